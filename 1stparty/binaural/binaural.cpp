@@ -1221,6 +1221,259 @@ namespace binaural
 	}
 #endif
 
+	//
+
+	void AudioBuffer_4::transformToFrequencyDomain()
+	{
+	#if BINAURAL_ENABLE_WDL_FFT
+		static bool isInit = false;
+		
+		if (isInit == false)
+		{
+			isInit = true;
+			
+			WDL_fft_init();
+		}
+		
+		static_assert(sizeof(Element) == sizeof(WDL_FFT4_COMPLEX), "AudioBuffer_4 element layout must match WDL_FFT4_COMPLEX");
+		
+		WDL_fft4((WDL_FFT4_COMPLEX*)elements, AUDIO_BUFFER_SIZE, false);
+	#else
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			ALIGN16 float real[AUDIO_BUFFER_SIZE];
+			ALIGN16 float imag[AUDIO_BUFFER_SIZE];
+			
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+			{
+				real[fftIndices.indices[i]] = elements[i].real[lane];
+				imag[fftIndices.indices[i]] = elements[i].imag[lane];
+			}
+			
+			Fourier::fft1D(real, imag, AUDIO_BUFFER_SIZE, AUDIO_BUFFER_SIZE, false, false);
+			
+			interleave(lane, real, imag);
+		}
+	#endif
+	}
+	
+	void AudioBuffer_4::transformToTimeDomain()
+	{
+	#if BINAURAL_ENABLE_WDL_FFT
+		// note : WDL_fft_init has already been called by transformToFrequencyDomain, as we can't have frequency domain data without it
+		
+		WDL_fft4((WDL_FFT4_COMPLEX*)elements, AUDIO_BUFFER_SIZE, true);
+	#else
+		for (int lane = 0; lane < 4; ++lane)
+		{
+			ALIGN16 float real[AUDIO_BUFFER_SIZE];
+			ALIGN16 float imag[AUDIO_BUFFER_SIZE];
+			
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+			{
+				real[fftIndices.indices[i]] = elements[i].real[lane];
+				imag[fftIndices.indices[i]] = elements[i].imag[lane];
+			}
+			
+			Fourier::fft1D(real, imag, AUDIO_BUFFER_SIZE, AUDIO_BUFFER_SIZE, true, false);
+			
+			interleave(lane, real, imag);
+		}
+	#endif
+	}
+	
+	void AudioBuffer_4::interleave(const int lane, const float * __restrict real, const float * __restrict imag)
+	{
+		if (real == nullptr)
+		{
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+				elements[i].real[lane] = 0.f;
+		}
+		else
+		{
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+				elements[i].real[lane] = real[i];
+		}
+		
+		if (imag == nullptr)
+		{
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+				elements[i].imag[lane] = 0.f;
+		}
+		else
+		{
+			for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+				elements[i].imag[lane] = imag[i];
+		}
+	}
+	
+	void AudioBuffer_4::deinterleave(const int lane, float * __restrict real, float * __restrict imag) const
+	{
+		for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+		{
+			real[i] = elements[i].real[lane];
+			imag[i] = elements[i].imag[lane];
+		}
+	}
+	
+	void AudioBuffer_4::deinterleaveReal(const int lane, const int offset, const int numSamples, const float scale, float * __restrict samples) const
+	{
+		debugAssert(offset >= 0 && offset + numSamples <= AUDIO_BUFFER_SIZE);
+		
+		for (int i = 0; i < numSamples; ++i)
+		{
+			samples[i] = elements[offset + i].real[lane] * scale;
+		}
+	}
+	
+	//
+	
+	void hrirToPartitionedHrtf(
+		const float * __restrict lSamples,
+		const float * __restrict rSamples,
+		PartitionedHRTF & hrtf)
+	{
+		static_assert(HRTF_NUM_PARTITIONS == 2, "hrirToPartitionedHrtf transforms all partitions of both ears at once. this assumes there are two partitions");
+		
+		// each partition is zero-padded to twice its size, so the circular convolution performed in the frequency domain
+		// doesn't wrap around into the samples we keep (overlap-save)
+		
+		AudioBuffer_4 buffer;
+		
+		for (int i = 0; i < AUDIO_BUFFER_SIZE; ++i)
+		{
+			const bool isPartitionSample = i < HRTF_PARTITION_SIZE;
+			
+			buffer.elements[i].real[0] = isPartitionSample ? lSamples[i] : 0.f;
+			buffer.elements[i].real[1] = isPartitionSample ? lSamples[HRTF_PARTITION_SIZE + i] : 0.f;
+			buffer.elements[i].real[2] = isPartitionSample ? rSamples[i] : 0.f;
+			buffer.elements[i].real[3] = isPartitionSample ? rSamples[HRTF_PARTITION_SIZE + i] : 0.f;
+			
+			for (int lane = 0; lane < 4; ++lane)
+				buffer.elements[i].imag[lane] = 0.f;
+		}
+		
+		buffer.transformToFrequencyDomain();
+		
+		buffer.deinterleave(0, hrtf.lFilter[0].real, hrtf.lFilter[0].imag);
+		buffer.deinterleave(1, hrtf.lFilter[1].real, hrtf.lFilter[1].imag);
+		buffer.deinterleave(2, hrtf.rFilter[0].real, hrtf.rFilter[0].imag);
+		buffer.deinterleave(3, hrtf.rFilter[1].real, hrtf.rFilter[1].imag);
+	}
+	
+	static void blendHrtfData_3(
+		HRTFData const * const * filters,
+		const float * weights,
+		HRTFData & result)
+	{
+	#if BINAURAL_USE_SSE || BINAURAL_USE_NEON
+		const float4 weight1 = _mm_set1_ps(weights[0]);
+		const float4 weight2 = _mm_set1_ps(weights[1]);
+		const float4 weight3 = _mm_set1_ps(weights[2]);
+		
+		for (int i = 0; i < HRTF_BUFFER_SIZE; i += 4)
+		{
+			_mm_store_ps(result.real + i,
+				_mm_add_ps(
+					_mm_add_ps(
+						_mm_mul_ps(_mm_load_ps(filters[0]->real + i), weight1),
+						_mm_mul_ps(_mm_load_ps(filters[1]->real + i), weight2)),
+					_mm_mul_ps(_mm_load_ps(filters[2]->real + i), weight3)));
+			
+			_mm_store_ps(result.imag + i,
+				_mm_add_ps(
+					_mm_add_ps(
+						_mm_mul_ps(_mm_load_ps(filters[0]->imag + i), weight1),
+						_mm_mul_ps(_mm_load_ps(filters[1]->imag + i), weight2)),
+					_mm_mul_ps(_mm_load_ps(filters[2]->imag + i), weight3)));
+		}
+	#else
+		for (int i = 0; i < HRTF_BUFFER_SIZE; ++i)
+		{
+			result.real[i] =
+				filters[0]->real[i] * weights[0] +
+				filters[1]->real[i] * weights[1] +
+				filters[2]->real[i] * weights[2];
+			
+			result.imag[i] =
+				filters[0]->imag[i] * weights[0] +
+				filters[1]->imag[i] * weights[1] +
+				filters[2]->imag[i] * weights[2];
+		}
+	#endif
+	}
+	
+	void blendPartitionedHrtfs_3(
+		PartitionedHRTF const * const * hrtfs,
+		const float * hrtfWeights,
+		PartitionedHRTF & result)
+	{
+		debugTimerBegin("blendPartitionedHrtfs_3");
+		
+		for (int p = 0; p < HRTF_NUM_PARTITIONS; ++p)
+		{
+			const HRTFData * lFilters[3] = { &hrtfs[0]->lFilter[p], &hrtfs[1]->lFilter[p], &hrtfs[2]->lFilter[p] };
+			const HRTFData * rFilters[3] = { &hrtfs[0]->rFilter[p], &hrtfs[1]->rFilter[p], &hrtfs[2]->rFilter[p] };
+			
+			blendHrtfData_3(lFilters, hrtfWeights, result.lFilter[p]);
+			blendHrtfData_3(rFilters, hrtfWeights, result.rFilter[p]);
+		}
+		
+		debugTimerEnd("blendPartitionedHrtfs_3");
+	}
+	
+	void convolvePartitioned(
+		AudioBuffer const * const * sourceSpectra,
+		const HRTFData * filter,
+		float * __restrict resultReal,
+		float * __restrict resultImag)
+	{
+		// accumulate the products of each partition of the filter with the spectrum of the matching (delayed) input block.
+		// sourceSpectra[0] is the spectrum of the most recent input block, sourceSpectra[1] the one before that, etc
+		
+	#if BINAURAL_USE_SSE || BINAURAL_USE_NEON
+		for (int i = 0; i < HRTF_BUFFER_SIZE; i += 4)
+		{
+			float4 re = _mm_setzero_ps();
+			float4 im = _mm_setzero_ps();
+			
+			for (int p = 0; p < HRTF_NUM_PARTITIONS; ++p)
+			{
+				const float4 sReal = _mm_load_ps(sourceSpectra[p]->real + i);
+				const float4 sImag = _mm_load_ps(sourceSpectra[p]->imag + i);
+				const float4 fReal = _mm_load_ps(filter[p].real + i);
+				const float4 fImag = _mm_load_ps(filter[p].imag + i);
+				
+				re = _mm_add_ps(re, _mm_sub_ps(_mm_mul_ps(sReal, fReal), _mm_mul_ps(sImag, fImag)));
+				im = _mm_add_ps(im, _mm_add_ps(_mm_mul_ps(sReal, fImag), _mm_mul_ps(sImag, fReal)));
+			}
+			
+			_mm_store_ps(resultReal + i, re);
+			_mm_store_ps(resultImag + i, im);
+		}
+	#else
+		for (int i = 0; i < HRTF_BUFFER_SIZE; ++i)
+		{
+			float re = 0.f;
+			float im = 0.f;
+			
+			for (int p = 0; p < HRTF_NUM_PARTITIONS; ++p)
+			{
+				const float sReal = sourceSpectra[p]->real[i];
+				const float sImag = sourceSpectra[p]->imag[i];
+				const float fReal = filter[p].real[i];
+				const float fImag = filter[p].imag[i];
+				
+				re += sReal * fReal - sImag * fImag;
+				im += sReal * fImag + sImag * fReal;
+			}
+			
+			resultReal[i] = re;
+			resultImag[i] = im;
+		}
+	#endif
+	}
+
 	const HRIRSampleGrid::Cell * HRIRSampleGrid::lookupCell(const float elevation, const float azimuth) const
 	{
 		const int cellX = (int(std::floor(elevation / 180.f * HRIRSampleGrid::kGridSx)) + HRIRSampleGrid::kGridSx) % HRIRSampleGrid::kGridSx;
@@ -1407,6 +1660,25 @@ namespace binaural
 		return result;
 	}
 	
+	HRIRSampleSet::~HRIRSampleSet()
+	{
+		for (auto & sample : samples)
+		{
+			delete sample;
+			sample = nullptr;
+		}
+		
+		samples.clear();
+		
+		for (auto & hrtf : hrtfs)
+		{
+			delete hrtf;
+			hrtf = nullptr;
+		}
+		
+		hrtfs.clear();
+	}
+	
 	bool HRIRSampleSet::addHrirSampleFromSoundData(const SoundData & soundData, const float elevation, const float azimuth, const bool swapLR)
 	{
 		HRIRSample * sample = new HRIRSample();
@@ -1572,6 +1844,27 @@ namespace binaural
 		}
 		
 		debugTimerEnd("grid_insertion");
+		
+		// precompute the partitioned HRTFs, so the binauralizer may blend filters directly in the frequency domain
+		
+		debugTimerBegin("hrtf_precompute");
+		
+		for (auto & hrtf : hrtfs)
+			delete hrtf;
+		
+		hrtfs.resize(samples.size());
+		
+		for (size_t i = 0; i < samples.size(); ++i)
+		{
+			hrtfs[i] = new PartitionedHRTF();
+			
+			hrirToPartitionedHrtf(
+				samples[i]->sampleData.lSamples,
+				samples[i]->sampleData.rSamples,
+				*hrtfs[i]);
+		}
+		
+		debugTimerEnd("hrtf_precompute");
 	}
 	
 	bool HRIRSampleSet::lookup_3(const float elevation, const float azimuth, HRIRSample const * * samples, float * sampleWeights) const
@@ -1605,6 +1898,37 @@ namespace binaural
 		return result;
 	}
 	
+	bool HRIRSampleSet::lookupHrtf_3(const float elevation, const float azimuth, PartitionedHRTF const * * hrtfs, float * hrtfWeights) const
+	{
+		debugTimerBegin("lookup_hrtf");
+		
+		debugAssert(this->hrtfs.size() == samples.size()); // sample set must be finalized
+		
+		bool result = false;
+		
+		float baryU;
+		float baryV;
+		
+		auto triangle = sampleGrid.lookupTriangle(elevation, azimuth, baryU, baryV);
+		
+		if (triangle != nullptr)
+		{
+			hrtfs[0] = this->hrtfs[triangle->vertex[0].sampleIndex];
+			hrtfs[1] = this->hrtfs[triangle->vertex[1].sampleIndex];
+			hrtfs[2] = this->hrtfs[triangle->vertex[2].sampleIndex];
+			
+			hrtfWeights[0] = 1.f - baryU - baryV;
+			hrtfWeights[1] = baryV;
+			hrtfWeights[2] = baryU;
+			
+			result = true;
+		}
+		
+		debugTimerEnd("lookup_hrtf");
+		
+		return result;
+	}
+	
 	bool HRIRSampleSet::save(FILE * file) const
 	{
 		bool result = true;
@@ -1647,4 +1971,93 @@ namespace binaural
 		
 		return result;
 	}
+	
+	static const int kFinalizedMagic = 0x46535248; // 'HRSF'
+	static const int kFinalizedVersion = 1;
+	
+	bool HRIRSampleSet::saveFinalized(FILE * file) const
+	{
+		debugAssert(hrtfs.size() == samples.size()); // sample set must be finalized
+		
+		bool result = true;
+		
+		// write header. the HRTF data depends on the buffer sizes, so store them to detect incompatible files
+		
+		result &= saveInt(file, kFinalizedMagic);
+		result &= saveInt(file, kFinalizedVersion);
+		result &= saveInt(file, HRIR_BUFFER_SIZE);
+		result &= saveInt(file, HRTF_NUM_PARTITIONS);
+		
+		// write samples and triangulation
+		
+		result &= save(file);
+		result &= sampleGrid.save(file);
+		
+		// write precomputed HRTFs
+		
+		for (auto hrtf : hrtfs)
+		{
+			result &= fwrite(hrtf, sizeof(*hrtf), 1, file) == 1;
+		}
+		
+		return result;
+	}
+	
+	bool HRIRSampleSet::loadFinalized(FILE * file)
+	{
+		debugAssert(samples.empty() && hrtfs.empty());
+		
+		bool result = true;
+		
+		// read header
+		
+		int magic = 0;
+		int version = 0;
+		int hrirBufferSize = 0;
+		int numPartitions = 0;
+		
+		result &= loadInt(file, magic);
+		result &= loadInt(file, version);
+		result &= loadInt(file, hrirBufferSize);
+		result &= loadInt(file, numPartitions);
+		
+		if (result == false ||
+			magic != kFinalizedMagic ||
+			version != kFinalizedVersion ||
+			hrirBufferSize != HRIR_BUFFER_SIZE ||
+			numPartitions != HRTF_NUM_PARTITIONS)
+		{
+			return false;
+		}
+		
+		// read samples and triangulation
+		
+		result &= load(file);
+		result &= sampleGrid.load(file);
+		
+		for (auto & triangle : sampleGrid.triangles)
+			for (auto & vertex : triangle.vertex)
+				result &= vertex.sampleIndex >= 0 && vertex.sampleIndex < (int)samples.size();
+		
+		for (int x = 0; x < HRIRSampleGrid::kGridSx; ++x)
+			for (int y = 0; y < HRIRSampleGrid::kGridSy; ++y)
+				for (auto triangleIndex : sampleGrid.cells[x][y].triangleIndices)
+					result &= triangleIndex >= 0 && triangleIndex < (int)sampleGrid.triangles.size();
+		
+		// read precomputed HRTFs
+		
+		if (result)
+		{
+			hrtfs.resize(samples.size());
+			
+			for (auto & hrtf : hrtfs)
+			{
+				hrtf = new PartitionedHRTF();
+				
+				result &= fread(hrtf, sizeof(*hrtf), 1, file) == 1;
+			}
+		}
+		
+		return result;
+	}
 }
@@ -110,6 +110,9 @@ namespace binaural
 	static const int HRIR_BUFFER_SIZE = 64; // todo : make effective FFT size depend on the sample set. let this be merely the maximum HRIR buffer size
 	static const int HRTF_BUFFER_SIZE = HRIR_BUFFER_SIZE;
 	static const int AUDIO_BUFFER_SIZE = HRIR_BUFFER_SIZE;
+	
+	static const int HRTF_PARTITION_SIZE = AUDIO_BUFFER_SIZE / 2; // the number of HRIR samples in each partition of a partitioned HRTF. equal to the number of samples processed per update
+	static const int HRTF_NUM_PARTITIONS = HRIR_BUFFER_SIZE / HRTF_PARTITION_SIZE;
 
 	// forward declarations
 
@@ -118,6 +121,7 @@ namespace binaural
 	struct HRIRSampleData;
 	struct HRTF;
 	struct HRTFData;
+	struct PartitionedHRTF;
 	struct SoundData;
 	
 	// values
@@ -163,6 +167,28 @@ namespace binaural
 	{
 		ALIGN16 float samples[AUDIO_BUFFER_SIZE];
 	};
+	
+	/**
+	 * Four complex audio buffers, stored such that each element holds the values for all four buffers. This layout lets us perform four FFTs at once.
+	 * Note the frequency domain data is stored in the order produced by the FFT implementation, which isn't necessarily the natural order. Data should only be combined with other data transformed to the frequency domain by AudioBuffer_4.
+	 */
+	struct AudioBuffer_4
+	{
+		struct Element
+		{
+			ALIGN16 float real[4];
+			ALIGN16 float imag[4];
+		};
+		
+		Element elements[AUDIO_BUFFER_SIZE];
+		
+		void transformToFrequencyDomain();
+		void transformToTimeDomain(); // note : the result isn't scaled by 1/AUDIO_BUFFER_SIZE
+		
+		void interleave(const int lane, const float * __restrict real, const float * __restrict imag); // real and/or imag may be nullptr, to set them to zero
+		void deinterleave(const int lane, float * __restrict real, float * __restrict imag) const;
+		void deinterleaveReal(const int lane, const int offset, const int numSamples, const float scale, float * __restrict samples) const;
+	};
 
 	struct HRIRSampleData
 	{
@@ -273,25 +299,18 @@ namespace binaural
 	struct HRIRSampleSet
 	{
 		std::vector<HRIRSample*> samples;
+		std::vector<PartitionedHRTF*> hrtfs; // precomputed HRTF for each sample, computed by finalize
 		
 		HRIRSampleGrid sampleGrid;
 		
 		HRIRSampleSet()
 			: samples()
+			, hrtfs()
 			, sampleGrid()
 		{
 		}
 		
-		~HRIRSampleSet()
-		{
-			for (auto & sample : samples)
-			{
-				delete sample;
-				sample = nullptr;
-			}
-			
-			samples.clear();
-		}
+		~HRIRSampleSet();
 		
 		bool addHrirSampleFromSoundData(
 			const SoundData & soundData,
@@ -302,9 +321,17 @@ namespace binaural
 		void finalize();
 		
 		bool lookup_3(const float elevation, const float azimuth, HRIRSample const * * samples, float * sampleWeights) const;
+		bool lookupHrtf_3(const float elevation, const float azimuth, PartitionedHRTF const * * hrtfs, float * hrtfWeights) const;
 		
 		bool save(FILE * file) const;
 		bool load(FILE * file);
+		
+		/**
+		 * Saves the finalized sample set, including the triangulation and the precomputed HRTFs.
+		 * A sample set loaded using loadFinalized is ready for use, without the need to call finalize.
+		 */
+		bool saveFinalized(FILE * file) const;
+		bool loadFinalized(FILE * file);
 	};
 
 	struct HRTFData
@@ -320,6 +347,43 @@ namespace binaural
 		HRTFData lFilter;
 		HRTFData rFilter;
 	};
+	
+	/**
+	 * HRTF for the left and right ear, split into HRTF_NUM_PARTITIONS partitions for use with uniformly partitioned convolution.
+	 * Each partition holds the frequency domain representation of HRTF_PARTITION_SIZE HRIR samples, zero-padded to AUDIO_BUFFER_SIZE,
+	 * as transformed by AudioBuffer_4. Since the Fourier transform is linear, partitioned HRTFs may be blended directly.
+	 */
+	struct PartitionedHRTF
+	{
+		HRTFData lFilter[HRTF_NUM_PARTITIONS];
+		HRTFData rFilter[HRTF_NUM_PARTITIONS];
+		
+	#if BINAURAL_USE_SIMD
+	#if BINAURAL_USE_SSE
+		void * operator new(size_t size)
+		{
+			return _mm_malloc(size, 32);
+		}
+
+		void operator delete(void * mem)
+		{
+			_mm_free(mem);
+		}
+	#else
+		void * operator new(size_t size)
+		{
+			void * result = nullptr;
+			posix_memalign(&result, 16, size);
+			return result;
+		}
+
+		void operator delete(void * mem)
+		{
+			free(mem);
+		}
+	#endif
+	#endif
+	};
 
 	struct SoundData
 	{
@@ -386,6 +450,22 @@ namespace binaural
 		HRTFData & lFilter,
 		HRTFData & rFilter);
 	
+	void hrirToPartitionedHrtf(
+		const float * __restrict lSamples,
+		const float * __restrict rSamples,
+		PartitionedHRTF & hrtf);
+	
+	void blendPartitionedHrtfs_3(
+		PartitionedHRTF const * const * hrtfs,
+		const float * hrtfWeights,
+		PartitionedHRTF & result);
+	
+	void convolvePartitioned(
+		AudioBuffer const * const * sourceSpectra,
+		const HRTFData * filter,
+		float * __restrict resultReal,
+		float * __restrict resultImag);
+	
 	void reverseSampleIndices(
 		const float * __restrict src,
 		float * __restrict dst);
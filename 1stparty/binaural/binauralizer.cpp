@@ -1,371 +1,889 @@
-/*
-	Copyright (C) 2020 Marcel Smit
-	marcel303@gmail.com
-	https://www.facebook.com/marcel.smit981
-
-	Permission is hereby granted, free of charge, to any person
-	obtaining a copy of this software and associated documentation
-	files (the "Software"), to deal in the Software without
-	restriction, including without limitation the rights to use,
-	copy, modify, merge, publish, distribute, sublicense, and/or
-	sell copies of the Software, and to permit persons to whom the
-	Software is furnished to do so, subject to the following
-	conditions:
-
-	The above copyright notice and this permission notice shall be
-	included in all copies or substantial portions of the Software.
-
-	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
-	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
-	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
-	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
-	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
-	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
-	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
-	OTHER DEALINGS IN THE SOFTWARE.
-*/
-
-#include "binaural.h"
-#include "binauralizer.h"
-#include <algorithm>
-#include <string.h>
-
-#if BINAURAL_USE_NEON
-	#include "sse2neon.h"
-#endif
-
-#undef AUDIO_UPDATE_SIZE
-
-namespace binaural
-{
-	static const int AUDIO_UPDATE_SIZE = AUDIO_BUFFER_SIZE/2;
-	
-	//
-	
-	Binauralizer::Binauralizer()
-		: sampleSet(nullptr)
-		, sampleBuffer()
-		, overlapBuffer()
-		, sampleLocation()
-		, hrtfs()
-		, nextHrtfIndex(0)
-		, audioBufferL()
-		, audioBufferR()
-		, nextReadLocation(AUDIO_BUFFER_SIZE)
-		, mutex(nullptr)
-	{
-		memset(overlapBuffer, 0, sizeof(overlapBuffer));
-		memset(hrtfs, 0, sizeof(hrtfs));
-		
-	#if defined(DEBUG)
-		memset(sampleBuffer.samples, 0xff, sizeof(sampleBuffer.samples));
-	#endif
-	}
-	
-	void Binauralizer::init(const HRIRSampleSet * in_sampleSet, Mutex * in_mutex)
-	{
-		debugAssert(in_sampleSet == nullptr || in_sampleSet->sampleGrid.triangles.empty() == false); // sample set must be finalized
-	
-		sampleSet = in_sampleSet;
-		mutex = in_mutex;
-	}
-	
-	void Binauralizer::shut()
-	{
-		sampleSet = nullptr;
-		mutex = nullptr;
-	}
-	
-	bool Binauralizer::isInit() const
-	{
-		return
-			sampleSet != nullptr &&
-			mutex != nullptr;
-	}
-	
-	void Binauralizer::setSampleSet(const HRIRSampleSet * in_sampleSet)
-	{
-		debugAssert(in_sampleSet == nullptr || in_sampleSet->sampleGrid.triangles.empty() == false); // sample set must be finalized
-		
-		sampleSet = in_sampleSet;
-	}
-	
-	void Binauralizer::setSampleLocation(const float elevation, const float azimuth)
-	{
-		mutex->lock();
-		{
-			sampleLocation.elevation = elevation;
-			sampleLocation.azimuth = azimuth;
-		}
-		mutex->unlock();
-	}
-	
-	void Binauralizer::calculateHrir(HRIRSample & sample) const
-	{
-		// compute the HRIR, a blend between three sample points in a Delaunay triangulation of all sample points
-		
-		const HRIRSample * samples[3];
-		float sampleWeights[3];
-		
-		float elevation;
-		float azimuth;
-		
-		mutex->lock();
-		{
-			elevation = sampleLocation.elevation;
-			azimuth = sampleLocation.azimuth;
-		}
-		mutex->unlock();
-
-		// ensure elevation and azimuth are within (-90, -180) to (+90, +180) range
-
-		float x, y, z;
-		elevationAndAzimuthToCartesian(elevation, azimuth, x, y, z);
-		cartesianToElevationAndAzimuth(x, y, z, elevation, azimuth);
-		debugAssert(elevation >= -90.f && elevation <= +90.f);
-		debugAssert(azimuth >= -180.f && azimuth <= +180.f);
-
-		{
-			// clamp elevation and azimuth to ensure it maps within the elevation and azimut topology
-			
-			const float eps = .01f;
-			
-			const float elevationMin = -90.f + eps;
-			const float elevationMax = +90.f - eps;
-			
-			const float azimuthMin = -180.f + eps;
-			const float azimuthMax = +180.f - eps;
-			
-			elevation = std::max(elevation, elevationMin);
-			elevation = std::min(elevation, elevationMax);
-			
-			azimuth = std::max(azimuth, azimuthMin);
-			azimuth = std::min(azimuth, azimuthMax);
-		}
-		
-		if (sampleSet != nullptr && sampleSet->lookup_3(elevation, azimuth, samples, sampleWeights))
-		{
-			blendHrirSamples_3(samples, sampleWeights, sample);
-		}
-		else
-		{
-			memset(&sample, 0, sizeof(sample));
-		}
-	}
-	
-	void Binauralizer::provide(const float * __restrict samples, const int numSamples)
-	{
-		int left = numSamples;
-		int done = 0;
-		
-		while (left != 0)
-		{
-			if (sampleBuffer.nextWriteIndex == SampleBuffer::kBufferSize)
-			{
-				sampleBuffer.nextWriteIndex = 0;
-			}
-			
-			const int todo = std::min(left, SampleBuffer::kBufferSize - sampleBuffer.nextWriteIndex);
-			
-			memcpy(sampleBuffer.samples + sampleBuffer.nextWriteIndex, samples + done, todo * sizeof(float));
-			
-			sampleBuffer.nextWriteIndex += todo;
-			
-			left -= todo;
-			done += todo;
-		}
-		
-		sampleBuffer.totalWriteSize += numSamples;
-	}
-	
-	void Binauralizer::fillReadBuffer(const HRIRSampleData & hrir)
-	{
-		if (sampleBuffer.totalWriteSize < AUDIO_UPDATE_SIZE)
-		{
-			memset(audioBufferL.samples, 0, sizeof(audioBufferL.samples));
-			memset(audioBufferR.samples, 0, sizeof(audioBufferR.samples));
-			nextReadLocation = AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
-			return;
-		}
-		
-		// move the old audio signal to the start of the overlap buffer
-		
-		memcpy(overlapBuffer, overlapBuffer + AUDIO_UPDATE_SIZE, (AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE) * sizeof(float));
-		
-		// generate audio signal
-		
-		float * __restrict samples = overlapBuffer + AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
-		
-		int left = AUDIO_UPDATE_SIZE;
-		int done = 0;
-		
-		while (left != 0)
-		{
-			if (sampleBuffer.nextReadIndex == SampleBuffer::kBufferSize)
-			{
-				sampleBuffer.nextReadIndex = 0;
-			}
-			
-			const int todo = std::min(left, SampleBuffer::kBufferSize - sampleBuffer.nextReadIndex);
-			
-			memcpy(samples + done, sampleBuffer.samples + sampleBuffer.nextReadIndex, todo * sizeof(float));
-			
-			sampleBuffer.nextReadIndex += todo;
-			
-			left -= todo;
-			done += todo;
-		}
-		
-		// compute the HRTF from the HRIR
-		
-		const HRTF & oldHrtf = hrtfs[1 - nextHrtfIndex];
-		HRTF & newHrtf = hrtfs[nextHrtfIndex];
-		nextHrtfIndex = (nextHrtfIndex + 1) % 2;
-		
-		hrirToHrtf(hrir.lSamples, hrir.rSamples, newHrtf.lFilter, newHrtf.rFilter);
-		
-		// prepare audio signal for HRTF application
-		
-	#if !BINAURAL_ENABLE_FOURIER4 && BINAURAL_ENABLE_WDL_FFT
-		AudioBuffer audioBuffer;
-		memcpy(audioBuffer.real, overlapBuffer, AUDIO_BUFFER_SIZE * sizeof(float));
-		memset(audioBuffer.imag, 0, AUDIO_BUFFER_SIZE * sizeof(float));
-	#else
-		AudioBuffer audioBuffer;
-		reverseSampleIndices(overlapBuffer, audioBuffer.real);
-		memset(audioBuffer.imag, 0, AUDIO_BUFFER_SIZE * sizeof(float));
-	#endif
-	
-		// apply HRTF
-		
-		// convolve audio in the frequency domain
-		
-		AudioBuffer_Real oldAudioBufferL;
-		AudioBuffer_Real oldAudioBufferR;
-		
-		AudioBuffer_Real newAudioBufferL;
-		AudioBuffer_Real newAudioBufferR;
-		
-		convolveAudio_2(
-			audioBuffer,
-			oldHrtf.lFilter,
-			oldHrtf.rFilter,
-			newHrtf.lFilter,
-			newHrtf.rFilter,
-			oldAudioBufferL.samples,
-			oldAudioBufferR.samples,
-			newAudioBufferL.samples,
-			newAudioBufferR.samples);
-		
-		// ramp from old to new audio buffer
-		
-		const int offset = AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
-		
-		rampAudioBuffers(oldAudioBufferL.samples + offset, newAudioBufferL.samples + offset, AUDIO_UPDATE_SIZE, audioBufferL.samples + offset);
-		rampAudioBuffers(oldAudioBufferR.samples + offset, newAudioBufferR.samples + offset, AUDIO_UPDATE_SIZE, audioBufferR.samples + offset);
-		
-		nextReadLocation = AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
-	}
-	
-	void Binauralizer::generateInterleaved(
-		float * __restrict samples,
-		const int numSamples,
-		const HRIRSample * hrir)
-	{
-		assert(numSamples <= SampleBuffer::kBufferSize);
-
-		int left = numSamples;
-		int done = 0;
-		
-		while (left != 0)
-		{
-			if (nextReadLocation == AUDIO_BUFFER_SIZE)
-			{
-				if (hrir == nullptr)
-				{
-					HRIRSample hrir;
-					calculateHrir(hrir);
-					fillReadBuffer(hrir.sampleData);
-				}
-				else
-				{
-					fillReadBuffer(hrir->sampleData);
-				}
-			}
-			
-			const int todo = std::min(left, AUDIO_BUFFER_SIZE - nextReadLocation);
-			
-		#if BINAURAL_USE_SSE || BINAURAL_USE_NEON
-			debugAssert((todo % 4) == 0);
-			
-			const float4 * __restrict audioBufferL4 = (float4*)audioBufferL.samples + nextReadLocation / 4;
-			const float4 * __restrict audioBufferR4 = (float4*)audioBufferR.samples + nextReadLocation / 4;
-			float4 * __restrict samples4 = (float4*)samples;
-			
-			for (int i = 0; i < todo / 4; ++i)
-			{
-				const float4 l = audioBufferL4[i];
-				const float4 r = audioBufferR4[i];
-				
-				const float4 interleaved1 = _mm_unpacklo_ps(l, r);
-				const float4 interleaved2 = _mm_unpackhi_ps(l, r);
-				
-				samples4[i * 2 + 0] = interleaved1;
-				samples4[i * 2 + 1] = interleaved2;
-			}
-		#else
-			for (int i = 0; i < todo; ++i)
-			{
-				samples[i * 2 + 0] = audioBufferL.samples[nextReadLocation + i];
-				samples[i * 2 + 1] = audioBufferR.samples[nextReadLocation + i];
-			}
-		#endif
-			
-			samples += todo * 2;
-			
-			nextReadLocation += todo;
-			
-			left -= todo;
-			done += todo;
-		}
-	}
-	
-	void Binauralizer::generateLR(
-		float * __restrict samplesL,
-		float * __restrict samplesR,
-		const int numSamples,
-		const HRIRSample * hrir)
-	{
-		assert(numSamples <= SampleBuffer::kBufferSize);
-		
-		int left = numSamples;
-		int done = 0;
-		
-		while (left != 0)
-		{
-			if (nextReadLocation == AUDIO_BUFFER_SIZE)
-			{
-				if (hrir == nullptr)
-				{
-					HRIRSample hrir;
-					calculateHrir(hrir);
-					fillReadBuffer(hrir.sampleData);
-				}
-				else
-				{
-					fillReadBuffer(hrir->sampleData);
-				}
-			}
-			
-			const int todo = std::min(left, AUDIO_BUFFER_SIZE - nextReadLocation);
-			
-			memcpy(samplesL + done, audioBufferL.samples + nextReadLocation, todo * sizeof(float));
-			memcpy(samplesR + done, audioBufferR.samples + nextReadLocation, todo * sizeof(float));
-			
-			nextReadLocation += todo;
-			
-			left -= todo;
-			done += todo;
-		}
-	}
-}
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "binaural.h"
+#include "binauralizer.h"
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+
+#if BINAURAL_USE_NEON
+	#include "sse2neon.h"
+#endif
+
+#undef AUDIO_UPDATE_SIZE
+
+namespace binaural
+{
+	static const int AUDIO_UPDATE_SIZE = AUDIO_BUFFER_SIZE/2;
+	
+	static_assert(AUDIO_UPDATE_SIZE == HRTF_PARTITION_SIZE, "partitioned convolution requires the update size to match the HRTF partition size");
+	
+	static const int kMaxBatchSize = 32; // the maximum number of binauralizers processed at once. limits the amount of stack space used for temporary buffers
+	
+	//
+	
+	static void clampSampleLocation(float & elevation, float & azimuth)
+	{
+		// clamp elevation and azimuth to ensure it maps within the elevation and azimut topology
+		
+		const float eps = .01f;
+		
+		const float elevationMin = -90.f + eps;
+		const float elevationMax = +90.f - eps;
+		
+		const float azimuthMin = -180.f + eps;
+		const float azimuthMax = +180.f - eps;
+		
+		elevation = std::max(elevation, elevationMin);
+		elevation = std::min(elevation, elevationMax);
+		
+		azimuth = std::max(azimuth, azimuthMin);
+		azimuth = std::min(azimuth, azimuthMax);
+	}
+	
+	static void sanitizeSampleLocation(float & elevation, float & azimuth)
+	{
+		// ensure elevation and azimuth are within (-90, -180) to (+90, +180) range
+
+		float x, y, z;
+		elevationAndAzimuthToCartesian(elevation, azimuth, x, y, z);
+		cartesianToElevationAndAzimuth(x, y, z, elevation, azimuth);
+		debugAssert(elevation >= -90.f && elevation <= +90.f);
+		debugAssert(azimuth >= -180.f && azimuth <= +180.f);
+
+		clampSampleLocation(elevation, azimuth);
+	}
+	
+	static void readInputBlock(Binauralizer::SampleBuffer & sampleBuffer, float * __restrict overlapBuffer)
+	{
+		// move the old audio signal to the start of the overlap buffer
+		
+		memcpy(overlapBuffer, overlapBuffer + AUDIO_UPDATE_SIZE, (AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE) * sizeof(float));
+		
+		// read the new audio signal
+		
+		float * __restrict samples = overlapBuffer + AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
+		
+		int left = AUDIO_UPDATE_SIZE;
+		int done = 0;
+		
+		while (left != 0)
+		{
+			if (sampleBuffer.nextReadIndex == Binauralizer::SampleBuffer::kBufferSize)
+			{
+				sampleBuffer.nextReadIndex = 0;
+			}
+			
+			const int todo = std::min(left, Binauralizer::SampleBuffer::kBufferSize - sampleBuffer.nextReadIndex);
+			
+			memcpy(samples + done, sampleBuffer.samples + sampleBuffer.nextReadIndex, todo * sizeof(float));
+			
+			sampleBuffer.nextReadIndex += todo;
+			
+			left -= todo;
+			done += todo;
+		}
+	}
+	
+	/**
+	 * Gathers up to four convolved spectra, and transforms them back to the time domain at once.
+	 */
+	struct InverseTransformBatch
+	{
+		AudioBuffer_4 buffer;
+		float * outputs[4];
+		int numLanes = 0;
+		
+		InverseTransformBatch()
+		{
+			// note : lanes left unused by a partial batch keep the data from the previous batch. this is harmless, as
+			//        lanes are transformed independently, as long as the data is initialized
+			
+			memset(&buffer, 0, sizeof(buffer));
+		}
+		
+		void add(AudioBuffer const * const * sourceSpectra, const HRTFData * filter, float * output)
+		{
+			ALIGN16 float real[HRTF_BUFFER_SIZE];
+			ALIGN16 float imag[HRTF_BUFFER_SIZE];
+			
+			convolvePartitioned(sourceSpectra, filter, real, imag);
+			
+			buffer.interleave(numLanes, real, imag);
+			outputs[numLanes] = output;
+			numLanes++;
+			
+			if (numLanes == 4)
+				flush();
+		}
+		
+		void flush()
+		{
+			if (numLanes == 0)
+				return;
+			
+			buffer.transformToTimeDomain();
+			
+			// with overlap-save, only the last AUDIO_UPDATE_SIZE samples are free from circular convolution artefacts
+			
+			const float scale = 1.f / AUDIO_BUFFER_SIZE;
+			
+			for (int lane = 0; lane < numLanes; ++lane)
+				buffer.deinterleaveReal(lane, AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE, AUDIO_UPDATE_SIZE, scale, outputs[lane]);
+			
+			numLanes = 0;
+		}
+	};
+	
+	static void fillReadBuffersBatch(
+		Binauralizer * const * binauralizers,
+		const HRIRSampleData * const * hrirs,
+		const int numBinauralizers)
+	{
+		debugAssert(numBinauralizers <= kMaxBatchSize);
+		
+		Binauralizer * active[kMaxBatchSize];
+		bool hrtfChanged[kMaxBatchSize];
+		int numActive = 0;
+		
+		const int offset = AUDIO_BUFFER_SIZE - AUDIO_UPDATE_SIZE;
+		
+		for (int i = 0; i < numBinauralizers; ++i)
+		{
+			Binauralizer * binauralizer = binauralizers[i];
+			
+			if (binauralizer->sampleBuffer.totalWriteSize < AUDIO_UPDATE_SIZE)
+			{
+				memset(binauralizer->audioBufferL.samples, 0, sizeof(binauralizer->audioBufferL.samples));
+				memset(binauralizer->audioBufferR.samples, 0, sizeof(binauralizer->audioBufferR.samples));
+				binauralizer->nextReadLocation = offset;
+				continue;
+			}
+			
+			readInputBlock(binauralizer->sampleBuffer, binauralizer->overlapBuffer);
+			
+			hrtfChanged[numActive] = binauralizer->updateHrtf(hrirs == nullptr ? nullptr : hrirs[i]);
+			
+			active[numActive] = binauralizer;
+			numActive++;
+		}
+		
+		// transform the input blocks to the frequency domain, four at a time
+		
+		AudioBuffer_4 buffer;
+		memset(&buffer, 0, sizeof(buffer));
+		
+		for (int i = 0; i < numActive; i += 4)
+		{
+			const int numLanes = std::min(4, numActive - i);
+			
+			// note : unused lanes keep the data from the previous group, which is harmless
+			
+			for (int lane = 0; lane < numLanes; ++lane)
+				buffer.interleave(lane, active[i + lane]->overlapBuffer, nullptr);
+			
+			buffer.transformToFrequencyDomain();
+			
+			for (int lane = 0; lane < numLanes; ++lane)
+			{
+				Binauralizer * binauralizer = active[i + lane];
+				
+				AudioBuffer & spectrum = binauralizer->inputSpectra[binauralizer->nextInputSpectrumIndex];
+				
+				buffer.deinterleave(lane, spectrum.real, spectrum.imag);
+			}
+		}
+		
+		// apply the HRTFs in the frequency domain and transform the results back to the time domain. when the HRTF changed,
+		// we convolve with both the old and the new HRTF, so we can ramp between them
+		
+		ALIGN16 float oldSamples[kMaxBatchSize][2][AUDIO_UPDATE_SIZE];
+		
+		InverseTransformBatch inverseTransformBatch;
+		
+		for (int i = 0; i < numActive; ++i)
+		{
+			Binauralizer * binauralizer = active[i];
+			
+			const AudioBuffer * sourceSpectra[HRTF_NUM_PARTITIONS];
+			
+			for (int p = 0; p < HRTF_NUM_PARTITIONS; ++p)
+			{
+				const int index = (binauralizer->nextInputSpectrumIndex - p + HRTF_NUM_PARTITIONS) % HRTF_NUM_PARTITIONS;
+				
+				sourceSpectra[p] = &binauralizer->inputSpectra[index];
+			}
+			
+			binauralizer->nextInputSpectrumIndex = (binauralizer->nextInputSpectrumIndex + 1) % HRTF_NUM_PARTITIONS;
+			
+			const PartitionedHRTF & newHrtf = binauralizer->hrtfs[1 - binauralizer->nextHrtfIndex];
+			
+			inverseTransformBatch.add(sourceSpectra, newHrtf.lFilter, binauralizer->audioBufferL.samples + offset);
+			inverseTransformBatch.add(sourceSpectra, newHrtf.rFilter, binauralizer->audioBufferR.samples + offset);
+			
+			if (hrtfChanged[i])
+			{
+				const PartitionedHRTF & oldHrtf = binauralizer->hrtfs[binauralizer->nextHrtfIndex];
+				
+				inverseTransformBatch.add(sourceSpectra, oldHrtf.lFilter, oldSamples[i][0]);
+				inverseTransformBatch.add(sourceSpectra, oldHrtf.rFilter, oldSamples[i][1]);
+			}
+		}
+		
+		inverseTransformBatch.flush();
+		
+		// ramp from old to new audio buffer
+		
+		for (int i = 0; i < numActive; ++i)
+		{
+			Binauralizer * binauralizer = active[i];
+			
+			if (hrtfChanged[i])
+			{
+				ALIGN16 float newSamples[AUDIO_UPDATE_SIZE];
+				
+				memcpy(newSamples, binauralizer->audioBufferL.samples + offset, sizeof(newSamples));
+				rampAudioBuffers(oldSamples[i][0], newSamples, AUDIO_UPDATE_SIZE, binauralizer->audioBufferL.samples + offset);
+				
+				memcpy(newSamples, binauralizer->audioBufferR.samples + offset, sizeof(newSamples));
+				rampAudioBuffers(oldSamples[i][1], newSamples, AUDIO_UPDATE_SIZE, binauralizer->audioBufferR.samples + offset);
+			}
+			
+			binauralizer->nextReadLocation = offset;
+		}
+	}
+	
+	//
+	
+	HRTFCache::HRTFCache()
+		: sampleSet(nullptr)
+		, angularResolution(0.f)
+		, numElevations(0)
+		, numAzimuths(0)
+		, keyToEntry()
+		, entryHrtfs()
+		, entryKeys()
+		, entryPrev()
+		, entryNext()
+		, numEntries(0)
+		, head(-1)
+		, tail(-1)
+		, stats()
+		, mutex(nullptr)
+	{
+	}
+	
+	HRTFCache::~HRTFCache()
+	{
+		shut();
+	}
+	
+	void HRTFCache::init(const HRIRSampleSet * in_sampleSet, const float in_angularResolution, const int maxEntries, Mutex * in_mutex)
+	{
+		debugAssert(in_sampleSet != nullptr && in_sampleSet->hrtfs.size() == in_sampleSet->samples.size()); // sample set must be finalized
+		debugAssert(in_angularResolution >= .25f);
+		debugAssert(maxEntries >= 1);
+		
+		shut();
+		
+		sampleSet = in_sampleSet;
+		mutex = in_mutex;
+		
+		// note : the key table has an entry for each quantized direction. limit the resolution to keep its size reasonable
+		
+		angularResolution = std::max(in_angularResolution, .25f);
+		
+		numElevations = int(std::ceil(180.f / angularResolution)) + 1;
+		numAzimuths = int(std::ceil(360.f / angularResolution)) + 1;
+		
+		keyToEntry.resize(numElevations * numAzimuths, -1);
+		
+		const int numEntriesToAllocate = std::max(1, maxEntries);
+		
+		entryHrtfs.resize(numEntriesToAllocate);
+		for (auto & hrtf : entryHrtfs)
+			hrtf = new PartitionedHRTF();
+		
+		entryKeys.resize(numEntriesToAllocate, -1);
+		entryPrev.resize(numEntriesToAllocate, -1);
+		entryNext.resize(numEntriesToAllocate, -1);
+		
+		numEntries = 0;
+		head = -1;
+		tail = -1;
+		
+		stats = Stats();
+	}
+	
+	void HRTFCache::shut()
+	{
+		for (auto & hrtf : entryHrtfs)
+		{
+			delete hrtf;
+			hrtf = nullptr;
+		}
+		
+		entryHrtfs.clear();
+		entryKeys.clear();
+		entryPrev.clear();
+		entryNext.clear();
+		
+		keyToEntry.clear();
+		
+		numEntries = 0;
+		head = -1;
+		tail = -1;
+		
+		sampleSet = nullptr;
+		mutex = nullptr;
+	}
+	
+	bool HRTFCache::isInit() const
+	{
+		return sampleSet != nullptr;
+	}
+	
+	int HRTFCache::calculateKey(const float elevation, const float azimuth) const
+	{
+		const int elevationIndex = int(std::round((elevation + 90.f) / angularResolution));
+		const int azimuthIndex = int(std::round((azimuth + 180.f) / angularResolution));
+		
+		debugAssert(elevationIndex >= 0 && elevationIndex < numElevations);
+		debugAssert(azimuthIndex >= 0 && azimuthIndex < numAzimuths);
+		
+		return
+			std::max(0, std::min(numElevations - 1, elevationIndex)) * numAzimuths +
+			std::max(0, std::min(numAzimuths - 1, azimuthIndex));
+	}
+	
+	void HRTFCache::lookup(const int key, PartitionedHRTF & hrtf)
+	{
+		debugAssert(key >= 0 && key < (int)keyToEntry.size());
+		
+		mutex->lock();
+		{
+			stats.numLookups++;
+			
+			int entryIndex = keyToEntry[key];
+			
+			if (entryIndex == -1)
+			{
+				stats.numMisses++;
+				
+				// allocate an entry, or evict the least recently used one
+				
+				if (numEntries < (int)entryHrtfs.size())
+				{
+					entryIndex = numEntries++;
+				}
+				else
+				{
+					stats.numEvictions++;
+					
+					entryIndex = tail;
+					
+					keyToEntry[entryKeys[entryIndex]] = -1;
+					
+					// unlink the entry
+					
+					tail = entryPrev[entryIndex];
+					
+					if (tail != -1)
+						entryNext[tail] = -1;
+					else
+						head = -1;
+				}
+				
+				// compute the HRTF at the center of the quantized direction. note the key was calculated from a sanitized
+				// direction, so we only need to clamp the center to the elevation and azimuth topology
+				
+				float elevation = (key / numAzimuths) * angularResolution - 90.f;
+				float azimuth = (key % numAzimuths) * angularResolution - 180.f;
+				
+				clampSampleLocation(elevation, azimuth);
+				
+				const PartitionedHRTF * sampleHrtfs[3];
+				float sampleWeights[3];
+				
+				PartitionedHRTF & entryHrtf = *entryHrtfs[entryIndex];
+				
+				if (sampleSet->lookupHrtf_3(elevation, azimuth, sampleHrtfs, sampleWeights))
+					blendPartitionedHrtfs_3(sampleHrtfs, sampleWeights, entryHrtf);
+				else
+					memset(&entryHrtf, 0, sizeof(entryHrtf));
+				
+				entryKeys[entryIndex] = key;
+				keyToEntry[key] = entryIndex;
+				
+				// link the entry at the head of the list
+				
+				entryPrev[entryIndex] = -1;
+				entryNext[entryIndex] = head;
+				
+				if (head != -1)
+					entryPrev[head] = entryIndex;
+				head = entryIndex;
+				
+				if (tail == -1)
+					tail = entryIndex;
+			}
+			else if (entryIndex != head)
+			{
+				// move the entry to the head of the list
+				
+				const int prev = entryPrev[entryIndex];
+				const int next = entryNext[entryIndex];
+				
+				entryNext[prev] = next;
+				
+				if (next != -1)
+					entryPrev[next] = prev;
+				else
+					tail = prev;
+				
+				entryPrev[entryIndex] = -1;
+				entryNext[entryIndex] = head;
+				entryPrev[head] = entryIndex;
+				head = entryIndex;
+			}
+			
+			memcpy(&hrtf, entryHrtfs[entryIndex], sizeof(hrtf));
+		}
+		mutex->unlock();
+	}
+	
+	HRTFCache::Stats HRTFCache::getStats() const
+	{
+		Stats result;
+		
+		mutex->lock();
+		{
+			result = stats;
+		}
+		mutex->unlock();
+		
+		return result;
+	}
+	
+	//
+	
+	Binauralizer::Binauralizer()
+		: sampleSet(nullptr)
+		, hrtfCache(nullptr)
+		, sampleBuffer()
+		, overlapBuffer()
+		, inputSpectra()
+		, nextInputSpectrumIndex(0)
+		, sampleLocation()
+		, hrtfs()
+		, nextHrtfIndex(0)
+		, hrtfSource(kHrtfSource_None)
+		, hrtfSampleSet(nullptr)
+		, hrtfSampleLocation()
+		, hrtfCacheKey(HRTFCache::kInvalidKey)
+		, hrtfHrir()
+		, audioBufferL()
+		, audioBufferR()
+		, nextReadLocation(AUDIO_BUFFER_SIZE)
+		, mutex(nullptr)
+	{
+		memset(overlapBuffer, 0, sizeof(overlapBuffer));
+		memset(inputSpectra, 0, sizeof(inputSpectra));
+		memset(hrtfs, 0, sizeof(hrtfs));
+		memset(&hrtfHrir, 0, sizeof(hrtfHrir));
+		
+	#if defined(DEBUG)
+		memset(sampleBuffer.samples, 0xff, sizeof(sampleBuffer.samples));
+	#endif
+	}
+	
+	void Binauralizer::init(const HRIRSampleSet * in_sampleSet, Mutex * in_mutex)
+	{
+		debugAssert(in_sampleSet == nullptr || in_sampleSet->sampleGrid.triangles.empty() == false); // sample set must be finalized
+	
+		sampleSet = in_sampleSet;
+		mutex = in_mutex;
+	}
+	
+	void Binauralizer::shut()
+	{
+		sampleSet = nullptr;
+		hrtfCache = nullptr;
+		mutex = nullptr;
+	}
+	
+	bool Binauralizer::isInit() const
+	{
+		return
+			sampleSet != nullptr &&
+			mutex != nullptr;
+	}
+	
+	void Binauralizer::setSampleSet(const HRIRSampleSet * in_sampleSet)
+	{
+		debugAssert(in_sampleSet == nullptr || in_sampleSet->sampleGrid.triangles.empty() == false); // sample set must be finalized
+		
+		sampleSet = in_sampleSet;
+	}
+	
+	void Binauralizer::setHrtfCache(HRTFCache * in_hrtfCache)
+	{
+		hrtfCache = in_hrtfCache;
+	}
+	
+	void Binauralizer::setSampleLocation(const float elevation, const float azimuth)
+	{
+		mutex->lock();
+		{
+			sampleLocation.elevation = elevation;
+			sampleLocation.azimuth = azimuth;
+		}
+		mutex->unlock();
+	}
+	
+	void Binauralizer::calculateHrir(HRIRSample & sample) const
+	{
+		// compute the HRIR, a blend between three sample points in a Delaunay triangulation of all sample points
+		
+		const HRIRSample * samples[3];
+		float sampleWeights[3];
+		
+		float elevation;
+		float azimuth;
+		
+		mutex->lock();
+		{
+			elevation = sampleLocation.elevation;
+			azimuth = sampleLocation.azimuth;
+		}
+		mutex->unlock();
+
+		sanitizeSampleLocation(elevation, azimuth);
+		
+		if (sampleSet != nullptr && sampleSet->lookup_3(elevation, azimuth, samples, sampleWeights))
+		{
+			blendHrirSamples_3(samples, sampleWeights, sample);
+		}
+		else
+		{
+			memset(&sample, 0, sizeof(sample));
+		}
+	}
+	
+	void Binauralizer::provide(const float * __restrict samples, const int numSamples)
+	{
+		int left = numSamples;
+		int done = 0;
+		
+		while (left != 0)
+		{
+			if (sampleBuffer.nextWriteIndex == SampleBuffer::kBufferSize)
+			{
+				sampleBuffer.nextWriteIndex = 0;
+			}
+			
+			const int todo = std::min(left, SampleBuffer::kBufferSize - sampleBuffer.nextWriteIndex);
+			
+			memcpy(sampleBuffer.samples + sampleBuffer.nextWriteIndex, samples + done, todo * sizeof(float));
+			
+			sampleBuffer.nextWriteIndex += todo;
+			
+			left -= todo;
+			done += todo;
+		}
+		
+		sampleBuffer.totalWriteSize += numSamples;
+	}
+	
+	bool Binauralizer::updateHrtf(const HRIRSampleData * hrir)
+	{
+		PartitionedHRTF & newHrtf = hrtfs[nextHrtfIndex];
+		
+		if (hrir != nullptr)
+		{
+			if (hrtfSource == kHrtfSource_Custom && memcmp(&hrtfHrir, hrir, sizeof(hrtfHrir)) == 0)
+				return false;
+			
+			hrtfSource = kHrtfSource_Custom;
+			hrtfHrir = *hrir;
+			
+			hrirToPartitionedHrtf(hrir->lSamples, hrir->rSamples, newHrtf);
+		}
+		else
+		{
+			float elevation;
+			float azimuth;
+			
+			mutex->lock();
+			{
+				elevation = sampleLocation.elevation;
+				azimuth = sampleLocation.azimuth;
+			}
+			mutex->unlock();
+			
+			const bool useHrtfCache = hrtfCache != nullptr && hrtfCache->sampleSet == sampleSet && sampleSet != nullptr;
+			
+			if (hrtfSource == (useHrtfCache ? kHrtfSource_HrtfCache : kHrtfSource_SampleSet) &&
+				hrtfSampleSet == sampleSet &&
+				hrtfSampleLocation.elevation == elevation &&
+				hrtfSampleLocation.azimuth == azimuth)
+			{
+				return false;
+			}
+			
+			hrtfSampleLocation.elevation = elevation;
+			hrtfSampleLocation.azimuth = azimuth;
+			
+			if (useHrtfCache)
+			{
+				// look up the HRTF for the quantized direction. we only need a new HRTF when the quantized direction changed
+				
+				sanitizeSampleLocation(elevation, azimuth);
+				
+				const int key = hrtfCache->calculateKey(elevation, azimuth);
+				
+				if (hrtfSource == kHrtfSource_HrtfCache &&
+					hrtfSampleSet == sampleSet &&
+					hrtfCacheKey == key)
+				{
+					return false;
+				}
+				
+				hrtfSource = kHrtfSource_HrtfCache;
+				hrtfSampleSet = sampleSet;
+				hrtfCacheKey = key;
+				
+				hrtfCache->lookup(key, newHrtf);
+				
+				nextHrtfIndex = 1 - nextHrtfIndex;
+				
+				return true;
+			}
+			
+			hrtfSource = kHrtfSource_SampleSet;
+			hrtfSampleSet = sampleSet;
+			
+			// compute the HRTF, a blend between the precomputed HRTFs of three sample points in a Delaunay triangulation of all sample points
+			
+			sanitizeSampleLocation(elevation, azimuth);
+			
+			const PartitionedHRTF * sampleHrtfs[3];
+			float sampleWeights[3];
+			
+			if (sampleSet != nullptr && sampleSet->lookupHrtf_3(elevation, azimuth, sampleHrtfs, sampleWeights))
+			{
+				blendPartitionedHrtfs_3(sampleHrtfs, sampleWeights, newHrtf);
+			}
+			else
+			{
+				memset(&newHrtf, 0, sizeof(newHrtf));
+			}
+		}
+		
+		nextHrtfIndex = 1 - nextHrtfIndex;
+		
+		return true;
+	}
+	
+	void Binauralizer::fillReadBuffer(const HRIRSampleData & hrir)
+	{
+		Binauralizer * self = this;
+		const HRIRSampleData * hrirPtr = &hrir;
+		
+		fillReadBuffers(&self, &hrirPtr, 1);
+	}
+	
+	void Binauralizer::fillReadBuffers(
+		Binauralizer * const * binauralizers,
+		const HRIRSampleData * const * hrirs,
+		const int numBinauralizers)
+	{
+		for (int i = 0; i < numBinauralizers; i += kMaxBatchSize)
+		{
+			const int batchSize = std::min(kMaxBatchSize, numBinauralizers - i);
+			
+			fillReadBuffersBatch(binauralizers + i, hrirs == nullptr ? nullptr : hrirs + i, batchSize);
+		}
+	}
+	
+	void Binauralizer::generateInterleaved(
+		float * __restrict samples,
+		const int numSamples,
+		const HRIRSample * hrir)
+	{
+		assert(numSamples <= SampleBuffer::kBufferSize);
+
+		int left = numSamples;
+		int done = 0;
+		
+		while (left != 0)
+		{
+			if (nextReadLocation == AUDIO_BUFFER_SIZE)
+			{
+				Binauralizer * self = this;
+				const HRIRSampleData * hrirPtr = hrir == nullptr ? nullptr : &hrir->sampleData;
+				
+				fillReadBuffers(&self, &hrirPtr, 1);
+			}
+			
+			const int todo = std::min(left, AUDIO_BUFFER_SIZE - nextReadLocation);
+			
+		#if BINAURAL_USE_SSE || BINAURAL_USE_NEON
+			debugAssert((todo % 4) == 0);
+			
+			const float4 * __restrict audioBufferL4 = (float4*)audioBufferL.samples + nextReadLocation / 4;
+			const float4 * __restrict audioBufferR4 = (float4*)audioBufferR.samples + nextReadLocation / 4;
+			float4 * __restrict samples4 = (float4*)samples;
+			
+			for (int i = 0; i < todo / 4; ++i)
+			{
+				const float4 l = audioBufferL4[i];
+				const float4 r = audioBufferR4[i];
+				
+				const float4 interleaved1 = _mm_unpacklo_ps(l, r);
+				const float4 interleaved2 = _mm_unpackhi_ps(l, r);
+				
+				samples4[i * 2 + 0] = interleaved1;
+				samples4[i * 2 + 1] = interleaved2;
+			}
+		#else
+			for (int i = 0; i < todo; ++i)
+			{
+				samples[i * 2 + 0] = audioBufferL.samples[nextReadLocation + i];
+				samples[i * 2 + 1] = audioBufferR.samples[nextReadLocation + i];
+			}
+		#endif
+			
+			samples += todo * 2;
+			
+			nextReadLocation += todo;
+			
+			left -= todo;
+			done += todo;
+		}
+	}
+	
+	void Binauralizer::generateLR(
+		float * __restrict samplesL,
+		float * __restrict samplesR,
+		const int numSamples,
+		const HRIRSample * hrir)
+	{
+		assert(numSamples <= SampleBuffer::kBufferSize);
+		
+		int left = numSamples;
+		int done = 0;
+		
+		while (left != 0)
+		{
+			if (nextReadLocation == AUDIO_BUFFER_SIZE)
+			{
+				Binauralizer * self = this;
+				const HRIRSampleData * hrirPtr = hrir == nullptr ? nullptr : &hrir->sampleData;
+				
+				fillReadBuffers(&self, &hrirPtr, 1);
+			}
+			
+			const int todo = std::min(left, AUDIO_BUFFER_SIZE - nextReadLocation);
+			
+			memcpy(samplesL + done, audioBufferL.samples + nextReadLocation, todo * sizeof(float));
+			memcpy(samplesR + done, audioBufferR.samples + nextReadLocation, todo * sizeof(float));
+			
+			nextReadLocation += todo;
+			
+			left -= todo;
+			done += todo;
+		}
+	}
+	
+	void Binauralizer::generateLR_batch(
+		Binauralizer * const * binauralizers,
+		float * const * samplesL,
+		float * const * samplesR,
+		const int numBinauralizers,
+		const int numSamples)
+	{
+		debugAssert(numSamples <= SampleBuffer::kBufferSize);
+		
+		for (int batchBegin = 0; batchBegin < numBinauralizers; batchBegin += kMaxBatchSize)
+		{
+			const int batchSize = std::min(kMaxBatchSize, numBinauralizers - batchBegin);
+			
+			Binauralizer * const * batch = binauralizers + batchBegin;
+			
+			int done[kMaxBatchSize];
+			for (int i = 0; i < batchSize; ++i)
+				done[i] = 0;
+			
+			for (;;)
+			{
+				// fill the read buffers for all binauralizers which ran out of samples, at once
+				
+				Binauralizer * binauralizersToFill[kMaxBatchSize];
+				int numBinauralizersToFill = 0;
+				
+				bool finished = true;
+				
+				for (int i = 0; i < batchSize; ++i)
+				{
+					if (done[i] == numSamples)
+						continue;
+					
+					finished = false;
+					
+					if (batch[i]->nextReadLocation == AUDIO_BUFFER_SIZE)
+					{
+						binauralizersToFill[numBinauralizersToFill] = batch[i];
+						numBinauralizersToFill++;
+					}
+				}
+				
+				if (finished)
+					break;
+				
+				fillReadBuffersBatch(binauralizersToFill, nullptr, numBinauralizersToFill);
+				
+				// copy samples from the read buffers
+				
+				for (int i = 0; i < batchSize; ++i)
+				{
+					Binauralizer * binauralizer = batch[i];
+					
+					const int todo = std::min(numSamples - done[i], AUDIO_BUFFER_SIZE - binauralizer->nextReadLocation);
+					
+					memcpy(samplesL[batchBegin + i] + done[i], binauralizer->audioBufferL.samples + binauralizer->nextReadLocation, todo * sizeof(float));
+					memcpy(samplesR[batchBegin + i] + done[i], binauralizer->audioBufferR.samples + binauralizer->nextReadLocation, todo * sizeof(float));
+					
+					binauralizer->nextReadLocation += todo;
+					
+					done[i] += todo;
+				}
+			}
+		}
+	}
+}
@@ -29,8 +29,78 @@
 
 #include "binaural.h"
 
+#include <vector>
+
 namespace binaural
 {
+	/**
+	 * Caches blended HRTFs for a sample set, for directions quantized to a configurable angular resolution.
+	 * When a binauralizer uses a HRTF cache, a moving sound source only needs a new HRTF when it moves into another
+	 * quantized direction, and the HRTF is blended only once for all binauralizers looking in the same direction.
+	 * The cache holds at most maxEntries HRTFs. When full, the least recently used HRTF is evicted.
+	 * The cache may be shared between binauralizers running on different threads, as all lookups are protected by the mutex.
+	 */
+	struct HRTFCache
+	{
+		struct Stats
+		{
+			int numLookups = 0;
+			int numMisses = 0;
+			int numEvictions = 0;
+		};
+		
+		static const int kInvalidKey = -1;
+		
+		const HRIRSampleSet * sampleSet;
+		
+		float angularResolution;
+		int numElevations;
+		int numAzimuths;
+		
+		std::vector<int> keyToEntry; // entry index for each quantized direction, or -1 when not cached
+		
+		std::vector<PartitionedHRTF*> entryHrtfs;
+		std::vector<int> entryKeys;
+		std::vector<int> entryPrev; // least recently used list. the head is the most recently used entry
+		std::vector<int> entryNext;
+		int numEntries;
+		int head;
+		int tail;
+		
+		Stats stats;
+		
+		Mutex * mutex;
+		
+		HRTFCache();
+		~HRTFCache();
+		
+		/**
+		 * Initializes the HRTF cache.
+		 * @param sampleSet The (finalized) sample set to look up and blend HRTFs from.
+		 * @param angularResolution The angular resolution (in degrees) at which directions are quantized. Must be at least 0.25 degrees.
+		 * @param maxEntries The maximum number of HRTFs kept in the cache. Each HRTF takes sizeof(PartitionedHRTF) bytes.
+		 * @param mutex The mutex used to protect lookups.
+		 */
+		void init(const HRIRSampleSet * sampleSet, const float angularResolution, const int maxEntries, Mutex * mutex);
+		void shut();
+		
+		bool isInit() const;
+		
+		/**
+		 * Quantizes the given (sanitized) direction, and returns the key identifying it.
+		 */
+		int calculateKey(const float elevation, const float azimuth) const;
+		
+		/**
+		 * (THREAD SAFE) Looks up the HRTF for the quantized direction identified by key. The HRTF is computed when it isn't cached yet.
+		 * @param key The key for the quantized direction, as returned by calculateKey.
+		 * @param hrtf The HRTF for the quantized direction.
+		 */
+		void lookup(const int key, PartitionedHRTF & hrtf);
+		
+		Stats getStats() const;
+	};
+	
 	struct Binauralizer
 	{
 		struct SampleLocation
@@ -63,16 +133,35 @@ namespace binaural
 			}
 		};
 		
+		enum HrtfSource
+		{
+			kHrtfSource_None,
+			kHrtfSource_SampleSet,
+			kHrtfSource_HrtfCache,
+			kHrtfSource_Custom
+		};
+		
 		const HRIRSampleSet * sampleSet;
+		HRTFCache * hrtfCache;
 		
 		SampleBuffer sampleBuffer;
 		
 		float overlapBuffer[AUDIO_BUFFER_SIZE];
 		
+		AudioBuffer inputSpectra[HRTF_NUM_PARTITIONS]; // frequency domain representation of the most recent input blocks, used for partitioned convolution
+		int nextInputSpectrumIndex;
+		
 		SampleLocation sampleLocation;
 		
-		HRTF hrtfs[2];
+		PartitionedHRTF hrtfs[2];
 		int nextHrtfIndex;
+		
+		// the source of the current HRTF. used to skip recomputing the HRTF when nothing changed
+		HrtfSource hrtfSource;
+		const HRIRSampleSet * hrtfSampleSet;
+		SampleLocation hrtfSampleLocation;
+		int hrtfCacheKey;
+		HRIRSampleData hrtfHrir;
 
 		AudioBuffer_Real audioBufferL;
 		AudioBuffer_Real audioBufferR;
@@ -93,6 +182,13 @@ namespace binaural
 		 */
 		void setSampleSet(const HRIRSampleSet * sampleSet);
 		
+		/**
+		 * Sets the HRTF cache used to look up HRTFs. The HRTF cache is only used when it was initialized for the same sample set as the binauralizer.
+		 * Note that with a HRTF cache, sample locations are quantized to the angular resolution of the cache.
+		 * @param hrtfCache The HRTF cache, or nullptr to blend HRTFs directly from the sample set.
+		 */
+		void setHrtfCache(HRTFCache * hrtfCache);
+		
 		/**
 		 * (THREAD SAFE) Sets the sample location used to look up the HRIR data. The location (elevation, azimuth) can be interpreted as the orientation of a sound source to be spatialized, relative to the listener's head.
 		 * @param elevation The elevation (in degrees) coordinate of the hrtf filter location.
@@ -118,6 +214,17 @@ namespace binaural
 		 * @param hrir The HRIR data to use during the binauralization process.
 		 */
 		void fillReadBuffer(const HRIRSampleData & hrir);
+		
+		/**
+		 * Fills the read buffers of multiple binauralizers at once. The Fourier transforms for all binauralizers are batched, four at a time, which is a lot faster than filling the read buffers one by one.
+		 * @param binauralizers The binauralizers whose read buffers should be filled.
+		 * @param hrirs Optional HRIR data for each binauralizer, for custom binauralization. When hrirs, or an element of hrirs, is nullptr, the HRTF is looked up using the binauralizer's sample set and sample location.
+		 * @param numBinauralizers The number of binauralizers.
+		 */
+		static void fillReadBuffers(
+			Binauralizer * const * binauralizers,
+			const HRIRSampleData * const * hrirs,
+			const int numBinauralizers);
 
 		/**
 		 * Generate interleaved binauralized stereo samples (left, right), given the samples inside the internal input buffer, and the HRIR given the last set sample location.
@@ -134,5 +241,27 @@ namespace binaural
 			float * __restrict samplesR,
 			const int numSamples,
 			const HRIRSample * hrir = nullptr);
+		
+		/**
+		 * Generate binauralized stereo samples for multiple binauralizers at once. This is equivalent to calling generateLR for each binauralizer, but batches the work for all binauralizers, see fillReadBuffers.
+		 * @param binauralizers The binauralizers to generate samples for.
+		 * @param samplesL numBinauralizers x numSamples left samples.
+		 * @param samplesR numBinauralizers x numSamples right samples.
+		 * @param numBinauralizers The number of binauralizers.
+		 * @param numSamples The number of samples to generate for each binauralizer.
+		 */
+		static void generateLR_batch(
+			Binauralizer * const * binauralizers,
+			float * const * samplesL,
+			float * const * samplesR,
+			const int numBinauralizers,
+			const int numSamples);
+		
+		/**
+		 * Updates the HRTF used for binauralization, either from the custom HRIR data, or by looking it up using the sample set and sample location. The HRTF is only recomputed when its source changed.
+		 * @param hrir Optional HRIR data, for custom binauralization.
+		 * @return True when the HRTF changed, and the output should be ramped from the old to the new HRTF.
+		 */
+		bool updateHrtf(const HRIRSampleData * hrir);
 	};
 }
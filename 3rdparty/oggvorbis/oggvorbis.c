@@ -30,6 +30,7 @@
 
 #include "vorbis/window.h"
 
+#include "vorbis/analysis.c" // encoder
 #include "vorbis/bitrate.c"
 
 #define ilog2 block_ilog2
@@ -80,5 +81,6 @@
 
 #include "vorbis/smallft.c"
 #include "vorbis/synthesis.c"
+#include "vorbis/vorbisenc.c" // encoder
 #include "vorbis/vorbisfile.c"
 #include "vorbis/window.c"
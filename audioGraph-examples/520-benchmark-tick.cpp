@@ -0,0 +1,224 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioGraph.h"
+#include "audioGraphContext.h"
+#include "audioNodeBase.h"
+#include "Timer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+This benchmark measures the per-tick overhead of ticking an audio graph. It builds graphs of trivial
+nodes, where each node depends on one or two nodes created before it, and compares the time it takes
+to tick the graph using the node map and recursive traversal (as AudioGraph::tickAudio used to do),
+with the time it takes to tick the graph using its compiled schedule.
+*/
+
+struct BenchmarkNode : AudioNodeBase
+{
+	enum Input
+	{
+		kInput_A,
+		kInput_B,
+		kInput_COUNT
+	};
+	
+	enum Output
+	{
+		kOutput_Value,
+		kOutput_COUNT
+	};
+	
+	AudioFloat valueOutput;
+	
+	BenchmarkNode()
+		: AudioNodeBase()
+		, valueOutput()
+	{
+		resizeSockets(kInput_COUNT, kOutput_COUNT);
+		addInput(kInput_A, kAudioPlugType_FloatVec);
+		addInput(kInput_B, kAudioPlugType_FloatVec);
+		addOutput(kOutput_Value, kAudioPlugType_FloatVec, &valueOutput);
+	}
+	
+	virtual void tick(const float dt) override
+	{
+		const AudioFloat * a = getInputAudioFloat(kInput_A, &AudioFloat::Zero);
+		const AudioFloat * b = getInputAudioFloat(kInput_B, &AudioFloat::Zero);
+		
+		valueOutput.setScalar(a->getScalar() * .5f + b->getScalar() * .5f + 1.f);
+	}
+};
+
+static void connect(AudioNodeBase * node, const int inputIndex, AudioNodeBase * predep)
+{
+	node->inputs[inputIndex].connectTo(predep->outputs[BenchmarkNode::kOutput_Value]);
+	node->predeps.push_back(predep);
+}
+
+static AudioGraph * createGraph(AudioGraphContext * context, const int numNodes)
+{
+	AudioGraph * audioGraph = new AudioGraph(context, false);
+	
+	pushAudioGraph(audioGraph);
+	{
+		std::vector<AudioNodeBase*> nodes;
+		
+		for (int i = 0; i < numNodes; ++i)
+		{
+			AudioNodeBase * node = new BenchmarkNode();
+			
+			if (i >= 1)
+				connect(node, BenchmarkNode::kInput_A, nodes[rand() % i]);
+			if (i >= 2 && (rand() % 2) == 0)
+				connect(node, BenchmarkNode::kInput_B, nodes[rand() % i]);
+			
+			nodes.push_back(node);
+			
+			// note : use random node ids, so the order of the node map doesn't match the order of creation
+			
+			GraphNodeId nodeId;
+			
+			do
+			{
+				nodeId = 1 + (rand() % (numNodes * 10));
+			} while (audioGraph->nodes.count(nodeId) != 0);
+			
+			audioGraph->nodes[nodeId] = node;
+		}
+		
+		audioGraph->updateSchedule();
+	}
+	popAudioGraph();
+	
+	return audioGraph;
+}
+
+static void tickUsingTraversal(AudioGraph * audioGraph, const float dt)
+{
+	pushAudioGraph(audioGraph);
+	{
+		audioGraph->beginTick();
+		
+		setCurrentAudioGraphTraversalId(audioGraph->currentTickTraversalId);
+		
+		for (auto & i : audioGraph->nodes)
+		{
+			AudioNodeBase * node = i.second;
+			
+			if (node->lastTickTraversalId != audioGraph->currentTickTraversalId)
+			{
+				node->traverseTick(audioGraph->currentTickTraversalId, dt);
+			}
+		}
+		
+		clearCurrentAudioGraphTraversalId();
+		
+		audioGraph->endTick(dt);
+	}
+	popAudioGraph();
+}
+
+static float getResult(AudioGraph * audioGraph)
+{
+	float result = 0.f;
+	
+	for (auto & i : audioGraph->nodes)
+		result += i.second->outputs[BenchmarkNode::kOutput_Value].getAudioFloat().getScalar();
+	
+	return result;
+}
+
+int main(int argc, char * argv[])
+{
+	AudioMutex mutex_mem;
+	AudioMutex mutex_reg;
+	mutex_mem.init();
+	mutex_reg.init();
+	
+	AudioGraphContext context;
+	context.init(&mutex_mem, &mutex_reg, nullptr);
+	
+	const float dt = AUDIO_UPDATE_SIZE / float(SAMPLE_RATE);
+	
+	const int kNumTicks = 10000;
+	
+	const int numNodesList[] = { 10, 100, 1000 };
+	
+	printf("nodes | traversal (us/tick) | schedule (us/tick) | speedup\n");
+	
+	for (const int numNodes : numNodesList)
+	{
+		srand(numNodes);
+		
+		AudioGraph * audioGraph = createGraph(&context, numNodes);
+		
+		// warm up and verify both methods produce the same result
+		
+		tickUsingTraversal(audioGraph, dt);
+		const float result1 = getResult(audioGraph);
+		audioGraph->tickAudio(dt, false);
+		const float result2 = getResult(audioGraph);
+		
+		if (result1 != result2)
+			printf("error: traversal and schedule produce different results!\n");
+		
+		// measure the time it takes to tick the graph using both methods
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		for (int i = 0; i < kNumTicks; ++i)
+			tickUsingTraversal(audioGraph, dt);
+		
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		for (int i = 0; i < kNumTicks; ++i)
+			audioGraph->tickAudio(dt, false);
+		
+		const uint64_t t3 = g_TimerRT.TimeUS_get();
+		
+		const double traversalTime = (t2 - t1) / double(kNumTicks);
+		const double scheduleTime = (t3 - t2) / double(kNumTicks);
+		
+		printf("%5d | %19.3f | %18.3f | %.2fx\n",
+			numNodes,
+			traversalTime,
+			scheduleTime,
+			traversalTime / scheduleTime);
+		
+		delete audioGraph;
+		audioGraph = nullptr;
+	}
+	
+	context.shut();
+	
+	mutex_mem.shut();
+	mutex_reg.shut();
+	
+	return 0;
+}
@@ -0,0 +1,237 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioGraph.h"
+#include "audioGraphContext.h"
+#include "audioGraphManager.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+
+#if defined(MACOS) || defined(LINUX)
+	#include <unistd.h>
+#endif
+
+#if defined(WINDOWS)
+	#include <direct.h>
+#endif
+
+#ifdef WIN32
+	#define chdir _chdir
+#endif
+
+/*
+This stress test hammers an audio graph with memf, mems and control value updates, events and flags from the
+main thread, while a simulated audio thread ticks the graph manager at the rate at which a real audio thread
+would. The graph contains memf, mems, event, flags and (shared and per-instance) control value nodes, so the
+values pass through the same path as they would in an app. The main thread also holds the control values lock
+for long periods of time, the way a UI editing control values might do.
+The audio thread measures the time it takes to tick the graph manager, and counts the number of deadline misses,
+which would happen if the audio thread were blocked by the main thread.
+*/
+
+static const int kTestDurationInSeconds = 5;
+
+int main(int argc, char * argv[])
+{
+#if defined(CHIBI_RESOURCE_PATH)
+	if (chdir(CHIBI_RESOURCE_PATH) != 0)
+		return -1;
+#endif
+
+	typedef std::chrono::steady_clock Clock;
+	
+	AudioMutex audioMutex;
+	audioMutex.init();
+	
+	AudioGraphManager_Basic audioGraphMgr(false);
+	audioGraphMgr.init(&audioMutex, nullptr);
+	
+	AudioGraphContext * context = audioGraphMgr.getContext();
+	
+	AudioGraphInstance * instance = audioGraphMgr.createInstance("530-stress-main-to-audio.xml");
+	
+	if (instance == nullptr)
+	{
+		printf("failed to create the audio graph instance\n");
+		return -1;
+	}
+	
+	AudioGraph * audioGraph = instance->audioGraph;
+	
+	// resolve the ids the audio thread uses to check the values it receives. the nodes have registered these during initialization
+	
+	const int memfId = audioGraph->findMemf("value");
+	const int eventId = audioGraph->registerEvent("event");
+	
+	std::atomic<bool> stop(false);
+	
+	// audio thread
+	
+	int numTicks = 0;
+	int numDeadlineMisses = 0;
+	int maxTickTime = 0;
+	int numEventsReceived = 0;
+	int numOrderErrors = 0;
+	
+	std::thread audioThread([&]()
+	{
+		const float dt = AUDIO_UPDATE_SIZE / float(SAMPLE_RATE);
+		
+		const auto period = std::chrono::microseconds(int64_t(AUDIO_UPDATE_SIZE) * 1000000 / SAMPLE_RATE);
+		
+		auto deadline = Clock::now() + period;
+		
+		float lastValue = 0.f;
+		
+		while (stop == false)
+		{
+			std::this_thread::sleep_until(deadline - period);
+			
+			const auto t1 = Clock::now();
+			
+			audioGraphMgr.tickAudio(dt);
+			
+			const auto t2 = Clock::now();
+			
+			pushAudioGraph(audioGraph);
+			{
+				const AudioGraph::Memf memf = audioGraph->getMemf(memfId, false);
+				
+				if (memf.value1_audioThread < lastValue)
+					numOrderErrors++;
+				lastValue = memf.value1_audioThread;
+				
+				if (audioGraph->isEventTriggered(eventId))
+					numEventsReceived++;
+			}
+			popAudioGraph();
+			
+			const int tickTime = std::chrono::duration_cast<std::chrono::microseconds>(t2 - t1).count();
+			
+			if (tickTime > maxTickTime)
+				maxTickTime = tickTime;
+			
+			// note : we only count the time spent ticking the graph manager. the scheduler waking us up late isn't our concern here
+			
+			if (t2 - t1 > period)
+				numDeadlineMisses++;
+			
+			numTicks++;
+			
+			deadline += period;
+		}
+	});
+	
+	// main thread
+	
+	int numIterations = 0;
+	int numEventsSent = 0;
+	int numAudioFlagsSeen = 0;
+	
+	const auto endTime = Clock::now() + std::chrono::seconds(kTestDurationInSeconds);
+	
+	while (Clock::now() < endTime)
+	{
+		audioGraph->setMemf("value", float(numIterations));
+		
+		audioGraph->triggerEvent("event");
+		numEventsSent++;
+		
+		if ((numIterations % 1000) == 0)
+		{
+			// the flags node in the graph sets the 'audio' flag each time the event is triggered
+			
+			if (audioGraph->isFlagSet("audio"))
+			{
+				numAudioFlagsSeen++;
+				
+				audioGraph->resetFlag("audio");
+			}
+			
+			char text[32];
+			sprintf(text, "iteration %d", numIterations);
+			audioGraph->setMems("text", text);
+		}
+		
+		if ((numIterations % 100000) == 0)
+		{
+			// simulate a slow UI holding on to the control values for a while
+			
+			context->lockControlValues();
+			audioGraph->lockControlValues();
+			{
+				for (auto & controlValue : context->controlValues)
+					controlValue.desiredX = (numIterations / 100000) % 2;
+				for (auto & controlValue : audioGraph->controlValues)
+					controlValue.desiredX = (numIterations / 100000) % 2;
+				
+				std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			}
+			audioGraph->unlockControlValues();
+			context->unlockControlValues();
+		}
+		
+		numIterations++;
+	}
+	
+	stop = true;
+	audioThread.join();
+	
+	printf("main thread: iterations: %d, events sent: %d, audio flags seen: %d\n",
+		numIterations,
+		numEventsSent,
+		numAudioFlagsSeen);
+	printf("audio thread: ticks: %d, deadline misses: %d, max tick time: %dus, events received: %d, memf order errors: %d\n",
+		numTicks,
+		numDeadlineMisses,
+		maxTickTime,
+		numEventsReceived,
+		numOrderErrors);
+	
+	context->lockControlValues();
+	audioGraph->lockControlValues();
+	{
+		for (auto & controlValue : context->controlValues)
+			printf("shared control value %s: desired: %.2f, current: %.2f\n", controlValue.name.c_str(), controlValue.desiredX, controlValue.currentX);
+		for (auto & controlValue : audioGraph->controlValues)
+			printf("per-instance control value %s: desired: %.2f, current: %.2f\n", controlValue.name.c_str(), controlValue.desiredX, controlValue.currentX);
+	}
+	audioGraph->unlockControlValues();
+	context->unlockControlValues();
+	
+	audioGraph->unregisterEvent("event");
+	
+	audioGraphMgr.free(instance, false);
+	
+	audioGraphMgr.shut();
+	
+	audioMutex.shut();
+	
+	return (numDeadlineMisses == 0 && numOrderErrors == 0) ? 0 : -1;
+}
@@ -0,0 +1,261 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "audioKernels.h"
+#include "audioTypes.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/*
+This benchmark verifies the vectorized audio kernels produce the same results as the scalar reference
+kernels, and measures the time it takes to run each kernel, for each set of kernels supported by the CPU.
+Buffers are deliberately misaligned and have sizes which aren't a multiple of the vector size, to verify
+the unaligned and tail cases. The benchmark itself runs on buffers of AUDIO_UPDATE_SIZE samples.
+*/
+
+static const int kMaxSamples = AUDIO_UPDATE_SIZE + 33;
+
+struct Buffers
+{
+	float dst[kMaxSamples + 1];
+	float src1[kMaxSamples + 1];
+	float src2[kMaxSamples + 1];
+	float src3[kMaxSamples + 1];
+};
+
+static void randomize(Buffers & b, const int seed)
+{
+	srand(seed);
+	
+	for (int i = 0; i < kMaxSamples + 1; ++i)
+	{
+		b.dst[i] = (rand() / float(RAND_MAX)) * 4.f - 2.f;
+		b.src1[i] = (rand() / float(RAND_MAX)) * 4.f - 2.f;
+		b.src2[i] = (rand() / float(RAND_MAX)) * 4.f - 2.f;
+		b.src3[i] = (rand() / float(RAND_MAX));
+	}
+}
+
+// runs a kernel on (misaligned) buffers. returns the result of kernels returning a value
+
+static float runKernel(const AudioKernels & k, const int kernelIndex, Buffers & b, const int offset, const int numSamples)
+{
+	float * dst = b.dst + offset;
+	const float * src1 = b.src1 + offset;
+	const float * src2 = b.src2 + offset;
+	const float * src3 = b.src3 + offset;
+	
+	switch (kernelIndex)
+	{
+	case 0: k.setZero(dst, numSamples); break;
+	case 1: k.fill(dst, numSamples, .5f); break;
+	case 2: k.mul(dst, numSamples, .5f); break;
+	case 3: k.mulBuffer(dst, src1, numSamples); break;
+	case 4: k.ramp(dst, numSamples, .25f, 1.f); break;
+	case 5: k.setMul(dst, src1, numSamples, .5f); break;
+	case 6: k.setMulBuffer(dst, src1, src2, numSamples); break;
+	case 7: k.add(dst, src1, numSamples); break;
+	case 8: k.addMul(dst, src1, numSamples, .5f); break;
+	case 9: k.addMulBuffer(dst, src1, src2, numSamples); break;
+	case 10:
+		{
+			const float * src[4] = { src1, src2, src3, src1 };
+			const float scale[4] = { .5f, -.25f, 1.f, .125f };
+			k.addMul4(dst, src, scale, numSamples);
+		}
+		break;
+	case 11: k.setAddMul(dst, src1, src2, numSamples, .5f); break;
+	case 12: k.mulMul(dst, src1, numSamples, .5f); break;
+	case 13: k.mulMulBuffer(dst, src1, src2, numSamples); break;
+	case 14: k.dryWet(dst, src1, src2, numSamples, .25f); break;
+	case 15: k.dryWetBuffer(dst, src1, src2, src3, numSamples); break;
+	case 16: return k.sum(src1, numSamples);
+	case 17: return k.peak(src1, numSamples);
+	case 18: k.clipHard(dst, numSamples); break;
+	case 19: k.clipSigmoidSqrt(dst, numSamples); break;
+	case 20: k.clipSigmoidFast(dst, numSamples); break;
+	}
+	
+	return 0.f;
+}
+
+static const char * kKernelNames[] =
+{
+	"setZero",
+	"fill",
+	"mul",
+	"mulBuffer",
+	"ramp",
+	"setMul",
+	"setMulBuffer",
+	"add",
+	"addMul",
+	"addMulBuffer",
+	"addMul4",
+	"setAddMul",
+	"mulMul",
+	"mulMulBuffer",
+	"dryWet",
+	"dryWetBuffer",
+	"sum",
+	"peak",
+	"clipHard",
+	"clipSigmoidSqrt",
+	"clipSigmoidFast"
+};
+
+static const int kNumKernels = sizeof(kKernelNames) / sizeof(kKernelNames[0]);
+
+static bool isClose(const float a, const float b)
+{
+	// note : the vectorized kernels may perform operations in a different order (sum, ramp), so allow for a small error
+	
+	return fabsf(a - b) <= 1e-5f * (1.f + fabsf(a) + fabsf(b));
+}
+
+static bool verifyKernels(const AudioKernels & reference, const AudioKernels & k)
+{
+	bool result = true;
+	
+	Buffers * b1 = new Buffers();
+	Buffers * b2 = new Buffers();
+	
+	for (int kernelIndex = 0; kernelIndex < kNumKernels; ++kernelIndex)
+	{
+		for (int offset = 0; offset < 2; ++offset)
+		{
+			for (int numSamples = 0; numSamples <= kMaxSamples; ++numSamples)
+			{
+				randomize(*b1, numSamples);
+				randomize(*b2, numSamples);
+				
+				const float value1 = runKernel(reference, kernelIndex, *b1, offset, numSamples);
+				const float value2 = runKernel(k, kernelIndex, *b2, offset, numSamples);
+				
+				bool equal = isClose(value1, value2);
+				
+				for (int i = 0; i < kMaxSamples + 1; ++i)
+					equal &= isClose(b1->dst[i], b2->dst[i]);
+				
+				if (equal == false)
+				{
+					printf("error: %s: %s produces a different result from %s. offset=%d, numSamples=%d\n",
+						k.name,
+						kKernelNames[kernelIndex],
+						reference.name,
+						offset,
+						numSamples);
+					
+					result = false;
+					
+					break;
+				}
+			}
+		}
+	}
+	
+	delete b1;
+	b1 = nullptr;
+	
+	delete b2;
+	b2 = nullptr;
+	
+	return result;
+}
+
+static double measureKernel(const AudioKernels & k, const int kernelIndex, Buffers & b)
+{
+	const int kNumIterations = 100000;
+	
+	// note : the kernels are run repeatedly on the same buffers. flush denormals like the audio thread does,
+	//        so we don't measure the cost of denormals as the values decay
+	
+	SCOPED_FLUSH_DENORMALS;
+	
+	volatile float sink = 0.f;
+	
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+	
+	for (int i = 0; i < kNumIterations; ++i)
+		sink = sink + runKernel(k, kernelIndex, b, 0, AUDIO_UPDATE_SIZE);
+	
+	const uint64_t t2 = g_TimerRT.TimeUS_get();
+	
+	return (t2 - t1) * 1000.0 / kNumIterations;
+}
+
+int main(int argc, char * argv[])
+{
+	const AudioKernels * kernels[8];
+	const int numKernels = getAvailableAudioKernels(kernels, 8);
+	
+	printf("available kernels:");
+	for (int i = 0; i < numKernels; ++i)
+		printf(" %s", kernels[i]->name);
+	printf("\nselected kernels: %s\n", getAudioKernels().name);
+	
+	// verify the vectorized kernels against the scalar reference kernels
+	
+	bool success = true;
+	
+	for (int i = 1; i < numKernels; ++i)
+		success &= verifyKernels(*kernels[0], *kernels[i]);
+	
+	printf("verification %s\n", success ? "passed" : "failed");
+	
+	// measure the time it takes to run each kernel
+	
+	Buffers * b = new Buffers();
+	
+	printf("%-16s", "kernel (ns/call)");
+	for (int i = 0; i < numKernels; ++i)
+		printf(" | %8s", kernels[i]->name);
+	printf("\n");
+	
+	for (int kernelIndex = 0; kernelIndex < kNumKernels; ++kernelIndex)
+	{
+		printf("%-16s", kKernelNames[kernelIndex]);
+		
+		for (int i = 0; i < numKernels; ++i)
+		{
+			randomize(*b, 0);
+			
+			printf(" | %8.1f", measureKernel(*kernels[i], kernelIndex, *b));
+		}
+		
+		printf("\n");
+	}
+	
+	delete b;
+	b = nullptr;
+	
+	return success ? 0 : -1;
+}
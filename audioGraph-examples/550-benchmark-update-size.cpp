@@ -0,0 +1,217 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioGraph.h"
+#include "audioGraphContext.h"
+#include "audioNodeBase.h"
+#include "audioTypeDB.h"
+#include "graph.h"
+#include "graph_typeDefinitionLibrary.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+
+/*
+This benchmark renders the same audio graph offline using different update sizes. The update size is
+chosen when creating the audio graph context. Smaller update sizes give lower latency when running live,
+while larger update sizes amortize the per-tick overhead of ticking the graph, which is better suited for
+offline rendering. For each update size, it reports the time per tick, the time per sample, and the
+realtime factor (how many seconds of audio are rendered per second). It also verifies the rendered audio
+is the same for each update size, as nodes like sample.delay, filter.biquad and impulse.response process
+their samples one by one, and shouldn't depend on how the samples are divided into ticks.
+*/
+
+static const int kNumVoices = 16;
+static const float kRenderTime = 10.f;
+
+static GraphNodeId addNode(Graph & graph, const char * typeName, const std::map<std::string, std::string> & inputValues)
+{
+	GraphNode node;
+	node.id = graph.allocNodeId();
+	node.typeName = typeName;
+	node.inputValues = inputValues;
+	
+	graph.addNode(node);
+	
+	return node.id;
+}
+
+static void addLink(Graph & graph, const GraphNodeId nodeId, const int inputIndex, const GraphNodeId srcNodeId, const int outputIndex)
+{
+	GraphLink link;
+	link.id = graph.allocLinkId();
+	link.srcNodeId = nodeId;
+	link.srcNodeSocketIndex = inputIndex;
+	link.dstNodeId = srcNodeId;
+	link.dstNodeSocketIndex = outputIndex;
+	
+	graph.addLink(link, false);
+}
+
+static GraphNodeId createGraph(Graph & graph)
+{
+	// create a number of voices, each consisting of sine -> biquad -> delay -> impulse response, and sum them
+	
+	GraphNodeId sumNodeId = kGraphNodeIdInvalid;
+	
+	for (int i = 0; i < kNumVoices; ++i)
+	{
+		char frequency[32];
+		sprintf(frequency, "%d", 110 * (i + 1));
+		
+		char delay[32];
+		sprintf(delay, "%f", .001f * (i + 1));
+		
+		const GraphNodeId sineNodeId = addNode(graph, "audio.sine", { { "frequency", frequency }, { "a", "-1" }, { "b", "1" } });
+		const GraphNodeId biquadNodeId = addNode(graph, "filter.biquad", { { "frequency", "2000" } });
+		const GraphNodeId delayNodeId = addNode(graph, "sample.delay", { { "maxDelay", "0.1" }, { "delay1", delay } });
+		const GraphNodeId responseNodeId = addNode(graph, "impulse.response", { { "frequency", frequency }, { "decayPerMs", "0.1" } });
+		
+		addLink(graph, biquadNodeId, 0, sineNodeId, 0);
+		addLink(graph, delayNodeId, 0, biquadNodeId, 0);
+		addLink(graph, responseNodeId, 0, delayNodeId, 0);
+		
+		if (sumNodeId == kGraphNodeIdInvalid)
+		{
+			sumNodeId = responseNodeId;
+		}
+		else
+		{
+			const GraphNodeId addNodeId = addNode(graph, "math.add", { });
+			
+			addLink(graph, addNodeId, 0, sumNodeId, 0);
+			addLink(graph, addNodeId, 1, responseNodeId, 0);
+			
+			sumNodeId = addNodeId;
+		}
+	}
+	
+	return sumNodeId;
+}
+
+static void captureOutput(const AudioFloat & value, const int numSamples, std::vector<float> & samples)
+{
+	// note : we're outside of the graph's tick here, so we avoid AudioFloat::expand, which depends on the current update size
+	
+	for (int i = 0; i < numSamples; ++i)
+		samples.push_back(value.isScalar ? value.getScalar() : value.samples[i]);
+}
+
+int main(int argc, char * argv[])
+{
+	AudioMutex mutex_mem;
+	AudioMutex mutex_reg;
+	mutex_mem.init();
+	mutex_reg.init();
+	
+	Graph_TypeDefinitionLibrary * typeDefinitionLibrary = createAudioTypeDefinitionLibrary();
+	
+	Graph graph;
+	const GraphNodeId outputNodeId = createGraph(graph);
+	
+	const int updateSizeList[] = { 64, 128, 256, 512 };
+	
+	std::vector<float> referenceSamples;
+	
+	printf("update size | us/tick | ns/sample | realtime factor | max difference\n");
+	
+	for (const int updateSize : updateSizeList)
+	{
+		if (updateSize > AUDIO_MAX_UPDATE_SIZE)
+		{
+			printf("%11d | skipped. update size exceeds AUDIO_MAX_UPDATE_SIZE (%d)\n", updateSize, AUDIO_MAX_UPDATE_SIZE);
+			continue;
+		}
+		
+		AudioGraphContext context;
+		context.init(&mutex_mem, &mutex_reg, nullptr, updateSize);
+		
+		AudioGraph * audioGraph = constructAudioGraph(graph, typeDefinitionLibrary, &context, false);
+		
+		const AudioFloat & output = audioGraph->nodes[outputNodeId]->outputs[0].getAudioFloat();
+		
+		const float dt = updateSize / float(SAMPLE_RATE);
+		
+		const int numTicks = int(ceilf(kRenderTime * SAMPLE_RATE / updateSize));
+		
+		std::vector<float> samples;
+		samples.reserve(numTicks * updateSize);
+		
+		// render the graph. note we capture the output after the timing, so only the tick itself is measured
+		
+		uint64_t tickTime = 0;
+		
+		for (int i = 0; i < numTicks; ++i)
+		{
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			audioGraph->tickAudio(dt, false);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			tickTime += t2 - t1;
+			
+			captureOutput(output, updateSize, samples);
+		}
+		
+		// compare the result against the first update size
+		
+		if (referenceSamples.empty())
+			referenceSamples = samples;
+		
+		const size_t numSamplesToCompare = std::min(samples.size(), referenceSamples.size());
+		
+		float maxDifference = 0.f;
+		
+		for (size_t i = 0; i < numSamplesToCompare; ++i)
+			maxDifference = fmaxf(maxDifference, fabsf(samples[i] - referenceSamples[i]));
+		
+		const double renderTime = numTicks * updateSize / double(SAMPLE_RATE);
+		
+		printf("%11d | %7.2f | %9.2f | %14.1fx | %g%s\n",
+			updateSize,
+			tickTime / double(numTicks),
+			tickTime * 1000.0 / (numTicks * double(updateSize)),
+			renderTime / (tickTime / 1000000.0),
+			maxDifference,
+			maxDifference > 1e-4f ? " (error: output depends on the update size!)" : "");
+		
+		delete audioGraph;
+		audioGraph = nullptr;
+		
+		context.shut();
+	}
+	
+	delete typeDefinitionLibrary;
+	typeDefinitionLibrary = nullptr;
+	
+	mutex_mem.shut();
+	mutex_reg.shut();
+	
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "audioGraph.h"
+#include "audioGraphManager.h"
+#include "audioOfflineRenderer.h"
+#include "audioUpdateHandler.h"
+#include "audioVoiceManager.h"
+#include "Debugging.h"
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(MACOS) || defined(LINUX)
+	#include <unistd.h>
+#endif
+
+#if defined(WINDOWS)
+	#include <direct.h>
+#endif
+
+#ifdef WIN32
+	#define chdir _chdir
+#endif
+
+#define CHANNEL_COUNT 64
+
+/*
+Renders an audio graph offline, as fast as possible, without opening an audio device.
+
+usage: 560-render-offline [graph.xml] [output.wav|output.ogg|-] [duration] [updateSize] [numThreads]
+
+When the output file is '-', nothing is written and the render is only used for benchmarking.
+*/
+
+int main(int argc, char * argv[])
+{
+#if defined(CHIBI_RESOURCE_PATH)
+	if (chdir(CHIBI_RESOURCE_PATH) != 0)
+		return -1;
+#endif
+
+	const char * graphFilename = argc > 1 ? argv[1] : "sweetStuff6.xml";
+	const char * outputFilename = argc > 2 ? argv[2] : "-";
+	const double duration = argc > 3 ? atof(argv[3]) : 10.0;
+	const int updateSize = argc > 4 ? atoi(argv[4]) : AUDIO_UPDATE_SIZE;
+	const int numThreads = argc > 5 ? atoi(argv[5]) : 0;
+	
+	// initialize audio related systems
+	
+	AudioMutex mutex;
+	mutex.init();
+
+	AudioVoiceManagerBasic voiceMgr;
+	voiceMgr.init(&mutex, CHANNEL_COUNT);
+	voiceMgr.outputStereo = true;
+
+	AudioGraphManager_Basic audioGraphMgr(true);
+	audioGraphMgr.init(&mutex, &voiceMgr, updateSize);
+	
+	if (numThreads > 0)
+		audioGraphMgr.enableParallelTick(numThreads);
+
+	AudioUpdateHandler audioUpdateHandler;
+	audioUpdateHandler.init(&mutex, &voiceMgr, &audioGraphMgr);
+	
+	// create an audio graph instance
+	
+	AudioGraphInstance * instance = audioGraphMgr.createInstance(graphFilename);
+	
+	// render
+	
+	AudioOfflineRenderer renderer;
+	renderer.init(&audioUpdateHandler, 2, updateSize);
+	
+	bool result;
+	
+	if (strcmp(outputFilename, "-") == 0)
+		result = renderer.render(duration, nullptr);
+	else
+		result = renderer.renderToFile(outputFilename, duration);
+	
+	printf("rendered %.2f seconds of audio in %.2f seconds. realtime factor: %.2fx%s\n",
+		renderer.getRenderedDuration(),
+		renderer.renderTimeUs / 1000000.0,
+		renderer.getRealtimeFactor(),
+		result ? "" : " (failed)");
+	
+	renderer.shut();
+	
+	// free the audio graph instance
+	
+	audioGraphMgr.free(instance, false);
+	
+	// shut down audio related systems
+	
+	audioUpdateHandler.shut();
+
+	audioGraphMgr.shut();
+	
+	voiceMgr.shut();
+
+	mutex.shut();
+
+	return result ? 0 : -1;
+}
@@ -0,0 +1,290 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "audioVoiceManager.h"
+#include "soundmix.h"
+#include "Timer.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+/*
+This benchmark measures the throughput of AudioVoiceMixer in voices per millisecond, and compares it with a
+reference mixer which mixes voices one at a time, straight into the interleaved output (as AudioVoiceManager
+used to do). Half of the voices are active. The other half are either silent, or ramped down to zero, and
+should be culled by the mixer. The output of the mixer is verified against the output of the reference mixer.
+*/
+
+static const int kNumVoices = 256;
+static const int kNumVerifyTicks = 32;
+static const int kNumBenchmarkTicks = 2000;
+
+static const int kTableSize = 4096;
+
+// a cheap audio source, so the benchmark measures the cost of mixing, rather than the cost of generating samples
+
+struct TableSource : AudioSource
+{
+	const float * table = nullptr;
+	int position = 0;
+	
+	virtual void generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples) override
+	{
+		int i = 0;
+		
+		while (i < numSamples)
+		{
+			const int numSamplesToCopy = std::min(numSamples - i, kTableSize - position);
+			
+			memcpy(samples + i, table + position, numSamplesToCopy * sizeof(float));
+			
+			i += numSamplesToCopy;
+			position = (position + numSamplesToCopy) & (kTableSize - 1);
+		}
+	}
+};
+
+struct VoiceSet
+{
+	std::vector<float> table;
+	std::vector<float> silentTable;
+	
+	TableSource sources[kNumVoices];
+	AudioVoice voices[kNumVoices];
+	AudioVoice * voicePtrs[kNumVoices];
+	
+	VoiceSet(const int numChannels)
+	{
+		table.resize(kTableSize);
+		silentTable.resize(kTableSize, 0.f);
+		
+		for (int i = 0; i < kTableSize; ++i)
+			table[i] = sinf(i * 2.f * float(M_PI) / kTableSize);
+		
+		for (int i = 0; i < kNumVoices; ++i)
+		{
+			auto & voice = voices[i];
+			
+			sources[i].table = (i % 4 == 1) ? silentTable.data() : table.data();
+			sources[i].position = (i * 37) & (kTableSize - 1);
+			
+			voice.source = &sources[i];
+			voice.channelIndex = i % numChannels;
+			voice.speaker = (i % 3 == 0) ? AudioVoice::kSpeaker_Left : (i % 3 == 1) ? AudioVoice::kSpeaker_Right : AudioVoice::kSpeaker_None;
+			voice.gain = .5f + (i % 7) / 14.f;
+			
+			if (i % 4 == 3)
+			{
+				// ramped down to zero
+				
+				voice.rampInfo.ramp = false;
+				voice.rampInfo.rampValue = 0.f;
+				voice.rampInfo.isRamped = false;
+			}
+			
+			voicePtrs[i] = &voice;
+		}
+	}
+};
+
+// the reference mixer, which mixes voices one by one into the interleaved output
+
+static void mixReference(
+	AudioVoice ** voices, const int numVoices,
+	float * __restrict samples, const int numSamples, const int numChannels,
+	const AudioVoiceManager::OutputMode outputMode)
+{
+	const int numOutputChannels = outputMode == AudioVoiceManager::kOutputMode_Stereo ? 2 : numChannels;
+	
+	memset(samples, 0, numSamples * numOutputChannels * sizeof(float));
+	
+	float * voiceSamples = (float*)alloca(numSamples * sizeof(float));
+	
+	for (int v = 0; v < numVoices; ++v)
+	{
+		auto & voice = *voices[v];
+		
+		voice.source->generate(voiceSamples, numSamples);
+		
+		audioBufferMul(voiceSamples, numSamples, voice.gain);
+		
+		voice.applyLimiter(voiceSamples, numSamples, 1.f);
+		
+		voice.applyRamping(voiceSamples, numSamples, SAMPLE_RATE * voice.rampInfo.rampTime, true);
+		
+		if (outputMode == AudioVoiceManager::kOutputMode_Stereo)
+		{
+			const bool left = voice.speaker != AudioVoice::kSpeaker_Right;
+			const bool right = voice.speaker != AudioVoice::kSpeaker_Left;
+			
+			for (int i = 0; i < numSamples; ++i)
+			{
+				if (left)
+					samples[i * 2 + 0] += voiceSamples[i];
+				if (right)
+					samples[i * 2 + 1] += voiceSamples[i];
+			}
+		}
+		else
+		{
+			float * __restrict dstPtr = samples + voice.channelIndex;
+			
+			for (int i = 0; i < numSamples; ++i)
+			{
+				*dstPtr += voiceSamples[i];
+				
+				dstPtr += numChannels;
+			}
+		}
+	}
+}
+
+// runs a mixer. when mixer is nullptr, the reference mixer is used
+
+static void mix(AudioVoiceMixer * mixer, VoiceSet & voiceSet, float * samples, const int numChannels, const AudioVoiceManager::OutputMode outputMode)
+{
+	if (mixer == nullptr)
+	{
+		mixReference(voiceSet.voicePtrs, kNumVoices, samples, AUDIO_UPDATE_SIZE, numChannels, outputMode);
+	}
+	else
+	{
+		mixer->mix(
+			voiceSet.voicePtrs, kNumVoices,
+			samples, AUDIO_UPDATE_SIZE, numChannels,
+			true, 1.f,
+			true,
+			1.f,
+			outputMode, true);
+	}
+}
+
+static bool runBenchmark(const char * name, const int numChannels, const AudioVoiceManager::OutputMode outputMode)
+{
+	const int numOutputChannels = outputMode == AudioVoiceManager::kOutputMode_Stereo ? 2 : numChannels;
+	
+	printf("%s (%d voices, %d output channels):\n", name, kNumVoices, numOutputChannels);
+	
+	std::vector<float> referenceSamples(AUDIO_UPDATE_SIZE * numOutputChannels * kNumVerifyTicks);
+	std::vector<float> samples(AUDIO_UPDATE_SIZE * numOutputChannels * kNumVerifyTicks);
+	
+	bool result = true;
+	
+	const int kNumThreads[] = { -1, 0, 1, 3 }; // -1 = reference mixer, 0 = mixer without worker threads
+	
+	for (const int numThreads : kNumThreads)
+	{
+		AudioVoiceMixer * mixer = nullptr;
+		
+		if (numThreads >= 0)
+		{
+			mixer = new AudioVoiceMixer();
+			
+			if (numThreads > 0)
+				mixer->enableParallelMixing(numThreads);
+		}
+		
+		// verify
+		
+		VoiceSet * voiceSet = new VoiceSet(numChannels);
+		
+		float * dst = (mixer == nullptr) ? referenceSamples.data() : samples.data();
+		
+		for (int i = 0; i < kNumVerifyTicks; ++i)
+			mix(mixer, *voiceSet, dst + AUDIO_UPDATE_SIZE * numOutputChannels * i, numChannels, outputMode);
+		
+		float maxDifference = 0.f;
+		
+		if (mixer != nullptr)
+		{
+			for (size_t i = 0; i < samples.size(); ++i)
+				maxDifference = fmaxf(maxDifference, fabsf(samples[i] - referenceSamples[i]));
+		}
+		
+		// note : the mixer accumulates voices in a different order, so allow for a small error
+		
+		const bool equal = maxDifference <= 1e-4f;
+		
+		result &= equal;
+		
+		// measure
+		
+		SCOPED_FLUSH_DENORMALS;
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		for (int i = 0; i < kNumBenchmarkTicks; ++i)
+			mix(mixer, *voiceSet, samples.data(), numChannels, outputMode);
+		
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		const double ms = (t2 - t1) / 1000.0;
+		
+		char variantName[64];
+		if (mixer == nullptr)
+			sprintf(variantName, "reference");
+		else
+			sprintf(variantName, "mixer, %d worker threads", numThreads);
+		
+		printf("\t%-26s: %8.1f voices/ms, %6.2f us/tick", variantName, kNumVoices * kNumBenchmarkTicks / ms, (t2 - t1) / double(kNumBenchmarkTicks));
+		
+		if (mixer != nullptr)
+		{
+			const auto & stats = mixer->getStats();
+			
+			printf(", mixed: %d, culled: %d, max difference: %g%s",
+				stats.numVoicesMixed,
+				stats.numVoicesCulled,
+				maxDifference,
+				equal ? "" : " (error)");
+		}
+		
+		printf("\n");
+		
+		delete voiceSet;
+		voiceSet = nullptr;
+		
+		delete mixer;
+		mixer = nullptr;
+	}
+	
+	return result;
+}
+
+int main(int argc, char * argv[])
+{
+	bool success = true;
+	
+	success &= runBenchmark("stereo", 2, AudioVoiceManager::kOutputMode_Stereo);
+	success &= runBenchmark("multi-channel", 16, AudioVoiceManager::kOutputMode_MultiChannel);
+	success &= runBenchmark("multi-channel", 64, AudioVoiceManager::kOutputMode_MultiChannel);
+	
+	printf("verification %s\n", success ? "passed" : "failed");
+	
+	return success ? 0 : -1;
+}
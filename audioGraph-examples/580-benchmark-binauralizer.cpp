@@ -0,0 +1,370 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "binaural.h"
+#include "binaural_oalsoft.h"
+#include "binauralizer.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+#if defined(MACOS) || defined(LINUX)
+	#include <unistd.h>
+#endif
+
+#if defined(WINDOWS)
+	#include <direct.h>
+#endif
+
+#ifdef WIN32
+	#define chdir _chdir
+#endif
+
+/*
+This benchmark measures the cost of binauralizing a number of sound sources, using Binauralizer::generateLR for
+each source, and using Binauralizer::generateLR_batch for all sources at once. Both stationary and moving sources
+are measured, with and without a HRTF cache. Moving sources move each tick. With the smallest tick size, moving
+sources get a new location each update, which measures the cost of updating the HRTF.
+
+The output of the binauralizer is verified against a straightforward time-domain convolution of the input with
+the (blended) HRIR for the sound source location. Sources are placed at whole degrees, so the verification also
+holds when using a HRTF cache with a resolution of one degree.
+*/
+
+static const int kNumSources = 64;
+static const int kSampleRate = 44100;
+static const int kMaxSamplesPerTick = 256;
+static const int kNumVerifyTicks = 16;
+static const int kNumBenchmarkSamples = 256 * 1000;
+
+static const float kHrtfCacheResolution = 1.f;
+static const int kHrtfCacheMaxEntries = 1024;
+
+struct SourceSet
+{
+	binaural::Mutex_Dummy mutex;
+	
+	binaural::Binauralizer * binauralizers = nullptr;
+	binaural::Binauralizer * binauralizerPtrs[kNumSources];
+	
+	float * samplesL[kNumSources];
+	float * samplesR[kNumSources];
+	
+	std::vector<float> inputSamples;
+	std::vector<float> outputSamples;
+	
+	uint32_t random = 1;
+	
+	SourceSet(const binaural::HRIRSampleSet & sampleSet, binaural::HRTFCache * hrtfCache)
+	{
+		binauralizers = new binaural::Binauralizer[kNumSources];
+		
+		inputSamples.resize(kMaxSamplesPerTick);
+		outputSamples.resize(kNumSources * kMaxSamplesPerTick * 2);
+		
+		for (int i = 0; i < kNumSources; ++i)
+		{
+			binauralizers[i].init(&sampleSet, &mutex);
+			binauralizers[i].setHrtfCache(hrtfCache);
+			binauralizerPtrs[i] = &binauralizers[i];
+			
+			samplesL[i] = outputSamples.data() + kMaxSamplesPerTick * (i * 2 + 0);
+			samplesR[i] = outputSamples.data() + kMaxSamplesPerTick * (i * 2 + 1);
+		}
+	}
+	
+	~SourceSet()
+	{
+		delete [] binauralizers;
+		binauralizers = nullptr;
+	}
+	
+	void generateInput(float * samples, const int numSamples)
+	{
+		for (int i = 0; i < numSamples; ++i)
+		{
+			random = random * 1664525 + 1013904223;
+			
+			samples[i] = (random >> 8) / float(1 << 24) * 2.f - 1.f;
+		}
+	}
+	
+	void setLocations(const double time, const bool moving)
+	{
+		for (int i = 0; i < kNumSources; ++i)
+		{
+			// moving sources orbit the listener at 90 degrees per second, while slowly changing elevation
+			
+			const float t = moving ? float(time) : 0.f;
+			
+			const float elevation = fmodf(i * 13.f + t * 20.f, 160.f) - 80.f;
+			const float azimuth = fmodf(i * 29.f + t * 90.f, 360.f) - 180.f;
+			
+			binauralizers[i].setSampleLocation(elevation, azimuth);
+		}
+	}
+	
+	void provideInput(const int numSamples)
+	{
+		for (int i = 0; i < kNumSources; ++i)
+		{
+			generateInput(inputSamples.data(), numSamples);
+			
+			binauralizers[i].provide(inputSamples.data(), numSamples);
+		}
+	}
+	
+	void generate(const bool batch, const int numSamples)
+	{
+		if (batch)
+		{
+			binaural::Binauralizer::generateLR_batch(binauralizerPtrs, samplesL, samplesR, kNumSources, numSamples);
+		}
+		else
+		{
+			for (int i = 0; i < kNumSources; ++i)
+				binauralizers[i].generateLR(samplesL[i], samplesR[i], numSamples);
+		}
+	}
+};
+
+static float verify(const binaural::HRIRSampleSet & sampleSet, binaural::HRTFCache * hrtfCache, const bool batch)
+{
+	// binauralize stationary sources, and compare the output with the time-domain convolution of the input with the HRIR
+	
+	SourceSet sourceSet(sampleSet, hrtfCache);
+	
+	sourceSet.setLocations(0.0, false);
+	
+	std::vector<float> input[kNumSources];
+	std::vector<float> output[kNumSources][2];
+	
+	for (int t = 0; t < kNumVerifyTicks; ++t)
+	{
+		const uint32_t random = sourceSet.random;
+		
+		sourceSet.provideInput(kMaxSamplesPerTick);
+		
+		sourceSet.random = random;
+		
+		for (int i = 0; i < kNumSources; ++i)
+		{
+			sourceSet.generateInput(sourceSet.inputSamples.data(), kMaxSamplesPerTick);
+			
+			input[i].insert(input[i].end(), sourceSet.inputSamples.begin(), sourceSet.inputSamples.end());
+		}
+		
+		sourceSet.generate(batch, kMaxSamplesPerTick);
+		
+		for (int i = 0; i < kNumSources; ++i)
+		{
+			output[i][0].insert(output[i][0].end(), sourceSet.samplesL[i], sourceSet.samplesL[i] + kMaxSamplesPerTick);
+			output[i][1].insert(output[i][1].end(), sourceSet.samplesR[i], sourceSet.samplesR[i] + kMaxSamplesPerTick);
+		}
+	}
+	
+	float maxDifference = 0.f;
+	
+	for (int i = 0; i < kNumSources; ++i)
+	{
+		binaural::HRIRSample hrir;
+		sourceSet.binauralizers[i].calculateHrir(hrir);
+		
+		const float * filters[2] = { hrir.sampleData.lSamples, hrir.sampleData.rSamples };
+		
+		// note : skip the first update, where the binauralizer ramps from silence to the HRTF
+		
+		for (int c = 0; c < 2; ++c)
+		{
+			for (size_t n = binaural::AUDIO_BUFFER_SIZE; n < input[i].size(); ++n)
+			{
+				float value = 0.f;
+				
+				for (int m = 0; m < binaural::HRIR_BUFFER_SIZE; ++m)
+					value += filters[c][m] * input[i][n - m];
+				
+				maxDifference = fmaxf(maxDifference, fabsf(value - output[i][c][n]));
+			}
+		}
+	}
+	
+	return maxDifference;
+}
+
+static void benchmark(const binaural::HRIRSampleSet & sampleSet, binaural::HRTFCache * hrtfCache, const bool batch, const bool moving, const int samplesPerTick)
+{
+	SourceSet sourceSet(sampleSet, hrtfCache);
+	
+	const int numTicks = kNumBenchmarkSamples / samplesPerTick;
+	
+	uint64_t time = 0;
+	
+	for (int t = 0; t < numTicks; ++t)
+	{
+		sourceSet.setLocations(t * samplesPerTick / double(kSampleRate), moving);
+		
+		sourceSet.provideInput(samplesPerTick);
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		sourceSet.generate(batch, samplesPerTick);
+		
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		time += t2 - t1;
+	}
+	
+	const double ms = time / 1000.0;
+	const int numUpdates = kNumSources * (kNumBenchmarkSamples / (binaural::AUDIO_BUFFER_SIZE / 2));
+	
+	printf("\t%-10s %-10s %-8s %3d samples/tick: %8.2f us per 256 samples, %8.1f source updates/ms",
+		moving ? "moving" : "stationary",
+		batch ? "batched" : "per-source",
+		hrtfCache ? "cached" : "uncached",
+		samplesPerTick,
+		time / (kNumBenchmarkSamples / 256.0),
+		numUpdates / ms);
+	
+	if (hrtfCache != nullptr)
+	{
+		const auto stats = hrtfCache->getStats();
+		
+		printf(", cache lookups: %d, misses: %d", stats.numLookups, stats.numMisses);
+	}
+	
+	printf("\n");
+}
+
+int main(int argc, char * argv[])
+{
+#if defined(CHIBI_RESOURCE_PATH)
+	if (chdir(CHIBI_RESOURCE_PATH) != 0)
+		return -1;
+#endif
+
+	binaural::HRIRSampleSet sampleSet;
+	
+	if (!binaural::loadHRIRSampleSet_Oalsoft("binaural/Default HRTF.mhr", sampleSet))
+	{
+		printf("failed to load HRIR sample set\n");
+		return -1;
+	}
+	
+	sampleSet.finalize();
+	
+	binaural::Mutex_Dummy hrtfCacheMutex;
+	
+	binaural::HRTFCache hrtfCache;
+	
+	bool success = true;
+	
+	printf("verification (%d sources):\n", kNumSources);
+	
+	for (int cached = 0; cached < 2; ++cached)
+	{
+		for (int batch = 0; batch < 2; ++batch)
+		{
+			hrtfCache.init(&sampleSet, kHrtfCacheResolution, kHrtfCacheMaxEntries, &hrtfCacheMutex);
+			
+			const float maxDifference = verify(sampleSet, cached ? &hrtfCache : nullptr, batch != 0);
+			
+			// note : the FFT based convolution introduces a small amount of rounding error
+			
+			const bool equal = maxDifference <= 1e-4f;
+			
+			printf("\t%-10s %-8s: max difference: %g%s\n",
+				batch ? "batched" : "per-source",
+				cached ? "cached" : "uncached",
+				maxDifference,
+				equal ? "" : " (error)");
+			
+			success &= equal;
+		}
+	}
+	
+	printf("benchmark (%d sources):\n", kNumSources);
+	
+	const int kSamplesPerTick[] = { 256, 32 };
+	
+	for (const int samplesPerTick : kSamplesPerTick)
+	{
+		for (int moving = 0; moving < 2; ++moving)
+		{
+			for (int cached = 0; cached < 2; ++cached)
+			{
+				for (int batch = 0; batch < 2; ++batch)
+				{
+					hrtfCache.init(&sampleSet, kHrtfCacheResolution, kHrtfCacheMaxEntries, &hrtfCacheMutex);
+					
+					benchmark(sampleSet, cached ? &hrtfCache : nullptr, batch != 0, moving != 0, samplesPerTick);
+				}
+			}
+		}
+	}
+	
+	// measure the cost of finalizing the sample set, versus loading the finalized sample set
+	
+	{
+		FILE * file = tmpfile();
+		
+		if (file != nullptr)
+		{
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			binaural::HRIRSampleSet finalizedSampleSet;
+			binaural::loadHRIRSampleSet_Oalsoft("binaural/Default HRTF.mhr", finalizedSampleSet);
+			finalizedSampleSet.finalize();
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			finalizedSampleSet.saveFinalized(file);
+			rewind(file);
+			
+			const uint64_t t3 = g_TimerRT.TimeUS_get();
+			
+			binaural::HRIRSampleSet loadedSampleSet;
+			const bool loaded = loadedSampleSet.loadFinalized(file);
+			
+			const uint64_t t4 = g_TimerRT.TimeUS_get();
+			
+			fclose(file);
+			file = nullptr;
+			
+			printf("startup:\n");
+			printf("\tload and finalize       : %8.2f ms\n", (t2 - t1) / 1000.0);
+			printf("\tload finalized (cached) : %8.2f ms%s\n", (t4 - t3) / 1000.0, loaded ? "" : " (error)");
+			
+			success &= loaded;
+		}
+	}
+	
+	printf("verification %s\n", success ? "passed" : "failed");
+	
+	return success ? 0 : -1;
+}
@@ -0,0 +1,296 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioSourceVorbis.h"
+#include "audiostream/AudioStreamVorbis.h"
+#include "audiostream/VorbisDecodeService.h"
+#include "Timer.h"
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#if defined(MACOS) || defined(LINUX)
+	#include <unistd.h>
+#endif
+
+#if defined(WINDOWS)
+	#include <direct.h>
+#endif
+
+#ifdef WIN32
+	#define chdir _chdir
+#endif
+
+/*
+This benchmark measures the cost of streaming a large number of Vorbis files. First, the decoded output of a stream
+decoded by the decode service is verified against the output of a stream decoded synchronously, over multiple loops
+of the file, and sources which are closed before they are destroyed are checked to release their stream once. Next, the audio thread cost of decoding all streams inline (inside AudioStream_Vorbis::Provide) is
+measured. Finally, all streams are played back in real-time using AudioSourceVorbis, where the audio thread only
+copies samples decoded ahead of time by the decode service. Underruns are reported for the real-time playback.
+*/
+
+static const int kNumStreams = 128;
+static const int kSamplesPerTick = 256;
+static const int kNumInlineTicks = 100;
+static const int kNumRealtimeSeconds = 10;
+static const int kNumVerifyLoops = 3;
+
+static const char * kFileNames[] =
+{
+	"thegrooop/welcome/01 Welcome Intro alleeeen zang.ogg",
+	"thegrooop/welcome/02 Welcome Intro zonder zang.ogg",
+	"thegrooop/welcome/03 Welcome couplet 1 alleeen zang.ogg",
+	"thegrooop/welcome/04 Welcome couplet 1 zonder zang.ogg",
+	"thegrooop/welcome/05 Welcome couplet 2 alleen zang.ogg",
+	"thegrooop/welcome/06 Welcome couplet 2 zonder zang.ogg",
+	"thegrooop/welcome/07 Welcome refrein 1 alleen zang.ogg",
+	"thegrooop/welcome/08 Welcome refrein 1 zonder zang.ogg",
+	"thegrooop/welcome/09 Welcome brug alleeeen zang.ogg",
+	"thegrooop/welcome/10 Welcome brug zonder zang.ogg"
+};
+
+static const int kNumFileNames = sizeof(kFileNames) / sizeof(kFileNames[0]);
+
+static bool verify(const char * fileName)
+{
+	// decode the file synchronously using a small ring buffer, to make sure wrapping around is exercised too
+	
+	VorbisDecodeStream syncStream;
+	
+	if (!syncStream.Open(fileName, true, 1000))
+		return false;
+	
+	VorbisDecodeStream * asyncStream = GetVorbisDecodeService().OpenStream(fileName, true);
+	
+	if (asyncStream == nullptr)
+		return false;
+	
+	const int numChannels = syncStream.NumChannels_get();
+	const int64_t numFrames = syncStream.Duration_get() * kNumVerifyLoops + kSamplesPerTick;
+	
+	std::vector<float> syncSamples(kSamplesPerTick * numChannels);
+	std::vector<float> asyncSamples(kSamplesPerTick * numChannels);
+	
+	int numSyncLoops = 0;
+	int numAsyncLoops = 0;
+	
+	bool success = true;
+	
+	for (int64_t i = 0; i < numFrames && success; i += kSamplesPerTick)
+	{
+		while (syncStream.NumFramesAvailable_get() < kSamplesPerTick && syncStream.Decode(1 << 16) > 0)
+		{
+		}
+		
+		// wait for the decode service, so we don't verify against underruns
+		
+		while (asyncStream->NumFramesAvailable_get() < kSamplesPerTick)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		
+		bool hasLooped;
+		bool hasEnded;
+		
+		syncStream.Read(syncSamples.data(), kSamplesPerTick, hasLooped, hasEnded);
+		numSyncLoops += hasLooped;
+		
+		asyncStream->Read(asyncSamples.data(), kSamplesPerTick, hasLooped, hasEnded);
+		numAsyncLoops += hasLooped;
+		
+		success &= syncSamples == asyncSamples;
+		success &= syncStream.Position_get() == asyncStream->Position_get();
+	}
+	
+	success &= numSyncLoops == kNumVerifyLoops;
+	success &= numAsyncLoops == kNumVerifyLoops;
+	
+	GetVorbisDecodeService().CloseStream(asyncStream);
+	
+	return success;
+}
+
+static bool verifyClose(const char * fileName)
+{
+	bool success = true;
+	
+	// close a source while the decode service is still opening it, and close it again when it's destroyed
+	
+	{
+		AudioSourceVorbis source;
+		source.open(fileName, true);
+		source.close();
+		
+		success &= source.isOpen() == false;
+		success &= source.getNumUnderruns() == 0;
+		
+		source.close();
+	}
+	
+	// close a source after it's done opening, and reopen it
+	
+	{
+		AudioSourceVorbis source;
+		source.open(fileName, true);
+		
+		while (source.stream->IsOpen_get() == false && source.stream->HasFailed_get() == false)
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		
+		// the stream is marked as open only after the decode service prefetched it
+		
+		success &= source.stream->NumFramesAvailable_get() > 0;
+		
+		source.close();
+		
+		success &= source.isOpen() == false;
+		
+		source.open(fileName, false);
+		
+		success &= source.isOpen();
+	}
+	
+	return success;
+}
+
+int main(int argc, char * argv[])
+{
+#if defined(CHIBI_RESOURCE_PATH)
+	if (chdir(CHIBI_RESOURCE_PATH) != 0)
+		return -1;
+#endif
+
+	VorbisDecodeService::Settings settings;
+	GetVorbisDecodeService().Init(settings);
+	
+	const double tickTimeUs = kSamplesPerTick * 1000000.0 / 44100.0;
+	
+	// verification
+	
+	const bool success = verify(kFileNames[0]) && verifyClose(kFileNames[1]);
+	
+	printf("verification: %s\n", success ? "passed" : "FAILED");
+	
+	// inline decoding
+	
+	{
+		std::vector<AudioStream_Vorbis> streams(kNumStreams);
+		
+		for (int i = 0; i < kNumStreams; ++i)
+			streams[i].Open(kFileNames[i % kNumFileNames], true, false);
+		
+		AudioSample samples[kSamplesPerTick];
+		
+		uint64_t totalUs = 0;
+		uint64_t maxUs = 0;
+		
+		for (int tick = 0; tick < kNumInlineTicks; ++tick)
+		{
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			for (auto & stream : streams)
+				stream.Provide(kSamplesPerTick, samples);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			totalUs += t2 - t1;
+			maxUs = t2 - t1 > maxUs ? t2 - t1 : maxUs;
+		}
+		
+		printf("inline decoding (%d streams): audio thread: avg %.0fus (%.0f%% of a tick), max %lluus\n",
+			kNumStreams,
+			totalUs / double(kNumInlineTicks),
+			totalUs / double(kNumInlineTicks) / tickTimeUs * 100.0,
+			(unsigned long long)maxUs);
+	}
+	
+	// real-time playback using the decode service
+	
+	{
+		std::vector<AudioSourceVorbis> sources(kNumStreams);
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		for (int i = 0; i < kNumStreams; ++i)
+			sources[i].open(kFileNames[i % kNumFileNames], true);
+		
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		// wait for the decode service to open and prefetch the streams
+		
+		for (auto & source : sources)
+			while (source.stream->IsOpen_get() == false && source.stream->HasFailed_get() == false)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		
+		const uint64_t t3 = g_TimerRT.TimeUS_get();
+		
+		printf("opening %d streams: %.2fms, ready for playback after %.2fms\n", kNumStreams, (t2 - t1) / 1000.0, (t3 - t1) / 1000.0);
+		
+		const VorbisDecodeService::Stats statsBefore = GetVorbisDecodeService().GetStats();
+		
+		ALIGN16 float samples[kSamplesPerTick];
+		
+		const int numTicks = int(kNumRealtimeSeconds * 1000000.0 / tickTimeUs);
+		
+		uint64_t totalUs = 0;
+		uint64_t maxUs = 0;
+		
+		auto deadline = std::chrono::steady_clock::now();
+		
+		for (int tick = 0; tick < numTicks; ++tick)
+		{
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			for (auto & source : sources)
+				source.generate(samples, kSamplesPerTick);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			totalUs += t2 - t1;
+			maxUs = t2 - t1 > maxUs ? t2 - t1 : maxUs;
+			
+			deadline += std::chrono::microseconds(int(tickTimeUs));
+			std::this_thread::sleep_until(deadline);
+		}
+		
+		const VorbisDecodeService::Stats stats = GetVorbisDecodeService().GetStats();
+		
+		printf("real-time playback (%d streams, %d decode threads, %ds): audio thread: avg %.0fus (%.1f%% of a tick), max %lluus\n",
+			kNumStreams,
+			settings.numThreads,
+			kNumRealtimeSeconds,
+			totalUs / double(numTicks),
+			totalUs / double(numTicks) / tickTimeUs * 100.0,
+			(unsigned long long)maxUs);
+		
+		printf("\tdecoded: %.1f seconds of audio, underruns: %d (%lld frames)\n",
+			(stats.numDecodedFrames - statsBefore.numDecodedFrames) / 44100.0,
+			stats.numUnderruns - statsBefore.numUnderruns,
+			(long long)(stats.numUnderrunFrames - statsBefore.numUnderrunFrames));
+	}
+	
+	return success ? 0 : -1;
+}
@@ -0,0 +1,283 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "PolyphaseResampler.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+
+/*
+This benchmark measures the throughput and quality of the polyphase resampler, for each of its quality tiers. The
+nearest sample picking the resampler used before is included for reference.
+
+Quality is measured as THD+N: a sine wave is resampled and compared against the ideal output, which is the same sine
+wave evaluated at the output sample rate. As the resampler doesn't introduce any latency, the ideal output is known
+exactly. Aliasing is measured by downsampling a tone which lies above the Nyquist frequency of the output sample rate.
+The ideal output is silence, so anything that remains is aliasing.
+*/
+
+static const int kBlockSize = 256;
+static const int kNumMeasureFrames = 1 << 16;
+static const int kNumBenchmarkFrames = 1 << 22;
+
+static const char * kQualityNames[kResampleQuality_COUNT + 1] =
+{
+	"linear",
+	"cubic",
+	"sinc16",
+	"sinc32",
+	"sinc64",
+	"nearest (reference)"
+};
+
+struct NearestResampler
+{
+	int64_t position_fp = 0;
+	int64_t increment_fp = 0;
+	int64_t numInputFramesConsumed = 0;
+	float lastInputValue = 0.f;
+	
+	void setRatio(const double ratio)
+	{
+		increment_fp = int64_t(ratio * (int64_t(1) << 32));
+	}
+	
+	int calculateNumInputFrames(const int numOutputFrames) const
+	{
+		const int64_t lastIndex = (position_fp + (numOutputFrames - 1) * increment_fp) >> 32;
+		
+		return lastIndex + 1 > numInputFramesConsumed ? int(lastIndex + 1 - numInputFramesConsumed) : 0;
+	}
+	
+	void process(const float * input, const int numInputFrames, float * output, const int numOutputFrames)
+	{
+		for (int i = 0; i < numOutputFrames; ++i, position_fp += increment_fp)
+		{
+			const int index = int((position_fp >> 32) - numInputFramesConsumed);
+			
+			output[i] = index < 0 ? lastInputValue : input[index];
+		}
+		
+		if (numInputFrames > 0)
+			lastInputValue = input[numInputFrames - 1];
+		
+		numInputFramesConsumed += numInputFrames;
+	}
+};
+
+// resamples a sine wave in blocks, and returns the output
+
+static std::vector<float> resampleSine(const int quality, const double frequency, const int inputRate, const int outputRate, const int numOutputFrames)
+{
+	const double ratio = inputRate / double(outputRate);
+	
+	PolyphaseResampler resampler;
+	NearestResampler nearestResampler;
+	
+	if (quality < kResampleQuality_COUNT)
+	{
+		resampler.init(1, (ResampleQuality)quality);
+		resampler.setRatio(ratio);
+	}
+	else
+	{
+		nearestResampler.setRatio(ratio);
+	}
+	
+	std::vector<float> input;
+	std::vector<float> output(numOutputFrames);
+	
+	int64_t inputPosition = 0;
+	
+	for (int i = 0; i < numOutputFrames; i += kBlockSize)
+	{
+		const int numFrames = numOutputFrames - i < kBlockSize ? numOutputFrames - i : kBlockSize;
+		
+		const int numInputFrames =
+			quality < kResampleQuality_COUNT
+			? resampler.calculateNumInputFrames(numFrames)
+			: nearestResampler.calculateNumInputFrames(numFrames);
+		
+		input.resize(numInputFrames);
+		
+		for (int j = 0; j < numInputFrames; ++j)
+			input[j] = float(sin(2.0 * M_PI * frequency * (inputPosition + j) / inputRate) * .5);
+		
+		inputPosition += numInputFrames;
+		
+		float * outputPtr = output.data() + i;
+		
+		if (quality < kResampleQuality_COUNT)
+		{
+			const float * inputPtr = input.data();
+			
+			resampler.process(&inputPtr, numInputFrames, &outputPtr, numFrames);
+		}
+		else
+		{
+			nearestResampler.process(input.data(), numInputFrames, outputPtr, numFrames);
+		}
+	}
+	
+	return output;
+}
+
+// returns the ratio of the error with the ideal output to the signal level, in dB
+
+static double measureThdN(const int quality, const double frequency, const int inputRate, const int outputRate)
+{
+	const std::vector<float> output = resampleSine(quality, frequency, inputRate, outputRate, kNumMeasureFrames);
+	
+	double signal = 0.0;
+	double error = 0.0;
+	
+	// skip the start, where the filter is still reading the silence it was primed with
+	
+	for (int i = 1024; i < kNumMeasureFrames; ++i)
+	{
+		const double ideal = sin(2.0 * M_PI * frequency * i / outputRate) * .5;
+		
+		signal += ideal * ideal;
+		error += (output[i] - ideal) * (output[i] - ideal);
+	}
+	
+	return 10.0 * log10(error / signal + 1e-30);
+}
+
+// returns the level of what remains of a tone above the output Nyquist frequency, in dB relative to the input level
+
+static double measureAliasing(const int quality, const double frequency, const int inputRate, const int outputRate)
+{
+	const std::vector<float> output = resampleSine(quality, frequency, inputRate, outputRate, kNumMeasureFrames);
+	
+	double residual = 0.0;
+	
+	for (int i = 1024; i < kNumMeasureFrames; ++i)
+		residual += output[i] * output[i];
+	
+	const double signal = .5 * .5 / 2.0 * (kNumMeasureFrames - 1024);
+	
+	return 10.0 * log10(residual / signal + 1e-30);
+}
+
+static double measureThroughput(const int quality, const double ratio, const int numChannels)
+{
+	PolyphaseResampler resampler;
+	NearestResampler nearestResampler;
+	
+	if (quality < kResampleQuality_COUNT)
+	{
+		resampler.init(numChannels, (ResampleQuality)quality);
+		resampler.setRatio(ratio);
+	}
+	else
+	{
+		nearestResampler.setRatio(ratio);
+	}
+	
+	std::vector<float> inputs[PolyphaseResampler::kMaxChannels];
+	std::vector<float> outputs[PolyphaseResampler::kMaxChannels];
+	
+	const float * inputPtrs[PolyphaseResampler::kMaxChannels];
+	float * outputPtrs[PolyphaseResampler::kMaxChannels];
+	
+	for (int c = 0; c < numChannels; ++c)
+	{
+		inputs[c].resize(int(kBlockSize * ratio) + 256);
+		outputs[c].resize(kBlockSize);
+		
+		for (size_t i = 0; i < inputs[c].size(); ++i)
+			inputs[c][i] = (rand() / float(RAND_MAX)) * 2.f - 1.f;
+		
+		inputPtrs[c] = inputs[c].data();
+		outputPtrs[c] = outputs[c].data();
+	}
+	
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+	
+	for (int i = 0; i < kNumBenchmarkFrames; i += kBlockSize)
+	{
+		if (quality < kResampleQuality_COUNT)
+		{
+			const int numInputFrames = resampler.calculateNumInputFrames(kBlockSize);
+			
+			resampler.process(inputPtrs, numInputFrames, outputPtrs, kBlockSize);
+		}
+		else
+		{
+			const int numInputFrames = nearestResampler.calculateNumInputFrames(kBlockSize);
+			
+			// note : process all channels using the same resampling state
+			
+			const NearestResampler state = nearestResampler;
+			
+			for (int c = 0; c < numChannels; ++c)
+			{
+				nearestResampler = state;
+				nearestResampler.process(inputPtrs[c], numInputFrames, outputPtrs[c], kBlockSize);
+			}
+		}
+	}
+	
+	const uint64_t t2 = g_TimerRT.TimeUS_get();
+	
+	// output frames per second, in millions
+	
+	return kNumBenchmarkFrames / double(t2 - t1);
+}
+
+int main(int argc, char * argv[])
+{
+	printf("quality:\n");
+	printf("\t%-20s %16s %16s %22s\n", "", "THD+N 1kHz", "THD+N 10kHz", "aliasing 30kHz");
+	printf("\t%-20s %16s %16s %22s\n", "", "(44.1k -> 48k)", "(44.1k -> 48k)", "(96k -> 44.1k)");
+	
+	for (int quality = 0; quality <= kResampleQuality_COUNT; ++quality)
+	{
+		printf("\t%-20s %13.1fdB %13.1fdB %19.1fdB\n",
+			kQualityNames[quality],
+			measureThdN(quality, 1000.0, 44100, 48000),
+			measureThdN(quality, 10000.0, 44100, 48000),
+			measureAliasing(quality, 30000.0, 96000, 44100));
+	}
+	
+	printf("throughput (million output frames per second):\n");
+	printf("\t%-20s %16s %16s %16s\n", "", "44.1k -> 48k", "pitch x1.5", "stereo x1.5");
+	
+	for (int quality = 0; quality <= kResampleQuality_COUNT; ++quality)
+	{
+		printf("\t%-20s %16.1f %16.1f %16.1f\n",
+			kQualityNames[quality],
+			measureThroughput(quality, 44100.0 / 48000.0, 1),
+			measureThroughput(quality, 1.5, 1),
+			measureThroughput(quality, 1.5, 2));
+	}
+	
+	return 0;
+}
@@ -0,0 +1,169 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "pcmDataCache.h"
+#include "soundmix.h" // PcmData
+#include "Timer.h"
+#include <chrono>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#if defined(MACOS) || defined(LINUX)
+	#include <unistd.h>
+#endif
+
+#if defined(WINDOWS)
+	#include <direct.h>
+#endif
+
+#ifdef WIN32
+	#define chdir _chdir
+#endif
+
+/*
+This benchmark compares the startup time and resident memory of a PCM data cache which loads all sounds up front, to
+a PCM data cache with lazy loading enabled. For the latter, it also measures the cost of calling acquire, the time it
+takes for all sounds to become ready, and how the cache behaves when the memory budget is smaller than the total size
+of all sounds. Note the benchmark creates .cache files next to the sounds, as lazy loading memory maps these.
+*/
+
+static const size_t kMemoryBudget = size_t(4) << 20;
+
+static void printStats(const char * name, const PcmDataCache & cache)
+{
+	const PcmDataCache::Stats stats = cache.getStats();
+	
+	printf("\t%-28s: %d/%d resident, %.2fMB, %d loads, %d evictions\n",
+		name,
+		stats.numResident,
+		stats.numElems,
+		stats.residentBytes / 1024.0 / 1024.0,
+		stats.numLoads,
+		stats.numEvictions);
+}
+
+int main(int argc, char * argv[])
+{
+#if defined(CHIBI_RESOURCE_PATH)
+	if (chdir(CHIBI_RESOURCE_PATH) != 0)
+		return -1;
+#endif
+
+	std::vector<std::string> filenames;
+	
+	// load everything up front
+	
+	{
+		PcmDataCache cache;
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		cache.addPath(".", true, false, true);
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		printf("load up front: startup took %.2fms\n", (t2 - t1) / 1000.0);
+		printStats("after startup", cache);
+		
+		for (auto & elem : cache.elems)
+			filenames.push_back(elem.first);
+	}
+	
+	// lazy loading
+	
+	{
+		PcmDataCache cache;
+		cache.setLazyLoading(true, kMemoryBudget);
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		cache.addPath(".", true, false, true);
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		printf("lazy loading (memory budget: %.2fMB): startup took %.2fms\n", kMemoryBudget / 1024.0 / 1024.0, (t2 - t1) / 1000.0);
+		printStats("after startup", cache);
+		
+		// request all sounds, the way an audio thread would each tick, until they're all ready
+		
+		std::vector<PcmDataCache::Ref> refs(filenames.size());
+		
+		const uint64_t t3 = g_TimerRT.TimeUS_get();
+		
+		int64_t numGets = 0;
+		uint64_t getTimeUs = 0;
+		
+		for (;;)
+		{
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			int numReady = 0;
+			
+			for (size_t i = 0; i < filenames.size(); ++i)
+			{
+				cache.acquire(filenames[i].c_str(), refs[i]);
+				
+				numReady += refs[i].get() != nullptr;
+			}
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			numGets += filenames.size();
+			getTimeUs += t2 - t1;
+			
+			if (numReady == (int)filenames.size())
+				break;
+			
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		
+		const uint64_t t4 = g_TimerRT.TimeUS_get();
+		
+		printf("\tall sounds ready after %.2fms. acquire: %.0fns on average\n", (t4 - t3) / 1000.0, getTimeUs * 1000.0 / numGets);
+		printStats("all sounds in use", cache);
+		
+		// use only the first few sounds, and let the others be evicted
+		
+		const int numSoundsInUse = filenames.size() < 8 ? (int)filenames.size() : 8;
+		
+		for (size_t i = numSoundsInUse; i < refs.size(); ++i)
+			refs[i].reset();
+		
+		const uint64_t t5 = g_TimerRT.TimeUS_get();
+		
+		while (g_TimerRT.TimeUS_get() - t5 < 2500000)
+		{
+			for (int i = 0; i < numSoundsInUse; ++i)
+				cache.acquire(filenames[i].c_str(), refs[i]);
+			
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+		
+		char name[64];
+		sprintf(name, "%d sounds in use", numSoundsInUse);
+		printStats(name, cache);
+	}
+	
+	return 0;
+}
@@ -0,0 +1,297 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioTypes.h"
+#include "Timer.h"
+#include "wavefield.h"
+#include <algorithm>
+#include <cmath>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+#include <vector>
+
+/*
+This benchmark measures the throughput of the 2D wave field simulation, in cells updated per second, for a range of
+grid sizes. The scalar loops Wavefield2Df::tick used before are included for reference, followed by the vectorized
+Wavefield2Df::tick and Wavefield2DfSimulator using an increasing number of threads. Before measuring, the results of
+each method are compared against the scalar reference.
+
+Running a grid at audio rate requires numElems^2 * SAMPLE_RATE cell updates per second. For a 128x128 grid at 48kHz
+this is 786 million cell updates per second.
+*/
+
+static const int kBlockSize = 256;
+static const double kSampleRate = 48000.0;
+static const double kTension = 1000000.0;
+static const double kVRetainPerSecond = 0.8;
+static const double kPRetainPerSecond = 0.8;
+
+// the scalar implementation of Wavefield2Df::tick, before it was vectorized
+
+static void tickReference(Wavefield2Df & w, const double dt, const double c, const double vRetainPerSecond, const double pRetainPerSecond, const bool closedEnds)
+{
+	const float forcesDt = dt * 1000.0;
+	const float forcesC = c / 1000.0;
+	const float cTimesDtTimesOneQuarter = forcesC * forcesDt * .25f;
+	
+	const int sx = w.numElems;
+	const int sy = w.numElems;
+	
+	for (int x = 0; x < sx; ++x)
+	{
+		const int x0 = closedEnds ? (x > 0 ? x - 1 : 0) : (x == 0 ? sx - 1 : x - 1);
+		const int x2 = closedEnds ? (x < sx - 1 ? x + 1 : sx - 1) : (x == sx - 1 ? 0 : x + 1);
+		
+		for (int y = 0; y < sy; ++y)
+		{
+			const int y0 = closedEnds ? (y > 0 ? y - 1 : 0) : (y == 0 ? sy - 1 : y - 1);
+			const int y2 = closedEnds ? (y < sy - 1 ? y + 1 : sy - 1) : (y == sy - 1 ? 0 : y + 1);
+			
+			const float pt = w.p[x0][y] + w.p[x][y0] + w.p[x][y2] + w.p[x2][y];
+			
+			const float a = (pt - w.p[x][y] * 4.f) * cTimesDtTimesOneQuarter;
+			
+			w.v[x][y] += a * w.f[x][y];
+		}
+	}
+	
+	if (closedEnds)
+	{
+		for (int i = 0; i < sx; ++i)
+		{
+			w.v[i][0] = w.v[i][sy - 1] = 0.f;
+			w.p[i][0] = w.p[i][sy - 1] = 0.f;
+			w.v[0][i] = w.v[sx - 1][i] = 0.f;
+			w.p[0][i] = w.p[sx - 1][i] = 0.f;
+		}
+	}
+	
+	const float velocityDt = dt;
+	const float vRetain = std::pow(float(vRetainPerSecond), velocityDt);
+	const float pRetain = std::pow(float(pRetainPerSecond), velocityDt);
+	const float dMin = -1000.0 * velocityDt;
+	const float dMax = +1000.0 * velocityDt;
+	
+	for (int x = 0; x < sx; ++x)
+	{
+		for (int y = 0; y < sy; ++y)
+		{
+			const float d_clamped = fmaxf(fminf(w.d[x][y], dMax), dMin);
+			
+			w.p[x][y] = w.p[x][y] * pRetain + w.v[x][y] * velocityDt + d_clamped;
+			w.v[x][y] = w.v[x][y] * vRetain;
+			w.d[x][y] = w.d[x][y] - d_clamped;
+		}
+	}
+}
+
+static void initWavefield(Wavefield2Df & w, const int numElems)
+{
+	w.init(numElems);
+	
+	srand(1234);
+	
+	for (int x = 0; x < numElems; ++x)
+	{
+		for (int y = 0; y < numElems; ++y)
+		{
+			w.f[x][y] = .5f + rand() / float(RAND_MAX) * .5f;
+			w.d[x][y] = (rand() / float(RAND_MAX) - .5f) * .1f;
+		}
+	}
+	
+	w.doGaussianImpact(numElems / 3, numElems / 2, 4, 1.f, 1.f);
+}
+
+static float computeMaxDifference(const Wavefield2Df & a, const Wavefield2Df & b)
+{
+	float maxP = 0.f;
+	float maxDifference = 0.f;
+	
+	for (int x = 0; x < a.numElems; ++x)
+	{
+		for (int y = 0; y < a.numElems; ++y)
+		{
+			maxP = std::max(maxP, std::abs(a.p[x][y]));
+			maxDifference = std::max(maxDifference, std::abs(a.p[x][y] - b.p[x][y]));
+		}
+	}
+	
+	return maxP == 0.f ? 0.f : maxDifference / maxP;
+}
+
+// runs the simulation with the given method. a method of -1 selects the reference, zero selects Wavefield2Df::tick
+// and a positive value selects Wavefield2DfSimulator with that many threads
+
+static void run(Wavefield2Df & w, Wavefield2DfSimulator & simulator, const int method, const int numSteps, const bool closedEnds, float * samples)
+{
+	const double dt = 1.0 / kSampleRate;
+	
+	float c[kBlockSize];
+	float vRetainPerSecond[kBlockSize];
+	float pRetainPerSecond[kBlockSize];
+	float sampleX[kBlockSize];
+	float sampleY[kBlockSize];
+	
+	for (int i = 0; i < kBlockSize; ++i)
+	{
+		c[i] = kTension;
+		vRetainPerSecond[i] = kVRetainPerSecond;
+		pRetainPerSecond[i] = kPRetainPerSecond;
+		sampleX[i] = w.numElems * .4f;
+		sampleY[i] = w.numElems * .6f;
+	}
+	
+	for (int offset = 0; offset < numSteps; offset += kBlockSize)
+	{
+		const int numStepsThisBlock = std::min(kBlockSize, numSteps - offset);
+		
+		if (method < 0)
+		{
+			for (int i = 0; i < numStepsThisBlock; ++i)
+			{
+				tickReference(w, dt, kTension, kVRetainPerSecond, kPRetainPerSecond, closedEnds);
+				samples[offset + i] = w.sample(sampleX[i], sampleY[i], closedEnds);
+			}
+		}
+		else if (method == 0)
+		{
+			for (int i = 0; i < numStepsThisBlock; ++i)
+			{
+				w.tick(dt, kTension, kVRetainPerSecond, kPRetainPerSecond, closedEnds);
+				samples[offset + i] = w.sample(sampleX[i], sampleY[i], closedEnds);
+			}
+		}
+		else
+		{
+			simulator.tick(w, numStepsThisBlock, dt, c, vRetainPerSecond, pRetainPerSecond, closedEnds, sampleX, sampleY, samples + offset);
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	SCOPED_FLUSH_DENORMALS;
+	
+	const int numCores = std::max(1, int(std::thread::hardware_concurrency()));
+	
+	std::vector<int> methods = { -1, 0, 1, 2, 4 };
+	if (numCores > 4)
+		methods.push_back(numCores);
+	
+	const int sizes[] = { 32, 64, 128, 192, 256 };
+	
+	Wavefield2Df * reference = new Wavefield2Df();
+	Wavefield2Df * wavefield = new Wavefield2Df();
+	Wavefield2DfSimulator simulator;
+	
+	// verify all methods produce the same results as the reference, using an odd number of steps and a grid size
+	// which isn't a multiple of the vector size, to exercise the remainder paths
+	
+	printf("verification (maximum position difference relative to the peak, after 301 steps):\n");
+	
+	for (int closedEnds = 0; closedEnds < 2; ++closedEnds)
+	{
+		const int numElems = 67;
+		const int numSteps = 301;
+		
+		std::vector<float> samples(numSteps);
+		
+		initWavefield(*reference, numElems);
+		run(*reference, simulator, -1, numSteps, closedEnds, samples.data());
+		
+		for (size_t i = 1; i < methods.size(); ++i)
+		{
+			simulator.init(std::max(1, methods[i]));
+			
+			initWavefield(*wavefield, numElems);
+			run(*wavefield, simulator, methods[i], numSteps, closedEnds, samples.data());
+			
+			printf("\t%-8s %-12s %-10s %g\n",
+				closedEnds ? "closed" : "wrap",
+				methods[i] == 0 ? "simd" : "simulator",
+				methods[i] == 0 ? "" : (std::to_string(methods[i]) + " threads").c_str(),
+				computeMaxDifference(*reference, *wavefield));
+		}
+	}
+	
+	// measure throughput
+	
+	printf("throughput (million cells updated per second, real-time factor at 48kHz):\n");
+	printf("\t%-6s", "size");
+	for (const int method : methods)
+	{
+		if (method < 0)
+			printf(" %20s", "scalar (reference)");
+		else if (method == 0)
+			printf(" %20s", "simd");
+		else
+			printf(" %17d th", method);
+	}
+	printf("\n");
+	
+	for (const int numElems : sizes)
+	{
+		printf("\t%-6d", numElems);
+		
+		// run for roughly a quarter second of audio for the largest grid, and proportionally longer for smaller ones
+		
+		const int numSteps = std::max(kBlockSize, int(kSampleRate / 4 * 256 * 256 / (numElems * numElems)) / kBlockSize * kBlockSize);
+		
+		std::vector<float> samples(numSteps);
+		
+		for (const int method : methods)
+		{
+			simulator.init(std::max(1, method));
+			
+			initWavefield(*wavefield, numElems);
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			run(*wavefield, simulator, method, numSteps, true, samples.data());
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			const double seconds = std::max(uint64_t(1), t2 - t1) / 1000000.0;
+			const double cellsPerSecond = double(numElems) * numElems * numSteps / seconds;
+			const double realTimeFactor = numSteps / kSampleRate / seconds;
+			
+			printf(" %12.1f (%5.1fx)", cellsPerSecond / 1000000.0, realTimeFactor);
+		}
+		
+		printf("\n");
+	}
+	
+	simulator.shut();
+	
+	delete wavefield;
+	wavefield = nullptr;
+	
+	delete reference;
+	reference = nullptr;
+	
+	return 0;
+}
@@ -160,6 +160,8 @@ int main(int argc, char * argv[])
 			do
 			{
 				mutex.lock();
+				audioGraphMgr.context->lockControlValues();
+				instance->audioGraph->lockControlValues();
 				{
 					const int count =
 						audioGraphMgr.context->controlValues.size() +
@@ -199,6 +201,8 @@ int main(int argc, char * argv[])
 						index++;
 					}
 				}
+				instance->audioGraph->unlockControlValues();
+				audioGraphMgr.context->unlockControlValues();
 				mutex.unlock();
 				
 				printf("up/down = a/z, increment/decrement = 1/2, trigger event = SPACE, quit = q\n");
@@ -45,6 +45,14 @@ AUDIO_THREAD_LOCAL AudioGraph * g_currentAudioGraph = nullptr;
 
 //
 
+static const int kFlagQueueSize = 256;
+static const int kEventQueueSize = 256;
+
+static const int kMaxFlags = 1024; // the flag values are allocated up front, so setting a flag never allocates
+static const int kMaxEvents = 1024; // the event states are allocated up front, so registering an event never grows them
+
+//
+
 AudioGraph::AudioGraph(AudioGraphContext * in_context, const bool in_isPaused)
 	: isPaused(in_isPaused)
 	, rampDownRequested(false)
@@ -52,14 +60,30 @@ AudioGraph::AudioGraph(AudioGraphContext * in_context, const bool in_isPaused)
 	, rampedDown(false)
 	, nodes()
 	, currentTickTraversalId(0)
+	, schedule()
+	, scheduleIsDirty(true)
 #if AUDIO_GRAPH_ENABLE_TIMING
 	, graph(nullptr)
 #endif
 	, valuesToFree()
 	, time(0.0)
+	, controlValuesVersion(0)
+	, nextEventId(0)
+	, freeEventIds()
 	, context(nullptr)
 {
 	context = in_context;
+	
+	activeFlags_mainThread.resize(kMaxFlags, false);
+	activeFlags_audioThread.resize(kMaxFlags, false);
+	
+	flags_mainToAudio.init(kFlagQueueSize);
+	flags_audioToMain.init(kFlagQueueSize);
+	
+	triggeredEvents_mainToAudio.init(kEventQueueSize);
+	triggeredEvents_audioThread.reserve(kMaxEvents);
+	eventIsTriggered_audioThread.resize(kMaxEvents, false);
+	freeEventIds.reserve(kMaxEvents);
 }
 
 AudioGraph::~AudioGraph()
@@ -132,6 +156,10 @@ void AudioGraph::destroy()
 		}
 		
 		nodes.clear();
+		
+		schedule.elems.clear();
+		schedule.predeps.clear();
+		scheduleIsDirty = true;
 	}
 	popAudioGraph();
 	
@@ -223,66 +251,236 @@ void AudioGraph::freeVoice(AudioVoice *& voice)
 	}
 }
 
+static void setFlagValue(std::vector<bool> & activeFlags, const int flagId, const bool value)
+{
+	if (flagId >= 0 && flagId < (int)activeFlags.size())
+	{
+		activeFlags[flagId] = value;
+	}
+}
+
+static bool getFlagValue(const std::vector<bool> & activeFlags, const int flagId)
+{
+	return
+		flagId >= 0 && flagId < (int)activeFlags.size()
+		? activeFlags[flagId]
+		: false;
+}
+
+static void receiveFlags_mainThread(AudioGraph & audioGraph)
+{
+	// note : mutex_mem must be locked, to ensure only one thread at a time consumes the queue
+	
+	AudioGraph::FlagMessage message;
+	
+	while (audioGraph.flags_audioToMain.pop(message))
+	{
+		setFlagValue(audioGraph.activeFlags_mainThread, message.flagId, message.value);
+	}
+}
+
 void AudioGraph::lockControlValues()
 {
 	context->mutex_mem->lock();
+	
+	// pick up the current values published by the audio thread
+	
+	if (controlValues_audioToMain.update())
+	{
+		auto & snapshot = controlValues_audioToMain.getReadBuffer();
+		
+		if (snapshot.version == controlValuesVersion)
+		{
+			for (size_t i = 0; i < controlValues.size(); ++i)
+			{
+				controlValues[i].currentX = snapshot.values[i].x;
+				controlValues[i].currentY = snapshot.values[i].y;
+			}
+		}
+	}
 }
 
 void AudioGraph::unlockControlValues()
 {
+	// publish the desired values for the audio thread to pick up
+	
+	auto & snapshot = controlValues_mainToAudio.getWriteBuffer();
+	
+	snapshot.version = controlValuesVersion;
+	snapshot.values.resize(controlValues.size());
+	
+	for (size_t i = 0; i < controlValues.size(); ++i)
+	{
+		snapshot.values[i].x = controlValues[i].desiredX;
+		snapshot.values[i].y = controlValues[i].desiredY;
+	}
+	
+	controlValues_mainToAudio.publish();
+	
 	context->mutex_mem->unlock();
 }
 
+void AudioGraph::beginControlValueRegistration()
+{
+	// copy the current values from the audio thread, so they move along when control values are re-ordered
+	
+	Assert(controlValues_audioThread.size() == controlValues.size());
+	
+	for (size_t i = 0; i < controlValues_audioThread.size(); ++i)
+	{
+		controlValues[i].currentX = controlValues_audioThread[i].currentX;
+		controlValues[i].currentY = controlValues_audioThread[i].currentY;
+	}
+}
+
+void AudioGraph::endControlValueRegistration()
+{
+	// note : snapshots published before this point are ignored by both threads. this is fine, as the desired
+	//        values are copied here, and the main thread will pick up the current values from the next snapshot
+	
+	controlValuesVersion++;
+	
+	controlValues_audioThread.resize(controlValues.size());
+	
+	// size the snapshots up front, so publishing a snapshot doesn't allocate. note that neither thread
+	// touches the snapshots right now: the main thread only does so while mutex_mem is locked, and
+	// registration happens on the audio thread, or before the graph is being ticked
+	
+	for (auto & snapshot : controlValues_mainToAudio.buffers)
+		snapshot.values.resize(controlValues.size());
+	for (auto & snapshot : controlValues_audioToMain.buffers)
+		snapshot.values.resize(controlValues.size());
+	
+	for (size_t i = 0; i < controlValues.size(); ++i)
+	{
+		auto & controlValue = controlValues[i];
+		auto & state = controlValues_audioThread[i];
+		
+		auto memf_itr = memf.find(controlValue.name);
+		Assert(memf_itr != memf.end());
+		
+		state.memf = &memf_itr->second;
+		state.smoothness = controlValue.smoothness;
+		state.desiredX = controlValue.desiredX;
+		state.desiredY = controlValue.desiredY;
+		state.currentX = controlValue.currentX;
+		state.currentY = controlValue.currentY;
+	}
+}
+
 void AudioGraph::syncMainToAudio(const float dt)
 {
 	Assert(context->mainThreadId.checkThreadId() == false);
 	
-	context->mutex_mem->lock();
+	// note : this function never locks. values are passed from the main thread using triple buffers and queues
+	
+	// synchronize memory from main -> audio
+	
+	for (auto * entry : memfList)
 	{
-		// update control values
-		
-		for (auto & controlValue : controlValues)
+		if (entry->mainToAudio.update())
 		{
-			const float retain = powf(controlValue.smoothness, dt);
+			auto & values = entry->mainToAudio.getReadBuffer();
 			
-			controlValue.currentX = controlValue.currentX * retain + controlValue.desiredX * (1.f - retain);
-			controlValue.currentY = controlValue.currentY * retain + controlValue.desiredY * (1.f - retain);
+			entry->memf.value1_audioThread = values.value1;
+			entry->memf.value2_audioThread = values.value2;
+			entry->memf.value3_audioThread = values.value3;
+			entry->memf.value4_audioThread = values.value4;
 		}
+	}
+	
+	for (auto * mems : memsList)
+	{
+		mems->mainToAudio.update();
+	}
+	
+	// pick up the desired control values published by the main thread
+	
+	if (controlValues_mainToAudio.update())
+	{
+		auto & snapshot = controlValues_mainToAudio.getReadBuffer();
 		
-		// export control values
-		
-		for (auto & controlValue : controlValues)
+		if (snapshot.version == controlValuesVersion)
 		{
-			setMemf(
-				controlValue.name.c_str(),
-				controlValue.currentX,
-				controlValue.currentY);
+			for (size_t i = 0; i < controlValues_audioThread.size(); ++i)
+			{
+				controlValues_audioThread[i].desiredX = snapshot.values[i].x;
+				controlValues_audioThread[i].desiredY = snapshot.values[i].y;
+			}
 		}
+	}
+	
+	// update control values
+	
+	for (auto & state : controlValues_audioThread)
+	{
+		const float retain = powf(state.smoothness, dt);
 		
-		// synchronize memory from main -> audio
+		state.currentX = state.currentX * retain + state.desiredX * (1.f - retain);
+		state.currentY = state.currentY * retain + state.desiredY * (1.f - retain);
+	}
+	
+	// export control values
+	
+	for (auto & state : controlValues_audioThread)
+	{
+		auto & memf = state.memf->memf;
 		
-		for (auto & memf_itr : memf)
-		{
-			auto & memf = memf_itr.second;
-			
-			memf.syncMainToAudio();
-		}
+		memf.value1_audioThread = state.currentX;
+		memf.value2_audioThread = state.currentY;
+		memf.value3_audioThread = 0.f;
+		memf.value4_audioThread = 0.f;
+	}
+	
+	// publish the current control values for the main thread to pick up
+	
+	{
+		auto & snapshot = controlValues_audioToMain.getWriteBuffer();
+		
+		snapshot.version = controlValuesVersion;
 		
-		for (auto & mems_itr : mems)
+		Assert(snapshot.values.size() == controlValues_audioThread.size());
+		
+		for (size_t i = 0; i < controlValues_audioThread.size(); ++i)
 		{
-			auto & mems = mems_itr.second;
-			
-			mems.syncMainToAudio();
+			snapshot.values[i].x = controlValues_audioThread[i].currentX;
+			snapshot.values[i].y = controlValues_audioThread[i].currentY;
 		}
+		
+		controlValues_audioToMain.publish();
+	}
 	
-		// capture and reset triggered events
+	// apply flags set or reset from the main thread
+	
+	FlagMessage message;
+	
+	while (flags_mainToAudio.pop(message))
+	{
+		setFlagValue(activeFlags_audioThread, message.flagId, message.value);
+	}
+	
+	// capture triggered events
+	
+	for (auto eventId : triggeredEvents_audioThread)
+		eventIsTriggered_audioThread[eventId] = false;
+	
+	triggeredEvents_audioThread.clear();
+	
+	int eventId;
+	
+	while (triggeredEvents_mainToAudio.pop(eventId))
+	{
+		// note : an event may be passed more than once when the main thread triggers it again, after we
+		//        started popping events. we only add it once, so the list never grows beyond its capacity
 		
-		std::swap(
-			triggeredEvents_audioThread,
-			triggeredEvents_mainThread);
-		triggeredEvents_mainThread.clear();
+		if (eventIsTriggered_audioThread[eventId])
+			continue;
+		
+		Assert(triggeredEvents_audioThread.size() < triggeredEvents_audioThread.capacity());
+		triggeredEvents_audioThread.push_back(eventId);
+		
+		eventIsTriggered_audioThread[eventId] = true;
 	}
-	context->mutex_mem->unlock();
 }
 
 void AudioGraph::tickAudio(const float dt, const bool in_syncMainToAudio)
@@ -294,98 +492,343 @@ void AudioGraph::tickAudio(const float dt, const bool in_syncMainToAudio)
 	
 	pushAudioGraph(this);
 	{
-		if (rampDownRequested)
-			rampDown = true;
-		
 		if (in_syncMainToAudio)
 		{
 			syncMainToAudio(dt);
 		}
 		
-		// process nodes
+		beginTick();
+		
+		// recompile the schedule when the graph has been edited
 		
-		++currentTickTraversalId;
+		if (scheduleIsDirty)
+		{
+			updateSchedule();
+		}
+		
+		// process nodes
 		
 		setCurrentAudioGraphTraversalId(currentTickTraversalId);
 		
-		for (auto & i : nodes)
+		for (auto & elem : schedule.elems)
 		{
-			AudioNodeBase * node = i.second;
-			
-			if (node->lastTickTraversalId != currentTickTraversalId)
-			{
-				node->traverseTick(currentTickTraversalId, dt);
-			}
+			elem.node->scheduledTick(currentTickTraversalId, dt);
 		}
 		
 		clearCurrentAudioGraphTraversalId();
 		
-		//
+		endTick(dt);
+	}
+	popAudioGraph();
+}
+
+void AudioGraph::beginTick()
+{
+	if (rampDownRequested)
+		rampDown = true;
+	
+	++currentTickTraversalId;
+}
+
+void AudioGraph::endTick(const float dt)
+{
+	time += dt;
+	
+	//
+	
+	if (rampDown)
+	{
+		bool isRampedDown = true;
+		
+		for (AudioVoice * voice : audioVoices)
+		{
+			Assert(voice->rampInfo.ramp == false);
+			
+			isRampedDown &= voice->rampInfo.rampValue == 0.f;
+		}
+		
+		if (isRampedDown)
+			rampedDown = true;
+	}
+}
+
+void AudioGraph::invalidateSchedule()
+{
+	scheduleIsDirty = true;
+}
+
+static void addNodeToSchedule(
+	AudioNodeBase * node,
+	std::map<AudioNodeBase*, int> & scheduleIndices,
+	AudioGraph::Schedule & schedule)
+{
+	// note : the node is marked as being visited (-1) before visiting its predeps, to detect cycles
+	
+	scheduleIndices[node] = -1;
+	
+	for (auto * predep : node->predeps)
+	{
+		if (scheduleIndices.count(predep) == 0)
+			addNodeToSchedule(predep, scheduleIndices, schedule);
+	}
+	
+	AudioGraph::Schedule::Elem elem;
+	elem.node = node;
+	elem.firstPredep = schedule.predeps.size();
+	elem.numPredeps = 0;
+	elem.numSuccessors = 0;
+	elem.numAudioRateSuccessors = 0;
+	
+	for (auto * predep : node->predeps)
+	{
+		const int predepIndex = scheduleIndices[predep];
+		
+		// skip predeps which are still being visited. these close a cycle
+		
+		if (predepIndex == -1)
+			continue;
+		
+		// skip duplicate predeps
+		
+		bool isDuplicate = false;
+		
+		for (int i = 0; i < elem.numPredeps; ++i)
+			if (schedule.predeps[elem.firstPredep + i] == predepIndex)
+				isDuplicate = true;
+		
+		if (isDuplicate)
+			continue;
+		
+		schedule.predeps.push_back(predepIndex);
+		schedule.elems[predepIndex].numSuccessors++;
+		elem.numPredeps++;
+	}
+	
+	scheduleIndices[node] = schedule.elems.size();
+	schedule.elems.push_back(elem);
+}
+
+static bool isScalarInput(const AudioPlug & input, const std::set<const AudioFloat*> & scalarOutputs)
+{
+	if (input.type != kAudioPlugType_FloatVec)
+		return true;
+	
+	if (input.floatArray.elems.empty() == false)
+	{
+		// the input is linked to one or more outputs. each of them must be scalar
+		
+		for (auto & elem : input.floatArray.elems)
+			if (scalarOutputs.count(elem.audioFloat) == 0)
+				return false;
+		
+		return true;
+	}
+	
+	// unconnected inputs use a scalar default value, and literals are always scalar
+	
+	return input.mem == input.immediateMem;
+}
+
+static void propagateScalars(AudioGraph::Schedule & schedule)
+{
+	// note : nodes are visited in evaluation order, so the nodes a node depends on are visited first. for
+	//        links closing a cycle the source node hasn't been visited yet, which conservatively leaves the
+	//        node at audio rate
+	
+	std::set<const AudioFloat*> scalarOutputs;
+	
+	schedule.stats.numControlRateNodes = 0;
+	
+	for (auto & elem : schedule.elems)
+	{
+		AudioNodeBase * node = elem.node;
 		
-		time += dt;
+		node->isControlRate = node->isScalarPreserving;
 		
-		//
+		for (auto & input : node->inputs)
+			if (node->isControlRate && isScalarInput(input, scalarOutputs) == false)
+				node->isControlRate = false;
 		
-		if (rampDown)
+		if (node->isControlRate)
 		{
-			bool isRampedDown = true;
-			
-			for (AudioVoice * voice : audioVoices)
-			{
-				Assert(voice->rampInfo.ramp == false);
-				
-				isRampedDown &= voice->rampInfo.rampValue == 0.f;
-			}
+			for (auto & output : node->outputs)
+				if (output.type == kAudioPlugType_FloatVec)
+					scalarOutputs.insert((const AudioFloat*)output.mem);
 			
-			if (isRampedDown)
-				rampedDown = true;
+			schedule.stats.numControlRateNodes++;
+		}
+		else
+		{
+			for (int i = 0; i < elem.numPredeps; ++i)
+				schedule.elems[schedule.predeps[elem.firstPredep + i]].numAudioRateSuccessors++;
 		}
 	}
-	popAudioGraph();
+	
+	schedule.stats.numScalarOnlyNodes = 0;
+	
+	for (auto & elem : schedule.elems)
+		if (elem.node->isControlRate && elem.numAudioRateSuccessors == 0)
+			schedule.stats.numScalarOnlyNodes++;
 }
 
-void AudioGraph::setFlag(const char * name, const bool value)
+void AudioGraph::updateSchedule()
+{
+	audioCpuTimingBlock(AudioGraph_UpdateSchedule);
+	
+	schedule.elems.clear();
+	schedule.predeps.clear();
+	
+	std::map<AudioNodeBase*, int> scheduleIndices;
+	
+	for (auto & i : nodes)
+	{
+		AudioNodeBase * node = i.second;
+		
+		if (scheduleIndices.count(node) == 0)
+			addNodeToSchedule(node, scheduleIndices, schedule);
+	}
+	
+	schedule.stats.numNodes = schedule.elems.size();
+	
+	propagateScalars(schedule);
+	
+	scheduleIsDirty = false;
+}
+
+int AudioGraph::getFlagId(const char * name)
 {
 	// thread: main, audio
 	
-	context->mutex_mem->lock();
+	int result;
+	
+	context->mutex_reg->lock();
 	{
-		if (value)
-			activeFlags.insert(name);
+		auto flagId_itr = flagIds.find(name);
+		
+		if (flagId_itr != flagIds.end())
+		{
+			result = flagId_itr->second;
+		}
+		else if ((int)flagIds.size() == kMaxFlags)
+		{
+			LOG_ERR("failed to allocate an id for flag %s. the maximum number of flags (%d) has been reached", name, kMaxFlags);
+			
+			result = -1;
+		}
 		else
-			activeFlags.erase(name);
+		{
+			result = flagIds.size();
+			
+			flagIds[name] = result;
+		}
 	}
-	context->mutex_mem->unlock();
+	context->mutex_reg->unlock();
+	
+	return result;
 }
 
-void AudioGraph::resetFlag(const char * name)
+void AudioGraph::setFlag(const char * name, const bool value)
 {
-	// thread: main, audio
+	// thread: main
 	
-	context->mutex_mem->lock();
+	Assert(g_currentAudioGraph != this); // the audio thread should use the id based version, as looking up the id locks
+	
+	setFlag(getFlagId(name), value);
+}
+
+void AudioGraph::setFlag(const int flagId, const bool value)
+{
+	if (flagId == -1)
+		return;
+	
+	FlagMessage message;
+	message.flagId = flagId;
+	message.value = value;
+	
+	if (g_currentAudioGraph == this)
 	{
-		activeFlags.erase(name);
+		// thread: audio
+		
+		setFlagValue(activeFlags_audioThread, flagId, value);
+		
+		// note : the message is dropped when the main thread doesn't keep up with picking up flags. we cannot wait here
+		
+		flags_audioToMain.push(message);
 	}
-	context->mutex_mem->unlock();
+	else
+	{
+		// thread: main
+		
+		context->mutex_mem->lock();
+		{
+			receiveFlags_mainThread(*this);
+			
+			setFlagValue(activeFlags_mainThread, flagId, value);
+			
+			if (flags_mainToAudio.push(message) == false)
+			{
+				LOG_WRN("failed to pass flag %d to the audio thread. the queue is full", flagId);
+			}
+		}
+		context->mutex_mem->unlock();
+	}
+}
+
+void AudioGraph::resetFlag(const char * name)
+{
+	// thread: main
+	
+	Assert(g_currentAudioGraph != this); // the audio thread should use the id based version, as looking up the id locks
+	
+	setFlag(getFlagId(name), false);
 }
 
-bool AudioGraph::isFlagSet(const char * name) const
+void AudioGraph::resetFlag(const int flagId)
 {
 	// thread: main, audio
 	
+	setFlag(flagId, false);
+}
+
+bool AudioGraph::isFlagSet(const char * name)
+{
+	// thread: main
+	
+	Assert(g_currentAudioGraph != this); // the audio thread should use the id based version, as looking up the id locks
+	
+	return isFlagSet(getFlagId(name));
+}
+
+bool AudioGraph::isFlagSet(const int flagId)
+{
 	bool result;
 	
-	context->mutex_mem->lock();
+	if (g_currentAudioGraph == this)
 	{
-		result = activeFlags.count(name) != 0;
+		// thread: audio
+		
+		result = getFlagValue(activeFlags_audioThread, flagId);
+	}
+	else
+	{
+		// thread: main
+		
+		context->mutex_mem->lock();
+		{
+			receiveFlags_mainThread(*this);
+			
+			result = getFlagValue(activeFlags_mainThread, flagId);
+		}
+		context->mutex_mem->unlock();
 	}
-	context->mutex_mem->unlock();
 	
 	return result;
 }
 
-void AudioGraph::registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
+int AudioGraph::registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
 {
+	int result;
+	
 	context->mutex_reg->lock();
 	context->mutex_mem->lock();
 	{
@@ -393,7 +836,8 @@ void AudioGraph::registerMemf(const char * name, const float value1, const float
 		
 		if (mem_itr == memf.end())
 		{
-			auto & mem = memf[name];
+			auto & entry = memf[name];
+			auto & mem = entry.memf;
 			
 			mem.value1_mainThread = value1;
 			mem.value2_mainThread = value2;
@@ -401,14 +845,29 @@ void AudioGraph::registerMemf(const char * name, const float value1, const float
 			mem.value4_mainThread = value4;
 			
 			mem.syncMainToAudio();
+			
+			entry.id = memfList.size();
+			entry.mainToAudio.reset({ value1, value2, value3, value4 });
+			
+			memfList.push_back(&entry);
+			
+			result = entry.id;
+		}
+		else
+		{
+			result = mem_itr->second.id;
 		}
 	}
 	context->mutex_mem->unlock();
 	context->mutex_reg->unlock();
+	
+	return result;
 }
 
-void AudioGraph::registerMems(const char * name, const char * value)
+int AudioGraph::registerMems(const char * name, const char * value)
 {
+	int result;
+	
 	context->mutex_reg->lock();
 	context->mutex_mem->lock();
 	{
@@ -418,13 +877,23 @@ void AudioGraph::registerMems(const char * name, const char * value)
 		{
 			auto & mem = mems[name];
 			
+			mem.id = memsList.size();
 			mem.value_mainThread = value;
+			mem.mainToAudio.reset(mem.value_mainThread);
 			
-			mem.syncMainToAudio();
+			memsList.push_back(&mem);
+			
+			result = mem.id;
+		}
+		else
+		{
+			result = mem_itr->second.id;
 		}
 	}
 	context->mutex_mem->unlock();
 	context->mutex_reg->unlock();
+	
+	return result;
 }
 
 void AudioGraph::registerControlValue(AudioControlValue::Type type, const char * name, const float min, const float max, const float smoothness, const float defaultX, const float defaultY)
@@ -446,6 +915,8 @@ void AudioGraph::registerControlValue(AudioControlValue::Type type, const char *
 		
 		if (exists == false)
 		{
+			beginControlValueRegistration();
+			
 			controlValues.resize(controlValues.size() + 1);
 			
 			{
@@ -475,6 +946,8 @@ void AudioGraph::registerControlValue(AudioControlValue::Type type, const char *
 			// register the memf. if we don't, setMemf would fail!
 			
 			registerMemf(name, defaultX, defaultY, 0.f, 0.f);
+			
+			endControlValueRegistration();
 		}
 	}
 	context->mutex_mem->unlock();
@@ -500,7 +973,11 @@ void AudioGraph::unregisterControlValue(const char * name)
 				{
 					//LOG_DBG("erasing control value %s", name);
 					
+					beginControlValueRegistration();
+					
 					controlValues.erase(controlValueItr);
+					
+					endControlValueRegistration();
 				}
 				
 				exists = true;
@@ -518,42 +995,74 @@ void AudioGraph::unregisterControlValue(const char * name)
 	context->mutex_reg->unlock();
 }
 
-void AudioGraph::registerEvent(const char * name)
+int AudioGraph::registerEvent(const char * name)
 {
+	int result = -1;
+	
 	context->mutex_reg->lock();
 	context->mutex_mem->lock();
 	{
-		bool exists = false;
-		
 		for (auto & event : events)
 		{
 			if (event.name == name)
 			{
 				event.refCount++;
-				exists = true;
+				result = event.id;
 				break;
 			}
 		}
 		
-		if (exists == false)
+		if (result == -1)
 		{
-			events.resize(events.size() + 1);
+			// note : the ids of unregistered events are recycled, so the number of ids in use never exceeds the
+			//        peak number of registered events. an id is only recycled when the main to audio queue is
+			//        empty. triggerEvent can't push the id of an unregistered event, so this guarantees no
+			//        trigger for the previous owner of the id is still pending. it may have been picked up
+			//        during the current tick though, so we clear its triggered state
+			
+			int id = -1;
 			
+			if (!freeEventIds.empty() && triggeredEvents_mainToAudio.isEmpty())
 			{
-				// note : it won't be safe to reference event after the sort,
-				//        so we make sure to let it leave scope before the sort
-				
-				auto & event = events.back();
+				id = freeEventIds.back();
+				freeEventIds.pop_back();
 				
-				event.name = name;
-				event.refCount = 1;
+				eventIsTriggered_audioThread[id] = false;
+			}
+			else if (nextEventId < kMaxEvents)
+			{
+				id = nextEventId++;
 			}
 			
-			std::sort(events.begin(), events.end(), [](const AudioEvent & a, const AudioEvent & b) { return a.name < b.name; });
+			if (id == -1)
+			{
+				LOG_ERR("failed to allocate an id for event %s. the maximum number of events (%d) has been reached", name, kMaxEvents);
+			}
+			else
+			{
+				result = id;
+				
+				events.resize(events.size() + 1);
+				
+				{
+					// note : it won't be safe to reference event after the sort,
+					//        so we make sure to let it leave scope before the sort
+					
+					auto & event = events.back();
+					
+					event.name = name;
+					event.id = result;
+					event.refCount = 1;
+				}
+				
+				std::sort(events.begin(), events.end(), [](const AudioEvent & a, const AudioEvent & b) { return a.name < b.name; });
+			}
 		}
 	}
 	context->mutex_mem->unlock();
 	context->mutex_reg->unlock();
+	
+	return result;
 }
 
 void AudioGraph::unregisterEvent(const char * name)
@@ -575,6 +1084,9 @@ void AudioGraph::unregisterEvent(const char * name)
 				{
 					//LOG_DBG("erasing event %s", name);
 					
+					Assert(freeEventIds.size() < freeEventIds.capacity());
+					freeEventIds.push_back(event.id);
+					
 					events.erase(eventItr);
 				}
 				
@@ -599,108 +1111,250 @@ bool AudioGraph::isEventTriggered(const char * name, const bool isMainThread)
 	
 	Assert(context->mainThreadId.checkThreadId() == isMainThread);
 	
-	const bool result =
-		isMainThread
-		? g_currentAudioGraph->triggeredEvents_mainThread.count(name) != 0
-		: g_currentAudioGraph->triggeredEvents_audioThread.count(name) != 0;
+	bool result = false;
+	
+	if (isMainThread)
+	{
+		context->mutex_mem->lock();
+		{
+			if (triggeredEvents_mainToAudio.isEmpty())
+				triggeredEvents_mainThread.clear();
+			
+			result = triggeredEvents_mainThread.count(name) != 0;
+		}
+		context->mutex_mem->unlock();
+	}
+	else
+	{
+		for (auto & event : events)
+		{
+			if (event.name == name)
+			{
+				result = isEventTriggered(event.id);
+				break;
+			}
+		}
+	}
 	
 	return result;
 }
 
-void AudioGraph::setMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
+bool AudioGraph::isEventTriggered(const int eventId) const
 {
-	context->mutex_mem->lock();
+	// thread: audio
+	
+	Assert(eventId >= 0 && eventId < (int)eventIsTriggered_audioThread.size());
+	
+	return eventIsTriggered_audioThread[eventId];
+}
+
+int AudioGraph::findMemf(const char * name) const
+{
+	// note : registration happens on the audio thread, so the audio thread may look up names without locking
+	
+	const bool isAudioThread = g_currentAudioGraph == this;
+	
+	int result = -1;
+	
+	if (isAudioThread == false)
+		context->mutex_mem->lock();
+	
 	{
 		auto mem_itr = memf.find(name);
 		
 		if (mem_itr != memf.end())
+			result = mem_itr->second.id;
+	}
+	
+	if (isAudioThread == false)
+		context->mutex_mem->unlock();
+	
+	return result;
+}
+
+int AudioGraph::findMems(const char * name) const
+{
+	// note : registration happens on the audio thread, so the audio thread may look up names without locking
+	
+	const bool isAudioThread = g_currentAudioGraph == this;
+	
+	int result = -1;
+	
+	if (isAudioThread == false)
+		context->mutex_mem->lock();
+	
+	{
+		auto mem_itr = mems.find(name);
+		
+		if (mem_itr != mems.end())
+			result = mem_itr->second.id;
+	}
+	
+	if (isAudioThread == false)
+		context->mutex_mem->unlock();
+	
+	return result;
+}
+
+void AudioGraph::setMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
+{
+	const int memfId = findMemf(name);
+	
+	if (memfId != -1)
+	{
+		setMemf(memfId, value1, value2, value3, value4);
+	}
+}
+
+void AudioGraph::setMemf(const int memfId, const float value1, const float value2, const float value3, const float value4)
+{
+	if (g_currentAudioGraph == this)
+	{
+		// thread: audio
+		
+		Assert(memfId >= 0 && memfId < (int)memfList.size());
+		
+		auto & mem = memfList[memfId]->memf;
+		
+		mem.value1_audioThread = value1;
+		mem.value2_audioThread = value2;
+		mem.value3_audioThread = value3;
+		mem.value4_audioThread = value4;
+	}
+	else
+	{
+		// thread: main
+		
+		context->mutex_mem->lock();
 		{
-			auto & mem = mem_itr->second;
+			Assert(memfId >= 0 && memfId < (int)memfList.size());
+			
+			auto & entry = *memfList[memfId];
+			auto & mem = entry.memf;
 			
 			mem.value1_mainThread = value1;
 			mem.value2_mainThread = value2;
 			mem.value3_mainThread = value3;
 			mem.value4_mainThread = value4;
+			
+			entry.mainToAudio.getWriteBuffer() = { value1, value2, value3, value4 };
+			entry.mainToAudio.publish();
 		}
+		context->mutex_mem->unlock();
 	}
-	context->mutex_mem->unlock();
 }
 
 AudioGraph::Memf AudioGraph::getMemf(const char * name, const bool isMainThread) const
 {
-	Assert(context->mainThreadId.checkThreadId() == isMainThread);
+	const int memfId = findMemf(name);
+	
+	Assert(memfId != -1);
+	if (memfId == -1)
+		return Memf();
+	
+	return getMemf(memfId, isMainThread);
+}
 
-	bool found = false;
+AudioGraph::Memf AudioGraph::getMemf(const int memfId, const bool isMainThread) const
+{
+	Assert(context->mainThreadId.checkThreadId() == isMainThread);
 	
 	Memf result;
 	
-	context->mutex_mem->lock();
+	if (isMainThread)
 	{
-		auto mem_itr = memf.find(name);
-		
-		if (mem_itr != memf.end())
+		context->mutex_mem->lock();
 		{
-			auto & mem = mem_itr->second;
+			Assert(memfId >= 0 && memfId < (int)memfList.size());
 			
-			result = mem;
+			auto & mem = memfList[memfId]->memf;
 			
-			found = true;
+			// note : the audio thread values are owned by the audio thread. we return the main thread values for both
+			
+			result.value1_mainThread = mem.value1_mainThread;
+			result.value2_mainThread = mem.value2_mainThread;
+			result.value3_mainThread = mem.value3_mainThread;
+			result.value4_mainThread = mem.value4_mainThread;
+			
+			result.syncMainToAudio();
 		}
+		context->mutex_mem->unlock();
+	}
+	else
+	{
+		Assert(memfId >= 0 && memfId < (int)memfList.size());
+		
+		result = memfList[memfId]->memf;
 	}
-	context->mutex_mem->unlock();
-	
-	Assert(found);
 	
 	return result;
 }
 
 void AudioGraph::setMems(const char * name, const char * value)
 {
-	context->mutex_mem->lock();
-	{
-		auto mem_itr = mems.find(name);
+	const int memsId = findMems(name);
 	
-		Assert(mem_itr != mems.end());
-		if (mem_itr != mems.end())
-		{
-			auto & mem = mem_itr->second;
-			
-			mem.value_mainThread = value;
-		}
+	Assert(memsId != -1);
+	if (memsId != -1)
+	{
+		setMems(memsId, value);
 	}
-	context->mutex_mem->unlock();
 }
 
-void AudioGraph::getMems(const char * name, std::string & result) const
+void AudioGraph::setMems(const int memsId, const char * value)
 {
-	Assert(context->mainThreadId.checkThreadId() == false);
-
+	Assert(g_currentAudioGraph != this);
+	
 	context->mutex_mem->lock();
 	{
-		auto mem_itr = mems.find(name);
+		Assert(memsId >= 0 && memsId < (int)memsList.size());
 		
-		Assert(mem_itr != mems.end());
-		if (mem_itr != mems.end())
-		{
-			auto & mem = mem_itr->second;
-			
-			result = mem.value_audioThread;
-		}
-		else
-		{
-			result.clear();
-		}
+		auto & mem = *memsList[memsId];
+		
+		mem.value_mainThread = value;
+		
+		mem.mainToAudio.getWriteBuffer() = mem.value_mainThread;
+		mem.mainToAudio.publish();
 	}
 	context->mutex_mem->unlock();
 }
 
+const std::string & AudioGraph::getMems(const int memsId) const
+{
+	Assert(context->mainThreadId.checkThreadId() == false);
+	Assert(memsId >= 0 && memsId < (int)memsList.size());
+	
+	return memsList[memsId]->mainToAudio.getReadBuffer();
+}
+
 void AudioGraph::triggerEvent(const char * event)
 {
 	Assert(context->mainThreadId.checkThreadId() == true);
 	
 	context->mutex_mem->lock();
 	{
-		triggeredEvents_mainThread.insert(event);
+		// note : events triggered more than once before the audio thread picks them up, are passed only once
+		
+		if (triggeredEvents_mainToAudio.isEmpty())
+			triggeredEvents_mainThread.clear();
+		
+		if (triggeredEvents_mainThread.count(event) == 0)
+		{
+			triggeredEvents_mainThread.insert(event);
+			
+			for (auto & registeredEvent : events)
+			{
+				if (registeredEvent.name == event)
+				{
+					if (triggeredEvents_mainToAudio.push(registeredEvent.id) == false)
+					{
+						LOG_WRN("failed to pass event %s to the audio thread. the queue is full", event);
+					}
+					
+					break;
+				}
+			}
+		}
 	}
 	context->mutex_mem->unlock();
 }
@@ -711,11 +1365,15 @@ void pushAudioGraph(AudioGraph * audioGraph)
 {
 	Assert(g_currentAudioGraph == nullptr);
 	g_currentAudioGraph = audioGraph;
+	
+	setCurrentAudioUpdateSize(audioGraph->context->updateSize);
 }
 
 void popAudioGraph()
 {
 	g_currentAudioGraph = nullptr;
+	
+	setCurrentAudioUpdateSize(AUDIO_UPDATE_SIZE);
 }
 
 //
@@ -895,6 +1553,8 @@ AudioGraph * constructAudioGraph(
 			
 			audioNode->init(node);
 		}
+		
+		audioGraph->updateSchedule();
 	}
 	popAudioGraph();
 	
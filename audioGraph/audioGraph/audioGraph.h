@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include "audioProfiling.h"
 #include "audioThreading.h"
 #include "audioTypeDB.h"
 #include "audioTypes.h"
@@ -115,16 +116,97 @@ struct AudioGraph
 		}
 	};
 	
+	/**
+	 * Storage for a registered memf. Values set from the main thread are passed to the audio thread through
+	 * a triple buffer, which the audio thread picks up during syncMainToAudio. Neither thread has to wait.
+	 */
+	struct MemfEntry
+	{
+		struct Values
+		{
+			float value1;
+			float value2;
+			float value3;
+			float value4;
+		};
+		
+		int id; // index into memfList
+		
+		Memf memf; // the _mainThread values are owned by the main thread, the _audioThread values by the audio thread
+		
+		AudioTripleBuffer<Values> mainToAudio;
+	};
+	
 	struct Mems
 	{
+		int id; // index into memsList
+		
 		std::string value_mainThread;
 		
-		std::string value_audioThread;
+		AudioTripleBuffer<std::string> mainToAudio; // the audio thread reads its value directly from the read buffer
+	};
+	
+	struct FlagMessage
+	{
+		int flagId;
+		bool value;
+	};
+	
+	/**
+	 * Audio thread copy of a registered control value. The main thread edits control values directly, while
+	 * holding the control values lock. The desired values are passed to the audio thread when the lock is
+	 * released, and the current values are passed back to the main thread when it is acquired.
+	 */
+	struct ControlValueState
+	{
+		MemfEntry * memf;
 		
-		void syncMainToAudio()
+		float smoothness;
+		float desiredX;
+		float desiredY;
+		float currentX;
+		float currentY;
+	};
+	
+	struct ControlValueSnapshot
+	{
+		struct Value
 		{
-			value_audioThread = value_mainThread;
-		}
+			float x;
+			float y;
+		};
+		
+		int version = -1; // snapshots are ignored when control values have been (un)registered since they were taken
+		
+		std::vector<Value> values;
+	};
+	
+	/**
+	 * The schedule lists the nodes of the graph in evaluation order, together with the (unique) nodes each
+	 * node depends on. The evaluation order is equal to the order in which nodes are visited by traverseTick,
+	 * and dependencies always point to nodes earlier in the schedule. Dependencies closing a cycle are dropped,
+	 * in the same way traverseTick ignores predeps which are being traversed already.
+	 * tickAudio ticks the nodes by walking the schedule front to back, which avoids the cost of iterating
+	 * the node map and of recursively traversing predeps. The schedule is compiled by constructAudioGraph,
+	 * and recompiled on the next tick after the real-time connection adds or removes nodes or links.
+	 * When compiling the schedule, scalar-ness is propagated through the graph: scalar preserving nodes
+	 * whose inputs are all scalar run at control rate. See AudioNodeBase::isControlRate.
+	 */
+	struct Schedule
+	{
+		struct Elem
+		{
+			AudioNodeBase * node;
+			int firstPredep;
+			int numPredeps;
+			int numSuccessors;
+			int numAudioRateSuccessors; // the number of successors which don't run at control rate. see AudioNodeBase::isControlRate
+		};
+		
+		std::vector<Elem> elems;
+		std::vector<int> predeps; // for each elem, indices into elems of the nodes it depends on
+		
+		AudioGraphScheduleStats stats;
 	};
 	
 	std::atomic<bool> isPaused;
@@ -136,6 +218,9 @@ struct AudioGraph
 	
 	int currentTickTraversalId;
 	
+	Schedule schedule;
+	bool scheduleIsDirty;
+	
 #if AUDIO_GRAPH_ENABLE_TIMING
 	Graph * graph;
 #endif
@@ -146,16 +231,35 @@ struct AudioGraph
 	
 	double time;
 	
-	std::map<std::string, Memf> memf; // registered float type memory
+	// note : the main thread never blocks the audio thread when passing values, flags and events. the audio
+	//        thread only locks mutex_mem when memf, mems, control values or events are (un)registered. the
+	//        main thread locks mutex_mem to look up registered items, and to serialize calls from multiple threads
+	
+	std::map<std::string, MemfEntry> memf; // registered float type memory
+	std::vector<MemfEntry*> memfList; // registered float type memory, in order of registration
 	std::map<std::string, Mems> mems; // registered string type memory
+	std::vector<Mems*> memsList; // registered string type memory, in order of registration
 	
-	std::vector<AudioControlValue> controlValues; // registered control values
+	std::vector<AudioControlValue> controlValues; // registered control values. owned by the main thread
+	std::vector<ControlValueState> controlValues_audioThread; // audio thread copy of the registered control values, in the same order
+	int controlValuesVersion; // incremented each time control values are (un)registered
+	AudioTripleBuffer<ControlValueSnapshot> controlValues_mainToAudio; // desired values, published by unlockControlValues
+	AudioTripleBuffer<ControlValueSnapshot> controlValues_audioToMain; // current values, published by syncMainToAudio
 	
-	std::set<std::string> activeFlags; // flags to communicate state between main <-> audio threads
+	// flags to communicate state between main <-> audio threads
+	std::map<std::string, int> flagIds; // interned flag names. guarded by mutex_reg
+	std::vector<bool> activeFlags_mainThread; // indexed by flag id. sized up front
+	std::vector<bool> activeFlags_audioThread; // indexed by flag id. sized up front
+	AudioSpscQueue<FlagMessage> flags_mainToAudio;
+	AudioSpscQueue<FlagMessage> flags_audioToMain;
 	
 	std::vector<AudioEvent> events; // registered events
-	std::set<std::string> triggeredEvents_mainThread;  // events triggered from the main thread (authorative)
-	std::set<std::string> triggeredEvents_audioThread; // triggered events as captured from the authorative copy
+	int nextEventId; // the next id to hand out when there are no free ids
+	std::vector<int> freeEventIds; // ids of unregistered events, which may be recycled. capacity is reserved up front
+	std::set<std::string> triggeredEvents_mainThread; // events triggered from the main thread, which haven't been picked up by the audio thread yet
+	std::vector<int> triggeredEvents_audioThread; // ids of the events triggered during the current tick. capacity is reserved up front
+	std::vector<bool> eventIsTriggered_audioThread; // indexed by event id. sized up front
+	AudioSpscQueue<int> triggeredEvents_mainToAudio;
 	
 	AudioGraphContext * context; 
 	
@@ -169,37 +273,69 @@ struct AudioGraph
 	void freeVoice(AudioVoice *& voice);
 	
 	// called from the main thread
-	void lockControlValues();
-	void unlockControlValues();
+	void lockControlValues(); // picks up the current values of the control values from the audio thread
+	void unlockControlValues(); // passes the desired values of the control values to the audio thread
+	
+	// called during (un)registration of control values, while mutex_mem is locked
+	void beginControlValueRegistration();
+	void endControlValueRegistration();
 	
 	// called from the audio thread
 	void syncMainToAudio(const float dt); // synchronize control values and other state from the main thread to the audio thread
 	void tickAudio(const float dt, const bool syncMainToAudio);
 	
-	// called from the main & audio thread
+	// called from the audio thread. used when ticking the nodes of the graph is driven externally, for instance when ticking in parallel
+	void beginTick();
+	void endTick(const float dt);
+	
+	// called from the main & audio thread. the audio thread must be locked when called from the main thread
+	void invalidateSchedule(); // marks the schedule as dirty. this should be called whenever nodes or links are added or removed
+	void updateSchedule();
+	
+	// note : memf, mems, events and flags may be accessed by name, or by id. resolving a name to an id involves
+	//        a look up, and may need to lock. access by id is O(1), and is preferred inside nodes, which should
+	//        resolve the id once, when the name changes. ids remain valid for the lifetime of the graph, except for
+	//        event ids, which become invalid when the event is unregistered
+	
+	// called from the main & audio thread. the audio thread should call getFlagId during initialization, or when the name changes, as it locks
+	int getFlagId(const char * name); // interns the flag name. a new id is allocated when the name isn't known yet. returns -1 when the maximum number of flags has been reached
+	// called from the main thread
 	void setFlag(const char * name, const bool value = true);
 	void resetFlag(const char * name);
-	// called from the audio thread
-	bool isFlagSet(const char * name) const;
+	bool isFlagSet(const char * name);
+	// called from the main & audio thread
+	void setFlag(const int flagId, const bool value = true);
+	void resetFlag(const int flagId);
+	bool isFlagSet(const int flagId);
 	
-	// called from any thread
-	void registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4);
-	void registerMems(const char * name, const char * value);
+	// called from the audio thread, or from the main thread before the graph is being ticked
+	int registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4); // returns the memf id
+	int registerMems(const char * name, const char * value); // returns the mems id
 	void registerControlValue(AudioControlValue::Type type, const char * name, const float min, const float max, const float smoothness, const float defaultX, const float defaultY);
 	void unregisterControlValue(const char * name);
 	
-	// called from any thread
-	void registerEvent(const char * name);
+	// called from the audio thread, or from the main thread before the graph is being ticked
+	int registerEvent(const char * name); // returns the event id
 	void unregisterEvent(const char * name);
 	bool isEventTriggered(const char * name, const bool isMainThread);
+	// called from the audio thread
+	bool isEventTriggered(const int eventId) const;
+	
+	// called from the main & audio thread. returns -1 when the name isn't registered
+	int findMemf(const char * name) const;
+	int findMems(const char * name) const;
 	
 	// called from the main & audio thread
 	void setMemf(const char * name, const float value1, const float value2 = 0.f, const float value3 = 0.f, const float value4 = 0.f);
+	void setMemf(const int memfId, const float value1, const float value2 = 0.f, const float value3 = 0.f, const float value4 = 0.f);
 	Memf getMemf(const char * name, const bool isMainThread) const;
+	Memf getMemf(const int memfId, const bool isMainThread) const;
 	
-	// called from the main & audio thread
+	// called from the main thread
 	void setMems(const char * name, const char * value);
-	void getMems(const char * name, std::string & result) const;
+	void setMems(const int memsId, const char * value);
+	// called from the audio thread. the reference remains valid until the next call to syncMainToAudio
+	const std::string & getMems(const int memsId) const;
 	
 	// called from the main thread
 	void triggerEvent(const char * event);
@@ -31,21 +31,36 @@
 #include <algorithm> // std::sort
 #include <math.h>
 
+// note : memf and control value entries are stored in lists with a fixed capacity, so the audio thread may
+//        iterate them while entries are being registered, without having to lock
+
+static const int kMaxMemf = 1024;
+static const int kMaxControlValues = 256;
+
 AudioGraphContext::AudioGraphContext()
 	: mutex_mem(nullptr)
 	, mutex_reg(nullptr)
 	, voiceMgr(nullptr)
 	, mainThreadId()
+	, updateSize(AUDIO_UPDATE_SIZE)
 	, controlValues()
+	, controlValueEntries()
+	, controlValueList()
+	, numControlValueEntries(0)
 	, memf()
+	, memfList()
+	, numMemfEntries(0)
 	, time(0.0)
 {
+	controlValueList.reserve(kMaxControlValues);
+	memfList.reserve(kMaxMemf);
 }
 
 void AudioGraphContext::init(
 	AudioMutexBase * in_mutex_mem,
 	AudioMutexBase * in_mutex_reg,
-	AudioVoiceManager * in_voiceMgr)
+	AudioVoiceManager * in_voiceMgr,
+	const int in_updateSize)
 {
 	mutex_mem = in_mutex_mem;
 	mutex_reg = in_mutex_reg;
@@ -53,6 +68,19 @@ void AudioGraphContext::init(
 	voiceMgr = in_voiceMgr;
 	
 	mainThreadId.setThreadId();
+	
+	// note : some nodes process samples in groups of four, so the update size must be a multiple of four
+	
+	Assert(in_updateSize >= 4 && in_updateSize <= AUDIO_MAX_UPDATE_SIZE && (in_updateSize % 4) == 0);
+	if (in_updateSize < 4 || in_updateSize > AUDIO_MAX_UPDATE_SIZE || (in_updateSize % 4) != 0)
+	{
+		LOG_ERR("invalid update size: %d. update size must be a multiple of four and at most %d samples. using %d samples instead", in_updateSize, AUDIO_MAX_UPDATE_SIZE, AUDIO_UPDATE_SIZE);
+		updateSize = AUDIO_UPDATE_SIZE;
+	}
+	else
+	{
+		updateSize = in_updateSize;
+	}
 }
 
 void AudioGraphContext::shut()
@@ -65,42 +93,99 @@ void AudioGraphContext::shut()
 
 void AudioGraphContext::tickAudio(const float dt)
 {
-	mutex_mem->lock();
+	// note : this function never locks. values are passed from the main thread using triple buffers
+	
+	// synchronize memory from main -> audio
+	
+	const int numMemf = numMemfEntries.load(std::memory_order_acquire);
+	
+	for (int i = 0; i < numMemf; ++i)
 	{
-		// update control values
+		auto * entry = memfList[i];
 		
-		updateControlValues(dt);
-		
-		// export control values
-		
-		exportControlValues();
+		if (entry->mainToAudio.update())
+		{
+			auto & values = entry->mainToAudio.getReadBuffer();
+			
+			entry->memf.value1_audioThread = values.value1;
+			entry->memf.value2_audioThread = values.value2;
+			entry->memf.value3_audioThread = values.value3;
+			entry->memf.value4_audioThread = values.value4;
+		}
+	}
+	
+	// update and export control values
+	
+	const int numControlValues = numControlValueEntries.load(std::memory_order_acquire);
+	
+	for (int i = 0; i < numControlValues; ++i)
+	{
+		auto * entry = controlValueList[i];
 		
-		// synchronize memory from main -> audio
+		auto & params = entry->params_audioThread;
 		
-		for (auto & memf_itr : memf)
+		if (entry->mainToAudio.update())
 		{
-			auto & memf = memf_itr.second;
+			auto & newParams = entry->mainToAudio.getReadBuffer();
+			
+			if (newParams.resetId != params.resetId)
+			{
+				entry->currentX_audioThread = newParams.resetX;
+				entry->currentY_audioThread = newParams.resetY;
+			}
 			
-			memf.syncMainToAudio();
+			params = newParams;
 		}
+		
+		if (params.isActive == false)
+			continue;
+		
+		const float retain = powf(params.smoothness, dt);
+		
+		entry->currentX_audioThread = entry->currentX_audioThread * retain + params.desiredX * (1.f - retain);
+		entry->currentY_audioThread = entry->currentY_audioThread * retain + params.desiredY * (1.f - retain);
+		
+		auto & memf = entry->memf->memf;
+		
+		memf.value1_audioThread = entry->currentX_audioThread;
+		memf.value2_audioThread = entry->currentY_audioThread;
+		memf.value3_audioThread = 0.f;
+		memf.value4_audioThread = 0.f;
+		
+		// publish the current values for the main thread to pick up
+		
+		auto & values = entry->audioToMain.getWriteBuffer();
+		values.x = entry->currentX_audioThread;
+		values.y = entry->currentY_audioThread;
+		entry->audioToMain.publish();
 	}
-	mutex_mem->unlock();
 
 	// update time
 	
 	time += dt;
 }
 
-void AudioGraphContext::registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
+int AudioGraphContext::registerMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
 {
+	int result = -1;
+	
 	mutex_reg->lock();
 	mutex_mem->lock();
 	{
 		auto mem_itr = memf.find(name);
 		
-		if (mem_itr == memf.end())
+		if (mem_itr != memf.end())
+		{
+			result = mem_itr->second.id;
+		}
+		else if (memfList.size() == kMaxMemf)
+		{
+			LOG_ERR("failed to register memf %s. the maximum number of memf (%d) has been reached", name, kMaxMemf);
+		}
+		else
 		{
-			auto & mem = memf[name];
+			auto & entry = memf[name];
+			auto & mem = entry.memf;
 			
 			mem.value1_mainThread = value1;
 			mem.value2_mainThread = value2;
@@ -108,10 +193,37 @@ void AudioGraphContext::registerMemf(const char * name, const float value1, cons
 			mem.value4_mainThread = value4;
 			
 			mem.syncMainToAudio();
+			
+			entry.id = memfList.size();
+			entry.mainToAudio.reset({ value1, value2, value3, value4 });
+			
+			// note : the capacity of memfList is fixed, so this doesn't move the elements the audio thread may be reading
+			
+			memfList.push_back(&entry);
+			numMemfEntries.store(memfList.size(), std::memory_order_release);
+			
+			result = entry.id;
 		}
 	}
 	mutex_mem->unlock();
 	mutex_reg->unlock();
+	
+	return result;
+}
+
+static void publishControlValueParams(AudioGraphContext::ControlValueEntry & entry, const AudioControlValue & controlValue, const bool isActive)
+{
+	auto & params = entry.mainToAudio.getWriteBuffer();
+	
+	params.isActive = isActive;
+	params.smoothness = controlValue.smoothness;
+	params.desiredX = controlValue.desiredX;
+	params.desiredY = controlValue.desiredY;
+	params.resetId = entry.resetId;
+	params.resetX = controlValue.defaultX;
+	params.resetY = controlValue.defaultY;
+	
+	entry.mainToAudio.publish();
 }
 
 void AudioGraphContext::registerControlValue(AudioControlValue::Type type, const char * name, const float min, const float max, const float smoothness, const float defaultX, const float defaultY)
@@ -135,14 +247,23 @@ void AudioGraphContext::registerControlValue(AudioControlValue::Type type, const
 		
 		if (exists == false)
 		{
-			controlValues.resize(controlValues.size() + 1);
+			// register the memf. if we don't, setMemf would fail!
+			
+			const int memfId = registerMemf(name, defaultX, defaultY);
 			
+			auto entry_itr = controlValueEntries.find(name);
+			
+			if (memfId == -1)
 			{
-				// note : it won't be safe to reference controlValue after the sort,
-				//        so we make sure to let it leave scope before the sort
-				
-				auto & controlValue = controlValues.back();
-				
+				LOG_ERR("failed to register control value %s. the memf could not be registered", name);
+			}
+			else if (entry_itr == controlValueEntries.end() && controlValueList.size() == kMaxControlValues)
+			{
+				LOG_ERR("failed to register control value %s. the maximum number of control values (%d) has been reached", name, kMaxControlValues);
+			}
+			else
+			{
+				AudioControlValue controlValue;
 				controlValue.type = type;
 				controlValue.name = name;
 				controlValue.refCount = 1;
@@ -155,13 +276,51 @@ void AudioGraphContext::registerControlValue(AudioControlValue::Type type, const
 				controlValue.desiredY = defaultY;
 				controlValue.currentX = defaultX;
 				controlValue.currentY = defaultY;
+				
+				if (entry_itr == controlValueEntries.end())
+				{
+					// the entry isn't visible to the audio thread yet, so we may initialize its audio thread state directly
+					
+					auto & entry = controlValueEntries[name];
+					
+					entry.memf = memfList[memfId];
+					entry.resetId = 0;
+					
+					entry.params_audioThread.isActive = true;
+					entry.params_audioThread.smoothness = smoothness;
+					entry.params_audioThread.desiredX = defaultX;
+					entry.params_audioThread.desiredY = defaultY;
+					entry.params_audioThread.resetId = 0;
+					entry.params_audioThread.resetX = defaultX;
+					entry.params_audioThread.resetY = defaultY;
+					entry.currentX_audioThread = defaultX;
+					entry.currentY_audioThread = defaultY;
+					
+					entry.mainToAudio.reset(entry.params_audioThread);
+					entry.audioToMain.reset({ defaultX, defaultY });
+					
+					// note : the capacity of controlValueList is fixed, so this doesn't move the elements the audio thread may be reading
+					
+					controlValueList.push_back(&entry);
+					numControlValueEntries.store(controlValueList.size(), std::memory_order_release);
+				}
+				else
+				{
+					// re-activate the entry, and let the audio thread reset its current values
+					
+					auto & entry = entry_itr->second;
+					
+					entry.resetId++;
+					
+					publishControlValueParams(entry, controlValue, true);
+				}
+				
+				// keep the list of control values sorted (for a possible UI)
+				
+				controlValues.push_back(controlValue);
+				
+				std::sort(controlValues.begin(), controlValues.end(), [](const AudioControlValue & a, const AudioControlValue & b) { return a.name < b.name; });
 			}
-			
-			std::sort(controlValues.begin(), controlValues.end(), [](const AudioControlValue & a, const AudioControlValue & b) { return a.name < b.name; });
-			
-			// register the memf. if we don't, setMemf would fail!
-			
-			registerMemf(name, defaultX, defaultY);
 		}
 	}
 	mutex_mem->unlock();
@@ -189,6 +348,14 @@ void AudioGraphContext::unregisterControlValue(const char * name)
 				{
 					//LOG_DBG("erasing control value %s", name);
 					
+					// deactivate the entry. the audio thread stops updating the memf
+					
+					auto entry_itr = controlValueEntries.find(name);
+					Assert(entry_itr != controlValueEntries.end());
+					
+					if (entry_itr != controlValueEntries.end())
+						publishControlValueParams(entry_itr->second, controlValue, false);
+					
 					controlValues.erase(controlValueItr);
 				}
 				
@@ -210,33 +377,59 @@ void AudioGraphContext::unregisterControlValue(const char * name)
 void AudioGraphContext::lockControlValues()
 {
 	mutex_mem->lock();
+	
+	// pick up the current values published by the audio thread
+	
+	for (auto & controlValue : controlValues)
+	{
+		auto entry_itr = controlValueEntries.find(controlValue.name);
+		
+		if (entry_itr == controlValueEntries.end())
+			continue;
+		
+		auto & entry = entry_itr->second;
+		
+		if (entry.audioToMain.update())
+		{
+			auto & values = entry.audioToMain.getReadBuffer();
+			
+			controlValue.currentX = values.x;
+			controlValue.currentY = values.y;
+		}
+	}
 }
 
 void AudioGraphContext::unlockControlValues()
 {
-	mutex_mem->unlock();
-}
-
-void AudioGraphContext::updateControlValues(const float dt)
-{
+	// publish the desired values for the audio thread to pick up
+	
 	for (auto & controlValue : controlValues)
 	{
-		const float retain = powf(controlValue.smoothness, dt);
+		auto entry_itr = controlValueEntries.find(controlValue.name);
 		
-		controlValue.currentX = controlValue.currentX * retain + controlValue.desiredX * (1.f - retain);
-		controlValue.currentY = controlValue.currentY * retain + controlValue.desiredY * (1.f - retain);
+		if (entry_itr != controlValueEntries.end())
+			publishControlValueParams(entry_itr->second, controlValue, true);
 	}
+	
+	mutex_mem->unlock();
 }
 
-void AudioGraphContext::exportControlValues()
+int AudioGraphContext::findMemf(const char * name)
 {
-	for (auto & controlValue : controlValues)
+	// note : registration may happen on any thread, so looking up names always requires locking mutex_reg
+	
+	int result = -1;
+	
+	mutex_reg->lock();
 	{
-		setMemf(
-			controlValue.name.c_str(),
-			controlValue.currentX,
-			controlValue.currentY);
+		auto mem_itr = memf.find(name);
+		
+		if (mem_itr != memf.end())
+			result = mem_itr->second.id;
 	}
+	mutex_reg->unlock();
+	
+	return result;
 }
 
 void AudioGraphContext::setMemf(const char * name, const float value1, const float value2, const float value3, const float value4)
@@ -247,33 +440,59 @@ void AudioGraphContext::setMemf(const char * name, const float value1, const flo
 		
 		if (mem_itr != memf.end())
 		{
-			auto & mem = mem_itr->second;
+			auto & entry = mem_itr->second;
+			auto & mem = entry.memf;
 		
 			mem.value1_mainThread = value1;
 			mem.value2_mainThread = value2;
 			mem.value3_mainThread = value3;
 			mem.value4_mainThread = value4;
+			
+			entry.mainToAudio.getWriteBuffer() = { value1, value2, value3, value4 };
+			entry.mainToAudio.publish();
 		}
 	}
 	mutex_mem->unlock();
 }
 
 AudioGraphContext::Memf AudioGraphContext::getMemf(const char * name, const bool isMainThread)
+{
+	const int memfId = findMemf(name);
+	
+	if (memfId == -1)
+		return Memf();
+	
+	return getMemf(memfId, isMainThread);
+}
+
+AudioGraphContext::Memf AudioGraphContext::getMemf(const int memfId, const bool isMainThread)
 {
 	Assert(mainThreadId.checkThreadId() == isMainThread);
+	Assert(memfId >= 0 && memfId < numMemfEntries.load(std::memory_order_acquire));
 	
 	Memf result;
 	
-	mutex_mem->lock();
+	if (isMainThread)
 	{
-		auto memfItr = memf.find(name);
-		
-		if (memfItr != memf.end())
+		mutex_mem->lock();
 		{
-			result = memfItr->second;
+			auto & mem = memfList[memfId]->memf;
+			
+			// note : the audio thread values are owned by the audio thread. we return the main thread values for both
+			
+			result.value1_mainThread = mem.value1_mainThread;
+			result.value2_mainThread = mem.value2_mainThread;
+			result.value3_mainThread = mem.value3_mainThread;
+			result.value4_mainThread = mem.value4_mainThread;
+			
+			result.syncMainToAudio();
 		}
+		mutex_mem->unlock();
+	}
+	else
+	{
+		result = memfList[memfId]->memf;
 	}
-	mutex_mem->unlock();
 	
 	return result;
 }
@@ -29,6 +29,7 @@
 
 #include "audioThreading.h"
 #include "audioTypes.h"
+#include <atomic>
 #include <map>
 #include <typeindex>
 #include <vector>
@@ -64,6 +65,66 @@ struct AudioGraphContext
 		}
 	};
 	
+	/**
+	 * Storage for a registered memf. Values set from the main thread are passed to the audio thread through
+	 * a triple buffer, which the audio thread picks up during tickAudio. Entries are never removed.
+	 */
+	struct MemfEntry
+	{
+		struct Values
+		{
+			float value1;
+			float value2;
+			float value3;
+			float value4;
+		};
+		
+		int id; // index into memfList
+		
+		Memf memf; // the _mainThread values are owned by the main thread, the _audioThread values by the audio thread
+		
+		AudioTripleBuffer<Values> mainToAudio;
+	};
+	
+	/**
+	 * Storage for a registered control value. The entry outlives the registration, so the audio thread may
+	 * keep referencing it. Unregistering a control value deactivates the entry, and registering it again
+	 * re-activates it. The main thread edits the control values in the controlValues list while holding the
+	 * control values lock. The desired values are passed to the audio thread when the lock is released, and
+	 * the current values are passed back to the main thread when it is acquired.
+	 */
+	struct ControlValueEntry
+	{
+		struct Params
+		{
+			bool isActive;
+			float smoothness;
+			float desiredX;
+			float desiredY;
+			
+			int resetId; // the current values are reset when the reset id changes
+			float resetX;
+			float resetY;
+		};
+		
+		struct Values
+		{
+			float x;
+			float y;
+		};
+		
+		MemfEntry * memf;
+		
+		int resetId; // owned by the main thread
+		
+		Params params_audioThread;
+		float currentX_audioThread;
+		float currentY_audioThread;
+		
+		AudioTripleBuffer<Params> mainToAudio;
+		AudioTripleBuffer<Values> audioToMain;
+	};
+	
 // todo : document 'objects'
 // todo : do the same for vfxgraph! useful for registering FsfxLibrary, ...
 /*
@@ -88,18 +149,29 @@ struct AudioGraphContext
 	}
 */
 	
+	// note : the audio thread never locks while ticking the context. it only locks mutex_mem and mutex_reg when
+	//        memf or control values are (un)registered, or when looking up a memf by name. the main thread locks
+	//        mutex_mem to serialize calls from multiple threads, and while control values are being edited
+	
 	AudioMutexBase * mutex_mem; // mutex guarding VALUES of memf, mems, events and flags
 	AudioMutexBase * mutex_reg; // mutex guarding REGISTRATION of memf, mems, events
 	
 	AudioVoiceManager * voiceMgr;
 	
 	AudioThreadId mainThreadId;
+	
+	int updateSize; // the number of samples processed per tick by graphs using this context. at most AUDIO_MAX_UPDATE_SIZE
 
 	std::vector<ObjectRegistration> objects;
 	
-	std::vector<AudioControlValue> controlValues;
+	std::vector<AudioControlValue> controlValues; // registered control values. owned by the main thread
+	std::map<std::string, ControlValueEntry> controlValueEntries;
+	std::vector<ControlValueEntry*> controlValueList; // control value entries, in order of registration. the capacity is fixed, so the audio thread may iterate the list while entries are being added
+	std::atomic<int> numControlValueEntries; // the number of entries in controlValueList which are visible to the audio thread
 	
-	std::map<std::string, Memf> memf;
+	std::map<std::string, MemfEntry> memf; // registered float type memory
+	std::vector<MemfEntry*> memfList; // registered float type memory, in order of registration. the capacity is fixed, see controlValueList
+	std::atomic<int> numMemfEntries; // the number of entries in memfList which are visible to the audio thread
 
 	double time;
 	
@@ -109,26 +181,30 @@ struct AudioGraphContext
 	void init(
 		AudioMutexBase * mutex_mem,
 		AudioMutexBase * mutex_reg,
-		AudioVoiceManager * voiceMgr);
+		AudioVoiceManager * voiceMgr,
+		const int updateSize = AUDIO_UPDATE_SIZE);
 	void shut();
 	
 	// called from the audio thread
 	void tickAudio(const float dt);
 	
 	// called from any thread
-	void registerMemf(const char * name, const float value1, const float value2 = 0.f, const float value3 = 0.f, const float value4 = 0.f);
+	int registerMemf(const char * name, const float value1, const float value2 = 0.f, const float value3 = 0.f, const float value4 = 0.f); // returns the memf id, or -1 when the maximum number of memf has been reached
 	void registerControlValue(AudioControlValue::Type type, const char * name, const float min, const float max, const float smoothness, const float defaultX, const float defaultY);
 	void unregisterControlValue(const char * name);
-	void lockControlValues();
-	void unlockControlValues();
 	
-	// called from the audio thread
-	void updateControlValues(const float dt);
-	void exportControlValues();
+	// called from the main thread
+	void lockControlValues(); // picks up the current values of the control values from the audio thread
+	void unlockControlValues(); // passes the desired values of the control values to the audio thread
 	
-	// called from any thread
+	// called from any thread. returns -1 when the name isn't registered. nodes should resolve the id once, when the name changes
+	int findMemf(const char * name);
+	
+	// called from the main thread
 	void setMemf(const char * name, const float value1, const float value2 = 0.f, const float value3 = 0.f, const float value4 = 0.f);
+	// called from the main & audio thread
 	Memf getMemf(const char * name, const bool isMainThread);
+	Memf getMemf(const int memfId, const bool isMainThread);
 
 	// called from the app thread
 	template <typename T> void addObject(T * object, const char * name)
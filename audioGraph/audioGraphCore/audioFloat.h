@@ -39,7 +39,7 @@ struct AudioFloat
 	bool isScalar;
 	bool isExpanded;
 	
-	ALIGN16 float samples[AUDIO_UPDATE_SIZE];
+	ALIGN16 float samples[AUDIO_MAX_UPDATE_SIZE]; // only the first getCurrentAudioUpdateSize() samples are used
 	
 	AudioFloat()
 		: isScalar(true)
@@ -0,0 +1,440 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+// note : this file is included by audioKernels.cpp once for each instruction set. it implements the
+//        kernels in terms of a small set of vector operations, which must be defined before including
+//        this file, together with:
+//        - AUDIO_KERNEL_NAME, the name of the kernels as reported by AudioKernels::name
+//        - AUDIO_KERNEL_ATTRIBUTES, the attributes to give each function (the target instruction set)
+//        - kVectorSize, the number of floats in a vecf
+
+static AUDIO_KERNEL_ATTRIBUTES void setZero(float * __restrict dst, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf zero = vecf_set1(0.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+		vecf_store(dst + i * kVectorSize, zero);
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = 0.f;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void fill(float * __restrict dst, const int numSamples, const float value)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf value_v = vecf_set1(value);
+	
+	for (int i = 0; i < numVectors; ++i)
+		vecf_store(dst + i * kVectorSize, value_v);
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = value;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void mul(float * __restrict dst, const int numSamples, const float scale)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf scale_v = vecf_set1(scale);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_mul(vecf_load(dst_v), scale_v));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] *= scale;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void mulBuffer(float * __restrict dst, const float * __restrict scale, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_mul(vecf_load(dst_v), vecf_load(scale + i * kVectorSize)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] *= scale[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void ramp(float * __restrict dst, const int numSamples, const float scale1, const float scale2)
+{
+	const float scaleStep = (scale2 - scale1) / numSamples;
+	
+	const int numVectors = numSamples / kVectorSize;
+	
+	float scale_init[kVectorSize];
+	for (int i = 0; i < kVectorSize; ++i)
+		scale_init[i] = scale1 + scaleStep * i;
+	
+	vecf scale_v = vecf_load(scale_init);
+	const vecf scaleStep_v = vecf_set1(scaleStep * kVectorSize);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_mul(vecf_load(dst_v), scale_v));
+		
+		scale_v = vecf_add(scale_v, scaleStep_v);
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] *= scale1 + scaleStep * i;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void setMul(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf scale_v = vecf_set1(scale);
+	
+	for (int i = 0; i < numVectors; ++i)
+		vecf_store(dst + i * kVectorSize, vecf_mul(vecf_load(src + i * kVectorSize), scale_v));
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = src[i] * scale;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void setMulBuffer(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	
+	for (int i = 0; i < numVectors; ++i)
+		vecf_store(dst + i * kVectorSize, vecf_mul(vecf_load(src + i * kVectorSize), vecf_load(scale + i * kVectorSize)));
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = src[i] * scale[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void add(float * __restrict dst, const float * __restrict src, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_add(vecf_load(dst_v), vecf_load(src + i * kVectorSize)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] += src[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void addMul(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf scale_v = vecf_set1(scale);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_add(vecf_load(dst_v), vecf_mul(vecf_load(src + i * kVectorSize), scale_v)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] += src[i] * scale;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void addMulBuffer(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_add(vecf_load(dst_v), vecf_mul(vecf_load(src + i * kVectorSize), vecf_load(scale + i * kVectorSize))));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] += src[i] * scale[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void addMul4(float * __restrict dst, const float * const * __restrict src, const float * __restrict scale, const int numSamples)
+{
+	// note : accumulating four sources at a time means we load and store dst once for every four sources
+	
+	const int numVectors = numSamples / kVectorSize;
+	
+	const float * __restrict src0 = src[0];
+	const float * __restrict src1 = src[1];
+	const float * __restrict src2 = src[2];
+	const float * __restrict src3 = src[3];
+	
+	const vecf scale0_v = vecf_set1(scale[0]);
+	const vecf scale1_v = vecf_set1(scale[1]);
+	const vecf scale2_v = vecf_set1(scale[2]);
+	const vecf scale3_v = vecf_set1(scale[3]);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		const int index = i * kVectorSize;
+		
+		const vecf sum01 = vecf_add(vecf_mul(vecf_load(src0 + index), scale0_v), vecf_mul(vecf_load(src1 + index), scale1_v));
+		const vecf sum23 = vecf_add(vecf_mul(vecf_load(src2 + index), scale2_v), vecf_mul(vecf_load(src3 + index), scale3_v));
+		
+		vecf_store(dst + index, vecf_add(vecf_load(dst + index), vecf_add(sum01, sum23)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+	{
+		const float sum01 = src0[i] * scale[0] + src1[i] * scale[1];
+		const float sum23 = src2[i] * scale[2] + src3[i] * scale[3];
+		
+		dst[i] += sum01 + sum23;
+	}
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void setAddMul(float * __restrict dst, const float * __restrict src1, const float * __restrict src2, const int numSamples, const float scale)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf scale_v = vecf_set1(scale);
+	
+	for (int i = 0; i < numVectors; ++i)
+		vecf_store(dst + i * kVectorSize, vecf_add(vecf_load(src1 + i * kVectorSize), vecf_mul(vecf_load(src2 + i * kVectorSize), scale_v)));
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = src1[i] + src2[i] * scale;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void mulMul(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf scale_v = vecf_set1(scale);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_mul(vecf_load(dst_v), vecf_mul(vecf_load(src + i * kVectorSize), scale_v)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] *= src[i] * scale;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void mulMulBuffer(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_mul(vecf_load(dst_v), vecf_mul(vecf_load(src + i * kVectorSize), vecf_load(scale + i * kVectorSize))));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] *= src[i] * scale[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void dryWet(float * dst, const float * dry, const float * wet, const int numSamples, const float wetness)
+{
+	const float dryness = 1.f - wetness;
+	
+	const int numVectors = numSamples / kVectorSize;
+	const vecf wetness_v = vecf_set1(wetness);
+	const vecf dryness_v = vecf_set1(dryness);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		const vecf dry_v = vecf_load(dry + i * kVectorSize);
+		const vecf wet_v = vecf_load(wet + i * kVectorSize);
+		
+		vecf_store(dst + i * kVectorSize, vecf_add(vecf_mul(dry_v, dryness_v), vecf_mul(wet_v, wetness_v)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = dry[i] * dryness + wet[i] * wetness;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void dryWetBuffer(float * dst, const float * dry, const float * wet, const float * wetness, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf one_v = vecf_set1(1.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		const vecf dry_v = vecf_load(dry + i * kVectorSize);
+		const vecf wet_v = vecf_load(wet + i * kVectorSize);
+		const vecf wetness_v = vecf_load(wetness + i * kVectorSize);
+		const vecf dryness_v = vecf_sub(one_v, wetness_v);
+		
+		vecf_store(dst + i * kVectorSize, vecf_add(vecf_mul(dry_v, dryness_v), vecf_mul(wet_v, wetness_v)));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		dst[i] = dry[i] * (1.f - wetness[i]) + wet[i] * wetness[i];
+}
+
+static AUDIO_KERNEL_ATTRIBUTES float sum(const float * __restrict src, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	vecf sum_v = vecf_set1(0.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+		sum_v = vecf_add(sum_v, vecf_load(src + i * kVectorSize));
+	
+	float sum_elems[kVectorSize];
+	vecf_store(sum_elems, sum_v);
+	
+	float result = 0.f;
+	
+	for (int i = 0; i < kVectorSize; ++i)
+		result += sum_elems[i];
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		result += src[i];
+	
+	return result;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES float peak(const float * __restrict src, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	vecf peak_v = vecf_set1(0.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+		peak_v = vecf_max(peak_v, vecf_abs(vecf_load(src + i * kVectorSize)));
+	
+	float peak_elems[kVectorSize];
+	vecf_store(peak_elems, peak_v);
+	
+	float result = 0.f;
+	
+	for (int i = 0; i < kVectorSize; ++i)
+		result = fmaxf(result, peak_elems[i]);
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+		result = fmaxf(result, fabsf(src[i]));
+	
+	return result;
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void clipHard(float * __restrict dst, const int numSamples)
+{
+	const int numVectors = numSamples / kVectorSize;
+	const vecf min_v = vecf_set1(-1.f);
+	const vecf max_v = vecf_set1(+1.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		vecf_store(dst_v, vecf_max(min_v, vecf_min(max_v, vecf_load(dst_v))));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+	{
+		const float value = dst[i];
+		
+		dst[i] = value < -1.f ? -1.f : value > +1.f ? +1.f : value;
+	}
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void clipSigmoidSqrt(float * __restrict dst, const int numSamples)
+{
+	// stays linear aroud zero for a longer period of time compared to clipSigmoidFast
+	
+	const int numVectors = numSamples / kVectorSize;
+	const vecf one_v = vecf_set1(1.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		const vecf value = vecf_load(dst_v);
+		
+		vecf_store(dst_v, vecf_div(value, vecf_sqrt(vecf_add(one_v, vecf_mul(value, value)))));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+	{
+		const float value = dst[i];
+		
+		dst[i] = value / sqrtf(1.f + value * value);
+	}
+}
+
+static AUDIO_KERNEL_ATTRIBUTES void clipSigmoidFast(float * __restrict dst, const int numSamples)
+{
+	// quickly begins to attenuate compared to clipSigmoidSqrt. more 'range' when clipping occurs
+	
+	const int numVectors = numSamples / kVectorSize;
+	const vecf one_v = vecf_set1(1.f);
+	
+	for (int i = 0; i < numVectors; ++i)
+	{
+		float * dst_v = dst + i * kVectorSize;
+		
+		const vecf value = vecf_load(dst_v);
+		
+		vecf_store(dst_v, vecf_div(value, vecf_add(one_v, vecf_abs(value))));
+	}
+	
+	for (int i = numVectors * kVectorSize; i < numSamples; ++i)
+	{
+		const float value = dst[i];
+		
+		dst[i] = value / (1.f + fabsf(value));
+	}
+}
+
+static const AudioKernels kernels =
+{
+	AUDIO_KERNEL_NAME,
+	setZero,
+	fill,
+	mul,
+	mulBuffer,
+	ramp,
+	setMul,
+	setMulBuffer,
+	add,
+	addMul,
+	addMulBuffer,
+	addMul4,
+	setAddMul,
+	mulMul,
+	mulMulBuffer,
+	dryWet,
+	dryWetBuffer,
+	sum,
+	peak,
+	clipHard,
+	clipSigmoidSqrt,
+	clipSigmoidFast
+};
@@ -0,0 +1,320 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "audioKernels.h"
+#include "audioTypes.h"
+#include "Debugging.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+	#define AUDIO_KERNELS_SSE2 1
+	#define AUDIO_KERNELS_AVX2 1
+	#define AUDIO_KERNELS_AVX512 1
+#else
+	#define AUDIO_KERNELS_SSE2 0
+	#define AUDIO_KERNELS_AVX2 0
+	#define AUDIO_KERNELS_AVX512 0
+#endif
+
+#if AUDIO_USE_NEON
+	// use an external dependency to translate SSE intrinsics to NEON intrinsics
+	#define AUDIO_KERNELS_NEON 1
+	#include "sse2neon.h"
+#else
+	#define AUDIO_KERNELS_NEON 0
+#endif
+
+#if AUDIO_KERNELS_SSE2 || AUDIO_KERNELS_AVX2 || AUDIO_KERNELS_AVX512
+	#include <immintrin.h>
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#endif
+#endif
+
+#if defined(__GNUC__)
+	#define AUDIO_KERNEL_TARGET(name) __attribute__((target(name)))
+#else
+	#define AUDIO_KERNEL_TARGET(name)
+#endif
+
+//
+
+namespace AudioKernels_Scalar
+{
+	#define AUDIO_KERNEL_NAME "scalar"
+	#define AUDIO_KERNEL_ATTRIBUTES
+	
+	typedef float vecf;
+	
+	static const int kVectorSize = 1;
+	
+	static inline vecf vecf_load(const float * src) { return *src; }
+	static inline void vecf_store(float * dst, const vecf value) { *dst = value; }
+	static inline vecf vecf_set1(const float value) { return value; }
+	static inline vecf vecf_add(const vecf a, const vecf b) { return a + b; }
+	static inline vecf vecf_sub(const vecf a, const vecf b) { return a - b; }
+	static inline vecf vecf_mul(const vecf a, const vecf b) { return a * b; }
+	static inline vecf vecf_div(const vecf a, const vecf b) { return a / b; }
+	static inline vecf vecf_min(const vecf a, const vecf b) { return a < b ? a : b; }
+	static inline vecf vecf_max(const vecf a, const vecf b) { return a > b ? a : b; }
+	static inline vecf vecf_sqrt(const vecf a) { return sqrtf(a); }
+	static inline vecf vecf_abs(const vecf a) { return fabsf(a); }
+	
+	#include "audioKernels-impl.h"
+	
+	#undef AUDIO_KERNEL_NAME
+	#undef AUDIO_KERNEL_ATTRIBUTES
+}
+
+#if AUDIO_KERNELS_SSE2 || AUDIO_KERNELS_NEON
+
+namespace AudioKernels_SSE2
+{
+#if AUDIO_KERNELS_NEON
+	#define AUDIO_KERNEL_NAME "neon"
+#else
+	#define AUDIO_KERNEL_NAME "sse2"
+#endif
+	#define AUDIO_KERNEL_ATTRIBUTES
+	
+	typedef __m128 vecf;
+	
+	static const int kVectorSize = 4;
+	
+	static inline vecf vecf_load(const float * src) { return _mm_loadu_ps(src); }
+	static inline void vecf_store(float * dst, const vecf value) { _mm_storeu_ps(dst, value); }
+	static inline vecf vecf_set1(const float value) { return _mm_set1_ps(value); }
+	static inline vecf vecf_add(const vecf a, const vecf b) { return _mm_add_ps(a, b); }
+	static inline vecf vecf_sub(const vecf a, const vecf b) { return _mm_sub_ps(a, b); }
+	static inline vecf vecf_mul(const vecf a, const vecf b) { return _mm_mul_ps(a, b); }
+	static inline vecf vecf_div(const vecf a, const vecf b) { return _mm_div_ps(a, b); }
+	static inline vecf vecf_min(const vecf a, const vecf b) { return _mm_min_ps(a, b); }
+	static inline vecf vecf_max(const vecf a, const vecf b) { return _mm_max_ps(a, b); }
+	static inline vecf vecf_sqrt(const vecf a) { return _mm_sqrt_ps(a); }
+	static inline vecf vecf_abs(const vecf a) { return _mm_andnot_ps(_mm_set1_ps(-0.f), a); }
+	
+	#include "audioKernels-impl.h"
+	
+	#undef AUDIO_KERNEL_NAME
+	#undef AUDIO_KERNEL_ATTRIBUTES
+}
+
+#endif
+
+#if AUDIO_KERNELS_AVX2
+
+namespace AudioKernels_AVX2
+{
+	#define AUDIO_KERNEL_NAME "avx2"
+	#define AUDIO_KERNEL_ATTRIBUTES AUDIO_KERNEL_TARGET("avx2")
+	
+	typedef __m256 vecf;
+	
+	static const int kVectorSize = 8;
+	
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_load(const float * src) { return _mm256_loadu_ps(src); }
+	static inline AUDIO_KERNEL_ATTRIBUTES void vecf_store(float * dst, const vecf value) { _mm256_storeu_ps(dst, value); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_set1(const float value) { return _mm256_set1_ps(value); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_add(const vecf a, const vecf b) { return _mm256_add_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_sub(const vecf a, const vecf b) { return _mm256_sub_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_mul(const vecf a, const vecf b) { return _mm256_mul_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_div(const vecf a, const vecf b) { return _mm256_div_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_min(const vecf a, const vecf b) { return _mm256_min_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_max(const vecf a, const vecf b) { return _mm256_max_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_sqrt(const vecf a) { return _mm256_sqrt_ps(a); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_abs(const vecf a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), a); }
+	
+	#include "audioKernels-impl.h"
+	
+	#undef AUDIO_KERNEL_NAME
+	#undef AUDIO_KERNEL_ATTRIBUTES
+}
+
+#endif
+
+#if AUDIO_KERNELS_AVX512
+
+namespace AudioKernels_AVX512
+{
+	#define AUDIO_KERNEL_NAME "avx512"
+	#define AUDIO_KERNEL_ATTRIBUTES AUDIO_KERNEL_TARGET("avx512f")
+	
+	typedef __m512 vecf;
+	
+	static const int kVectorSize = 16;
+	
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_load(const float * src) { return _mm512_loadu_ps(src); }
+	static inline AUDIO_KERNEL_ATTRIBUTES void vecf_store(float * dst, const vecf value) { _mm512_storeu_ps(dst, value); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_set1(const float value) { return _mm512_set1_ps(value); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_add(const vecf a, const vecf b) { return _mm512_add_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_sub(const vecf a, const vecf b) { return _mm512_sub_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_mul(const vecf a, const vecf b) { return _mm512_mul_ps(a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_div(const vecf a, const vecf b) { return _mm512_div_ps(a, b); }
+	// note : gcc implements many avx512 intrinsics using masked builtins with an undefined passthrough value, which
+	//        triggers -Wmaybe-uninitialized. the zero masked versions with all lanes enabled compile to the same
+	//        instructions. _mm512_andnot_ps requires avx512dq, so abs clears the sign bit using integer ops instead
+	
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_min(const vecf a, const vecf b) { return _mm512_maskz_min_ps(0xffff, a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_max(const vecf a, const vecf b) { return _mm512_maskz_max_ps(0xffff, a, b); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_sqrt(const vecf a) { return _mm512_maskz_sqrt_ps(0xffff, a); }
+	static inline AUDIO_KERNEL_ATTRIBUTES vecf vecf_abs(const vecf a) { return _mm512_castsi512_ps(_mm512_maskz_andnot_epi32(0xffff, _mm512_set1_epi32(0x80000000), _mm512_castps_si512(a))); }
+	
+	#include "audioKernels-impl.h"
+	
+	#undef AUDIO_KERNEL_NAME
+	#undef AUDIO_KERNEL_ATTRIBUTES
+}
+
+#endif
+
+//
+
+#if AUDIO_KERNELS_AVX2 || AUDIO_KERNELS_AVX512
+
+#if defined(_MSC_VER)
+
+static bool cpuSupportsXsaveFeatures(const uint64_t mask)
+{
+	int info[4];
+	__cpuid(info, 1);
+	
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	
+	if (osxsave == false)
+		return false;
+	
+	return (_xgetbv(0) & mask) == mask;
+}
+
+static bool cpuSupportsLeaf7Feature(const int bit)
+{
+	int info[4];
+	__cpuid(info, 0);
+	
+	if (info[0] < 7)
+		return false;
+	
+	__cpuidex(info, 7, 0);
+	
+	return (info[1] & (1 << bit)) != 0;
+}
+
+#endif
+
+static bool cpuSupportsAvx2()
+{
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+	// check the OS saves the xmm and ymm registers and the CPU supports avx2
+	return cpuSupportsXsaveFeatures(0x6) && cpuSupportsLeaf7Feature(5);
+#else
+	return false;
+#endif
+}
+
+static bool cpuSupportsAvx512()
+{
+#if defined(__GNUC__)
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx512f");
+#elif defined(_MSC_VER)
+	// check the OS saves the xmm, ymm, zmm and opmask registers and the CPU supports avx512f
+	return cpuSupportsXsaveFeatures(0xe6) && cpuSupportsLeaf7Feature(16);
+#else
+	return false;
+#endif
+}
+
+#endif
+
+//
+
+const AudioKernels * g_audioKernels = &AudioKernels_Scalar::kernels;
+
+int getAvailableAudioKernels(const AudioKernels ** kernels, const int maxKernels)
+{
+	int numKernels = 0;
+	
+	auto addKernels = [&](const AudioKernels * k)
+	{
+		if (numKernels < maxKernels)
+			kernels[numKernels++] = k;
+	};
+	
+	addKernels(&AudioKernels_Scalar::kernels);
+	
+#if AUDIO_KERNELS_SSE2 || AUDIO_KERNELS_NEON
+	addKernels(&AudioKernels_SSE2::kernels);
+#endif
+
+#if AUDIO_KERNELS_AVX2
+	if (cpuSupportsAvx2())
+		addKernels(&AudioKernels_AVX2::kernels);
+#endif
+
+#if AUDIO_KERNELS_AVX512
+	if (cpuSupportsAvx512())
+		addKernels(&AudioKernels_AVX512::kernels);
+#endif
+
+	return numKernels;
+}
+
+bool selectAudioKernels(const char * name)
+{
+	const AudioKernels * kernels[8];
+	const int numKernels = getAvailableAudioKernels(kernels, 8);
+	
+	for (int i = 0; i < numKernels; ++i)
+	{
+		if (strcmp(kernels[i]->name, name) == 0)
+		{
+			g_audioKernels = kernels[i];
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+// note : g_audioKernels is statically initialized to the scalar kernels, so audio buffer routines
+//        invoked during static initialization work before the best kernels are selected here
+
+static struct AudioKernelsInitializer
+{
+	AudioKernelsInitializer()
+	{
+		const AudioKernels * kernels[8];
+		const int numKernels = getAvailableAudioKernels(kernels, 8);
+		
+		g_audioKernels = kernels[numKernels - 1];
+	}
+} s_audioKernelsInitializer;
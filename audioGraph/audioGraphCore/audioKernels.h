@@ -0,0 +1,92 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+/**
+ * AudioKernels is a table of vectorized routines operating on buffers of samples. It contains the
+ * innermost loops of AudioFloat and the audioBuffer* functions. A table exists for each instruction
+ * set the library is compiled with (scalar, SSE2, AVX2, AVX-512 and NEON). The best table supported
+ * by the CPU is selected at startup.
+ * Kernels do not require their buffers to be aligned. Buffers may alias only where noted.
+ */
+struct AudioKernels
+{
+	const char * name;
+	
+	void (*setZero)(float * __restrict dst, const int numSamples);
+	void (*fill)(float * __restrict dst, const int numSamples, const float value);
+	
+	void (*mul)(float * __restrict dst, const int numSamples, const float scale); ///< dst *= scale
+	void (*mulBuffer)(float * __restrict dst, const float * __restrict scale, const int numSamples); ///< dst *= scale[i]
+	void (*ramp)(float * __restrict dst, const int numSamples, const float scale1, const float scale2); ///< dst *= lerp(scale1, scale2, i / numSamples)
+	
+	void (*setMul)(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale); ///< dst = src * scale
+	void (*setMulBuffer)(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples); ///< dst = src * scale[i]
+	
+	void (*add)(float * __restrict dst, const float * __restrict src, const int numSamples); ///< dst += src
+	void (*addMul)(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale); ///< dst += src * scale
+	void (*addMulBuffer)(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples); ///< dst += src * scale[i]
+	void (*addMul4)(float * __restrict dst, const float * const * __restrict src, const float * __restrict scale, const int numSamples); ///< dst += src[0] * scale[0] + src[1] * scale[1] + src[2] * scale[2] + src[3] * scale[3]
+	void (*setAddMul)(float * __restrict dst, const float * __restrict src1, const float * __restrict src2, const int numSamples, const float scale); ///< dst = src1 + src2 * scale
+	
+	void (*mulMul)(float * __restrict dst, const float * __restrict src, const int numSamples, const float scale); ///< dst *= src * scale
+	void (*mulMulBuffer)(float * __restrict dst, const float * __restrict src, const float * __restrict scale, const int numSamples); ///< dst *= src * scale[i]
+	
+	void (*dryWet)(float * dst, const float * dry, const float * wet, const int numSamples, const float wetness); ///< dst may alias dry or wet
+	void (*dryWetBuffer)(float * dst, const float * dry, const float * wet, const float * wetness, const int numSamples); ///< dst may alias dry or wet
+	
+	float (*sum)(const float * __restrict src, const int numSamples);
+	float (*peak)(const float * __restrict src, const int numSamples); ///< returns the maximum magnitude
+	
+	void (*clipHard)(float * __restrict dst, const int numSamples);
+	void (*clipSigmoidSqrt)(float * __restrict dst, const int numSamples);
+	void (*clipSigmoidFast)(float * __restrict dst, const int numSamples);
+};
+
+extern const AudioKernels * g_audioKernels;
+
+/**
+ * Returns the kernels currently in use.
+ */
+inline const AudioKernels & getAudioKernels()
+{
+	return *g_audioKernels;
+}
+
+/**
+ * Returns the kernels which are compiled in and supported by the CPU, starting with the scalar reference
+ * kernels, and ending with the kernels selected at startup.
+ */
+int getAvailableAudioKernels(const AudioKernels ** kernels, const int maxKernels);
+
+/**
+ * Selects the kernels to use by name. Returns false when the kernels are not available.
+ * Note this isn't thread-safe. It is meant to be called at startup, before any audio processing is done.
+ */
+bool selectAudioKernels(const char * name);
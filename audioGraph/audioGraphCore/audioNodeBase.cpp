@@ -25,6 +25,7 @@
 	OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include "audioKernels.h"
 #include "audioNodeBase.h"
 #include "graph_typeDefinitionLibrary.h"
 #include "Log.h"
@@ -37,10 +38,6 @@
 	#include <xmmintrin.h>
 #endif
 
-#if AUDIO_USE_GCC_VECTOR
-	typedef float vec4f __attribute__ ((vector_size(16))) __attribute__ ((aligned(16)));
-#endif
-
 //
 
 AUDIO_THREAD_LOCAL int g_currentAudioGraphTraversalId = -1;
@@ -64,9 +61,34 @@ void clearCurrentAudioGraphTraversalId()
 
 //
 
-AudioFloat AudioFloat::Zero(0.0);
-AudioFloat AudioFloat::One(1.0);
-AudioFloat AudioFloat::Half(0.5);
+AUDIO_THREAD_LOCAL int g_currentAudioUpdateSize = AUDIO_UPDATE_SIZE;
+
+void setCurrentAudioUpdateSize(const int updateSize)
+{
+	Assert(updateSize > 0 && updateSize <= AUDIO_MAX_UPDATE_SIZE);
+	g_currentAudioUpdateSize = updateSize;
+}
+
+//
+
+// note : the constants are shared between graphs, which may use different update sizes. we expand them
+//        up-front to the maximum update size, so expand() never needs to touch them
+
+static AudioFloat makeExpandedConstant(const float value)
+{
+	AudioFloat result(value);
+	
+	for (int i = 0; i < AUDIO_MAX_UPDATE_SIZE; ++i)
+		result.samples[i] = value;
+	
+	result.isExpanded = true;
+	
+	return result;
+}
+
+AudioFloat AudioFloat::Zero = makeExpandedConstant(0.f);
+AudioFloat AudioFloat::One = makeExpandedConstant(1.f);
+AudioFloat AudioFloat::Half = makeExpandedConstant(.5f);
 
 float AudioFloat::getMean() const
 {
@@ -74,9 +96,11 @@ float AudioFloat::getMean() const
 		return getScalar();
 	else
 	{
-		const float sum = audioBufferSum(samples, AUDIO_UPDATE_SIZE);
+		const int numSamples = getCurrentAudioUpdateSize();
+		
+		const float sum = audioBufferSum(samples, numSamples);
 		
-		const float mean = sum / AUDIO_UPDATE_SIZE;
+		const float mean = sum / numSamples;
 		
 		return mean;
 	}
@@ -92,22 +116,7 @@ void AudioFloat::expand() const
 		{
 			self->isExpanded = true;
 			
-		#if AUDIO_USE_SSE
-			const __m128 scalar_4 = _mm_set1_ps(samples[0]);
-			__m128 * samples_4 = (__m128*)self->samples;
-			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE / 4; ++i)
-				samples_4[i] = scalar_4;
-		#elif AUDIO_USE_GCC_VECTOR
-			const vec4f scalar_4 = { samples[0], samples[0], samples[0], samples[0] };
-			vec4f * samples_4 = (vec4f*)self->samples;
-			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE / 4; ++i)
-				samples_4[i] = scalar_4;
-		#else
-			for (int i = 1; i < AUDIO_UPDATE_SIZE; ++i)
-				self->samples[i] = samples[0];
-		#endif
+			getAudioKernels().fill(self->samples, getCurrentAudioUpdateSize(), samples[0]);
 		}
 	}
 	else
@@ -136,7 +145,7 @@ void AudioFloat::set(const AudioFloat & other)
 	{
 		setVector();
 		
-		memcpy(samples, other.samples, AUDIO_UPDATE_SIZE * sizeof(float));
+		memcpy(samples, other.samples, getCurrentAudioUpdateSize() * sizeof(float));
 	}
 }
 
@@ -144,14 +153,13 @@ void AudioFloat::setMul(const AudioFloat & other, const float gain)
 {
 	if (other.isScalar)
 	{
-		setScalar(other.getScalar());
+		setScalar(other.getScalar() * gain);
 	}
 	else
 	{
 		setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] = other.samples[i] * gain;
+		getAudioKernels().setMul(samples, other.samples, getCurrentAudioUpdateSize(), gain);
 	}
 }
 
@@ -167,8 +175,7 @@ void AudioFloat::setMul(const AudioFloat & other, const AudioFloat & gain)
 		
 		setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] = other.samples[i] * gain.getScalar();
+		getAudioKernels().setMul(samples, other.samples, getCurrentAudioUpdateSize(), gain.getScalar());
 	}
 	else if (other.isScalar)
 	{
@@ -176,8 +183,7 @@ void AudioFloat::setMul(const AudioFloat & other, const AudioFloat & gain)
 		
 		setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] = other.getScalar() * gain.samples[i];
+		getAudioKernels().setMul(samples, gain.samples, getCurrentAudioUpdateSize(), other.getScalar());
 	}
 	else
 	{
@@ -185,8 +191,7 @@ void AudioFloat::setMul(const AudioFloat & other, const AudioFloat & gain)
 		
 		setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] = other.samples[i] * gain.samples[i];
+		getAudioKernels().setMulBuffer(samples, other.samples, gain.samples, getCurrentAudioUpdateSize());
 	}
 }
 
@@ -206,7 +211,7 @@ void AudioFloat::add(const AudioFloat & other)
 		
 		setVector();
 		
-		audioBufferAdd(samples, other.samples, AUDIO_UPDATE_SIZE);
+		audioBufferAdd(samples, other.samples, getCurrentAudioUpdateSize());
 	}
 }
 
@@ -226,7 +231,7 @@ void AudioFloat::addMul(const AudioFloat & other, const float gain)
 		
 		setVector();
 		
-		audioBufferAdd(samples, other.samples, AUDIO_UPDATE_SIZE, gain);
+		audioBufferAdd(samples, other.samples, getCurrentAudioUpdateSize(), gain);
 	}
 }
 
@@ -248,11 +253,11 @@ void AudioFloat::addMul(const AudioFloat & other, const AudioFloat & gain)
 		
 		if (gain.isScalar)
 		{
-			audioBufferAdd(samples, other.samples, AUDIO_UPDATE_SIZE, gain.getScalar());
+			audioBufferAdd(samples, other.samples, getCurrentAudioUpdateSize(), gain.getScalar());
 		}
 		else
 		{
-			audioBufferAdd(samples, other.samples, AUDIO_UPDATE_SIZE, gain.samples);
+			audioBufferAdd(samples, other.samples, getCurrentAudioUpdateSize(), gain.samples);
 		}
 	}
 }
@@ -294,7 +299,7 @@ void AudioFloat::mul(const AudioFloat & other)
 			
 			//
 			
-			audioBufferMul(samples, AUDIO_UPDATE_SIZE, other.samples);
+			audioBufferMul(samples, getCurrentAudioUpdateSize(), other.samples);
 		}
 	}
 	else if (other.isScalar)
@@ -318,7 +323,7 @@ void AudioFloat::mul(const AudioFloat & other)
 		}
 		else
 		{
-			audioBufferMul(samples, AUDIO_UPDATE_SIZE, otherValue);
+			audioBufferMul(samples, getCurrentAudioUpdateSize(), otherValue);
 		}
 	}
 	else
@@ -330,43 +335,54 @@ void AudioFloat::mul(const AudioFloat & other)
 		
 		//
 		
-		audioBufferMul(samples, AUDIO_UPDATE_SIZE, other.samples);
+		audioBufferMul(samples, getCurrentAudioUpdateSize(), other.samples);
 	}
 }
 
 void AudioFloat::mulMul(const AudioFloat & other, const float gain)
 {
-	other.expand();
-	
-	expand();
-	
-	//
-	
-	setVector();
-	
-	for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-		samples[i] *= other.samples[i] * gain;
+	if (isScalar && other.isScalar)
+	{
+		setScalar(getScalar() * other.getScalar() * gain);
+	}
+	else
+	{
+		other.expand();
+		
+		expand();
+		
+		//
+		
+		setVector();
+		
+		getAudioKernels().mulMul(samples, other.samples, getCurrentAudioUpdateSize(), gain);
+	}
 }
 
 void AudioFloat::mulMul(const AudioFloat & other, const AudioFloat & gain)
 {
-	other.expand();
-	
-	expand();
-	
-	//
-	
-	setVector();
-	
-	if (gain.isScalar)
+	if (isScalar && other.isScalar && gain.isScalar)
 	{
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] *= other.samples[i] * gain.getScalar();
+		setScalar(getScalar() * other.getScalar() * gain.getScalar());
 	}
 	else
 	{
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
-			samples[i] *= other.samples[i] * gain.samples[i];
+		other.expand();
+		
+		expand();
+		
+		//
+		
+		setVector();
+		
+		if (gain.isScalar)
+		{
+			getAudioKernels().mulMul(samples, other.samples, getCurrentAudioUpdateSize(), gain.getScalar());
+		}
+		else
+		{
+			getAudioKernels().mulMulBuffer(samples, other.samples, gain.samples, getCurrentAudioUpdateSize());
+		}
 	}
 }
 
@@ -460,7 +476,7 @@ void AudioFloatArray::update()
 				
 				if (a->isScalar == false)
 				{
-					audioBufferAdd(sum->samples, a->samples, AUDIO_UPDATE_SIZE);
+					audioBufferAdd(sum->samples, a->samples, getCurrentAudioUpdateSize());
 				}
 			}
 		}
@@ -572,6 +588,9 @@ AudioNodeBase::AudioNodeBase()
 	, editorIsTriggered(false)
 	, isPassthrough(false)
 	, isDeprecated(false)
+	, isThreadSafe(false)
+	, isScalarPreserving(false)
+	, isControlRate(false)
 #if ENABLE_AUDIOGRAPH_CPU_TIMING
 	, tickTimeAvg(0)
 #endif
@@ -593,6 +612,31 @@ void AudioNodeBase::traverseTick(const int traversalId, const float dt)
 	
 	//
 	
+	handleTriggersAndTick(dt);
+}
+
+void AudioNodeBase::scheduledTick(const int traversalId, const float dt)
+{
+	Assert(lastTickTraversalId != traversalId);
+	lastTickTraversalId = traversalId;
+	
+	//
+	
+	handleTriggersAndTick(dt);
+	
+#if defined(DEBUG)
+	// verify the node keeps its promise to output scalars when running at control rate
+	
+	if (isControlRate)
+	{
+		for (auto & output : outputs)
+			Assert(output.type != kAudioPlugType_FloatVec || output.getAudioFloat().isScalar);
+	}
+#endif
+}
+
+void AudioNodeBase::handleTriggersAndTick(const float dt)
+{
 	for (int i = 0; i < inputs.size(); ++i)
 	{
 		if (inputs[i].isTriggered)
@@ -618,7 +662,7 @@ void AudioNodeBase::traverseTick(const int traversalId, const float dt)
 	//
 	
 #if ENABLE_AUDIOGRAPH_CPU_TIMING
-	tickTimeAvg = (tickTimeAvg * 99 + (t2 - t1) * 1 * (SAMPLE_RATE / AUDIO_UPDATE_SIZE)) / 100;
+	tickTimeAvg = (tickTimeAvg * 99 + (t2 - t1) * 1 * (SAMPLE_RATE / getCurrentAudioUpdateSize())) / 100;
 #endif
 }
 
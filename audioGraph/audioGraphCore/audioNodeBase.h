@@ -49,6 +49,18 @@ void clearCurrentAudioGraphTraversalId();
 
 //
 
+extern AUDIO_THREAD_LOCAL int g_currentAudioUpdateSize;
+
+// returns the number of samples to process per tick. set when pushing an audio graph, from its context
+inline int getCurrentAudioUpdateSize()
+{
+	return g_currentAudioUpdateSize;
+}
+
+void setCurrentAudioUpdateSize(const int updateSize);
+
+//
+
 struct AudioNodeDescription
 {
 	std::vector<std::string> lines;
@@ -80,6 +92,9 @@ struct AudioNodeBase
 	
 	bool isPassthrough;
 	bool isDeprecated;
+	bool isThreadSafe; // when set, the node may be ticked on a worker thread when the graph is ticked in parallel. nodes which allocate voices, or rely on other shared state, should leave this unset
+	bool isScalarPreserving; // when set, the node promises to output scalars when all of its audio value inputs are scalar
+	bool isControlRate; // set by AudioGraph::updateSchedule when all of the node's inputs are known to be scalar. the node runs at control rate, evaluating a single value per block. when ticking in parallel, the outputs of control rate nodes which only feed other control rate nodes are left unexpanded
 	
 #if ENABLE_AUDIOGRAPH_CPU_TIMING
 	int tickTimeAvg;
@@ -91,7 +106,9 @@ struct AudioNodeBase
 	{
 	}
 	
-	void traverseTick(const int traversalId, const float dt);
+	void traverseTick(const int traversalId, const float dt); // ticks the predeps (recursively) and then the node itself
+	void scheduledTick(const int traversalId, const float dt); // ticks the node itself. the predeps must have been ticked already
+	void handleTriggersAndTick(const float dt);
 	
 	void trigger(const int outputSocketIndex);
 	
@@ -240,6 +257,7 @@ struct AudioNodeBase
 	virtual void shut() { }
 	virtual void tick(const float dt) { }
 	virtual void handleTrigger(const int inputSocketIndex) { }
+	virtual void handleInputValueChanged(const int inputSocketIndex) { } // called from the main thread when the real-time connection edits the value of an input. occurs inside AUDIO_SCOPE
 	
 	virtual void getDescription(AudioNodeDescription & d) { }
 	virtual bool getFilterResponse(float * magnitude, const int numSteps) const { return false; }
@@ -48,3 +48,23 @@
 	#define audioSetThreadName(name) do { } while (false)
 
 #endif
+
+/**
+ * Timing information for a single worker (thread) of AudioWorkerPool. When the audio graph is ticked in
+ * parallel, each worker keeps track of how much of its time is spent executing tasks.
+ */
+struct AudioWorkerTiming
+{
+	int busyTimeAvg = 0; ///< Average time spent executing tasks, in microseconds per second. Only updated when ENABLE_AUDIOGRAPH_CPU_TIMING is set.
+	int numTasks = 0;    ///< The number of tasks executed during the last tick.
+};
+
+/**
+ * Statistics gathered when compiling the schedule of an audio graph.
+ */
+struct AudioGraphScheduleStats
+{
+	int numNodes = 0;            ///< The number of nodes in the schedule.
+	int numControlRateNodes = 0; ///< The number of nodes demoted to control rate by scalar propagation.
+	int numScalarOnlyNodes = 0;  ///< The number of control rate nodes read by control rate nodes only. Their outputs are never expanded.
+};
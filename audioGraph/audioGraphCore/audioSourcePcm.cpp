@@ -28,6 +28,10 @@
 #include "audioSourcePcm.h"
 #include <string.h>
 
+// pitch is limited to four octaves up or down, to bound the amount of input needed per output sample
+static const float kMinPitch = 1.f / 16.f;
+static const float kMaxPitch = 16.f;
+
 AudioSourcePcm::AudioSourcePcm()
 	: AudioSource()
 	, pcmData(nullptr)
@@ -41,7 +45,15 @@ AudioSourcePcm::AudioSourcePcm()
 	, rangeEnd(0)
 	, maxLoopCount(0)
 	, loopCount(0)
+	, pitch(1.f)
+	, resampleQuality(kResampleQuality_Sinc16)
+	, resampler()
+	, isResampling(false)
 {
+	// note : initialize the resampler here, so its history and filter banks are allocated before the audio thread
+	//        starts generating samples. generateResampled re-initializes it without allocating
+	
+	resampler.init(1, resampleQuality);
 }
 
 void AudioSourcePcm::setPcmData(const PcmData * _pcmData, const int _samplePosition)
@@ -155,35 +167,90 @@ void AudioSourcePcm::generate(SAMPLE_ALIGN16 float * __restrict samples, const i
 			isDone = true;
 		}
 	}
+	else if (isResampling || pitch != 1.f)
+	{
+		generateResampled(samples, numSamples);
+	}
 	else
 	{
-		const float * __restrict pcmDataSamples = pcmData->samples;
-		
-		for (int i = 0; i < numSamples; ++i)
+		generatePcm(samples, numSamples);
+	}
+}
+
+void AudioSourcePcm::generatePcm(float * __restrict samples, const int numSamples)
+{
+	const float * __restrict pcmDataSamples = pcmData->samples;
+	
+	for (int i = 0; i < numSamples; ++i)
+	{
+		if (samplePosition < rangeBegin)
+			samplePosition = rangeBegin;
+		if (samplePosition >= rangeEnd)
 		{
-			if (samplePosition < rangeBegin)
-				samplePosition = rangeBegin;
-			if (samplePosition >= rangeEnd)
+			if (loop && (maxLoopCount == 0 || loopCount + 1 < maxLoopCount))
 			{
-				if (loop && (maxLoopCount == 0 || loopCount + 1 < maxLoopCount))
-				{
-					samplePosition = rangeBegin;
-					hasLooped = true;
-					loopCount++;
-				}
-				else
-				{
-					isDone = true;
-					isPlaying = false;
-				}
+				samplePosition = rangeBegin;
+				hasLooped = true;
+				loopCount++;
 			}
-			
-			if (samplePosition < 0 || samplePosition >= pcmData->numSamples)
-				samples[i] = 0.f;
 			else
-				samples[i] = pcmDataSamples[samplePosition];
-			
-			samplePosition += 1;
+			{
+				isDone = true;
+				isPlaying = false;
+			}
 		}
+		
+		if (samplePosition < 0 || samplePosition >= pcmData->numSamples)
+			samples[i] = 0.f;
+		else
+			samples[i] = pcmDataSamples[samplePosition];
+		
+		samplePosition += 1;
+	}
+}
+
+void AudioSourcePcm::generateResampled(float * __restrict samples, const int numSamples)
+{
+	if (isResampling == false || resampler.getQuality() != resampleQuality)
+	{
+		resampler.init(1, resampleQuality);
+		
+		isResampling = true;
+	}
+	
+	resampler.setRatio(pitch < kMinPitch ? kMinPitch : pitch > kMaxPitch ? kMaxPitch : pitch);
+	
+	// generate the PCM data at its original rate in chunks, and resample it to the requested pitch
+	
+	const int kMaxInputFrames = 1024;
+	const int kMaxOutputFrames = (kMaxInputFrames - 64) / int(kMaxPitch);
+	
+	ALIGN16 float input[kMaxInputFrames];
+	
+	for (int i = 0; i < numSamples; i += kMaxOutputFrames)
+	{
+		const int numOutputFrames = numSamples - i < kMaxOutputFrames ? numSamples - i : kMaxOutputFrames;
+		const int numInputFrames = resampler.calculateNumInputFrames(numOutputFrames);
+		
+		generatePcm(input, numInputFrames);
+		
+		const float * inputPtr = input;
+		float * outputPtr = samples + i;
+		
+		resampler.process(&inputPtr, numInputFrames, &outputPtr, numOutputFrames);
+	}
+	
+	if (pitch == 1.f)
+	{
+		// back to normal speed. rewind by the amount of look ahead, so playback continues where the resampler left off
+		
+		samplePosition -= resampler.calculateNumLookaheadFrames();
+		
+		if (samplePosition < rangeBegin && loop)
+			samplePosition += rangeEnd - rangeBegin;
+		if (samplePosition < rangeBegin)
+			samplePosition = rangeBegin;
+		
+		isResampling = false;
 	}
 }
@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include "PolyphaseResampler.h"
 #include "soundmix.h"
 
 struct AudioSourcePcm : AudioSource
@@ -47,6 +48,12 @@ struct AudioSourcePcm : AudioSource
 	int maxLoopCount;
 	int loopCount;
 	
+	float pitch; // playback speed. 2 plays back one octave higher, .5 one octave lower
+	ResampleQuality resampleQuality;
+	
+	PolyphaseResampler resampler;
+	bool isResampling;
+	
 	AudioSourcePcm();
 	
 	void setPcmData(const PcmData * pcmData, const int samplePosition = 0);
@@ -66,4 +73,8 @@ struct AudioSourcePcm : AudioSource
 	void resetLoopCount();
 
 	virtual void generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples) override;
+	
+private:
+	void generatePcm(float * __restrict samples, const int numSamples);
+	void generateResampled(float * __restrict samples, const int numSamples);
 };
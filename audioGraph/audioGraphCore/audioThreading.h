@@ -27,8 +27,11 @@
 
 #pragma once
 
+#include "Debugging.h"
 #include "Multicore/Mutex.h"
+#include <atomic>
 #include <stdint.h>
+#include <vector>
 
 struct AudioMutexBase
 {
@@ -88,3 +91,123 @@ struct AudioThreadId
 	
 	bool checkThreadId() const; ///< Asserts the current thread is equal to the thread the object was previously assigned to.
 };
+
+/**
+ * Wait-free single producer, single consumer queue with a fixed capacity. One thread may push elements
+ * while another thread pops them, without either thread having to wait for the other. Neither push nor pop
+ * allocate memory. The capacity is set using init, which must be called before the queue is shared.
+ */
+template <typename T>
+struct AudioSpscQueue
+{
+	std::vector<T> elems;
+	uint32_t mask = 0;
+	
+	std::atomic<uint32_t> head; ///< Index of the next element to pop. Written by the consumer only.
+	std::atomic<uint32_t> tail; ///< Index of the next element to push. Written by the producer only.
+	
+	AudioSpscQueue()
+		: head(0)
+		, tail(0)
+	{
+	}
+	
+	void init(const int capacity) ///< Allocates storage for the queue. The capacity must be a power of two.
+	{
+		Assert((capacity & (capacity - 1)) == 0);
+		
+		elems.resize(capacity);
+		mask = capacity - 1;
+		
+		head = 0;
+		tail = 0;
+	}
+	
+	bool push(const T & value) ///< Called from the producer thread. Returns false when the queue is full.
+	{
+		const uint32_t currentTail = tail.load(std::memory_order_relaxed);
+		
+		if (currentTail - head.load(std::memory_order_acquire) == elems.size())
+			return false;
+		
+		elems[currentTail & mask] = value;
+		
+		tail.store(currentTail + 1, std::memory_order_release);
+		
+		return true;
+	}
+	
+	bool pop(T & value) ///< Called from the consumer thread. Returns false when the queue is empty.
+	{
+		const uint32_t currentHead = head.load(std::memory_order_relaxed);
+		
+		if (currentHead == tail.load(std::memory_order_acquire))
+			return false;
+		
+		value = elems[currentHead & mask];
+		
+		head.store(currentHead + 1, std::memory_order_release);
+		
+		return true;
+	}
+	
+	bool isEmpty() const ///< Returns true when the consumer has popped all of the elements pushed so far.
+	{
+		return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+	}
+};
+
+/**
+ * Wait-free triple buffer, for passing the latest version of a value from a producer thread to a consumer thread.
+ * The producer fills in the write buffer and publishes it. The consumer calls update to pick up the most recently
+ * published buffer, if any, and reads it using getReadBuffer. Intermediate versions may be skipped by the consumer.
+ * Note that the write buffer isn't cleared on publish, and contains a version published earlier.
+ */
+template <typename T>
+struct AudioTripleBuffer
+{
+	static const int kIndexMask = 3;
+	static const int kNewDataBit = 4;
+	
+	T buffers[3];
+	
+	int writeIndex = 0;       ///< Owned by the producer.
+	int readIndex = 1;        ///< Owned by the consumer.
+	std::atomic<int> pending; ///< Index of the buffer in between the producer and consumer, plus kNewDataBit when it hasn't been picked up yet.
+	
+	AudioTripleBuffer()
+		: pending(2)
+	{
+	}
+	
+	void reset(const T & value) ///< Sets all of the buffers to the same value. May only be called when the triple buffer isn't shared.
+	{
+		for (auto & buffer : buffers)
+			buffer = value;
+	}
+	
+	T & getWriteBuffer() ///< Called from the producer thread.
+	{
+		return buffers[writeIndex];
+	}
+	
+	void publish() ///< Called from the producer thread. Makes the write buffer available to the consumer.
+	{
+		writeIndex = pending.exchange(writeIndex | kNewDataBit, std::memory_order_acq_rel) & kIndexMask;
+	}
+	
+	bool update() ///< Called from the consumer thread. Returns true when a newly published buffer was picked up.
+	{
+		if ((pending.load(std::memory_order_acquire) & kNewDataBit) == 0)
+			return false;
+		
+		readIndex = pending.exchange(readIndex, std::memory_order_acq_rel) & kIndexMask;
+		
+		return true;
+	}
+	
+	const T & getReadBuffer() const ///< Called from the consumer thread.
+	{
+		return buffers[readIndex];
+	}
+};
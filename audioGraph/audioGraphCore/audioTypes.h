@@ -29,10 +29,27 @@
 
 #include <string>
 
+// the default number of samples processed per tick. the actual update size is chosen at runtime when
+// creating the audio graph context (see AudioGraphContext::init), and may be anything up to AUDIO_MAX_UPDATE_SIZE
+
 #ifndef AUDIO_UPDATE_SIZE
 	#define AUDIO_UPDATE_SIZE 256
 #endif
 
+// the maximum number of samples processed per tick. this determines the storage size of audio buffers
+
+#ifndef AUDIO_MAX_UPDATE_SIZE
+	#if AUDIO_UPDATE_SIZE > 512
+		#define AUDIO_MAX_UPDATE_SIZE AUDIO_UPDATE_SIZE
+	#else
+		#define AUDIO_MAX_UPDATE_SIZE 512
+	#endif
+#endif
+
+#if AUDIO_MAX_UPDATE_SIZE < AUDIO_UPDATE_SIZE
+	#error "AUDIO_MAX_UPDATE_SIZE must be greater than or equal to AUDIO_UPDATE_SIZE"
+#endif
+
 #define SAMPLE_RATE 44100
 
 #ifndef AUDIO_USE_SSE
@@ -173,6 +190,7 @@ struct AudioControlValue
 struct AudioEvent
 {
 	std::string name;
+	int id = -1;
 	int refCount = 0;
 };
 
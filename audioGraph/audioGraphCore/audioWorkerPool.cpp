@@ -0,0 +1,495 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "audioTypes.h"
+#include "audioWorkerPool.h"
+#include "Debugging.h"
+#include "Timer.h"
+
+#if AUDIO_USE_SSE
+	#include <xmmintrin.h>
+#endif
+
+static void cpuRelax()
+{
+#if AUDIO_USE_SSE
+	_mm_pause();
+#endif
+}
+
+//
+
+void AudioTaskGraph::clear()
+{
+	tasks.clear();
+	successors.clear();
+	callingThreadTasks.clear();
+	dependencies.clear();
+}
+
+int AudioTaskGraph::addTask(const bool runOnCallingThread)
+{
+	Task task;
+	task.runOnCallingThread = runOnCallingThread;
+	
+	tasks.push_back(task);
+	
+	return (int)tasks.size() - 1;
+}
+
+void AudioTaskGraph::addDependency(const int taskIndex, const int dependsOnTaskIndex)
+{
+	Assert(taskIndex >= 0 && taskIndex < (int)tasks.size());
+	Assert(dependsOnTaskIndex >= 0 && dependsOnTaskIndex < (int)tasks.size());
+	Assert(taskIndex != dependsOnTaskIndex);
+	
+	dependencies.push_back(std::make_pair(taskIndex, dependsOnTaskIndex));
+}
+
+void AudioTaskGraph::finalize()
+{
+	// count the number of dependencies and successors for each task
+	
+	for (auto & task : tasks)
+	{
+		task.numDeps = 0;
+		task.numSuccessors = 0;
+	}
+	
+	for (auto & dependency : dependencies)
+	{
+		tasks[dependency.first].numDeps++;
+		tasks[dependency.second].numSuccessors++;
+	}
+	
+	// allocate successor ranges and fill them in
+	
+	int numSuccessors = 0;
+	
+	for (auto & task : tasks)
+	{
+		task.firstSuccessor = numSuccessors;
+		numSuccessors += task.numSuccessors;
+		task.numSuccessors = 0;
+	}
+	
+	successors.resize(numSuccessors);
+	
+	for (auto & dependency : dependencies)
+	{
+		auto & task = tasks[dependency.second];
+		
+		successors[task.firstSuccessor + task.numSuccessors] = dependency.first;
+		task.numSuccessors++;
+	}
+	
+	dependencies.clear();
+	
+	// gather the tasks which must run on the calling thread
+	
+	callingThreadTasks.clear();
+	
+	for (size_t i = 0; i < tasks.size(); ++i)
+		if (tasks[i].runOnCallingThread)
+			callingThreadTasks.push_back(i);
+}
+
+//
+
+void AudioWorkerPool::TaskQueue::reserve(const int capacity)
+{
+	// note : each task is pushed at most once per execution, so the queue never needs to wrap around
+	
+	if ((int)elems.size() < capacity)
+		elems.resize(capacity);
+}
+
+void AudioWorkerPool::TaskQueue::reset(const int capacity)
+{
+	Assert((int)elems.size() >= capacity);
+	
+	head = 0;
+	tail = 0;
+}
+
+void AudioWorkerPool::TaskQueue::push(const int taskIndex)
+{
+	while (lock.test_and_set(std::memory_order_acquire))
+		cpuRelax();
+	{
+		Assert(tail < (int)elems.size());
+		elems[tail++] = taskIndex;
+	}
+	lock.clear(std::memory_order_release);
+}
+
+bool AudioWorkerPool::TaskQueue::pop(int & taskIndex)
+{
+	bool result = false;
+	
+	while (lock.test_and_set(std::memory_order_acquire))
+		cpuRelax();
+	{
+		if (tail > head)
+		{
+			taskIndex = elems[--tail];
+			result = true;
+		}
+	}
+	lock.clear(std::memory_order_release);
+	
+	return result;
+}
+
+bool AudioWorkerPool::TaskQueue::steal(int & taskIndex)
+{
+	bool result = false;
+	
+	while (lock.test_and_set(std::memory_order_acquire))
+		cpuRelax();
+	{
+		if (tail > head)
+		{
+			taskIndex = elems[head++];
+			result = true;
+		}
+	}
+	lock.clear(std::memory_order_release);
+	
+	return result;
+}
+
+//
+
+AudioWorkerPool::AudioWorkerPool()
+	: executionEpoch(-1)
+	, numActiveWorkers(0)
+	, numRemainingTasks(0)
+{
+}
+
+AudioWorkerPool::~AudioWorkerPool()
+{
+	Assert(workers.empty());
+}
+
+void AudioWorkerPool::init(const int numThreads)
+{
+	shut();
+	
+	//
+	
+	stopRequested = false;
+	
+	for (int i = 0; i < numThreads + 1; ++i)
+	{
+		Worker * worker = new Worker();
+		worker->pool = this;
+		worker->index = i;
+		
+		workers.emplace_back(worker);
+	}
+	
+	for (int i = 1; i < numThreads + 1; ++i)
+	{
+		Worker * worker = workers[i].get();
+		
+		worker->thread = std::thread(threadMain, worker);
+	}
+}
+
+void AudioWorkerPool::shut()
+{
+	{
+		std::unique_lock<std::mutex> lock(wakeupMutex);
+		
+		stopRequested = true;
+		
+		wakeupCond.notify_all();
+	}
+	
+	for (auto & worker : workers)
+	{
+		if (worker->thread.joinable())
+			worker->thread.join();
+	}
+	
+	workers.clear();
+}
+
+int AudioWorkerPool::getNumWorkers() const
+{
+	return (int)workers.size();
+}
+
+const AudioWorkerTiming & AudioWorkerPool::getWorkerTiming(const int workerIndex) const
+{
+	Assert(workerIndex >= 0 && workerIndex < (int)workers.size());
+	
+	return workers[workerIndex]->timing;
+}
+
+void AudioWorkerPool::reserve(const int numTasks)
+{
+	Assert(executionEpoch == -1);
+	
+	if (numPendingDepsCapacity < numTasks)
+	{
+		numPendingDeps.reset(new std::atomic<int>[numTasks]);
+		numPendingDepsCapacity = numTasks;
+	}
+	
+	for (auto & worker : workers)
+		worker->queue.reserve(numTasks);
+}
+
+void AudioWorkerPool::execute(const AudioTaskGraph & in_taskGraph, TaskFunction function, void * userData, const int updateSize)
+{
+	Assert(executionEpoch == -1);
+	Assert(workers.empty() == false);
+	
+	const int numTasks = (int)in_taskGraph.tasks.size();
+	
+	if (numTasks == 0)
+		return;
+	
+	// prepare the execution state
+	
+	taskGraph = &in_taskGraph;
+	taskFunction = function;
+	taskUserData = userData;
+	taskUpdateSize = updateSize;
+	
+	// note : execute mustn't allocate. the storage for the execution state is allocated up front by reserve
+	
+	Assert(numPendingDepsCapacity >= numTasks);
+	
+	for (int i = 0; i < numTasks; ++i)
+		numPendingDeps[i].store(in_taskGraph.tasks[i].numDeps, std::memory_order_relaxed);
+	
+	numRemainingTasks.store(numTasks, std::memory_order_relaxed);
+	
+	for (auto & worker : workers)
+	{
+		worker->queue.reset(numTasks);
+		worker->busyTime = 0;
+		worker->numTasks = 0;
+	}
+	
+	// distribute the initially ready tasks over the workers
+	
+	const int numWorkers = (int)workers.size();
+	
+	int workerIndex = 0;
+	
+	for (int i = 0; i < numTasks; ++i)
+	{
+		auto & task = in_taskGraph.tasks[i];
+		
+		if (task.numDeps == 0 && task.runOnCallingThread == false)
+		{
+			workers[workerIndex]->queue.push(i);
+			
+			workerIndex = (workerIndex + 1) % numWorkers;
+		}
+	}
+	
+	// wake up the worker threads
+	
+	int64_t epoch;
+	
+	{
+		std::unique_lock<std::mutex> lock(wakeupMutex);
+		
+		epoch = ++wakeupEpoch;
+		
+		executionEpoch.store(epoch);
+		
+		wakeupCond.notify_all();
+	}
+	
+	// participate in executing the tasks. tasks which must run on the calling thread are executed in order
+	
+	Worker * worker = workers[0].get();
+	
+	size_t nextCallingThreadTask = 0;
+	
+	while (numRemainingTasks.load() != 0)
+	{
+		if (nextCallingThreadTask < in_taskGraph.callingThreadTasks.size())
+		{
+			const int taskIndex = in_taskGraph.callingThreadTasks[nextCallingThreadTask];
+			
+			if (numPendingDeps[taskIndex].load() == 0)
+			{
+				runTask(worker, taskIndex);
+				
+				nextCallingThreadTask++;
+				
+				continue;
+			}
+		}
+		
+		if (tryRunTask(worker) == false)
+			cpuRelax();
+	}
+	
+	// close the execution and wait for the worker threads which joined it to leave
+	
+	executionEpoch.store(-1);
+	
+	while (numActiveWorkers.load() != 0)
+		cpuRelax();
+	
+	finishTiming(worker);
+	
+	taskGraph = nullptr;
+	taskFunction = nullptr;
+	taskUserData = nullptr;
+}
+
+void AudioWorkerPool::threadMain(Worker * worker)
+{
+	audioSetThreadName("AudioGraph Worker");
+	
+	AudioWorkerPool * pool = worker->pool;
+	
+	int64_t seenEpoch = 0;
+	
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(pool->wakeupMutex);
+			
+			pool->wakeupCond.wait(lock, [&]() { return pool->stopRequested || pool->wakeupEpoch != seenEpoch; });
+			
+			if (pool->stopRequested)
+				break;
+			
+			seenEpoch = pool->wakeupEpoch;
+		}
+		
+		// note : we must register ourselves as being active before checking if the execution is still in progress.
+		//        execute() closes the execution before checking the number of active workers, so either we see
+		//        the execution as closed, or execute() waits for us to finish
+		
+		pool->numActiveWorkers.fetch_add(1);
+		{
+			if (pool->executionEpoch.load() == seenEpoch)
+			{
+				int numSpins = 0;
+				
+				while (pool->numRemainingTasks.load() != 0)
+				{
+					if (pool->tryRunTask(worker))
+						numSpins = 0;
+					else if (++numSpins < 1000)
+						cpuRelax();
+					else
+						std::this_thread::yield();
+				}
+				
+				pool->finishTiming(worker);
+			}
+		}
+		pool->numActiveWorkers.fetch_sub(1);
+	}
+}
+
+bool AudioWorkerPool::tryRunTask(Worker * worker)
+{
+	int taskIndex;
+	
+	if (worker->queue.pop(taskIndex))
+	{
+		runTask(worker, taskIndex);
+		return true;
+	}
+	
+	const int numWorkers = (int)workers.size();
+	
+	for (int i = 1; i < numWorkers; ++i)
+	{
+		Worker * victim = workers[(worker->index + i) % numWorkers].get();
+		
+		if (victim->queue.steal(taskIndex))
+		{
+			runTask(worker, taskIndex);
+			return true;
+		}
+	}
+	
+	return false;
+}
+
+void AudioWorkerPool::runTask(Worker * worker, const int taskIndex)
+{
+	audioCpuTimingBlock(AudioWorkerPool_RunTask);
+	
+#if ENABLE_AUDIOGRAPH_CPU_TIMING
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+#endif
+
+	taskFunction(taskUserData, taskIndex);
+	
+#if ENABLE_AUDIOGRAPH_CPU_TIMING
+	const uint64_t t2 = g_TimerRT.TimeUS_get();
+	
+	worker->busyTime += int(t2 - t1);
+#endif
+
+	worker->numTasks++;
+	
+	// release the tasks depending on this task
+	
+	auto & task = taskGraph->tasks[taskIndex];
+	
+	for (int i = 0; i < task.numSuccessors; ++i)
+	{
+		const int successorIndex = taskGraph->successors[task.firstSuccessor + i];
+		
+		if (numPendingDeps[successorIndex].fetch_sub(1) == 1)
+		{
+			// note : tasks which must run on the calling thread are picked up by the calling thread, once their dependencies are met
+			
+			if (taskGraph->tasks[successorIndex].runOnCallingThread == false)
+				worker->queue.push(successorIndex);
+		}
+	}
+	
+	numRemainingTasks.fetch_sub(1);
+}
+
+void AudioWorkerPool::finishTiming(Worker * worker)
+{
+#if ENABLE_AUDIOGRAPH_CPU_TIMING
+	worker->timing.busyTimeAvg = (worker->timing.busyTimeAvg * 99 + worker->busyTime * (SAMPLE_RATE / taskUpdateSize)) / 100;
+#endif
+
+	worker->timing.numTasks = worker->numTasks;
+}
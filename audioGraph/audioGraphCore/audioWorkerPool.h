@@ -0,0 +1,163 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+#include "audioProfiling.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * AudioTaskGraph describes a set of tasks and the dependencies between them. Tasks are identified by their index.
+ * A task may only run once all of the tasks it depends on have finished. Tasks marked 'runOnCallingThread' are
+ * always executed on the thread calling AudioWorkerPool::execute, in order of increasing task index.
+ */
+struct AudioTaskGraph
+{
+	struct Task
+	{
+		int numDeps = 0;                 ///< The number of tasks which must finish before this task may run.
+		int firstSuccessor = 0;          ///< Index into 'successors' of the first task depending on this task.
+		int numSuccessors = 0;           ///< The number of tasks depending on this task.
+		bool runOnCallingThread = false; ///< When set, the task is never executed on a worker thread.
+	};
+	
+	std::vector<Task> tasks;
+	std::vector<int> successors;
+	std::vector<int> callingThreadTasks; ///< Indices of the tasks which must run on the calling thread, in increasing order.
+	
+	std::vector<std::pair<int, int>> dependencies; ///< Dependencies added using addDependency. Consumed by finalize.
+	
+	void clear();
+	
+	int addTask(const bool runOnCallingThread);
+	void addDependency(const int taskIndex, const int dependsOnTaskIndex);
+	
+	void finalize(); ///< Builds the list of successors for each task. Must be called after all tasks and dependencies have been added.
+};
+
+/**
+ * AudioWorkerPool executes task graphs using a set of worker threads plus the calling thread. Each thread
+ * owns a queue of tasks which are ready to run. Threads pop tasks from the back of their own queue and steal
+ * tasks from the front of other queues when they run out of work. Tasks becoming ready are pushed onto
+ * the queue of the thread which finished the last dependency, to keep data hot in its cache.
+ *
+ * Usage example:
+ * ```cpp
+ * AudioWorkerPool pool;
+ * pool.init(3);
+ *
+ * AudioTaskGraph taskGraph;
+ * const int a = taskGraph.addTask(false);
+ * const int b = taskGraph.addTask(false);
+ * const int c = taskGraph.addTask(true);
+ * taskGraph.addDependency(c, a);
+ * taskGraph.addDependency(c, b);
+ * taskGraph.finalize();
+ *
+ * pool.reserve(taskGraph.tasks.size());
+ * pool.execute(taskGraph, [](void * userData, const int taskIndex) { ... }, nullptr);
+ *
+ * pool.shut();
+ * ```
+ */
+struct AudioWorkerPool
+{
+	typedef void (*TaskFunction)(void * userData, const int taskIndex);
+	
+	struct TaskQueue
+	{
+		std::atomic_flag lock = ATOMIC_FLAG_INIT;
+		std::vector<int> elems;
+		int head = 0;
+		int tail = 0;
+		
+		void reserve(const int capacity);
+		void reset(const int capacity); ///< Empties the queue. The capacity must have been reserved up front.
+		
+		void push(const int taskIndex);
+		bool pop(int & taskIndex);
+		bool steal(int & taskIndex);
+	};
+	
+	struct Worker
+	{
+		AudioWorkerPool * pool = nullptr;
+		int index = 0;
+		
+		TaskQueue queue;
+		
+		std::thread thread;
+		
+		AudioWorkerTiming timing;
+		int busyTime = 0;
+		int numTasks = 0;
+	};
+	
+	std::vector<std::unique_ptr<Worker>> workers; ///< Worker zero represents the calling thread. It doesn't own a thread.
+	
+	std::mutex wakeupMutex;
+	std::condition_variable wakeupCond;
+	int64_t wakeupEpoch = 0;
+	bool stopRequested = false;
+	
+	std::atomic<int64_t> executionEpoch; ///< Set to the wakeup epoch while an execution is in progress, -1 otherwise.
+	std::atomic<int> numActiveWorkers;
+	
+	const AudioTaskGraph * taskGraph = nullptr;
+	TaskFunction taskFunction = nullptr;
+	void * taskUserData = nullptr;
+	int taskUpdateSize = 1; ///< The number of samples processed per tick by the current execution. Used to compute the timing averages.
+	
+	std::unique_ptr<std::atomic<int>[]> numPendingDeps;
+	int numPendingDepsCapacity = 0;
+	std::atomic<int> numRemainingTasks;
+	
+	AudioWorkerPool();
+	~AudioWorkerPool();
+	
+	void init(const int numThreads); ///< Creates 'numThreads' worker threads. The calling thread participates in execution as well.
+	void shut();
+	
+	int getNumWorkers() const; ///< Returns the number of workers, including the calling thread.
+	const AudioWorkerTiming & getWorkerTiming(const int workerIndex) const;
+	
+	void reserve(const int numTasks); ///< Allocates the execution state for task graphs with up to 'numTasks' tasks. Must be called before execute, whenever the task graph grows.
+	void execute(const AudioTaskGraph & taskGraph, TaskFunction function, void * userData, const int updateSize); ///< Executes all tasks inside the task graph and waits for them to finish. 'updateSize' is the number of samples processed by the tasks.
+	
+private:
+	static void threadMain(Worker * worker);
+	
+	bool tryRunTask(Worker * worker);
+	void runTask(Worker * worker, const int taskIndex);
+	void finishTiming(Worker * worker);
+};
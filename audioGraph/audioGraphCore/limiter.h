@@ -27,6 +27,7 @@
 
 #pragma once
 
+#include "audioKernels.h"
 #include "soundmix.h"
 #include <math.h>
 
@@ -73,7 +74,25 @@ struct Limiter
 		int i = 0;
 
 	#if 1
-		const float retain16 = powf(retain, 16.f);
+		// note : the measured max only decays when it exceeds the output max. when neither the measured max, nor
+		//        any of the samples exceed the output max, the samples are left untouched and the measured max
+		//        becomes the peak value. this is the common case, so we check for it using a vectorized kernel
+		
+		const int numSamples16 = numSamples / 16 * 16;
+		
+		if (measuredMax <= outputMax && numSamples16 > 0)
+		{
+			const float peak = getAudioKernels().peak(samples, numSamples16);
+			
+			if (peak <= outputMax)
+			{
+				measuredMax = fmaxf(measuredMax, peak);
+				
+				i = numSamples16;
+			}
+		}
+		
+		const float retain16 = i < numSamples16 ? powf(retain, 16.f) : 0.f;
 		
 		while (i + 16 <= numSamples)
 		{
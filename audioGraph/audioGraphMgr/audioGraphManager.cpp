@@ -276,6 +276,12 @@ AudioGraphManager_Basic::AudioGraphManager_Basic(bool _cacheOnCreate)
 	, audioMutex(nullptr)
 	, allocatedContexts()
 	, context(nullptr)
+	, workerPool(nullptr)
+	, taskGraph()
+	, parallelGraphs()
+	, parallelTasks()
+	, taskGraphIsDirty(true)
+	, parallelTickDt(0.f)
 {
 	cacheOnCreate = _cacheOnCreate;
 }
@@ -285,7 +291,7 @@ AudioGraphManager_Basic::~AudioGraphManager_Basic()
 	shut();
 }
 
-void AudioGraphManager_Basic::init(AudioMutexBase * mutex, AudioVoiceManager * voiceMgr)
+void AudioGraphManager_Basic::init(AudioMutexBase * mutex, AudioVoiceManager * voiceMgr, const int updateSize)
 {
 	shut();
 	
@@ -302,7 +308,7 @@ void AudioGraphManager_Basic::init(AudioMutexBase * mutex, AudioVoiceManager * v
 	mutex_mem.init();
 	mutex_reg.init();
 	
-	context = createContext(voiceMgr);
+	context = createContext(voiceMgr, updateSize);
 }
 
 void AudioGraphManager_Basic::shut()
@@ -323,6 +329,8 @@ void AudioGraphManager_Basic::shut()
 		freeContext(context);
 	}
 	
+	disableParallelTick();
+	
 	mutex_mem.shut();
 	mutex_reg.shut();
 	
@@ -351,11 +359,79 @@ void AudioGraphManager_Basic::addGraphToCache(const char * filename)
 	}
 }
 
-AudioGraphContext * AudioGraphManager_Basic::createContext(AudioVoiceManager * voiceMgr)
+void AudioGraphManager_Basic::enableParallelTick(const int numThreads)
+{
+	disableParallelTick();
+	
+	// note : AudioFloat::expand may be called on the shared constants from multiple threads at the same
+	//        time when ticking in parallel. we expand them here, to ensure they are never written to again
+	
+	AudioFloat::Zero.expand();
+	AudioFloat::One.expand();
+	AudioFloat::Half.expand();
+	
+	AudioWorkerPool * pool = new AudioWorkerPool();
+	pool->init(numThreads);
+	
+	audioMutex->lock();
+	{
+		workerPool = pool;
+		
+		taskGraphIsDirty = true;
+	}
+	audioMutex->unlock();
+}
+
+void AudioGraphManager_Basic::disableParallelTick()
+{
+	if (workerPool == nullptr)
+		return;
+	
+	AudioWorkerPool * pool = workerPool;
+	
+	audioMutex->lock();
+	{
+		workerPool = nullptr;
+	}
+	audioMutex->unlock();
+	
+	pool->shut();
+	
+	delete pool;
+	pool = nullptr;
+	
+	taskGraph.clear();
+	parallelGraphs.clear();
+	parallelTasks.clear();
+}
+
+int AudioGraphManager_Basic::getNumParallelWorkers() const
+{
+	if (workerPool == nullptr)
+		return 0;
+	else
+		return workerPool->getNumWorkers();
+}
+
+AudioWorkerTiming AudioGraphManager_Basic::getParallelWorkerTiming(const int workerIndex)
+{
+	AudioWorkerTiming result;
+	
+	audioMutex->lock();
+	{
+		if (workerPool != nullptr && workerIndex >= 0 && workerIndex < workerPool->getNumWorkers())
+			result = workerPool->getWorkerTiming(workerIndex);
+	}
+	audioMutex->unlock();
+	
+	return result;
+}
+
+AudioGraphContext * AudioGraphManager_Basic::createContext(AudioVoiceManager * voiceMgr, const int updateSize)
 {
 	AudioGraphContext * context = new AudioGraphContext();
 	
-	context->init(&mutex_mem, &mutex_reg, voiceMgr);
+	context->init(&mutex_mem, &mutex_reg, voiceMgr, updateSize);
 	
 	audioMutex->lock();
 	{
@@ -457,6 +533,8 @@ AudioGraphInstance * AudioGraphManager_Basic::createInstance(const char * filena
 		audioMutex->lock();
 		{
 			instances.push_back(instance);
+			
+			taskGraphIsDirty = true;
 		}
 		audioMutex->unlock();
 		
@@ -491,6 +569,8 @@ void AudioGraphManager_Basic::free(AudioGraphInstance *& instance, const bool do
 			audioMutex->lock();
 			{
 				instances.erase(instanceItr);
+				
+				taskGraphIsDirty = true;
 			}
 			audioMutex->unlock();
 			
@@ -528,22 +608,26 @@ void AudioGraphManager_Basic::tickAudio(const float dt)
 {
 	lockAudio();
 	{
-		mutex_mem.lock();
-		{
-			// synchronize state from main to audio thread
-			
-			for (auto & context : allocatedContexts)
-				context->tickAudio(dt);
-			
-			for (auto & instance : instances)
-				instance->audioGraph->syncMainToAudio(dt);
-		}
-		mutex_mem.unlock();
+		// synchronize state from main to audio thread
+		// note : the contexts and audio graphs synchronize without locking
 		
-		// tick graph instances
+		for (auto & context : allocatedContexts)
+			context->tickAudio(dt);
 		
 		for (auto & instance : instances)
-			instance->audioGraph->tickAudio(dt, false);
+			instance->audioGraph->syncMainToAudio(dt);
+		
+		// tick graph instances
+		
+		if (workerPool != nullptr)
+		{
+			tickAudioParallel(dt);
+		}
+		else
+		{
+			for (auto & instance : instances)
+				instance->audioGraph->tickAudio(dt, false);
+		}
 	}
 	unlockAudio();
 }
@@ -562,6 +646,135 @@ void AudioGraphManager_Basic::unlockAudio()
 	audioMutex->unlock();
 }
 
+static void tickParallelTask(void * userData, const int taskIndex)
+{
+	AudioGraphManager_Basic * audioGraphMgr = (AudioGraphManager_Basic*)userData;
+	
+	auto & task = audioGraphMgr->parallelTasks[taskIndex];
+	auto & graph = audioGraphMgr->parallelGraphs[task.graphIndex];
+	
+	if (graph.isTicking == false)
+		return;
+	
+	AudioGraph * audioGraph = graph.audioGraph;
+	
+	pushAudioGraph(audioGraph);
+	setCurrentAudioGraphTraversalId(audioGraph->currentTickTraversalId);
+	{
+		task.node->scheduledTick(audioGraph->currentTickTraversalId, audioGraphMgr->parallelTickDt);
+		
+		// note : AudioFloat::expand isn't thread-safe. when multiple nodes depend on this node, they may
+		//        be ticked at the same time, so we expand the outputs here, before they get a chance to
+		
+		if (task.expandOutputs)
+		{
+			for (auto & output : task.node->outputs)
+			{
+				if (output.type == kAudioPlugType_FloatVec)
+					output.getRwAudioFloat().expand();
+			}
+		}
+	}
+	clearCurrentAudioGraphTraversalId();
+	popAudioGraph();
+}
+
+void AudioGraphManager_Basic::tickAudioParallel(const float dt)
+{
+	audioCpuTimingBlock(AudioGraphManager_TickAudioParallel);
+	
+	// update the schedules of graphs which have been edited, and rebuild the task graph when needed
+	
+	for (auto & instance : instances)
+	{
+		if (instance->audioGraph->scheduleIsDirty)
+		{
+			instance->audioGraph->updateSchedule();
+			
+			taskGraphIsDirty = true;
+		}
+	}
+	
+	if (taskGraphIsDirty)
+	{
+		updateTaskGraph();
+	}
+	
+	// tick the graph instances
+	
+	for (auto & graph : parallelGraphs)
+	{
+		graph.isTicking = (graph.audioGraph->isPaused == false);
+		
+		if (graph.isTicking)
+			graph.audioGraph->beginTick();
+	}
+	
+	parallelTickDt = dt;
+	
+	workerPool->execute(taskGraph, tickParallelTask, this, context->updateSize);
+	
+	for (auto & graph : parallelGraphs)
+	{
+		if (graph.isTicking)
+			graph.audioGraph->endTick(dt);
+	}
+}
+
+void AudioGraphManager_Basic::updateTaskGraph()
+{
+	taskGraph.clear();
+	parallelGraphs.clear();
+	parallelTasks.clear();
+	
+	for (auto & instance : instances)
+	{
+		AudioGraph * audioGraph = instance->audioGraph;
+		
+		Assert(audioGraph->scheduleIsDirty == false);
+		
+		ParallelGraph graph;
+		graph.audioGraph = audioGraph;
+		parallelGraphs.push_back(graph);
+		
+		const int firstTaskIndex = taskGraph.tasks.size();
+		
+		for (auto & elem : audioGraph->schedule.elems)
+		{
+			// note : nodes which aren't thread-safe are ticked on the audio thread, in schedule order
+			
+			const int taskIndex = taskGraph.addTask(elem.node->isThreadSafe == false);
+			
+			for (int i = 0; i < elem.numPredeps; ++i)
+			{
+				const int predepIndex = audioGraph->schedule.predeps[elem.firstPredep + i];
+				
+				taskGraph.addDependency(taskIndex, firstTaskIndex + predepIndex);
+			}
+			
+			ParallelTask task;
+			task.graphIndex = parallelGraphs.size() - 1;
+			task.node = elem.node;
+			// note : control rate nodes output scalars, and their control rate successors read them without
+			//        expanding. only expand their outputs when an audio rate successor may expand them too
+			
+			task.expandOutputs =
+				elem.numSuccessors > 1 &&
+				(elem.node->isControlRate == false || elem.numAudioRateSuccessors > 0);
+			parallelTasks.push_back(task);
+		}
+	}
+	
+	taskGraph.finalize();
+	
+	// note : the task graph is only rebuilt when instances are added or removed, or when a schedule changes.
+	//        we size the worker pool's execution state here, so ticking the task graph doesn't allocate
+	
+	workerPool->reserve(taskGraph.tasks.size());
+	
+	taskGraphIsDirty = false;
+}
+
 //
 
 AudioGraphManager_RTE::AudioGraphManager_RTE(const int in_displaySx, const int in_displaySy)
@@ -705,11 +918,11 @@ void AudioGraphManager_RTE::selectInstance(const AudioGraphInstance * instance)
 	audioMutex->unlock();
 }
 
-AudioGraphContext * AudioGraphManager_RTE::createContext(AudioVoiceManager * voiceMgr)
+AudioGraphContext * AudioGraphManager_RTE::createContext(AudioVoiceManager * voiceMgr, const int updateSize)
 {
 	AudioGraphContext * context = new AudioGraphContext();
 	
-	context->init(&mutex_mem, &mutex_reg, voiceMgr);
+	context->init(&mutex_mem, &mutex_reg, voiceMgr, updateSize);
 	
 	audioMutex->lock();
 	{
@@ -945,18 +1158,15 @@ void AudioGraphManager_RTE::tickAudio(const float dt)
 {
 	lockAudio();
 	{
-		mutex_mem.lock();
-		{
-			// synchronize state from main to audio thread
-			
-			for (auto & context : allocatedContexts)
-				context->tickAudio(dt);
-			
-			for (auto & file : files)
-				for (auto & instance : file.second->instanceList)
-					instance->audioGraph->syncMainToAudio(dt);
-		}
-		mutex_mem.unlock();
+		// synchronize state from main to audio thread
+		// note : the contexts and audio graphs synchronize without locking
+		
+		for (auto & context : allocatedContexts)
+			context->tickAudio(dt);
+		
+		for (auto & file : files)
+			for (auto & instance : file.second->instanceList)
+				instance->audioGraph->syncMainToAudio(dt);
 	
 		// tick graph instances
 		
@@ -1163,11 +1373,11 @@ void AudioGraphManager_MultiRTE::selectInstance(const AudioGraphInstance * insta
 	audioMutex->unlock();
 }
 
-AudioGraphContext * AudioGraphManager_MultiRTE::createContext(AudioVoiceManager * voiceMgr)
+AudioGraphContext * AudioGraphManager_MultiRTE::createContext(AudioVoiceManager * voiceMgr, const int updateSize)
 {
 	AudioGraphContext * context = new AudioGraphContext();
 	
-	context->init(&mutex_mem, &mutex_reg, voiceMgr);
+	context->init(&mutex_mem, &mutex_reg, voiceMgr, updateSize);
 	
 	audioMutex->lock();
 	{
@@ -1410,18 +1620,15 @@ void AudioGraphManager_MultiRTE::tickAudio(const float dt)
 {
 	lockAudio();
 	{
-		mutex_mem.lock();
-		{
-			// synchronize state from main to audio thread
-			
-			for (auto & context : allocatedContexts)
-				context->tickAudio(dt);
-			
-			for (auto & file : files)
-				for (auto & instance : file.second->instanceList)
-					instance->audioGraph->syncMainToAudio(dt);
-		}
-		mutex_mem.unlock();
+		// synchronize state from main to audio thread
+		// note : the contexts and audio graphs synchronize without locking
+		
+		for (auto & context : allocatedContexts)
+			context->tickAudio(dt);
+		
+		for (auto & file : files)
+			for (auto & instance : file.second->instanceList)
+				instance->audioGraph->syncMainToAudio(dt);
 		
 		// tick graph instances
 		
@@ -29,6 +29,7 @@
 
 #include "audioThreading.h"
 #include "audioTypes.h"
+#include "audioWorkerPool.h"
 #include <list>
 #include <map>
 #include <set>
@@ -38,6 +39,7 @@
 struct AudioGraph;
 struct AudioGraphContext;
 struct AudioGraphFileRTC;
+struct AudioNodeBase;
 struct AudioRealTimeConnection;
 struct AudioValueHistorySet;
 struct AudioVoiceManager;
@@ -78,7 +80,7 @@ struct AudioGraphManager
 	virtual ~AudioGraphManager() { }
 	
 	// called from the app thread
-	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr) = 0;
+	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr, const int updateSize = AUDIO_UPDATE_SIZE) = 0;
 	virtual void freeContext(AudioGraphContext *& context) = 0;
 	virtual AudioGraphContext * getContext() = 0;
 	
@@ -100,9 +102,28 @@ struct AudioGraphManager
 Basic audio graph manager, with optional support for caching graphs on load. This graph
 manager has less overhead than the real-time editing (RTE) and MultiRTE implementations,
 as it doesn't support real-time editing and doesn't create editors for loaded graphs.
+
+The basic audio graph manager optionally ticks graph instances in parallel. When enabled
+using enableParallelTick, the schedules of all graph instances are merged into a single
+task graph, which is executed on a pool of worker threads. Nodes which aren't marked as
+thread-safe are ticked on the audio thread, in the same order as when ticking serially,
+so the result of ticking in parallel is equal to the result of ticking serially.
 */
 struct AudioGraphManager_Basic : AudioGraphManager
 {
+	struct ParallelGraph
+	{
+		AudioGraph * audioGraph = nullptr;
+		bool isTicking = false;
+	};
+	
+	struct ParallelTask
+	{
+		int graphIndex = -1;
+		AudioNodeBase * node = nullptr;
+		bool expandOutputs = false;
+	};
+	
 	struct GraphCacheElem
 	{
 		bool isValid;
@@ -129,16 +150,29 @@ struct AudioGraphManager_Basic : AudioGraphManager
 	std::set<AudioGraphContext*> allocatedContexts;
 	AudioGraphContext * context;
 	
+	AudioWorkerPool * workerPool; // when set, graph instances are ticked in parallel
+	AudioTaskGraph taskGraph;
+	std::vector<ParallelGraph> parallelGraphs;
+	std::vector<ParallelTask> parallelTasks;
+	bool taskGraphIsDirty;
+	float parallelTickDt;
+	
 	AudioGraphManager_Basic(const bool cacheOnCreate);
 	virtual ~AudioGraphManager_Basic() override;
 	
 	// called from the app thread
-	void init(AudioMutexBase * mutex, AudioVoiceManager * voiceMgr);
+	void init(AudioMutexBase * mutex, AudioVoiceManager * voiceMgr, const int updateSize = AUDIO_UPDATE_SIZE); // updateSize is the update size of the default context
 	void shut();
 	void addGraphToCache(const char * filename);
 	
 	// called from the app thread
-	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr) override;
+	void enableParallelTick(const int numThreads); // creates a pool with numThreads worker threads. the audio thread participates in ticking as well
+	void disableParallelTick();
+	int getNumParallelWorkers() const; // returns the number of workers ticking in parallel, including the audio thread
+	AudioWorkerTiming getParallelWorkerTiming(const int workerIndex);
+	
+	// called from the app thread
+	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr, const int updateSize = AUDIO_UPDATE_SIZE) override;
 	virtual void freeContext(AudioGraphContext *& context) override;
 	virtual AudioGraphContext * getContext() override;
 	
@@ -154,6 +188,10 @@ struct AudioGraphManager_Basic : AudioGraphManager
 	// called from any thread
 	virtual void lockAudio() override;
 	virtual void unlockAudio() override;
+	
+private:
+	void tickAudioParallel(const float dt);
+	void updateTaskGraph();
 };
 
 /*
@@ -193,7 +231,7 @@ struct AudioGraphManager_RTE : AudioGraphManager
 	void selectInstance(const AudioGraphInstance * instance);
 	
 	// called from the app thread
-	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr) override;
+	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr, const int updateSize = AUDIO_UPDATE_SIZE) override;
 	virtual void freeContext(AudioGraphContext *& context) override;
 	virtual AudioGraphContext * getContext() override;
 	
@@ -247,7 +285,7 @@ struct AudioGraphManager_MultiRTE : AudioGraphManager
 	void selectInstance(const AudioGraphInstance * instance);
 	
 	// called from the app thread
-	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr) override;
+	virtual AudioGraphContext * createContext(AudioVoiceManager * voiceMgr, const int updateSize = AUDIO_UPDATE_SIZE) override;
 	virtual void freeContext(AudioGraphContext *& context) override;
 	virtual AudioGraphContext * getContext() override;
 	
@@ -26,6 +26,7 @@
 */
 
 #include "audioGraph.h"
+#include "audioGraphContext.h"
 #include "audioGraphRealTimeConnection.h"
 #include "audioNodeBase.h"
 #include "graphEdit.h"
@@ -55,13 +56,25 @@ AudioValueHistory::AudioValueHistory()
 	memset(samples, 0, sizeof(samples));
 }
 
-void AudioValueHistory::provide(const AudioFloat & value)
+void AudioValueHistory::provide(const AudioFloat & value, const int numSamples)
 {
-	value.expand();
+	Assert(numSamples <= kNumSamples);
 	
-	memmove(samples, samples + AUDIO_UPDATE_SIZE, (kNumSamples - AUDIO_UPDATE_SIZE) * sizeof(float));
+	memmove(samples, samples + numSamples, (kNumSamples - numSamples) * sizeof(float));
 	
-	memcpy(samples + kNumSamples - AUDIO_UPDATE_SIZE, value.samples, AUDIO_UPDATE_SIZE * sizeof(float));
+	// note : we avoid expanding the value here, as it may be shared with the audio thread
+	
+	if (value.isScalar)
+	{
+		const float scalar = value.getScalar();
+		
+		for (int i = kNumSamples - numSamples; i < kNumSamples; ++i)
+			samples[i] = scalar;
+	}
+	else
+	{
+		memcpy(samples + kNumSamples - numSamples, value.samples, numSamples * sizeof(float));
+	}
 	
 	isValid = true;
 }
@@ -198,7 +211,7 @@ void AudioRealTimeConnection::updateAudioValues()
 					{
 						const AudioFloat & value = input->getAudioFloat();
 						
-						audioValueHistory.provide(value);
+						audioValueHistory.provide(value, audioGraph->context->updateSize);
 					}
 					clearCurrentAudioGraphTraversalId();
 				}
@@ -228,7 +241,7 @@ void AudioRealTimeConnection::updateAudioValues()
 					{
 						const AudioFloat & value = output->getAudioFloat();
 						
-						audioValueHistory.provide(value);
+						audioValueHistory.provide(value, audioGraph->context->updateSize);
 					}
 					clearCurrentAudioGraphTraversalId();
 				}
@@ -302,6 +315,8 @@ void AudioRealTimeConnection::nodeAdd(const GraphNode & node)
 			// note : audioGraph->nodes is accessed during updateAudioValues, so we require AUDIO_SCOPE to modify it
 			
 			audioGraph->nodes[node.id] = audioNode;
+			
+			audioGraph->invalidateSchedule();
 		}
 	}
 	popAudioGraph();
@@ -395,6 +410,8 @@ void AudioRealTimeConnection::nodeRemove(const GraphNodeId nodeId)
 	
 	audioGraph->nodes.erase(nodeItr);
 	
+	audioGraph->invalidateSchedule();
+	
 	for (auto audioValueItr = audioValueHistorySet->audioValues.begin(); audioValueItr != audioValueHistorySet->audioValues.end(); )
 	{
 		auto & socketRef = audioValueItr->first;
@@ -472,6 +489,8 @@ void AudioRealTimeConnection::linkAdd(const GraphLinkId linkId, const GraphNodeI
 		
 		dstNode->triggerTargets.push_back(triggerTarget);
 	}
+	
+	audioGraph->invalidateSchedule();
 }
 
 void AudioRealTimeConnection::linkRemove(const GraphLinkId linkId, const GraphNodeId srcNodeId, const int srcSocketIndex, const GraphNodeId dstNodeId, const int dstSocketIndex)
@@ -524,6 +543,8 @@ void AudioRealTimeConnection::linkRemove(const GraphLinkId linkId, const GraphNo
 		Assert(foundPredep);
 	}
 	
+	audioGraph->invalidateSchedule();
+	
 	{
 		auto input = srcNode->tryGetInput(srcSocketIndex);
 		auto output = dstNode->tryGetOutput(dstSocketIndex);
@@ -696,6 +717,8 @@ void AudioRealTimeConnection::setSrcSocketValue(const GraphNodeId nodeId, const
 	{
 		audioGraph->connectToInputLiteral(*input, value);
 	}
+	
+	node->handleInputValueChanged(srcSocketIndex);
 }
 
 bool AudioRealTimeConnection::getSrcSocketValue(const GraphNodeId nodeId, const int srcSocketIndex, const std::string & srcSocketName, std::string & value)
@@ -896,7 +919,7 @@ bool AudioRealTimeConnection::getSrcSocketChannelData(const GraphNodeId nodeId,
 			
 			// make the data available
 			
-			history_capture.provide(value);
+			history_capture.provide(value, audioGraph->context->updateSize);
 		}
 		
 		channels.addChannel(history_capture.samples, history_capture.kNumSamples, true);
@@ -973,7 +996,7 @@ bool AudioRealTimeConnection::getDstSocketChannelData(const GraphNodeId nodeId,
 			
 			// make the data available
 			
-			history_capture.provide(value);
+			history_capture.provide(value, audioGraph->context->updateSize);
 		}
 		
 		channels.addChannel(history_capture.samples, history_capture.kNumSamples, true);
@@ -1049,6 +1072,13 @@ bool AudioRealTimeConnection::getNodeDescription(const GraphNodeId nodeId, std::
 #if ENABLE_AUDIOGRAPH_CPU_TIMING
 	d.add("tick: %.3fms", node->tickTimeAvg / 1000.0);
 #endif
+
+	if (node->isControlRate)
+	{
+		const AudioGraphScheduleStats & stats = audioGraph->schedule.stats;
+		
+		d.add("control rate (%d of %d nodes in graph, %d scalar only)", stats.numControlRateNodes, stats.numNodes, stats.numScalarOnlyNodes);
+	}
 	
 	std::swap(lines, d.lines);
 	
@@ -100,7 +100,7 @@ struct AudioFloat;
 struct AudioValueHistory
 {
 	static const int kHistorySize = 8;
-	static const int kNumSamples = AUDIO_UPDATE_SIZE * kHistorySize;
+	static const int kNumSamples = AUDIO_MAX_UPDATE_SIZE * kHistorySize;
 	
 	uint64_t lastRequestTime;
 	
@@ -110,7 +110,7 @@ struct AudioValueHistory
 	
 	AudioValueHistory();
 	
-	void provide(const AudioFloat & value);
+	void provide(const AudioFloat & value, const int numSamples);
 	
 	bool isActive() const;
 	
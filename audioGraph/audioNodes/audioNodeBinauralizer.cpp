@@ -47,6 +47,8 @@ void AudioNodeBinauralizer::tick(const float dt)
 {
 	audioCpuTimingBlock(AudioNodeBinauralizer);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * audio = getInputAudioFloat(kInput_Audio, &AudioFloat::Zero);
 	const char * location = getInputString(kInput_SampleSetLocation, "");
 	const float elevation = getInputAudioFloat(kInput_Elevation, &AudioFloat::Zero)->getMean();
@@ -75,6 +77,7 @@ void AudioNodeBinauralizer::tick(const float dt)
 		if (sampleSet != nullptr)
 		{
 			binauralizer.init(sampleSet, &mutex);
+			binauralizer.setHrtfCache(sampleSetCache->findHrtfCache(location));
 		}
 		else
 		{
@@ -92,11 +95,11 @@ void AudioNodeBinauralizer::tick(const float dt)
 		binauralizer.setSampleLocation(elevation, azimuth);
 		
 		audio->expand();
-		binauralizer.provide(audio->samples, AUDIO_UPDATE_SIZE);
+		binauralizer.provide(audio->samples, numSamples);
 		
 		audioOutputL.setVector();
 		audioOutputR.setVector();
 		
-		binauralizer.generateLR(audioOutputL.samples, audioOutputR.samples, AUDIO_UPDATE_SIZE);
+		binauralizer.generateLR(audioOutputL.samples, audioOutputR.samples, numSamples);
 	}
 }
@@ -62,10 +62,14 @@ AudioNodeBiquad::AudioNodeBiquad()
 	addInput(kInput_Q, kAudioPlugType_FloatVec);
 	addInput(kInput_PeakGain, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Output, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodeBiquad::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat defaultFrequency(100.f);
 	const AudioFloat defaultQ(.707f);
 	const AudioFloat defaultPeakGain(6.f);
@@ -128,7 +132,7 @@ void AudioNodeBiquad::tick(const float dt)
 		input->expand();
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float value = biquad.processSingle(input->samples[i]);
 			
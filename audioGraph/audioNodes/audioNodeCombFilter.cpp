@@ -55,6 +55,8 @@ AudioNodeCombFilter::AudioNodeCombFilter()
 	addInput(kInput_FeedForward, kAudioPlugType_FloatVec);
 	addInput(kInput_FeedBack, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Value, kAudioPlugType_FloatVec, &valueOutput);
+	
+	isThreadSafe = true;
 }
 
 AudioNodeCombFilter::~AudioNodeCombFilter()
@@ -67,6 +69,8 @@ void AudioNodeCombFilter::tick(const float dt)
 {
 	audioCpuTimingBlock(AudioNodeCombFilter);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const float maxDelay = getInputFloat(kInput_MaxDelay, .1f);
 	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
@@ -77,11 +81,11 @@ void AudioNodeCombFilter::tick(const float dt)
 	{
 		// set delay line length
 		
-		const int numSamples = maxDelay * SAMPLE_RATE;
+		const int length = maxDelay * SAMPLE_RATE;
 		
-		if (numSamples != delayLine->getLength())
+		if (length != delayLine->getLength())
 		{
-			delayLine->setLength(numSamples);
+			delayLine->setLength(length);
 		}
 	}
 	
@@ -100,7 +104,7 @@ void AudioNodeCombFilter::tick(const float dt)
 		
 		SCOPED_FLUSH_DENORMALS;
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const int offset = std::min(delayLine->getLength() - 1, int(delay->samples[i] * SAMPLE_RATE));
 			
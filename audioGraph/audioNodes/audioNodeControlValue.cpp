@@ -71,6 +71,7 @@ AudioNodeControlValue::AudioNodeControlValue()
 	, currentDefaultX(0.f)
 	, currentDefaultY(0.f)
 	, isRegistered(false)
+	, memfId(-1)
 	, valueOutput()
 {
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
@@ -84,6 +85,8 @@ AudioNodeControlValue::AudioNodeControlValue()
 	addInput(kInput_DefaultY, kAudioPlugType_FloatVec);
 	addOutput(kOutput_ValueX, kAudioPlugType_FloatVec, &valueOutput[0]);
 	addOutput(kOutput_ValueY, kAudioPlugType_FloatVec, &valueOutput[1]);
+	
+	isScalarPreserving = true;
 }
 
 AudioNodeControlValue::~AudioNodeControlValue()
@@ -150,12 +153,14 @@ void AudioNodeControlValue::updateControlValueRegistration(const bool isMainThre
 				g_currentAudioGraph->context->unregisterControlValue(currentName.c_str());
 				
 				isRegistered = false;
+				memfId = -1;
 			}
 			else if (currentScope == kScope_PerInstance)
 			{
 				g_currentAudioGraph->unregisterControlValue(currentName.c_str());
 				
 				isRegistered = false;
+				memfId = -1;
 			}
 			else
 			{
@@ -197,6 +202,7 @@ void AudioNodeControlValue::updateControlValueRegistration(const bool isMainThre
 					defaultY);
 				
 				isRegistered = true;
+				memfId = g_currentAudioGraph->context->findMemf(currentName.c_str());
 			}
 			else if (scope == kScope_PerInstance)
 			{
@@ -210,6 +216,7 @@ void AudioNodeControlValue::updateControlValueRegistration(const bool isMainThre
 					defaultY);
 				
 				isRegistered = true;
+				memfId = g_currentAudioGraph->findMemf(currentName.c_str());
 			}
 			else
 			{
@@ -228,22 +235,37 @@ void AudioNodeControlValue::updateControlValueOutput(const bool isMainThread)
 	}
 	else
 	{
-		const char * name = getInputString(kInput_Name, "");
 		const Scope scope = (Scope)getInputInt(kInput_Scope, 0);
 		
 		if (scope == kScope_Shared)
 		{
-			const AudioGraphContext::Memf memf = g_currentAudioGraph->context->getMemf(name, isMainThread);
-
-			valueOutput[0].setScalar(isMainThread ? memf.value1_mainThread : memf.value1_audioThread);
-			valueOutput[1].setScalar(isMainThread ? memf.value2_mainThread : memf.value2_audioThread);
+			if (memfId != -1)
+			{
+				const AudioGraphContext::Memf memf = g_currentAudioGraph->context->getMemf(memfId, isMainThread);
+				
+				valueOutput[0].setScalar(isMainThread ? memf.value1_mainThread : memf.value1_audioThread);
+				valueOutput[1].setScalar(isMainThread ? memf.value2_mainThread : memf.value2_audioThread);
+			}
+			else
+			{
+				valueOutput[0].setScalar(0.f);
+				valueOutput[1].setScalar(0.f);
+			}
 		}
 		else if (scope == kScope_PerInstance)
 		{
-			const AudioGraph::Memf memf = g_currentAudioGraph->getMemf(name, isMainThread);
-
-			valueOutput[0].setScalar(isMainThread ? memf.value1_mainThread : memf.value1_audioThread);
-			valueOutput[1].setScalar(isMainThread ? memf.value2_mainThread : memf.value2_audioThread);
+			if (memfId != -1)
+			{
+				const AudioGraph::Memf memf = g_currentAudioGraph->getMemf(memfId, isMainThread);
+				
+				valueOutput[0].setScalar(isMainThread ? memf.value1_mainThread : memf.value1_audioThread);
+				valueOutput[1].setScalar(isMainThread ? memf.value2_mainThread : memf.value2_audioThread);
+			}
+			else
+			{
+				valueOutput[0].setScalar(0.f);
+				valueOutput[1].setScalar(0.f);
+			}
 		}
 		else
 		{
@@ -76,6 +76,7 @@ struct AudioNodeControlValue : AudioNodeBase
 	float currentDefaultX;
 	float currentDefaultY;
 	bool isRegistered;
+	int memfId; // memf id of the control value. for shared control values, this is the id of the memf registered with the context
 	
 	AudioFloat valueOutput[2];
 
@@ -64,6 +64,8 @@ AudioNodeDelayLine::AudioNodeDelayLine()
 	addOutput(kOutput_Value2, kAudioPlugType_FloatVec, &outputValue[1]);
 	addOutput(kOutput_Value3, kAudioPlugType_FloatVec, &outputValue[2]);
 	addOutput(kOutput_Value4, kAudioPlugType_FloatVec, &outputValue[3]);
+	
+	isThreadSafe = true;
 }
 
 AudioNodeDelayLine::~AudioNodeDelayLine()
@@ -76,6 +78,8 @@ void AudioNodeDelayLine::tick(const float dt)
 {
 	audioCpuTimingBlock(AudioNodeDelayLine);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	
 	const float maxDelay = getInputFloat(kInput_MaxDelay, 0.f);
@@ -88,11 +92,11 @@ void AudioNodeDelayLine::tick(const float dt)
 	{
 		// set delay line length
 		
-		const int numSamples = maxDelay * SAMPLE_RATE;
+		const int length = maxDelay * SAMPLE_RATE;
 		
-		if (numSamples != delayLine->getLength())
+		if (length != delayLine->getLength())
 		{
-			delayLine->setLength(numSamples);
+			delayLine->setLength(length);
 		}
 	}
 	
@@ -124,7 +128,7 @@ void AudioNodeDelayLine::tick(const float dt)
 			{
 				const float valueScalar = value->getScalar();
 				
-				for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+				for (int i = 0; i < numSamples; ++i)
 					nextWriteIndex = delayLine->push_optimized(nextWriteIndex, valueScalar);
 				
 				outputValue[0].setScalar(delayLine->read_optimized(nextWriteIndex, offset1));
@@ -139,7 +143,7 @@ void AudioNodeDelayLine::tick(const float dt)
 				outputValue[2].setVector();
 				outputValue[3].setVector();
 				
-				for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+				for (int i = 0; i < numSamples; ++i)
 				{
 					nextWriteIndex = delayLine->push_optimized(nextWriteIndex, value->samples[i]);
 					
@@ -164,7 +168,7 @@ void AudioNodeDelayLine::tick(const float dt)
 			outputValue[2].setVector();
 			outputValue[3].setVector();
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				nextWriteIndex = delayLine->push_optimized(nextWriteIndex, value->samples[i]);
 				
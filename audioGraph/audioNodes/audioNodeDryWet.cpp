@@ -40,6 +40,8 @@ AUDIO_NODE_TYPE(AudioNodeDryWet)
 
 void AudioNodeDryWet::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * dry = getInputAudioFloat(kInput_Dry, &AudioFloat::Zero);
 	const AudioFloat * wet = getInputAudioFloat(kInput_Wet, &AudioFloat::Zero);
 	const AudioFloat * wetness = getInputAudioFloat(kInput_Wetness, &AudioFloat::Zero);
@@ -68,7 +70,7 @@ void AudioNodeDryWet::tick(const float dt)
 		
 		audioOutput.setVector();
 		
-		audioBufferDryWet(audioOutput.samples, dry->samples, wet->samples, AUDIO_UPDATE_SIZE, wetness->getScalar());
+		audioBufferDryWet(audioOutput.samples, dry->samples, wet->samples, numSamples, wetness->getScalar());
 	}
 	else
 	{
@@ -79,6 +81,6 @@ void AudioNodeDryWet::tick(const float dt)
 		
 		audioOutput.setVector();
 		
-		audioBufferDryWet(audioOutput.samples, dry->samples, wet->samples, AUDIO_UPDATE_SIZE, wetness->samples);
+		audioBufferDryWet(audioOutput.samples, dry->samples, wet->samples, numSamples, wetness->samples);
 	}
 }
@@ -56,6 +56,9 @@ struct AudioNodeDryWet : AudioNodeBase
 		addInput(kInput_Wet, kAudioPlugType_FloatVec);
 		addInput(kInput_Wetness, kAudioPlugType_FloatVec);
 		addOutput(kOutput_Audio, kAudioPlugType_FloatVec, &audioOutput);
+		
+		isThreadSafe = true;
+		isScalarPreserving = true;
 	}
 	
 	virtual void tick(const float dt) override;
@@ -53,10 +53,14 @@ AudioNodeEnvelope::AudioNodeEnvelope()
 	addInput(kInput_Sustain, kAudioPlugType_FloatVec);
 	addInput(kInput_Release, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodeEnvelope::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * signal = getInputAudioFloat(kInput_Signal, &AudioFloat::Zero);
 	const AudioFloat * attack = getInputAudioFloat(kInput_Attack, &AudioFloat::Zero);
 	const AudioFloat * decay = getInputAudioFloat(kInput_Decay, &AudioFloat::Zero);
@@ -85,7 +89,7 @@ void AudioNodeEnvelope::tick(const float dt)
 		const double decayPerSample = dt / decay->getScalar();
 		const double releasePerSample = dt / release->getScalar();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const bool newSignal = signal->samples[i] != 0.f;
 			
@@ -168,7 +172,7 @@ void AudioNodeEnvelope::tick(const float dt)
 		
 		const float dt = 1.f / SAMPLE_RATE;
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const bool newSignal = signal->samples[i] != 0.f;
 			
@@ -39,6 +39,7 @@ AUDIO_NODE_TYPE(AudioNodeEventTrigger)
 AudioNodeEventTrigger::AudioNodeEventTrigger()
 	: AudioNodeBase()
 	, currentName()
+	, eventId(-1)
 	, isRegistered(false)
 {
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
@@ -94,9 +95,9 @@ void AudioNodeEventTrigger::updateEventRegistration()
 		
 		if (!currentName.empty())
 		{
-			g_currentAudioGraph->registerEvent(currentName.c_str());
+			eventId = g_currentAudioGraph->registerEvent(currentName.c_str());
 			
-			isRegistered = true;
+			isRegistered = (eventId != -1);
 		}
 	}
 }
@@ -108,11 +109,9 @@ void AudioNodeEventTrigger::tick(const float dt)
 	if (isPassthrough)
 		return;
 	
-	const char * name = getInputString(kInput_Name, nullptr);
-
-	if (name != nullptr)
+	if (isRegistered)
 	{
-		if (g_currentAudioGraph->isEventTriggered(name, false))
+		if (g_currentAudioGraph->isEventTriggered(eventId))
 		{
 			trigger(kOutput_Trigger);
 		}
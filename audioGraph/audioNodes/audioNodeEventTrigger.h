@@ -44,6 +44,7 @@ struct AudioNodeEventTrigger : AudioNodeBase
 	};
 	
 	std::string currentName;
+	int eventId;
 	
 	bool isRegistered;
 	
@@ -42,6 +42,8 @@ AUDIO_NODE_TYPE(AudioNodeFlags)
 
 AudioNodeFlags::AudioNodeFlags()
 	: AudioNodeBase()
+	, currentFlag()
+	, flagId(-1)
 	, wasSet(false)
 	, isSetOutput(false)
 {
@@ -54,18 +56,36 @@ AudioNodeFlags::AudioNodeFlags()
 	addOutput(kOutput_Reset, kAudioPlugType_Trigger, nullptr);
 }
 
+int AudioNodeFlags::updateFlagId()
+{
+	const char * flag = getInputString(kInput_Flag, nullptr);
+	
+	if (flag == nullptr)
+	{
+		currentFlag.clear();
+		flagId = -1;
+	}
+	else if (flagId == -1 || flag != currentFlag)
+	{
+		currentFlag = flag;
+		flagId = g_currentAudioGraph->getFlagId(flag);
+	}
+	
+	return flagId;
+}
+
 void AudioNodeFlags::tick(const float dt)
 {
 	if (isPassthrough)
 		return;
 		
-	const char * flag = getInputString(kInput_Flag, nullptr);
+	const int flagId = updateFlagId();
 	
 	bool isSet = false;
 	
-	if (flag != nullptr)
+	if (flagId != -1)
 	{
-		isSet = g_currentAudioGraph->isFlagSet(flag);
+		isSet = g_currentAudioGraph->isFlagSet(flagId);
 	}
 	
 	if (isSet != isSetOutput)
@@ -87,20 +107,20 @@ void AudioNodeFlags::handleTrigger(const int inputSocketIndex)
 {
 	if (inputSocketIndex == kInput_Set)
 	{
-		const char * flag = getInputString(kInput_Flag, nullptr);
+		const int flagId = updateFlagId();
 
-		if (flag != nullptr)
+		if (flagId != -1)
 		{
-			g_currentAudioGraph->setFlag(flag);
+			g_currentAudioGraph->setFlag(flagId);
 		}
 	}
 	else if (inputSocketIndex == kInput_Reset)
 	{
-		const char * flag = getInputString(kInput_Flag, nullptr);
+		const int flagId = updateFlagId();
 
-		if (flag != nullptr)
+		if (flagId != -1)
 		{
-			g_currentAudioGraph->resetFlag(flag);
+			g_currentAudioGraph->resetFlag(flagId);
 		}
 	}
 }
@@ -49,10 +49,15 @@ struct AudioNodeFlags : AudioNodeBase
 	
 	AudioNodeFlags();
 	
+	std::string currentFlag;
+	int flagId;
+	
 	bool wasSet;
 	
 	bool isSetOutput;
 	
+	int updateFlagId(); // returns the id of the flag, or -1 when no flag is set
+	
 	virtual void tick(const float dt) override;
 
 	virtual void handleTrigger(const int inputSocketIndex) override;
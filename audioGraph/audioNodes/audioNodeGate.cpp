@@ -47,6 +47,9 @@ AudioNodeGate::AudioNodeGate()
 	addInput(kInput_Open, kAudioPlugType_Trigger);
 	addInput(kInput_Close, kAudioPlugType_Trigger);
 	addOutput(kOutput_Output, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
+	isScalarPreserving = true;
 }
 
 void AudioNodeGate::tick(const float dt)
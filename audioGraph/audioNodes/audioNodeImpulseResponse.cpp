@@ -49,12 +49,16 @@ AudioNodeImpulseResponse::AudioNodeImpulseResponse()
 	addInput(kInput_Frequency, kAudioPlugType_FloatVec);
 	addInput(kInput_DecayPerMs, kAudioPlugType_FloatVec);
 	addOutput(kOutput_ImpulseResponse, kAudioPlugType_FloatVec, &impulseResponseOutput);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodeImpulseResponse::tick(const float in_dt)
 {
 	audioCpuTimingBlock(AudioNodeImpulseResponse);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	const AudioFloat * frequency = getInputAudioFloat(kInput_Frequency, &AudioFloat::One);
 	const float decayPerMs = getInputAudioFloat(kInput_DecayPerMs, &AudioFloat::Half)->getMean();
@@ -71,7 +75,7 @@ void AudioNodeImpulseResponse::tick(const float in_dt)
 		
 		impulseResponseOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			runningImpulseResponseX *= retain;
 			runningImpulseResponseY *= retain;
@@ -50,6 +50,8 @@ void AudioNodeInput::init(const GraphNode & node)
 
 void AudioNodeInput::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const int channel = getInputInt(kInput_Channel, 0);
 	const AudioFloat * gain = getInputAudioFloat(kInput_Gain, &AudioFloat::One);
 	
@@ -65,7 +67,7 @@ void AudioNodeInput::tick(const float dt)
 
 		audioOutput.setVector();
 
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i, channelPtr += audioIO->numInputChannels)
+		for (int i = 0; i < numSamples; ++i, channelPtr += audioIO->numInputChannels)
 		{
 			audioOutput.samples[i] = *channelPtr;
 		}
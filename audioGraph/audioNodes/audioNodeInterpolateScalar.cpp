@@ -37,6 +37,8 @@ AUDIO_NODE_TYPE(AudioNodeInterpolateScalar)
 
 void AudioNodeInterpolateScalar::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	
 	if (isPassthrough)
@@ -49,11 +51,22 @@ void AudioNodeInterpolateScalar::tick(const float dt)
 	{
 		const float oldValue = previousValue;
 		const float newValue = value->getScalar();
+		
+		if (newValue == oldValue)
+		{
+			// nothing to interpolate. output a scalar
+			
+			resultOutput.setScalar(newValue);
+			
+			return;
+		}
+		
+		resultOutput.setVector();
 
-		const float tStep = 1.f / AUDIO_UPDATE_SIZE;
+		const float tStep = 1.f / numSamples;
 		float t = 0.f;
 
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float w2 = t;
 			const float w1 = 1.f - t;
@@ -50,10 +50,13 @@ struct AudioNodeInterpolateScalar : AudioNodeBase
 	AudioNodeInterpolateScalar()
 		: AudioNodeBase()
 		, resultOutput()
+		, previousValue(0.f)
 	{
 		resizeSockets(kInput_COUNT, kOutput_COUNT);
 		addInput(kInput_Value, kAudioPlugType_FloatVec);
 		addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+		
+		isThreadSafe = true;
 	}
 	
 	virtual void tick(const float dt) override;
@@ -42,6 +42,8 @@ void AudioNodeLimiter::tick(const float dt)
 {
 	audioCpuTimingBlock(AudioNodeLimiter);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	const float max = getInputFloat(kInput_Max, 1.f);
 	const double decayPerMs = fmaxf(0.f, fminf(1.f, getInputFloat(kInput_DecayPerMillisecond, .001f)));
@@ -54,7 +56,7 @@ void AudioNodeLimiter::tick(const float dt)
 	}
 	else if (value->isScalar)
 	{
-		const double dtMs = AUDIO_UPDATE_SIZE * 1000.0 / double(SAMPLE_RATE);
+		const double dtMs = numSamples * 1000.0 / double(SAMPLE_RATE);
 		const double retainPerTick = pow(1.0 - decayPerMs, dtMs);
 
 		//
@@ -75,6 +77,6 @@ void AudioNodeLimiter::tick(const float dt)
 
 		resultOutput.setVector();
 		
-		limiter.apply(value->samples, AUDIO_UPDATE_SIZE, retainPerSample, max, resultOutput.samples);
+		limiter.apply(value->samples, numSamples, retainPerSample, max, resultOutput.samples);
 	}
 }
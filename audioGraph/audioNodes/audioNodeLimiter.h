@@ -60,6 +60,8 @@ struct AudioNodeLimiter : AudioNodeBase
 		addInput(kInput_Max, kAudioPlugType_Float);
 		addInput(kInput_DecayPerMillisecond, kAudioPlugType_Float);
 		addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+		
+		isThreadSafe = true;
 	}
 	
 	virtual void tick(const float dt) override;
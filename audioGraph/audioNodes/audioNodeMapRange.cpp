@@ -50,10 +50,15 @@ AudioNodeMapRange::AudioNodeMapRange()
 	addInput(kInput_OutMin, kAudioPlugType_FloatVec);
 	addInput(kInput_OutMax, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
+	isScalarPreserving = true;
 }
 
 void AudioNodeMapRange::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	const AudioFloat * inMin = getInputAudioFloat(kInput_InMin, &AudioFloat::Zero);
 	const AudioFloat * inMax = getInputAudioFloat(kInput_InMax, &AudioFloat::One);
@@ -104,7 +109,7 @@ void AudioNodeMapRange::tick(const float dt)
 			const v4sf * __restrict valuePtr = (v4sf*)value->samples;
 			      v4sf * __restrict resultPtr = (v4sf*)resultOutput.samples;
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE/4; ++i)
+			for (int i = 0; i < numSamples/4; ++i)
 			{
 				const v4sf t2 = (valuePtr[i] - inMin4) * scale4;
 				const v4sf t1 = one4 - t2;
@@ -116,7 +121,7 @@ void AudioNodeMapRange::tick(const float dt)
 			const float * __restrict valuePtr = value->samples;
 			      float * __restrict resultPtr = resultOutput.samples;
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				const float t2 = (valuePtr[i] - _inMin) * scale;
 				const float t1 = 1.f - t2;
@@ -138,7 +143,7 @@ void AudioNodeMapRange::tick(const float dt)
 		outMin->expand();
 		outMax->expand();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float _inMin = inMin->samples[i];
 			const float _inMax = inMax->samples[i];
@@ -160,6 +160,9 @@ AudioNodeMath::AudioNodeMath()
 	addInput(kInput_A, kAudioPlugType_FloatVec);
 	addInput(kInput_B, kAudioPlugType_FloatVec);
 	addOutput(kOutput_R, kAudioPlugType_FloatVec, &result);
+	
+	isThreadSafe = true;
+	isScalarPreserving = true;
 }
 
 void AudioNodeMath::tick(const float dt)
@@ -185,9 +188,11 @@ void AudioNodeMath::tick(const float dt)
 		
 		float * __restrict resultPtr = result.samples;
 		
+		const int numSamples = getCurrentAudioUpdateSize();
+		
 	#define CASE(type) \
 		case type: \
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i) \
+			for (int i = 0; i < numSamples; ++i) \
 				resultPtr[i] = evalMathOp<type>(a->samples[i], b->samples[i], kType_Unknown); \
 			break
 		
@@ -230,6 +235,9 @@ AudioNodeMathBase::AudioNodeMathBase()
 	addInput(kInput_A, kAudioPlugType_FloatVec);
 	addInput(kInput_B, kAudioPlugType_FloatVec);
 	addOutput(kOutput_R, kAudioPlugType_FloatVec, &result);
+	
+	isThreadSafe = true;
+	isScalarPreserving = true;
 }
 
 //
@@ -255,7 +263,8 @@ struct name : AudioNodeMathBase \
 			b->expand(); \
 			result.setVector(); \
 			float * __restrict dst = result.samples; \
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i) \
+			const int numSamples = getCurrentAudioUpdateSize(); \
+			for (int i = 0; i < numSamples; ++i) \
 			{ \
 				dst[i] = eval(a->samples[i], b->samples[i]); \
 			} \
@@ -32,6 +32,8 @@
 
 struct AudioNodeMathSine : AudioNodeBase
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	enum Input
 	{
 		kInput_Value,
@@ -53,6 +55,9 @@ struct AudioNodeMathSine : AudioNodeBase
 		resizeSockets(kInput_COUNT, kOutput_COUNT);
 		addInput(kInput_Value, kAudioPlugType_FloatVec);
 		addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+		
+		isThreadSafe = true;
+		isScalarPreserving = true;
 	}
 	
 	virtual void tick(const float dt) override
@@ -68,7 +73,7 @@ struct AudioNodeMathSine : AudioNodeBase
 		{
 			resultOutput.setVector();
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				resultOutput.samples[i] = sinf(value->samples[i] * twoPi);
 			}
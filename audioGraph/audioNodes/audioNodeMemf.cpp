@@ -44,6 +44,7 @@ AUDIO_NODE_TYPE(AudioNodeMemf)
 AudioNodeMemf::AudioNodeMemf()
 	: AudioNodeBase()
 	, currentName()
+	, memfId(-1)
 	, valueOutput()
 {
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
@@ -52,6 +53,8 @@ AudioNodeMemf::AudioNodeMemf()
 	addOutput(kOutput_Value2, kAudioPlugType_FloatVec, &valueOutput[1]);
 	addOutput(kOutput_Value3, kAudioPlugType_FloatVec, &valueOutput[2]);
 	addOutput(kOutput_Value4, kAudioPlugType_FloatVec, &valueOutput[3]);
+	
+	isScalarPreserving = true;
 }
 
 void AudioNodeMemf::tick(const float dt)
@@ -61,6 +64,7 @@ void AudioNodeMemf::tick(const float dt)
 	if (isPassthrough || name == nullptr)
 	{
 		currentName.clear();
+		memfId = -1;
 		
 		valueOutput[0].setScalar(0.f);
 		valueOutput[1].setScalar(0.f);
@@ -73,10 +77,10 @@ void AudioNodeMemf::tick(const float dt)
 		{
 			currentName = name;
 			
-			g_currentAudioGraph->registerMemf(name, 0.f, 0.f, 0.f, 0.f);
+			memfId = g_currentAudioGraph->registerMemf(name, 0.f, 0.f, 0.f, 0.f);
 		}
 		
-		const AudioGraph::Memf memf = g_currentAudioGraph->getMemf(name, false);
+		const AudioGraph::Memf memf = g_currentAudioGraph->getMemf(memfId, false);
 
 		valueOutput[0].setScalar(memf.value1_audioThread);
 		valueOutput[1].setScalar(memf.value2_audioThread);
@@ -94,5 +98,5 @@ void AudioNodeMemf::init(const GraphNode & node)
 	
 	currentName = name;
 	
-	g_currentAudioGraph->registerMemf(name, 0.f, 0.f, 0.f, 0.f);
+	memfId = g_currentAudioGraph->registerMemf(name, 0.f, 0.f, 0.f, 0.f);
 }
@@ -47,6 +47,7 @@ struct AudioNodeMemf : AudioNodeBase
 	};
 	
 	std::string currentName;
+	int memfId;
 	
 	AudioFloat valueOutput[4];
 
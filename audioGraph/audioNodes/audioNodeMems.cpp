@@ -38,11 +38,15 @@ AUDIO_NODE_TYPE(AudioNodeMems)
 
 AudioNodeMems::AudioNodeMems()
 	: AudioNodeBase()
+	, currentName()
+	, memsId(-1)
 	, valueOutput()
 {
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
 	addInput(kInput_Name, kAudioPlugType_String);
 	addOutput(kOutput_Value, kAudioPlugType_String, &valueOutput);
+	
+	valueOutput.reserve(kValueCapacity);
 }
 
 void AudioNodeMems::tick(const float dt)
@@ -52,6 +56,7 @@ void AudioNodeMems::tick(const float dt)
 	if (isPassthrough || name == nullptr)
 	{
 		currentName.clear();
+		memsId = -1;
 		
 		valueOutput.clear();
 	}
@@ -61,10 +66,16 @@ void AudioNodeMems::tick(const float dt)
 		{
 			currentName = name;
 			
-			g_currentAudioGraph->registerMems(name, "");
+			memsId = g_currentAudioGraph->registerMems(name, "");
 		}
 		
-		g_currentAudioGraph->getMems(name, valueOutput);
+		// note : we only copy the value when it changed. the copy reuses the memory of the output string when
+		//        the new value fits, which is usually the case as its capacity is reserved up front
+		
+		const std::string & value = g_currentAudioGraph->getMems(memsId);
+		
+		if (valueOutput != value)
+			valueOutput = value;
 	}
 }
 
@@ -77,5 +88,5 @@ void AudioNodeMems::init(const GraphNode & node)
 	
 	currentName = name;
 	
-	g_currentAudioGraph->registerMems(name, "");
+	memsId = g_currentAudioGraph->registerMems(name, "");
 }
@@ -43,7 +43,10 @@ struct AudioNodeMems : AudioNodeBase
 		kOutput_COUNT
 	};
 	
+	static const int kValueCapacity = 256;
+	
 	std::string currentName;
+	int memsId;
 	
 	std::string valueOutput;
 
@@ -70,6 +70,9 @@ struct AudioNodeMix : AudioNodeBase
 		addOutput(kOutput_Audio, kAudioPlugType_FloatVec, &audioOutput);
 		
 		isDeprecated = true;
+		
+		isThreadSafe = true;
+		isScalarPreserving = true;
 	}
 	
 	virtual void tick(const float dt) override
@@ -68,6 +68,9 @@ struct AudioNodeSourceMix : AudioNodeBase
 		addOutput(kOutput_Audio, kAudioPlugType_FloatVec, &audioOutput);
 		
 		isDeprecated = true;
+		
+		isThreadSafe = true;
+		isScalarPreserving = true;
 	}
 	
 	virtual void tick(const float dt) override
@@ -115,7 +118,7 @@ struct AudioNodeSourceMix : AudioNodeBase
 		
 		if (numInputs == 0)
 		{
-			audioBufferSetZero(audioOutput.samples, AUDIO_UPDATE_SIZE);
+			audioOutput.setZero();
 			
 			return;
 		}
@@ -126,7 +129,7 @@ struct AudioNodeSourceMix : AudioNodeBase
 		{
 			auto & input = inputs[i];
 			
-			input.source->expand();
+			// note : setMul and addMul expand the source when needed. scalar sources and gains produce a scalar result
 			
 			if (isFirst)
 			{
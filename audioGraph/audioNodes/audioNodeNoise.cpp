@@ -56,6 +56,8 @@ AUDIO_NODE_TYPE(AudioNodeNoise)
 
 void AudioNodeNoise::drawOctave()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const int numOctaves = getInputInt(kInput_NumOctaves, 6);
 	const int sampleRate = std::max(1, getInputInt(kInput_SampleRate, 100));
 	const bool fine = getInputBool(kInput_Fine, true);
@@ -66,13 +68,13 @@ void AudioNodeNoise::drawOctave()
 	const AudioFloat * x = getInputAudioFloat(kInput_X, &AudioFloat::Zero);
 	
 	const double numSamplesPerSecond = sampleRate;
-	const double numSamplesPerTick = AUDIO_UPDATE_SIZE / double(SAMPLE_RATE) * numSamplesPerSecond;
+	const double numSamplesPerTick = numSamples / double(SAMPLE_RATE) * numSamplesPerSecond;
 
 	const int nearestSampleCount = fine ? int(std::round(numSamplesPerTick)) : 1;
 
 	if (nearestSampleCount <= 1)
 	{
-		const int iMid = AUDIO_UPDATE_SIZE/2;
+		const int iMid = numSamples/2;
 
 		const float value = scaled_octave_noise_1d(
 			numOctaves,
@@ -86,7 +88,7 @@ void AudioNodeNoise::drawOctave()
 	}
 	else
 	{
-		const int nearestSamplingInterval = std::max(1, AUDIO_UPDATE_SIZE / nearestSampleCount);
+		const int nearestSamplingInterval = std::max(1, numSamples / nearestSampleCount);
 		
 		scale->expand();
 		persistence->expand();
@@ -96,10 +98,10 @@ void AudioNodeNoise::drawOctave()
 		
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; i += nearestSamplingInterval)
+		for (int i = 0; i < numSamples; i += nearestSamplingInterval)
 		{
 			const int i1 = i;
-			const int i2 = std::min(AUDIO_UPDATE_SIZE, i1 + nearestSamplingInterval);
+			const int i2 = std::min(numSamples, i1 + nearestSamplingInterval);
 
 			const int iMid = (i1 + i2) / 2;
 
@@ -121,6 +123,8 @@ void AudioNodeNoise::drawOctave()
 
 void AudioNodeNoise::drawWhite()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const bool fine = getInputBool(kInput_Fine, true);
 	const AudioFloat * scale = getInputAudioFloat(kInput_Scale, &AudioFloat::One);
 	const AudioFloat * min = getInputAudioFloat(kInput_Min, &AudioFloat::Zero);
@@ -142,7 +146,7 @@ void AudioNodeNoise::drawWhite()
 		const float minValue = min->getScalar() * scale->getScalar();
 		const float maxValue = max->getScalar() * scale->getScalar();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			resultOutput.samples[i] = rng.nextf(minValue, maxValue);
 		}
@@ -155,7 +159,7 @@ void AudioNodeNoise::drawWhite()
 		
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float minValue = min->samples[i] * scale->samples[i];
 			const float maxValue = max->samples[i] * scale->samples[i];
@@ -167,6 +171,8 @@ void AudioNodeNoise::drawWhite()
 
 void AudioNodeNoise::drawPink()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	// pink noise (-3dB/octave) using Voss' method of a sample-and-hold random number generator
 	
 	const bool fine = getInputBool(kInput_Fine, true);
@@ -192,14 +198,14 @@ void AudioNodeNoise::drawPink()
 		const float minValue = min->getScalar() * scale->getScalar();
 		const float maxValue = max->getScalar() * scale->getScalar();
 		
-		ALIGN16 float values[AUDIO_UPDATE_SIZE];
+		ALIGN16 float values[AUDIO_MAX_UPDATE_SIZE];
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			values[i] = pinkNumber.next() * pinkScale;
 		}
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float t = values[i];
 			
@@ -214,7 +220,7 @@ void AudioNodeNoise::drawPink()
 		
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float minValue = min->samples[i] * scale->samples[i];
 			const float maxValue = max->samples[i] * scale->samples[i];
@@ -228,6 +234,8 @@ void AudioNodeNoise::drawPink()
 
 void AudioNodeNoise::drawBrown()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	// brown noise (-6dB/octave) by integrating brownian motion, using a leaky integrator to ensure the signal doesn't drift off too much from zero
 	
 	const bool fine = getInputBool(kInput_Fine, true);
@@ -257,7 +265,7 @@ void AudioNodeNoise::drawBrown()
 		const float minValue = min->getScalar() * scale->getScalar();
 		const float maxValue = max->getScalar() * scale->getScalar();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			resultOutput.samples[i] = ((minValue + maxValue) + (float)brownValue * (maxValue - minValue)) * .5f;
 
@@ -273,7 +281,7 @@ void AudioNodeNoise::drawBrown()
 		
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float minValue = min->samples[i] * scale->samples[i];
 			const float maxValue = max->samples[i] * scale->samples[i];
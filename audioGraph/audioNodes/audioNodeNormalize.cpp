@@ -43,6 +43,8 @@ void AudioNodeNormalize::tick(const float dt)
 {
 	audioCpuTimingBlock(AudioNodeNormalize);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	const float level = getInputFloat(kInput_Level, 1.f);
 	const float maxAmp = getInputFloat(kInput_MaxAmplification, 10.f);
@@ -69,7 +71,7 @@ void AudioNodeNormalize::tick(const float dt)
 
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const float input = value->samples[i];
 
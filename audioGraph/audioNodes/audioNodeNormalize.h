@@ -61,6 +61,8 @@ struct AudioNodeNormalize : AudioNodeBase
 		addInput(kInput_MaxAmplification, kAudioPlugType_Float);
 		addInput(kInput_DecayPerMillisecond, kAudioPlugType_Float);
 		addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+		
+		isThreadSafe = true;
 	}
 	
 	virtual void tick(const float dt) override;
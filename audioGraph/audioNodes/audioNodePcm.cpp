@@ -29,6 +29,15 @@ OTHER DEALINGS IN THE SOFTWARE.
 #include "audioNodePcm.h"
 #include "pcmDataCache.h"
 
+AUDIO_ENUM_TYPE(pcmResampleQuality)
+{
+	elem("linear");
+	elem("cubic");
+	elem("sinc16");
+	elem("sinc32");
+	elem("sinc64");
+}
+
 AUDIO_NODE_TYPE(AudioNodeSourcePcm)
 {
 	typeName = "audio.pcm";
@@ -44,6 +53,8 @@ AUDIO_NODE_TYPE(AudioNodeSourcePcm)
 	in("resume!", "trigger");
 	in("rangeBegin", "audioValue");
 	in("rangeLength", "audioValue", "-1");
+	in("pitch", "audioValue", "1");
+	inEnum("quality", "pcmResampleQuality", kResampleQuality_Sinc16);
 	out("audio", "audioValue");
 	out("duration", "float");
 	out("done!", "trigger");
@@ -53,6 +64,7 @@ AUDIO_NODE_TYPE(AudioNodeSourcePcm)
 AudioNodeSourcePcm::AudioNodeSourcePcm()
 	: AudioNodeBase()
 	, wasDone(false)
+	, pcmDataRef()
 	, audioSource()
 	, audioOutput()
 	, lengthOutput(0.f)
@@ -69,6 +81,8 @@ AudioNodeSourcePcm::AudioNodeSourcePcm()
 	addInput(kInput_Resume, kAudioPlugType_Trigger);
 	addInput(kInput_RangeBegin, kAudioPlugType_FloatVec);
 	addInput(kInput_RangeLength, kAudioPlugType_FloatVec);
+	addInput(kInput_Pitch, kAudioPlugType_FloatVec);
+	addInput(kInput_ResampleQuality, kAudioPlugType_Int);
 	addOutput(kOutput_Audio, kAudioPlugType_FloatVec, &audioOutput);
 	addOutput(kOutput_Length, kAudioPlugType_Float, &lengthOutput);
 	addOutput(kOutput_Done, kAudioPlugType_Trigger, nullptr);
@@ -85,6 +99,8 @@ void AudioNodeSourcePcm::init(const GraphNode & node)
 
 void AudioNodeSourcePcm::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const PcmData * pcmData = getInputPcmData(kInput_PcmData);
 	const char * filename = getInputString(kInput_Filename, nullptr);
 	const AudioFloat * gain = getInputAudioFloat(kInput_Gain, &AudioFloat::One);
@@ -92,6 +108,8 @@ void AudioNodeSourcePcm::tick(const float dt)
 	const int loopCount = getInputInt(kInput_LoopCount, 0);
 	const AudioFloat * rangeBegin = getInputAudioFloat(kInput_RangeBegin, nullptr);
 	const AudioFloat * rangeLength = getInputAudioFloat(kInput_RangeLength, nullptr);
+	const AudioFloat * pitch = getInputAudioFloat(kInput_Pitch, &AudioFloat::One);
+	const ResampleQuality resampleQuality = (ResampleQuality)getInputInt(kInput_ResampleQuality, kResampleQuality_Sinc16);
 	
 	// update PCM data and length output. note : same pcmData doesn't necessarily mean the PCM data hasn't changed. it could have been re-allocated at the same address. just always update the length here instead of trying to be clever and detect changes
 	
@@ -99,10 +117,16 @@ void AudioNodeSourcePcm::tick(const float dt)
 	{
 		auto * pcmDataCache = g_currentAudioGraph->context->findObject<PcmDataCache>();
 		
-		pcmData =
-			pcmDataCache == nullptr
-			? nullptr
-			: pcmDataCache->get(filename);
+		if (pcmDataCache == nullptr)
+			pcmDataRef.reset();
+		else
+			pcmDataCache->acquire(filename, pcmDataRef);
+		
+		pcmData = pcmDataRef.get();
+	}
+	else
+	{
+		pcmDataRef.reset();
 	}
 	
 	audioSource.pcmData = pcmData;
@@ -121,6 +145,11 @@ void AudioNodeSourcePcm::tick(const float dt)
 	audioSource.loop = loop;
 	audioSource.maxLoopCount = loopCount;
 	
+	audioSource.pitch = pitch->getMean();
+	
+	if (resampleQuality >= 0 && resampleQuality < kResampleQuality_COUNT)
+		audioSource.resampleQuality = resampleQuality;
+	
 	if ((rangeBegin == nullptr && rangeLength == nullptr) || pcmData == nullptr)
 	{
 		audioSource.clearRange();
@@ -141,7 +170,7 @@ void AudioNodeSourcePcm::tick(const float dt)
 	{
 		audioOutput.setVector();
 		
-		audioSource.generate(audioOutput.samples, AUDIO_UPDATE_SIZE);
+		audioSource.generate(audioOutput.samples, numSamples);
 		
 		audioOutput.mul(*gain);
 		
@@ -29,6 +29,7 @@
 
 #include "audioNodeBase.h"
 #include "audioSourcePcm.h"
+#include "pcmDataCache.h"
 
 struct AudioNodeSourcePcm : AudioNodeBase
 {
@@ -45,6 +46,8 @@ struct AudioNodeSourcePcm : AudioNodeBase
 		kInput_Resume,
 		kInput_RangeBegin,
 		kInput_RangeLength,
+		kInput_Pitch,
+		kInput_ResampleQuality,
 		kInput_COUNT
 	};
 	
@@ -59,6 +62,8 @@ struct AudioNodeSourcePcm : AudioNodeBase
 	
 	bool wasDone;
 	
+	PcmDataCache::Ref pcmDataRef; // keeps the PCM data for the filename alive until it's acquired again during the next tick
+	
 	AudioSourcePcm audioSource;
 	AudioFloat audioOutput;
 	float lengthOutput;
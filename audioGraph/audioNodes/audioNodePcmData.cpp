@@ -25,6 +25,8 @@ FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
 OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include "audioGraph.h"
+#include "audioGraphContext.h"
 #include "audioNodePcmData.h"
 #include "pcmDataCache.h"
 
@@ -43,22 +45,27 @@ void AudioNodePcmData::tick(const float dt)
 	if (filename != currentFilename)
 	{
 		currentFilename = filename;
-		
-		auto * pcmDataCache = g_currentAudioGraph->context->findObject<PcmDataCache>();
-		
-		const PcmData * newPcmData =
-			pcmDataCache == nullptr
-			? nullptr
-			: pcmDataCache->get(filename);
-		
-		if (newPcmData == nullptr)
-		{
-			pcmData.reset();
-		}
-		else
-		{
-			pcmData.set(newPcmData->samples, newPcmData->numSamples);
-		}
+	}
+	
+	// note : look up the PCM data each tick. with lazy loading, the cache yields nullptr until the PCM data has
+	//        been loaded. the reference keeps the PCM data we output from being evicted until the next tick
+	
+	auto * pcmDataCache = g_currentAudioGraph->context->findObject<PcmDataCache>();
+	
+	if (pcmDataCache == nullptr)
+		pcmDataRef.reset();
+	else
+		pcmDataCache->acquire(filename, pcmDataRef);
+	
+	const PcmData * newPcmData = pcmDataRef.get();
+	
+	if (newPcmData == nullptr)
+	{
+		pcmData.reset();
+	}
+	else
+	{
+		pcmData.set(newPcmData->samples, newPcmData->numSamples);
 	}
 }
 
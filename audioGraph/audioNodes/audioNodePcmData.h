@@ -28,6 +28,7 @@
 #pragma once
 
 #include "audioNodeBase.h"
+#include "pcmDataCache.h"
 #include "soundmix.h" // PcmData
 
 struct AudioNodePcmData : AudioNodeBase
@@ -46,11 +47,14 @@ struct AudioNodePcmData : AudioNodeBase
 	
 	PcmData pcmData;
 	
+	PcmDataCache::Ref pcmDataRef; // keeps the PCM data alive until it's acquired again during the next tick
+	
 	std::string currentFilename;
 	
 	AudioNodePcmData()
 		: AudioNodeBase()
 		, pcmData()
+		, pcmDataRef()
 		, currentFilename()
 	{
 		resizeSockets(kInput_COUNT, kOutput_COUNT);
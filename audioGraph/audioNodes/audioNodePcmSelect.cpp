@@ -59,6 +59,7 @@ AudioNodeSourcePcmSelect::AudioNodeSourcePcmSelect()
 	, currentPath()
 	, fileIndex(-1)
 	, samplePosition(0)
+	, pcmDataRef()
 	, loopCount(0)
 	, audioOutput()
 {
@@ -82,29 +83,31 @@ AudioNodeSourcePcmSelect::~AudioNodeSourcePcmSelect()
 
 void AudioNodeSourcePcmSelect::freeFiles()
 {
-	files.clear();
+	filenames.clear();
 
 	//
 
 	fileIndex = -1;
 	samplePosition = 0;
+	
+	pcmDataRef.reset();
 }
 
 void AudioNodeSourcePcmSelect::nextFile(const Mode mode)
 {
-	if (files.empty() == false)
+	if (filenames.empty() == false)
 	{
 		if (mode == kMode_Forward)
 		{
-			fileIndex = (fileIndex + 1 + files.size()) % files.size();
+			fileIndex = (fileIndex + 1 + filenames.size()) % filenames.size();
 		}
 		else if (mode == kMode_Backward)
 		{
-			fileIndex = (fileIndex - 1 + files.size()) % files.size();
+			fileIndex = (fileIndex - 1 + filenames.size()) % filenames.size();
 		}
 		else if (mode == kMode_Random)
 		{
-			fileIndex = rand() % files.size();
+			fileIndex = rand() % filenames.size();
 		}
 		
 		samplePosition = 0;
@@ -113,12 +116,16 @@ void AudioNodeSourcePcmSelect::nextFile(const Mode mode)
 
 void AudioNodeSourcePcmSelect::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const char * path = getInputString(kInput_Path, "");
 	const Mode mode = (Mode)getInputInt(kInput_Mode, 0);
 	const AudioFloat * gain = getInputAudioFloat(kInput_Gain, &AudioFloat::One);
 	const bool autoPlay = getInputBool(kInput_AutoPlay, false);
 	const int maxLoopCount = getInputInt(kInput_MaxLoopCount, 0);
 	
+	auto * pcmDataCache = g_currentAudioGraph->context->findObject<PcmDataCache>();
+	
 	if (path != currentPath)
 	{
 		freeFiles();
@@ -127,18 +134,12 @@ void AudioNodeSourcePcmSelect::tick(const float dt)
 		
 		const std::vector<std::string> filenames = listFiles(path, false);
 
-		auto * pcmDataCache = g_currentAudioGraph->context->findObject<PcmDataCache>();
-
 		if (pcmDataCache != nullptr)
 		{
 			for (auto & filename : filenames)
 			{
-				const PcmData * pcmData = pcmDataCache->get(filename.c_str());
-				
-				if (pcmData != nullptr && pcmData->numSamples > 0)
+				if (pcmDataCache->exists(filename.c_str()))
 				{
-					files.push_back(pcmData);
-					
 					this->filenames.push_back(filename);
 				}
 			}
@@ -156,21 +157,31 @@ void AudioNodeSourcePcmSelect::tick(const float dt)
 		nextFile(mode);
 	}
 
+	// note : fetch the PCM data each tick, as a cache with lazy loading may not have loaded it yet. the
+	//        reference keeps it from being evicted until the next tick
+	
+	if (fileIndex == -1 || pcmDataCache == nullptr)
+		pcmDataRef.reset();
+	else
+		pcmDataCache->acquire(filenames[fileIndex].c_str(), pcmDataRef);
+	
+	const PcmData * pcmData = pcmDataRef.get();
+	
 	if (isPassthrough)
 	{
 		audioOutput.setScalar(0.f);
 	}
-	else if (fileIndex == -1 || files[fileIndex]->numSamples == 0)
+	else if (pcmData == nullptr || pcmData->numSamples == 0)
 	{
+		// note : with lazy loading, the PCM data may not be ready yet
+		
 		audioOutput.setScalar(0.f);
 	}
 	else
 	{
-		const PcmData * pcmData = files[fileIndex];
-		
 		audioOutput.setVector();
 		
-		int left = AUDIO_UPDATE_SIZE;
+		int left = numSamples;
 		int done = 0;
 		
 		while (left != 0)
@@ -190,6 +201,13 @@ void AudioNodeSourcePcmSelect::tick(const float dt)
 					nextFile(mode);
 					
 					trigger(kOutput_Loop);
+					
+					pcmDataCache->acquire(filenames[fileIndex].c_str(), pcmDataRef);
+					
+					pcmData = pcmDataRef.get();
+					
+					if (pcmData == nullptr || pcmData->numSamples == 0)
+						break;
 				}
 				else
 				{
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "audioNodeBase.h"
+#include "pcmDataCache.h"
 
 struct AudioNodeSourcePcmSelect : AudioNodeBase
 {
@@ -59,11 +60,12 @@ struct AudioNodeSourcePcmSelect : AudioNodeBase
 	};
 	
 	std::string currentPath;
-	std::vector<const PcmData*> files;
 	std::vector<std::string> filenames;
 	int fileIndex;
 	int samplePosition;
 	
+	PcmDataCache::Ref pcmDataRef; // keeps the PCM data for the current file alive until it's acquired again during the next tick
+	
 	int loopCount;
 
 	AudioFloat audioOutput;
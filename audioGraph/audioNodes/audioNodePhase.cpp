@@ -48,10 +48,14 @@ AudioNodePhase::AudioNodePhase()
 	addInput(kInput_Frequency, kAudioPlugType_FloatVec);
 	addInput(kInput_PhaseOffset, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodePhase::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const bool fineGrained = getInputBool(kInput_FineGrained, true);
 	const AudioFloat * frequency = getInputAudioFloat(kInput_Frequency, &AudioFloat::Zero);
 	const AudioFloat * phaseOffset = getInputAudioFloat(kInput_PhaseOffset, &AudioFloat::Zero);
@@ -76,7 +80,7 @@ void AudioNodePhase::tick(const float dt)
 		#if 0
 			const float phaseStep = fmodf(_frequency / SAMPLE_RATE, 1.f);
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				resultOutput.samples[i] = phase + _phaseOffset;
 				
@@ -93,7 +97,7 @@ void AudioNodePhase::tick(const float dt)
 			
 			float _phase = phase + _phaseOffset;
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; i += 4)
+			for (int i = 0; i < numSamples; i += 4)
 			{
 				float value1 = _phase;
 				float value2 = _phase + phaseStep1;
@@ -128,7 +132,7 @@ void AudioNodePhase::tick(const float dt)
 			frequency->expand();
 			phaseOffset->expand();
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				const float _frequency = frequency->samples[i];
 				const float _phaseOffset = phaseOffset->samples[i];
@@ -147,7 +151,7 @@ void AudioNodePhase::tick(const float dt)
 		
 		resultOutput.setScalar(phase + _phaseOffset);
 		
-		phase += _frequency / SAMPLE_RATE * AUDIO_UPDATE_SIZE;
+		phase += _frequency / SAMPLE_RATE * numSamples;
 		phase = phase - floorf(phase);
 	}
 }
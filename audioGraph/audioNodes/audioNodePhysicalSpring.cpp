@@ -56,12 +56,16 @@ AudioNodePhysicalSpring::AudioNodePhysicalSpring()
 	addInput(kInput_ImpulseTrigger, kAudioPlugType_Trigger);
 	addOutput(kOutput_Value, kAudioPlugType_FloatVec, &outputValue);
 	addOutput(kOutput_Speed, kAudioPlugType_FloatVec, &outputSpeed);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodePhysicalSpring::tick(const float _dt)
 {
 	audioCpuTimingBlock(AudioNodePhysicalSpring);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	if (isPassthrough)
 	{
 		outputValue.setScalar(0.f);
@@ -76,6 +80,7 @@ void AudioNodePhysicalSpring::tick(const float _dt)
 	strength->expand();
 	externalForce->expand();
 
+	// note : time is measured in units of AUDIO_UPDATE_SIZE samples, so the spring behaves the same regardless of the actual update size
 	const double dt = 1.0 / AUDIO_UPDATE_SIZE;
 
 	outputValue.setVector();
@@ -90,7 +95,7 @@ void AudioNodePhysicalSpring::tick(const float _dt)
 	
 	SCOPED_FLUSH_DENORMALS;
 	
-	for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+	for (int i = 0; i < numSamples; ++i)
 	{
 		if (dampen->isScalar == false)
 		{
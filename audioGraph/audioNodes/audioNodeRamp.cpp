@@ -47,6 +47,8 @@ AUDIO_NODE_TYPE(AudioNodeRamp)
 
 void AudioNodeRamp::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * input = getInputAudioFloat(kInput_Value, &AudioFloat::One);
 	const AudioFloat * rampTime = getInputAudioFloat(kInput_RampTime, &AudioFloat::One);
 	const AudioFloat * rampUpTime = getInputAudioFloat(kInput_RampUpTime, rampTime);
@@ -89,7 +91,7 @@ void AudioNodeRamp::tick(const float dt)
 			
 			const float minRampTime = .1f / SAMPLE_RATE;
 			
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				if (ramp)
 				{
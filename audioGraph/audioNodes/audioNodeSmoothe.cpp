@@ -48,6 +48,8 @@ void AudioNodeSmoothe::tick(const float _dt)
 {
 	audioCpuTimingBlock(AudioNodeSmoothe);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat * value = getInputAudioFloat(kInput_Value, &AudioFloat::Zero);
 	const SmoothingUnit smoothingUnit = (SmoothingUnit)getInputInt(kInput_SmoothingUnit, 0);
 	const AudioFloat * retain = getInputAudioFloat(kInput_Smoothness, &AudioFloat::Half);
@@ -58,6 +60,12 @@ void AudioNodeSmoothe::tick(const float _dt)
 	{
 		resultOutput.set(*value);
 	}
+	else if (retain->isScalar && value->isScalar && currentValue == value->getScalar())
+	{
+		// the smoothed value has converged onto the input value. output a scalar until the input changes
+		
+		resultOutput.setScalar(currentValue);
+	}
 	else if (retain->isScalar)
 	{
 		value->expand();
@@ -70,12 +78,23 @@ void AudioNodeSmoothe::tick(const float _dt)
 		
 		SCOPED_FLUSH_DENORMALS;
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			resultOutput.samples[i] = currentValue;
 			
 			currentValue = currentValue * retainPerSample + value->samples[i] * followPerSample;
 		}
+		
+		if (value->isScalar)
+		{
+			// snap onto the input value when we're close enough. the smoothed value may otherwise never
+			// become exactly equal to it due to rounding
+			
+			const double target = value->getScalar();
+			
+			if (fabs(currentValue - target) <= 1e-6 * (1.0 + fabs(target)))
+				currentValue = target;
+		}
 	}
 	else
 	{
@@ -83,7 +102,7 @@ void AudioNodeSmoothe::tick(const float _dt)
 		
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			const double retainPerSecond = fminf(1.f, fmaxf(0.f, retain->samples[i]));
 			const double retainPerSample = pow(retainPerSecond, dt);
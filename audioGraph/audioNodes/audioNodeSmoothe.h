@@ -65,6 +65,8 @@ struct AudioNodeSmoothe : AudioNodeBase
 		addInput(kInput_SmoothingUnit, kAudioPlugType_Int);
 		addInput(kInput_Smoothness, kAudioPlugType_FloatVec);
 		addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+		
+		isThreadSafe = true;
 	}
 	
 	virtual void tick(const float dt) override;
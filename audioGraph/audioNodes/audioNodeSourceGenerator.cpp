@@ -84,6 +84,8 @@ AudioNodeSourceSine::AudioNodeSourceSine()
 
 void AudioNodeSourceSine::drawSine()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const Mode mode = (Mode)getInputInt(kInput_Mode, kMode_MinMax);
 	const bool fine = getInputBool(kInput_Fine, true);
 	const AudioFloat * frequency = getInputAudioFloat(kInput_Frequency, &AudioFloat::One);
@@ -104,7 +106,7 @@ void AudioNodeSourceSine::drawSine()
 		
 		if (mode == kMode_BaseScale)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				audioOutput.samples[i] = a->samples[i] + sinf(phase * twoPi) * b->samples[i];
 				
@@ -114,7 +116,7 @@ void AudioNodeSourceSine::drawSine()
 		}
 		else if (mode == kMode_MinMax)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				audioOutput.samples[i] = a->samples[i] + (.5f + .5f * sinf(phase * twoPi)) * (b->samples[i] - a->samples[i]);
 				
@@ -131,7 +133,7 @@ void AudioNodeSourceSine::drawSine()
 			
 			audioOutput.setScalar(value);
 			
-			phase += dt * frequency->getMean() * AUDIO_UPDATE_SIZE;
+			phase += dt * frequency->getMean() * numSamples;
 			phase = fmodf(phase, 1.f);
 		}
 		else if (mode == kMode_MinMax)
@@ -143,7 +145,7 @@ void AudioNodeSourceSine::drawSine()
 			
 			audioOutput.setScalar(value);
 			
-			phase += dt * frequency->getMean() * AUDIO_UPDATE_SIZE;
+			phase += dt * frequency->getMean() * numSamples;
 			phase = fmodf(phase, 1.f);
 		}
 	}
@@ -151,6 +153,8 @@ void AudioNodeSourceSine::drawSine()
 
 void AudioNodeSourceSine::drawTriangle()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const Mode mode = (Mode)getInputInt(kInput_Mode, kMode_MinMax);
 	const bool fine = getInputBool(kInput_Fine, true);
 	const AudioFloat * frequency = getInputAudioFloat(kInput_Frequency, &AudioFloat::One);
@@ -171,7 +175,7 @@ void AudioNodeSourceSine::drawTriangle()
 		
 		if (mode == kMode_BaseScale)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				float value;
 				
@@ -194,7 +198,7 @@ void AudioNodeSourceSine::drawTriangle()
 		}
 		else if (mode == kMode_MinMax)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				float value;
 				
@@ -218,7 +222,7 @@ void AudioNodeSourceSine::drawTriangle()
 	}
 	else
 	{
-		const float dt = AUDIO_UPDATE_SIZE / float(SAMPLE_RATE);
+		const float dt = numSamples / float(SAMPLE_RATE);
 		
 		const float frequency_scalar = frequency->getMean();
 		const float a_scalar = a->getMean();
@@ -269,6 +273,8 @@ void AudioNodeSourceSine::drawTriangle()
 
 void AudioNodeSourceSine::drawSquare()
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const Mode mode = (Mode)getInputInt(kInput_Mode, kMode_MinMax);
 	const bool fine = getInputBool(kInput_Fine, true);
 	const AudioFloat * frequency = getInputAudioFloat(kInput_Frequency, &AudioFloat::One);
@@ -289,7 +295,7 @@ void AudioNodeSourceSine::drawSquare()
 		
 		if (mode == kMode_BaseScale)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				float value = a->samples[i];
 				
@@ -308,7 +314,7 @@ void AudioNodeSourceSine::drawSquare()
 		}
 		else if (mode == kMode_MinMax)
 		{
-			for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+			for (int i = 0; i < numSamples; ++i)
 			{
 				const float skew_i = skew->samples[i];
 				
@@ -324,7 +330,7 @@ void AudioNodeSourceSine::drawSquare()
 	}
 	else
 	{
-		const float dt = AUDIO_UPDATE_SIZE / float(SAMPLE_RATE);
+		const float dt = numSamples / float(SAMPLE_RATE);
 		
 		if (mode == kMode_BaseScale)
 		{
@@ -42,6 +42,9 @@ AudioNodeSum::AudioNodeSum()
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
 	addInput(kInput_Input, kAudioPlugType_FloatVec);
 	addOutput(kOutput_Sum, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
+	isScalarPreserving = true;
 }
 
 void AudioNodeSum::tick(const float dt)
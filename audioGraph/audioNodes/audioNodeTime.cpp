@@ -63,10 +63,14 @@ AudioNodeTime::AudioNodeTime()
 	addInput(kInput_Scale, kAudioPlugType_Float);
 	addInput(kInput_Offset, kAudioPlugType_Float);
 	addOutput(kOutput_Result, kAudioPlugType_FloatVec, &resultOutput);
+	
+	isThreadSafe = true;
 }
 
 void AudioNodeTime::tick(const float dt)
 {
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const bool fineGrained = getInputBool(kInput_FineGrained, true);
 	const Mode mode = (Mode)getInputInt(kInput_Mode, 0);
 	const float scale = getInputFloat(kInput_Scale, 1.f);
@@ -78,7 +82,7 @@ void AudioNodeTime::tick(const float dt)
 	{
 		resultOutput.setVector();
 		
-		for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+		for (int i = 0; i < numSamples; ++i)
 		{
 			resultOutput.samples[i] = time * scale + offset;
 			
@@ -87,7 +91,7 @@ void AudioNodeTime::tick(const float dt)
 	}
 	else
 	{
-		time += 1.0 / SAMPLE_RATE * (AUDIO_UPDATE_SIZE / 2);
+		time += 1.0 / SAMPLE_RATE * (numSamples / 2);
 		
 		resultOutput.setScalar(time * scale + offset);
 	}
@@ -52,7 +52,7 @@ AUDIO_NODE_TYPE(AudioNodeVoice)
 
 void AudioNodeVoice::AudioSourceVoiceNode::generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples)
 {
-	Assert(numSamples == AUDIO_UPDATE_SIZE);
+	Assert(numSamples <= AUDIO_MAX_UPDATE_SIZE);
 	
 	if (voiceNode->isPassthrough)
 	{
@@ -64,9 +64,20 @@ void AudioNodeVoice::AudioSourceVoiceNode::generate(SAMPLE_ALIGN16 float * __res
 		{
 			const AudioFloat * audio = voiceNode->getInputAudioFloat(kInput_Audio, &AudioFloat::Zero);
 			
-			audio->expand();
+			// note : we're called by the voice manager, outside of the graph's tick. so rather than
+			//        expanding the value, which depends on the current update size, we copy it here
 			
-			memcpy(samples, audio->samples, numSamples * sizeof(float));
+			if (audio->isScalar)
+			{
+				const float value = audio->getScalar();
+				
+				for (int i = 0; i < numSamples; ++i)
+					samples[i] = value;
+			}
+			else
+			{
+				memcpy(samples, audio->samples, numSamples * sizeof(float));
+			}
 		}
 		clearCurrentAudioGraphTraversalId();
 	}
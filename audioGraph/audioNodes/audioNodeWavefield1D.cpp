@@ -454,6 +454,8 @@ void AudioNodeWavefield1D::tick(const float in_dt)
 {
 	audioCpuTimingBlock(AudioNodeWavefield1D);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat defaultTension(1.f);
 	
 	const AudioFloat * gain = getInputAudioFloat(kInput_Gain, &AudioFloat::One);
@@ -496,7 +498,7 @@ void AudioNodeWavefield1D::tick(const float in_dt)
 	
 	const bool closedEnds = (wrap == false);
 	
-	for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+	for (int i = 0; i < numSamples; ++i)
 	{
 		const double c = Wavefield::clamp<double>(tension->samples[i] * 1000000.0, -maxTension, +maxTension);
 		
@@ -515,11 +517,11 @@ void AudioNodeWavefield1D::tick(const float in_dt)
 			break;
 			
 		case kSoftClip_SigmoidFast:
-			audioBufferClip_SigmoidFast(audioOutput.samples, AUDIO_UPDATE_SIZE);
+			audioBufferClip_SigmoidFast(audioOutput.samples, numSamples);
 			break;
 		
 		case kSoftClip_SigmoidSqrt:
-			audioBufferClip_SigmoidSqrt(audioOutput.samples, AUDIO_UPDATE_SIZE);
+			audioBufferClip_SigmoidSqrt(audioOutput.samples, numSamples);
 			break;
 	}
 	
@@ -31,13 +31,15 @@ OTHER DEALINGS IN THE SOFTWARE.
 #include <cmath>
 
 #include "audioResource.h"
+#include "graph.h"
+#include "Parse.h"
 #include "StringEx.h"
 #include "tinyxml2.h"
 #include "tinyxml2_helpers.h"
 
 struct AudioResource_Wavefield2D : AudioResourceBase
 {
-	float f[Wavefield2D::kMaxElems][Wavefield2D::kMaxElems];
+	float f[Wavefield2Df::kMaxElems][Wavefield2Df::kMaxElems];
 	int numElems;
 	
 	AudioResource_Wavefield2D()
@@ -62,7 +64,7 @@ struct AudioResource_Wavefield2D : AudioResourceBase
 	virtual void load(tinyxml2::XMLElement * elem) override
 	{
 		numElems = intAttrib(elem, "numElems", 0);
-		numElems = clamp(numElems, 0, Wavefield2D::kMaxElems);
+		numElems = clamp(numElems, 0, Wavefield2Df::kMaxElems);
 		
 		for (int i = 0; i < numElems; ++i)
 		{
@@ -91,7 +93,7 @@ struct ResourceEditor_Wavefield2D : GraphEdit_ResourceEditorBase
 	
 	UiState uiState;
 	
-	Wavefield2D wavefield;
+	Wavefield2Df wavefield;
 	
 	AudioRNG rng;
 	
@@ -227,7 +229,7 @@ struct ResourceEditor_Wavefield2D : GraphEdit_ResourceEditorBase
 				doTextBox(numElems, "size", x, sx, false, dt);
 				x += sx;
 				
-				numElems = Wavefield2D::roundNumElems(numElems);
+				numElems = Wavefield2Df::roundNumElems(numElems);
 				
 				if (numElems != resource->numElems)
 				{
@@ -345,6 +347,7 @@ AUDIO_NODE_TYPE(AudioNodeWavefield2D)
 	in("trigger.amount", "audioValue", "0.5");
 	in("trigger.size", "audioValue", "1");
 	in("randomize!", "trigger");
+	in("threads", "int", "1");
 	out("audio", "audioValue");
 	
 	mainResourceType = "wavefield.2d";
@@ -361,6 +364,7 @@ AudioNodeWavefield2D::AudioNodeWavefield2D()
 	, wavefieldData(nullptr)
 	, currentDataVersion(-1)
 	, wavefield(nullptr)
+	, simulator(nullptr)
 	, rng()
 	, audioOutput()
 {
@@ -379,13 +383,18 @@ AudioNodeWavefield2D::AudioNodeWavefield2D()
 	addInput(kInput_TriggerAmount, kAudioPlugType_FloatVec);
 	addInput(kInput_TriggerSize, kAudioPlugType_FloatVec);
 	addInput(kInput_Randomize, kAudioPlugType_Trigger);
+	addInput(kInput_NumThreads, kAudioPlugType_Int);
 	addOutput(kOutput_Audio, kAudioPlugType_FloatVec, &audioOutput);
 
-	wavefield = new Wavefield2D();
+	wavefield = new Wavefield2Df();
+	simulator = new Wavefield2DfSimulator();
 }
 
 AudioNodeWavefield2D::~AudioNodeWavefield2D()
 {
+	delete simulator;
+	simulator = nullptr;
+	
 	delete wavefield;
 	wavefield = nullptr;
 	
@@ -441,12 +450,23 @@ void AudioNodeWavefield2D::initSelf(const GraphNode & node)
 	createAudioNodeResource(node, "wavefield.2d", "editorData", wavefieldData);
 	
 	syncWavefieldResource();
+	
+	// note : the simulator creates its worker threads here, and when the number of threads is edited, rather than
+	//        when ticking, to keep thread creation off the audio thread. linking the threads input has no effect
+	
+	auto threadsItr = node.inputValues.find("threads");
+	
+	const int numThreads = threadsItr == node.inputValues.end() ? 1 : Parse::Int32(threadsItr->second.c_str());
+	
+	simulator->init(Wavefield::clamp(numThreads, 1, 16));
 }
 
 void AudioNodeWavefield2D::tick(const float in_dt)
 {
 	audioCpuTimingBlock(AudioNodeWavefield2D);
 	
+	const int numSamples = getCurrentAudioUpdateSize();
+	
 	const AudioFloat defaultTension(1.f);
 	
 	const AudioFloat * gain = getInputAudioFloat(kInput_Gain, &AudioFloat::One);
@@ -491,18 +511,25 @@ void AudioNodeWavefield2D::tick(const float in_dt)
 	
 	const bool closedEnds = (wrap == false);
 	
-	for (int i = 0; i < AUDIO_UPDATE_SIZE; ++i)
+	ALIGN16 float c[AUDIO_MAX_UPDATE_SIZE];
+	ALIGN16 float vRetainPerSecond[AUDIO_MAX_UPDATE_SIZE];
+	ALIGN16 float pRetainPerSecond[AUDIO_MAX_UPDATE_SIZE];
+	ALIGN16 float sampleX[AUDIO_MAX_UPDATE_SIZE];
+	ALIGN16 float sampleY[AUDIO_MAX_UPDATE_SIZE];
+	
+	for (int i = 0; i < numSamples; ++i)
 	{
-		const double c = Wavefield::clamp<double>(tension->samples[i] * 1000000.0, -maxTension, +maxTension);
+		c[i] = Wavefield::clamp<double>(tension->samples[i] * 1000000.0, -maxTension, +maxTension);
 		
-		wavefield->tick(dtPerSample, c, 1.0 - velocityDampening->samples[i], 1.0 - positionDampening->samples[i], closedEnds);
+		vRetainPerSecond[i] = 1.f - velocityDampening->samples[i];
+		pRetainPerSecond[i] = 1.f - positionDampening->samples[i];
 		
-		audioOutput.samples[i] = wavefield->sample(
-			sampleLocationX->samples[i] * wavefield->numElems,
-			sampleLocationY->samples[i] * wavefield->numElems,
-			closedEnds);
+		sampleX[i] = sampleLocationX->samples[i] * wavefield->numElems;
+		sampleY[i] = sampleLocationY->samples[i] * wavefield->numElems;
 	}
 	
+	simulator->tick(*wavefield, numSamples, dtPerSample, c, vRetainPerSecond, pRetainPerSecond, closedEnds, sampleX, sampleY, audioOutput.samples);
+	
 	// soft clip wavefield position. abrupt tension changes could boost velocity too much, causing huge values for position
 	
 	switch (softClip)
@@ -511,11 +538,11 @@ void AudioNodeWavefield2D::tick(const float in_dt)
 			break;
 			
 		case kSoftClip_SigmoidFast:
-			audioBufferClip_SigmoidFast(audioOutput.samples, AUDIO_UPDATE_SIZE);
+			audioBufferClip_SigmoidFast(audioOutput.samples, numSamples);
 			break;
 		
 		case kSoftClip_SigmoidSqrt:
-			audioBufferClip_SigmoidSqrt(audioOutput.samples, AUDIO_UPDATE_SIZE);
+			audioBufferClip_SigmoidSqrt(audioOutput.samples, numSamples);
 			break;
 	}
 	
@@ -548,3 +575,16 @@ void AudioNodeWavefield2D::handleTrigger(const int inputSocketIndex)
 	}
 }
 
+void AudioNodeWavefield2D::handleInputValueChanged(const int inputSocketIndex)
+{
+	if (inputSocketIndex == kInput_NumThreads)
+	{
+		const int numThreads = Wavefield::clamp(getInputInt(kInput_NumThreads, 1), 1, 16);
+		
+		if (numThreads != simulator->getNumThreads())
+		{
+			simulator->init(numThreads);
+		}
+	}
+}
+
@@ -31,7 +31,8 @@
 #include "audioTypes.h"
 
 struct AudioResource_Wavefield2D;
-struct Wavefield2D;
+struct Wavefield2Df;
+struct Wavefield2DfSimulator;
 
 struct AudioNodeWavefield2D : AudioNodeBase
 {
@@ -58,6 +59,7 @@ struct AudioNodeWavefield2D : AudioNodeBase
 		kInput_TriggerAmount,
 		kInput_TriggerSize,
 		kInput_Randomize,
+		kInput_NumThreads,
 		kInput_COUNT
 	};
 	
@@ -70,7 +72,8 @@ struct AudioNodeWavefield2D : AudioNodeBase
 	AudioResource_Wavefield2D * wavefieldData;
 	int currentDataVersion;
 	
-	Wavefield2D * wavefield;
+	Wavefield2Df * wavefield;
+	Wavefield2DfSimulator * simulator;
 	
 	AudioRNG rng;
 
@@ -87,4 +90,5 @@ struct AudioNodeWavefield2D : AudioNodeBase
 	virtual void tick(const float dt) override;
 	
 	virtual void handleTrigger(const int inputSocketIndex) override;
+	virtual void handleInputValueChanged(const int inputSocketIndex) override;
 };
@@ -104,7 +104,7 @@ AUDIO_NODE_TYPE(AudioNodeVoice4D)
 
 void AudioNodeVoice4D::AudioSourceVoiceNode::generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples)
 {
-	Assert(numSamples == AUDIO_UPDATE_SIZE);
+	Assert(numSamples <= AUDIO_MAX_UPDATE_SIZE);
 	
 	if (voiceNode->isPassthrough)
 	{
@@ -116,9 +116,20 @@ void AudioNodeVoice4D::AudioSourceVoiceNode::generate(SAMPLE_ALIGN16 float * __r
 		{
 			const AudioFloat * audio = voiceNode->getInputAudioFloat(kInput_Audio, &AudioFloat::Zero);
 			
-			audio->expand();
+			// note : we're called by the voice manager, outside of the graph's tick. so rather than
+			//        expanding the value, which depends on the current update size, we copy it here
 			
-			memcpy(samples, audio->samples, numSamples * sizeof(float));
+			if (audio->isScalar)
+			{
+				const float value = audio->getScalar();
+				
+				for (int i = 0; i < numSamples; ++i)
+					samples[i] = value;
+			}
+			else
+			{
+				memcpy(samples, audio->samples, numSamples * sizeof(float));
+			}
 		}
 		clearCurrentAudioGraphTraversalId();
 	}
@@ -128,6 +139,10 @@ AudioNodeVoice4D::AudioNodeVoice4D()
 	: AudioNodeBase()
 	, source()
 	, voice(nullptr)
+	, rampUpFlagId(-1)
+	, rampDownFlagId(-1)
+	, rampedUpFlagId(-1)
+	, rampedDownFlagId(-1)
 {
 	resizeSockets(kInput_COUNT, kOutput_COUNT);
 	addInput(kInput_Audio, kAudioPlugType_FloatVec);
@@ -177,6 +192,14 @@ AudioNodeVoice4D::AudioNodeVoice4D()
 	source.voiceNode = this;
 }
 
+void AudioNodeVoice4D::init(const GraphNode & node)
+{
+	rampUpFlagId = g_currentAudioGraph->getFlagId("voice.4d.rampUp");
+	rampDownFlagId = g_currentAudioGraph->getFlagId("voice.4d.rampDown");
+	rampedUpFlagId = g_currentAudioGraph->getFlagId("voice.4d.rampedUp");
+	rampedDownFlagId = g_currentAudioGraph->getFlagId("voice.4d.rampedDown");
+}
+
 void AudioNodeVoice4D::shut()
 {
 	if (voice != nullptr)
@@ -317,11 +340,11 @@ void AudioNodeVoice4D::tick(const float dt)
 	
 	// update ramping
 	
-	if (g_currentAudioGraph->isFlagSet("voice.4d.rampUp"))
+	if (g_currentAudioGraph->isFlagSet(rampUpFlagId))
 	{
 		voice->rampInfo.ramp = true;
 	}
-	else if (g_currentAudioGraph->isFlagSet("voice.4d.rampDown"))
+	else if (g_currentAudioGraph->isFlagSet(rampDownFlagId))
 	{
 		voice->rampInfo.ramp = false;
 	}
@@ -332,13 +355,13 @@ void AudioNodeVoice4D::tick(const float dt)
 		{
 			trigger(kOutput_RampedUp);
 			
-			g_currentAudioGraph->setFlag("voice.4d.rampedUp");
+			g_currentAudioGraph->setFlag(rampedUpFlagId);
 		}
 		else
 		{
 			trigger(kOutput_RampedDown);
 			
-			g_currentAudioGraph->setFlag("voice.4d.rampedDown");
+			g_currentAudioGraph->setFlag(rampedDownFlagId);
 		}
 	}
 	
@@ -408,7 +431,7 @@ AUDIO_NODE_TYPE(AudioNodeVoice4DReturn)
 
 void AudioNodeVoice4DReturn::AudioSourceReturnNode::generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples)
 {
-	Assert(numSamples == AUDIO_UPDATE_SIZE);
+	Assert(numSamples <= AUDIO_MAX_UPDATE_SIZE);
 	
 	if (returnNode->isPassthrough)
 	{
@@ -420,9 +443,20 @@ void AudioNodeVoice4DReturn::AudioSourceReturnNode::generate(SAMPLE_ALIGN16 floa
 		{
 			const AudioFloat * audio = returnNode->getInputAudioFloat(kInput_Audio, &AudioFloat::Zero);
 			
-			audio->expand();
+			// note : we're called by the voice manager, outside of the graph's tick. so rather than
+			//        expanding the value, which depends on the current update size, we copy it here
 			
-			memcpy(samples, audio->samples, numSamples * sizeof(float));
+			if (audio->isScalar)
+			{
+				const float value = audio->getScalar();
+				
+				for (int i = 0; i < numSamples; ++i)
+					samples[i] = value;
+			}
+			else
+			{
+				memcpy(samples, audio->samples, numSamples * sizeof(float));
+			}
 		}
 		clearCurrentAudioGraphTraversalId();
 	}
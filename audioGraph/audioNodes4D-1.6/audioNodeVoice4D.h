@@ -96,7 +96,13 @@ struct AudioNodeVoice4D : AudioNodeBase
 	AudioSourceVoiceNode source;
 	AudioVoice * voice;
 	
+	int rampUpFlagId;
+	int rampDownFlagId;
+	int rampedUpFlagId;
+	int rampedDownFlagId;
+	
 	AudioNodeVoice4D();
+	virtual void init(const GraphNode & node) override;
 	virtual void shut() override;
 	
 	virtual void tick(const float dt) override;
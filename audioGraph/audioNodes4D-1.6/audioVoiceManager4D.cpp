@@ -102,6 +102,14 @@ bool AudioVoiceManager4D::allocVoice(AudioVoice *& out_voice, AudioSource * sour
 		
 		out_voice = voice;
 		
+		// size the mixer for the new number of voices here, so the audio thread doesn't allocate while mixing
+		
+		int numVoices = 0;
+		for (auto * voiceItr = firstVoice; voiceItr != nullptr; voiceItr = voiceItr->next)
+			numVoices++;
+		
+		mixer.reserve(numVoices);
+		
 		voice->source = source;
 		
 		const float hue = colorIndex / 16.f;
@@ -255,171 +263,60 @@ void AudioVoiceManager4D::generateAudio(
 	const OutputMode outputMode,
 	const bool interleaved)
 {
-	// initialize samples to zero before we start mixing
-	
-	if (outputMode == kOutputMode_Mono)
+	audioMutex->lock();
 	{
-		memset(samples, 0, numSamples * 1 * sizeof(float));
+		int numVoices = 0;
+		for (auto * voice = firstVoice; voice != nullptr; voice = voice->next)
+			numVoices++;
+		
+		AudioVoice ** voiceArray = (AudioVoice**)alloca(numVoices * sizeof(AudioVoice*));
+		
+		int voiceIndex = 0;
+		for (auto * voice = firstVoice; voice != nullptr; voice = voice->next)
+			voiceArray[voiceIndex++] = voice;
+		
+		mixer.mix(
+			voiceArray, numVoices,
+			samples, numSamples, numChannels,
+			doLimiting, limiterPeak,
+			updateRamping,
+			spat.globalGain,
+			outputMode, interleaved);
 	}
-	else if (outputMode == kOutputMode_Stereo)
+	audioMutex->unlock();
+}
+
+void AudioVoiceManager4D::enableParallelMixing(const int numThreads)
+{
+	// note : the audio thread may be mixing at this moment, so we hold the audio mutex while the mixer (re)creates its worker threads
+	
+	audioMutex->lock();
 	{
-		memset(samples, 0, numSamples * 2 * sizeof(float));
+		mixer.enableParallelMixing(numThreads);
 	}
-	else
+	audioMutex->unlock();
+}
+
+void AudioVoiceManager4D::disableParallelMixing()
+{
+	audioMutex->lock();
 	{
-		Assert(outputMode == kOutputMode_MultiChannel);
-		
-		memset(samples, 0, numSamples * numChannels * sizeof(float));
+		mixer.disableParallelMixing();
 	}
+	audioMutex->unlock();
+}
+
+AudioVoiceMixer::Stats AudioVoiceManager4D::getMixerStats() const
+{
+	AudioVoiceMixer::Stats result;
 	
 	audioMutex->lock();
 	{
-		float * voiceSamples = (float*)alloca(numSamples * sizeof(float));
-		
-		for (auto * voice_itr = firstVoice; voice_itr != nullptr; voice_itr = voice_itr->next)
-		{
-			AudioVoice4D & voice = static_cast<AudioVoice4D&>(*voice_itr);
-			
-			// note : we need to call applyRamping or else ramping flags may not be updated appropriately
-			//        as an optimize we could skip some processing here, but for now it seems unnecessary
-			
-			//if (voice.channelIndex != -1)
-			{
-				// generate samples
-				
-				voice.source->generate(voiceSamples, numSamples);
-				
-				// apply gain
-				
-				const float gain = voice.gain * spat.globalGain;
-				
-				audioBufferMul(voiceSamples, numSamples, gain);
-				
-				// apply limiting
-				
-				if (doLimiting)
-				{
-					voice.applyLimiter(voiceSamples, numSamples, limiterPeak);
-				}
-				
-				// apply volume ramping
-				
-				voice.applyRamping(voiceSamples, numSamples, SAMPLE_RATE * voice.rampInfo.rampTime, updateRamping);
-				
-				if (voice.channelIndex != -1)
-				{
-					if (outputMode == kOutputMode_Mono)
-					{
-						audioBufferAdd(samples, voiceSamples, numSamples);
-					}
-					else if (outputMode == kOutputMode_Stereo)
-					{
-						if (voice.speaker == AudioVoice::kSpeaker_Left)
-						{
-							if (interleaved)
-							{
-								// interleave voice samples into destination buffer
-								
-								float * __restrict dstPtr = samples;
-								
-								for (int i = 0; i < numSamples; ++i)
-								{
-									dstPtr[i * 2 + 0] += voiceSamples[i];
-								}
-							}
-							else
-							{
-								audioBufferAdd(&samples[numSamples * 0], voiceSamples, numSamples);
-							}
-						}
-						else if (voice.speaker == AudioVoice::kSpeaker_Right)
-						{
-							if (interleaved)
-							{
-								// interleave voice samples into destination buffer
-								
-								float * __restrict dstPtr = samples;
-								
-								for (int i = 0; i < numSamples; ++i)
-								{
-									dstPtr[i * 2 + 1] += voiceSamples[i];
-								}
-							}
-							else
-							{
-								audioBufferAdd(&samples[numSamples * 1], voiceSamples, numSamples);
-							}
-						}
-						else if (voice.speaker == AudioVoice::kSpeaker_Channel)
-						{
-							if (voice.channelIndex >= 0 && voice.channelIndex < 2)
-							{
-								if (interleaved)
-								{
-									// interleave voice samples into destination buffer
-									
-									float * __restrict dstPtr = samples;
-									
-									for (int i = 0; i < numSamples; ++i)
-									{
-										dstPtr[i * 2 + voice.channelIndex] += voiceSamples[i];
-									}
-								}
-								else
-								{
-									audioBufferAdd(&samples[numSamples * voice.channelIndex], voiceSamples, numSamples);
-								}
-							}
-						}
-						else
-						{
-							if (interleaved)
-							{
-								// interleave voice samples into destination buffer
-								
-								float * __restrict dstPtr = samples;
-								
-								for (int i = 0; i < numSamples; ++i)
-								{
-									dstPtr[i * 2 + 0] += voiceSamples[i];
-									dstPtr[i * 2 + 1] += voiceSamples[i];
-								}
-							}
-							else
-							{
-								audioBufferAdd(&samples[numSamples * 0], voiceSamples, numSamples);
-								audioBufferAdd(&samples[numSamples * 1], voiceSamples, numSamples);
-							}
-						}
-					}
-					else
-					{
-						if (voice.channelIndex >= 0 && voice.channelIndex < numChannels)
-						{
-							if (interleaved)
-							{
-								// interleave voice samples into destination buffer
-								
-								float * __restrict dstPtr = samples + voice.channelIndex;
-								
-								for (int i = 0; i < numSamples; ++i)
-								{
-									*dstPtr = voiceSamples[i];
-									
-									dstPtr += numChannels;
-								}
-							}
-							else
-							{
-								audioBufferAdd(&samples[numSamples * voice.channelIndex], voiceSamples, numSamples);
-							}
-						}
-					}
-				}
-			}
-		}
+		result = mixer.getStats();
 	}
 	audioMutex->unlock();
+	
+	return result;
 }
 
 static void generateOscForVoice(AudioVoice4D & voice, Osc4DStream & stream, const bool forceSync)
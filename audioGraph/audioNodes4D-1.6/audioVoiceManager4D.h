@@ -285,6 +285,8 @@ private:
 	int numDynamicChannels;
 	
 	Osc4DStream * oscStream;
+	
+	AudioVoiceMixer mixer; ///< The mixer used by generateAudio.
 
 public:
 	bool outputStereo;
@@ -337,6 +339,11 @@ public:
 		const OutputMode outputMode,
 		const bool interleaved);
 	
+	void enableParallelMixing(const int numThreads); ///< Mixes the output channels using 'numThreads' worker threads plus the audio thread. Useful for large numbers of voices and channels.
+	void disableParallelMixing();
+	
+	AudioVoiceMixer::Stats getMixerStats() const; ///< Returns mixing statistics for the last call to generateAudio.
+	
 	/**
 	 * Generates OSC messages for voices and global parameters that changed, or for all parameters when forceSync is set to true.
 	 * @param stream The stream to which to output OSC messages.
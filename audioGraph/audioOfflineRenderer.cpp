@@ -0,0 +1,160 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "audioOfflineRenderer.h"
+#include "audioTypes.h"
+#include "audioUpdateHandler.h"
+#include "Debugging.h"
+#include "Log.h"
+#include "soundfile/SoundIO.h"
+#include "Timer.h"
+#include <math.h>
+
+AudioOfflineRenderer::AudioOfflineRenderer()
+	: audioUpdateHandler(nullptr)
+	, numChannels(0)
+	, updateSize(0)
+	, outputBuffer(nullptr)
+	, numFramesRendered(0)
+	, renderTimeUs(0)
+{
+}
+
+AudioOfflineRenderer::~AudioOfflineRenderer()
+{
+	shut();
+}
+
+void AudioOfflineRenderer::init(AudioUpdateHandler * in_audioUpdateHandler, const int in_numChannels, const int in_updateSize)
+{
+	Assert(in_audioUpdateHandler != nullptr);
+	Assert(in_numChannels > 0);
+	Assert(in_updateSize > 0 && in_updateSize <= AUDIO_MAX_UPDATE_SIZE);
+	
+	//
+	
+	shut();
+	
+	//
+	
+	audioUpdateHandler = in_audioUpdateHandler;
+	
+	numChannels = in_numChannels;
+	updateSize = in_updateSize;
+	
+	outputBuffer = new float[numChannels * updateSize];
+}
+
+void AudioOfflineRenderer::shut()
+{
+	delete [] outputBuffer;
+	outputBuffer = nullptr;
+	
+	audioUpdateHandler = nullptr;
+	
+	numChannels = 0;
+	updateSize = 0;
+	
+	numFramesRendered = 0;
+	renderTimeUs = 0;
+}
+
+bool AudioOfflineRenderer::render(const double duration, SoundWriter * writer)
+{
+	Assert(audioUpdateHandler != nullptr);
+	if (audioUpdateHandler == nullptr)
+		return false;
+	
+	const int64_t numTicks = (int64_t)ceil(duration * SAMPLE_RATE / updateSize);
+	
+	bool result = true;
+	
+	for (int64_t i = 0; i < numTicks; ++i)
+	{
+		// note : we only measure the time spent rendering. writing the output isn't part of the realtime factor
+		
+		const int64_t t1 = g_TimerRT.TimeUS_get();
+		
+		audioUpdateHandler->portAudioCallback(nullptr, 0, outputBuffer, numChannels, updateSize);
+		
+		const int64_t t2 = g_TimerRT.TimeUS_get();
+		
+		renderTimeUs += t2 - t1;
+		
+		numFramesRendered += updateSize;
+		
+		if (writer != nullptr && writer->write(outputBuffer, updateSize) == false)
+		{
+			LOG_ERR("failed to write rendered audio");
+			result = false;
+			break;
+		}
+	}
+	
+	return result;
+}
+
+bool AudioOfflineRenderer::renderToFile(const char * filename, const double duration)
+{
+	SoundWriter * writer = createSoundWriter(filename);
+	
+	if (writer == nullptr)
+	{
+		LOG_ERR("unable to create a sound writer for %s. unsupported file type", filename);
+		return false;
+	}
+	
+	bool result = true;
+	
+	if (writer->open(filename, numChannels, SAMPLE_RATE) == false)
+	{
+		result = false;
+	}
+	else
+	{
+		result &= render(duration, writer);
+		result &= writer->close();
+	}
+	
+	delete writer;
+	writer = nullptr;
+	
+	return result;
+}
+
+double AudioOfflineRenderer::getRenderedDuration() const
+{
+	return numFramesRendered / double(SAMPLE_RATE);
+}
+
+double AudioOfflineRenderer::getRealtimeFactor() const
+{
+	if (renderTimeUs == 0)
+		return 0.0;
+	else
+		return getRenderedDuration() / (renderTimeUs / 1000000.0);
+}
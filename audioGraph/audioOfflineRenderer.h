@@ -0,0 +1,78 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+//
+
+class SoundWriter;
+
+struct AudioUpdateHandler;
+
+//
+
+/*
+AudioOfflineRenderer renders audio without the need for an audio device. It drives an audio update
+handler the same way the audio device would, except it runs as fast as possible, rather than at
+the pace of the audio device. The mixed output of the voice manager is streamed to a sound writer
+one tick at a time, so the amount of memory used doesn't depend on the length of the render.
+
+Offline rendering is useful for rendering audio graphs to file for regression testing and content
+baking, and for benchmarking audio graphs on machines without an audio device. For benchmarking,
+render without a sound writer and use the realtime factor, which is the number of seconds of
+audio rendered per second.
+
+The update size must match the update size of the audio graph context(s) ticked by the audio graph
+manager. To tick audio graph instances multi-threaded, enable parallel ticking on the audio graph
+manager before rendering.
+*/
+struct AudioOfflineRenderer
+{
+	AudioUpdateHandler * audioUpdateHandler;
+	
+	int numChannels;
+	int updateSize;
+	
+	float * outputBuffer; // a single tick worth of interleaved samples
+	
+	int64_t numFramesRendered;
+	int64_t renderTimeUs;
+	
+	AudioOfflineRenderer();
+	~AudioOfflineRenderer();
+	
+	void init(AudioUpdateHandler * audioUpdateHandler, const int numChannels, const int updateSize);
+	void shut();
+	
+	bool render(const double duration, SoundWriter * writer); // renders 'duration' seconds of audio. when writer is set, the output is written to it
+	bool renderToFile(const char * filename, const double duration); // renders 'duration' seconds of audio to a WAVE or OGG file, depending on the extension
+	
+	double getRenderedDuration() const; // returns the number of seconds of audio rendered so far
+	double getRealtimeFactor() const; // returns the number of seconds of audio rendered per second
+};
@@ -25,9 +25,12 @@
 	OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include "audioKernels.h"
 #include "audioVoiceManager.h"
+#include "audioWorkerPool.h"
 #include "Debugging.h"
 #include "soundmix.h" // audio buffer routines
+#include <algorithm>
 #include <string.h>
 
 static void applyRamping(AudioVoice::RampInfo & rampInfo, float * __restrict samples, const int numSamples, const int durationInSamples)
@@ -130,7 +133,7 @@ void AudioVoice::applyLimiter(float * __restrict samples, const int numSamples,
 {
 	const float decayPerMs = .01f;
 	const float dtMs = 1000.f / SAMPLE_RATE;
-	const float retainPerSample = powf(1.f - decayPerMs, dtMs);
+	static const float retainPerSample = powf(1.f - decayPerMs, dtMs);
 	
 	limiter.applyInPlace(samples, numSamples, retainPerSample, maxGain);
 }
@@ -143,6 +146,7 @@ AudioVoiceManager::AudioVoiceManager(const Type _type)
 }
 
 void AudioVoiceManager::generateAudio(
+	AudioVoiceMixer & mixer,
 	AudioVoice ** voices,
 	const int numVoices,
 	float * __restrict samples, const int numSamples, const int numChannels,
@@ -153,167 +157,383 @@ void AudioVoiceManager::generateAudio(
 	const OutputMode outputMode,
 	const bool interleaved)
 {
-	// initialize samples to zero before we start mixing
+	mixer.mix(
+		voices, numVoices,
+		samples, numSamples, numChannels,
+		doLimiting, limiterPeak,
+		updateRamping,
+		globalGain,
+		outputMode, interleaved);
+}
+
+void AudioVoiceManager::generateAudio(
+	AudioVoice ** voices,
+	const int numVoices,
+	float * __restrict samples, const int numSamples, const int numChannels,
+	const bool doLimiting,
+	const float limiterPeak,
+	const bool updateRamping,
+	const float globalGain,
+	const OutputMode outputMode,
+	const bool interleaved)
+{
+	// note : the mixer is thread local, as callers may mix from multiple threads at the same time
 	
-	if (outputMode == kOutputMode_Mono)
-	{
-		memset(samples, 0, numSamples * 1 * sizeof(float));
-	}
-	else if (outputMode == kOutputMode_Stereo)
-	{
-		memset(samples, 0, numSamples * 2 * sizeof(float));
-	}
-	else
+	static thread_local AudioVoiceMixer mixer;
+	
+	mixer.mix(
+		voices, numVoices,
+		samples, numSamples, numChannels,
+		doLimiting, limiterPeak,
+		updateRamping,
+		globalGain,
+		outputMode, interleaved);
+}
+
+//
+
+AudioVoiceMixer::AudioVoiceMixer()
+	: workerPool(nullptr)
+	, taskGraph(nullptr)
+	, numReservedVoices(0)
+	, mixChannelSamples(nullptr)
+	, mixNumSamples(0)
+{
+}
+
+AudioVoiceMixer::~AudioVoiceMixer()
+{
+	disableParallelMixing();
+}
+
+void AudioVoiceMixer::enableParallelMixing(const int numThreads)
+{
+	disableParallelMixing();
+	
+	workerPool = new AudioWorkerPool();
+	workerPool->init(numThreads);
+	
+	// note : the output channels are partitioned over at most one task per worker
+	
+	workerPool->reserve(workerPool->getNumWorkers());
+	
+	taskGraph = new AudioTaskGraph();
+}
+
+void AudioVoiceMixer::disableParallelMixing()
+{
+	if (workerPool != nullptr)
 	{
-		Assert(outputMode == kOutputMode_MultiChannel);
+		workerPool->shut();
 		
-		memset(samples, 0, numSamples * numChannels * sizeof(float));
+		delete workerPool;
+		workerPool = nullptr;
 	}
 	
-	float * __restrict voiceSamples = (float*)alloca(numSamples * sizeof(float));
+	delete taskGraph;
+	taskGraph = nullptr;
+	
+	channelPartitions.clear();
+}
+
+void AudioVoiceMixer::reserve(const int numVoices)
+{
+	if (numVoices <= numReservedVoices)
+		return;
+	
+	// note : we grow geometrically, so allocating voices one at a time doesn't resize the buffers each time
+	
+	numReservedVoices = std::max(numVoices, numReservedVoices * 2);
+	
+	voiceSamples.resize(size_t(numReservedVoices) * AUDIO_MAX_UPDATE_SIZE);
+	voiceChannels.resize(size_t(numReservedVoices) * 2);
+	voiceGains.resize(numReservedVoices);
+	channelSources.reserve(size_t(numReservedVoices) * 2);
+}
+
+void AudioVoiceMixer::mix(
+	AudioVoice ** voices,
+	const int numVoices,
+	float * __restrict samples, const int numSamples, const int numChannels,
+	const bool doLimiting,
+	const float limiterPeak,
+	const bool updateRamping,
+	const float globalGain,
+	const AudioVoiceManager::OutputMode outputMode,
+	const bool interleaved)
+{
+	const int numOutputChannels =
+		outputMode == AudioVoiceManager::kOutputMode_Mono ? 1 :
+		outputMode == AudioVoiceManager::kOutputMode_Stereo ? 2 :
+		numChannels;
+	
+	Assert(outputMode == AudioVoiceManager::kOutputMode_Mono || outputMode == AudioVoiceManager::kOutputMode_Stereo || outputMode == AudioVoiceManager::kOutputMode_MultiChannel);
+	
+	// note : these buffers are normally sized by reserve, when voices are allocated. we grow them here for
+	//        callers which don't reserve up front
+	
+	if (voiceSamples.size() < size_t(numVoices) * numSamples)
+		voiceSamples.resize(size_t(numVoices) * numSamples);
+	if (voiceChannels.size() < size_t(numVoices) * 2)
+		voiceChannels.resize(size_t(numVoices) * 2);
+	if (voiceGains.size() < size_t(numVoices))
+		voiceGains.resize(numVoices);
+	
+	stats = Stats();
+	stats.numVoices = numVoices;
+	
+	const AudioKernels & kernels = getAudioKernels();
+	
+	// process voices. voices which aren't culled are packed at the start of the voice samples array
+	
+	int numMixedVoices = 0;
 	
 	for (int i = 0; i < numVoices; ++i)
 	{
 		auto & voice = *voices[i];
 		
-		// note : we need to call applyRamping or else ramping flags may not be updated appropriately
-		//        as an optimize we could skip some processing here, but for now it seems unnecessary
+		float * __restrict voiceSamplesPtr = voiceSamples.data() + size_t(numMixedVoices) * numSamples;
+		
+		// generate samples. note we always ask the source to generate samples, since sources may be stateful
+		
+		voice.source->generate(voiceSamplesPtr, numSamples);
+		
+		// cull voices which are ramped down to zero. applyRamping would set their samples to zero
 		
-		//if (voice.channelIndex != -1)
+		if (voice.rampInfo.ramp == false && voice.rampInfo.rampValue == 0.f)
 		{
-			// generate samples
+			if (updateRamping)
+				voice.rampInfo.hasRamped = false;
 			
-			voice.source->generate(voiceSamples, numSamples);
+			stats.numVoicesCulled++;
+			continue;
+		}
+		
+		// determine the output channels
+		
+		int channel1 = -1;
+		int channel2 = -1;
+		
+		if (voice.channelIndex != -1)
+		{
+			if (outputMode == AudioVoiceManager::kOutputMode_Mono)
+			{
+				channel1 = 0;
+			}
+			else if (outputMode == AudioVoiceManager::kOutputMode_Stereo)
+			{
+				if (voice.speaker == AudioVoice::kSpeaker_Left)
+					channel1 = 0;
+				else if (voice.speaker == AudioVoice::kSpeaker_Right)
+					channel1 = 1;
+				else if (voice.speaker == AudioVoice::kSpeaker_Channel)
+					channel1 = (voice.channelIndex >= 0 && voice.channelIndex < 2) ? voice.channelIndex : -1;
+				else
+				{
+					channel1 = 0;
+					channel2 = 1;
+				}
+			}
+			else
+			{
+				channel1 = (voice.channelIndex >= 0 && voice.channelIndex < numChannels) ? voice.channelIndex : -1;
+			}
+		}
+		
+		// apply gain and limiting. when the limiter is disabled, we fold the gain into the mixing gain instead,
+		// which is possible since ramping is linear. voices without an output channel only need ramping
+		
+		float mixGain = voice.gain * globalGain;
+		
+		if (channel1 != -1 && doLimiting)
+		{
+			if (mixGain != 1.f)
+				audioBufferMul(voiceSamplesPtr, numSamples, mixGain);
 			
-			// apply gain
+			voice.applyLimiter(voiceSamplesPtr, numSamples, limiterPeak);
 			
-			const float gain = voice.gain * globalGain;
+			mixGain = 1.f;
+		}
+		
+		// apply volume ramping
+		
+		voice.applyRamping(voiceSamplesPtr, numSamples, SAMPLE_RATE * voice.rampInfo.rampTime, updateRamping);
+		
+		// cull voices which don't contribute to the output
+		
+		if (channel1 == -1 || mixGain == 0.f || kernels.peak(voiceSamplesPtr, numSamples) == 0.f)
+		{
+			stats.numVoicesCulled++;
+			continue;
+		}
+		
+		voiceChannels[numMixedVoices * 2 + 0] = channel1;
+		voiceChannels[numMixedVoices * 2 + 1] = channel2;
+		voiceGains[numMixedVoices] = mixGain;
+		
+		numMixedVoices++;
+	}
+	
+	stats.numVoicesMixed = numMixedVoices;
+	
+	// build the sparse gain matrix, by sorting the mixed voices by output channel. we first store the
+	// end index for each channel, and then decrement while placing the voices in reverse order. this
+	// leaves us with the first index for each channel, and sources sorted by voice index
+	
+	channelFirstSource.assign(numOutputChannels + 1, 0);
+	
+	for (int i = 0; i < numMixedVoices * 2; ++i)
+		if (voiceChannels[i] != -1)
+			channelFirstSource[voiceChannels[i]]++;
+	
+	for (int i = 1; i <= numOutputChannels; ++i)
+		channelFirstSource[i] += channelFirstSource[i - 1];
+	
+	channelSources.resize(channelFirstSource[numOutputChannels]);
+	
+	for (int i = numMixedVoices * 2 - 1; i >= 0; --i)
+	{
+		const int channelIndex = voiceChannels[i];
+		
+		if (channelIndex != -1)
+		{
+			auto & source = channelSources[--channelFirstSource[channelIndex]];
 			
-			audioBufferMul(voiceSamples, numSamples, gain);
+			source.samples = voiceSamples.data() + size_t(i / 2) * numSamples;
+			source.gain = voiceGains[i / 2];
+		}
+	}
+	
+	// mix the output channels. we mix directly into the output when it's planar
+	
+	const bool planarOutput = (interleaved == false || numOutputChannels == 1);
+	
+	if (planarOutput)
+	{
+		mixChannelSamples = samples;
+	}
+	else
+	{
+		if (channelSamples.size() < size_t(numOutputChannels) * numSamples)
+			channelSamples.resize(size_t(numOutputChannels) * numSamples);
+		
+		mixChannelSamples = channelSamples.data();
+	}
+	
+	mixNumSamples = numSamples;
+	
+	if (workerPool != nullptr && numOutputChannels > 1 && numMixedVoices > 0)
+	{
+		// partition the output channels over the workers
+		
+		const int numPartitions = std::min(numOutputChannels, workerPool->getNumWorkers());
+		
+		if ((int)channelPartitions.size() != numPartitions || channelPartitions.back().firstChannel + channelPartitions.back().numChannels != numOutputChannels)
+		{
+			channelPartitions.resize(numPartitions);
 			
-			// apply limiting
+			taskGraph->clear();
 			
-			if (doLimiting)
+			for (int i = 0; i < numPartitions; ++i)
 			{
-				voice.applyLimiter(voiceSamples, numSamples, limiterPeak);
+				const int firstChannel = numOutputChannels * i / numPartitions;
+				const int lastChannel = numOutputChannels * (i + 1) / numPartitions;
+				
+				channelPartitions[i].firstChannel = firstChannel;
+				channelPartitions[i].numChannels = lastChannel - firstChannel;
+				
+				taskGraph->addTask(false);
 			}
 			
-			// apply volume ramping
-			
-			voice.applyRamping(voiceSamples, numSamples, SAMPLE_RATE * voice.rampInfo.rampTime, updateRamping);
+			taskGraph->finalize();
+		}
+		
+		workerPool->execute(*taskGraph, mixPartitionTask, this, numSamples);
+	}
+	else
+	{
+		for (int i = 0; i < numOutputChannels; ++i)
+			mixChannel(i);
+	}
+	
+	// interleave the output channels
+	
+	if (planarOutput == false)
+	{
+		float * __restrict dst = samples;
+		
+		if (numOutputChannels == 2)
+		{
+			const float * __restrict srcL = mixChannelSamples;
+			const float * __restrict srcR = mixChannelSamples + numSamples;
 			
-			if (voice.channelIndex != -1)
+			for (int i = 0; i < numSamples; ++i)
 			{
-				if (outputMode == kOutputMode_Mono)
-				{
-					audioBufferAdd(samples, voiceSamples, numSamples);
-				}
-				else if (outputMode == kOutputMode_Stereo)
-				{
-					if (voice.speaker == AudioVoice::kSpeaker_Left)
-					{
-						if (interleaved)
-						{
-							// interleave voice samples into destination buffer
-							
-							float * __restrict dstPtr = samples;
-							
-							for (int i = 0; i < numSamples; ++i)
-							{
-								dstPtr[i * 2 + 0] += voiceSamples[i];
-							}
-						}
-						else
-						{
-							audioBufferAdd(&samples[numSamples * 0], voiceSamples, numSamples);
-						}
-					}
-					else if (voice.speaker == AudioVoice::kSpeaker_Right)
-					{
-						if (interleaved)
-						{
-							// interleave voice samples into destination buffer
-							
-							float * __restrict dstPtr = samples;
-							
-							for (int i = 0; i < numSamples; ++i)
-							{
-								dstPtr[i * 2 + 1] += voiceSamples[i];
-							}
-						}
-						else
-						{
-							audioBufferAdd(&samples[numSamples * 1], voiceSamples, numSamples);
-						}
-					}
-					else if (voice.speaker == AudioVoice::kSpeaker_Channel)
-					{
-						if (voice.channelIndex >= 0 && voice.channelIndex < 2)
-						{
-							if (interleaved)
-							{
-								// interleave voice samples into destination buffer
-								
-								float * __restrict dstPtr = samples;
-								
-								for (int i = 0; i < numSamples; ++i)
-								{
-									dstPtr[i * 2 + voice.channelIndex] += voiceSamples[i];
-								}
-							}
-							else
-							{
-								audioBufferAdd(&samples[numSamples * voice.channelIndex], voiceSamples, numSamples);
-							}
-						}
-					}
-					else
-					{
-						if (interleaved)
-						{
-							// interleave voice samples into destination buffer
-							
-							float * __restrict dstPtr = samples;
-							
-							for (int i = 0; i < numSamples; ++i)
-							{
-								dstPtr[i * 2 + 0] += voiceSamples[i];
-								dstPtr[i * 2 + 1] += voiceSamples[i];
-							}
-						}
-						else
-						{
-							audioBufferAdd(&samples[numSamples * 0], voiceSamples, numSamples);
-							audioBufferAdd(&samples[numSamples * 1], voiceSamples, numSamples);
-						}
-					}
-				}
-				else
-				{
-					if (voice.channelIndex >= 0 && voice.channelIndex < numChannels)
-					{
-						if (interleaved && numChannels > 1)
-						{
-							// interleave voice samples into destination buffer
-							
-							float * __restrict dstPtr = samples + voice.channelIndex;
-							
-							for (int i = 0; i < numSamples; ++i)
-							{
-								*dstPtr += voiceSamples[i];
-								
-								dstPtr += numChannels;
-							}
-						}
-						else
-						{
-							audioBufferAdd(&samples[numSamples * voice.channelIndex], voiceSamples, numSamples);
-						}
-					}
-				}
+				dst[i * 2 + 0] = srcL[i];
+				dst[i * 2 + 1] = srcR[i];
+			}
+		}
+		else
+		{
+			for (int c = 0; c < numOutputChannels; ++c)
+			{
+				const float * __restrict src = mixChannelSamples + size_t(c) * numSamples;
+				
+				for (int i = 0; i < numSamples; ++i)
+					dst[i * numOutputChannels + c] = src[i];
 			}
 		}
 	}
+	
+	mixChannelSamples = nullptr;
+}
+
+void AudioVoiceMixer::mixChannel(const int channelIndex) const
+{
+	const AudioKernels & kernels = getAudioKernels();
+	
+	float * __restrict dst = mixChannelSamples + size_t(channelIndex) * mixNumSamples;
+	
+	kernels.setZero(dst, mixNumSamples);
+	
+	const ChannelSource * sources = channelSources.data() + channelFirstSource[channelIndex];
+	const int numSources = channelFirstSource[channelIndex + 1] - channelFirstSource[channelIndex];
+	
+	int i = 0;
+	
+	for (; i + 4 <= numSources; i += 4)
+	{
+		const float * src[4] =
+		{
+			sources[i + 0].samples,
+			sources[i + 1].samples,
+			sources[i + 2].samples,
+			sources[i + 3].samples
+		};
+		
+		const float scale[4] =
+		{
+			sources[i + 0].gain,
+			sources[i + 1].gain,
+			sources[i + 2].gain,
+			sources[i + 3].gain
+		};
+		
+		kernels.addMul4(dst, src, scale, mixNumSamples);
+	}
+	
+	for (; i < numSources; ++i)
+		kernels.addMul(dst, sources[i].samples, mixNumSamples, sources[i].gain);
+}
+
+void AudioVoiceMixer::mixPartitionTask(void * userData, const int taskIndex)
+{
+	const AudioVoiceMixer * self = (AudioVoiceMixer*)userData;
+	
+	const ChannelPartition & partition = self->channelPartitions[taskIndex];
+	
+	for (int i = 0; i < partition.numChannels; ++i)
+		self->mixChannel(partition.firstChannel + i);
 }
 
 //
@@ -362,6 +582,14 @@ bool AudioVoiceManagerBasic::allocVoice(AudioVoice *& out_voice, AudioSource * s
 		
 		out_voice = voice;
 		
+		// size the mixer for the new number of voices here, so the audio thread doesn't allocate while mixing
+		
+		int numVoices = 0;
+		for (auto * voiceItr = firstVoice; voiceItr != nullptr; voiceItr = voiceItr->next)
+			numVoices++;
+		
+		mixer.reserve(numVoices);
+		
 		voice->source = source;
 		
 		if (channelIndex < 0)
@@ -461,46 +689,48 @@ void AudioVoiceManagerBasic::generateAudio(float * __restrict samples, const int
 		for (auto * voice = firstVoice; voice != nullptr; voice = voice->next)
 			voiceArray[voiceIndex++] = voice;
 		
-		const bool interleaveOptimize = (outputMode == kOutputMode_Stereo && numVoices >= 8);
-		
-		if (interleaveOptimize)
-		{
-			// generate channel data to planar arrays
-			
-			ALIGN16 float planarSamples[AUDIO_UPDATE_SIZE * 2];
-			
-			AudioVoiceManager::generateAudio(
-				voiceArray, numVoices,
-				planarSamples, numSamples, numChannels,
-				true, limiterPeak,
-				true,
-				1.f,
-				outputMode, false);
-			
-			// interleave channels
-			
-			const float * __restrict srcL = planarSamples;
-			const float * __restrict srcR = planarSamples + numSamples;
-			      float * __restrict dst = samples;
-			
-			for (int i = 0; i < numSamples; ++i)
-			{
-				dst[i * 2 + 0] = srcL[i];
-				dst[i * 2 + 1] = srcR[i];
-			}
-		}
-		else
-		{
-			AudioVoiceManager::generateAudio(
-				voiceArray, numVoices,
-				samples, numSamples, numChannels,
-				true, limiterPeak,
-				true,
-				1.f,
-				outputMode, true);
-		}
+		mixer.mix(
+			voiceArray, numVoices,
+			samples, numSamples, numChannels,
+			true, limiterPeak,
+			true,
+			1.f,
+			outputMode, true);
+	}
+	audioMutex->unlock();
+}
+
+void AudioVoiceManagerBasic::enableParallelMixing(const int numThreads)
+{
+	// note : the audio thread may be mixing at this moment, so we hold the audio mutex while the mixer (re)creates its worker threads
+	
+	audioMutex->lock();
+	{
+		mixer.enableParallelMixing(numThreads);
+	}
+	audioMutex->unlock();
+}
+
+void AudioVoiceManagerBasic::disableParallelMixing()
+{
+	audioMutex->lock();
+	{
+		mixer.disableParallelMixing();
+	}
+	audioMutex->unlock();
+}
+
+AudioVoiceMixer::Stats AudioVoiceManagerBasic::getMixerStats() const
+{
+	AudioVoiceMixer::Stats result;
+	
+	audioMutex->lock();
+	{
+		result = mixer.getStats();
 	}
 	audioMutex->unlock();
+	
+	return result;
 }
 
 int AudioVoiceManagerBasic::calculateNumDynamicChannelsUsed() const
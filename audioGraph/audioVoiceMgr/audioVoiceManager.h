@@ -30,8 +30,12 @@
 #include "audioThreading.h"
 #include "audioTypes.h"
 #include "limiter.h"
+#include <vector>
 
 struct AudioSource;
+struct AudioTaskGraph;
+struct AudioVoiceMixer;
+struct AudioWorkerPool;
 
 // todo : see if it's possible to write documentation outside of the context of the code
 //        .. using Doxygen
@@ -225,6 +229,7 @@ struct AudioVoiceManager
 	 * generateAudio provides a shared mixer implementation, which is capable of mixing
 	 * voices down to a mono or stereo signal, or to a multi-channel output.
 	 * Note this method is NOT thread safe. You will have to lock the audio mutex (when applicable) yourself before calling this method.
+	 * @param mixer The mixer used to do the mixing. Callers should keep the mixer around between calls, so its buffers are allocated only once.
 	 * @param voices The voices to mix.
 	 * @param numVoices The size of the voices array.
 	 * @param samples The output samples.
@@ -237,6 +242,22 @@ struct AudioVoiceManager
 	 * @param outputMode The output mode (mono, stereo or multi-channel).
 	 * @param interleaved True when the stereo or multi-channel output should be written in an interleaved fashion. Interleaved means that the values for channel 0, 1, 2 etc will be packed next to each other inside the samples array. When false, the channels are output in a planar fashion. Which means first numSamples for channel 0 are output, followed by numSamples for channel 1, etc.
 	 */
+	static void generateAudio(
+		AudioVoiceMixer & mixer,
+		AudioVoice ** voices,
+		const int numVoices,
+		float * __restrict samples, const int numSamples, const int numChannels,
+		const bool doLimiting,
+		const float limiterPeak,
+		const bool updateRamping,
+		const float globalGain,
+		const OutputMode outputMode,
+		const bool interleaved);
+	
+	/**
+	 * Same as above, using a mixer owned by the calling thread. Kept for compatibility. Prefer the version taking a mixer,
+	 * so the mixer's buffers can be reserved up front (see AudioVoiceMixer::reserve).
+	 */
 	static void generateAudio(
 		AudioVoice ** voices,
 		const int numVoices,
@@ -285,6 +306,104 @@ struct AudioVoiceManager
 	virtual void generateAudio(float * __restrict samples, const int numSamples, const int numChannels) = 0;
 };
 
+/**
+ * AudioVoiceMixer mixes voices down to a mono or stereo signal, or to a multi-channel output. It is the mixer
+ * behind AudioVoiceManager::generateAudio. Mixing is done in two phases:
+ *
+ * 1. Voices are processed one by one. Each voice generates its samples, after which gain, limiting and ramping are applied.
+ *    Voices which are ramped down to zero skip these steps. The peak of each voice is measured, and silent voices are culled.
+ * 2. The remaining voices are accumulated into the output channels. The routing of voices to channels forms a sparse
+ *    gain matrix, which is stored as a list of (voice, gain) pairs per output channel. Each output channel accumulates
+ *    its voices four at a time, using vectorized kernels.
+ *
+ * When parallel mixing is enabled, the output channels are partitioned over worker threads during the second phase.
+ * The first phase always runs on the calling thread, as audio sources are not required to be thread safe.
+ *
+ * Voices which are ramped down to zero are culled without applying the limiter. Their limiter keeps its measured peak
+ * until the voice ramps up again, which is the conservative choice, as it can only attenuate the voice more.
+ *
+ * The per-voice buffers are sized by reserve, which voice managers call when voices are allocated, so mixing on the
+ * audio thread doesn't allocate. Buffers not reserved up front grow on demand. Their sizes stabilize after the first
+ * mix for a given number of voices and channels.
+ */
+struct AudioVoiceMixer
+{
+	struct Stats
+	{
+		int numVoices = 0;       ///< The number of voices passed to the last mix.
+		int numVoicesMixed = 0;  ///< The number of voices accumulated into the output during the last mix.
+		int numVoicesCulled = 0; ///< The number of voices culled during the last mix, because they were silent, ramped down to zero or didn't map to an output channel.
+	};
+	
+	struct ChannelSource
+	{
+		const float * samples;
+		float gain;
+	};
+	
+	struct ChannelPartition
+	{
+		int firstChannel;
+		int numChannels;
+	};
+	
+	AudioVoiceMixer();
+	~AudioVoiceMixer();
+	
+	/**
+	 * Enables mixing of the output channels using a pool of worker threads.
+	 * Note this method is NOT thread safe. It must not be called while mixing.
+	 * @param numThreads The number of worker threads to create. The thread calling mix participates in mixing as well.
+	 */
+	void enableParallelMixing(const int numThreads);
+	void disableParallelMixing(); ///< Stops the worker threads, if any. Note this method is NOT thread safe.
+	
+	/**
+	 * Allocates the per-voice buffers for mixing up to 'numVoices' voices of at most AUDIO_MAX_UPDATE_SIZE samples.
+	 * Note this method is NOT thread safe. It must not be called while mixing.
+	 */
+	void reserve(const int numVoices);
+	
+	/**
+	 * Mixes voices. See AudioVoiceManager::generateAudio for a description of the parameters.
+	 */
+	void mix(
+		AudioVoice ** voices,
+		const int numVoices,
+		float * __restrict samples, const int numSamples, const int numChannels,
+		const bool doLimiting,
+		const float limiterPeak,
+		const bool updateRamping,
+		const float globalGain,
+		const AudioVoiceManager::OutputMode outputMode,
+		const bool interleaved);
+	
+	const Stats & getStats() const { return stats; } ///< Returns statistics about the last mix.
+	
+private:
+	AudioWorkerPool * workerPool;
+	AudioTaskGraph * taskGraph; ///< A task graph with one task for each channel partition.
+	
+	std::vector<float> voiceSamples;                ///< Processed samples for each of the voices.
+	std::vector<int> voiceChannels;                 ///< The output channels for each voice which isn't culled, two per voice. -1 when unused.
+	std::vector<float> voiceGains;                  ///< The gain to mix each voice with.
+	std::vector<ChannelSource> channelSources;      ///< The sparse gain matrix. Contains the sources for each output channel, sorted by channel.
+	std::vector<int> channelFirstSource;            ///< Index into channelSources of the first source for each output channel. Has one extra element at the end.
+	std::vector<float> channelSamples;              ///< Planar output samples, used when the output is interleaved.
+	std::vector<ChannelPartition> channelPartitions;
+	
+	int numReservedVoices;
+	
+	float * mixChannelSamples;
+	int mixNumSamples;
+	
+	Stats stats;
+	
+	void mixChannel(const int channelIndex) const;
+	
+	static void mixPartitionTask(void * userData, const int taskIndex);
+};
+
 /**
  * The basic voice manager uses a basic mixer implementation to mix down to stereo or to mix to a multi-channel output.
  */
@@ -296,6 +415,8 @@ private:
 	int numDynamicChannels; ///< The number of dynamic channels, for voices wishing to be allocated to a dynamic channel index.
 	AudioVoice * firstVoice; ///< First voice in the list of registered voices.
 	
+	AudioVoiceMixer mixer; ///< The mixer used by generateAudio.
+	
 public:
 	bool outputStereo; ///< When true, the voice manager will down mix to stereo. Otherwise, multi-channel mixing is used.
 	
@@ -311,6 +432,11 @@ public:
 	
 	virtual void generateAudio(float * __restrict samples, const int numSamples, const int numChannels) override;
 	
+	void enableParallelMixing(const int numThreads); ///< Mixes the output channels using 'numThreads' worker threads plus the audio thread. Useful for large numbers of voices and channels.
+	void disableParallelMixing();
+	
+	AudioVoiceMixer::Stats getMixerStats() const; ///< Returns mixing statistics for the last call to generateAudio.
+	
 	int calculateNumDynamicChannelsUsed() const; ///< Calculates the number of dynamic channels in use, by traversing the list of voices and checking their channel allocations.
 	int getNumDynamicChannels() const; ///< Returns the number of dynamic channels set on init.
 	
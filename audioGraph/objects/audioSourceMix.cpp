@@ -26,6 +26,7 @@
 */
 
 #include "audioSourceMix.h"
+#include "Debugging.h"
 
 AudioSourceMix::AudioSourceMix()
 	: AudioSource()
@@ -90,7 +91,8 @@ void AudioSourceMix::generate(SAMPLE_ALIGN16 float * __restrict samples, const i
 		}
 		else
 		{
-			ALIGN16 float tempSamples[AUDIO_UPDATE_SIZE];
+			Assert(numSamples <= AUDIO_MAX_UPDATE_SIZE);
+			ALIGN16 float tempSamples[AUDIO_MAX_UPDATE_SIZE];
 			
 			input.source->generate(tempSamples, numSamples);
 			
@@ -26,15 +26,14 @@
 */
 
 #include "audioSourceVorbis.h"
+#include "audiostream/VorbisDecodeService.h"
 #include "Debugging.h"
 #include "Log.h"
-#include <stdio.h>
 #include <string.h>
 
 AudioSourceVorbis::AudioSourceVorbis()
 	: filename()
-	, file(nullptr)
-	, vorbisFile()
+	, stream(nullptr)
 	, sampleRate(0)
 	, numChannels(0)	
 	, loop(false)
@@ -51,107 +50,62 @@ AudioSourceVorbis::~AudioSourceVorbis()
 
 void AudioSourceVorbis::generate(SAMPLE_ALIGN16 float * __restrict samples, const int numSamples)
 {
-	Assert(file != nullptr);
+	Assert(stream != nullptr);
 	
-	if (file == nullptr)
+	if (stream == nullptr)
 	{
 		memset(samples, 0, sizeof(float) * numSamples);
 		return;
 	}
 	
-	int numSamplesRemaining = numSamples;
-	
 	hasLooped = false;
 	
-	while (numSamplesRemaining != 0)
+	if (stream->IsOpen_get() == false)
 	{
-		int bitstream = -1;
-		
-		float ** channels = nullptr;
+		// the decode service hasn't opened the stream yet, or failed to open it
 		
-		int numSamplesRead = (int)ov_read_float(
-			&vorbisFile,
-			&channels,
-			numSamplesRemaining,
-			&bitstream);	
+		memset(samples, 0, sizeof(float) * numSamples);
 		
-		if (numSamplesRead < 0)
-		{
-			numSamplesRead = 0;
-		}
+		hasEnded = stream->HasFailed_get();
+		return;
+	}
+	
+	if (numChannels == 0)
+	{
+		sampleRate = stream->SampleRate_get();
+		numChannels = stream->NumChannels_get();
+	}
+	
+	if (numChannels == 1)
+	{
+		stream->Read(samples, numSamples, hasLooped, hasEnded);
+	}
+	else
+	{
+		// read and mix down stereo frames, in chunks small enough to fit on the stack
 		
-		const int sampleOffset = numSamples - numSamplesRemaining;
+		const int kChunkSize = 256;
 		
-		float * __restrict samplePtr = samples + sampleOffset;
+		ALIGN16 float frames[kChunkSize * 2];
 		
-		if (numChannels == 1)
+		for (int i = 0; i < numSamples; i += kChunkSize)
 		{
-			if (numSamplesRead > 0)
-			{
-				memcpy(samplePtr, channels[0], numSamplesRead * sizeof(float));
-			}
-		}
-		else if (numChannels == 2)
-		{
-			const int numSamplesRead4 = numSamplesRead / 4;
+			const int numFrames = numSamples - i < kChunkSize ? numSamples - i : kChunkSize;
 			
-			for (int i = 0; i < numSamplesRead4; ++i)
-			{
-				const float value1 = channels[0][i * 4 + 0] + channels[1][i * 4 + 0];
-				const float value2 = channels[0][i * 4 + 1] + channels[1][i * 4 + 1];
-				const float value3 = channels[0][i * 4 + 2] + channels[1][i * 4 + 2];
-				const float value4 = channels[0][i * 4 + 3] + channels[1][i * 4 + 3];
-				
-				samplePtr[i * 4 + 0] = value1;
-				samplePtr[i * 4 + 1] = value2;
-				samplePtr[i * 4 + 2] = value3;
-				samplePtr[i * 4 + 3] = value4;
-			}
+			bool chunkHasLooped;
 			
-			for (int i = numSamplesRead4 * 4; i < numSamplesRead; ++i)
-			{
-				samplePtr[i] = channels[0][i] + channels[1][i];
-			}
-		}
-		
-		samplePosition += numSamplesRead;
-		
-		//
-		
-		if (numSamplesRead == 0)
-		{
-			// reached EOF
+			stream->Read(frames, numFrames, chunkHasLooped, hasEnded);
 			
-			if (loop)
-			{
-				// not done yet!
-				
-				close();
-				
-				open(filename.c_str(), loop);
-				
-				hasLooped = true;
-				
-				samplePosition = 0;
-			}
-			else
-			{
-				// we're done
-				
-				memset(samplePtr, 0, numSamplesRemaining * sizeof(float));
-				
-				hasEnded = true;
-				
-				break;
-			}
-		}
-		else
-		{
-			Assert(numSamplesRead <= numSamplesRemaining);
+			hasLooped |= chunkHasLooped;
+			
+			float * __restrict samplePtr = samples + i;
 			
-			numSamplesRemaining -= numSamplesRead;
+			for (int j = 0; j < numFrames; ++j)
+				samplePtr[j] = frames[j * 2 + 0] + frames[j * 2 + 1];
 		}
 	}
+	
+	samplePosition = (int)stream->Position_get();
 }
 
 void AudioSourceVorbis::open(const char * _filename, bool _loop)
@@ -164,59 +118,36 @@ void AudioSourceVorbis::open(const char * _filename, bool _loop)
 	hasEnded = false;
 	
 	samplePosition = 0;
-
-	file = fopen(_filename, "rb");
 	
-	if (file == nullptr)
-	{
-		LOG_ERR("Vosbis Audio Stream: failed to open file (%s)", _filename);
-		Assert(file != 0);
-		close();
-		return;
-	}
+	// note : the decode service opens the file, parses the header and prefetches the first couple of frames on
+	//        one of its threads. until then generate outputs silence. the sample rate and channel count are
+	//        picked up by generate once the stream is open
 	
-	LOG_DBG("Vorbis Audio Stream: opened file: %s", _filename);
+	sampleRate = 0;
+	numChannels = 0;
 	
-	const int result = ov_open(file, &vorbisFile, NULL, 0);
-
-	if (result != 0)
-	{
-		LOG_ERR("Vosbis Audio Stream: failed to create vorbis decoder (%d)", result);
-		close();
-		return;
-	}
+	stream = GetVorbisDecodeService().OpenStreamAsync(_filename, _loop);
 	
-	LOG_DBG("Vorbis Audio Stream: created vorbis decoder");
-	
-	const vorbis_info * info = ov_info(&vorbisFile, -1);
-	
-	sampleRate = static_cast<int>(info->rate);
-	numChannels = info->channels;
-	
-	LOG_DBG("Vorbis Audio Stream: channelCount=%d, sampleRate=%d", numChannels, sampleRate);
-	
-	if (numChannels != 1 && numChannels != 2)
-	{
-		LOG_ERR("Vosbis Audio Stream: channel count is not supported (%d)", numChannels);
-		close();
-		return;
-	}
+	LOG_DBG("Vorbis Audio Stream: opening file (%s)", _filename);
 }
 
 void AudioSourceVorbis::close()
 {
-	if (file != nullptr)
+	if (stream != nullptr)
 	{
-		ov_clear(&vorbisFile);
-		LOG_DBG("Vorbis Audio Stream: destroyed vorbis decoder");
+		GetVorbisDecodeService().CloseStream(stream);
+		stream = nullptr;
 		
-		fclose(file);
-		file = 0;
 		LOG_DBG("Vorbis Audio Stream: closed file");
 	}
 }
 
 bool AudioSourceVorbis::isOpen() const
 {
-	return file != nullptr;
+	return stream != nullptr;
+}
+
+int AudioSourceVorbis::getNumUnderruns() const
+{
+	return stream != nullptr ? stream->NumUnderruns_get() : 0;
 }
@@ -27,18 +27,24 @@
 
 #pragma once
 
-#include "oggvorbis.h"
 #include "soundmix.h" // AudioSource
 #include <string>
 
+class VorbisDecodeStream;
+
+/**
+ * Streams a Vorbis file. Opening and decoding are done ahead of time by the Vorbis decode service, so open returns
+ * immediately and generate only copies already decoded samples. generate outputs silence until the stream is open.
+ * When the decode service falls behind, generate outputs silence and counts an underrun. When the file fails to
+ * open, generate outputs silence and hasEnded is set.
+ */
 struct AudioSourceVorbis : AudioSource
 {
 	std::string filename;
-	FILE * file;
-	OggVorbis_File vorbisFile;
+	VorbisDecodeStream * stream;
 	
-	int sampleRate;
-	int numChannels;
+	int sampleRate; // zero until the stream is open
+	int numChannels; // zero until the stream is open
 	bool loop;
 	bool hasLooped;
 	bool hasEnded;
@@ -53,4 +59,6 @@ struct AudioSourceVorbis : AudioSource
 	void close();
 	
 	bool isOpen() const;
+	
+	int getNumUnderruns() const;
 };
@@ -30,18 +30,164 @@
 #include "binaural_ircam.h"
 #include "binaural_mit.h"
 #include "binaural_oalsoft.h"
+#include "binauralizer.h"
 #include "hrirSampleSetCache.h"
 #include "Log.h"
+#include "Multicore/Mutex.h"
 #include <map>
+#include <stdint.h>
+#include <stdio.h>
 #include <string>
+#include <sys/stat.h>
 
-typedef std::map<std::string, binaural::HRIRSampleSet*> HRIRSampleSetCacheInternal;
+struct HRTFCacheMutex : binaural::Mutex
+{
+	::Mutex mutex;
+	
+	HRTFCacheMutex()
+	{
+		mutex.alloc();
+	}
+	
+	virtual ~HRTFCacheMutex() override
+	{
+		mutex.free();
+	}
+	
+	virtual void lock() override
+	{
+		mutex.lock();
+	}
+	
+	virtual void unlock() override
+	{
+		mutex.unlock();
+	}
+};
+
+struct HRIRSampleSetCacheElem
+{
+	binaural::HRIRSampleSet * sampleSet = nullptr;
+	binaural::HRTFCache * hrtfCache = nullptr;
+	HRTFCacheMutex * hrtfCacheMutex = nullptr;
+	
+	void free()
+	{
+		delete hrtfCache;
+		hrtfCache = nullptr;
+		
+		delete hrtfCacheMutex;
+		hrtfCacheMutex = nullptr;
+		
+		delete sampleSet;
+		sampleSet = nullptr;
+	}
+};
+
+struct HRIRSampleSetCacheInternal
+{
+	std::map<std::string, HRIRSampleSetCacheElem> elems;
+	
+	float hrtfCacheAngularResolution = 1.f;
+	int hrtfCacheMaxEntries = 1024;
+};
 
 static HRIRSampleSetCacheInternal & getInternal(void * internal)
 {
 	return *(HRIRSampleSetCacheInternal*)internal;
 }
 
+//
+
+static bool getModificationTime(const char * path, int64_t & time)
+{
+	struct stat s;
+	
+	if (stat(path, &s) != 0)
+		return false;
+	
+	time = s.st_mtime;
+	
+	return true;
+}
+
+static std::string getFinalizedCachePath(const char * path)
+{
+	std::string result = path;
+	
+	while (!result.empty() && (result.back() == '/' || result.back() == '\\'))
+		result.pop_back();
+	
+	return result + ".cache";
+}
+
+static binaural::HRIRSampleSet * loadFinalizedCache(const char * cachePath, const HRIRSampleSetType type, const int64_t time)
+{
+	binaural::HRIRSampleSet * sampleSet = nullptr;
+	
+	FILE * file = fopen(cachePath, "rb");
+	
+	if (file != nullptr)
+	{
+		int64_t cachedTime = 0;
+		int cachedType = -1;
+		
+		bool result = true;
+		
+		result &= fread(&cachedTime, sizeof(cachedTime), 1, file) == 1;
+		result &= fread(&cachedType, sizeof(cachedType), 1, file) == 1;
+		
+		if (result && cachedTime == time && cachedType == type)
+		{
+			sampleSet = new binaural::HRIRSampleSet();
+			
+			if (sampleSet->loadFinalized(file) == false)
+			{
+				LOG_WRN("failed to load cached sample set. path=%s", cachePath);
+				
+				delete sampleSet;
+				sampleSet = nullptr;
+			}
+		}
+		
+		fclose(file);
+		file = nullptr;
+	}
+	
+	return sampleSet;
+}
+
+static void saveFinalizedCache(const char * cachePath, const HRIRSampleSetType type, const int64_t time, const binaural::HRIRSampleSet & sampleSet)
+{
+	FILE * file = fopen(cachePath, "wb");
+	
+	if (file == nullptr)
+	{
+		LOG_DBG("unable to save cached sample set. path=%s", cachePath);
+		return;
+	}
+	
+	const int typeAsInt = type;
+	
+	bool result = true;
+	
+	result &= fwrite(&time, sizeof(time), 1, file) == 1;
+	result &= fwrite(&typeAsInt, sizeof(typeAsInt), 1, file) == 1;
+	result &= sampleSet.saveFinalized(file);
+	
+	fclose(file);
+	file = nullptr;
+	
+	if (result == false)
+	{
+		LOG_WRN("failed to save cached sample set. path=%s", cachePath);
+		
+		remove(cachePath);
+	}
+}
+
+//
+
 HRIRSampleSetCache::HRIRSampleSetCache()
 {
 	m_internal = new HRIRSampleSetCacheInternal();
@@ -49,79 +195,132 @@ HRIRSampleSetCache::HRIRSampleSetCache()
 
 HRIRSampleSetCache::~HRIRSampleSetCache()
 {
+	clear();
+	
 	auto & internal = getInternal(m_internal);
 	
 	delete &internal;
 	m_internal = nullptr;
 }
 
+void HRIRSampleSetCache::setHrtfCacheParams(const float angularResolution, const int maxEntries)
+{
+	auto & internal = getInternal(m_internal);
+	
+	internal.hrtfCacheAngularResolution = angularResolution;
+	internal.hrtfCacheMaxEntries = maxEntries;
+}
+
 void HRIRSampleSetCache::add(const char * path, const char * name, const HRIRSampleSetType type)
 {
-	binaural::HRIRSampleSet * sampleSet = new binaural::HRIRSampleSet();
+	auto & internal = getInternal(m_internal);
 	
-	bool result = false;
+	// try to load the finalized sample set from the cache first
 	
-	switch (type)
-	{
-	case kHRIRSampleSetType_Cipic:
-		result = binaural::loadHRIRSampleSet_Cipic(path, *sampleSet);
-		break;
-	case kHRIRSampleSetType_Ircam:
-		result = binaural::loadHRIRSampleSet_Ircam(path, *sampleSet);
-		break;
-	case kHRIRSampleSetType_Mit:
-		result = binaural::loadHRIRSampleSet_Mit(path, *sampleSet);
-		break;
-	case kHRIRSampleSetType_Oalsoft:
-		result = binaural::loadHRIRSampleSet_Oalsoft(path, *sampleSet);
-		break;
-	}
+	const std::string cachePath = getFinalizedCachePath(path);
 	
-	if (result == false)
-	{
-		LOG_ERR("failed to load sample set. path=%s", path);
+	int64_t time = 0;
+	const bool hasTime = getModificationTime(path, time);
 	
-		delete sampleSet;
-		sampleSet = nullptr;
-	}
-	else
+	binaural::HRIRSampleSet * sampleSet = hasTime
+		? loadFinalizedCache(cachePath.c_str(), type, time)
+		: nullptr;
+	
+	if (sampleSet == nullptr)
 	{
-		sampleSet->finalize();
+		sampleSet = new binaural::HRIRSampleSet();
+		
+		bool result = false;
+		
+		switch (type)
+		{
+		case kHRIRSampleSetType_Cipic:
+			result = binaural::loadHRIRSampleSet_Cipic(path, *sampleSet);
+			break;
+		case kHRIRSampleSetType_Ircam:
+			result = binaural::loadHRIRSampleSet_Ircam(path, *sampleSet);
+			break;
+		case kHRIRSampleSetType_Mit:
+			result = binaural::loadHRIRSampleSet_Mit(path, *sampleSet);
+			break;
+		case kHRIRSampleSetType_Oalsoft:
+			result = binaural::loadHRIRSampleSet_Oalsoft(path, *sampleSet);
+			break;
+		}
 		
-		auto & elem = getInternal(m_internal)[name];
+		if (result == false)
+		{
+			LOG_ERR("failed to load sample set. path=%s", path);
 		
-		delete elem;
-		elem = nullptr;
+			delete sampleSet;
+			sampleSet = nullptr;
+			
+			return;
+		}
 		
-		elem = sampleSet;
+		sampleSet->finalize();
+		
+		if (hasTime)
+		{
+			saveFinalizedCache(cachePath.c_str(), type, time, *sampleSet);
+		}
 	}
+	
+	auto & elem = internal.elems[name];
+	
+	elem.free();
+	
+	elem.sampleSet = sampleSet;
+	
+	elem.hrtfCacheMutex = new HRTFCacheMutex();
+	elem.hrtfCache = new binaural::HRTFCache();
+	elem.hrtfCache->init(
+		sampleSet,
+		internal.hrtfCacheAngularResolution,
+		internal.hrtfCacheMaxEntries,
+		elem.hrtfCacheMutex);
 }
 
 void HRIRSampleSetCache::clear()
 {
 	auto & internal = getInternal(m_internal);
 	
-	for (auto & i : internal)
+	for (auto & i : internal.elems)
 	{
-		delete i.second;
-		i.second = nullptr;
+		i.second.free();
 	}
 	
-	internal.clear();
+	internal.elems.clear();
 }
 
 const binaural::HRIRSampleSet * HRIRSampleSetCache::find(const char * name) const
 {
 	auto & internal = getInternal(m_internal);
 	
-	auto i = internal.find(name);
+	auto i = internal.elems.find(name);
+	
+	if (i == internal.elems.end())
+	{
+		return nullptr;
+	}
+	else
+	{
+		return i->second.sampleSet;
+	}
+}
+
+binaural::HRTFCache * HRIRSampleSetCache::findHrtfCache(const char * name) const
+{
+	auto & internal = getInternal(m_internal);
+	
+	auto i = internal.elems.find(name);
 	
-	if (i == internal.end())
+	if (i == internal.elems.end())
 	{
 		return nullptr;
 	}
 	else
 	{
-		return i->second;
+		return i->second.hrtfCache;
 	}
 }
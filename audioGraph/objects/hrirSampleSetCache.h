@@ -28,6 +28,7 @@
 namespace binaural
 {
 	struct HRIRSampleSet;
+	struct HRTFCache;
 }
 
 enum HRIRSampleSetType
@@ -38,6 +39,13 @@ enum HRIRSampleSetType
 	kHRIRSampleSetType_Oalsoft
 };
 
+/**
+ * Loads and owns HRIR sample sets, which may be looked up by name.
+ * When a sample set is added, its finalized form (triangulation and precomputed HRTFs) is saved next to it, with the '.cache'
+ * extension appended to its path. The next time the sample set is added, the finalized form is loaded instead, which is a lot
+ * faster than loading and finalizing the sample set. The cached form is rebuilt when the modification time of the path changes.
+ * For each sample set, a HRTF cache is created as well, which binauralizers may share, see binaural::HRTFCache.
+ */
 struct HRIRSampleSetCache
 {
 private:
@@ -47,8 +55,14 @@ public:
 	HRIRSampleSetCache();
 	~HRIRSampleSetCache();
 	
+	/**
+	 * Sets the angular resolution (in degrees) and the maximum number of entries for the HRTF caches created for sample sets added after this call.
+	 */
+	void setHrtfCacheParams(const float angularResolution, const int maxEntries);
+	
 	void add(const char * path, const char * name, const HRIRSampleSetType type);
 	void clear();
 	
 	const binaural::HRIRSampleSet * find(const char * name) const;
+	binaural::HRTFCache * findHrtfCache(const char * name) const;
 };
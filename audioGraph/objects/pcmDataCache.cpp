@@ -25,16 +25,415 @@
 	OTHER DEALINGS IN THE SOFTWARE.
 */
 
+#include "Debugging.h"
 #include "framework.h" // listFiles
 #include "Log.h"
+#include "Multicore/ThreadName.h"
 #include "Path.h" // GetExtension
 #include "pcmDataCache.h"
 #include "soundmix.h" // PcmData
 #include "StringEx.h" // ToLower
 #include "Timer.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#if defined(WIN32)
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
 
 // todo : use a system-provided temp path for the cache files, to avoid polluting the data folder
 
+static const int kLazyLoaderPollIntervalMs = 5;
+
+//
+
+struct MappedFile
+{
+	void * address = nullptr;
+	size_t size = 0;
+	
+#if defined(WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+	
+	bool map(const char * filename)
+	{
+	#if defined(WIN32)
+		file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		
+		LARGE_INTEGER fileSize;
+		
+		if (GetFileSizeEx(file, &fileSize) == FALSE || fileSize.QuadPart == 0)
+		{
+			unmap();
+			return false;
+		}
+		
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		
+		if (mapping == nullptr)
+		{
+			unmap();
+			return false;
+		}
+		
+		address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		size = (size_t)fileSize.QuadPart;
+		
+		if (address == nullptr)
+		{
+			unmap();
+			return false;
+		}
+		
+		return true;
+	#else
+		const int fd = open(filename, O_RDONLY);
+		
+		if (fd < 0)
+			return false;
+		
+		struct stat s;
+		
+		if (fstat(fd, &s) != 0 || s.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+		
+		void * result = mmap(nullptr, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		
+		// note : the mapping remains valid after closing the file
+		
+		close(fd);
+		
+		if (result == MAP_FAILED)
+			return false;
+		
+		address = result;
+		size = (size_t)s.st_size;
+		
+		return true;
+	#endif
+	}
+	
+	void unmap()
+	{
+	#if defined(WIN32)
+		if (address != nullptr)
+			UnmapViewOfFile(address);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+	#else
+		if (address != nullptr)
+			munmap(address, size);
+	#endif
+		
+		address = nullptr;
+		size = 0;
+	}
+};
+
+struct PcmDataCache::LazyElem
+{
+	std::string filename;
+	bool createCache = false;
+	
+	// shared between the users of the cache and the loader thread
+	
+	std::atomic<PcmData*> pcmData;
+	std::atomic<int> refCount;
+	std::atomic<uint64_t> lastUseTime;
+	std::atomic<bool> isRequested;
+	std::atomic<bool> hasFailed;
+	
+	LazyElem * nextRequest = nullptr;
+	
+	// owned by the loader thread
+	
+	MappedFile mappedFile;
+	size_t residentBytes = 0;
+	
+	LazyElem()
+		: pcmData(nullptr)
+		, refCount(0)
+		, lastUseTime(0)
+		, isRequested(false)
+		, hasFailed(false)
+	{
+	}
+};
+
+struct PcmDataCache::LazyLoader
+{
+	size_t memoryBudget = 0;
+	
+	// requests are pushed onto a lock-free stack, so acquire never needs to take a lock
+	
+	std::atomic<LazyElem*> requests;
+	
+	std::vector<LazyElem*> residentElems;
+	
+	std::atomic<size_t> residentBytes;
+	std::atomic<int> numResident;
+	std::atomic<int> numLoads;
+	std::atomic<int> numEvictions;
+	
+	std::thread thread;
+	std::mutex mutex;
+	std::condition_variable condition;
+	bool stop = false;
+	
+	LazyLoader()
+		: requests(nullptr)
+		, residentBytes(0)
+		, numResident(0)
+		, numLoads(0)
+		, numEvictions(0)
+	{
+	}
+	
+	void init(const size_t _memoryBudget)
+	{
+		memoryBudget = _memoryBudget;
+		
+		thread = std::thread([this]() { threadMain(); });
+	}
+	
+	void shut()
+	{
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			stop = true;
+		}
+		
+		condition.notify_one();
+		
+		thread.join();
+		
+		// free all PCM data. the caller guarantees no one is using it anymore
+		
+		for (auto * elem : residentElems)
+			freePcmData(elem->pcmData.exchange(nullptr), elem->mappedFile);
+		residentElems.clear();
+	}
+	
+	void request(LazyElem * elem)
+	{
+		if (elem->isRequested.exchange(true, std::memory_order_acq_rel))
+			return;
+		
+		LazyElem * head = requests.load(std::memory_order_relaxed);
+		
+		do
+		{
+			elem->nextRequest = head;
+		} while (!requests.compare_exchange_weak(head, elem, std::memory_order_release, std::memory_order_relaxed));
+	}
+	
+	static void freePcmData(PcmData * pcmData, MappedFile & mappedFile)
+	{
+		delete pcmData;
+		
+		mappedFile.unmap();
+	}
+	
+	void load(LazyElem * elem)
+	{
+		PcmData * pcmData = new PcmData();
+		
+		// prefer memory mapping the cache file. its contents are paged in by the OS as they're being accessed
+		
+		const std::string cachedFilename = elem->filename + ".cache";
+		
+		if (elem->mappedFile.map(cachedFilename.c_str()))
+		{
+			const int32_t numSamples = elem->mappedFile.size >= 4 ? *(const int32_t*)elem->mappedFile.address : -1;
+			
+			if (numSamples >= 0 && 4 + size_t(numSamples) * sizeof(float) <= elem->mappedFile.size)
+			{
+				pcmData->set((float*)((uint8_t*)elem->mappedFile.address + 4), numSamples);
+				
+				elem->residentBytes = elem->mappedFile.size;
+			}
+			else
+			{
+				LOG_ERR("invalid PCM data cache file: %s", cachedFilename.c_str());
+				
+				elem->mappedFile.unmap();
+			}
+		}
+		
+		if (elem->mappedFile.address == nullptr)
+		{
+			if (pcmData->load(elem->filename.c_str(), 0, elem->createCache) == false)
+			{
+				delete pcmData;
+				
+				elem->hasFailed.store(true, std::memory_order_relaxed);
+				
+				return;
+			}
+			
+			elem->residentBytes = pcmData->numSamples * sizeof(float);
+		}
+		
+		residentElems.push_back(elem);
+		
+		residentBytes.fetch_add(elem->residentBytes, std::memory_order_relaxed);
+		numResident.fetch_add(1, std::memory_order_relaxed);
+		numLoads.fetch_add(1, std::memory_order_relaxed);
+		
+		elem->lastUseTime.store(g_TimerRT.TimeUS_get(), std::memory_order_relaxed);
+		elem->pcmData.store(pcmData, std::memory_order_release);
+	}
+	
+	void evict()
+	{
+		while (residentBytes.load(std::memory_order_relaxed) > memoryBudget)
+		{
+			// find the least recently used PCM data which isn't referenced
+			
+			int lruIndex = -1;
+			uint64_t lruTime = 0;
+			
+			for (size_t i = 0; i < residentElems.size(); ++i)
+			{
+				if (residentElems[i]->refCount.load() != 0)
+					continue;
+				
+				const uint64_t lastUseTime = residentElems[i]->lastUseTime.load(std::memory_order_relaxed);
+				
+				if (lruIndex == -1 || lastUseTime < lruTime)
+				{
+					lruIndex = (int)i;
+					lruTime = lastUseTime;
+				}
+			}
+			
+			if (lruIndex == -1)
+			{
+				// everything that's resident is referenced. allow going over budget for now
+				
+				break;
+			}
+			
+			LazyElem * elem = residentElems[lruIndex];
+			
+			// note : acquire increments the reference count before it loads the PCM data, while we clear the PCM
+			//        data before checking the reference count again. so either we see the new reference, or the
+			//        user sees nullptr. when the PCM data was acquired in between, we put it back and retry later
+			
+			PcmData * pcmData = elem->pcmData.exchange(nullptr);
+			
+			if (elem->refCount.load() != 0)
+			{
+				elem->pcmData.store(pcmData);
+				
+				break;
+			}
+			
+			residentElems[lruIndex] = residentElems.back();
+			residentElems.pop_back();
+			
+			// no one references the PCM data, and users acquiring it from now on will see nullptr, so it's safe to free it right away
+			
+			freePcmData(pcmData, elem->mappedFile);
+			
+			residentBytes.fetch_sub(elem->residentBytes, std::memory_order_relaxed);
+			numResident.fetch_sub(1, std::memory_order_relaxed);
+			numEvictions.fetch_add(1, std::memory_order_relaxed);
+			
+			elem->residentBytes = 0;
+			
+			// allow the next call to acquire to request the PCM data again
+			
+			elem->isRequested.store(false, std::memory_order_release);
+		}
+	}
+	
+	void threadMain()
+	{
+		SetCurrentThreadName("PCM Data Loader");
+		
+		for (;;)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				
+				if (stop)
+					break;
+				
+				condition.wait_for(lock, std::chrono::milliseconds(kLazyLoaderPollIntervalMs));
+				
+				if (stop)
+					break;
+			}
+			
+			// take all pending requests at once
+			
+			LazyElem * elem = requests.exchange(nullptr, std::memory_order_acquire);
+			
+			while (elem != nullptr)
+			{
+				LazyElem * next = elem->nextRequest;
+				
+				if (elem->pcmData.load(std::memory_order_relaxed) == nullptr)
+					load(elem);
+				
+				elem = next;
+			}
+			
+			evict();
+		}
+	}
+};
+
+//
+
+PcmDataCache::~PcmDataCache()
+{
+	clear();
+	
+	setLazyLoading(false, 0);
+}
+
+void PcmDataCache::setLazyLoading(const bool enabled, const size_t memoryBudget)
+{
+	Assert(elems.empty() && lazyElems.empty());
+	
+	if (lazyLoader != nullptr)
+	{
+		lazyLoader->shut();
+		
+		delete lazyLoader;
+		lazyLoader = nullptr;
+	}
+	
+	if (enabled)
+	{
+		lazyLoader = new LazyLoader();
+		lazyLoader->init(memoryBudget);
+	}
+}
+
 void PcmDataCache::addPath(const char * path, const bool recurse, const bool stripPaths, const bool createCaches)
 {
 	LOG_DBG("filling PCM data cache with path: %s", path);
@@ -55,6 +454,24 @@ void PcmDataCache::addPath(const char * path, const bool recurse, const bool str
 		
 		const std::string filenameLower = String::ToLower(filename);
 		
+		const std::string name = stripPaths ? Path::GetFileName(filenameLower) : filenameLower;
+		
+		if (lazyLoader != nullptr)
+		{
+			// register the file. its PCM data will be loaded on first use
+			
+			auto & elem = lazyElems[name];
+			
+			if (elem == nullptr)
+			{
+				elem = new LazyElem();
+				elem->filename = filenameLower;
+				elem->createCache = createCaches;
+			}
+			
+			continue;
+		}
+		
 		PcmData * pcmData = new PcmData();
 		
 		if (pcmData->load(filenameLower.c_str(), 0, createCaches) == false)
@@ -64,8 +481,6 @@ void PcmDataCache::addPath(const char * path, const bool recurse, const bool str
 		}
 		else
 		{
-			const std::string name = stripPaths ? Path::GetFileName(filenameLower) : filenameLower;
-			
 			// check if this is a duplicate element. this could happen if different folders contain
 			// a file with the same name, due to stripping paths
 			
@@ -85,7 +500,10 @@ void PcmDataCache::addPath(const char * path, const bool recurse, const bool str
 	
 	const auto t2 = g_TimerRT.TimeUS_get();
 	
-	LOG_INF("loading PCM data from %s took %.2fms", path, (t2 - t1) / 1000.0);
+	if (lazyLoader != nullptr)
+		LOG_INF("registering PCM data from %s took %.2fms", path, (t2 - t1) / 1000.0);
+	else
+		LOG_INF("loading PCM data from %s took %.2fms", path, (t2 - t1) / 1000.0);
 }
 
 void PcmDataCache::clear()
@@ -97,10 +515,92 @@ void PcmDataCache::clear()
 	}
 	
 	elems.clear();
+	
+	if (lazyLoader != nullptr)
+	{
+		for (auto & i : lazyElems)
+			Assert(i.second->refCount.load() == 0);
+		
+		// restart the loader, to make sure it has released all of the PCM data before we free the elements
+		
+		const size_t memoryBudget = lazyLoader->memoryBudget;
+		
+		lazyLoader->shut();
+		
+		for (auto & i : lazyElems)
+			delete i.second;
+		lazyElems.clear();
+		
+		delete lazyLoader;
+		lazyLoader = new LazyLoader();
+		lazyLoader->init(memoryBudget);
+	}
+}
+
+PcmDataCache::Ref::~Ref()
+{
+	reset();
+}
+
+void PcmDataCache::Ref::reset()
+{
+	if (elem != nullptr)
+		elem->refCount.fetch_sub(1);
+	
+	elem = nullptr;
+	pcmData = nullptr;
+}
+
+void PcmDataCache::acquire(const char * filename, Ref & ref) const
+{
+	const std::string filenameLower = String::ToLower(filename);
+	
+	LazyElem * elem = nullptr;
+	const PcmData * pcmData = nullptr;
+	
+	if (lazyLoader != nullptr)
+	{
+		auto i = lazyElems.find(filenameLower);
+		
+		if (i != lazyElems.end())
+		{
+			elem = i->second;
+			
+			elem->refCount.fetch_add(1);
+			elem->lastUseTime.store(g_TimerRT.TimeUS_get(), std::memory_order_relaxed);
+			
+			pcmData = elem->pcmData.load();
+			
+			if (pcmData == nullptr && elem->hasFailed.load(std::memory_order_relaxed) == false)
+				lazyLoader->request(elem);
+		}
+	}
+	else
+	{
+		auto i = elems.find(filenameLower);
+		
+		if (i != elems.end())
+			pcmData = i->second;
+	}
+	
+	// note : the old reference is released after acquiring the new one, so PCM data which is acquired
+	//        again each tick remains referenced without interruption
+	
+	ref.reset();
+	
+	ref.elem = elem;
+	ref.pcmData = pcmData;
 }
 
 const PcmData * PcmDataCache::get(const char * filename) const
 {
+	// note : PCM data may be evicted as soon as it isn't referenced anymore, so with lazy loading, the PCM data
+	//        returned by get wouldn't remain valid for any amount of time. use acquire instead
+	
+	Assert(lazyLoader == nullptr);
+	if (lazyLoader != nullptr)
+		return nullptr;
+	
 	const std::string filenameLower = String::ToLower(filename);
 	
 	auto i = elems.find(filenameLower);
@@ -114,3 +614,39 @@ const PcmData * PcmDataCache::get(const char * filename) const
 		return i->second;
 	}
 }
+
+bool PcmDataCache::exists(const char * filename) const
+{
+	const std::string filenameLower = String::ToLower(filename);
+	
+	if (lazyLoader != nullptr)
+		return lazyElems.count(filenameLower) != 0;
+	else
+		return elems.count(filenameLower) != 0;
+}
+
+PcmDataCache::Stats PcmDataCache::getStats() const
+{
+	Stats stats;
+	
+	if (lazyLoader != nullptr)
+	{
+		stats.numElems = (int)lazyElems.size();
+		stats.numResident = lazyLoader->numResident.load(std::memory_order_relaxed);
+		stats.residentBytes = lazyLoader->residentBytes.load(std::memory_order_relaxed);
+		stats.numLoads = lazyLoader->numLoads.load(std::memory_order_relaxed);
+		stats.numEvictions = lazyLoader->numEvictions.load(std::memory_order_relaxed);
+	}
+	else
+	{
+		stats.numElems = (int)elems.size();
+		stats.numResident = (int)elems.size();
+		
+		for (auto & i : elems)
+			stats.residentBytes += i.second->numSamples * sizeof(float);
+		
+		stats.numLoads = (int)elems.size();
+	}
+	
+	return stats;
+}
@@ -28,16 +28,76 @@
 #pragma once
 
 #include <map>
+#include <stddef.h>
 #include <string>
 
 struct PcmData;
 
+/**
+ * Cache of PCM data, indexed by (lower case) file name.
+ *
+ * By default, addPath loads all sounds up front and keeps them resident. With lazy loading enabled, addPath only
+ * registers the sounds. Their PCM data is then memory mapped from their .cache files, or decoded, by a background
+ * thread when first requested through acquire. The least recently used PCM data is evicted when the total size of
+ * the resident PCM data exceeds the memory budget. acquire never blocks. It yields nullptr while the PCM data isn't
+ * ready yet, so make sure to call it again each tick.
+ *
+ * PCM data is never evicted while a Ref to it is held. Users keep their Ref until they acquire the PCM data again
+ * during the next tick, so the PCM data they looked up remains valid for the remainder of the current tick, no
+ * matter how long the tick takes. The memory budget is a soft limit. The resident size exceeds it when more sounds
+ * are referenced at once than fit within it.
+ */
 struct PcmDataCache
 {
+	struct LazyElem;
+	struct LazyLoader;
+	
+	/**
+	 * Reference to PCM data in the cache. Releases the reference when reset, destroyed, or when it is
+	 * reused by acquire. All references must be released before the cache is cleared or destroyed.
+	 */
+	struct Ref
+	{
+		LazyElem * elem = nullptr;
+		const PcmData * pcmData = nullptr;
+		
+		Ref() = default;
+		Ref(const Ref &) = delete;
+		~Ref();
+		
+		Ref & operator=(const Ref &) = delete;
+		
+		void reset();
+		
+		const PcmData * get() const { return pcmData; }
+	};
+	
+	struct Stats
+	{
+		int numElems = 0;
+		int numResident = 0;
+		size_t residentBytes = 0;
+		int numLoads = 0;
+		int numEvictions = 0;
+	};
+	
 	std::map<std::string, PcmData*> elems;
 	
+	std::map<std::string, LazyElem*> lazyElems;
+	LazyLoader * lazyLoader = nullptr;
+	
+	~PcmDataCache();
+	
+	void setLazyLoading(const bool enabled, const size_t memoryBudget);
+	
 	void addPath(const char * path, const bool recurse, const bool stripPaths, const bool createCaches);
 	void clear();
 	
-	const PcmData * get(const char * filename) const;
+	void acquire(const char * filename, Ref & ref) const; // thread: any. acquires the new reference before releasing the old one
+	
+	const PcmData * get(const char * filename) const; // returns nullptr when lazy loading is enabled. use acquire instead
+	
+	bool exists(const char * filename) const;
+	
+	Stats getStats() const;
 };
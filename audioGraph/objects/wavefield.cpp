@@ -698,6 +698,171 @@ void Wavefield1Df::doGaussianImpact(const int spotX, const int radius, const flo
 
 //
 
+// unaligned load and store helpers used by the 2D wave field kernels. the horizontal neighbours of a row are
+// loaded at a one element offset, so these loads are never aligned
+
+#if AUDIO_USE_SSE || AUDIO_USE_NEON
+
+template <typename T, typename S> inline T _mm_loadu(const S * p);
+template <typename T, typename S> inline void _mm_storeu(S * p, const T v);
+template <typename T, typename S> inline T _mm_set1(const S v);
+
+#if AUDIO_USE_SSE
+template <> inline __m128 _mm_loadu<__m128, float>(const float * p) { return _mm_loadu_ps(p); }
+template <> inline __m128d _mm_loadu<__m128d, double>(const double * p) { return _mm_loadu_pd(p); }
+template <> inline void _mm_storeu<__m128, float>(float * p, const __m128 v) { _mm_storeu_ps(p, v); }
+template <> inline void _mm_storeu<__m128d, double>(double * p, const __m128d v) { _mm_storeu_pd(p, v); }
+template <> inline __m128 _mm_set1<__m128, float>(const float v) { return _mm_set1_ps(v); }
+template <> inline __m128d _mm_set1<__m128d, double>(const double v) { return _mm_set1_pd(v); }
+inline __m128 _mm_clamp(const __m128 v, const __m128 min, const __m128 max) { return _mm_max_ps(_mm_min_ps(v, max), min); }
+#endif
+
+#if AUDIO_USE_SSE && __AVX__
+template <> inline __m256 _mm_loadu<__m256, float>(const float * p) { return _mm256_loadu_ps(p); }
+template <> inline __m256d _mm_loadu<__m256d, double>(const double * p) { return _mm256_loadu_pd(p); }
+template <> inline void _mm_storeu<__m256, float>(float * p, const __m256 v) { _mm256_storeu_ps(p, v); }
+template <> inline void _mm_storeu<__m256d, double>(double * p, const __m256d v) { _mm256_storeu_pd(p, v); }
+template <> inline __m256 _mm_set1<__m256, float>(const float v) { return _mm256_set1_ps(v); }
+template <> inline __m256d _mm_set1<__m256d, double>(const double v) { return _mm256_set1_pd(v); }
+inline __m256 _mm_clamp(const __m256 v, const __m256 min, const __m256 max) { return _mm256_max_ps(_mm256_min_ps(v, max), min); }
+#endif
+
+#if AUDIO_USE_NEON
+template <> inline float32x4_t _mm_loadu<float32x4_t, float>(const float * p) { return vld1q_f32(p); }
+template <> inline void _mm_storeu<float32x4_t, float>(float * p, const float32x4_t v) { vst1q_f32(p, v); }
+template <> inline float32x4_t _mm_set1<float32x4_t, float>(const float v) { return vdupq_n_f32(v); }
+inline float32x4_t _mm_clamp(const float32x4_t v, const float32x4_t min, const float32x4_t max) { return vmaxq_f32(vminq_f32(v, max), min); }
+#endif
+
+/**
+ * Accumulates the spring forces acting on the elements [begin, end) of a row into their velocities. 'pU' and
+ * 'pD' are the rows above and below the row 'pC'. The caller must ensure the horizontal neighbours of 'begin'
+ * and 'end - 1' are within the row. Returns the index of the first element which wasn't processed.
+ */
+template <typename T, typename S>
+inline int tickForcesRow(const S * __restrict pU, const S * __restrict pC, const S * __restrict pD, S * __restrict v, const S * __restrict f, const S _k, const int begin, const int end)
+{
+	const int vectorSize = sizeof(T) / sizeof(S);
+	
+	const int numVectors = (end - begin) / vectorSize;
+	
+	const T k = _mm_set1<T, S>(_k);
+	const T four = _mm_set1<T, S>(4);
+	
+	for (int i = 0, y = begin; i < numVectors; ++i, y += vectorSize)
+	{
+		const T pt =
+			_mm_loadu<T>(pU + y) +
+			_mm_loadu<T>(pC + y - 1) +
+			_mm_loadu<T>(pC + y + 1) +
+			_mm_loadu<T>(pD + y);
+		
+		const T a = (pt - _mm_loadu<T>(pC + y) * four) * k;
+		
+		_mm_storeu<T>(v + y, _mm_loadu<T>(v + y) + a * _mm_loadu<T>(f + y));
+	}
+	
+	return begin + numVectors * vectorSize;
+}
+
+#endif
+
+inline int tickForcesRowVectorized(const float * __restrict pU, const float * __restrict pC, const float * __restrict pD, float * __restrict v, const float * __restrict f, const float k, const int begin, const int end)
+{
+#if AUDIO_USE_SSE && __AVX__
+	return tickForcesRow<__m256, float>(pU, pC, pD, v, f, k, begin, end);
+#elif AUDIO_USE_SSE
+	return tickForcesRow<__m128, float>(pU, pC, pD, v, f, k, begin, end);
+#elif AUDIO_USE_NEON
+	return tickForcesRow<float32x4_t, float>(pU, pC, pD, v, f, k, begin, end);
+#else
+	return begin;
+#endif
+}
+
+inline int tickForcesRowVectorized(const double * __restrict pU, const double * __restrict pC, const double * __restrict pD, double * __restrict v, const double * __restrict f, const double k, const int begin, const int end)
+{
+#if AUDIO_USE_SSE && __AVX__
+	return tickForcesRow<__m256d, double>(pU, pC, pD, v, f, k, begin, end);
+#elif AUDIO_USE_SSE
+	return tickForcesRow<__m128d, double>(pU, pC, pD, v, f, k, begin, end);
+#else
+	return begin;
+#endif
+}
+
+template <typename S>
+inline void tickForcesRowScalar(const S * __restrict pU, const S * __restrict pC, const S * __restrict pD, S * __restrict v, const S * __restrict f, const S k, const int begin, const int end)
+{
+	for (int y = begin; y < end; ++y)
+	{
+		const S pt = pU[y] + pC[y - 1] + pC[y + 1] + pD[y];
+		
+		const S a = (pt - pC[y] * S(4)) * k;
+		
+		v[y] += a * f[y];
+	}
+}
+
+template <typename S, int kMaxElems>
+static void tickForces2D(const S (*p)[kMaxElems], S (*v)[kMaxElems], const S (*f)[kMaxElems], const int numElems, const S cTimesDtTimesOneQuarter, const bool closedEnds)
+{
+	const int sx = numElems;
+	const int sy = numElems;
+	
+	for (int x = 0; x < sx; ++x)
+	{
+		int x0, x2;
+		
+		if (closedEnds)
+		{
+			x0 = x > 0      ? x - 1 : 0;
+			x2 = x < sx - 1 ? x + 1 : sx - 1;
+		}
+		else
+		{
+			x0 = x == 0 ? sx - 1 : x - 1;
+			x2 = x == sx - 1 ? 0 : x + 1;
+		}
+		
+		const S * __restrict pU = p[x0];
+		const S * __restrict pC = p[x];
+		const S * __restrict pD = p[x2];
+		
+		// the first and last element in each row wrap around or clamp their horizontal neighbours
+		
+		for (int y = 0; y < sy; y += std::max(1, sy - 1))
+		{
+			int y0, y2;
+			
+			if (closedEnds)
+			{
+				y0 = y > 0      ? y - 1 : 0;
+				y2 = y < sy - 1 ? y + 1 : sy - 1;
+			}
+			else
+			{
+				y0 = y == 0 ? sy - 1 : y - 1;
+				y2 = y == sy - 1 ? 0 : y + 1;
+			}
+			
+			const S pt = pU[y] + pC[y0] + pC[y2] + pD[y];
+			
+			const S a = (pt - pC[y] * S(4)) * cTimesDtTimesOneQuarter;
+			
+			v[x][y] += a * f[x][y];
+		}
+		
+		// the remaining elements have both of their horizontal neighbours inside the row
+		
+		const int begin = tickForcesRowVectorized(pU, pC, pD, v[x], f[x], cTimesDtTimesOneQuarter, 1, sy - 1);
+		
+		tickForcesRowScalar<S>(pU, pC, pD, v[x], f[x], cTimesDtTimesOneQuarter, begin, sy - 1);
+	}
+}
+
+//
+
 const int Wavefield2D::kMaxElems;
 
 Wavefield2D::Wavefield2D()
@@ -766,79 +931,7 @@ void Wavefield2D::tickForces(const double dt, const double c, const bool closedE
 {
 	const double cTimesDtTimesOneQuarter = c * dt * 0.25; // times 0.25 because we're adding four spring forces
 	
-	const int sx = numElems;
-	const int sy = numElems;
-	
-	for (int x = 0; x < sx; ++x)
-	{
-		int x0, x1, x2;
-		
-		if (closedEnds)
-		{
-			x0 = x > 0      ? x - 1 : 0;
-			x1 = x;
-			x2 = x < sx - 1 ? x + 1 : sx - 1;
-		}
-		else
-		{
-			x0 = x == 0 ? sx - 1 : x - 1;
-			x1 = x;
-			x2 = x == sx - 1 ? 0 : x + 1;
-		}
-		
-		for (int y = 0; y < sy; ++y)
-		{
-			const double pMid = p[x][y];
-			
-			int y0, y1, y2;
-			
-			if (closedEnds)
-			{
-				y0 = y > 0      ? y - 1 : 0;
-				y1 = y;
-				y2 = y < sy - 1 ? y + 1 : sy - 1;
-			}
-			else
-			{
-				y0 = y == 0 ? sy - 1 : y - 1;
-				y1 = y;
-				y2 = y == sy - 1 ? 0 : y + 1;
-			}
-			
-			double pt = 0.0;
-			
-		#if 0
-			pt += p[x0][y0];
-			pt += p[x1][y0];
-			pt += p[x2][y0];
-			pt += p[x0][y1];
-			pt += p[x2][y1];
-			pt += p[x0][y2];
-			pt += p[x1][y2];
-			pt += p[x2][y2];
-			
-			const double d = pt - pMid * 8.0;
-		#elif 0
-			pt += p[x0][y0];
-			pt += p[x2][y0];
-			pt += p[x0][y2];
-			pt += p[x2][y2];
-			
-			const double d = pt - pMid * 16.0;
-		#else
-			pt += p[x0][y1];
-			pt += p[x1][y0];
-			pt += p[x1][y2];
-			pt += p[x2][y1];
-			
-			const double d = pt - pMid * 4.0;
-		#endif
-			
-			const double a = d * cTimesDtTimesOneQuarter;
-			
-			v[x][y] += a * f[x][y];
-		}
-	}
+	tickForces2D<double, kMaxElems>(p, v, f, numElems, cTimesDtTimesOneQuarter, closedEnds);
 }
 
 void Wavefield2D::tickVelocity(const double dt, const double vRetainPerSecond, const double pRetainPerSecond)
@@ -1044,6 +1137,7 @@ void Wavefield2D::copyFrom(const Wavefield2D & other, const bool copyP, const bo
 //
 
 const int Wavefield2Df::kMaxElems;
+const int Wavefield2Df::kArrayPadding;
 
 Wavefield2Df::Wavefield2Df()
 	: numElems(0)
@@ -1109,79 +1203,7 @@ void Wavefield2Df::tickForces(const float dt, const float c, const bool closedEn
 {
 	const float cTimesDtTimesOneQuarter = c * dt * .25f; // times 0.25 because we're adding four spring forces
 	
-	const int sx = numElems;
-	const int sy = numElems;
-	
-	for (int x = 0; x < sx; ++x)
-	{
-		int x0, x1, x2;
-		
-		if (closedEnds)
-		{
-			x0 = x > 0      ? x - 1 : 0;
-			x1 = x;
-			x2 = x < sx - 1 ? x + 1 : sx - 1;
-		}
-		else
-		{
-			x0 = x == 0 ? sx - 1 : x - 1;
-			x1 = x;
-			x2 = x == sx - 1 ? 0 : x + 1;
-		}
-		
-		for (int y = 0; y < sy; ++y)
-		{
-			const float pMid = p[x][y];
-			
-			int y0, y1, y2;
-			
-			if (closedEnds)
-			{
-				y0 = y > 0      ? y - 1 : 0;
-				y1 = y;
-				y2 = y < sy - 1 ? y + 1 : sy - 1;
-			}
-			else
-			{
-				y0 = y == 0 ? sy - 1 : y - 1;
-				y1 = y;
-				y2 = y == sy - 1 ? 0 : y + 1;
-			}
-			
-			float pt = 0.f;
-			
-		#if 0
-			pt += p[x0][y0];
-			pt += p[x1][y0];
-			pt += p[x2][y0];
-			pt += p[x0][y1];
-			pt += p[x2][y1];
-			pt += p[x0][y2];
-			pt += p[x1][y2];
-			pt += p[x2][y2];
-			
-			const float d = pt - pMid * 8.0;
-		#elif 0
-			pt += p[x0][y0];
-			pt += p[x2][y0];
-			pt += p[x0][y2];
-			pt += p[x2][y2];
-			
-			const float d = pt - pMid * 16.f;
-		#else
-			pt += p[x0][y1];
-			pt += p[x1][y0];
-			pt += p[x1][y2];
-			pt += p[x2][y1];
-			
-			const float d = pt - pMid * 4.f;
-		#endif
-			
-			const float a = d * cTimesDtTimesOneQuarter;
-			
-			v[x][y] += a * f[x][y];
-		}
-	}
+	tickForces2D<float, kMaxElems>(p, v, f, numElems, cTimesDtTimesOneQuarter, closedEnds);
 }
 
 void Wavefield2Df::tickVelocity(const float dt, const float vRetainPerSecond, const float pRetainPerSecond)
@@ -1341,7 +1363,7 @@ void Wavefield2Df::doGaussianImpact(const int spotX, const int spotY, const int
 	}
 }
 
-float Wavefield2Df::sample(const float x, const float y, const bool closedEnds) const
+static float sampleWavefield2Df(const float (*p)[Wavefield2Df::kMaxElems], const int numElems, const float x, const float y, const bool closedEnds)
 {
 	if (numElems == 0)
 	{
@@ -1390,6 +1412,11 @@ float Wavefield2Df::sample(const float x, const float y, const bool closedEnds)
 	}
 }
 
+float Wavefield2Df::sample(const float x, const float y, const bool closedEnds) const
+{
+	return sampleWavefield2Df(p, numElems, x, y, closedEnds);
+}
+
 void Wavefield2Df::copyFrom(const Wavefield2Df & other, const bool copyP, const bool copyV, const bool copyF)
 {
 	numElems = other.numElems;
@@ -1412,3 +1439,363 @@ void Wavefield2Df::copyFrom(const Wavefield2Df & other, const bool copyP, const
 			memcpy(f[x], other.f[x], numElems * sizeof(float));
 	}
 }
+
+//
+
+const int Wavefield2DfSimulator::kMaxStepsPerJob;
+
+#if AUDIO_USE_SSE || AUDIO_USE_NEON
+
+/**
+ * Integrates forces and velocities for the elements [begin, end) of a row in a single pass. Positions are read
+ * from the rows 'pU', 'pC' and 'pD' of the previous step and written to 'pOut'. Returns the index of the first
+ * element which wasn't processed.
+ */
+template <typename T>
+inline int tickRowFused(const float * __restrict pU, const float * __restrict pC, const float * __restrict pD, float * __restrict pOut, float * __restrict v, const float * __restrict f, float * __restrict d, const Wavefield2DfSimulator::Step & step, const int begin, const int end)
+{
+	const int vectorSize = sizeof(T) / sizeof(float);
+	
+	const int numVectors = (end - begin) / vectorSize;
+	
+	const T k = _mm_set1<T, float>(step.k);
+	const T four = _mm_set1<T, float>(4.f);
+	const T dt = _mm_set1<T, float>(step.dt);
+	const T vRetain = _mm_set1<T, float>(step.vRetain);
+	const T pRetain = _mm_set1<T, float>(step.pRetain);
+	const T dMin = _mm_set1<T, float>(step.dMin);
+	const T dMax = _mm_set1<T, float>(step.dMax);
+	
+	for (int i = 0, y = begin; i < numVectors; ++i, y += vectorSize)
+	{
+		const T p = _mm_loadu<T>(pC + y);
+		
+		const T pt =
+			_mm_loadu<T>(pU + y) +
+			_mm_loadu<T>(pC + y - 1) +
+			_mm_loadu<T>(pC + y + 1) +
+			_mm_loadu<T>(pD + y);
+		
+		const T a = (pt - p * four) * k;
+		
+		const T vNew = _mm_loadu<T>(v + y) + a * _mm_loadu<T>(f + y);
+		
+		const T dOld = _mm_loadu<T>(d + y);
+		const T d_clamped = _mm_clamp(dOld, dMin, dMax);
+		
+		_mm_storeu<T>(pOut + y, p * pRetain + vNew * dt + d_clamped);
+		_mm_storeu<T>(v + y, vNew * vRetain);
+		_mm_storeu<T>(d + y, dOld - d_clamped);
+	}
+	
+	return begin + numVectors * vectorSize;
+}
+
+#endif
+
+static inline void tickCellFused(const float pU, const float pL, const float pC, const float pR, const float pD, float & pOut, float & v, const float f, float & d, const Wavefield2DfSimulator::Step & step)
+{
+	const float pt = pU + pL + pR + pD;
+	
+	const float a = (pt - pC * 4.f) * step.k;
+	
+	const float vNew = v + a * f;
+	
+	const float d_clamped = std::max(std::min(d, step.dMax), step.dMin);
+	
+	pOut = pC * step.pRetain + vNew * step.dt + d_clamped;
+	v = vNew * step.vRetain;
+	d = d - d_clamped;
+}
+
+static inline void tickBorderCellFused(float & pOut, float & v, float & d, const Wavefield2DfSimulator::Step & step)
+{
+	// border elements are held at rest when the ends are closed. only impulses move them, for a single step
+	
+	const float d_clamped = std::max(std::min(d, step.dMax), step.dMin);
+	
+	pOut = d_clamped;
+	v = 0.f;
+	d = d - d_clamped;
+}
+
+static void tickRowFused(const float (*src)[Wavefield2Df::kMaxElems], float (*dst)[Wavefield2Df::kMaxElems], Wavefield2Df & w, const int x, const bool closedEnds, const Wavefield2DfSimulator::Step & step)
+{
+	const int sx = w.numElems;
+	const int sy = w.numElems;
+	
+	float * __restrict pOut = dst[x];
+	float * __restrict v = w.v[x];
+	const float * __restrict f = w.f[x];
+	float * __restrict d = w.d[x];
+	
+	if (closedEnds && (x == 0 || x == sx - 1))
+	{
+		for (int y = 0; y < sy; ++y)
+			tickBorderCellFused(pOut[y], v[y], d[y], step);
+		return;
+	}
+	
+	const int x0 = x == 0 ? sx - 1 : x - 1;
+	const int x2 = x == sx - 1 ? 0 : x + 1;
+	
+	const float * __restrict pU = src[x0];
+	const float * __restrict pC = src[x];
+	const float * __restrict pD = src[x2];
+	
+	// the first and last element in each row are either held at rest or wrap around
+	
+	for (int y = 0; y < sy; y += std::max(1, sy - 1))
+	{
+		if (closedEnds)
+		{
+			tickBorderCellFused(pOut[y], v[y], d[y], step);
+		}
+		else
+		{
+			const int y0 = y == 0 ? sy - 1 : y - 1;
+			const int y2 = y == sy - 1 ? 0 : y + 1;
+			
+			tickCellFused(pU[y], pC[y0], pC[y], pC[y2], pD[y], pOut[y], v[y], f[y], d[y], step);
+		}
+	}
+	
+	// the remaining elements have both of their horizontal neighbours inside the row
+	
+	int begin = 1;
+	
+#if AUDIO_USE_SSE && __AVX__
+	begin = tickRowFused<__m256>(pU, pC, pD, pOut, v, f, d, step, begin, sy - 1);
+#elif AUDIO_USE_SSE
+	begin = tickRowFused<__m128>(pU, pC, pD, pOut, v, f, d, step, begin, sy - 1);
+#elif AUDIO_USE_NEON
+	begin = tickRowFused<float32x4_t>(pU, pC, pD, pOut, v, f, d, step, begin, sy - 1);
+#endif
+	
+	for (int y = begin; y < sy - 1; ++y)
+		tickCellFused(pU[y], pC[y - 1], pC[y], pC[y + 1], pD[y], pOut[y], v[y], f[y], d[y], step);
+}
+
+Wavefield2DfSimulator::Wavefield2DfSimulator()
+	: numThreads(1)
+	, workers()
+	, wakeupMutex()
+	, wakeupCond()
+	, wakeupEpoch(0)
+	, stopRequested(false)
+	, barrierCount(0)
+	, barrierGeneration(0)
+	, pBackStorage(nullptr)
+	, pBack(nullptr)
+	, wavefield(nullptr)
+	, closedEnds(true)
+	, numSteps(0)
+	, sampleX(nullptr)
+	, sampleY(nullptr)
+	, samples(nullptr)
+{
+	// offset the back buffer from the arrays inside the wave field, for the same reason they are padded
+	
+	const int numElems = Wavefield2Df::kMaxElems * Wavefield2Df::kMaxElems;
+	const int offset = Wavefield2Df::kArrayPadding * 4;
+	
+	pBackStorage = new float[numElems + offset];
+	memset(pBackStorage, 0, (numElems + offset) * sizeof(float));
+	
+	pBack = (float(*)[Wavefield2Df::kMaxElems])(pBackStorage + offset);
+}
+
+Wavefield2DfSimulator::~Wavefield2DfSimulator()
+{
+	shut();
+	
+	delete [] pBackStorage;
+	pBackStorage = nullptr;
+	pBack = nullptr;
+}
+
+void Wavefield2DfSimulator::init(const int _numThreads)
+{
+	shut();
+	
+	numThreads = std::max(1, _numThreads);
+	
+	wakeupEpoch = 0;
+	stopRequested = false;
+	
+	for (int i = 1; i < numThreads; ++i)
+	{
+		Worker * worker = new Worker();
+		worker->simulator = this;
+		worker->index = i;
+		
+		workers.emplace_back(worker);
+	}
+	
+	for (auto & worker : workers)
+		worker->thread = std::thread(threadMain, worker.get());
+}
+
+void Wavefield2DfSimulator::shut()
+{
+	{
+		std::unique_lock<std::mutex> lock(wakeupMutex);
+		
+		stopRequested = true;
+	}
+	
+	wakeupCond.notify_all();
+	
+	for (auto & worker : workers)
+		worker->thread.join();
+	
+	workers.clear();
+	
+	numThreads = 1;
+}
+
+void Wavefield2DfSimulator::tick(
+	Wavefield2Df & in_wavefield,
+	const int in_numSteps,
+	const double in_dt,
+	const float * c,
+	const float * vRetainPerSecond,
+	const float * pRetainPerSecond,
+	const bool in_closedEnds,
+	const float * in_sampleX,
+	const float * in_sampleY,
+	float * in_samples)
+{
+	for (int offset = 0; offset < in_numSteps; offset += kMaxStepsPerJob)
+	{
+		// compute the per-step constants up front. they match the ones computed by Wavefield2Df::tick
+		
+		numSteps = std::min(kMaxStepsPerJob, in_numSteps - offset);
+		
+		for (int i = 0; i < numSteps; ++i)
+		{
+			const float forcesDt = in_dt * 1000.0;
+			const float forcesC = c[offset + i] / 1000.0;
+			
+			const float dt = in_dt;
+			
+			Step & step = steps[i];
+			step.k = forcesC * forcesDt * .25f;
+			step.dt = dt;
+			step.vRetain = std::pow(vRetainPerSecond[offset + i], dt);
+			step.pRetain = std::pow(pRetainPerSecond[offset + i], dt);
+			step.dMin = -MAX_IMPULSE_PER_SECOND * dt;
+			step.dMax = +MAX_IMPULSE_PER_SECOND * dt;
+		}
+		
+		wavefield = &in_wavefield;
+		closedEnds = in_closedEnds;
+		sampleX = in_samples == nullptr ? nullptr : in_sampleX + offset;
+		sampleY = in_samples == nullptr ? nullptr : in_sampleY + offset;
+		samples = in_samples == nullptr ? nullptr : in_samples + offset;
+		
+		if (numThreads > 1)
+		{
+			{
+				std::unique_lock<std::mutex> lock(wakeupMutex);
+				
+				wakeupEpoch++;
+			}
+			
+			wakeupCond.notify_all();
+		}
+		
+		runJob(0);
+	}
+	
+	wavefield = nullptr;
+}
+
+void Wavefield2DfSimulator::threadMain(Worker * worker)
+{
+	Wavefield2DfSimulator * simulator = worker->simulator;
+	
+	int64_t epoch = 0;
+	
+	for (;;)
+	{
+		{
+			std::unique_lock<std::mutex> lock(simulator->wakeupMutex);
+			
+			simulator->wakeupCond.wait(lock, [&]() { return simulator->stopRequested || simulator->wakeupEpoch != epoch; });
+			
+			if (simulator->stopRequested)
+				break;
+			
+			epoch = simulator->wakeupEpoch;
+		}
+		
+		simulator->runJob(worker->index);
+	}
+}
+
+void Wavefield2DfSimulator::runJob(const int threadIndex)
+{
+	SCOPED_FLUSH_DENORMALS;
+	
+	// copy the job description, as the calling thread may start setting up the next job as soon as it passes the final barrier
+	
+	Wavefield2Df & w = *wavefield;
+	const bool closedEnds = this->closedEnds;
+	const int numSteps = this->numSteps;
+	
+	const int numElems = w.numElems;
+	
+	const int rowBegin = numElems * (threadIndex + 0) / numThreads;
+	const int rowEnd   = numElems * (threadIndex + 1) / numThreads;
+	
+	for (int i = 0; i < numSteps; ++i)
+	{
+		// even steps read from the wave field and write to the back buffer. odd steps do the reverse
+		
+		const float (*src)[Wavefield2Df::kMaxElems] = (i & 1) ? pBack : w.p;
+		float (*dst)[Wavefield2Df::kMaxElems] = (i & 1) ? w.p : pBack;
+		
+		for (int x = rowBegin; x < rowEnd; ++x)
+			tickRowFused(src, dst, w, x, closedEnds, steps[i]);
+		
+		barrier();
+		
+		// the next step writes to the other buffer, so the calling thread can sample this one while the other threads continue
+		
+		if (threadIndex == 0 && samples != nullptr)
+			samples[i] = sampleWavefield2Df(dst, numElems, sampleX[i], sampleY[i], closedEnds);
+	}
+	
+	if (numSteps & 1)
+	{
+		for (int x = rowBegin; x < rowEnd; ++x)
+			memcpy(w.p[x], pBack[x], numElems * sizeof(float));
+		
+		barrier();
+	}
+}
+
+void Wavefield2DfSimulator::barrier()
+{
+	if (numThreads == 1)
+		return;
+	
+	const int generation = barrierGeneration.load(std::memory_order_acquire);
+	
+	if (barrierCount.fetch_add(1, std::memory_order_acq_rel) + 1 == numThreads)
+	{
+		barrierCount.store(0, std::memory_order_relaxed);
+		barrierGeneration.fetch_add(1, std::memory_order_release);
+	}
+	else
+	{
+		// the other threads are expected to arrive within microseconds, so spin for a while before yielding
+		
+		for (int i = 0; barrierGeneration.load(std::memory_order_acquire) == generation; ++i)
+		{
+			if (i >= 1000)
+				std::this_thread::yield();
+		}
+	}
+}
@@ -28,7 +28,13 @@
 #pragma once
 
 #include "audioTypes.h"
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
 #include <stddef.h>
+#include <thread>
+#include <vector>
 
 namespace Wavefield
 {
@@ -137,13 +143,20 @@ struct Wavefield2D
 
 struct Wavefield2Df
 {
-	static const int kMaxElems = 64;
+	static const int kMaxElems = 256;
+	static const int kArrayPadding = 40;
 	
 	int numElems;
 	
+	// the arrays are padded so that elements at the same index don't share the same offset modulo 4K. the simd
+	// kernels access all of them in lock step, and stores to one array would otherwise stall loads from the others
+	
 	ALIGN32 float p[kMaxElems][kMaxElems];
+	float pPadding[kArrayPadding];
 	ALIGN32 float v[kMaxElems][kMaxElems];
+	float vPadding[kArrayPadding];
 	ALIGN32 float f[kMaxElems][kMaxElems];
+	float fPadding[kArrayPadding];
 	ALIGN32 float d[kMaxElems][kMaxElems];
 	
 	AudioRNG rng;
@@ -168,3 +181,100 @@ struct Wavefield2Df
 	
 	ALIGNED_AUDIO_NEW_AND_DELETE();
 };
+
+//
+
+/**
+ * Wavefield2DfSimulator ticks a Wavefield2Df for a block of steps, splitting the grid into bands of rows which are
+ * processed in parallel by a team of threads. The calling thread participates as well. Forces and velocities are
+ * integrated in a single pass per row, reading the positions of the previous step from one buffer and writing the
+ * new positions into a second buffer, so the threads only need to synchronize once per step. The results are
+ * identical to calling Wavefield2Df::tick once per step.
+ *
+ * Usage example:
+ * ```cpp
+ * Wavefield2DfSimulator simulator;
+ * simulator.init(4);
+ *
+ * simulator.tick(wavefield, numSamples, 1.0 / SAMPLE_RATE, c, vRetainPerSecond, pRetainPerSecond, true, sampleX, sampleY, samples);
+ *
+ * simulator.shut();
+ * ```
+ */
+struct Wavefield2DfSimulator
+{
+	static const int kMaxStepsPerJob = 256;
+	
+	struct Step
+	{
+		float k;
+		float dt;
+		float vRetain;
+		float pRetain;
+		float dMin;
+		float dMax;
+	};
+	
+	struct Worker
+	{
+		Wavefield2DfSimulator * simulator = nullptr;
+		int index = 0;
+		
+		std::thread thread;
+	};
+	
+	int numThreads; ///< The total number of threads ticking the wave field, including the calling thread.
+	std::vector<std::unique_ptr<Worker>> workers;
+	
+	std::mutex wakeupMutex;
+	std::condition_variable wakeupCond;
+	int64_t wakeupEpoch;
+	bool stopRequested;
+	
+	std::atomic<int> barrierCount;
+	std::atomic<int> barrierGeneration;
+	
+	float * pBackStorage;
+	float (*pBack)[Wavefield2Df::kMaxElems]; ///< Second position buffer. Odd steps read from here and write to Wavefield2Df::p.
+	
+	// the current job
+	
+	Wavefield2Df * wavefield;
+	bool closedEnds;
+	int numSteps;
+	Step steps[kMaxStepsPerJob];
+	const float * sampleX;
+	const float * sampleY;
+	float * samples;
+	
+	Wavefield2DfSimulator();
+	~Wavefield2DfSimulator();
+	
+	void init(const int numThreads); ///< Creates 'numThreads - 1' worker threads. A value of one runs the simulation on the calling thread only.
+	void shut();
+	
+	int getNumThreads() const { return numThreads; }
+	
+	/**
+	 * Ticks the wave field 'numSteps' times. 'c', 'vRetainPerSecond' and 'pRetainPerSecond' contain the parameters
+	 * for each step. When 'samples' is set, the wave field is sampled after each step at the locations given by
+	 * 'sampleX' and 'sampleY', in element units.
+	 */
+	void tick(
+		Wavefield2Df & wavefield,
+		const int numSteps,
+		const double dt,
+		const float * c,
+		const float * vRetainPerSecond,
+		const float * pRetainPerSecond,
+		const bool closedEnds,
+		const float * sampleX,
+		const float * sampleY,
+		float * samples);
+	
+private:
+	static void threadMain(Worker * worker);
+	
+	void runJob(const int threadIndex);
+	void barrier();
+};
@@ -4964,6 +4964,10 @@ void GraphEdit::draw() const
 	if (state == kState_Hidden || (state == kState_HiddenIdle && hideTime == 0.f))
 		return;
 	
+	// note : the graph editor draws lots of small rects, lines and text. let the immediate mode batcher merge them into fewer draw calls
+	const bool batchingWasEnabled = gxGetBatchingEnabled();
+	gxSetBatchingEnabled(true);
+	
 	GRAPHEDIT_SX = displaySx;
 	GRAPHEDIT_SY = displaySy;
 	
@@ -5607,6 +5611,8 @@ void GraphEdit::draw() const
 	}
 	
 	popFontMode();
+	
+	gxSetBatchingEnabled(batchingWasEnabled);
 }
 
 void GraphEdit::drawNode(const GraphNode & node, const NodeData & nodeData, const Graph_TypeDefinition & definition, const char * displayName) const
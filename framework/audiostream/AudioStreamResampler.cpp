@@ -27,14 +27,32 @@
 
 #include "AudioStreamResampler.h"
 
-#define RESAMPLE_FIXEDBITS 32
-
 void AudioStreamResampler::SetSource(AudioStream * source, const int sourceRate, const int targetRate)
 {
 	mSource = source;
+	
+	// no need to resample when the rates match. just forward the samples from the source
+	
+	mPassthrough = (sourceRate == targetRate);
+	
+	mResampler.init(2, mQuality);
+	mResampler.setRatio(sourceRate / double(targetRate));
+	
+	// allocate the buffers up front, so we don't allocate memory on the audio thread
+	
+	const int maxInputFrames = mResampler.calculateNumInputFrames(kBlockSize) + 1;
+	
+	mSourceBuffer.resize(maxInputFrames);
+	mInputBuffer[0].resize(maxInputFrames);
+	mInputBuffer[1].resize(maxInputFrames);
+}
 
-	mBufferPosition_fp = 0;
-	mBufferIncrement_fp = (int64_t(sourceRate) << RESAMPLE_FIXEDBITS) / targetRate;
+void AudioStreamResampler::SetQuality(const ResampleQuality quality)
+{
+	mQuality = quality;
+	
+	mResampler.init(2, mQuality);
+	mResampler.setRatio(mResampler.getRatio());
 }
 
 int AudioStreamResampler::Provide(int numSamples, AudioSample* __restrict samples)
@@ -42,22 +60,68 @@ int AudioStreamResampler::Provide(int numSamples, AudioSample* __restrict sample
 	if (mSource == 0)
 		return 0;
 	
+	if (mPassthrough)
+		return mSource->Provide(numSamples, samples);
+	
 	int i = 0;
 	while (i < numSamples)
 	{
-		const int bufferPosition = mBufferPosition_fp >> RESAMPLE_FIXEDBITS;
-
-		if (bufferPosition >= mBufferSize)
+		const int numFrames = numSamples - i < kBlockSize ? numSamples - i : kBlockSize;
+		
+		const int numInputFrames = mResampler.calculateNumInputFrames(numFrames);
+		
+		if (numInputFrames > (int)mSourceBuffer.size())
 		{
-			mBufferSize = mSource->Provide(kBufferSize, mBuffer);
-			if (mBufferSize == 0)
-				break;
-			mBufferPosition_fp -= int64_t(bufferPosition) << RESAMPLE_FIXEDBITS;
-			continue;
+			mSourceBuffer.resize(numInputFrames);
+			mInputBuffer[0].resize(numInputFrames);
+			mInputBuffer[1].resize(numInputFrames);
 		}
-
-		samples[i++] = mBuffer[bufferPosition];
-		mBufferPosition_fp += mBufferIncrement_fp;
+		
+		// fetch source samples and convert them to planar floating point
+		
+		const int numSourceFrames = numInputFrames == 0 ? 0 : mSource->Provide(numInputFrames, mSourceBuffer.data());
+		
+		if (numSourceFrames == 0 && numInputFrames != 0)
+			break;
+		
+		float * __restrict input0 = mInputBuffer[0].data();
+		float * __restrict input1 = mInputBuffer[1].data();
+		
+		for (int j = 0; j < numSourceFrames; ++j)
+		{
+			input0[j] = mSourceBuffer[j].channel[0] * (1.f / 32768.f);
+			input1[j] = mSourceBuffer[j].channel[1] * (1.f / 32768.f);
+		}
+		
+		// note : when the source ends, we pad its output with silence, which lets the filter tail decay naturally
+		
+		for (int j = numSourceFrames; j < numInputFrames; ++j)
+		{
+			input0[j] = 0.f;
+			input1[j] = 0.f;
+		}
+		
+		const float * input[2] = { input0, input1 };
+		float * output[2] = { mOutputBuffer[0], mOutputBuffer[1] };
+		
+		mResampler.process(input, numInputFrames, output, numFrames);
+		
+		// convert the output back to 16 bit integer samples
+		
+		for (int j = 0; j < numFrames; ++j)
+		{
+			for (int c = 0; c < 2; ++c)
+			{
+				const float value = mOutputBuffer[c][j] * 32768.f;
+				
+				samples[i + j].channel[c] =
+					value <= -32768.f ? -32768 :
+					value >= +32767.f ? +32767 :
+					short(value + (value >= 0.f ? .5f : -.5f));
+			}
+		}
+		
+		i += numFrames;
 	}
 
 	return i;
@@ -28,20 +28,27 @@
 #pragma once
 
 #include "AudioStream.h"
+#include "PolyphaseResampler.h"
 #include <stdint.h>
+#include <vector>
 
 class AudioStreamResampler : public AudioStream
 {
-	static const int kBufferSize = 64;
+	static const int kBlockSize = 256;
 
 	AudioStream * mSource = nullptr;
-	AudioSample mBuffer[kBufferSize];
-	int mBufferSize = 0;
-	int64_t mBufferPosition_fp = 0;
-	int64_t mBufferIncrement_fp = 0;
+	ResampleQuality mQuality = kResampleQuality_Sinc32;
+	bool mPassthrough = false;
+	
+	PolyphaseResampler mResampler;
+	
+	std::vector<AudioSample> mSourceBuffer;
+	std::vector<float> mInputBuffer[2];
+	float mOutputBuffer[2][kBlockSize];
 
 public:
 	void SetSource(AudioStream * source, const int sourceRate, const int targetRate);
+	void SetQuality(const ResampleQuality quality);
 
 	virtual int Provide(int numSamples, AudioSample* __restrict samples) override;
 };
@@ -25,169 +25,134 @@
 	OTHER DEALINGS IN THE SOFTWARE.
 */
 
-#include <stdio.h>
+#include <math.h>
+#include <string.h>
 #include "AudioStreamVorbis.h"
 #include "Debugging.h"
 #include "Log.h"
-#include "oggvorbis.h"
+#include "VorbisDecodeService.h"
 
-static void DuplicateInPlace(short * buffer, int numSamples);
+static const int kSyncBufferSize = 1 << 12;
+
+static void ConvertToAudioSamples(const float * __restrict src, int numChannels, int numFrames, AudioSample * __restrict dst);
 
 AudioStream_Vorbis::AudioStream_Vorbis()
-	: mFile(0)
-	, mVorbisFile(0)
-	, mNumChannels(0)
-	, mSampleRate(0)
-	, mDuration(0)
+	: mStream(0)
+	, mDecodeAsync(false)
 	, mPosition(0)
 	, mLoop(false)
 	, mHasLooped(false)
 {
-	mVorbisFile = new OggVorbis_File();
 }
 
 AudioStream_Vorbis::~AudioStream_Vorbis()
 {
 	Close();
-	
-	delete mVorbisFile;
-	mVorbisFile = 0;
 }
 
 int AudioStream_Vorbis::Provide(int numSamples, AudioSample* __restrict buffer)
 {
-	if (mFile == 0)
+	mHasLooped = false;
+	
+	if (mStream == 0)
 		return 0;
 	
-	int bytesRemain = numSamples * sizeof(AudioSample);
-	int bytesRead = 0;
+	const int kChunkSize = 256;
 	
-	char* bytes = (char*)buffer;
+	float samples[kChunkSize * 2];
 	
-	mHasLooped = false;
+	const int numChannels = mStream->NumChannels_get();
+	
+	int numSamplesRead = 0;
 	
-	while (bytesRemain != 0)
+	while (numSamplesRead < numSamples)
 	{
-		const int bytesToRead = bytesRemain * mNumChannels / 2;
-		
-		int bitstream = -1;
-		
-		int currentBytesRead = (int)ov_read(
-			mVorbisFile,
-			bytes + bytesRead,
-			bytesToRead,
-			0,
-			2,
-			1,
-			&bitstream);	
+		const int numFrames = numSamples - numSamplesRead < kChunkSize ? numSamples - numSamplesRead : kChunkSize;
 		
-		if (currentBytesRead < 0)
+		if (mDecodeAsync == false)
 		{
-			currentBytesRead = 0;
+			while (mStream->NumFramesAvailable_get() < numFrames && mStream->Decode(kSyncBufferSize) > 0)
+			{
+			}
 		}
 		
-		if (mNumChannels == 1)
-		{
-			DuplicateInPlace((short*)(bytes + bytesRead), currentBytesRead / sizeof(short));
-			
-			currentBytesRead *= 2;
-		}
+		bool hasLooped;
+		bool hasEnded;
+		
+		const int numFramesRead = mStream->Read(samples, numFrames, hasLooped, hasEnded);
+		
+		ConvertToAudioSamples(samples, numChannels, numFramesRead, buffer + numSamplesRead);
+		
+		mHasLooped |= hasLooped;
 		
-		if (currentBytesRead == 0)
+		if (hasEnded)
 		{
-			// reached EOF
+			// we're done
 			
-			if (mLoop)
-			{
-				// not done yet!
-				
-				const std::string fileName = mFileName;
-				
-				Close();
-				
-				Open(fileName.c_str(), mLoop);
-				
-				mHasLooped = true;
-			}
-			else
-			{
-				// we're done
-				
-				break;
-			}
+			numSamplesRead += numFramesRead;
+			
+			break;
 		}
 		else
 		{
-			Assert(currentBytesRead <= bytesRemain);
+			// note : when we run out of decoded samples before reaching the end of the stream, we output silence
+			
+			memset(buffer + numSamplesRead + numFramesRead, 0, (numFrames - numFramesRead) * sizeof(AudioSample));
 			
-			bytesRemain -= currentBytesRead;
-			bytesRead += currentBytesRead;
+			numSamplesRead += numFrames;
 		}
-		
 	}
 	
-	Assert((bytesRead % sizeof(AudioSample)) == 0);
-	
-	const int numReadSamples = bytesRead / sizeof(AudioSample);
+	mPosition = mStream->Position_get();
 	
-	mPosition += numReadSamples;
-	
-	return numReadSamples;
+	return numSamplesRead;
 }
 
-void AudioStream_Vorbis::Open(const char* fileName, bool loop)
+void AudioStream_Vorbis::Open(const char* fileName, bool loop, bool decodeAsync)
 {
 	Close();
 
 	mFileName = fileName;
 	mLoop = loop;
+	mDecodeAsync = decodeAsync;
 	
-	mFile = fopen(mFileName.c_str(), "rb");
-	
-	if (mFile == 0)
+	if (mDecodeAsync)
 	{
-		LOG_ERR("Vorbis Audio Stream: failed to open file (%s)", fileName);
-		Close();
-		return;
+		mStream = GetVorbisDecodeService().OpenStream(mFileName.c_str(), mLoop);
+	}
+	else
+	{
+		mStream = new VorbisDecodeStream();
+		
+		if (!mStream->Open(mFileName.c_str(), mLoop, kSyncBufferSize))
+		{
+			delete mStream;
+			mStream = 0;
+		}
 	}
 	
-	LOG_DBG("Vorbis Audio Stream: opened file: %s", mFileName.c_str());
-	
-	int result = ov_open(mFile, mVorbisFile, NULL, 0);
-	if (result != 0)
+	if (mStream == 0)
 	{
-		LOG_ERR("Vorbis Audio Stream: failed to create vorbis decoder (%d)", result);
+		LOG_ERR("Vorbis Audio Stream: failed to open file (%s)", fileName);
 		Close();
 		return;
 	}
 	
-	LOG_DBG("Vorbis Audio Stream: created vorbis decoder");
-	
-	vorbis_info* info = ov_info(mVorbisFile, -1);
-	
-	mNumChannels = info->channels;
-	mSampleRate = static_cast<int>(info->rate);
-	mDuration = ov_pcm_total(mVorbisFile, -1);
-	
-	LOG_DBG("Vorbis Audio Stream: channelCount=%d, sampleRate=%d", mNumChannels, mSampleRate);
+	LOG_DBG("Vorbis Audio Stream: channelCount=%d, sampleRate=%d", mStream->NumChannels_get(), mStream->SampleRate_get());
 }
 
 void AudioStream_Vorbis::Close()
 {
-	if (mVorbisFile->datasource != 0)
+	if (mStream != 0)
 	{
-		ov_clear(mVorbisFile);
-		LOG_DBG("Vorbis Audio Stream: destroyed vorbis decoder");
+		if (mDecodeAsync)
+			GetVorbisDecodeService().CloseStream(mStream);
+		else
+		{
+			delete mStream;
+			mStream = 0;
+		}
 		
-		// note : ov_clear calls fclose for us
-		mFile = 0;
-		LOG_DBG("Vorbis Audio Stream: closed file");
-	}
-	
-	if (mFile != 0)
-	{
-		fclose(mFile);
-		mFile = 0;
 		LOG_DBG("Vorbis Audio Stream: closed file");
 	}
 	
@@ -195,19 +160,47 @@ void AudioStream_Vorbis::Close()
 	mPosition = 0;
 }
 
+int32_t AudioStream_Vorbis::SampleRate_get() const
+{
+	return mStream != 0 ? mStream->SampleRate_get() : 0;
+}
+
+int64_t AudioStream_Vorbis::Duration_get() const
+{
+	return mStream != 0 ? mStream->Duration_get() : 0;
+}
+
+int AudioStream_Vorbis::NumUnderruns_get() const
+{
+	return mStream != 0 ? mStream->NumUnderruns_get() : 0;
+}
+
 //
 
-static void DuplicateInPlace(short * buffer, int numFrames)
+static short ConvertToShort(const float value)
 {
-	short * src = buffer + (numFrames - 1) * 1;
-	short * dst = buffer + (numFrames - 1) * 2;
+	const int result = (int)floorf(value * 32768.f + .5f);
 	
-	for (int i = 0; i < numFrames; ++i)
+	return result < -32768 ? -32768 : result > 32767 ? 32767 : result;
+}
+
+static void ConvertToAudioSamples(const float * __restrict src, int numChannels, int numFrames, AudioSample * __restrict dst)
+{
+	if (numChannels == 1)
+	{
+		for (int i = 0; i < numFrames; ++i)
+		{
+			const short value = ConvertToShort(src[i]);
+			dst[i].channel[0] = value;
+			dst[i].channel[1] = value;
+		}
+	}
+	else
 	{
-		const short value = src[0];
-		dst[0] = value;
-		dst[1] = value;
-		src -= 1;
-		dst -= 2;
+		for (int i = 0; i < numFrames; ++i)
+		{
+			dst[i].channel[0] = ConvertToShort(src[i * 2 + 0]);
+			dst[i].channel[1] = ConvertToShort(src[i * 2 + 1]);
+		}
 	}
 }
@@ -28,9 +28,10 @@
 #pragma once
 
 #include "AudioStream.h"
-#include <stdio.h> // FILE
 #include <string>
 
+class VorbisDecodeStream;
+
 class AudioStream_Vorbis : public AudioStream
 {
 public:
@@ -39,26 +40,29 @@ public:
 	
 	virtual int Provide(int numSamples, AudioSample* __restrict buffer);
 	
-	void Open(const char* fileName, bool loop);
+	// when decodeAsync is set, decoding is done by the Vorbis decode service and Provide only copies already decoded
+	// samples. otherwise decoding happens inside Provide, which is what you want when reading an entire file at once.
+	// note : Open opens the file, parses the header and prefetches the first couple of frames on the calling thread,
+	//        so the sample rate and duration are known when it returns. it must not be called from the audio thread
+	void Open(const char* fileName, bool loop, bool decodeAsync = true);
 	void Close();
 	
-	int32_t SampleRate_get() const { return mSampleRate; }
-	int64_t Duration_get() const { return mDuration; }
+	int32_t SampleRate_get() const;
+	int64_t Duration_get() const;
 	
 	int64_t Position_get() const { return mPosition; }
 	bool HasLooped_get() const { return mHasLooped; }
+	
+	int NumUnderruns_get() const;
 
-	bool IsOpen_get() const { return mFile != 0; }
+	bool IsOpen_get() const { return mStream != 0; }
 	const char * FileName_get() const { return mFileName.c_str(); }
 	bool Loop_get() const { return mLoop; }
 	
 private:
 	std::string mFileName;
-	FILE* mFile;
-	struct OggVorbis_File* mVorbisFile;
-	int16_t mNumChannels;
-	int32_t mSampleRate;
-	int64_t mDuration;
+	VorbisDecodeStream* mStream;
+	bool mDecodeAsync;
 	int64_t mPosition;
 	bool mLoop;
 	bool mHasLooped;
@@ -0,0 +1,619 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "Log.h"
+#include "Multicore/ThreadName.h"
+#include "oggvorbis.h"
+#include "VorbisDecodeService.h"
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <stdio.h>
+#include <string.h>
+
+VorbisDecodeStream::VorbisDecodeStream()
+	: mFileName()
+	, mLoop(false)
+	, mVorbisFile(nullptr)
+	, mDecodeDone(false)
+	, mFramesSinceLoop(0)
+	, mNumChannels(0)
+	, mSampleRate(0)
+	, mDuration(0)
+	, mState(kState_Closed)
+	, mBuffer(nullptr)
+	, mBufferSize(0)
+	, mBufferMask(0)
+	, mWritePosition(0)
+	, mReadPosition(0)
+	, mEndPosition(std::numeric_limits<int64_t>::max())
+	, mLoopMarkerWriteIndex(0)
+	, mLoopMarkerReadIndex(0)
+	, mLoopStartPosition(0)
+	, mNumUnderruns(0)
+	, mNumUnderrunFrames(0)
+	, mIsBusy(false)
+	, mIsClosing(false)
+{
+}
+
+VorbisDecodeStream::~VorbisDecodeStream()
+{
+	Close();
+}
+
+bool VorbisDecodeStream::Open(const char * fileName, bool loop, int bufferSize, int prefetchSize)
+{
+	const std::string fileNameCopy = fileName;
+	
+	// note : we don't call Close here, as it would publish the closed state while the stream is being opened asynchronously
+	
+	Free();
+	
+	mFileName = fileNameCopy;
+	mLoop = loop;
+	
+	FILE * file = fopen(mFileName.c_str(), "rb");
+	
+	if (file == nullptr)
+	{
+		LOG_ERR("Vorbis Decode Stream: failed to open file (%s)", mFileName.c_str());
+		mState.store(kState_Failed, std::memory_order_release);
+		return false;
+	}
+	
+	mVorbisFile = new OggVorbis_File();
+	
+	const int result = ov_open(file, mVorbisFile, NULL, 0);
+	
+	if (result != 0)
+	{
+		LOG_ERR("Vorbis Decode Stream: failed to create vorbis decoder (%d)", result);
+		delete mVorbisFile;
+		mVorbisFile = nullptr;
+		fclose(file);
+		mState.store(kState_Failed, std::memory_order_release);
+		return false;
+	}
+	
+	const vorbis_info * info = ov_info(mVorbisFile, -1);
+	
+	mNumChannels = info->channels;
+	mSampleRate = static_cast<int>(info->rate);
+	mDuration = ov_pcm_total(mVorbisFile, -1);
+	
+	LOG_DBG("Vorbis Decode Stream: opened %s. channelCount=%d, sampleRate=%d", mFileName.c_str(), mNumChannels, mSampleRate);
+	
+	if (mNumChannels != 1 && mNumChannels != 2)
+	{
+		LOG_ERR("Vorbis Decode Stream: channel count is not supported (%d)", mNumChannels);
+		Free();
+		mState.store(kState_Failed, std::memory_order_release);
+		return false;
+	}
+	
+	// round the buffer size up to a power of two, so ring buffer positions can be wrapped using a mask
+	
+	mBufferSize = 1;
+	while (mBufferSize < bufferSize)
+		mBufferSize <<= 1;
+	mBufferMask = mBufferSize - 1;
+	mBuffer = new float[mBufferSize * mNumChannels];
+	
+	mDecodeDone = false;
+	mFramesSinceLoop = 0;
+	
+	mWritePosition.store(0, std::memory_order_relaxed);
+	mReadPosition.store(0, std::memory_order_relaxed);
+	mEndPosition.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+	mLoopMarkerWriteIndex.store(0, std::memory_order_relaxed);
+	mLoopMarkerReadIndex.store(0, std::memory_order_relaxed);
+	mLoopStartPosition = 0;
+	
+	// prefetch before publishing the open state, so the consumer doesn't start reading from an empty buffer
+	
+	if (prefetchSize > 0)
+		Decode(prefetchSize);
+	
+	mState.store(kState_Open, std::memory_order_release);
+	
+	return true;
+}
+
+void VorbisDecodeStream::Close()
+{
+	mState.store(kState_Closed, std::memory_order_release);
+	
+	Free();
+}
+
+void VorbisDecodeStream::Free()
+{
+	if (mVorbisFile != nullptr)
+	{
+		// note : ov_clear calls fclose for us
+		ov_clear(mVorbisFile);
+		delete mVorbisFile;
+		mVorbisFile = nullptr;
+	}
+	
+	delete [] mBuffer;
+	mBuffer = nullptr;
+	mBufferSize = 0;
+	mBufferMask = 0;
+	
+	mNumChannels = 0;
+	mSampleRate = 0;
+	mDuration = 0;
+	
+	mDecodeDone = true;
+}
+
+int VorbisDecodeStream::Decode(const int maxFrames)
+{
+	if (mDecodeDone)
+		return 0;
+	
+	const int64_t writePosition = mWritePosition.load(std::memory_order_relaxed);
+	const int64_t readPosition = mReadPosition.load(std::memory_order_acquire);
+	
+	const int numFrames = std::min(maxFrames, mBufferSize - int(writePosition - readPosition));
+	
+	int numDecoded = 0;
+	
+	while (numDecoded < numFrames)
+	{
+		float ** channels = nullptr;
+		int bitstream = -1;
+		
+		const int numRead = (int)ov_read_float(mVorbisFile, &channels, numFrames - numDecoded, &bitstream);
+		
+		if (numRead == OV_HOLE)
+		{
+			// an interruption in the data. decoding can continue right after it
+			
+			continue;
+		}
+		
+		if (numRead <= 0)
+		{
+			// reached EOF or an unrecoverable error
+			
+			if (mLoop && numRead == 0 && mFramesSinceLoop > 0)
+			{
+				const int writeIndex = mLoopMarkerWriteIndex.load(std::memory_order_relaxed);
+				const int readIndex = mLoopMarkerReadIndex.load(std::memory_order_acquire);
+				
+				if (writeIndex - readIndex == kMaxLoopMarkers)
+				{
+					// the consumer hasn't caught up with our previous loops yet. try again later
+					
+					break;
+				}
+				
+				if (ov_pcm_seek(mVorbisFile, 0) == 0)
+				{
+					mLoopMarkers[writeIndex % kMaxLoopMarkers] = writePosition + numDecoded;
+					mLoopMarkerWriteIndex.store(writeIndex + 1, std::memory_order_release);
+					
+					mFramesSinceLoop = 0;
+					
+					continue;
+				}
+			}
+			
+			mDecodeDone = true;
+			
+			break;
+		}
+		
+		// copy the decoded frames into the ring buffer, splitting the copy where the buffer wraps around
+		
+		const int offset = int((writePosition + numDecoded) & mBufferMask);
+		const int numFrames1 = std::min(numRead, mBufferSize - offset);
+		
+		if (mNumChannels == 1)
+		{
+			memcpy(mBuffer + offset, channels[0], numFrames1 * sizeof(float));
+			memcpy(mBuffer, channels[0] + numFrames1, (numRead - numFrames1) * sizeof(float));
+		}
+		else
+		{
+			const float * __restrict channel1 = channels[0];
+			const float * __restrict channel2 = channels[1];
+			
+			float * __restrict dst1 = mBuffer + offset * 2;
+			
+			for (int i = 0; i < numFrames1; ++i)
+			{
+				dst1[i * 2 + 0] = channel1[i];
+				dst1[i * 2 + 1] = channel2[i];
+			}
+			
+			float * __restrict dst2 = mBuffer - numFrames1 * 2;
+			
+			for (int i = numFrames1; i < numRead; ++i)
+			{
+				dst2[i * 2 + 0] = channel1[i];
+				dst2[i * 2 + 1] = channel2[i];
+			}
+		}
+		
+		numDecoded += numRead;
+		
+		mFramesSinceLoop += numRead;
+	}
+	
+	mWritePosition.store(writePosition + numDecoded, std::memory_order_release);
+	
+	// note : the end position is published after the write position, so a consumer which sees it also sees all of the frames before it
+	
+	if (mDecodeDone)
+		mEndPosition.store(writePosition + numDecoded, std::memory_order_release);
+	
+	return numDecoded;
+}
+
+bool VorbisDecodeStream::NeedsDecode(const int minFrames) const
+{
+	if (mDecodeDone)
+		return false;
+	
+	const int64_t writePosition = mWritePosition.load(std::memory_order_relaxed);
+	const int64_t readPosition = mReadPosition.load(std::memory_order_acquire);
+	
+	if (mBufferSize - int(writePosition - readPosition) < minFrames)
+		return false;
+	
+	// when looping (very) short files, we may be waiting for the consumer to catch up with our loop markers
+	
+	const int writeIndex = mLoopMarkerWriteIndex.load(std::memory_order_relaxed);
+	const int readIndex = mLoopMarkerReadIndex.load(std::memory_order_acquire);
+	
+	return writeIndex - readIndex < kMaxLoopMarkers;
+}
+
+int VorbisDecodeStream::Read(float * __restrict samples, const int numFrames, bool & hasLooped, bool & hasEnded)
+{
+	hasLooped = false;
+	hasEnded = false;
+	
+	const int state = mState.load(std::memory_order_acquire);
+	
+	if (state != kState_Open)
+	{
+		hasEnded = (state == kState_Failed);
+		return 0;
+	}
+	
+	const int64_t endPosition = mEndPosition.load(std::memory_order_acquire);
+	const int64_t writePosition = mWritePosition.load(std::memory_order_acquire);
+	const int64_t readPosition = mReadPosition.load(std::memory_order_relaxed);
+	
+	const int numRead = std::min(numFrames, int(writePosition - readPosition));
+	
+	// copy the decoded frames from the ring buffer
+	
+	const int offset = int(readPosition & mBufferMask);
+	const int numFrames1 = std::min(numRead, mBufferSize - offset);
+	
+	memcpy(samples, mBuffer + offset * mNumChannels, numFrames1 * mNumChannels * sizeof(float));
+	memcpy(samples + numFrames1 * mNumChannels, mBuffer, (numRead - numFrames1) * mNumChannels * sizeof(float));
+	
+	if (numRead < numFrames)
+	{
+		memset(samples + numRead * mNumChannels, 0, (numFrames - numRead) * mNumChannels * sizeof(float));
+		
+		if (readPosition + numRead < endPosition)
+		{
+			mNumUnderruns.fetch_add(1, std::memory_order_relaxed);
+			mNumUnderrunFrames.fetch_add(numFrames - numRead, std::memory_order_relaxed);
+		}
+	}
+	
+	hasEnded = (readPosition + numRead >= endPosition);
+	
+	// process loop markers which fall within the range of frames we just read
+	
+	const int writeIndex = mLoopMarkerWriteIndex.load(std::memory_order_acquire);
+	int readIndex = mLoopMarkerReadIndex.load(std::memory_order_relaxed);
+	
+	while (readIndex != writeIndex && mLoopMarkers[readIndex % kMaxLoopMarkers] < readPosition + numRead)
+	{
+		mLoopStartPosition = mLoopMarkers[readIndex % kMaxLoopMarkers];
+		readIndex++;
+		
+		hasLooped = true;
+	}
+	
+	mLoopMarkerReadIndex.store(readIndex, std::memory_order_release);
+	
+	mReadPosition.store(readPosition + numRead, std::memory_order_release);
+	
+	return numRead;
+}
+
+int VorbisDecodeStream::NumFramesAvailable_get() const
+{
+	const int64_t writePosition = mWritePosition.load(std::memory_order_acquire);
+	const int64_t readPosition = mReadPosition.load(std::memory_order_relaxed);
+	
+	return int(writePosition - readPosition);
+}
+
+//
+
+VorbisDecodeService::VorbisDecodeService()
+	: mSettings()
+	, mStreams()
+	, mThreads()
+	, mMutex()
+	, mCondition()
+	, mStop(false)
+	, mNumRetiredUnderruns(0)
+	, mNumRetiredUnderrunFrames(0)
+	, mNumDecodedFrames(0)
+{
+}
+
+VorbisDecodeService::~VorbisDecodeService()
+{
+	Shut();
+}
+
+void VorbisDecodeService::Init(const Settings & settings)
+{
+	Shut();
+	
+	Assert(settings.numThreads >= 1);
+	Assert(settings.refillThreshold <= settings.bufferSize);
+	
+	mSettings = settings;
+}
+
+void VorbisDecodeService::Shut()
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		mStop = true;
+	}
+	
+	mCondition.notify_all();
+	
+	for (auto & thread : mThreads)
+		thread.join();
+	mThreads.clear();
+	
+	mStop = false;
+	
+	// note : streams which are still open remain registered. they are decoded again once the service is restarted
+}
+
+VorbisDecodeStream * VorbisDecodeService::OpenStream(const char * fileName, bool loop)
+{
+	VorbisDecodeStream * stream = new VorbisDecodeStream();
+	
+	// note : the stream is prefetched on the calling thread, so it's ready for playback as soon as we return
+	
+	if (!stream->Open(fileName, loop, mSettings.bufferSize, mSettings.prefetchSize))
+	{
+		delete stream;
+		return nullptr;
+	}
+	
+	mNumDecodedFrames.fetch_add(stream->NumFramesAvailable_get(), std::memory_order_relaxed);
+	
+	AddStream(stream);
+	
+	return stream;
+}
+
+VorbisDecodeStream * VorbisDecodeService::OpenStreamAsync(const char * fileName, bool loop)
+{
+	VorbisDecodeStream * stream = new VorbisDecodeStream();
+	
+	stream->mFileName = fileName;
+	stream->mLoop = loop;
+	stream->mState.store(VorbisDecodeStream::kState_Opening, std::memory_order_release);
+	
+	AddStream(stream);
+	
+	return stream;
+}
+
+void VorbisDecodeService::CloseStream(VorbisDecodeStream *& stream)
+{
+	if (stream == nullptr)
+		return;
+	
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		
+		if (stream->mIsBusy)
+		{
+			// a decode thread is working on the stream. it will retire the stream once it's done with it
+			
+			stream->mIsClosing = true;
+		}
+		else
+		{
+			RetireStream(stream);
+		}
+	}
+	
+	stream = nullptr;
+}
+
+VorbisDecodeService::Stats VorbisDecodeService::GetStats()
+{
+	std::lock_guard<std::mutex> lock(mMutex);
+	
+	Stats stats;
+	stats.numStreams = (int)mStreams.size();
+	stats.numUnderruns = mNumRetiredUnderruns;
+	stats.numUnderrunFrames = mNumRetiredUnderrunFrames;
+	stats.numDecodedFrames = mNumDecodedFrames.load(std::memory_order_relaxed);
+	
+	for (auto * stream : mStreams)
+	{
+		stats.numUnderruns += stream->NumUnderruns_get();
+		stats.numUnderrunFrames += stream->NumUnderrunFrames_get();
+	}
+	
+	return stats;
+}
+
+void VorbisDecodeService::AddStream(VorbisDecodeStream * stream)
+{
+	{
+		std::lock_guard<std::mutex> lock(mMutex);
+		
+		mStreams.push_back(stream);
+		
+		// start the decode threads on demand, so applications which never stream any Vorbis files don't pay for them
+		
+		while ((int)mThreads.size() < mSettings.numThreads)
+			mThreads.emplace_back([this]() { ThreadMain(); });
+	}
+	
+	mCondition.notify_one();
+}
+
+VorbisDecodeStream * VorbisDecodeService::ClaimStream()
+{
+	// pick the stream which is most at risk of running out of decoded frames
+	
+	VorbisDecodeStream * result = nullptr;
+	int resultNumFramesAvailable = 0;
+	
+	for (auto * stream : mStreams)
+	{
+		if (stream->mIsBusy)
+			continue;
+		
+		const int state = stream->mState.load(std::memory_order_relaxed);
+		
+		if (state == VorbisDecodeStream::kState_Opening)
+		{
+			// streams which still need to be opened come first
+			
+			result = stream;
+			break;
+		}
+		
+		if (state != VorbisDecodeStream::kState_Open || stream->NeedsDecode(mSettings.refillThreshold) == false)
+			continue;
+		
+		const int numFramesAvailable = stream->NumFramesAvailable_get();
+		
+		if (result == nullptr || numFramesAvailable < resultNumFramesAvailable)
+		{
+			result = stream;
+			resultNumFramesAvailable = numFramesAvailable;
+		}
+	}
+	
+	if (result != nullptr)
+		result->mIsBusy = true;
+	
+	return result;
+}
+
+void VorbisDecodeService::ReleaseStream(VorbisDecodeStream * stream)
+{
+	stream->mIsBusy = false;
+	
+	if (stream->mIsClosing)
+		RetireStream(stream);
+}
+
+void VorbisDecodeService::RetireStream(VorbisDecodeStream * stream)
+{
+	auto i = std::find(mStreams.begin(), mStreams.end(), stream);
+	
+	if (i != mStreams.end())
+	{
+		mStreams.erase(i);
+		
+		mNumRetiredUnderruns += stream->NumUnderruns_get();
+		mNumRetiredUnderrunFrames += stream->NumUnderrunFrames_get();
+	}
+	
+	delete stream;
+}
+
+void VorbisDecodeService::ThreadMain()
+{
+	SetCurrentThreadName("Vorbis Decode");
+	
+	std::unique_lock<std::mutex> lock(mMutex);
+	
+	while (mStop == false)
+	{
+		VorbisDecodeStream * stream = ClaimStream();
+		
+		if (stream == nullptr)
+		{
+			mCondition.wait_for(lock, std::chrono::milliseconds(mSettings.pollInterval));
+			continue;
+		}
+		
+		lock.unlock();
+		{
+			int numDecoded = 0;
+			
+			if (stream->mState.load(std::memory_order_relaxed) == VorbisDecodeStream::kState_Opening)
+			{
+				const std::string fileName = stream->mFileName;
+				
+				if (stream->Open(fileName.c_str(), stream->mLoop, mSettings.bufferSize, mSettings.prefetchSize))
+					numDecoded = stream->NumFramesAvailable_get();
+			}
+			else
+			{
+				numDecoded = stream->Decode(mSettings.refillThreshold);
+			}
+			
+			mNumDecodedFrames.fetch_add(numDecoded, std::memory_order_relaxed);
+		}
+		lock.lock();
+		
+		ReleaseStream(stream);
+	}
+}
+
+//
+
+VorbisDecodeService & GetVorbisDecodeService()
+{
+	// note : the service is intentionally never destroyed, as streams may still be closed during static destruction
+	
+	static VorbisDecodeService * s_service = new VorbisDecodeService();
+	
+	return *s_service;
+}
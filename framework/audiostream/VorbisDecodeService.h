@@ -0,0 +1,201 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct OggVorbis_File;
+
+/**
+ * A Vorbis decoder feeding a lock-free single producer, single consumer ring buffer of interleaved PCM frames.
+ * The producer (a decode service thread, or the consumer itself when the stream is used synchronously) calls Decode,
+ * while the consumer (typically the audio thread) calls Read, which only copies already decoded frames.
+ * When the consumer runs out of decoded frames before the stream has ended, the missing frames are zero-filled
+ * and counted as an underrun.
+ */
+class VorbisDecodeStream
+{
+public:
+	static const int kMaxLoopMarkers = 16;
+	
+	VorbisDecodeStream();
+	~VorbisDecodeStream();
+	
+	// opens the file and decodes up to prefetchSize frames, before the stream is marked as open
+	bool Open(const char * fileName, bool loop, int bufferSize, int prefetchSize = 0);
+	void Close();
+	
+	// producer side
+	
+	int Decode(int maxFrames);
+	
+	bool NeedsDecode(int minFrames) const;
+	bool IsDecodeDone_get() const { return mDecodeDone; }
+	
+	// consumer side
+	
+	int Read(float * __restrict samples, int numFrames, bool & hasLooped, bool & hasEnded);
+	
+	int NumFramesAvailable_get() const;
+	int64_t Position_get() const { return mReadPosition.load(std::memory_order_relaxed) - mLoopStartPosition; }
+	
+	int NumUnderruns_get() const { return mNumUnderruns.load(std::memory_order_relaxed); }
+	int64_t NumUnderrunFrames_get() const { return mNumUnderrunFrames.load(std::memory_order_relaxed); }
+	
+	// stream info. valid once IsOpen_get returns true
+	
+	bool IsOpen_get() const { return mState.load(std::memory_order_acquire) == kState_Open; }
+	bool HasFailed_get() const { return mState.load(std::memory_order_acquire) == kState_Failed; }
+	
+	const char * FileName_get() const { return mFileName.c_str(); }
+	bool Loop_get() const { return mLoop; }
+	int NumChannels_get() const { return mNumChannels; }
+	int SampleRate_get() const { return mSampleRate; }
+	int64_t Duration_get() const { return mDuration; }
+	
+private:
+	enum State
+	{
+		kState_Closed,
+		kState_Opening,
+		kState_Open,
+		kState_Failed
+	};
+	
+	friend class VorbisDecodeService;
+	
+	void Free(); // frees the decoder and ring buffer, without changing the state
+	
+	std::string mFileName;
+	bool mLoop;
+	
+	OggVorbis_File * mVorbisFile;
+	bool mDecodeDone;
+	int64_t mFramesSinceLoop;
+	
+	int mNumChannels;
+	int mSampleRate;
+	int64_t mDuration;
+	
+	std::atomic<int> mState;
+	
+	// ring buffer. the write position is owned by the producer, the read position by the consumer
+	
+	float * mBuffer;
+	int mBufferSize;
+	int mBufferMask;
+	
+	std::atomic<int64_t> mWritePosition;
+	std::atomic<int64_t> mReadPosition;
+	std::atomic<int64_t> mEndPosition;
+	
+	// loop markers, stored as the ring buffer position of the first frame after looping
+	
+	int64_t mLoopMarkers[kMaxLoopMarkers];
+	std::atomic<int> mLoopMarkerWriteIndex;
+	std::atomic<int> mLoopMarkerReadIndex;
+	int64_t mLoopStartPosition;
+	
+	std::atomic<int> mNumUnderruns;
+	std::atomic<int64_t> mNumUnderrunFrames;
+	
+	// service bookkeeping, protected by the service mutex
+	
+	bool mIsBusy;
+	bool mIsClosing;
+};
+
+/**
+ * Background decode service for streamed Vorbis files. A small pool of threads keeps the ring buffers of all open
+ * streams topped up, always refilling the stream with the least amount of decoded audio first, so a large number of
+ * streams can be played back while the audio thread does nothing more than copy PCM data.
+ */
+class VorbisDecodeService
+{
+public:
+	struct Settings
+	{
+		int numThreads = 2;
+		int bufferSize = 1 << 14;     // ring buffer size in frames. this is the maximum read-ahead per stream
+		int refillThreshold = 1 << 12; // a stream is refilled once at least this many frames are free
+		int prefetchSize = 1 << 13;    // number of frames decoded on open, before the stream is handed to the service
+		int pollInterval = 5;          // milliseconds between checking streams for free space
+	};
+	
+	struct Stats
+	{
+		int numStreams = 0;
+		int numUnderruns = 0;
+		int64_t numUnderrunFrames = 0;
+		int64_t numDecodedFrames = 0;
+	};
+	
+	VorbisDecodeService();
+	~VorbisDecodeService();
+	
+	void Init(const Settings & settings);
+	void Shut();
+	
+	// opens the file, parses the header and prefetches on the calling thread. returns nullptr when the file fails to open.
+	// must not be called from the audio thread
+	VorbisDecodeStream * OpenStream(const char * fileName, bool loop);
+	// returns immediately. the file is opened and prefetched on a decode thread. reading from the stream yields nothing
+	// until IsOpen_get returns true. when the file fails to open, HasFailed_get returns true
+	VorbisDecodeStream * OpenStreamAsync(const char * fileName, bool loop);
+	void CloseStream(VorbisDecodeStream *& stream);
+	
+	Stats GetStats();
+	
+private:
+	Settings mSettings;
+	
+	std::vector<VorbisDecodeStream*> mStreams;
+	std::vector<std::thread> mThreads;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	bool mStop;
+	
+	int mNumRetiredUnderruns;
+	int64_t mNumRetiredUnderrunFrames;
+	std::atomic<int64_t> mNumDecodedFrames;
+	
+	void AddStream(VorbisDecodeStream * stream);
+	VorbisDecodeStream * ClaimStream();
+	void ReleaseStream(VorbisDecodeStream * stream);
+	void RetireStream(VorbisDecodeStream * stream);
+	
+	void ThreadMain();
+};
+
+VorbisDecodeService & GetVorbisDecodeService();
@@ -0,0 +1,204 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "framework.h"
+#include "gx_texture_container.h"
+#include "image.h"
+#include "Path.h"
+#include "StringEx.h"
+#include "Timer.h"
+#include <string.h>
+
+/*
+This tool bakes the images inside one or more folders into texture containers, which the texture cache loads instead
+of decoding the source images, as long as the baked file is at least as new as the source image. It can also measure
+the CPU-side cost of loading the source images versus the baked containers.
+
+Usage: framework-example-bake-textures [-z] [-nomips] [-force] [-benchmark] <path> [path..]
+
+-z          compress the containers using zstd
+-nomips     don't precompute the mip chain
+-force      bake images, even when the baked file is up to date
+-benchmark  after baking, measure the time to load all source images and all containers, twice. the first pass
+            measures a cold start when the OS file cache was purged before running the tool (using 'sudo purge' on
+            macOS, or by writing 3 to /proc/sys/vm/drop_caches on Linux). the second pass measures a warm start
+*/
+
+static bool isImageFile(const std::string & filename)
+{
+	const std::string extension = Path::GetExtension(filename, true);
+	
+	return
+		extension == "png" ||
+		extension == "jpg" ||
+		extension == "jpeg" ||
+		extension == "bmp" ||
+		extension == "gif" ||
+		extension == "tga" ||
+		extension == "qoi";
+}
+
+static uint32_t touchBytes(const uint8_t * bytes, const int64_t numBytes)
+{
+	// read every page, the same way uploading the texture would
+	
+	uint32_t result = 0;
+	
+	for (int64_t i = 0; i < numBytes; i += 4096)
+		result += bytes[i];
+	
+	return result;
+}
+
+static void benchmark(const std::vector<std::string> & filenames, const int pass)
+{
+	int64_t numSourceBytes = 0;
+	int64_t numBakedBytes = 0;
+	uint32_t checksum = 0;
+	
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+	
+	for (auto & filename : filenames)
+	{
+		ImageData * imageData = loadImage(filename.c_str());
+		
+		if (imageData != nullptr)
+		{
+			if (String::EndsWith(filename, ".png") || String::EndsWith(filename, ".gif"))
+			{
+				ImageData * temp = imageFixAlphaFilter(imageData);
+				delete imageData;
+				imageData = temp;
+			}
+			
+			numSourceBytes += int64_t(imageData->sx) * imageData->sy * 4;
+			
+			delete imageData;
+			imageData = nullptr;
+		}
+	}
+	
+	const uint64_t t2 = g_TimerRT.TimeUS_get();
+	
+	for (auto & filename : filenames)
+	{
+		GxTextureContainer container;
+		
+		if (container.load(gxGetBakedTextureFilename(filename.c_str()).c_str()))
+		{
+			for (int i = 0; i < container.numLevels; ++i)
+				checksum += touchBytes(container.levels[i].bytes, container.levels[i].numBytes);
+			
+			numBakedBytes += container.getNumBytes();
+		}
+	}
+	
+	const uint64_t t3 = g_TimerRT.TimeUS_get();
+	
+	printf("%-6s %8d %14.2f %14.2f %12.1fMb %12.1fMb (%08x)\n",
+		pass == 0 ? "cold" : "warm",
+		(int)filenames.size(),
+		(t2 - t1) / 1000.0,
+		(t3 - t2) / 1000.0,
+		numSourceBytes / (1024.0 * 1024.0),
+		numBakedBytes / (1024.0 * 1024.0),
+		checksum);
+}
+
+int main(int argc, char * argv[])
+{
+	GxTextureBakeOptions options;
+	bool force = false;
+	bool doBenchmark = false;
+	
+	std::vector<std::string> paths;
+	
+	for (int i = 1; i < argc; ++i)
+	{
+		if (strcmp(argv[i], "-z") == 0)
+			options.compress = true;
+		else if (strcmp(argv[i], "-nomips") == 0)
+			options.generateMipmaps = false;
+		else if (strcmp(argv[i], "-force") == 0)
+			force = true;
+		else if (strcmp(argv[i], "-benchmark") == 0)
+			doBenchmark = true;
+		else
+			paths.push_back(argv[i]);
+	}
+	
+	if (paths.empty())
+	{
+		printf("usage: %s [-z] [-nomips] [-force] [-benchmark] <path> [path..]\n", argv[0]);
+		return -1;
+	}
+	
+	std::vector<std::string> filenames;
+	
+	for (auto & path : paths)
+		for (auto & filename : listFiles(path.c_str(), true))
+			if (isImageFile(filename))
+				filenames.push_back(filename);
+	
+	int numBaked = 0;
+	int numUpToDate = 0;
+	int numFailed = 0;
+	
+	for (auto & filename : filenames)
+	{
+		const std::string bakedFilename = gxGetBakedTextureFilename(filename.c_str());
+		
+		if (force == false && gxBakedTextureIsUpToDate(filename.c_str(), bakedFilename.c_str()))
+		{
+			numUpToDate++;
+			continue;
+		}
+		
+		if (gxBakeTextureFromImageFile(filename.c_str(), options))
+		{
+			printf("baked %s\n", filename.c_str());
+			numBaked++;
+		}
+		else
+		{
+			printf("failed to bake %s\n", filename.c_str());
+			numFailed++;
+		}
+	}
+	
+	printf("baked: %d, up to date: %d, failed: %d\n", numBaked, numUpToDate, numFailed);
+	
+	if (doBenchmark)
+	{
+		printf("%-6s %8s %14s %14s %14s %14s\n", "pass", "images", "decode (ms)", "baked (ms)", "decoded", "baked");
+		
+		for (int pass = 0; pass < 2; ++pass)
+			benchmark(filenames, pass);
+	}
+	
+	return numFailed == 0 ? 0 : -1;
+}
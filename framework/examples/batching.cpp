@@ -0,0 +1,221 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "framework.h"
+#include "gx_mesh.h"
+
+#define VIEW_SX 1200
+#define VIEW_SY 800
+
+static const char * s_flushReasonNames[GX_FLUSH_REASON_COUNT] =
+{
+	"state",
+	"shader",
+	"texture",
+	"matrix",
+	"primitive type",
+	"buffer full",
+	"render pass",
+	"draw",
+	"explicit"
+};
+
+static bool checkCapturedBatches()
+{
+	// draw a known sequence of primitives with a capture callback set, and verify the batcher merged them as expected. note : the capture path doesn't issue any OpenGL draw calls
+	
+	int numCallbacks = 0;
+	int numVertices = 0;
+	
+	gxResetDrawStats();
+	
+	gxSetCaptureCallback([&](
+		const void * vertexData,
+		const int vertexDataSize,
+		const GxVertexInput * vsInputs,
+		const int numVsInputs,
+		const int vertexStride,
+		const GX_PRIMITIVE_TYPE primType,
+		const int in_numVertices,
+		const bool endOfBatch)
+		{
+			numCallbacks++;
+			numVertices += in_numVertices;
+		});
+	
+	const bool batchingWasEnabled = gxGetBatchingEnabled();
+	gxSetBatchingEnabled(true);
+	{
+		pushBlend(BLEND_ALPHA);
+		{
+			for (int i = 0; i < 100; ++i)
+				drawRect(i, 0, i + 1, 1);
+			
+			// a matrix change ends the first batch
+			
+			gxPushMatrix();
+			{
+				gxTranslatef(0, 10, 0);
+				
+				for (int i = 0; i < 100; ++i)
+					drawRect(i, 0, i + 1, 1);
+			}
+			gxPopMatrix();
+			
+			// a blend mode change ends the second batch
+			
+			pushBlend(BLEND_ADD);
+			{
+				// switching to lines ends the third batch
+				
+				for (int i = 0; i < 100; ++i)
+					drawRect(i, 0, i + 1, 1);
+				
+				for (int i = 0; i < 100; ++i)
+					drawLine(i, 0, i + 1, 1);
+			}
+			popBlend();
+		}
+		popBlend();
+	}
+	gxSetBatchingEnabled(batchingWasEnabled);
+	
+	gxClearCaptureCallback();
+	
+	const GxDrawStats stats = gxGetDrawStats();
+	
+	logInfo("capture check: callbacks: %d, vertices: %d, gxBegin/gxEnd pairs: %d, merged: %d",
+		numCallbacks,
+		numVertices,
+		stats.numPrimitiveBatches,
+		stats.numMergedBatches);
+	
+	return
+		numCallbacks == 4 &&
+		numVertices == 300 * 4 + 100 * 2 &&
+		stats.numDrawCalls == 4 &&
+		stats.numPrimitiveBatches == 400 &&
+		stats.numMergedBatches == 396 &&
+		stats.numFlushes[GX_FLUSH_MATRIX] == 1 &&
+		stats.numFlushes[GX_FLUSH_STATE] == 2 &&
+		stats.numFlushes[GX_FLUSH_PRIMITIVE_TYPE] == 1;
+}
+
+int main(int argc, char * argv[])
+{
+	setupPaths(CHIBI_RESOURCE_PATHS);
+
+	if (!framework.init(VIEW_SX, VIEW_SY))
+		return -1;
+	
+	const bool captureCheckPassed = checkCapturedBatches();
+	
+	bool batchingEnabled = true;
+	
+	GxDrawStats stats;
+	
+	while (!framework.quitRequested)
+	{
+		framework.process();
+		
+		if (keyboard.wentDown(SDLK_ESCAPE))
+			framework.quitRequested = true;
+		
+		if (keyboard.wentDown(SDLK_b))
+			batchingEnabled = !batchingEnabled;
+		
+		framework.beginDraw(0, 0, 0, 0);
+		{
+			gxResetDrawStats();
+			gxSetBatchingEnabled(batchingEnabled);
+			
+			// draw a grid of small rects and lines, similar to what the graph editor does for its nodes and links
+			
+			const float time = framework.time;
+			
+			pushBlend(BLEND_ALPHA);
+			{
+				for (int y = 0; y < 60; ++y)
+				{
+					for (int x = 0; x < 100; ++x)
+					{
+						const float px = 20 + x * 11.6f;
+						const float py = 100 + y * 11.6f;
+						
+						setColorf(
+							.5f + .5f * sinf(time + x * .1f),
+							.5f + .5f * sinf(time + y * .1f),
+							1.f,
+							.8f);
+						drawRect(px, py, px + 9, py + 9);
+						
+						setColor(0, 0, 0, 80);
+						drawLine(px, py, px + 9, py + 9);
+					}
+				}
+				
+				setFont("calibri.ttf");
+				setColor(colorWhite);
+				
+				for (int i = 0; i < 20; ++i)
+					drawText(20 + i * 58, 80, 12, +1, -1, "label %d", i);
+			}
+			popBlend();
+			
+			// capture the stats before drawing them, so the numbers reflect the scene only
+			
+			gxFlushBatch();
+			
+			stats = gxGetDrawStats();
+			
+			gxSetBatchingEnabled(false);
+			
+			setFont("calibri.ttf");
+			setColor(colorWhite);
+			drawText(20, 20, 16, +1, +1, "batching: %s (press B to toggle). capture check: %s",
+				batchingEnabled ? "on" : "off",
+				captureCheckPassed ? "passed" : "FAILED");
+			drawText(20, 40, 14, +1, +1, "draw calls: %d, vertices: %d, gxBegin/gxEnd pairs: %d, merged: %d",
+				stats.numDrawCalls,
+				stats.numVertices,
+				stats.numPrimitiveBatches,
+				stats.numMergedBatches);
+			
+			for (int i = 0; i < GX_FLUSH_REASON_COUNT; ++i)
+			{
+				drawText(VIEW_SX - 20, 20 + i * 16, 12, -1, +1, "%s: %d",
+					s_flushReasonNames[i],
+					stats.numFlushes[i]);
+			}
+		}
+		framework.endDraw();
+	}
+	
+	framework.shutdown();
+
+	return 0;
+}
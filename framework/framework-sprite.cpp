@@ -112,7 +112,7 @@ Sprite::Sprite(const char * filename, float pivotX, float pivotY, const char * s
 	}
 	
 	// texture
-	m_texture = &g_textureCache.findOrCreate(filename, m_anim->m_gridSize[0], m_anim->m_gridSize[1], true, contentScale);
+	m_texture = &g_textureCache.findOrCreate(filename, m_anim->m_gridSize[0], m_anim->m_gridSize[1], true, contentScale, framework.asyncTextureLoading);
 	
 	m_prev = 0;
 	m_next = 0;
@@ -300,7 +300,7 @@ void Sprite::updateAnimationSegment()
 		}
 		
 		// recache texture, since the animation grid size may have changed
-		m_texture = &g_textureCache.findOrCreate(m_texture->name.c_str(), m_anim->m_gridSize[0], m_anim->m_gridSize[1], false, m_texture->contentScale);
+		m_texture = &g_textureCache.findOrCreate(m_texture->name.c_str(), m_anim->m_gridSize[0], m_anim->m_gridSize[1], false, m_texture->contentScale, framework.asyncTextureLoading);
 	}
 }
 
@@ -224,6 +224,8 @@ Framework::Framework()
 	allowHighDpi = true;
 	reloadCachesOnActivate = false;
 	cacheResourceData = false;
+	asyncTextureLoading = false;
+	maxTextureUploadBytesPerFrame = 16 * 1024 * 1024;
 #if defined(DISTRIBUTION)
 	enableRealTimeEditing = false;
 #else
@@ -916,6 +918,8 @@ bool Framework::shutdown()
 	for (auto * resourceCache : resourceCaches)
 		resourceCache->clear();
 
+	g_textureCache.shutAsyncLoads();
+	
 	g_glyphCache.clear();
 	
 #if USE_FREETYPE
@@ -1017,6 +1021,8 @@ bool Framework::shutdown()
 	allowHighDpi = true;
 	reloadCachesOnActivate = false;
 	cacheResourceData = false;
+	asyncTextureLoading = false;
+	maxTextureUploadBytesPerFrame = 16 * 1024 * 1024;
 #if defined(DISTRIBUTION)
 	enableRealTimeEditing = false;
 #else
@@ -1254,6 +1260,8 @@ void Framework::process()
 	
 	g_soundPlayer.process();
 	
+	g_textureCache.processAsyncLoads(maxTextureUploadBytesPerFrame);
+	
 	mouseCaptureState.nextFrame();
 	
 #if FRAMEWORK_USE_SDL
@@ -1996,6 +2004,17 @@ void Framework::fillCaches(bool recurse)
 	fillCachesWithPath(".", recurse);
 }
 
+void Framework::preloadTextures(const std::vector<std::string> & filenames)
+{
+	for (auto & filename : filenames)
+		g_textureCache.findOrCreate(filename.c_str(), 1, 1, true, 0.f, true);
+}
+
+int Framework::getNumPendingTextureLoads() const
+{
+	return g_textureCache.m_numPendingAsyncLoads;
+}
+
 Window & Framework::getMainWindow() const
 {
 	return *globals.mainWindow;
@@ -3239,7 +3258,7 @@ Dictionary & Dictionary::operator=(const Dictionary & other)
 
 GxTextureId getTexture(const char * filename, float contentScale)
 {
-	const TextureCacheElem & elem = g_textureCache.findOrCreate(filename, 1, 1, true, contentScale);
+	const TextureCacheElem & elem = g_textureCache.findOrCreate(filename, 1, 1, true, contentScale, framework.asyncTextureLoading);
 
 	if (elem.textures)
 		return elem.textures[0].id;
@@ -4108,6 +4127,8 @@ static void setDrawRect_physical(int x, int y, int sx, int sy)
 {
 	//logDebug("setDrawRect (physical): (%d, %d) x (%d, %d)", x, y, sx , sy);
 	
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.drawRect.isSet = true;
 	globals.drawRect.x = x;
 	globals.drawRect.y = y;
@@ -4159,6 +4180,8 @@ void setDrawRect(int x, int y, int sx, int sy)
 
 void clearDrawRect()
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.drawRect.isSet = false;
 	
 #if ENABLE_METAL
@@ -4240,6 +4263,9 @@ void popBlend()
 
 void setColorMode(COLOR_MODE colorMode)
 {
+	if (colorMode != globals.colorMode)
+		gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.colorMode = colorMode;
 
 #if ENABLE_OPENGL && USE_LEGACY_OPENGL
@@ -4280,6 +4306,9 @@ void popColorMode()
 
 void setColorPost(COLOR_POST colorPost)
 {
+	if (colorPost != globals.colorPost)
+		gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.colorPost = colorPost;
 }
 
@@ -4538,6 +4567,9 @@ void setColorf(float r, float g, float b, float a, float rgbMul)
 
 void setColorClamp(bool clamp)
 {
+	if (clamp != globals.colorClamp)
+		gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.colorClamp = clamp;
 	
 #if ENABLE_OPENGL && USE_LEGACY_OPENGL
@@ -4647,6 +4679,8 @@ void setShader(const ShaderBase & shader)
 {
 	if (&shader != globals.shader)
 	{
+		gxFlushBatch(GX_FLUSH_SHADER);
+		
 		globals.shader = const_cast<ShaderBase*>(&shader);
 	
 	#if ENABLE_OPENGL
@@ -4661,6 +4695,8 @@ void clearShader()
 {
 	if (globals.shader)
 	{
+		gxFlushBatch(GX_FLUSH_SHADER);
+		
 		globals.shader = 0;
 	
 	#if ENABLE_OPENGL
@@ -4676,12 +4712,18 @@ void shaderSource(const char * filename, const char * text)
 
 void pushShaderOutputs(const char * outputs)
 {
+	// note : the shader outputs select the shader variant used for drawing, so we must flush any batched geometry first
+	
+	gxFlushBatch(GX_FLUSH_SHADER);
+	
 	s_shaderOutputsStack.push(globals.shaderOutputs);
 	strcpy_s(globals.shaderOutputs, sizeof(globals.shaderOutputs), outputs);
 }
 
 void popShaderOutputs()
 {
+	gxFlushBatch(GX_FLUSH_SHADER);
+	
 	auto value = s_shaderOutputsStack.popValue();
 	strcpy_s(globals.shaderOutputs, sizeof(globals.shaderOutputs), value.c_str());
 }
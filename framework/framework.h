@@ -445,6 +445,9 @@ public:
 	void fillCachesWithPath(const char * path, bool recurse);
 	void fillCaches(bool recurse);
 	
+	void preloadTextures(const std::vector<std::string> & filenames); // decodes textures in the background. they are uploaded during process()
+	int getNumPendingTextureLoads() const;
+	
 	Window & getMainWindow() const;
 	Window & getCurrentWindow() const;
 	std::vector<Window*> getAllWindows() const;
@@ -514,6 +517,8 @@ public:
 	bool allowHighDpi;
 	bool reloadCachesOnActivate;
 	bool cacheResourceData;
+	bool asyncTextureLoading; // when set, textures are decoded in the background. getTexture and sprites return an empty placeholder until the texture is uploaded
+	int64_t maxTextureUploadBytesPerFrame;
 	bool enableRealTimeEditing;
 	bool vrMode;
 	bool filedrop;
@@ -1753,6 +1758,30 @@ void freeTexture(GxTextureId & textureId);
 void debugDrawText(float x, float y, int size, float alignX, float alignY, const char * format, ...);
 void debugDrawText(const Vec3 & position, int size, float alignX, float alignY, const char * format, ...);
 
+enum GX_FLUSH_REASON
+{
+	GX_FLUSH_STATE,          // a draw state (blend mode, color mode, depth test, draw rect, ..) changed
+	GX_FLUSH_SHADER,         // the active shader or one of its uniforms changed
+	GX_FLUSH_TEXTURE,        // the immediate mode texture changed, or a texture is modified or read back
+	GX_FLUSH_MATRIX,         // the modelview or projection matrix changed
+	GX_FLUSH_PRIMITIVE_TYPE, // gxBegin was called with a different (or non-batchable) primitive type
+	GX_FLUSH_BUFFER_FULL,    // the immediate mode vertex buffer ran out of space
+	GX_FLUSH_RENDER_PASS,    // a render pass began or ended
+	GX_FLUSH_DRAW,           // a non-immediate draw call, blit or compute dispatch was issued
+	GX_FLUSH_EXPLICIT,       // gxFlushBatch was called by the application
+	GX_FLUSH_REASON_COUNT
+};
+
+struct GxDrawStats
+{
+	int numDrawCalls = 0;        // number of draw calls (or capture callbacks) issued by the immediate mode path
+	int numVertices = 0;         // number of vertices submitted by the immediate mode path
+	int numPrimitiveBatches = 0; // number of gxBegin/gxEnd pairs
+	int numMergedBatches = 0;    // number of gxBegin/gxEnd pairs which got appended to a pending batch
+	int numStreamingBufferWaits = 0; // number of times the immediate mode path had to wait for the GPU to free up space in its vertex buffer
+	int numFlushes[GX_FLUSH_REASON_COUNT] = { }; // number of pending batches flushed, per reason
+};
+
 // OpenGL legacy mode drawing
 
 #if !ENABLE_OPENGL && !ENABLE_METAL
@@ -1799,6 +1828,12 @@ static inline void gxClearTexture() { }
 static inline void gxGetTextureSize(GxTextureId texture, int & width, int & height) { width = 0; height = 0; }
 static inline GX_TEXTURE_FORMAT gxGetTextureFormat(GxTextureId texture) { return GX_UNKNOWN_FORMAT; }
 
+static inline void gxSetBatchingEnabled(bool enabled) { }
+static inline bool gxGetBatchingEnabled() { return false; }
+static inline void gxFlushBatch(GX_FLUSH_REASON reason = GX_FLUSH_EXPLICIT) { }
+static inline GxDrawStats gxGetDrawStats() { return GxDrawStats(); }
+static inline void gxResetDrawStats() { }
+
 #elif (ENABLE_OPENGL && !USE_LEGACY_OPENGL) || ENABLE_METAL
 
 void gxMatrixMode(GX_MATRIX mode);
@@ -1841,6 +1876,18 @@ void gxClearTexture();
 void gxGetTextureSize(GxTextureId texture, int & width, int & height);
 GX_TEXTURE_FORMAT gxGetTextureFormat(GxTextureId texture);
 
+// immediate mode draw call batching. when enabled, consecutive gxBegin/gxEnd pairs of the same
+// list primitive type (triangles, quads, lines, points) are merged into a single draw call, as
+// long as the shader, texture, draw states and matrices stay the same. the batch is flushed
+// automatically when any of these changes through the framework. note : batching is off by
+// default, as raw OpenGL calls go unnoticed by the batcher. call gxFlushBatch before issuing them
+
+void gxSetBatchingEnabled(bool enabled);
+bool gxGetBatchingEnabled();
+void gxFlushBatch(GX_FLUSH_REASON reason = GX_FLUSH_EXPLICIT);
+GxDrawStats gxGetDrawStats();
+void gxResetDrawStats();
+
 #else
 
 #define gxMatrixMode glMatrixMode
@@ -1886,6 +1933,12 @@ void gxClearTexture();
 void gxGetTextureSize(GxTextureId texture, int & width, int & height);
 GX_TEXTURE_FORMAT gxGetTextureFormat(GxTextureId texture);
 
+void gxSetBatchingEnabled(bool enabled);
+bool gxGetBatchingEnabled();
+void gxFlushBatch(GX_FLUSH_REASON reason = GX_FLUSH_EXPLICIT);
+GxDrawStats gxGetDrawStats();
+void gxResetDrawStats();
+
 #endif
 
 #if FRAMEWORK_ENABLE_GL_ERROR_LOG && ENABLE_OPENGL
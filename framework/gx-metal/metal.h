@@ -104,7 +104,8 @@ void metal_copy_texture_to_texture(
 	const int srcSx, const int srcSy, const int srcSz,
 	__unsafe_unretained id <MTLTexture> dst,
 	const int dstX, const int dstY, const int dstZ,
-	const MTLPixelFormat pixelFormat);
+	const MTLPixelFormat pixelFormat,
+	const int dstLevel = 0);
 
 void metal_generate_mipmaps(__unsafe_unretained id <MTLTexture> texture);
 
@@ -627,7 +627,8 @@ void metal_copy_texture_to_texture(
 	const int srcSx, const int srcSy, const int srcSz,
 	__unsafe_unretained id <MTLTexture> dst,
 	const int dstX, const int dstY, const int dstZ,
-	const MTLPixelFormat pixelFormat)
+	const MTLPixelFormat pixelFormat,
+	const int dstLevel)
 {
 	@autoreleasepool
 	{
@@ -662,7 +663,7 @@ void metal_copy_texture_to_texture(
 			sourceSize:src_size
 			toTexture:dst
 			destinationSlice:0
-			destinationLevel:0
+			destinationLevel:dstLevel
 			destinationOrigin:dst_origin];
 		
 		if (waitForBlit != nil)
@@ -3253,6 +3254,30 @@ void gxClearCaptureCallback()
 	s_gxCaptureCallback = nullptr;
 }
 
+// note : immediate mode batching isn't implemented (yet) for Metal. gxBegin/gxEnd pairs are drawn individually
+
+void gxSetBatchingEnabled(bool enabled)
+{
+}
+
+bool gxGetBatchingEnabled()
+{
+	return false;
+}
+
+void gxFlushBatch(GX_FLUSH_REASON reason)
+{
+}
+
+GxDrawStats gxGetDrawStats()
+{
+	return GxDrawStats();
+}
+
+void gxResetDrawStats()
+{
+}
+
 //
 
 static void gxValidateShaderResources(const bool useGenericShader)
@@ -34,6 +34,7 @@
 #import "renderTarget.h"
 #import "texture.h"
 #import <Metal/Metal.h>
+#import <algorithm>
 
 #define TODO 0
 
@@ -347,22 +348,10 @@ static void * make_compatible(const void * src, const int srcSx, const int srcSy
 	return nullptr;
 }
 
-void GxTexture::upload(const void * src, const int srcAlignment, const int srcPitch, const bool updateMipmaps)
-{
-	uploadArea(src, srcAlignment, srcPitch, sx, sy, 0, 0);
-	
-	// generate mipmaps if needed
-	
-	if (updateMipmaps && mipmapped)
-	{
-		generateMipmaps();
-	}
-}
-
-void GxTexture::uploadArea(const void * src, const int srcAlignment, const int in_srcPitch, const int srcSx, const int srcSy, const int dstX, const int dstY)
+static void uploadAreaToLevel(GxTexture & texture, const int level, const void * src, const int srcAlignment, const int in_srcPitch, const int srcSx, const int srcSy, const int dstX, const int dstY)
 {
-	Assert(id != 0);
-	if (id == 0)
+	Assert(texture.id != 0);
+	if (texture.id == 0)
 		return;
 	
 	@autoreleasepool
@@ -375,7 +364,7 @@ void GxTexture::uploadArea(const void * src, const int srcAlignment, const int i
 		
 		auto device = metal_get_device();
 		
-		const MTLPixelFormat metalFormat = toMetalFormat(format);
+		const MTLPixelFormat metalFormat = toMetalFormat(texture.format);
 
 		MTLTextureDescriptor * descriptor = [MTLTextureDescriptor
 			texture2DDescriptorWithPixelFormat:metalFormat
@@ -395,9 +384,9 @@ void GxTexture::uploadArea(const void * src, const int srcAlignment, const int i
 		};
 		
 		const int srcPitch = in_srcPitch == 0 ? srcSx : in_srcPitch;
-		const int bytesPerPixel = getMetalFormatBytesPerPixel(format);
+		const int bytesPerPixel = getMetalFormatBytesPerPixel(texture.format);
 		
-		void * copy = make_compatible(src, srcSx, srcSy, srcPitch, format);
+		void * copy = make_compatible(src, srcSx, srcSy, srcPitch, texture.format);
 		
 		if (copy != nullptr)
 		{
@@ -412,7 +401,7 @@ void GxTexture::uploadArea(const void * src, const int srcAlignment, const int i
 		
 		// 3. asynchronously copy from the source texture to our own texture
 		
-		auto & dst_texture = s_textureElems[id].texture;
+		auto & dst_texture = s_textureElems[texture.id].texture;
 		
 		metal_copy_texture_to_texture(
 			src_texture,
@@ -420,12 +409,40 @@ void GxTexture::uploadArea(const void * src, const int srcAlignment, const int i
 			srcSx, srcSy, 1,
 			dst_texture,
 			dstX, dstY, 0,
-			metalFormat);
+			metalFormat,
+			level);
 		
 		src_texture = nullptr;
 	}
 }
 
+void GxTexture::upload(const void * src, const int srcAlignment, const int srcPitch, const bool updateMipmaps)
+{
+	uploadArea(src, srcAlignment, srcPitch, sx, sy, 0, 0);
+	
+	// generate mipmaps if needed
+	
+	if (updateMipmaps && mipmapped)
+	{
+		generateMipmaps();
+	}
+}
+
+void GxTexture::uploadArea(const void * src, const int srcAlignment, const int in_srcPitch, const int srcSx, const int srcSy, const int dstX, const int dstY)
+{
+	uploadAreaToLevel(*this, 0, src, srcAlignment, in_srcPitch, srcSx, srcSy, dstX, dstY);
+}
+
+void GxTexture::uploadMipLevel(const int level, const void * src, const int srcAlignment, const int srcPitch)
+{
+	Assert(level == 0 || mipmapped);
+	
+	const int level_sx = std::max(1, sx >> level);
+	const int level_sy = std::max(1, sy >> level);
+	
+	uploadAreaToLevel(*this, level, src, srcAlignment, srcPitch, level_sx, level_sy, 0, 0);
+}
+
 void GxTexture::copyRegionsFromTexture(const GxTexture & src, const CopyRegion * regions, const int numRegions)
 {
 	Assert(src.id != 0);
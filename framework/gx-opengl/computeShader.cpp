@@ -299,6 +299,8 @@ void ComputeShader::setBufferRw(GxImmediateIndex index, const ShaderBufferRw & b
 
 void ComputeShader::dispatch(const int dispatchSx, const int dispatchSy, const int dispatchSz)
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	fassert(globals.shader == this);
 
 	const int threadSx = toThreadSx(dispatchSx);
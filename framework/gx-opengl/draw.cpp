@@ -38,6 +38,7 @@
 #include "data/engine/ShaderCommon.txt" // VS_ constants
 #include "enumTranslation.h"
 #include "gx_mesh.h"
+#include "gx_streaming_buffer.h"
 #include "internal.h"
 #include "Quat.h"
 #include <map>
@@ -277,7 +278,11 @@ struct GxVertex
 //#define GX_BUFFER_DRAW_MODE GL_STREAM_DRAW
 #define GX_USE_ELEMENT_ARRAY_BUFFER 1
 
+// note : the streaming buffer relies on glDrawElementsBaseVertex for drawing quads, which isn't available on OpenGL ES 3.0
+#define GX_USE_STREAMING_BUFFER (ENABLE_DESKTOP_OPENGL && GX_USE_ELEMENT_ARRAY_BUFFER)
+
 #define GX_VERTEX_BUFFER_SIZE (1024*16)
+#define GX_STREAMING_BUFFER_SIZE (1024*1024*4)
 
 static GLuint s_gxVertexArrayObject = 0;
 static GLuint s_gxVertexBufferObject = 0;
@@ -306,6 +311,125 @@ static GLuint s_gxVertexArrayObjectForCustomDraw = 0;
 
 static GxCaptureCallback s_gxCaptureCallback = nullptr;
 
+struct GxBatch
+{
+	bool isPending = false; // true when gxEnd left vertices in the vertex buffer, waiting to be merged with the next gxBegin/gxEnd pair
+	int numVertices = 0; // number of vertices recorded by completed gxBegin/gxEnd pairs
+	GX_PRIMITIVE_TYPE primitiveType = GX_INVALID_PRIM;
+	Mat4x4 modelView; // matrices the pending vertices should be drawn with
+	Mat4x4 projection;
+};
+
+static bool s_gxBatchingEnabled = false;
+static bool s_gxIsInsideBeginEnd = false;
+static GxBatch s_gxBatch;
+static GxDrawStats s_gxDrawStats;
+
+#if GX_USE_STREAMING_BUFFER
+
+class GxStreamingBufferBackend_GL : public GxStreamingBufferBackend
+{
+	GLuint buffer = 0;
+	uint8_t * mappedBytes = nullptr; // set when the buffer is persistently mapped
+	
+public:
+	void init(const GLuint in_buffer, const int capacity)
+	{
+		buffer = in_buffer;
+		
+		glBindBuffer(GL_ARRAY_BUFFER, buffer);
+		checkErrorGL();
+		
+		if (GLEW_ARB_buffer_storage)
+		{
+			// write vertices directly into a persistently mapped buffer. this saves us a driver call per draw
+			
+			const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+			
+			glBufferStorage(GL_ARRAY_BUFFER, capacity, nullptr, flags);
+			mappedBytes = (uint8_t*)glMapBufferRange(GL_ARRAY_BUFFER, 0, capacity, flags);
+			checkErrorGL();
+		}
+		
+		if (mappedBytes == nullptr)
+		{
+			glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+			checkErrorGL();
+		}
+	}
+	
+	void shut()
+	{
+		if (mappedBytes != nullptr)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glUnmapBuffer(GL_ARRAY_BUFFER);
+			checkErrorGL();
+			
+			mappedBytes = nullptr;
+		}
+		
+		buffer = 0;
+	}
+	
+	virtual void write(const int offset, const void * bytes, const int numBytes) override
+	{
+		if (mappedBytes != nullptr)
+		{
+			memcpy(mappedBytes + offset, bytes, numBytes);
+		}
+		else
+		{
+			// note : the streaming buffer makes sure we never write to a region the GPU may still be reading from, so the driver doesn't need to synchronize here
+			
+			glBindBuffer(GL_ARRAY_BUFFER, buffer);
+			glBufferSubData(GL_ARRAY_BUFFER, offset, numBytes, bytes);
+			checkErrorGL();
+		}
+	}
+	
+	virtual void * insertFence() override
+	{
+		GLsync sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+		checkErrorGL();
+		
+		return sync;
+	}
+	
+	virtual bool isFenceSignaled(void * fence) override
+	{
+		const GLenum result = glClientWaitSync((GLsync)fence, 0, 0);
+		checkErrorGL();
+		
+		// note : a failed wait is treated as signaled, to avoid waiting forever on a broken fence
+		
+		return result == GL_ALREADY_SIGNALED || result == GL_CONDITION_SATISFIED || result == GL_WAIT_FAILED;
+	}
+	
+	virtual void waitFence(void * fence) override
+	{
+		for (;;)
+		{
+			const GLenum result = glClientWaitSync((GLsync)fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000*1000*1000);
+			checkErrorGL();
+			
+			if (result != GL_TIMEOUT_EXPIRED)
+				break;
+		}
+	}
+	
+	virtual void freeFence(void * fence) override
+	{
+		glDeleteSync((GLsync)fence);
+		checkErrorGL();
+	}
+};
+
+static GxStreamingBufferBackend_GL s_gxStreamingBufferBackend;
+static GxStreamingBuffer s_gxStreamingBuffer;
+
+#endif
+
 static const GxVertexInput s_gxVsInputs[] =
 {
 	{ VS_POSITION, 4, GX_ELEMENT_FLOAT32, 0, offsetof(GxVertex, px), 0 },
@@ -371,7 +495,7 @@ void gxInitialize()
 			baseIndex += 4;
 		}
 		
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(glindex_t) * numIndices, indices, GX_BUFFER_DRAW_MODE);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(glindex_t) * numIndices, indices, GL_STATIC_DRAW);
 		checkErrorGL();
 	#endif
 	
@@ -383,6 +507,11 @@ void gxInitialize()
 	glBindVertexArray(0);
 	checkErrorGL();
 	
+#if GX_USE_STREAMING_BUFFER
+	s_gxStreamingBufferBackend.init(s_gxVertexBufferObject, GX_STREAMING_BUFFER_SIZE);
+	s_gxStreamingBuffer.init(&s_gxStreamingBufferBackend, GX_STREAMING_BUFFER_SIZE);
+#endif
+	
 	// create vertex array for custom draw
 	fassert(s_gxVertexArrayObjectForCustomDraw == 0);
 	glGenVertexArrays(1, &s_gxVertexArrayObjectForCustomDraw);
@@ -397,6 +526,8 @@ void gxInitialize()
 
 void gxShutdown()
 {
+	gxFlushBatch(GX_FLUSH_EXPLICIT);
+	
 #if ENABLE_DESKTOP_OPENGL
 	glDisable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
 #endif
@@ -413,6 +544,11 @@ void gxShutdown()
 		s_gxVertexArrayObject = 0;
 	}
 	
+#if GX_USE_STREAMING_BUFFER
+	s_gxStreamingBuffer.shut();
+	s_gxStreamingBufferBackend.shut();
+#endif
+
 	if (s_gxVertexBufferObject != 0)
 	{
 		glDeleteBuffers(1, &s_gxVertexBufferObject);
@@ -437,6 +573,10 @@ void gxShutdown()
 	
 	s_gxLastPrimitiveType = GX_INVALID_PRIM;
 	s_gxLastVertexCount = -1;
+	
+	s_gxBatchingEnabled = false;
+	s_gxIsInsideBeginEnd = false;
+	s_gxBatch = GxBatch();
 }
 
 static void doCapture(const bool endOfBatch)
@@ -498,6 +638,12 @@ static void doCapture(const bool endOfBatch)
 
 static void gxFlush(bool endOfBatch)
 {
+	if (s_gxVertexCount != 0)
+	{
+		s_gxDrawStats.numDrawCalls++;
+		s_gxDrawStats.numVertices += s_gxVertexCount;
+	}
+	
 	if (s_gxCaptureCallback != nullptr)
 	{
 		doCapture(endOfBatch);
@@ -526,10 +672,25 @@ static void gxFlush(bool endOfBatch)
 		glBindVertexArray(s_gxVertexArrayObject);
 		checkErrorGL();
 		
+	#if GX_USE_STREAMING_BUFFER
+		// append the vertices to the streaming buffer, and draw them from there
+		
+		const int numFenceWaits = s_gxStreamingBuffer.getStats().numFenceWaits;
+		
+		const int vertexOffset = s_gxStreamingBuffer.append(s_gxVertices, sizeof(GxVertex) * s_gxVertexCount, sizeof(GxVertex));
+		fassert(vertexOffset != -1);
+		
+		const int firstVertex = vertexOffset / sizeof(GxVertex);
+		
+		s_gxDrawStats.numStreamingBufferWaits += s_gxStreamingBuffer.getStats().numFenceWaits - numFenceWaits;
+	#else
 		glBindBuffer(GL_ARRAY_BUFFER, s_gxVertexBufferObject);
 		glBufferData(GL_ARRAY_BUFFER, sizeof(GxVertex) * s_gxVertexCount, s_gxVertices, GX_BUFFER_DRAW_MODE);
 		checkErrorGL();
 		
+		const int firstVertex = 0;
+	#endif
+		
 		bool indexed = false;
 	#if !GX_USE_ELEMENT_ARRAY_BUFFER
 		glindex_t * indices = nullptr;
@@ -604,7 +765,9 @@ static void gxFlush(bool endOfBatch)
 
 			if (indexed)
 			{
-			#if GX_USE_ELEMENT_ARRAY_BUFFER
+			#if GX_USE_STREAMING_BUFFER
+				glDrawElementsBaseVertex(glPrimitiveType, numElements, INDEX_TYPE, 0, firstVertex);
+			#elif GX_USE_ELEMENT_ARRAY_BUFFER
 				glDrawElements(glPrimitiveType, numElements, INDEX_TYPE, 0);
 			#else
 				glDrawElements(glPrimitiveType, numElements, INDEX_TYPE, indices);
@@ -613,7 +776,7 @@ static void gxFlush(bool endOfBatch)
 			}
 			else
 			{
-				glDrawArrays(glPrimitiveType, 0, numElements);
+				glDrawArrays(glPrimitiveType, firstVertex, numElements);
 				checkErrorGL();
 			}
 		}
@@ -662,10 +825,124 @@ static void gxFlush(bool endOfBatch)
 		s_gxVertices = nullptr;
 }
 
+static bool isBatchablePrimitiveType(const GX_PRIMITIVE_TYPE primitiveType)
+{
+	// note : only list primitives can be merged. strips, fans and loops would connect to the previous batch
+	
+	return
+		primitiveType == GX_TRIANGLES ||
+		primitiveType == GX_QUADS ||
+		primitiveType == GX_LINES ||
+		primitiveType == GX_POINTS;
+}
+
+static bool batchMatricesAreCurrent()
+{
+	return
+		memcmp(s_gxBatch.modelView.m_v, s_gxModelView.get().m_v, sizeof(Mat4x4::m_v)) == 0 &&
+		memcmp(s_gxBatch.projection.m_v, s_gxProjection.get().m_v, sizeof(Mat4x4::m_v)) == 0;
+}
+
+void gxSetBatchingEnabled(bool enabled)
+{
+	if (enabled == false)
+		gxFlushBatch(GX_FLUSH_EXPLICIT);
+	
+	s_gxBatchingEnabled = enabled;
+}
+
+bool gxGetBatchingEnabled()
+{
+	return s_gxBatchingEnabled;
+}
+
+void gxFlushBatch(GX_FLUSH_REASON reason)
+{
+	if (s_gxBatch.isPending == false)
+		return;
+	
+	// note : when called in between gxBegin and gxEnd, the vertices of the pair in progress are
+	//        kept, and moved to the front of the vertex buffer once the pending vertices are drawn
+	
+	const int numPendingVertices = s_gxBatch.numVertices;
+	const int numCurrentVertices = s_gxVertexCount - numPendingVertices;
+	
+	fassert(numCurrentVertices >= 0);
+	fassert(s_gxPrimitiveType == s_gxBatch.primitiveType);
+	
+	s_gxBatch.isPending = false;
+	s_gxBatch.numVertices = 0;
+	
+	s_gxDrawStats.numFlushes[reason]++;
+	
+	// draw using the matrices the vertices were recorded with
+	
+	const bool restoreMatrices = !batchMatricesAreCurrent();
+	
+	Mat4x4 modelView;
+	Mat4x4 projection;
+	
+	if (restoreMatrices)
+	{
+		modelView = s_gxModelView.get();
+		projection = s_gxProjection.get();
+		
+		s_gxModelView.getRw() = s_gxBatch.modelView;
+		s_gxProjection.getRw() = s_gxBatch.projection;
+	}
+	
+	s_gxVertexCount = numPendingVertices;
+	
+	gxFlush(s_gxIsInsideBeginEnd == false);
+	
+	if (restoreMatrices)
+	{
+		s_gxModelView.getRw() = modelView;
+		s_gxProjection.getRw() = projection;
+	}
+	
+	if (numCurrentVertices > 0)
+	{
+		memmove(s_gxVertices, s_gxVertices + numPendingVertices, numCurrentVertices * sizeof(GxVertex));
+		s_gxVertexCount = numCurrentVertices;
+	}
+}
+
+GxDrawStats gxGetDrawStats()
+{
+	return s_gxDrawStats;
+}
+
+void gxResetDrawStats()
+{
+	s_gxDrawStats = GxDrawStats();
+}
+
 void gxBegin(GX_PRIMITIVE_TYPE primitiveType)
 {
+	if (s_gxBatch.isPending)
+	{
+		if (s_gxBatchingEnabled == false || primitiveType != s_gxBatch.primitiveType)
+			gxFlushBatch(GX_FLUSH_PRIMITIVE_TYPE);
+		else if (batchMatricesAreCurrent() == false)
+			gxFlushBatch(GX_FLUSH_MATRIX);
+	}
+	
+	s_gxDrawStats.numPrimitiveBatches++;
+	s_gxIsInsideBeginEnd = true;
+	
 	s_gxPrimitiveType = primitiveType;
-	s_gxVertices = s_gxVertexBuffer;
+	
+	if (s_gxBatch.isPending)
+	{
+		// append to the vertices of the pending batch
+		
+		s_gxDrawStats.numMergedBatches++;
+	}
+	else
+	{
+		s_gxVertices = s_gxVertexBuffer;
+	}
 	
 	switch (primitiveType)
 	{
@@ -697,11 +974,54 @@ void gxBegin(GX_PRIMITIVE_TYPE primitiveType)
 			fassert(false);
 	}
 	
-	fassert(s_gxVertexCount == 0);
+	fassert(s_gxVertexCount == s_gxBatch.numVertices);
 }
 
 void gxEnd()
 {
+	if (s_gxBatchingEnabled && isBatchablePrimitiveType(s_gxPrimitiveType))
+	{
+		// the matrices may have changed in between gxBegin and gxEnd. in this case, the vertices
+		// of previous pairs must be drawn with the matrices they were recorded with
+		
+		if (s_gxBatch.isPending && batchMatricesAreCurrent() == false)
+			gxFlushBatch(GX_FLUSH_MATRIX);
+		
+		s_gxIsInsideBeginEnd = false;
+		
+		if (s_gxVertexCount == 0)
+		{
+			s_gxVertices = nullptr;
+		}
+		else if (s_gxVertexCount % s_gxPrimitiveSize == 0)
+		{
+			// defer drawing until the next gxBegin, or until the draw state changes
+			
+			if (s_gxBatch.isPending == false)
+			{
+				s_gxBatch.isPending = true;
+				s_gxBatch.primitiveType = s_gxPrimitiveType;
+				s_gxBatch.modelView = s_gxModelView.get();
+				s_gxBatch.projection = s_gxProjection.get();
+			}
+			
+			s_gxBatch.numVertices = s_gxVertexCount;
+		}
+		else
+		{
+			// incomplete primitives would shift the vertices of subsequent pairs. draw now
+			
+			s_gxBatch.isPending = false;
+			s_gxBatch.numVertices = 0;
+			
+			gxFlush(true);
+		}
+		
+		return;
+	}
+	
+	s_gxIsInsideBeginEnd = false;
+	
 	gxFlush(true);
 }
 
@@ -709,6 +1029,8 @@ void gxEmitVertices(GX_PRIMITIVE_TYPE primitiveType, int numVertices)
 {
 	fassert(primitiveType == GX_POINTS || primitiveType == GX_LINES || primitiveType == GX_TRIANGLES || primitiveType == GX_TRIANGLE_STRIP);
 	
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	const bool useGenericShader =
 		globals.shader == nullptr ||
 		globals.shader == &globals.builtinShaders->generic.get();
@@ -772,7 +1094,15 @@ void gxEmitVertex()
 	
 	if (s_gxVertexCount + s_gxPrimitiveSize > s_gxMaxVertexCount)
 	{
-		if (s_gxVertexCount % s_gxPrimitiveSize == 0)
+		if (s_gxBatch.isPending)
+		{
+			// make room by drawing the vertices of previous gxBegin/gxEnd pairs first
+			
+			gxFlushBatch(GX_FLUSH_BUFFER_FULL);
+		}
+		
+		if (s_gxVertexCount + s_gxPrimitiveSize > s_gxMaxVertexCount &&
+			s_gxVertexCount % s_gxPrimitiveSize == 0)
 		{
 			gxFlush(false);
 		}
@@ -896,6 +1226,9 @@ void gxVertex4fv(const float * v)
 
 void gxSetTexture(GxTextureId texture, GX_SAMPLE_FILTER filter, bool clamp)
 {
+	if (texture != s_gxTexture || filter != s_gxTextureFilter || clamp != s_gxTextureClamp)
+		gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	s_gxTextureEnabled = texture != 0;
 	s_gxTexture = texture;
 	s_gxTextureIsDirty = true;
@@ -906,6 +1239,9 @@ void gxSetTexture(GxTextureId texture, GX_SAMPLE_FILTER filter, bool clamp)
 
 void gxClearTexture()
 {
+	if (s_gxTexture != 0)
+		gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	s_gxTextureEnabled = false;
 	s_gxTexture = 0;
 	s_gxTextureIsDirty = true;
@@ -1004,6 +1340,28 @@ void gxShutdown()
 {
 }
 
+void gxSetBatchingEnabled(bool enabled)
+{
+}
+
+bool gxGetBatchingEnabled()
+{
+	return false;
+}
+
+void gxFlushBatch(GX_FLUSH_REASON reason)
+{
+}
+
+GxDrawStats gxGetDrawStats()
+{
+	return GxDrawStats();
+}
+
+void gxResetDrawStats()
+{
+}
+
 void gxGetMatrixf(GX_MATRIX mode, float * m)
 {
 	switch (mode)
@@ -1301,6 +1659,8 @@ void gxSetVertexBuffer(const GxVertexBuffer * buffer, const GxVertexInput * vsIn
 
 void gxDrawIndexedPrimitives(const GX_PRIMITIVE_TYPE type, const int firstIndex, const int in_numIndices, const GxIndexBuffer * indexBuffer)
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	const bool useGenericShader =
 		globals.shader == nullptr ||
 		globals.shader == &globals.builtinShaders->generic.get();
@@ -1379,6 +1739,8 @@ void gxDrawIndexedPrimitives(const GX_PRIMITIVE_TYPE type, const int firstIndex,
 
 void gxDrawPrimitives(const GX_PRIMITIVE_TYPE type, const int firstVertex, const int numVertices)
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	const bool useGenericShader =
 		globals.shader == nullptr ||
 		globals.shader == &globals.builtinShaders->generic.get();
@@ -1434,6 +1796,8 @@ void gxDrawPrimitives(const GX_PRIMITIVE_TYPE type, const int firstVertex, const
 
 void gxDrawInstancedIndexedPrimitives(const int numInstances, const GX_PRIMITIVE_TYPE type, const int firstIndex, const int in_numIndices, const GxIndexBuffer * indexBuffer)
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	const bool useGenericShader =
 		globals.shader == nullptr ||
 		globals.shader == &globals.builtinShaders->generic.get();
@@ -1512,6 +1876,8 @@ void gxDrawInstancedIndexedPrimitives(const int numInstances, const GX_PRIMITIVE
 
 void gxDrawInstancedPrimitives(const int numInstances, const GX_PRIMITIVE_TYPE type, const int firstVertex, const int numVertices)
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	const bool useGenericShader =
 		globals.shader == nullptr ||
 		globals.shader == &globals.builtinShaders->generic.get();
@@ -1568,11 +1934,13 @@ void gxDrawInstancedPrimitives(const int numInstances, const GX_PRIMITIVE_TYPE t
 void gxSetCaptureCallback(GxCaptureCallback callback)
 {
 	Assert(s_gxCaptureCallback == nullptr);
+	gxFlushBatch(GX_FLUSH_STATE);
 	s_gxCaptureCallback = callback;
 }
 
 void gxClearCaptureCallback()
 {
+	gxFlushBatch(GX_FLUSH_STATE);
 	s_gxCaptureCallback = nullptr;
 }
 
@@ -37,6 +37,9 @@ static int s_colorWriteMask = 0xf;
 
 void setBlend(BLEND_MODE blendMode)
 {
+	if (blendMode != globals.blendMode)
+		gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.blendMode = blendMode;
 	
 	switch (blendMode)
@@ -127,6 +130,8 @@ void setBlend(BLEND_MODE blendMode)
 
 void setLineSmooth(bool enabled)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.lineSmoothEnabled = enabled;
 	
 #if ENABLE_DESKTOP_OPENGL
@@ -148,6 +153,8 @@ void setLineSmooth(bool enabled)
 
 void setWireframe(bool enabled)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.wireframeEnabled = enabled;
 	
 #if ENABLE_DESKTOP_OPENGL
@@ -160,6 +167,8 @@ void setWireframe(bool enabled)
 
 void setColorWriteMask(int r, int g, int b, int a)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	s_colorWriteMask =
 		((r ? 1 : 0) << 0) |
 		((g ? 1 : 0) << 1) |
@@ -217,6 +226,8 @@ static GLenum toOpenGLDepthFunc(DEPTH_TEST test)
 
 void setDepthTest(bool enabled, DEPTH_TEST test, bool writeEnabled)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.depthTestEnabled = enabled;
 	globals.depthTest = test;
 	globals.depthTestWriteEnabled = writeEnabled;
@@ -239,6 +250,8 @@ void setDepthTest(bool enabled, DEPTH_TEST test, bool writeEnabled)
 
 void setDepthBias(float depthBias, float slopeScale)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.depthBias = depthBias;
 	globals.depthBiasSlopeScale = slopeScale;
 	
@@ -261,6 +274,8 @@ void setDepthBias(float depthBias, float slopeScale)
 
 void setAlphaToCoverage(bool enabled)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.alphaToCoverageEnabled = enabled;
 	
 	if (enabled)
@@ -327,6 +342,8 @@ static GLenum translateStencilFunc(const GX_STENCIL_FUNC func)
 
 void clearStencil(uint8_t value, uint32_t writeMask)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	glClearStencil(value);
 	checkErrorGL();
 
@@ -343,6 +360,8 @@ void clearStencil(uint8_t value, uint32_t writeMask)
 
 void setStencilTest(const StencilState & front, const StencilState & back)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	// capture current stencil state
 	
 	globals.stencilEnabled = true;
@@ -369,6 +388,8 @@ void setStencilTest(const StencilState & front, const StencilState & back)
 
 void clearStencilTest()
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	// capture current stencil state
 	
 	globals.stencilEnabled = false;
@@ -380,6 +401,8 @@ void clearStencilTest()
 
 void setCullMode(CULL_MODE mode, CULL_WINDING frontFaceWinding)
 {
+	gxFlushBatch(GX_FLUSH_STATE);
+	
 	globals.cullMode = mode;
 	globals.cullWinding = frontFaceWinding;
 	
@@ -68,6 +68,8 @@ void beginRenderPass(ColorTarget ** targets, const int numTargets, const bool cl
 	Assert(s_oldDrawBuffer == 0);
 	AssertBackingScaleConstraint(backingScale);
 	
+	gxFlushBatch(GX_FLUSH_RENDER_PASS);
+	
 	// capture the currently bound framebuffers. we will restore them at the end of endRenderPass
 	
 	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, (GLint*)&s_oldReadBuffer);
@@ -242,6 +244,8 @@ void beginBackbufferRenderPass(const bool clearColor, const Color & color, const
 	Assert(s_frameBufferId == 0);
 	AssertBackingScaleConstraint(backingScale);
 	
+	gxFlushBatch(GX_FLUSH_RENDER_PASS);
+	
 	// capture the currently bound framebuffers. we will restore them at the end of endRenderPass
 	
 	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, (GLint*)&s_oldReadBuffer);
@@ -334,6 +338,8 @@ void beginBackbufferRenderPass(const bool clearColor, const Color & color, const
 
 void endRenderPass()
 {
+	gxFlushBatch(GX_FLUSH_RENDER_PASS);
+	
 	// note : for MSAA, SDL uses a separate framebuffer. we ask/store the framebuffer used by the current windows, and set that instead of the framebuffer with id zero
 
 	popContentScale();
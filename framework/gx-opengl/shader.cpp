@@ -233,6 +233,7 @@ std::vector<GxTextureInfo> Shader::getTextureInfos() const
 		} \
 		else \
 		{ \
+			gxFlushBatch(GX_FLUSH_SHADER); \
 			op; \
 		} \
 	}
@@ -265,6 +266,7 @@ void Shader::setImmediate(GxImmediateIndex index, float x)
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform1f(index, x);
 	checkErrorGL();
 }
@@ -273,6 +275,7 @@ void Shader::setImmediate(GxImmediateIndex index, float x, float y)
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform2f(index, x, y);
 	checkErrorGL();
 }
@@ -281,6 +284,7 @@ void Shader::setImmediate(GxImmediateIndex index, float x, float y, float z)
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform3f(index, x, y, z);
 	checkErrorGL();
 }
@@ -289,6 +293,7 @@ void Shader::setImmediate(GxImmediateIndex index, float x, float y, float z, flo
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform4f(index, x, y, z, w);
 	checkErrorGL();
 }
@@ -303,6 +308,7 @@ void Shader::setImmediateFloatArray(GxImmediateIndex index, const float * values
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform1fv(index, numValues, values);
 	checkErrorGL();
 }
@@ -317,6 +323,7 @@ void Shader::setImmediateMatrix4x4(GxImmediateIndex index, const float * matrix)
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniformMatrix4fv(index, 1, GL_FALSE, matrix);
 	checkErrorGL();
 }
@@ -331,6 +338,7 @@ void Shader::setImmediateMatrix4x4Array(GxImmediateIndex index, const float * ma
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniformMatrix4fv(index, numMatrices, GL_FALSE, matrices);
 	checkErrorGL();
 }
@@ -354,6 +362,7 @@ void Shader::setTexture(GxImmediateIndex index, int unit, GxTextureId texture, b
 {
 	fassert(index != -1);
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 	glUniform1i(index, unit);
 	checkErrorGL();
 
@@ -430,6 +439,7 @@ void Shader::setBuffer(const char * name, const ShaderBuffer & buffer)
 void Shader::setBuffer(GxImmediateIndex index, const ShaderBuffer & buffer)
 {
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 
 	glUniformBlockBinding(getProgram(), index, index);
 	glBindBufferBase(GL_UNIFORM_BUFFER, index, buffer.getOpenglBufferId());
@@ -461,6 +471,7 @@ void Shader::setBufferRw(GxImmediateIndex index, const ShaderBufferRw & buffer)
 	AssertMsg(false, "not supported");
 #else
 	fassert(globals.shader == this);
+	gxFlushBatch(GX_FLUSH_SHADER);
 
 	glShaderStorageBlockBinding(getProgram(), index, index);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, index, buffer.getOpenglBufferId());
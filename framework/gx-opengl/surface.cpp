@@ -86,6 +86,8 @@ void Surface::setSwizzle(int r, int g, int b, int a)
 
 void Surface::blitTo(Surface * surface) const
 {
+	gxFlushBatch(GX_FLUSH_DRAW);
+	
 	// capture current OpenGL states before we change them
 	int oldReadBuffer = 0;
 	int oldDrawBuffer = 0;
@@ -160,6 +160,9 @@ void GxTexture::allocate(const GxTextureProperties & properties)
 
 void GxTexture::free()
 {
+	// note : pending immediate mode draws may reference the texture. draw them before its contents change
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	if (id != 0)
 	{
 		glDeleteTextures(1, &id);
@@ -179,6 +182,8 @@ bool GxTexture::isChanged(const int _sx, const int _sy, const GX_TEXTURE_FORMAT
 
 void GxTexture::setSwizzle(const int in_r, const int in_g, const int in_b, const int in_a)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	Assert(id != 0);
 	if (id == 0)
 		return;
@@ -227,6 +232,8 @@ void GxTexture::setSwizzle(const int in_r, const int in_g, const int in_b, const
 
 void GxTexture::clearf(const float r, const float g, const float b, const float a)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	GLuint oldReadBuffer = 0;
 	GLuint oldDrawBuffer = 0;
 	glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, (GLint*)&oldReadBuffer);
@@ -256,6 +263,8 @@ void GxTexture::clearf(const float r, const float g, const float b, const float
 
 void GxTexture::clearAreaToZero(const int x, const int y, const int sx, const int sy)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	GLenum uploadFormat;
 	GLenum uploadElementType;
 	toOpenGLUploadType(format, uploadFormat, uploadElementType);
@@ -316,6 +325,8 @@ void GxTexture::clearAreaToZero(const int x, const int y, const int sx, const in
 
 void GxTexture::upload(const void * src, const int _srcAlignment, const int _srcPitch, const bool updateMipmaps)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	Assert(id != 0);
 	if (id == 0)
 		return;
@@ -369,8 +380,71 @@ void GxTexture::upload(const void * src, const int _srcAlignment, const int _src
 	}
 }
 
+void GxTexture::uploadMipLevel(const int level, const void * src, const int _srcAlignment, const int _srcPitch)
+{
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
+	Assert(id != 0);
+	if (id == 0)
+		return;
+	
+	Assert(level == 0 || mipmapped);
+	
+#if USE_LEGACY_OPENGL
+	// note : legacy OpenGL textures are allocated with a single level. precomputed mip levels are ignored
+	if (level != 0)
+		return;
+#endif
+	
+	const int level_sx = std::max(1, sx >> level);
+	const int level_sy = std::max(1, sy >> level);
+	
+	const int srcPitch = _srcPitch == 0 ? level_sx : _srcPitch;
+	
+	const int srcAlignment = ((srcPitch & (_srcAlignment - 1)) == 0) ? _srcAlignment : 1;
+	
+	// capture current OpenGL states before we change them
+
+	GLuint restoreTexture;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, reinterpret_cast<GLint*>(&restoreTexture));
+	GLint restoreUnpack;
+	glGetIntegerv(GL_UNPACK_ALIGNMENT, &restoreUnpack);
+	GLint restorePitch;
+	glGetIntegerv(GL_UNPACK_ROW_LENGTH, &restorePitch);
+	checkErrorGL();
+
+	//
+	
+	GLenum uploadFormat;
+	GLenum uploadElementType;
+	toOpenGLUploadType(format, uploadFormat, uploadElementType);
+
+	glBindTexture(GL_TEXTURE_2D, id);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, std::min(8, srcAlignment));
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, srcPitch);
+	checkErrorGL();
+	
+	glTexSubImage2D(
+		GL_TEXTURE_2D,
+		level, 0, 0,
+		level_sx, level_sy,
+		uploadFormat,
+		uploadElementType,
+		src);
+	checkErrorGL();
+
+	// restore previous OpenGL states
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, restoreUnpack);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, restorePitch);
+	glBindTexture(GL_TEXTURE_2D, restoreTexture);
+	checkErrorGL();
+}
+
 void GxTexture::uploadArea(const void * src, const int srcAlignment, const int _srcPitch, const int srcSx, const int srcSy, const int dstX, const int dstY)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	Assert(id != 0);
 	if (id == 0)
 		return;
@@ -412,6 +486,8 @@ void GxTexture::uploadArea(const void * src, const int srcAlignment, const int _
 
 void GxTexture::copyRegionsFromTexture(const GxTexture & src, const CopyRegion * regions, const int numRegions)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	// capture current OpenGL states before we change them
 	
 	GLuint restoreBuffer = 0;
@@ -464,6 +540,8 @@ void GxTexture::copyRegionsFromTexture(const GxTexture & src, const CopyRegion *
 
 void GxTexture::generateMipmaps()
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	if (id == 0)
 		return;
 		
@@ -488,6 +566,8 @@ void GxTexture::generateMipmaps()
 
 bool GxTexture::downloadContents(const int x, const int y, const int sx, const int sy, void * bytes, const int numBytes)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	bool result = true;
 	
 	// capture OpenGL states so we can restore them later
@@ -885,6 +965,8 @@ static GLuint allocateTexture(const int sx, const int sy, GLenum internalFormat,
 
 GxTextureId copyTexture(const GxTextureId texture)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 #if ENABLE_DESKTOP_OPENGL
 	// capture OpenGL states so we can restore them later
 	
@@ -966,6 +1048,8 @@ GxTextureId copyTexture(const GxTextureId texture)
 
 void freeTexture(GxTextureId & textureId)
 {
+	gxFlushBatch(GX_FLUSH_TEXTURE);
+	
 	glDeleteTextures(1, &textureId);
 	textureId = 0;
 }
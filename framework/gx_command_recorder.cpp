@@ -0,0 +1,350 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "gx_command_recorder.h"
+#include "Quat.h"
+#include <string.h>
+
+// -- replay targets
+
+void GxCommandReplayTarget_Gx::draw(const GX_PRIMITIVE_TYPE primitiveType, const GxRecordedVertex * vertices, const int numVertices)
+{
+	gxBegin(primitiveType);
+	{
+		for (int i = 0; i < numVertices; ++i)
+		{
+			const GxRecordedVertex & v = vertices[i];
+			
+			gxNormal3f(v.nx, v.ny, v.nz);
+			gxTexCoord2f(v.tx, v.ty);
+			gxColor4f(v.cx, v.cy, v.cz, v.cw);
+			gxVertex4f(v.px, v.py, v.pz, v.pw);
+		}
+	}
+	gxEnd();
+}
+
+void GxCommandReplayTarget_Gx::setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp)
+{
+	gxSetTexture(texture, filter, clamp);
+}
+
+void GxCommandReplayTarget_Gx::clearTexture()
+{
+	gxClearTexture();
+}
+
+//
+
+void GxCommandReplayTarget_Cpu::clear()
+{
+	commands.clear();
+	vertices.clear();
+}
+
+void GxCommandReplayTarget_Cpu::draw(const GX_PRIMITIVE_TYPE primitiveType, const GxRecordedVertex * in_vertices, const int numVertices)
+{
+	Command command;
+	command.type = kCommandType_Draw;
+	command.primitiveType = primitiveType;
+	command.firstVertex = (int)vertices.size();
+	command.numVertices = numVertices;
+	command.texture = 0;
+	commands.push_back(command);
+	
+	vertices.insert(vertices.end(), in_vertices, in_vertices + numVertices);
+}
+
+void GxCommandReplayTarget_Cpu::setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp)
+{
+	Command command;
+	command.type = kCommandType_SetTexture;
+	command.primitiveType = GX_INVALID_PRIM;
+	command.firstVertex = 0;
+	command.numVertices = 0;
+	command.texture = texture;
+	commands.push_back(command);
+}
+
+void GxCommandReplayTarget_Cpu::clearTexture()
+{
+	Command command;
+	command.type = kCommandType_ClearTexture;
+	command.primitiveType = GX_INVALID_PRIM;
+	command.firstVertex = 0;
+	command.numVertices = 0;
+	command.texture = 0;
+	commands.push_back(command);
+}
+
+// -- GxCommandRecorder
+
+static int getPrimitiveSize(const GX_PRIMITIVE_TYPE primitiveType)
+{
+	// returns the number of vertices per primitive for primitive types which may be merged into a single draw, or zero otherwise
+	
+	switch (primitiveType)
+	{
+	case GX_POINTS:
+		return 1;
+	case GX_LINES:
+		return 2;
+	case GX_TRIANGLES:
+		return 3;
+	case GX_QUADS:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+GxCommandRecorder::GxCommandRecorder()
+{
+	reset();
+}
+
+void GxCommandRecorder::reset()
+{
+	commands.clear();
+	vertices.clear();
+	
+	matrixStack[0].MakeIdentity();
+	matrixIsIdentity[0] = true;
+	matrixStackDepth = 0;
+	
+	primitiveType = GX_INVALID_PRIM;
+	firstVertex = 0;
+	
+	memset(&currentVertex, 0, sizeof(currentVertex));
+	currentVertex.pw = 1.f;
+	currentVertex.cx = 1.f;
+	currentVertex.cy = 1.f;
+	currentVertex.cz = 1.f;
+	currentVertex.cw = 1.f;
+}
+
+void GxCommandRecorder::begin(const GX_PRIMITIVE_TYPE in_primitiveType)
+{
+	Assert(primitiveType == GX_INVALID_PRIM);
+	
+	primitiveType = in_primitiveType;
+	firstVertex = (int)vertices.size();
+}
+
+void GxCommandRecorder::end()
+{
+	Assert(primitiveType != GX_INVALID_PRIM);
+	
+	const int numVertices = (int)vertices.size() - firstVertex;
+	
+	if (numVertices > 0)
+	{
+		// merge with the previous draw command when possible. this works because vertices are always appended,
+		// so the vertices of consecutive draws are adjacent. it's only valid for list-type primitives, where
+		// each primitive stands on its own, and only when the previous draw consisted of whole primitives
+		
+		const int primitiveSize = getPrimitiveSize(primitiveType);
+		
+		Command * last = commands.empty() ? nullptr : &commands.back();
+		
+		if (primitiveSize != 0 &&
+			last != nullptr &&
+			last->type == kCommandType_Draw &&
+			last->draw.primitiveType == primitiveType &&
+			(last->draw.numVertices % primitiveSize) == 0)
+		{
+			Assert(last->draw.firstVertex + last->draw.numVertices == firstVertex);
+			
+			last->draw.numVertices += numVertices;
+		}
+		else
+		{
+			Command command;
+			command.type = kCommandType_Draw;
+			command.draw.primitiveType = primitiveType;
+			command.draw.firstVertex = firstVertex;
+			command.draw.numVertices = numVertices;
+			commands.push_back(command);
+		}
+	}
+	
+	primitiveType = GX_INVALID_PRIM;
+}
+
+void GxCommandRecorder::normal3f(const float x, const float y, const float z)
+{
+	if (matrixIsIdentity[matrixStackDepth])
+	{
+		currentVertex.nx = x;
+		currentVertex.ny = y;
+		currentVertex.nz = z;
+	}
+	else
+	{
+		const Vec3 n = matrixStack[matrixStackDepth].Mul3(Vec3(x, y, z));
+		
+		currentVertex.nx = n[0];
+		currentVertex.ny = n[1];
+		currentVertex.nz = n[2];
+	}
+}
+
+void GxCommandRecorder::vertex4f(const float x, const float y, const float z, const float w)
+{
+	Assert(primitiveType != GX_INVALID_PRIM);
+	
+	if (matrixIsIdentity[matrixStackDepth])
+	{
+		currentVertex.px = x;
+		currentVertex.py = y;
+		currentVertex.pz = z;
+		currentVertex.pw = w;
+	}
+	else
+	{
+		const Vec4 p = matrixStack[matrixStackDepth].Mul(Vec4(x, y, z, w));
+		
+		currentVertex.px = p[0];
+		currentVertex.py = p[1];
+		currentVertex.pz = p[2];
+		currentVertex.pw = p[3];
+	}
+	
+	vertices.push_back(currentVertex);
+}
+
+void GxCommandRecorder::setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp)
+{
+	Assert(primitiveType == GX_INVALID_PRIM);
+	
+	Command command;
+	command.type = kCommandType_SetTexture;
+	command.texture.id = texture;
+	command.texture.filter = filter;
+	command.texture.clamp = clamp;
+	commands.push_back(command);
+}
+
+void GxCommandRecorder::clearTexture()
+{
+	Assert(primitiveType == GX_INVALID_PRIM);
+	
+	Command command;
+	command.type = kCommandType_ClearTexture;
+	commands.push_back(command);
+}
+
+void GxCommandRecorder::pushMatrix()
+{
+	Assert(matrixStackDepth + 1 < kMaxMatrixStackDepth);
+	if (matrixStackDepth + 1 < kMaxMatrixStackDepth)
+	{
+		matrixStack[matrixStackDepth + 1] = matrixStack[matrixStackDepth];
+		matrixIsIdentity[matrixStackDepth + 1] = matrixIsIdentity[matrixStackDepth];
+		matrixStackDepth++;
+	}
+}
+
+void GxCommandRecorder::popMatrix()
+{
+	Assert(matrixStackDepth > 0);
+	if (matrixStackDepth > 0)
+	{
+		matrixStackDepth--;
+	}
+}
+
+void GxCommandRecorder::loadIdentity()
+{
+	matrixStack[matrixStackDepth].MakeIdentity();
+	matrixIsIdentity[matrixStackDepth] = true;
+}
+
+void GxCommandRecorder::loadMatrixf(const float * m)
+{
+	memcpy(matrixStack[matrixStackDepth].m_v, m, sizeof(float) * 16);
+	matrixIsIdentity[matrixStackDepth] = false;
+}
+
+void GxCommandRecorder::multMatrixf(const float * _m)
+{
+	Mat4x4 m;
+	memcpy(m.m_v, _m, sizeof(m.m_v));
+	
+	matrixStack[matrixStackDepth] = matrixStack[matrixStackDepth] * m;
+	matrixIsIdentity[matrixStackDepth] = false;
+}
+
+void GxCommandRecorder::translatef(const float x, const float y, const float z)
+{
+	matrixStack[matrixStackDepth] = matrixStack[matrixStackDepth].Translate(x, y, z);
+	matrixIsIdentity[matrixStackDepth] = false;
+}
+
+void GxCommandRecorder::rotatef(const float angle, const float x, const float y, const float z)
+{
+	Quat q;
+	q.fromAxisAngle(Vec3(x, y, z), angle * M_PI / 180.f);
+	
+	matrixStack[matrixStackDepth] = matrixStack[matrixStackDepth] * q.toMatrix();
+	matrixIsIdentity[matrixStackDepth] = false;
+}
+
+void GxCommandRecorder::scalef(const float x, const float y, const float z)
+{
+	matrixStack[matrixStackDepth] = matrixStack[matrixStackDepth].Scale(x, y, z);
+	matrixIsIdentity[matrixStackDepth] = false;
+}
+
+void GxCommandRecorder::replay() const
+{
+	GxCommandReplayTarget_Gx target;
+	
+	replay(target);
+}
+
+void GxCommandRecorder::replay(GxCommandReplayTarget & target) const
+{
+	Assert(primitiveType == GX_INVALID_PRIM);
+	
+	for (auto & command : commands)
+	{
+		switch (command.type)
+		{
+		case kCommandType_Draw:
+			target.draw(command.draw.primitiveType, vertices.data() + command.draw.firstVertex, command.draw.numVertices);
+			break;
+		case kCommandType_SetTexture:
+			target.setTexture(command.texture.id, command.texture.filter, command.texture.clamp);
+			break;
+		case kCommandType_ClearTexture:
+			target.clearTexture();
+			break;
+		}
+	}
+}
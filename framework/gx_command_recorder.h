@@ -0,0 +1,210 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "framework.h" // GX_PRIMITIVE_TYPE, GxTextureId
+#include "Mat4x4.h"
+#include <vector>
+
+/*
+ * GxCommandRecorder records immediate mode draw commands into a CPU-side command list, so scene
+ * building can be moved off the render thread. The recorder implements the same begin/end,
+ * vertex attribute and (model view) matrix calls as the gx api, but it doesn't touch any global
+ * state. Each thread records into its own recorder(s), after which the render thread replays
+ * them, in whatever order it chooses, using the regular gx api.
+ *
+ * Vertex positions and normals are transformed by the recorder's own matrix stack at record
+ * time. The replayed geometry is drawn relative to the model view matrix which is active during
+ * replay, so recording inside a pushMatrix/translatef gives the same result as issuing the same
+ * calls on the render thread directly.
+ *
+ * Replay goes through a GxCommandReplayTarget. The default target forwards to gx. The CPU target
+ * captures the replayed commands and vertices, which is useful for testing and for measuring
+ * recording performance without a GPU.
+ *
+ * note : a recorder may only be used by one thread at a time. recorders themselves are not
+ *        synchronized. the thread which builds the command list must be done before the render
+ *        thread starts replaying it
+ */
+
+struct GxRecordedVertex
+{
+	float px, py, pz, pw;
+	float nx, ny, nz;
+	float cx, cy, cz, cw;
+	float tx, ty;
+};
+
+class GxCommandReplayTarget // base class for replay targets
+{
+public:
+	virtual ~GxCommandReplayTarget() { }
+	
+	virtual void draw(const GX_PRIMITIVE_TYPE primitiveType, const GxRecordedVertex * vertices, const int numVertices) = 0;
+	virtual void setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp) = 0;
+	virtual void clearTexture() = 0;
+};
+
+class GxCommandReplayTarget_Gx : public GxCommandReplayTarget // replays commands using the gx api. must be used from the render thread
+{
+public:
+	virtual void draw(const GX_PRIMITIVE_TYPE primitiveType, const GxRecordedVertex * vertices, const int numVertices) override;
+	virtual void setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp) override;
+	virtual void clearTexture() override;
+};
+
+class GxCommandReplayTarget_Cpu : public GxCommandReplayTarget // captures replayed commands. may be used from any thread
+{
+public:
+	enum CommandType
+	{
+		kCommandType_Draw,
+		kCommandType_SetTexture,
+		kCommandType_ClearTexture
+	};
+	
+	struct Command
+	{
+		CommandType type;
+		GX_PRIMITIVE_TYPE primitiveType;
+		int firstVertex;
+		int numVertices;
+		GxTextureId texture;
+	};
+	
+	std::vector<Command> commands;
+	std::vector<GxRecordedVertex> vertices;
+	
+	void clear();
+	
+	virtual void draw(const GX_PRIMITIVE_TYPE primitiveType, const GxRecordedVertex * vertices, const int numVertices) override;
+	virtual void setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp) override;
+	virtual void clearTexture() override;
+};
+
+class GxCommandRecorder
+{
+	enum CommandType
+	{
+		kCommandType_Draw,
+		kCommandType_SetTexture,
+		kCommandType_ClearTexture
+	};
+	
+	struct Command
+	{
+		CommandType type;
+		
+		union
+		{
+			struct
+			{
+				GX_PRIMITIVE_TYPE primitiveType;
+				int firstVertex;
+				int numVertices;
+			} draw;
+			
+			struct
+			{
+				GxTextureId id;
+				GX_SAMPLE_FILTER filter;
+				bool clamp;
+			} texture;
+		};
+	};
+	
+	static const int kMaxMatrixStackDepth = 32;
+	
+	std::vector<Command> commands;
+	std::vector<GxRecordedVertex> vertices;
+	
+	Mat4x4 matrixStack[kMaxMatrixStackDepth];
+	bool matrixIsIdentity[kMaxMatrixStackDepth]; // lets us skip transforming vertices when the matrix is identity
+	int matrixStackDepth = 0;
+	
+	GX_PRIMITIVE_TYPE primitiveType = GX_INVALID_PRIM;
+	int firstVertex = 0;
+	
+	GxRecordedVertex currentVertex;
+	
+public:
+	GxCommandRecorder();
+	
+	void reset(); // clears the command list and resets the matrix stack and vertex attributes
+	
+	int getNumCommands() const { return (int)commands.size(); }
+	int getNumVertices() const { return (int)vertices.size(); }
+	
+	// draw calls
+	
+	void begin(const GX_PRIMITIVE_TYPE primitiveType);
+	void end();
+	
+	void color3f(const float r, const float g, const float b) { color4f(r, g, b, 1.f); }
+	void color4f(const float r, const float g, const float b, const float a)
+	{
+		currentVertex.cx = r;
+		currentVertex.cy = g;
+		currentVertex.cz = b;
+		currentVertex.cw = a;
+	}
+	void color4fv(const float * rgba) { color4f(rgba[0], rgba[1], rgba[2], rgba[3]); }
+	void color4ub(const int r, const int g, const int b, const int a) { color4f(r / 255.f, g / 255.f, b / 255.f, a / 255.f); }
+	
+	void texCoord2f(const float u, const float v)
+	{
+		currentVertex.tx = u;
+		currentVertex.ty = v;
+	}
+	
+	void normal3f(const float x, const float y, const float z);
+	
+	void vertex2f(const float x, const float y) { vertex4f(x, y, 0.f, 1.f); }
+	void vertex3f(const float x, const float y, const float z) { vertex4f(x, y, z, 1.f); }
+	void vertex3fv(const float * v) { vertex4f(v[0], v[1], v[2], 1.f); }
+	void vertex4f(const float x, const float y, const float z, const float w);
+	
+	void setTexture(const GxTextureId texture, const GX_SAMPLE_FILTER filter, const bool clamp);
+	void clearTexture();
+	
+	// model view matrix stack. the stack starts out as identity, which means 'the model view matrix active during replay'
+	
+	void pushMatrix();
+	void popMatrix();
+	void loadIdentity();
+	void loadMatrixf(const float * m);
+	void multMatrixf(const float * m);
+	void translatef(const float x, const float y, const float z);
+	void rotatef(const float angle, const float x, const float y, const float z);
+	void scalef(const float x, const float y, const float z);
+	
+	// replay
+	
+	void replay() const; // replays the commands using the gx api. must be called from the render thread
+	void replay(GxCommandReplayTarget & target) const;
+};
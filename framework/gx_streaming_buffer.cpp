@@ -0,0 +1,285 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "gx_streaming_buffer.h"
+#include <algorithm>
+#include <string.h>
+
+void GxStreamingBuffer::init(GxStreamingBufferBackend * in_backend, const int in_capacity, const int in_fenceGranularity)
+{
+	Assert(backend == nullptr);
+	Assert(in_capacity > 0);
+	
+	backend = in_backend;
+	
+	capacity = in_capacity;
+	fenceGranularity = in_fenceGranularity > 0 ? in_fenceGranularity : std::max(1, in_capacity / 8);
+	
+	head = 0;
+	numBytesInUse = 0;
+	numBytesUnfenced = 0;
+	
+	firstFence = 0;
+	numFences = 0;
+	
+	stats = Stats();
+}
+
+void GxStreamingBuffer::shut()
+{
+	if (backend == nullptr)
+		return;
+	
+	// note : the fences are freed without waiting for them. the backend is expected to keep the buffer alive until the GPU is done with it (OpenGL does this for us)
+	
+	while (numFences > 0)
+		retireOldestFence(false);
+	
+	backend = nullptr;
+	
+	capacity = 0;
+	fenceGranularity = 0;
+	
+	head = 0;
+	numBytesInUse = 0;
+	numBytesUnfenced = 0;
+}
+
+void GxStreamingBuffer::retireOldestFence(const bool wait)
+{
+	Assert(numFences > 0);
+	
+	Fence & fence = fences[firstFence];
+	
+	if (wait && backend->isFenceSignaled(fence.fence) == false)
+	{
+		stats.numFenceWaits++;
+		
+		backend->waitFence(fence.fence);
+	}
+	
+	backend->freeFence(fence.fence);
+	
+	numBytesInUse -= fence.numBytes;
+	Assert(numBytesInUse >= numBytesUnfenced);
+	
+	fence = Fence();
+	
+	firstFence = (firstFence + 1) % kMaxFences;
+	numFences--;
+	
+	// start over at the beginning of the buffer when it's empty, to avoid needless wrap arounds
+	
+	if (numBytesInUse == 0)
+		head = 0;
+}
+
+void GxStreamingBuffer::retireSignaledFences()
+{
+	while (numFences > 0 && backend->isFenceSignaled(fences[firstFence].fence))
+		retireOldestFence(false);
+}
+
+int GxStreamingBuffer::alloc(const int numBytes, const int alignment)
+{
+	Assert(backend != nullptr);
+	Assert(numBytes >= 0 && alignment >= 1);
+	
+	if (numBytes > capacity)
+		return -1;
+	
+	// note : the fence is inserted here, rather than right after the previous allocation. the caller is
+	//        expected to have issued the draw calls using the previous allocation(s) by now, which is what
+	//        the fence needs to guard
+	
+	if (numBytesUnfenced >= fenceGranularity)
+		fence();
+	
+	for (;;)
+	{
+		int offset = (head + alignment - 1) / alignment * alignment;
+		int numBytesRequired;
+		bool wraps = false;
+		
+		if (offset + numBytes <= capacity)
+		{
+			numBytesRequired = offset - head + numBytes;
+		}
+		else
+		{
+			// the remainder of the buffer is too small. skip it and continue at the start of the buffer
+			
+			offset = 0;
+			numBytesRequired = capacity - head + numBytes;
+			wraps = true;
+		}
+		
+		if (numBytesInUse + numBytesRequired <= capacity)
+		{
+			if (wraps)
+				stats.numWraps++;
+			
+			head = offset + numBytes;
+			numBytesInUse += numBytesRequired;
+			numBytesUnfenced += numBytesRequired;
+			
+			stats.numAllocations++;
+			stats.numBytesAllocated += numBytes;
+			
+			return offset;
+		}
+		
+		// the region we want to allocate is still (potentially) in use. free up space by retiring the oldest region
+		
+		if (numFences == 0)
+		{
+			// everything in use was allocated since the last fence. insert a fence so we have something to wait for
+			
+			fence();
+		}
+		
+		retireOldestFence(true);
+	}
+}
+
+int GxStreamingBuffer::append(const void * bytes, const int numBytes, const int alignment)
+{
+	const int offset = alloc(numBytes, alignment);
+	
+	if (offset != -1 && numBytes > 0)
+		backend->write(offset, bytes, numBytes);
+	
+	return offset;
+}
+
+void GxStreamingBuffer::fence()
+{
+	Assert(backend != nullptr);
+	
+	if (numBytesUnfenced == 0)
+		return;
+	
+	retireSignaledFences();
+	
+	if (numFences == kMaxFences)
+		retireOldestFence(true);
+	
+	Fence & fence = fences[(firstFence + numFences) % kMaxFences];
+	fence.fence = backend->insertFence();
+	fence.numBytes = numBytesUnfenced;
+	numFences++;
+	
+	numBytesUnfenced = 0;
+	
+	stats.numFences++;
+}
+
+//
+
+GxStreamingBufferBackend_Cpu::~GxStreamingBufferBackend_Cpu()
+{
+	shut();
+}
+
+void GxStreamingBufferBackend_Cpu::init(const int in_capacity)
+{
+	shut();
+	
+	bytes = new uint8_t[in_capacity];
+	capacity = in_capacity;
+}
+
+void GxStreamingBufferBackend_Cpu::shut()
+{
+	delete [] bytes;
+	bytes = nullptr;
+	
+	capacity = 0;
+	
+	writesInFlight.clear();
+}
+
+void GxStreamingBufferBackend_Cpu::signalFences(const int64_t fenceId)
+{
+	lastSignaledFenceId = std::max(lastSignaledFenceId, std::min(fenceId, nextFenceId - 1));
+	
+	// forget about writes the GPU is done with
+	
+	writesInFlight.erase(
+		std::remove_if(writesInFlight.begin(), writesInFlight.end(),
+			[&](const Write & write) { return write.fenceId <= lastSignaledFenceId; }),
+		writesInFlight.end());
+}
+
+void GxStreamingBufferBackend_Cpu::write(const int offset, const void * in_bytes, const int numBytes)
+{
+	if (offset < 0 || numBytes < 0 || offset + numBytes > capacity)
+	{
+		numBoundsErrors++;
+		return;
+	}
+	
+	for (auto & write : writesInFlight)
+	{
+		if (offset < write.offset + write.numBytes && write.offset < offset + numBytes)
+			numOverlapErrors++;
+	}
+	
+	memcpy(bytes + offset, in_bytes, numBytes);
+	
+	// the write is guarded by the next fence to be inserted
+	
+	Write write;
+	write.offset = offset;
+	write.numBytes = numBytes;
+	write.fenceId = nextFenceId;
+	writesInFlight.push_back(write);
+}
+
+void * GxStreamingBufferBackend_Cpu::insertFence()
+{
+	return (void*)(intptr_t)nextFenceId++;
+}
+
+bool GxStreamingBufferBackend_Cpu::isFenceSignaled(void * fence)
+{
+	return (intptr_t)fence <= lastSignaledFenceId;
+}
+
+void GxStreamingBufferBackend_Cpu::waitFence(void * fence)
+{
+	// simulate the GPU catching up
+	
+	numWaits++;
+	
+	signalFences((intptr_t)fence);
+}
+
+void GxStreamingBufferBackend_Cpu::freeFence(void * fence)
+{
+}
@@ -0,0 +1,158 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+/*
+ * GxStreamingBuffer is a ring buffer allocator for per-frame (or per-draw) geometry. Data is
+ * appended to a single large buffer, and regions of it are guarded by fences. The allocator
+ * only waits on a fence when it wraps around and runs into data which may still be in use by
+ * the GPU. This avoids re-specifying (orphaning) a buffer object for every draw call.
+ *
+ * The allocator itself doesn't know about the rendering api. Buffer writes and fences are
+ * delegated to a backend. GxStreamingBufferBackend_Cpu is a CPU-side implementation, which
+ * simulates the GPU consuming data, and which checks that no data gets overwritten while it
+ * may still be in use. It's used to test the allocation and wrap-around logic.
+ */
+
+class GxStreamingBufferBackend // base class for the rendering-api specific implementation
+{
+public:
+	virtual ~GxStreamingBufferBackend() { }
+	
+	virtual void write(const int offset, const void * bytes, const int numBytes) = 0;
+	
+	virtual void * insertFence() = 0; // returns a fence which becomes signaled once the GPU consumed all previously written data
+	virtual bool isFenceSignaled(void * fence) = 0;
+	virtual void waitFence(void * fence) = 0;
+	virtual void freeFence(void * fence) = 0;
+};
+
+class GxStreamingBuffer
+{
+public:
+	struct Stats
+	{
+		int64_t numAllocations = 0;
+		int64_t numBytesAllocated = 0;
+		int numWraps = 0;
+		int numFences = 0;
+		int numFenceWaits = 0; // number of times the allocator had to wait for the GPU to free up space
+	};
+	
+private:
+	struct Fence
+	{
+		void * fence = nullptr;
+		int numBytes = 0; // number of bytes (including padding and the unused space at the end when wrapping) guarded by the fence
+	};
+	
+	static const int kMaxFences = 64;
+	
+	GxStreamingBufferBackend * backend = nullptr;
+	
+	int capacity = 0;
+	int fenceGranularity = 0;
+	
+	int head = 0; // offset where the next allocation starts (before alignment)
+	int numBytesInUse = 0; // number of bytes from the oldest unretired allocation up to head
+	int numBytesUnfenced = 0; // number of bytes allocated since the last fence
+	
+	Fence fences[kMaxFences]; // fences ordered from old to new
+	int firstFence = 0;
+	int numFences = 0;
+	
+	Stats stats;
+	
+	void retireOldestFence(const bool wait);
+	
+public:
+	// fenceGranularity : a fence is inserted automatically once this many bytes got allocated since the last fence. when zero, capacity/8 is used
+	void init(GxStreamingBufferBackend * backend, const int capacity, const int fenceGranularity = 0);
+	void shut();
+	
+	// returns the offset of a region of numBytes bytes inside the buffer, aligned to alignment bytes (which doesn't need to be a power of two). returns -1 when numBytes exceeds the capacity of the buffer
+	// note : the GPU commands consuming an allocation must be issued before the next call to alloc or fence
+	int alloc(const int numBytes, const int alignment);
+	
+	// allocates a region and writes the given bytes into it. returns the offset of the region, or -1 on failure
+	int append(const void * bytes, const int numBytes, const int alignment);
+	
+	// inserts a fence guarding all allocations made since the last fence
+	void fence();
+	
+	// retires the regions of which the GPU signaled it's done with them, without waiting
+	void retireSignaledFences();
+	
+	int getCapacity() const { return capacity; }
+	int getNumBytesInUse() const { return numBytesInUse; }
+	
+	const Stats & getStats() const { return stats; }
+};
+
+class GxStreamingBufferBackend_Cpu : public GxStreamingBufferBackend
+{
+	struct Write
+	{
+		int offset;
+		int numBytes;
+		int64_t fenceId; // the fence which guards this write
+	};
+	
+	std::vector<Write> writesInFlight;
+	
+	int64_t nextFenceId = 1;
+	
+public:
+	uint8_t * bytes = nullptr;
+	int capacity = 0;
+	
+	int64_t lastSignaledFenceId = 0; // fences up to and including this id are signaled. advance it to simulate the GPU consuming data
+	
+	int numWaits = 0;
+	int numOverlapErrors = 0; // number of writes which overlapped data which may still be in use by the (simulated) GPU
+	int numBoundsErrors = 0; // number of writes outside the buffer
+	
+	virtual ~GxStreamingBufferBackend_Cpu() override;
+	
+	void init(const int capacity);
+	void shut();
+	
+	int64_t getLastInsertedFenceId() const { return nextFenceId - 1; }
+	
+	void signalFences(const int64_t fenceId);
+	
+	virtual void write(const int offset, const void * bytes, const int numBytes) override;
+	
+	virtual void * insertFence() override;
+	virtual bool isFenceSignaled(void * fence) override;
+	virtual void waitFence(void * fence) override;
+	virtual void freeFence(void * fence) override;
+};
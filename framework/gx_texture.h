@@ -110,6 +110,7 @@ struct GxTexture
 	
 	void upload(const void * src, const int srcAlignment, const int srcPitch, const bool updateMipmaps = false);
 	void uploadArea(const void * src, const int srcAlignment, const int srcPitch, const int srcSx, const int srcSy, const int dstX, const int dstY);
+	void uploadMipLevel(const int level, const void * src, const int srcAlignment, const int srcPitch); // uploads a single, precomputed, mip level. the size of the level is max(1, size >> level)
 	
 	void copyRegionsFromTexture(const GxTexture & src, const CopyRegion * regions, const int numRegions);
 	
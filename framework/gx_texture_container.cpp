@@ -0,0 +1,734 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "framework.h" // logError
+#include "gx_texture_container.h"
+#include "image.h"
+#include "internal.h" // loadTextureImage
+#include "Path.h"
+#include <algorithm>
+#include <string.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <vector>
+
+#if defined(WINDOWS)
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
+#ifndef FRAMEWORK_USE_ZSTD
+	#define FRAMEWORK_USE_ZSTD 0
+#endif
+
+#if FRAMEWORK_USE_ZSTD
+	#include "zstd.h"
+#endif
+
+#define BAKED_TEXTURE_EXTENSION ".gxtex"
+
+static const char kMagic[4] = { 'G', 'X', 'T', 'C' };
+static const uint32_t kVersion = 1;
+
+static const int kLevelAlignment = 64;
+
+enum ContainerFormat // stable identifiers for the texture formats stored inside containers
+{
+	kContainerFormat_R8_UNORM = 1,
+	kContainerFormat_RGBA8_UNORM = 2,
+	kContainerFormat_R32_FLOAT = 3,
+	kContainerFormat_RGBA32_FLOAT = 4
+};
+
+enum ContainerCompression
+{
+	kContainerCompression_None = 0,
+	kContainerCompression_Zstd = 1
+};
+
+struct ContainerHeader
+{
+	char magic[4];
+	uint32_t version;
+	uint32_t format;
+	uint32_t sx;
+	uint32_t sy;
+	uint32_t numLevels;
+	uint32_t compression;
+	int32_t swizzle[4];
+	uint32_t reserved;
+	
+	struct
+	{
+		uint64_t offset;
+		uint64_t numBytes;
+		uint64_t numStoredBytes; // equal to numBytes when the level isn't compressed
+	} levels[GxTextureContainer::kMaxLevels];
+};
+
+static_assert(sizeof(ContainerHeader) == 48 + 24 * GxTextureContainer::kMaxLevels, "unexpected container header size");
+
+static bool toContainerFormat(const GX_TEXTURE_FORMAT format, uint32_t & containerFormat, int & numChannels, bool & isFloat)
+{
+	switch (format)
+	{
+	case GX_R8_UNORM:
+		containerFormat = kContainerFormat_R8_UNORM;
+		numChannels = 1;
+		isFloat = false;
+		return true;
+	case GX_RGBA8_UNORM:
+		containerFormat = kContainerFormat_RGBA8_UNORM;
+		numChannels = 4;
+		isFloat = false;
+		return true;
+	case GX_R32_FLOAT:
+		containerFormat = kContainerFormat_R32_FLOAT;
+		numChannels = 1;
+		isFloat = true;
+		return true;
+	case GX_RGBA32_FLOAT:
+		containerFormat = kContainerFormat_RGBA32_FLOAT;
+		numChannels = 4;
+		isFloat = true;
+		return true;
+	default:
+		return false;
+	}
+}
+
+static GX_TEXTURE_FORMAT fromContainerFormat(const uint32_t containerFormat)
+{
+	switch (containerFormat)
+	{
+	case kContainerFormat_R8_UNORM:
+		return GX_R8_UNORM;
+	case kContainerFormat_RGBA8_UNORM:
+		return GX_RGBA8_UNORM;
+	case kContainerFormat_R32_FLOAT:
+		return GX_R32_FLOAT;
+	case kContainerFormat_RGBA32_FLOAT:
+		return GX_RGBA32_FLOAT;
+	default:
+		return GX_UNKNOWN_FORMAT;
+	}
+}
+
+static int getNumLevels(const int sx, const int sy)
+{
+	// the same number of levels GxTexture allocates for mipmapped textures
+	
+	int numLevels = 1;
+	
+	int level_sx = sx;
+	int level_sy = sy;
+	
+	while (level_sx > 1 || level_sy > 1)
+	{
+		numLevels++;
+		level_sx /= 2;
+		level_sy /= 2;
+	}
+	
+	return numLevels;
+}
+
+template <typename T, typename Sum>
+static void downsampleLevel(const T * __restrict src, const int src_sx, const int src_sy, T * __restrict dst, const int dst_sx, const int dst_sy, const int numChannels)
+{
+	// 2x2 box filter. when the source size is odd, the last row or column is sampled twice
+	
+	for (int y = 0; y < dst_sy; ++y)
+	{
+		const int y1 = std::min(y * 2 + 0, src_sy - 1);
+		const int y2 = std::min(y * 2 + 1, src_sy - 1);
+		
+		const T * __restrict src_line1 = src + y1 * src_sx * numChannels;
+		const T * __restrict src_line2 = src + y2 * src_sx * numChannels;
+		
+		T * __restrict dst_line = dst + y * dst_sx * numChannels;
+		
+		for (int x = 0; x < dst_sx; ++x)
+		{
+			const int x1 = std::min(x * 2 + 0, src_sx - 1) * numChannels;
+			const int x2 = std::min(x * 2 + 1, src_sx - 1) * numChannels;
+			
+			for (int c = 0; c < numChannels; ++c)
+			{
+				const Sum sum =
+					Sum(src_line1[x1 + c]) +
+					Sum(src_line1[x2 + c]) +
+					Sum(src_line2[x1 + c]) +
+					Sum(src_line2[x2 + c]);
+				
+				dst_line[x * numChannels + c] = std::is_floating_point<T>::value ? T(sum / Sum(4)) : T((sum + Sum(2)) / Sum(4));
+			}
+		}
+	}
+}
+
+//
+
+struct GxTextureContainer::MappedFile
+{
+	void * address = nullptr;
+	size_t size = 0;
+	
+#if defined(WINDOWS)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#endif
+	
+	bool map(const char * filename)
+	{
+	#if defined(WINDOWS)
+		file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		
+		LARGE_INTEGER fileSize;
+		
+		if (GetFileSizeEx(file, &fileSize) == FALSE || fileSize.QuadPart == 0)
+		{
+			unmap();
+			return false;
+		}
+		
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		
+		if (mapping == nullptr)
+		{
+			unmap();
+			return false;
+		}
+		
+		address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		size = (size_t)fileSize.QuadPart;
+		
+		if (address == nullptr)
+		{
+			unmap();
+			return false;
+		}
+		
+		return true;
+	#else
+		const int fd = open(filename, O_RDONLY);
+		
+		if (fd < 0)
+			return false;
+		
+		struct stat s;
+		
+		if (fstat(fd, &s) != 0 || s.st_size == 0)
+		{
+			close(fd);
+			return false;
+		}
+		
+		void * result = mmap(nullptr, (size_t)s.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		
+		// note : the mapping remains valid after closing the file
+		
+		close(fd);
+		
+		if (result == MAP_FAILED)
+			return false;
+		
+		address = result;
+		size = (size_t)s.st_size;
+		
+		return true;
+	#endif
+	}
+	
+	void unmap()
+	{
+	#if defined(WINDOWS)
+		if (address != nullptr)
+			UnmapViewOfFile(address);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+	#else
+		if (address != nullptr)
+			munmap(address, size);
+	#endif
+		
+		address = nullptr;
+		size = 0;
+	}
+};
+
+//
+
+GxTextureContainer::GxTextureContainer()
+{
+}
+
+GxTextureContainer::~GxTextureContainer()
+{
+	free();
+}
+
+bool GxTextureContainer::load(const char * filename)
+{
+	free();
+	
+	mappedFile = new MappedFile();
+	
+	if (!mappedFile->map(filename))
+	{
+		free();
+		return false;
+	}
+	
+	const uint8_t * bytes = (const uint8_t*)mappedFile->address;
+	const uint64_t numBytes = mappedFile->size;
+	
+	// validate the header
+	
+	if (numBytes < sizeof(ContainerHeader))
+	{
+		logError("texture container is truncated: %s", filename);
+		free();
+		return false;
+	}
+	
+	ContainerHeader header;
+	memcpy(&header, bytes, sizeof(header));
+	
+	if (memcmp(header.magic, kMagic, 4) != 0 || header.version != kVersion)
+	{
+		logError("texture container has an unknown format or version: %s", filename);
+		free();
+		return false;
+	}
+	
+	format = fromContainerFormat(header.format);
+	
+	if (format == GX_UNKNOWN_FORMAT ||
+		header.sx == 0 ||
+		header.sy == 0 ||
+		header.numLevels < 1 ||
+		header.numLevels > kMaxLevels ||
+		header.numLevels > (uint32_t)getNumLevels(header.sx, header.sy) ||
+		(header.compression != kContainerCompression_None && header.compression != kContainerCompression_Zstd))
+	{
+		logError("texture container is invalid: %s", filename);
+		free();
+		return false;
+	}
+	
+#if FRAMEWORK_USE_ZSTD == 0
+	if (header.compression == kContainerCompression_Zstd)
+	{
+		logError("texture container is compressed, but zstd support is disabled: %s", filename);
+		free();
+		return false;
+	}
+#endif
+	
+	uint32_t containerFormat;
+	int numChannels;
+	bool isFloat;
+	Verify(toContainerFormat(format, containerFormat, numChannels, isFloat));
+	
+	const int bytesPerPixel = numChannels * (isFloat ? 4 : 1);
+	
+	for (int i = 0; i < 4; ++i)
+	{
+		// note : the swizzle is passed on to the graphics API, so it must be a channel index, or zero or one
+		
+		if ((header.swizzle[i] < 0 || header.swizzle[i] > 3) &&
+			header.swizzle[i] != GX_SWIZZLE_ZERO &&
+			header.swizzle[i] != GX_SWIZZLE_ONE)
+		{
+			logError("texture container has an invalid swizzle: %s", filename);
+			free();
+			return false;
+		}
+	}
+	
+	sx = header.sx;
+	sy = header.sy;
+	numLevels = header.numLevels;
+	for (int i = 0; i < 4; ++i)
+		swizzle[i] = header.swizzle[i];
+	
+	uint64_t numDecompressedBytes = 0;
+	
+	for (int i = 0; i < numLevels; ++i)
+	{
+		const int level_sx = std::max(1, sx >> i);
+		const int level_sy = std::max(1, sy >> i);
+		
+		if (header.levels[i].numBytes != uint64_t(level_sx) * level_sy * bytesPerPixel ||
+			header.levels[i].offset > numBytes ||
+			header.levels[i].numStoredBytes > numBytes - header.levels[i].offset ||
+			(header.compression == kContainerCompression_None && header.levels[i].numStoredBytes != header.levels[i].numBytes))
+		{
+			logError("texture container has an invalid level: %s", filename);
+			free();
+			return false;
+		}
+		
+		levels[i].sx = level_sx;
+		levels[i].sy = level_sy;
+		levels[i].numBytes = header.levels[i].numBytes;
+		
+		numDecompressedBytes += header.levels[i].numBytes;
+	}
+	
+	if (header.compression == kContainerCompression_None)
+	{
+		// use the levels straight from the memory mapped file
+		
+		for (int i = 0; i < numLevels; ++i)
+			levels[i].bytes = bytes + header.levels[i].offset;
+	}
+	else
+	{
+	#if FRAMEWORK_USE_ZSTD
+		decompressedBytes = new uint8_t[numDecompressedBytes];
+		
+		uint64_t offset = 0;
+		
+		for (int i = 0; i < numLevels; ++i)
+		{
+			const size_t result = ZSTD_decompress(
+				decompressedBytes + offset, header.levels[i].numBytes,
+				bytes + header.levels[i].offset, header.levels[i].numStoredBytes);
+			
+			if (ZSTD_isError(result) || result != header.levels[i].numBytes)
+			{
+				logError("failed to decompress texture container level: %s", filename);
+				free();
+				return false;
+			}
+			
+			levels[i].bytes = decompressedBytes + offset;
+			
+			offset += header.levels[i].numBytes;
+		}
+		
+		// the compressed data is no longer needed
+		
+		mappedFile->unmap();
+		delete mappedFile;
+		mappedFile = nullptr;
+	#endif
+	}
+	
+	return true;
+}
+
+void GxTextureContainer::free()
+{
+	if (mappedFile != nullptr)
+	{
+		mappedFile->unmap();
+		
+		delete mappedFile;
+		mappedFile = nullptr;
+	}
+	
+	delete [] decompressedBytes;
+	decompressedBytes = nullptr;
+	
+	format = GX_UNKNOWN_FORMAT;
+	sx = 0;
+	sy = 0;
+	for (int i = 0; i < 4; ++i)
+		swizzle[i] = i;
+	numLevels = 0;
+	for (auto & level : levels)
+		level = Level();
+}
+
+bool GxTextureContainer::hasSwizzle() const
+{
+	return
+		swizzle[0] != 0 ||
+		swizzle[1] != 1 ||
+		swizzle[2] != 2 ||
+		swizzle[3] != 3;
+}
+
+int64_t GxTextureContainer::getNumBytes() const
+{
+	int64_t result = 0;
+	
+	for (int i = 0; i < numLevels; ++i)
+		result += levels[i].numBytes;
+	
+	return result;
+}
+
+//
+
+static bool bakeTexture(const void * pixels, const int sx, const int sy, const GX_TEXTURE_FORMAT format, const int * swizzle, const GxTextureBakeOptions & options, const char * filename)
+{
+	uint32_t containerFormat;
+	int numChannels;
+	bool isFloat;
+	
+	if (toContainerFormat(format, containerFormat, numChannels, isFloat) == false)
+	{
+		logError("unsupported texture format for baking: %s", filename);
+		return false;
+	}
+	
+	if (sx <= 0 || sy <= 0)
+		return false;
+	
+	const int bytesPerPixel = numChannels * (isFloat ? 4 : 1);
+	
+	const int numLevels = options.generateMipmaps ? std::min(getNumLevels(sx, sy), (int)GxTextureContainer::kMaxLevels) : 1;
+	
+	// build the mip chain
+	
+	std::vector<uint8_t> levelBytes[GxTextureContainer::kMaxLevels];
+	
+	levelBytes[0].resize(size_t(sx) * sy * bytesPerPixel);
+	memcpy(levelBytes[0].data(), pixels, levelBytes[0].size());
+	
+	for (int i = 1; i < numLevels; ++i)
+	{
+		const int src_sx = std::max(1, sx >> (i - 1));
+		const int src_sy = std::max(1, sy >> (i - 1));
+		const int dst_sx = std::max(1, sx >> i);
+		const int dst_sy = std::max(1, sy >> i);
+		
+		levelBytes[i].resize(size_t(dst_sx) * dst_sy * bytesPerPixel);
+		
+		if (isFloat)
+			downsampleLevel<float, float>((const float*)levelBytes[i - 1].data(), src_sx, src_sy, (float*)levelBytes[i].data(), dst_sx, dst_sy, numChannels);
+		else
+			downsampleLevel<uint8_t, int>(levelBytes[i - 1].data(), src_sx, src_sy, levelBytes[i].data(), dst_sx, dst_sy, numChannels);
+	}
+	
+	// compress levels
+	
+#if FRAMEWORK_USE_ZSTD
+	const bool compress = options.compress;
+#else
+	if (options.compress)
+		logWarning("zstd support is disabled. baking an uncompressed texture container: %s", filename);
+	
+	const bool compress = false;
+#endif
+	
+	std::vector<uint8_t> storedBytes[GxTextureContainer::kMaxLevels];
+	
+#if FRAMEWORK_USE_ZSTD
+	if (compress)
+	{
+		for (int i = 0; i < numLevels; ++i)
+		{
+			storedBytes[i].resize(ZSTD_compressBound(levelBytes[i].size()));
+			
+			const size_t result = ZSTD_compress(
+				storedBytes[i].data(), storedBytes[i].size(),
+				levelBytes[i].data(), levelBytes[i].size(),
+				options.compressionLevel);
+			
+			if (ZSTD_isError(result))
+			{
+				logError("failed to compress texture container level: %s", filename);
+				return false;
+			}
+			
+			storedBytes[i].resize(result);
+		}
+	}
+#endif
+	
+	// write the header, followed by the aligned levels
+	
+	ContainerHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, kMagic, 4);
+	header.version = kVersion;
+	header.format = containerFormat;
+	header.sx = sx;
+	header.sy = sy;
+	header.numLevels = numLevels;
+	header.compression = compress ? kContainerCompression_Zstd : kContainerCompression_None;
+	for (int i = 0; i < 4; ++i)
+		header.swizzle[i] = swizzle[i];
+	
+	uint64_t offset = (sizeof(header) + kLevelAlignment - 1) & ~uint64_t(kLevelAlignment - 1);
+	
+	for (int i = 0; i < numLevels; ++i)
+	{
+		const std::vector<uint8_t> & bytes = compress ? storedBytes[i] : levelBytes[i];
+		
+		header.levels[i].offset = offset;
+		header.levels[i].numBytes = levelBytes[i].size();
+		header.levels[i].numStoredBytes = bytes.size();
+		
+		offset = (offset + bytes.size() + kLevelAlignment - 1) & ~uint64_t(kLevelAlignment - 1);
+	}
+	
+	// write to a temporary file first, so a partially written container is never picked up by the texture cache
+	
+	const std::string tempFilename = std::string(filename) + ".tmp";
+	
+	FILE * file = fopen(tempFilename.c_str(), "wb");
+	
+	if (file == nullptr)
+	{
+		logError("failed to open %s for writing", tempFilename.c_str());
+		return false;
+	}
+	
+	bool result = fwrite(&header, sizeof(header), 1, file) == 1;
+	
+	const uint8_t padding[kLevelAlignment] = { };
+	
+	uint64_t position = sizeof(header);
+	
+	for (int i = 0; i < numLevels && result; ++i)
+	{
+		const std::vector<uint8_t> & bytes = compress ? storedBytes[i] : levelBytes[i];
+		
+		result &= fwrite(padding, 1, header.levels[i].offset - position, file) == header.levels[i].offset - position;
+		result &= fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+		
+		position = header.levels[i].offset + bytes.size();
+	}
+	
+	result &= fclose(file) == 0;
+	file = nullptr;
+	
+	if (result)
+	{
+		// note : rename doesn't replace existing files on Windows
+		
+		remove(filename);
+		
+		result = rename(tempFilename.c_str(), filename) == 0;
+	}
+	
+	if (result == false)
+	{
+		logError("failed to write texture container %s", filename);
+		remove(tempFilename.c_str());
+	}
+	
+	return result;
+}
+
+bool gxBakeTexture(const void * pixels, const int sx, const int sy, const GX_TEXTURE_FORMAT format, const GxTextureBakeOptions & options, const char * filename)
+{
+	const int swizzle[4] = { 0, 1, 2, 3 };
+	
+	return bakeTexture(pixels, sx, sy, format, swizzle, options, filename);
+}
+
+bool gxBakeTextureFromImageFile(const char * srcFilename, const GxTextureBakeOptions & options)
+{
+	ImageData * imageData = loadTextureImage(srcFilename, 1.f);
+	
+	if (imageData == nullptr)
+	{
+		logError("failed to load %s", srcFilename);
+		return false;
+	}
+	
+	const std::string bakedFilename = gxGetBakedTextureFilename(srcFilename);
+	
+	// see if we can store the image as a single channel. this is the case for opaque grayscale images
+	
+	const int numPixels = imageData->sx * imageData->sy;
+	
+	bool isOpaqueGrayscale = options.allowSingleChannel;
+	
+	for (int i = 0; i < numPixels && isOpaqueGrayscale; ++i)
+	{
+		const ImageData::Pixel & pixel = imageData->imageData[i];
+		
+		isOpaqueGrayscale &= pixel.r == pixel.g && pixel.r == pixel.b && pixel.a == 255;
+	}
+	
+	bool result;
+	
+	if (isOpaqueGrayscale)
+	{
+		std::vector<uint8_t> values(numPixels);
+		
+		for (int i = 0; i < numPixels; ++i)
+			values[i] = imageData->imageData[i].r;
+		
+		const int swizzle[4] = { 0, 0, 0, GX_SWIZZLE_ONE };
+		
+		result = bakeTexture(values.data(), imageData->sx, imageData->sy, GX_R8_UNORM, swizzle, options, bakedFilename.c_str());
+	}
+	else
+	{
+		const int swizzle[4] = { 0, 1, 2, 3 };
+		
+		result = bakeTexture(imageData->imageData, imageData->sx, imageData->sy, GX_RGBA8_UNORM, swizzle, options, bakedFilename.c_str());
+	}
+	
+	delete imageData;
+	imageData = nullptr;
+	
+	return result;
+}
+
+std::string gxGetBakedTextureFilename(const char * srcFilename)
+{
+	return std::string(srcFilename) + BAKED_TEXTURE_EXTENSION;
+}
+
+bool gxBakedTextureIsUpToDate(const char * srcFilename, const char * bakedFilename)
+{
+	struct stat bakedStat;
+	
+	if (stat(bakedFilename, &bakedStat) != 0)
+		return false;
+	
+	// note : when the source image doesn't exist, we assume it was left out on purpose, and only the baked texture was distributed
+	
+	struct stat srcStat;
+	
+	if (stat(srcFilename, &srcStat) != 0)
+		return true;
+	
+	return bakedStat.st_mtime >= srcStat.st_mtime;
+}
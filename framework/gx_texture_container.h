@@ -0,0 +1,99 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include "gx_texture.h"
+#include <stdint.h>
+#include <string>
+
+/*
+ * GxTextureContainer holds texture data which is ready to be uploaded to the GPU as-is: pixels are stored in
+ * the texture format itself, and the mip chain is precomputed. Containers are produced by an offline baking
+ * step (see gxBakeTexture), and the texture cache uses them instead of decoding the source image when a baked
+ * file exists next to the source image, and it's at least as new as the source image.
+ *
+ * The levels inside the file are aligned, so uncompressed containers are used straight from a memory mapped
+ * file. Levels may optionally be compressed using zstd, which trades disk space and I/O for decompression time.
+ *
+ * note : containers are stored in little endian byte order
+ */
+
+struct GxTextureBakeOptions
+{
+	bool generateMipmaps = true;
+	bool compress = false; // compress levels using zstd. only available when built with FRAMEWORK_USE_ZSTD
+	int compressionLevel = 3;
+	bool allowSingleChannel = true; // store opaque grayscale RGBA8 images as R8, with a swizzle which expands them to RGBA again
+};
+
+class GxTextureContainer
+{
+public:
+	static const int kMaxLevels = 16;
+	
+	struct Level
+	{
+		int sx = 0;
+		int sy = 0;
+		const uint8_t * bytes = nullptr;
+		int64_t numBytes = 0;
+	};
+	
+	GX_TEXTURE_FORMAT format = GX_UNKNOWN_FORMAT;
+	int sx = 0;
+	int sy = 0;
+	int swizzle[4] = { 0, 1, 2, 3 }; // channel index, or GX_SWIZZLE_ZERO/ONE
+	int numLevels = 0;
+	Level levels[kMaxLevels];
+	
+private:
+	struct MappedFile;
+	
+	MappedFile * mappedFile = nullptr;
+	uint8_t * decompressedBytes = nullptr;
+	
+public:
+	GxTextureContainer();
+	~GxTextureContainer();
+	
+	bool load(const char * filename);
+	void free();
+	
+	bool hasSwizzle() const;
+	int64_t getNumBytes() const; // the total number of bytes for all levels, when uncompressed
+};
+
+// bakes a texture from pixels laid out the same way as for GxTexture::upload, with tightly packed rows.
+// supported formats are GX_R8_UNORM, GX_RGBA8_UNORM, GX_R32_FLOAT and GX_RGBA32_FLOAT
+bool gxBakeTexture(const void * pixels, const int sx, const int sy, const GX_TEXTURE_FORMAT format, const GxTextureBakeOptions & options, const char * filename);
+
+// decodes an image file the same way the texture cache does, and bakes it next to the source image
+bool gxBakeTextureFromImageFile(const char * srcFilename, const GxTextureBakeOptions & options);
+
+std::string gxGetBakedTextureFilename(const char * srcFilename);
+bool gxBakedTextureIsUpToDate(const char * srcFilename, const char * bakedFilename);
@@ -34,12 +34,18 @@
 #endif
 
 #include "audio.h"
+#include "gx_texture_container.h"
 #include "image.h"
 #include "internal.h"
 #include "spriter.h"
 
 #include "Path.h"
 #include "StringEx.h"
+#include "Timer.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
 
 #if USE_GLYPH_ATLAS
 	#include "textureatlas.h"
@@ -52,10 +58,6 @@
 #define STB_TRUETYPE_IMPLEMENTATION
 #include "stb_truetype.h"
 
-#if defined(DEBUG)
-	#include "Timer.h"
-#endif
-
 #define MSDF_FONT_CACHE_VERSION 6
 
 Globals globals;
@@ -165,6 +167,12 @@ ScopedLoadTimer::ScopedLoadTimer(const char * filename)
 	m_startTime = g_TimerRT.TimeUS_get();
 }
 
+ScopedLoadTimer::ScopedLoadTimer(const char * filename, const uint64_t startTime)
+	: m_filename(filename)
+	, m_startTime(startTime)
+{
+}
+
 ScopedLoadTimer::~ScopedLoadTimer()
 {
 	const uint64_t endTime = g_TimerRT.TimeUS_get();
@@ -248,6 +256,8 @@ TextureCacheElem::TextureCacheElem()
 	gridSx = gridSy = 0;
 	mipmapped = false;
 	contentScale = 0.f;
+	isLoading = false;
+	asyncLoadId = 0;
 }
 
 void TextureCacheElem::free()
@@ -371,6 +381,63 @@ static std::string getCacheFilename(const char * filename, bool forRead)
 }
 #endif
 
+static float getTextureContentScale(const int gridSx, const int gridSy, const float contentScale)
+{
+	if (gridSx != 1 || gridSy != 1)
+	{
+		// make sure the content scale is an integer when we need to subdivide the texture into a grid
+		
+		return int(ceilf(contentScale));
+	}
+	else
+	{
+		return contentScale;
+	}
+}
+
+ImageData * loadTextureImage(const char * filename, const float contentScale)
+{
+	// note : this function is called from the async loader threads. it shouldn't touch any shared state
+	
+	ImageData * imageData = loadImage(filename, contentScale);
+	
+#if 1 // imageFixAlphaFilter for png and gif
+	if (imageData != nullptr && (String::EndsWith(filename, ".png") || String::EndsWith(filename, ".gif")))
+	{
+		ImageData * temp = imageFixAlphaFilter(imageData);
+		delete imageData;
+		imageData = temp;
+	}
+#endif
+
+	return imageData;
+}
+
+static GxTextureContainer * loadBakedTexture(const char * filename, const int gridSx, const int gridSy, const float contentScale)
+{
+	// note : this function is called from the async loader threads too
+	
+	// baked textures are always baked at a content scale of one, and contain the entire image
+	
+	if (gridSx != 1 || gridSy != 1 || contentScale != 1.f)
+		return nullptr;
+	
+	const std::string bakedFilename = gxGetBakedTextureFilename(filename);
+	
+	if (gxBakedTextureIsUpToDate(filename, bakedFilename.c_str()) == false)
+		return nullptr;
+	
+	GxTextureContainer * container = new GxTextureContainer();
+	
+	if (container->load(bakedFilename.c_str()) == false)
+	{
+		delete container;
+		container = nullptr;
+	}
+	
+	return container;
+}
+
 void TextureCacheElem::load(const char * filename, int gridSx, int gridSy, bool mipmapped, float contentScale)
 {
 	ScopedLoadTimer loadTimer(filename);
@@ -378,31 +445,72 @@ void TextureCacheElem::load(const char * filename, int gridSx, int gridSy, bool
 	free();
 	
 	name = filename;
+	isLoading = false;
+	asyncLoadId = 0;
 	
-	if (gridSx != 1 || gridSy != 1)
+	contentScale = getTextureContentScale(gridSx, gridSy, contentScale);
+	
+	GxTextureContainer * container = loadBakedTexture(filename, gridSx, gridSy, contentScale);
+	
+	if (container != nullptr)
 	{
-		// make sure the content scale is an integer when we need to subdivide the texture into a grid
+		uploadBaked(filename, *container, mipmapped);
+		
+		delete container;
+		container = nullptr;
 		
-		contentScale = int(ceilf(contentScale));
+		return;
 	}
 	
-	ImageData * imageData = loadImage(filename, contentScale);
+	ImageData * imageData = loadTextureImage(filename, contentScale);
+	
+	upload(filename, imageData, gridSx, gridSy, mipmapped, contentScale);
 	
+	delete imageData;
+	imageData = nullptr;
+}
+
+void TextureCacheElem::uploadBaked(const char * filename, const GxTextureContainer & container, bool mipmapped)
+{
+	textures = new GxTexture[1];
+	
+	GxTextureProperties textureProperties;
+	textureProperties.dimensions.sx = container.sx;
+	textureProperties.dimensions.sy = container.sy;
+	textureProperties.format = container.format;
+	textureProperties.mipmapped = mipmapped;
+	
+	textures[0].allocate(textureProperties);
+	
+	const int numLevels = mipmapped ? container.numLevels : 1;
+	
+	for (int i = 0; i < numLevels; ++i)
+		textures[0].uploadMipLevel(i, container.levels[i].bytes, 1, 0);
+	
+	if (mipmapped && container.numLevels == 1)
+		textures[0].generateMipmaps();
+	
+	if (container.hasSwizzle())
+		textures[0].setSwizzle(container.swizzle[0], container.swizzle[1], container.swizzle[2], container.swizzle[3]);
+	
+	this->sx = container.sx;
+	this->sy = container.sy;
+	this->gridSx = 1;
+	this->gridSy = 1;
+	this->mipmapped = mipmapped;
+	this->contentScale = 1.f;
+	
+	logInfo("loaded %s (baked, %d levels)", filename, numLevels);
+}
+
+void TextureCacheElem::upload(const char * filename, const ImageData * imageData, int gridSx, int gridSy, bool mipmapped, float contentScale)
+{
 	if (!imageData)
 	{
 		logError("failed to load %s (%dx%d) @%.2fx", filename, gridSx, gridSy, contentScale);
 	}
 	else
 	{
-	#if 1 // imageFixAlphaFilter for png and gif
-		if (String::EndsWith(filename, ".png") || String::EndsWith(filename, ".gif"))
-		{
-			ImageData * temp = imageFixAlphaFilter(imageData);
-			delete imageData;
-			imageData = temp;
-		}
-	#endif
-
 		if ((imageData->sx % int(gridSx * contentScale)) != 0 || (imageData->sy % int(gridSy * contentScale)) != 0)
 		{
 			logError("image size (%d, %d) must be a multiple of the grid size (%d, %d) @%.2fx",
@@ -452,9 +560,6 @@ void TextureCacheElem::load(const char * filename, int gridSx, int gridSy, bool
 			
 			logInfo("loaded %s (%dx%d) @%.2fx", filename, gridSx, gridSy, contentScale);
 		}
-		
-		delete imageData;
-		imageData = nullptr;
 	}
 }
 
@@ -471,6 +576,97 @@ void TextureCacheElem::reload()
 	load(oldName.c_str(), oldGridSx, oldGridSy, oldMipmapped, oldContentScale);
 }
 
+// decodes images on a set of worker threads. uploading happens on the main thread, in TextureCache::processAsyncLoads
+
+class TextureCacheAsyncLoader
+{
+public:
+	struct Request
+	{
+		TextureCache::Key key;
+		uint32_t id = 0;
+		std::string filename;
+		float contentScale = 0.f;
+		uint64_t requestTime = 0;
+		GxTextureContainer * container = nullptr;
+		ImageData * imageData = nullptr;
+	};
+	
+	std::vector<std::thread> threads;
+	
+	std::mutex mutex;
+	std::condition_variable workEvent;
+	
+	std::deque<Request*> requests; // protected by mutex
+	std::deque<Request*> results;  // protected by mutex
+	bool stop = false;             // protected by mutex
+	
+	void init(const int numThreads)
+	{
+		for (int i = 0; i < numThreads; ++i)
+			threads.emplace_back([this]() { threadMain(); });
+	}
+	
+	void shut()
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			
+			stop = true;
+			workEvent.notify_all();
+		}
+		
+		for (auto & thread : threads)
+			thread.join();
+		threads.clear();
+		
+		for (auto * request : requests)
+			delete request;
+		requests.clear();
+		
+		for (auto * result : results)
+		{
+			delete result->container;
+			delete result->imageData;
+			delete result;
+		}
+		results.clear();
+	}
+	
+	void threadMain()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		
+		for (;;)
+		{
+			while (stop == false && requests.empty())
+				workEvent.wait(lock);
+			
+			if (stop)
+				break;
+			
+			Request * request = requests.front();
+			requests.pop_front();
+			
+			lock.unlock();
+			{
+				request->container = loadBakedTexture(request->filename.c_str(), request->key.gridSx, request->key.gridSy, request->contentScale);
+				
+				if (request->container == nullptr)
+					request->imageData = loadTextureImage(request->filename.c_str(), request->contentScale);
+			}
+			lock.lock();
+			
+			results.push_back(request);
+		}
+	}
+};
+
+TextureCache::~TextureCache()
+{
+	shutAsyncLoads();
+}
+
 void TextureCache::clear()
 {
 	for (Map::iterator i = m_map.begin(); i != m_map.end(); ++i)
@@ -479,6 +675,22 @@ void TextureCache::clear()
 	}
 	
 	m_map.clear();
+	
+	// cancel requests which haven't been picked up yet. results for requests which are being decoded
+	// right now no longer match an element and get discarded once they arrive
+	
+	if (m_asyncLoader != nullptr)
+	{
+		std::unique_lock<std::mutex> lock(m_asyncLoader->mutex);
+		
+		for (auto * request : m_asyncLoader->requests)
+		{
+			delete request;
+			m_numPendingAsyncLoads--;
+		}
+		
+		m_asyncLoader->requests.clear();
+	}
 }
 
 void TextureCache::reload()
@@ -500,7 +712,7 @@ void TextureCache::handleFileChange(const std::string & filename, const std::str
 	}
 }
 
-TextureCacheElem & TextureCache::findOrCreate(const char * name, int gridSx, int gridSy, bool mipmapped, float contentScale)
+TextureCacheElem & TextureCache::findOrCreate(const char * name, int gridSx, int gridSy, bool mipmapped, float contentScale, bool async)
 {
 	if (contentScale == 0.f)
 	{
@@ -525,6 +737,58 @@ TextureCacheElem & TextureCache::findOrCreate(const char * name, int gridSx, int
 	
 	if (i != m_map.end())
 	{
+		TextureCacheElem & elem = i->second;
+		
+		if (elem.isLoading && async == false)
+		{
+			// the caller expects the texture to be available right away. load it now. the pending result gets discarded
+			
+			elem.load(elem.name.c_str(), gridSx, gridSy, mipmapped, contentScale);
+		}
+		
+		return elem;
+	}
+	else if (async)
+	{
+		const char * resolved_filename = framework.resolveResourcePath(name);
+		
+		if (m_asyncLoader == nullptr)
+		{
+			const int numThreads = std::max(1, std::min(4, int(std::thread::hardware_concurrency()) - 1));
+			
+			m_asyncLoader = new TextureCacheAsyncLoader();
+			m_asyncLoader->init(numThreads);
+		}
+		
+		TextureCacheAsyncLoader::Request * request = new TextureCacheAsyncLoader::Request();
+		request->key = key;
+		request->id = m_nextAsyncLoadId++;
+		request->filename = resolved_filename;
+		request->contentScale = getTextureContentScale(gridSx, gridSy, contentScale);
+		request->requestTime = g_TimerRT.TimeUS_get();
+		
+		// note : the placeholder remembers the load parameters, so reloading it works like reloading a loaded texture
+		
+		TextureCacheElem elem;
+		elem.name = resolved_filename;
+		elem.gridSx = gridSx;
+		elem.gridSy = gridSy;
+		elem.mipmapped = mipmapped;
+		elem.contentScale = request->contentScale;
+		elem.isLoading = true;
+		elem.asyncLoadId = request->id;
+		
+		i = m_map.insert(Map::value_type(key, elem)).first;
+		
+		m_numPendingAsyncLoads++;
+		
+		{
+			std::unique_lock<std::mutex> lock(m_asyncLoader->mutex);
+			
+			m_asyncLoader->requests.push_back(request);
+			m_asyncLoader->workEvent.notify_one();
+		}
+		
 		return i->second;
 	}
 	else
@@ -541,6 +805,102 @@ TextureCacheElem & TextureCache::findOrCreate(const char * name, int gridSx, int
 	}
 }
 
+void TextureCache::processAsyncLoads(const int64_t maxUploadBytes)
+{
+	if (m_asyncLoader == nullptr || m_numPendingAsyncLoads == 0)
+		return;
+	
+	cpuTimingBlock(textureCacheUploads);
+	
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+	
+	int64_t numUploadBytes = 0;
+	
+	for (;;)
+	{
+		TextureCacheAsyncLoader::Request * result = nullptr;
+		
+		{
+			std::unique_lock<std::mutex> lock(m_asyncLoader->mutex);
+			
+			if (m_asyncLoader->results.empty() == false)
+			{
+				result = m_asyncLoader->results.front();
+				m_asyncLoader->results.pop_front();
+			}
+		}
+		
+		if (result == nullptr)
+			break;
+		
+		m_numPendingAsyncLoads--;
+		
+		Map::iterator i = m_map.find(result->key);
+		
+		if (i != m_map.end() && i->second.isLoading && i->second.asyncLoadId == result->id)
+		{
+			TextureCacheElem & elem = i->second;
+			
+			{
+				ScopedLoadTimer loadTimer(result->filename.c_str(), result->requestTime);
+				
+				if (result->container != nullptr)
+					elem.uploadBaked(result->filename.c_str(), *result->container, result->key.mipmapped);
+				else
+					elem.upload(result->filename.c_str(), result->imageData, result->key.gridSx, result->key.gridSy, result->key.mipmapped, result->contentScale);
+				
+				elem.isLoading = false;
+				elem.asyncLoadId = 0;
+			}
+			
+			const uint64_t latency = g_TimerRT.TimeUS_get() - result->requestTime;
+			
+			m_asyncStats.numLoads++;
+			m_asyncStats.totalLatencyUs += latency;
+			m_asyncStats.maxLatencyUs = std::max(m_asyncStats.maxLatencyUs, latency);
+			
+			if (result->container != nullptr)
+				numUploadBytes += result->container->getNumBytes();
+			else if (result->imageData != nullptr)
+				numUploadBytes += int64_t(result->imageData->sx) * result->imageData->sy * 4;
+		}
+		
+		delete result->container;
+		delete result->imageData;
+		delete result;
+		
+		if (numUploadBytes >= maxUploadBytes)
+			break;
+	}
+	
+	const uint64_t t2 = g_TimerRT.TimeUS_get();
+	
+	m_asyncStats.lastFrameUploadTimeUs = t2 - t1;
+	m_asyncStats.maxFrameUploadTimeUs = std::max(m_asyncStats.maxFrameUploadTimeUs, t2 - t1);
+	m_asyncStats.lastFrameUploadBytes = numUploadBytes;
+}
+
+void TextureCache::shutAsyncLoads()
+{
+	if (m_asyncLoader != nullptr)
+	{
+		m_asyncLoader->shut();
+		
+		delete m_asyncLoader;
+		m_asyncLoader = nullptr;
+	}
+	
+	m_numPendingAsyncLoads = 0;
+	
+	// elements which were still loading stay placeholders. forget about their loads
+	
+	for (auto & i : m_map)
+	{
+		i.second.isLoading = false;
+		i.second.asyncLoadId = 0;
+	}
+}
+
 // -----
 
 Texture3dCacheElem::Texture3dCacheElem()
@@ -686,13 +686,21 @@ public:
 	int gridSy;
 	bool mipmapped;
 	float contentScale;
+	bool isLoading; // true while the image is being decoded in the background. until then, the element is a placeholder without textures
+	uint32_t asyncLoadId; // identifies the pending async load. results which don't match (because the element got reloaded in the mean time) are discarded
 	
 	TextureCacheElem();
 	void free();
 	void load(const char * filename, int gridSx, int gridSy, bool mipmapped, float contentScale);
+	void upload(const char * filename, const class ImageData * imageData, int gridSx, int gridSy, bool mipmapped, float contentScale);
+	void uploadBaked(const char * filename, const class GxTextureContainer & container, bool mipmapped);
 	void reload();
 };
 
+class TextureCacheAsyncLoader;
+
+class ImageData * loadTextureImage(const char * filename, const float contentScale); // decodes an image the same way the texture cache does. may be called from any thread
+
 class TextureCache : public ResourceCacheBase
 {
 public:
@@ -722,12 +730,32 @@ public:
 	};
 	typedef std::map<Key, TextureCacheElem> Map;
 	
+	struct AsyncStats
+	{
+		int numLoads = 0;
+		uint64_t totalLatencyUs = 0; // time between requesting a texture and its upload
+		uint64_t maxLatencyUs = 0;
+		uint64_t lastFrameUploadTimeUs = 0;
+		uint64_t maxFrameUploadTimeUs = 0;
+		int64_t lastFrameUploadBytes = 0;
+	};
+	
 	Map m_map;
 	
+	TextureCacheAsyncLoader * m_asyncLoader = nullptr;
+	uint32_t m_nextAsyncLoadId = 1;
+	int m_numPendingAsyncLoads = 0;
+	AsyncStats m_asyncStats;
+	
+	~TextureCache();
+	
 	virtual void clear() override;
 	virtual void reload() override;
 	virtual void handleFileChange(const std::string & filename, const std::string & extension) override;
-	TextureCacheElem & findOrCreate(const char * name, int gridSx, int gridSy, bool mipmapped, float contentScale = 0.f);
+	TextureCacheElem & findOrCreate(const char * name, int gridSx, int gridSy, bool mipmapped, float contentScale = 0.f, bool async = false);
+	
+	void processAsyncLoads(const int64_t maxUploadBytes); // uploads decoded images, until the upload budget is exhausted. at least one image is uploaded per call, so progress is guaranteed
+	void shutAsyncLoads();
 };
 
 //
@@ -1206,11 +1234,16 @@ public:
 	uint64_t m_startTime;
 
 	ScopedLoadTimer(const char * filename);
+	ScopedLoadTimer(const char * filename, const uint64_t startTime); // for loads which started earlier, like asynchronous loads
 	~ScopedLoadTimer();
 #else
 	ScopedLoadTimer(const char * filename)
 	{
 	}
+	
+	ScopedLoadTimer(const char * filename, const uint64_t startTime)
+	{
+	}
 #endif
 };
 
@@ -30,6 +30,12 @@
 #include "audiostream/AudioStream.h"
 #include "audiostream/AudioStreamVorbis.h"
 
+#include "Log.h"
+
+#include "vorbis/vorbisenc.h"
+
+#include <algorithm>
+
 #include <string.h>
 #include <vector>
 
@@ -41,7 +47,7 @@ SoundData * loadSound_OGG(const char * filename)
 	std::vector<AudioSample> readBuffer;
 	
 	AudioStream_Vorbis stream;
-	stream.Open(filename, false);
+	stream.Open(filename, false, false);
 	
 	if (!stream.IsOpen_get())
 		return nullptr;
@@ -84,3 +90,186 @@ SoundData * loadSound_OGG(const char * filename)
 	
 	return soundData;
 }
+
+//
+
+class SoundWriter_OGG : public SoundWriter
+{
+	FILE * file = nullptr;
+	
+	float quality = .5f;
+	
+	int channelCount = 0;
+	
+	ogg_stream_state os;
+	vorbis_info vi;
+	vorbis_comment vc;
+	vorbis_dsp_state vd;
+	vorbis_block vb;
+	
+	bool hasError = false;
+	
+	void writePage(const ogg_page & og)
+	{
+		if (fwrite(og.header, og.header_len, 1, file) != 1 ||
+			fwrite(og.body, og.body_len, 1, file) != 1)
+		{
+			hasError = true;
+		}
+	}
+	
+	void flushBlocks()
+	{
+		// encode the blocks which are ready, and write the pages which are complete
+		
+		while (vorbis_analysis_blockout(&vd, &vb) == 1)
+		{
+			vorbis_analysis(&vb, nullptr);
+			vorbis_bitrate_addblock(&vb);
+			
+			ogg_packet op;
+			
+			while (vorbis_bitrate_flushpacket(&vd, &op))
+			{
+				ogg_stream_packetin(&os, &op);
+				
+				ogg_page og;
+				
+				while (ogg_stream_pageout(&os, &og))
+					writePage(og);
+			}
+		}
+	}
+	
+public:
+	SoundWriter_OGG(const float in_quality)
+		: quality(in_quality)
+	{
+	}
+	
+	virtual ~SoundWriter_OGG() override
+	{
+		close();
+	}
+	
+	virtual bool open(const char * filename, const int in_channelCount, const int sampleRate) override
+	{
+		close();
+		
+		vorbis_info_init(&vi);
+		
+		if (vorbis_encode_init_vbr(&vi, in_channelCount, sampleRate, std::max(-.1f, std::min(1.f, quality))) != 0)
+		{
+			LOG_ERR("failed to initialize the Vorbis encoder. channelCount=%d, sampleRate=%d", in_channelCount, sampleRate);
+			vorbis_info_clear(&vi);
+			return false;
+		}
+		
+		file = fopen(filename, "wb");
+		
+		if (file == nullptr)
+		{
+			LOG_ERR("failed to open %s", filename);
+			vorbis_info_clear(&vi);
+			return false;
+		}
+		
+		channelCount = in_channelCount;
+		hasError = false;
+		
+		vorbis_comment_init(&vc);
+		vorbis_analysis_init(&vd, &vi);
+		vorbis_block_init(&vd, &vb);
+		
+		// note : we use a fixed serial number, so encoding the same audio twice produces identical files
+		
+		ogg_stream_init(&os, 1);
+		
+		// write the header packets. they must be on pages of their own, so we flush the stream here
+		
+		ogg_packet header;
+		ogg_packet headerComment;
+		ogg_packet headerCode;
+		
+		vorbis_analysis_headerout(&vd, &vc, &header, &headerComment, &headerCode);
+		
+		ogg_stream_packetin(&os, &header);
+		ogg_stream_packetin(&os, &headerComment);
+		ogg_stream_packetin(&os, &headerCode);
+		
+		ogg_page og;
+		
+		while (ogg_stream_flush(&os, &og))
+			writePage(og);
+		
+		return hasError == false;
+	}
+	
+	virtual bool write(const float * samples, const int numFrames) override
+	{
+		if (file == nullptr)
+			return false;
+		
+		// encode the samples in batches, to avoid the encoder allocating memory proportional to the number of frames
+		
+		const int kBatchSize = 1024;
+		
+		for (int i = 0; i < numFrames; i += kBatchSize)
+		{
+			const int numFramesInBatch = std::min(kBatchSize, numFrames - i);
+			
+			float ** buffer = vorbis_analysis_buffer(&vd, numFramesInBatch);
+			
+			const float * __restrict src = samples + i * channelCount;
+			
+			for (int c = 0; c < channelCount; ++c)
+			{
+				float * __restrict dst = buffer[c];
+				
+				for (int j = 0; j < numFramesInBatch; ++j)
+					dst[j] = src[j * channelCount + c];
+			}
+			
+			vorbis_analysis_wrote(&vd, numFramesInBatch);
+			
+			flushBlocks();
+		}
+		
+		return hasError == false;
+	}
+	
+	virtual bool close() override
+	{
+		if (file == nullptr)
+			return false;
+		
+		// signal the end of the stream and write the remaining pages
+		
+		vorbis_analysis_wrote(&vd, 0);
+		
+		flushBlocks();
+		
+		ogg_page og;
+		
+		while (ogg_stream_flush(&os, &og))
+			writePage(og);
+		
+		ogg_stream_clear(&os);
+		vorbis_block_clear(&vb);
+		vorbis_dsp_clear(&vd);
+		vorbis_comment_clear(&vc);
+		vorbis_info_clear(&vi);
+		
+		if (fclose(file) != 0)
+			hasError = true;
+		
+		file = nullptr;
+		
+		return hasError == false;
+	}
+};
+
+SoundWriter * createSoundWriter_OGG(const float quality)
+{
+	return new SoundWriter_OGG(quality);
+}
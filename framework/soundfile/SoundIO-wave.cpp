@@ -33,6 +33,9 @@
 
 #include "Log.h"
 
+#include <algorithm>
+#include <math.h>
+
 SoundData * loadSound_WAV(const char * filename)
 {
 	FileReader r;
@@ -168,3 +171,171 @@ SoundData * loadSound_WAV(const char * filename)
 	
 	return soundData;
 }
+
+//
+
+class SoundWriter_WAV : public SoundWriter
+{
+	FILE * file = nullptr;
+	
+	bool writeFloats = false;
+	
+	int channelCount = 0;
+	
+	uint64_t numDataBytes = 0;
+	
+	bool hasError = false;
+	
+	template <typename T>
+	void writeValue(const T & value)
+	{
+		if (fwrite(&value, sizeof(value), 1, file) != 1)
+			hasError = true;
+	}
+	
+	void writeId(const char * id)
+	{
+		if (fwrite(id, 4, 1, file) != 1)
+			hasError = true;
+	}
+	
+	void writeHeaders(const int sampleRate)
+	{
+		const int16_t bitDepth = writeFloats ? 32 : 16;
+		const int16_t blockAlign = channelCount * bitDepth / 8;
+		
+		// note : the RIFF and data chunk sizes are patched when closing the file
+		
+		writeId("RIFF");
+		writeValue<int32_t>(0);
+		writeId("WAVE");
+		
+		writeId("fmt ");
+		writeValue<int32_t>(16);
+		writeValue<int16_t>(writeFloats ? WAVE_FORMAT_IEEE_FLOAT : WAVE_FORMAT_PCM);
+		writeValue<int16_t>(channelCount);
+		writeValue<int32_t>(sampleRate);
+		writeValue<int32_t>(sampleRate * blockAlign);
+		writeValue<int16_t>(blockAlign);
+		writeValue<int16_t>(bitDepth);
+		
+		writeId("data");
+		writeValue<int32_t>(0);
+	}
+	
+public:
+	SoundWriter_WAV(const bool in_writeFloats)
+		: writeFloats(in_writeFloats)
+	{
+	}
+	
+	virtual ~SoundWriter_WAV() override
+	{
+		close();
+	}
+	
+	virtual bool open(const char * filename, const int in_channelCount, const int sampleRate) override
+	{
+		close();
+		
+		file = fopen(filename, "wb");
+		
+		if (file == nullptr)
+		{
+			LOG_ERR("failed to open %s", filename);
+			return false;
+		}
+		
+		channelCount = in_channelCount;
+		numDataBytes = 0;
+		hasError = false;
+		
+		writeHeaders(sampleRate);
+		
+		return hasError == false;
+	}
+	
+	virtual bool write(const float * samples, const int numFrames) override
+	{
+		if (file == nullptr)
+			return false;
+		
+		const int numSamples = numFrames * channelCount;
+		
+		if (writeFloats)
+		{
+			if (fwrite(samples, sizeof(float), numSamples, file) != (size_t)numSamples)
+				hasError = true;
+			
+			numDataBytes += numSamples * sizeof(float);
+		}
+		else
+		{
+			// convert the samples in batches, to avoid allocating memory proportional to the number of frames
+			
+			const int kBatchSize = 1024;
+			
+			int16_t values[kBatchSize];
+			
+			for (int i = 0; i < numSamples; i += kBatchSize)
+			{
+				const int numValues = std::min(kBatchSize, numSamples - i);
+				
+				for (int j = 0; j < numValues; ++j)
+				{
+					const float value = std::max(-1.f, std::min(+1.f, samples[i + j]));
+					
+					values[j] = (int16_t)lrintf(value * 32767.f);
+				}
+				
+				if (fwrite(values, sizeof(int16_t), numValues, file) != (size_t)numValues)
+					hasError = true;
+			}
+			
+			numDataBytes += numSamples * sizeof(int16_t);
+		}
+		
+		return hasError == false;
+	}
+	
+	virtual bool close() override
+	{
+		if (file == nullptr)
+			return false;
+		
+		// patch the chunk sizes, now we know the size of the data
+		
+		if (numDataBytes > 0xffffffff - 36)
+		{
+			LOG_ERR("WAVE data exceeds the maximum size of a WAVE file");
+			hasError = true;
+		}
+		else
+		{
+			const uint32_t riffSize = uint32_t(36 + numDataBytes);
+			const uint32_t dataSize = uint32_t(numDataBytes);
+			
+			if (fseek(file, 4, SEEK_SET) != 0)
+				hasError = true;
+			else
+				writeValue(riffSize);
+			
+			if (fseek(file, 40, SEEK_SET) != 0)
+				hasError = true;
+			else
+				writeValue(dataSize);
+		}
+		
+		if (fclose(file) != 0)
+			hasError = true;
+		
+		file = nullptr;
+		
+		return hasError == false;
+	}
+};
+
+SoundWriter * createSoundWriter_WAV(const bool writeFloats)
+{
+	return new SoundWriter_WAV(writeFloats);
+}
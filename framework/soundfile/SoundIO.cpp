@@ -39,3 +39,15 @@ SoundData * loadSound(const char * filename)
 	else
 		return nullptr;
 }
+
+SoundWriter * createSoundWriter(const char * filename)
+{
+	const std::string extension = Path::GetExtension(filename, true);
+	
+	if (extension == "ogg")
+		return createSoundWriter_OGG();
+	else if (extension == "wav")
+		return createSoundWriter_WAV();
+	else
+		return nullptr;
+}
@@ -53,3 +53,29 @@ SoundData * loadSound(const char * filename);
 
 SoundData * loadSound_OGG(const char * filename);
 SoundData * loadSound_WAV(const char * filename);
+
+//
+
+/*
+SoundWriter streams audio to a sound file. Samples are provided as interleaved 32 bit floats, one
+block at a time, so the amount of memory used while writing doesn't depend on the length of the
+sound. WAVE files are written as either 16 bit integer or 32 bit float PCM. OGG files are encoded
+using Vorbis at the given quality, ranging from 0.0 (lowest) to 1.0 (highest).
+*/
+
+class SoundWriter
+{
+public:
+	virtual ~SoundWriter()
+	{
+	}
+	
+	virtual bool open(const char * filename, const int channelCount, const int sampleRate) = 0;
+	virtual bool write(const float * samples, const int numFrames) = 0;
+	virtual bool close() = 0; // finalizes the file. returns false if any of the writes failed
+};
+
+SoundWriter * createSoundWriter(const char * filename); // creates a writer based on the file extension
+
+SoundWriter * createSoundWriter_OGG(const float quality = .5f);
+SoundWriter * createSoundWriter_WAV(const bool writeFloats = false);
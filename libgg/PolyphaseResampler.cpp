@@ -0,0 +1,444 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "PolyphaseResampler.h"
+#include <algorithm>
+#include <math.h>
+#include <string.h>
+
+#ifdef __SSE2__
+	#include <xmmintrin.h>
+#endif
+
+#define RESAMPLE_FIXEDBITS 32
+
+static const int kNumPhases = 1 << PolyphaseResampler::kNumPhaseBits;
+
+// the cutoff frequency is lowered in steps of 1/8th octave when downsampling, for up to 5 octaves
+static const int kNumCutoffStepsPerOctave = 8;
+static const int kNumCutoffSteps = 5 * kNumCutoffStepsPerOctave + 1;
+
+struct SincParams
+{
+	int numTaps;
+	double cutoff; // relative to the Nyquist frequency
+	double beta; // Kaiser window shape
+};
+
+// the history is sized to hold this many input frames, on top of the taps of the longest filter
+static const int kHistoryInputFrames = 1024;
+static const int kMaxNumTaps = 64;
+
+static const SincParams s_sincParams[3] =
+{
+	{ 16, .86, 7.0 },
+	{ 32, .93, 8.6 },
+	{ 64, .96, 10.0 }
+};
+
+struct PolyphaseResampler::FilterBank
+{
+	int numTaps = 0;
+	
+	std::vector<float> coefficients; // (kNumPhases + 1) rows of numTaps coefficients
+};
+
+static double besselI0(const double x)
+{
+	double sum = 1.0;
+	double term = 1.0;
+	
+	for (int k = 1; k < 32; ++k)
+	{
+		term *= (x / (2.0 * k)) * (x / (2.0 * k));
+		sum += term;
+		
+		if (term < sum * 1e-12)
+			break;
+	}
+	
+	return sum;
+}
+
+static PolyphaseResampler::FilterBank * createFilterBank(const SincParams & params, const int cutoffStep)
+{
+	PolyphaseResampler::FilterBank * filterBank = new PolyphaseResampler::FilterBank();
+	
+	const int numTaps = params.numTaps;
+	const int halfTaps = numTaps / 2;
+	
+	const double cutoff = params.cutoff * pow(2.0, - cutoffStep / double(kNumCutoffStepsPerOctave));
+	const double windowScale = 1.0 / besselI0(params.beta);
+	
+	filterBank->numTaps = numTaps;
+	filterBank->coefficients.resize((kNumPhases + 1) * numTaps);
+	
+	for (int phase = 0; phase <= kNumPhases; ++phase)
+	{
+		float * __restrict coefficients = filterBank->coefficients.data() + phase * numTaps;
+		
+		const double fraction = phase / double(kNumPhases);
+		
+		double sum = 0.0;
+		
+		for (int i = 0; i < numTaps; ++i)
+		{
+			// distance between the input sample for this tap and the output position
+			
+			const double t = (i - (halfTaps - 1)) - fraction;
+			
+			const double x = M_PI * cutoff * t;
+			const double sinc = fabs(x) < 1e-9 ? 1.0 : sin(x) / x;
+			
+			const double w = t / halfTaps;
+			const double window = fabs(w) >= 1.0 ? 0.0 : besselI0(params.beta * sqrt(1.0 - w * w)) * windowScale;
+			
+			const double value = sinc * window;
+			
+			coefficients[i] = float(value);
+			
+			sum += value;
+		}
+		
+		// normalize for unity gain at DC, for each phase
+		
+		for (int i = 0; i < numTaps; ++i)
+			coefficients[i] = float(coefficients[i] / sum);
+	}
+	
+	return filterBank;
+}
+
+// note : filter banks are immutable once created and shared between all resamplers. they live until the application exits
+static const PolyphaseResampler::FilterBank * s_filterBanks[3][kNumCutoffSteps] = { };
+
+static bool createFilterBanks()
+{
+	for (int sincIndex = 0; sincIndex < 3; ++sincIndex)
+		for (int cutoffStep = 0; cutoffStep < kNumCutoffSteps; ++cutoffStep)
+			s_filterBanks[sincIndex][cutoffStep] = createFilterBank(s_sincParams[sincIndex], cutoffStep);
+	
+	return true;
+}
+
+static inline void dotProduct2(
+	const float * __restrict x,
+	const float * __restrict a,
+	const float * __restrict b,
+	const int numTaps,
+	float & resultA,
+	float & resultB)
+{
+#ifdef __SSE2__
+	__m128 sumA = _mm_setzero_ps();
+	__m128 sumB = _mm_setzero_ps();
+	
+	for (int i = 0; i < numTaps; i += 4)
+	{
+		const __m128 xv = _mm_loadu_ps(x + i);
+		
+		sumA = _mm_add_ps(sumA, _mm_mul_ps(xv, _mm_loadu_ps(a + i)));
+		sumB = _mm_add_ps(sumB, _mm_mul_ps(xv, _mm_loadu_ps(b + i)));
+	}
+	
+	// horizontal add of both sums at once
+	
+	const __m128 lo = _mm_unpacklo_ps(sumA, sumB); // a0 b0 a1 b1
+	const __m128 hi = _mm_unpackhi_ps(sumA, sumB); // a2 b2 a3 b3
+	const __m128 sum = _mm_add_ps(lo, hi);
+	const __m128 result = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+	
+	float values[4];
+	_mm_storeu_ps(values, result);
+	
+	resultA = values[0];
+	resultB = values[1];
+#else
+	float sumA = 0.f;
+	float sumB = 0.f;
+	
+	for (int i = 0; i < numTaps; ++i)
+	{
+		sumA += x[i] * a[i];
+		sumB += x[i] * b[i];
+	}
+	
+	resultA = sumA;
+	resultB = sumB;
+#endif
+}
+
+//
+
+PolyphaseResampler::PolyphaseResampler()
+	: numChannels(0)
+	, quality(kResampleQuality_Linear)
+	, numTaps(2)
+	, filterBank(nullptr)
+	, history()
+	, historyCapacity(0)
+	, numHistoryFrames(0)
+	, position_fp(0)
+	, increment_fp(int64_t(1) << RESAMPLE_FIXEDBITS)
+{
+}
+
+void PolyphaseResampler::init(const int _numChannels, const ResampleQuality _quality)
+{
+	Assert(_numChannels >= 1 && _numChannels <= kMaxChannels);
+	
+	// note : the filter banks for all qualities and cutoff frequencies are created the first time a resampler is
+	//        initialized, so setRatio and switching qualities never allocate memory or compute filter taps
+	
+	static const bool s_filterBanksCreated = createFilterBanks();
+	(void)s_filterBanksCreated;
+	
+	// note : the history is sized for the longest filter, so switching qualities doesn't reallocate it
+	
+	if (_numChannels != numChannels || historyCapacity < kHistoryInputFrames + kMaxNumTaps)
+	{
+		numChannels = _numChannels;
+		
+		historyCapacity = 0;
+		numHistoryFrames = 0;
+		history.clear();
+		ensureHistoryCapacity(kHistoryInputFrames + kMaxNumTaps);
+	}
+	
+	quality = _quality;
+	
+	switch (quality)
+	{
+	case kResampleQuality_Linear:
+		numTaps = 2;
+		break;
+	case kResampleQuality_Cubic:
+		numTaps = 4;
+		break;
+	case kResampleQuality_Sinc16:
+	case kResampleQuality_Sinc32:
+	case kResampleQuality_Sinc64:
+		numTaps = s_sincParams[quality - kResampleQuality_Sinc16].numTaps;
+		break;
+	default:
+		Assert(false);
+		quality = kResampleQuality_Linear;
+		numTaps = 2;
+		break;
+	}
+	
+	setRatio(getRatio());
+	
+	reset();
+}
+
+void PolyphaseResampler::reset()
+{
+	// prime the history with silence, so the taps before the first input frame have something to read from
+	
+	const int halfTaps = numTaps / 2;
+	
+	std::fill(history.begin(), history.end(), 0.f);
+	
+	numHistoryFrames = halfTaps - 1;
+	position_fp = int64_t(halfTaps - 1) << RESAMPLE_FIXEDBITS;
+}
+
+void PolyphaseResampler::setRatio(const double ratio)
+{
+	Assert(ratio > 0.0);
+	
+	increment_fp = int64_t(ratio * (int64_t(1) << RESAMPLE_FIXEDBITS) + .5);
+	
+	if (quality >= kResampleQuality_Sinc16)
+	{
+		// lower the cutoff frequency when downsampling. we round up to the next step, to be sure not to alias
+		
+		int cutoffStep = ratio <= 1.0 ? 0 : (int)ceil(log2(ratio) * kNumCutoffStepsPerOctave - 1e-6);
+		
+		if (cutoffStep > kNumCutoffSteps - 1)
+			cutoffStep = kNumCutoffSteps - 1;
+		
+		filterBank = s_filterBanks[quality - kResampleQuality_Sinc16][cutoffStep];
+	}
+	else
+	{
+		filterBank = nullptr;
+	}
+}
+
+double PolyphaseResampler::getRatio() const
+{
+	return increment_fp / double(int64_t(1) << RESAMPLE_FIXEDBITS);
+}
+
+int PolyphaseResampler::calculateNumInputFrames(const int numOutputFrames) const
+{
+	if (numOutputFrames <= 0)
+		return 0;
+	
+	const int64_t lastPosition_fp = position_fp + (numOutputFrames - 1) * increment_fp;
+	const int64_t lastIndex = (lastPosition_fp >> RESAMPLE_FIXEDBITS) + numTaps / 2;
+	
+	const int64_t numInputFrames = lastIndex + 1 - numHistoryFrames;
+	
+	return numInputFrames < 0 ? 0 : int(numInputFrames);
+}
+
+int PolyphaseResampler::calculateNumLookaheadFrames() const
+{
+	// the number of input frames consumed beyond the position of the next output frame
+	
+	return numHistoryFrames - 1 - int(position_fp >> RESAMPLE_FIXEDBITS);
+}
+
+void PolyphaseResampler::ensureHistoryCapacity(const int capacity)
+{
+	if (capacity <= historyCapacity)
+		return;
+	
+	int newCapacity = historyCapacity < 16 ? 16 : historyCapacity;
+	while (newCapacity < capacity)
+		newCapacity *= 2;
+	
+	std::vector<float> newHistory(newCapacity * numChannels, 0.f);
+	
+	for (int c = 0; c < numChannels && historyCapacity != 0; ++c)
+		memcpy(&newHistory[c * newCapacity], &history[c * historyCapacity], numHistoryFrames * sizeof(float));
+	
+	history.swap(newHistory);
+	historyCapacity = newCapacity;
+}
+
+void PolyphaseResampler::process(const float * const * input, const int numInputFrames, float * const * output, const int numOutputFrames)
+{
+	Assert(numInputFrames >= calculateNumInputFrames(numOutputFrames));
+	
+	// append the input to the history
+	
+	ensureHistoryCapacity(numHistoryFrames + numInputFrames);
+	
+	for (int c = 0; c < numChannels; ++c)
+		memcpy(&history[c * historyCapacity + numHistoryFrames], input[c], numInputFrames * sizeof(float));
+	
+	numHistoryFrames += numInputFrames;
+	
+	// generate output
+	
+	const int halfTaps = numTaps / 2;
+	
+	const float * __restrict historyPtr = history.data();
+	
+	int64_t position = position_fp;
+	
+	if (quality == kResampleQuality_Linear)
+	{
+		for (int i = 0; i < numOutputFrames; ++i, position += increment_fp)
+		{
+			const int index = int(position >> RESAMPLE_FIXEDBITS);
+			const float t = uint32_t(position) * (1.f / 4294967296.f);
+			
+			for (int c = 0; c < numChannels; ++c)
+			{
+				const float * __restrict x = historyPtr + c * historyCapacity + index;
+				
+				output[c][i] = x[0] + (x[1] - x[0]) * t;
+			}
+		}
+	}
+	else if (quality == kResampleQuality_Cubic)
+	{
+		for (int i = 0; i < numOutputFrames; ++i, position += increment_fp)
+		{
+			const int index = int(position >> RESAMPLE_FIXEDBITS);
+			const float t = uint32_t(position) * (1.f / 4294967296.f);
+			
+			for (int c = 0; c < numChannels; ++c)
+			{
+				// Catmull-Rom spline through x[-1] .. x[2]
+				
+				const float * __restrict x = historyPtr + c * historyCapacity + index;
+				
+				const float a = -.5f * x[-1] + 1.5f * x[0] - 1.5f * x[1] + .5f * x[2];
+				const float b = x[-1] - 2.5f * x[0] + 2.f * x[1] - .5f * x[2];
+				const float d = -.5f * x[-1] + .5f * x[1];
+				
+				output[c][i] = ((a * t + b) * t + d) * t + x[0];
+			}
+		}
+	}
+	else
+	{
+		const float * __restrict coefficients = filterBank->coefficients.data();
+		
+		const int kFractionBits = RESAMPLE_FIXEDBITS - kNumPhaseBits;
+		
+		for (int i = 0; i < numOutputFrames; ++i, position += increment_fp)
+		{
+			const int firstIndex = int(position >> RESAMPLE_FIXEDBITS) - (halfTaps - 1);
+			const uint32_t fraction = uint32_t(position);
+			
+			const int phase = fraction >> kFractionBits;
+			const float t = (fraction & ((1u << kFractionBits) - 1)) * (1.f / (1u << kFractionBits));
+			
+			const float * __restrict coefficients1 = coefficients + phase * numTaps;
+			const float * __restrict coefficients2 = coefficients1 + numTaps;
+			
+			for (int c = 0; c < numChannels; ++c)
+			{
+				const float * __restrict x = historyPtr + c * historyCapacity + firstIndex;
+				
+				float value1;
+				float value2;
+				dotProduct2(x, coefficients1, coefficients2, numTaps, value1, value2);
+				
+				output[c][i] = value1 + (value2 - value1) * t;
+			}
+		}
+	}
+	
+	// discard the history we no longer need
+	
+	const int firstIndexNeeded = int(position >> RESAMPLE_FIXEDBITS) - (halfTaps - 1);
+	const int numFramesToDiscard = std::min(firstIndexNeeded, numHistoryFrames);
+	
+	if (numFramesToDiscard > 0)
+	{
+		for (int c = 0; c < numChannels; ++c)
+		{
+			float * channelHistory = &history[c * historyCapacity];
+			
+			memmove(channelHistory, channelHistory + numFramesToDiscard, (numHistoryFrames - numFramesToDiscard) * sizeof(float));
+		}
+		
+		numHistoryFrames -= numFramesToDiscard;
+		position -= int64_t(numFramesToDiscard) << RESAMPLE_FIXEDBITS;
+	}
+	
+	position_fp = position;
+}
@@ -0,0 +1,115 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+enum ResampleQuality
+{
+	kResampleQuality_Linear,
+	kResampleQuality_Cubic,
+	kResampleQuality_Sinc16,
+	kResampleQuality_Sinc32,
+	kResampleQuality_Sinc64,
+	kResampleQuality_COUNT
+};
+
+/*
+
+PolyphaseResampler:
+
+Streaming sample rate converter for planar float audio. Linear and cubic interpolation are provided for when speed
+matters more than quality. The sinc qualities use a Kaiser windowed-sinc filter, stored as a polyphase filter bank
+with 256 phases, which is linearly interpolated between adjacent phases. When the ratio is larger than one
+(downsampling, or pitching up), the cutoff frequency of the filter is lowered to avoid aliasing.
+
+The resampler doesn't introduce any latency: output sample n corresponds to input position n * ratio. To make this
+possible, it looks ahead (numTaps / 2) input samples. Use calculateNumInputFrames to determine how many input frames
+must be passed to process, to generate the requested number of output frames.
+
+init allocates the input history and, the first time it's called, creates the filter banks for all qualities and
+cutoff frequencies. Call it off the audio thread. Once initialized, setRatio and process don't allocate memory, as
+long as no more than 1024 input frames are passed to process at once. Calling init again to switch qualities
+doesn't allocate either, as long as the number of channels stays the same.
+
+example usage:
+
+	PolyphaseResampler resampler;
+	resampler.init(1, kResampleQuality_Sinc32);
+	resampler.setRatio(44100.0 / 48000.0);
+	
+	const int numInputFrames = resampler.calculateNumInputFrames(kNumOutputFrames);
+	
+	provideInput(input, numInputFrames);
+	
+	resampler.process(&input, numInputFrames, &output, kNumOutputFrames);
+
+*/
+
+class PolyphaseResampler
+{
+public:
+	static const int kMaxChannels = 8;
+	static const int kNumPhaseBits = 8;
+	
+	struct FilterBank;
+	
+	PolyphaseResampler();
+	
+	void init(const int numChannels, const ResampleQuality quality);
+	void reset();
+	
+	void setRatio(const double ratio); // the number of input frames consumed per output frame
+	double getRatio() const;
+	
+	int getNumChannels() const { return numChannels; }
+	ResampleQuality getQuality() const { return quality; }
+	int getNumTaps() const { return numTaps; }
+	
+	int calculateNumInputFrames(const int numOutputFrames) const;
+	int calculateNumLookaheadFrames() const;
+	
+	void process(const float * const * input, const int numInputFrames, float * const * output, const int numOutputFrames);
+	
+private:
+	int numChannels;
+	ResampleQuality quality;
+	int numTaps;
+	
+	const FilterBank * filterBank; // only used by the sinc qualities
+	
+	std::vector<float> history; // planar input history, one stretch of historyCapacity frames per channel
+	int historyCapacity;
+	int numHistoryFrames;
+	
+	int64_t position_fp; // 32.32 fixed point position within the history of the current output frame
+	int64_t increment_fp;
+	
+	void ensureHistoryCapacity(const int capacity);
+};
@@ -759,5 +759,11 @@ void ParticleEditor::tick(const bool menuActive, const float sx, const float sy,
 
 void ParticleEditor::draw(const bool menuActive, const float sx, const float sy)
 {
+	// note : particles and the editor ui are drawn using many small gxBegin/gxEnd pairs. let the immediate mode batcher merge them
+	const bool batchingWasEnabled = gxGetBatchingEnabled();
+	gxSetBatchingEnabled(true);
+	
 	state->draw(menuActive, sx, sy);
+	
+	gxSetBatchingEnabled(batchingWasEnabled);
 }
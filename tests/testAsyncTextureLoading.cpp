@@ -0,0 +1,155 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "framework.h"
+#include "Path.h"
+#include "testBase.h"
+#include "Timer.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+extern const int GFX_SX;
+extern const int GFX_SY;
+
+void testAsyncTextureLoading()
+{
+	setAbout("This example loads all images inside the data folder, either asynchronously using a batch preload, or synchronously the first time they are drawn. Images are drawn as a grey placeholder until they are available. The graph at the bottom shows the time spent inside framework.process() and drawing each frame. Synchronous loads show up as large spikes, asynchronous loads as a bounded amount of upload time per frame.");
+	setInstructions("A: toggle asynchronous loading. Space: clear the texture cache and load all images again");
+	
+	std::vector<std::string> filenames;
+	
+	for (auto & filename : listFiles(".", true))
+	{
+		const std::string extension = Path::GetExtension(filename, true);
+		
+		if (extension == "png" || extension == "jpg" || extension == "jpeg")
+			filenames.push_back(filename);
+	}
+	
+	const bool oldAsyncTextureLoading = framework.asyncTextureLoading;
+	
+	bool async = true;
+	bool reload = true;
+	
+	uint64_t loadStartTime = 0;
+	uint64_t loadTime = 0;
+	
+	const int kNumFrameTimes = 200;
+	float frameTimes[kNumFrameTimes] = { };
+	int frameIndex = 0;
+	
+	do
+	{
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		framework.process();
+		
+		if (keyboard.wentDown(SDLK_a))
+		{
+			async = !async;
+			reload = true;
+		}
+		
+		if (keyboard.wentDown(SDLK_SPACE))
+			reload = true;
+		
+		framework.asyncTextureLoading = async;
+		
+		if (reload)
+		{
+			reload = false;
+			
+			clearCaches(CACHE_TEXTURE);
+			
+			if (async)
+				framework.preloadTextures(filenames);
+			
+			loadStartTime = t1;
+			loadTime = 0;
+		}
+		
+		framework.beginDraw(0, 0, 0, 0);
+		{
+			const int kCellSize = 80;
+			const int numColumns = (GFX_SX - 40) / kCellSize;
+			
+			for (size_t i = 0; i < filenames.size(); ++i)
+			{
+				const int x = 20 + (i % numColumns) * kCellSize;
+				const int y = 100 + (i / numColumns) * kCellSize;
+				
+				const GxTextureId texture = getTexture(filenames[i].c_str());
+				
+				if (texture != 0)
+				{
+					setColor(colorWhite);
+					gxSetTexture(texture, GX_SAMPLE_LINEAR, true);
+					drawRect(x, y, x + kCellSize - 4, y + kCellSize - 4);
+					gxClearTexture();
+				}
+				else
+				{
+					setColor(60, 60, 60);
+					drawRect(x, y, x + kCellSize - 4, y + kCellSize - 4);
+				}
+			}
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			if (loadTime == 0 && framework.getNumPendingTextureLoads() == 0)
+				loadTime = t2 - loadStartTime;
+			
+			frameTimes[frameIndex % kNumFrameTimes] = (t2 - t1) / 1000.f;
+			frameIndex++;
+			
+			const float graphY = GFX_SY - 60.f;
+			
+			for (int i = 0; i < kNumFrameTimes; ++i)
+			{
+				const float frameTime = frameTimes[(frameIndex + i) % kNumFrameTimes];
+				
+				setColor(frameTime > 16.f ? colorRed : colorGreen);
+				drawRect(20 + i * 4, graphY - std::min(frameTime, 50.f), 20 + i * 4 + 3, graphY);
+			}
+			
+			setFont("calibri.ttf");
+			setColor(colorWhite);
+			drawText(20, 20, 16, +1, +1, "%s loading, %d images, pending: %d",
+				async ? "asynchronous" : "synchronous",
+				(int)filenames.size(),
+				framework.getNumPendingTextureLoads());
+			if (loadTime != 0)
+				drawText(20, 44, 14, +1, +1, "all images loaded after %.2fms", loadTime / 1000.f);
+			
+			drawTestUi();
+		}
+		framework.endDraw();
+	} while (tickTestUi());
+	
+	framework.asyncTextureLoading = oldAsyncTextureLoading;
+}
@@ -61,6 +61,9 @@ extern void testStbTruetype();
 extern void testMsdfgen();
 extern void testDeepbelief();
 extern void testImageCpuDelayLine();
+extern void testStreamingBuffer();
+extern void testAsyncTextureLoading();
+extern void testTextureContainer();
 #ifndef WIN32
 extern void testXmm();
 #endif
@@ -485,6 +488,9 @@ static bool doMenus(const bool tick, const bool draw, const float dt)
 	doButton("DTAtl", "Dynamic Texture Atlas", testDynamicTextureAtlas);
 	doButton("Fr2D", "2D Fourier Analysis", testFourier2d);
 	doButton("ImDL", "CPU-image delay line", testImageCpuDelayLine);
+	doButton("StBf", "Streaming vertex buffer", testStreamingBuffer);
+	doButton("AsTx", "Async texture loading", testAsyncTextureLoading);
+	doButton("TxCn", "Texture containers", testTextureContainer);
 	doButton("DrPr", "Drawing Primitives", testHqPrimitives);
 	doButton("HRTF", "Binaural Sound", testHrtf);
 	doButton("IRm", "Impulse-Response", testImpulseResponseMeasurement);
@@ -0,0 +1,216 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "framework.h"
+#include "gx_streaming_buffer.h"
+#include "testBase.h"
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+extern const int GFX_SX;
+extern const int GFX_SY;
+
+static bool testAllocations(const int capacity, const int fenceGranularity, const int numAllocations)
+{
+	GxStreamingBufferBackend_Cpu backend;
+	backend.init(capacity);
+	
+	GxStreamingBuffer buffer;
+	buffer.init(&backend, capacity, fenceGranularity);
+	
+	std::vector<uint8_t> bytes(capacity);
+	
+	bool success = true;
+	
+	for (int i = 0; i < numAllocations; ++i)
+	{
+		const int alignment = (i % 3) == 0 ? 60 : (i % 3) == 1 ? 4 : 1;
+		const int numBytes = random(0, capacity / 3);
+		
+		const int offset = buffer.append(bytes.data(), numBytes, alignment);
+		
+		success &= offset >= 0;
+		success &= (offset % alignment) == 0;
+		success &= offset + numBytes <= capacity;
+		success &= buffer.getNumBytesInUse() <= capacity;
+		
+		// let the simulated GPU make some progress
+		
+		if ((rand() % 4) == 0)
+			backend.signalFences(backend.lastSignaledFenceId + rand() % 3);
+	}
+	
+	success &= buffer.append(bytes.data(), capacity + 1, 1) == -1;
+	success &= buffer.append(bytes.data(), capacity, 1) == 0;
+	
+	success &= backend.numOverlapErrors == 0;
+	success &= backend.numBoundsErrors == 0;
+	success &= buffer.getStats().numWraps > 0;
+	
+	printf("streaming buffer test: capacity=%d, fenceGranularity=%d, wraps=%d, fences=%d, waits=%d, overlapErrors=%d, boundsErrors=%d, success=%d\n",
+		capacity,
+		fenceGranularity,
+		buffer.getStats().numWraps,
+		buffer.getStats().numFences,
+		buffer.getStats().numFenceWaits,
+		backend.numOverlapErrors,
+		backend.numBoundsErrors,
+		success ? 1 : 0);
+	
+	buffer.shut();
+	backend.shut();
+	
+	return success;
+}
+
+void testStreamingBuffer()
+{
+	setAbout("This example tests the ring buffer allocator used for streaming vertices to the GPU, using a CPU-side backend which simulates the GPU consuming data with some latency. The bar shows the regions in use, and the frames they belong to.");
+	setInstructions("Up/Down: change the GPU latency (in frames). Left/Right: change the number of bytes allocated per frame");
+	
+	bool success = true;
+	
+	success &= testAllocations(1000, 0, 100000);
+	success &= testAllocations(4096, 1, 100000);
+	success &= testAllocations(1024 * 1024, 300, 100000);
+	
+	const int kCapacity = 1024 * 1024;
+	
+	GxStreamingBufferBackend_Cpu backend;
+	backend.init(kCapacity);
+	
+	GxStreamingBuffer buffer;
+	buffer.init(&backend, kCapacity, 1024);
+	
+	std::vector<uint8_t> bytes(kCapacity);
+	
+	struct Allocation
+	{
+		int offset;
+		int numBytes;
+		int frameIndex;
+	};
+	
+	std::deque<int64_t> frameFences; // the last fence inserted for each frame in flight
+	std::deque<Allocation> allocations;
+	
+	int gpuLatency = 2;
+	int numBytesPerFrame = 100 * 1024;
+	int frameIndex = 0;
+	
+	do
+	{
+		framework.process();
+		
+		if (keyboard.wentDown(SDLK_UP, true))
+			gpuLatency = std::min(gpuLatency + 1, 16);
+		if (keyboard.wentDown(SDLK_DOWN, true))
+			gpuLatency = std::max(gpuLatency - 1, 0);
+		if (keyboard.wentDown(SDLK_RIGHT, true))
+			numBytesPerFrame = std::min(numBytesPerFrame + 16 * 1024, kCapacity);
+		if (keyboard.wentDown(SDLK_LEFT, true))
+			numBytesPerFrame = std::max(numBytesPerFrame - 16 * 1024, 16 * 1024);
+		
+		// simulate a frame worth of draw calls, each appending a random number of vertices
+		
+		for (int numBytesLeft = numBytesPerFrame; numBytesLeft > 0; )
+		{
+			const int numBytes = std::min(numBytesLeft, random(1, 16) * 60 * 64);
+			
+			const int offset = buffer.append(bytes.data(), numBytes, 60);
+			
+			allocations.push_back({ offset, numBytes, frameIndex });
+			
+			numBytesLeft -= numBytes;
+		}
+		
+		buffer.fence();
+		
+		frameFences.push_back(backend.getLastInsertedFenceId());
+		
+		// simulate the GPU finishing frames after a given latency
+		
+		while ((int)frameFences.size() > gpuLatency)
+		{
+			backend.signalFences(frameFences.front());
+			frameFences.pop_front();
+		}
+		
+		while (allocations.empty() == false && allocations.front().frameIndex < frameIndex - gpuLatency - 8)
+			allocations.pop_front();
+		
+		frameIndex++;
+		
+		framework.beginDraw(0, 0, 0, 0);
+		{
+			const float x1 = 40.f;
+			const float x2 = GFX_SX - 40.f;
+			const float y = GFX_SY / 2.f;
+			const float scale = (x2 - x1) / kCapacity;
+			
+			setColor(40, 40, 40);
+			drawRect(x1, y, x2, y + 40);
+			
+			for (auto & allocation : allocations)
+			{
+				const int age = frameIndex - 1 - allocation.frameIndex;
+				
+				if (age <= gpuLatency)
+					setColor(Color::fromHSL(allocation.frameIndex / 8.f, .5f, .5f));
+				else
+					setColor(80, 80, 80);
+				
+				drawRect(
+					x1 + allocation.offset * scale, y,
+					x1 + (allocation.offset + allocation.numBytes) * scale, y + 40);
+			}
+			
+			const GxStreamingBuffer::Stats & stats = buffer.getStats();
+			
+			setFont("calibri.ttf");
+			setColor(colorWhite);
+			drawText(x1, y - 100, 16, +1, +1, "self test: %s", success ? "passed" : "FAILED");
+			drawText(x1, y - 80, 14, +1, +1, "GPU latency: %d frames, bytes per frame: %dKB, in use: %dKB",
+				gpuLatency,
+				numBytesPerFrame / 1024,
+				buffer.getNumBytesInUse() / 1024);
+			drawText(x1, y - 60, 14, +1, +1, "allocations: %lld, wraps: %d, fences: %d, waits: %d, overlap errors: %d",
+				(long long)stats.numAllocations,
+				stats.numWraps,
+				stats.numFences,
+				stats.numFenceWaits,
+				backend.numOverlapErrors);
+			
+			drawTestUi();
+		}
+		framework.endDraw();
+	} while (tickTestUi());
+	
+	buffer.shut();
+	backend.shut();
+}
@@ -0,0 +1,358 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "framework.h"
+#include "gx_texture_container.h"
+#include "image.h"
+#include "Path.h"
+#include "StringEx.h"
+#include "testBase.h"
+#include "Timer.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#if defined(LINUX)
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+/*
+This test verifies texture containers are baked and loaded correctly, and that damaged containers are rejected.
+Next, it bakes the images inside the data folder, and compares the time needed to decode the source images with
+the time needed to load the baked containers. The baked containers are removed again when the test is done.
+*/
+
+static const int kVerifySx = 37;
+static const int kVerifySy = 23;
+
+// the byte offset of the swizzle inside the container header
+static const int kHeaderSwizzleOffset = 28;
+
+struct TestResults
+{
+	std::vector<std::string> lines;
+	int numFailures = 0;
+	
+	void check(const bool condition, const char * description)
+	{
+		if (condition == false)
+		{
+			lines.push_back(String::FormatC("FAILED: %s", description));
+			numFailures++;
+		}
+	}
+};
+
+static std::vector<uint8_t> readFile(const char * filename)
+{
+	std::vector<uint8_t> bytes;
+	
+	FILE * file = fopen(filename, "rb");
+	
+	if (file != nullptr)
+	{
+		fseek(file, 0, SEEK_END);
+		bytes.resize(ftell(file));
+		fseek(file, 0, SEEK_SET);
+		if (fread(bytes.data(), 1, bytes.size(), file) != bytes.size())
+			bytes.clear();
+		fclose(file);
+	}
+	
+	return bytes;
+}
+
+static bool writeFile(const char * filename, const uint8_t * bytes, const size_t numBytes)
+{
+	FILE * file = fopen(filename, "wb");
+	
+	if (file == nullptr)
+		return false;
+	
+	const bool result = fwrite(bytes, 1, numBytes, file) == numBytes;
+	
+	fclose(file);
+	
+	return result;
+}
+
+static void verifyContainers(TestResults & results)
+{
+	const char * filename = "testTextureContainer.gxtex";
+	const char * damagedFilename = "testTextureContainer-damaged.gxtex";
+	
+	for (int compress = 0; compress < 2; ++compress)
+	{
+		GxTextureBakeOptions options;
+		options.compress = compress != 0;
+		
+		// float textures should round trip exactly, with a box filtered mip chain
+		
+		std::vector<float> values(kVerifySx * kVerifySy * 4);
+		for (auto & value : values)
+			value = random<float>(0.f, 1.f);
+		
+		GxTextureContainer container;
+		
+		results.check(gxBakeTexture(values.data(), kVerifySx, kVerifySy, GX_RGBA32_FLOAT, options, filename), "bake RGBA32F");
+		
+		if (container.load(filename))
+		{
+			results.check(container.format == GX_RGBA32_FLOAT, "RGBA32F format");
+			results.check(container.numLevels == 6, "RGBA32F number of levels");
+			results.check(container.levels[container.numLevels - 1].sx == 1 && container.levels[container.numLevels - 1].sy == 1, "RGBA32F last level is 1x1");
+			results.check(memcmp(container.levels[0].bytes, values.data(), values.size() * sizeof(float)) == 0, "RGBA32F level 0 contents");
+			
+			const float * level1 = (const float*)container.levels[1].bytes;
+			const float expected = (values[0] + values[4] + values[kVerifySx * 4] + values[kVerifySx * 4 + 4]) / 4.f;
+			results.check(fabsf(level1[0] - expected) < 1e-6f, "RGBA32F level 1 is box filtered");
+			
+			container.free();
+		}
+		else
+		{
+			results.check(false, "load RGBA32F");
+		}
+		
+		// single channel textures don't have a swizzle
+		
+		std::vector<uint8_t> bytes(kVerifySx * kVerifySy);
+		for (auto & byte : bytes)
+			byte = random<int>(0, 255);
+		
+		results.check(gxBakeTexture(bytes.data(), kVerifySx, kVerifySy, GX_R8_UNORM, options, filename), "bake R8");
+		
+		if (container.load(filename))
+		{
+			results.check(container.format == GX_R8_UNORM, "R8 format");
+			results.check(container.hasSwizzle() == false, "R8 has no swizzle");
+			results.check(memcmp(container.levels[0].bytes, bytes.data(), bytes.size()) == 0, "R8 level 0 contents");
+			
+			container.free();
+		}
+		else
+		{
+			results.check(false, "load R8");
+		}
+		
+		// damaged containers must be rejected
+		
+		const std::vector<uint8_t> file = readFile(filename);
+		
+		results.check(file.size() > 64, "read container");
+		
+		if (file.size() > 64)
+		{
+			for (const size_t numBytes : { (size_t)10, (size_t)300, file.size() - 5 })
+			{
+				writeFile(damagedFilename, file.data(), numBytes);
+				results.check(container.load(damagedFilename) == false, "reject truncated container");
+				container.free();
+			}
+			
+			for (const int32_t swizzle : { 4, -3, 0x7fffffff })
+			{
+				std::vector<uint8_t> damaged = file;
+				memcpy(&damaged[kHeaderSwizzleOffset + 4], &swizzle, sizeof(swizzle));
+				writeFile(damagedFilename, damaged.data(), damaged.size());
+				results.check(container.load(damagedFilename) == false, "reject invalid swizzle");
+				container.free();
+			}
+		}
+	}
+	
+	remove(filename);
+	remove(damagedFilename);
+	
+	results.lines.push_back(String::FormatC("verification: %s", results.numFailures == 0 ? "passed" : "FAILED"));
+}
+
+static void evictFromFileCache(const char * filename)
+{
+#if defined(LINUX)
+	// note : the kernel drops clean pages of the file from the page cache, so the next read hits the disk
+	
+	const int fd = open(filename, O_RDONLY);
+	
+	if (fd >= 0)
+	{
+		fdatasync(fd);
+		posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+		close(fd);
+	}
+#endif
+}
+
+static uint32_t touchBytes(const uint8_t * bytes, const int64_t numBytes)
+{
+	// read every page, the same way uploading the texture would
+	
+	uint32_t result = 0;
+	
+	for (int64_t i = 0; i < numBytes; i += 4096)
+		result += bytes[i];
+	
+	return result;
+}
+
+static void benchmarkContainers(TestResults & results, const bool compress)
+{
+	std::vector<std::string> filenames;
+	
+	for (auto & filename : listFiles(".", true))
+	{
+		const std::string extension = Path::GetExtension(filename, true);
+		
+		if (extension == "png" || extension == "jpg" || extension == "jpeg")
+			filenames.push_back(filename);
+	}
+	
+	GxTextureBakeOptions options;
+	options.compress = compress;
+	
+	for (auto & filename : filenames)
+		gxBakeTextureFromImageFile(filename.c_str(), options);
+	
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		const bool cold = (pass == 0);
+		
+		if (cold)
+		{
+			for (auto & filename : filenames)
+			{
+				evictFromFileCache(filename.c_str());
+				evictFromFileCache(gxGetBakedTextureFilename(filename.c_str()).c_str());
+			}
+		}
+		
+		uint32_t checksum = 0;
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		for (auto & filename : filenames)
+		{
+			ImageData * imageData = loadImage(filename.c_str());
+			
+			if (imageData != nullptr)
+			{
+				if (String::EndsWith(filename, ".png"))
+				{
+					ImageData * temp = imageFixAlphaFilter(imageData);
+					delete imageData;
+					imageData = temp;
+				}
+				
+				checksum += imageData->imageData[0].r;
+				
+				delete imageData;
+				imageData = nullptr;
+			}
+		}
+		
+		const uint64_t t2 = g_TimerRT.TimeUS_get();
+		
+		for (auto & filename : filenames)
+		{
+			GxTextureContainer container;
+			
+			if (container.load(gxGetBakedTextureFilename(filename.c_str()).c_str()))
+			{
+				for (int i = 0; i < container.numLevels; ++i)
+					checksum += touchBytes(container.levels[i].bytes, container.levels[i].numBytes);
+			}
+		}
+		
+		const uint64_t t3 = g_TimerRT.TimeUS_get();
+		
+		results.lines.push_back(String::FormatC("%s: %d images. decode: %.2fms, baked containers (with mips%s): %.2fms (%08x)",
+			cold ? "cold" : "warm",
+			(int)filenames.size(),
+			compress ? ", zstd" : "",
+			(t2 - t1) / 1000.0,
+			(t3 - t2) / 1000.0,
+			checksum));
+	}
+	
+	for (auto & filename : filenames)
+		remove(gxGetBakedTextureFilename(filename.c_str()).c_str());
+}
+
+void testTextureContainer()
+{
+	setAbout("This test verifies baking and loading texture containers, and makes sure damaged containers are rejected. Next, it compares the time needed to decode the images inside the data folder with the time needed to load their baked containers. The cold pass evicts the files from the OS file cache first (Linux only).");
+	setInstructions("Z: toggle zstd compression. Space: run the test again");
+	
+	TestResults results;
+	
+	bool compress = false;
+	bool run = true;
+	
+	do
+	{
+		framework.process();
+		
+		if (keyboard.wentDown(SDLK_z))
+		{
+			compress = !compress;
+			run = true;
+		}
+		
+		if (keyboard.wentDown(SDLK_SPACE))
+			run = true;
+		
+		if (run)
+		{
+			run = false;
+			
+			results = TestResults();
+			
+			verifyContainers(results);
+			benchmarkContainers(results, compress);
+			
+			for (auto & line : results.lines)
+				logInfo("%s", line.c_str());
+		}
+		
+		framework.beginDraw(0, 0, 0, 0);
+		{
+			setFont("calibri.ttf");
+			
+			for (size_t i = 0; i < results.lines.size(); ++i)
+			{
+				setColor(String::StartsWith(results.lines[i], "FAILED") ? colorRed : colorWhite);
+				drawText(20, 100 + i * 20, 14, +1, +1, "%s", results.lines[i].c_str());
+			}
+			
+			drawTestUi();
+		}
+		framework.endDraw();
+	} while (tickTestUi());
+}
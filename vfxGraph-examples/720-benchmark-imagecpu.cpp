@@ -0,0 +1,252 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Timer.h"
+#include "vfxNodeBase.h"
+#include "vfxNodes/vfxNodeImageCpuCrop.h"
+#include "vfxNodes/vfxNodeImageCpuDownsample.h"
+#include "vfxNodes/vfxNodeImageCpuEqualize.h"
+#include "vfxNodes/vfxNodeImageCpuToChannels.h"
+#include "vfxParallelRows.h"
+#include <functional>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+
+/*
+This benchmark measures the throughput of the CPU image kernels, in megapixels per second, at 720p, 1080p and 4K
+resolution. It covers the VfxImageCpu interleave and deinterleave methods, and the image_cpu nodes used by camera
+pipelines. Each kernel is run on the calling thread only, and using the helper threads of vfxParallelRows. Before
+measuring, interleaving and deinterleaving an image is checked to reproduce the original image.
+
+Usage: vfxgraph-720-benchmark-imagecpu [numThreads]
+*/
+
+struct Resolution
+{
+	const char * name;
+	int sx;
+	int sy;
+};
+
+static const Resolution kResolutions[] =
+{
+	{ "720p", 1280, 720 },
+	{ "1080p", 1920, 1080 },
+	{ "4K", 3840, 2160 }
+};
+
+static void fillRandom(VfxImageCpuData & imageData)
+{
+	for (int i = 0; i < imageData.image.numChannels; ++i)
+	{
+		const VfxImageCpu::Channel & channel = imageData.image.channel[i];
+		
+		for (int y = 0; y < imageData.image.sy; ++y)
+		{
+			uint8_t * row = (uint8_t*)channel.data + y * channel.pitch;
+			
+			for (int x = 0; x < imageData.image.sx; ++x)
+				row[x] = rand();
+		}
+	}
+}
+
+static bool verifyRoundTrip(const VfxImageCpu & image, const int numChannels)
+{
+	const int sx = image.sx;
+	const int sy = image.sy;
+	
+	std::vector<uint8_t> interleaved(sx * sy * numChannels);
+	
+	VfxImageCpuData result;
+	result.alloc(sx, sy, numChannels);
+	
+	if (numChannels == 3)
+	{
+		VfxImageCpu::interleave3(image.channel[0], image.channel[1], image.channel[2], interleaved.data(), 0, sx, sy);
+		VfxImageCpu::deinterleave3(interleaved.data(), sx, sy, 1, sx * 3, result.image.channel[0], result.image.channel[1], result.image.channel[2]);
+	}
+	else
+	{
+		VfxImageCpu::interleave4(image.channel[0], image.channel[1], image.channel[2], image.channel[3], interleaved.data(), 0, sx, sy);
+		VfxImageCpu::deinterleave4(interleaved.data(), sx, sy, 1, sx * 4, result.image.channel[0], result.image.channel[1], result.image.channel[2], result.image.channel[3]);
+	}
+	
+	for (int i = 0; i < numChannels; ++i)
+	{
+		for (int y = 0; y < sy; ++y)
+		{
+			const uint8_t * expected = image.channel[i].data + y * image.channel[i].pitch;
+			const uint8_t * actual = result.image.channel[i].data + y * result.image.channel[i].pitch;
+			
+			for (int x = 0; x < sx; ++x)
+			{
+				if (expected[x] != actual[x])
+				{
+					printf("interleave%d/deinterleave%d mismatch at (%d, %d) channel %d\n", numChannels, numChannels, x, y, i);
+					return false;
+				}
+			}
+		}
+	}
+	
+	return true;
+}
+
+// runs the kernel repeatedly for at least a quarter second and returns the throughput in megapixels per second
+
+static double measure(const int numPixels, const std::function<void()> & kernel)
+{
+	kernel(); // warm up
+	
+	const uint64_t t1 = g_TimerRT.TimeUS_get();
+	
+	int numIterations = 0;
+	uint64_t t2 = t1;
+	
+	while (t2 - t1 < 250000)
+	{
+		kernel();
+		
+		numIterations++;
+		t2 = g_TimerRT.TimeUS_get();
+	}
+	
+	const double seconds = (t2 - t1) / 1000000.0;
+	
+	return numPixels * double(numIterations) / seconds / 1000000.0;
+}
+
+static void connectImmediate(VfxNodeBase * node, const int index, void * mem, const VfxPlugType type)
+{
+	node->tryGetInput(index)->connectToImmediate(mem, type);
+}
+
+int main(int argc, char * argv[])
+{
+	const int numThreads = argc >= 2 ? atoi(argv[1]) : vfxGetParallelRowsThreadCount();
+	
+	printf("parallel rows: %d helper threads\n", numThreads);
+	
+	bool success = true;
+	
+	for (auto & resolution : kResolutions)
+	{
+		const int sx = resolution.sx;
+		const int sy = resolution.sy;
+		const int numPixels = sx * sy;
+		
+		VfxImageCpuData imageData;
+		imageData.alloc(sx, sy, 4);
+		fillRandom(imageData);
+		
+		VfxImageCpu & image = imageData.image;
+		
+		success &= verifyRoundTrip(image, 3);
+		success &= verifyRoundTrip(image, 4);
+		
+		std::vector<uint8_t> interleaved(sx * sy * 4);
+		
+		VfxImageCpuData planar;
+		planar.alloc(sx, sy, 4);
+		
+		// nodes
+		
+		int downsampleSize2x2 = VfxNodeImageCpuDownsample::kDownsampleSize_2x2;
+		int downsampleSize4x4 = VfxNodeImageCpuDownsample::kDownsampleSize_4x4;
+		int downsampleChannel = VfxNodeImageCpuDownsample::kDownsampleChannel_All;
+		
+		VfxNodeImageCpuDownsample downsample2x2;
+		connectImmediate(&downsample2x2, VfxNodeImageCpuDownsample::kInput_Image, &image, kVfxPlugType_ImageCpu);
+		connectImmediate(&downsample2x2, VfxNodeImageCpuDownsample::kInput_DownsampleSize, &downsampleSize2x2, kVfxPlugType_Int);
+		connectImmediate(&downsample2x2, VfxNodeImageCpuDownsample::kInput_DownsampleChannel, &downsampleChannel, kVfxPlugType_Int);
+		
+		VfxNodeImageCpuDownsample downsample4x4;
+		connectImmediate(&downsample4x4, VfxNodeImageCpuDownsample::kInput_Image, &image, kVfxPlugType_ImageCpu);
+		connectImmediate(&downsample4x4, VfxNodeImageCpuDownsample::kInput_DownsampleSize, &downsampleSize4x4, kVfxPlugType_Int);
+		connectImmediate(&downsample4x4, VfxNodeImageCpuDownsample::kInput_DownsampleChannel, &downsampleChannel, kVfxPlugType_Int);
+		
+		int equalizeChannel = VfxNodeImageCpuEqualize::kChannel_RGBA;
+		bool errorDiffusion = false;
+		
+		VfxNodeImageCpuEqualize equalize;
+		connectImmediate(&equalize, VfxNodeImageCpuEqualize::kInput_Image, &image, kVfxPlugType_ImageCpu);
+		connectImmediate(&equalize, VfxNodeImageCpuEqualize::kInput_Channel, &equalizeChannel, kVfxPlugType_Int);
+		connectImmediate(&equalize, VfxNodeImageCpuEqualize::kInput_ErrorDiffusion, &errorDiffusion, kVfxPlugType_Bool);
+		
+		int toChannelsChannel = VfxNodeImageCpuToChannels::kChannel_RGBA;
+		
+		VfxNodeImageCpuToChannels toChannels;
+		connectImmediate(&toChannels, VfxNodeImageCpuToChannels::kInput_Image, &image, kVfxPlugType_ImageCpu);
+		connectImmediate(&toChannels, VfxNodeImageCpuToChannels::kInput_Channel, &toChannelsChannel, kVfxPlugType_Int);
+		toChannels.tryGetOutput(VfxNodeImageCpuToChannels::kOutput_RChannel)->isReferencedByLink = true;
+		
+		float cropAmount = .25f;
+		
+		VfxNodeImageCpuCrop crop;
+		connectImmediate(&crop, VfxNodeImageCpuCrop::kInput_Image, &image, kVfxPlugType_ImageCpu);
+		connectImmediate(&crop, VfxNodeImageCpuCrop::kInput_Amount, &cropAmount, kVfxPlugType_Float);
+		
+		struct Kernel
+		{
+			const char * name;
+			std::function<void()> function;
+		};
+		
+		const Kernel kernels[] =
+		{
+			{ "interleave3", [&]() { VfxImageCpu::interleave3(image.channel[0], image.channel[1], image.channel[2], interleaved.data(), 0, sx, sy); } },
+			{ "interleave4", [&]() { VfxImageCpu::interleave4(image.channel[0], image.channel[1], image.channel[2], image.channel[3], interleaved.data(), 0, sx, sy); } },
+			{ "deinterleave3", [&]() { VfxImageCpu::deinterleave3(interleaved.data(), sx, sy, 1, sx * 3, planar.image.channel[0], planar.image.channel[1], planar.image.channel[2]); } },
+			{ "deinterleave4", [&]() { VfxImageCpu::deinterleave4(interleaved.data(), sx, sy, 1, sx * 4, planar.image.channel[0], planar.image.channel[1], planar.image.channel[2], planar.image.channel[3]); } },
+			{ "image_cpu.downsample 2x2", [&]() { downsample2x2.tick(0.f); } },
+			{ "image_cpu.downsample 4x4", [&]() { downsample4x4.tick(0.f); } },
+			{ "image_cpu.equalize rgba", [&]() { equalize.tick(0.f); } },
+			{ "image_cpu.toChannels rgba", [&]() { toChannels.tick(0.f); } },
+			{ "image_cpu.crop", [&]() { crop.tick(0.f); } }
+		};
+		
+		printf("\n%s (%dx%d)\n", resolution.name, sx, sy);
+		printf("%-28s %14s %14s\n", "kernel", "1 thread", "parallel");
+		
+		for (auto & kernel : kernels)
+		{
+			vfxSetParallelRowsThreadCount(0);
+			const double mpps1 = measure(numPixels, kernel.function);
+			
+			vfxSetParallelRowsThreadCount(numThreads);
+			const double mppsN = measure(numPixels, kernel.function);
+			
+			printf("%-28s %10.1f MP/s %10.1f MP/s\n", kernel.name, mpps1, mppsN);
+		}
+	}
+	
+	printf("\n%s\n", success ? "verification: ok" : "verification: FAILED");
+	
+	return success ? 0 : -1;
+}
@@ -0,0 +1,175 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if VFXGRAPH_ENABLE_TURBOJPEG
+
+#include "Timer.h"
+#include "vfxNodeBase.h"
+#include "vfxNodes/imageCpuDelayLine.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/*
+This benchmark measures the number of frames per second the image delay line sustains at 1080p, for several JPEG
+quality levels and worker thread counts. Each frame one image is added and four images are read at fixed delays, the
+same as the image_cpu.delay node does when all four of its outputs are connected.
+
+Usage: vfxgraph-730-benchmark-imagecpu-delayline [historySize]
+*/
+
+static const int kSx = 1920;
+static const int kSy = 1080;
+
+static const int kNumSourceImages = 8;
+
+static const int kQualityLevels[] = { 50, 75, 95 };
+static const int kThreadCounts[] = { 1, 2, 4 };
+
+static void fillImage(VfxImageCpuData & imageData, const int index)
+{
+	// smooth gradients with a little noise, so the compression ratio resembles that of camera images
+	
+	for (int i = 0; i < imageData.image.numChannels; ++i)
+	{
+		const VfxImageCpu::Channel & channel = imageData.image.channel[i];
+		
+		for (int y = 0; y < imageData.image.sy; ++y)
+		{
+			uint8_t * row = (uint8_t*)channel.data + y * channel.pitch;
+			
+			for (int x = 0; x < imageData.image.sx; ++x)
+			{
+				const float value =
+					128.f +
+					64.f * sinf(x / 97.f + index * .3f + i) +
+					48.f * cosf(y / 61.f - index * .2f) +
+					(rand() % 16);
+				
+				row[x] = (uint8_t)std::max(0.f, std::min(255.f, value));
+			}
+		}
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	const int historySize = argc >= 2 ? std::max(2, atoi(argv[1])) : 120;
+	
+	VfxImageCpuData sourceImages[kNumSourceImages];
+	
+	for (int i = 0; i < kNumSourceImages; ++i)
+	{
+		sourceImages[i].alloc(kSx, kSy, 4);
+		fillImage(sourceImages[i], i);
+	}
+	
+	const int offsets[4] = { 1, historySize / 4, historySize / 2, historySize - 1 };
+	
+	printf("%dx%d, history size: %d, delays: %d %d %d %d\n", kSx, kSy, historySize, offsets[0], offsets[1], offsets[2], offsets[3]);
+	printf("%-8s %-8s %10s %10s %10s %14s %12s\n", "quality", "threads", "fps", "hit rate", "stalls", "compressed", "decoded");
+	
+	for (auto qualityLevel : kQualityLevels)
+	{
+		for (auto numThreads : kThreadCounts)
+		{
+			ImageCpuDelayLine delayLine;
+			delayLine.init(historySize, 1024 * 1024 * 4, numThreads);
+			
+			VfxImageCpuData outputs[4];
+			
+			int frameIndex = 0;
+			
+			auto doFrame = [&]()
+			{
+				delayLine.tick();
+				
+				delayLine.add(sourceImages[frameIndex % kNumSourceImages].image, qualityLevel, frameIndex);
+				
+				for (int i = 0; i < 4; ++i)
+					delayLine.get(offsets[i], outputs[i]);
+				
+				frameIndex++;
+			};
+			
+			// fill the history before measuring, so all reads are served from compressed images
+			
+			for (int i = 0; i < historySize; ++i)
+				doFrame();
+			
+			const ImageCpuDelayLine::Stats stats1 = delayLine.stats;
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			int numFrames = 0;
+			uint64_t t2 = t1;
+			
+			while (t2 - t1 < 2000000)
+			{
+				doFrame();
+				
+				numFrames++;
+				t2 = g_TimerRT.TimeUS_get();
+			}
+			
+			const ImageCpuDelayLine::Stats & stats2 = delayLine.stats;
+			
+			const int64_t numHits = stats2.numCacheHits - stats1.numCacheHits;
+			const int64_t numMisses = stats2.numCacheMisses - stats1.numCacheMisses;
+			const int64_t numStalls = stats2.numCompressStalls - stats1.numCompressStalls;
+			
+			const ImageCpuDelayLine::MemoryUsage memoryUsage = delayLine.getMemoryUsage();
+			
+			printf("%-8d %-8d %10.1f %9.1f%% %10lld %12.1fMb %10.1fMb\n",
+				qualityLevel,
+				numThreads,
+				numFrames / ((t2 - t1) / 1000000.0),
+				numHits + numMisses == 0 ? 0.0 : numHits * 100.0 / (numHits + numMisses),
+				(long long)numStalls,
+				memoryUsage.numCompressedBytes / (1024.0 * 1024.0),
+				memoryUsage.numDecodedBytes / (1024.0 * 1024.0));
+			
+			delayLine.shut();
+		}
+	}
+	
+	return 0;
+}
+
+#else
+
+#include <stdio.h>
+
+int main(int argc, char * argv[])
+{
+	printf("this benchmark requires turbojpeg support (VFXGRAPH_ENABLE_TURBOJPEG)\n");
+	
+	return 0;
+}
+
+#endif
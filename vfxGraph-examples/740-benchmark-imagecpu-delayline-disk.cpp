@@ -0,0 +1,250 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#if VFXGRAPH_ENABLE_TURBOJPEG
+
+#include "Timer.h"
+#include "vfxNodeBase.h"
+#include "vfxNodes/imageCpuDelayLine.h"
+#include <algorithm>
+#include <SDL2/SDL.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+This benchmark measures the latency of random access into the disk tier of the image delay line. It fills a long
+delay line at 720p, with all but the most recent images moved to disk, and then reads images at random offsets. For
+each offset it measures the time it takes to touch the memory mapped JPEG data only, and the time it takes to get the
+decoded image. Reads from the hot window, which is kept in memory, are measured for comparison.
+
+Note the segment files were just written, so their contents are likely still in the file cache of the OS. To measure
+reads from the storage device itself, pass 'wait' as the last argument, and drop the file cache while the benchmark
+waits for input.
+
+Usage: vfxgraph-740-benchmark-imagecpu-delayline-disk [historySize] [hotWindowSize] [path] [wait]
+*/
+
+static const int kSx = 1280;
+static const int kSy = 720;
+
+static const int kNumSourceImages = 8;
+static const int kNumSamples = 200;
+
+static void fillImage(VfxImageCpuData & imageData, const int index)
+{
+	for (int i = 0; i < imageData.image.numChannels; ++i)
+	{
+		const VfxImageCpu::Channel & channel = imageData.image.channel[i];
+		
+		for (int y = 0; y < imageData.image.sy; ++y)
+		{
+			uint8_t * row = (uint8_t*)channel.data + y * channel.pitch;
+			
+			for (int x = 0; x < imageData.image.sx; ++x)
+			{
+				const float value =
+					128.f +
+					64.f * sinf(x / 97.f + index * .3f + i) +
+					48.f * cosf(y / 61.f - index * .2f) +
+					(rand() % 16);
+				
+				row[x] = (uint8_t)std::max(0.f, std::min(255.f, value));
+			}
+		}
+	}
+}
+
+static void printLatencies(const char * name, std::vector<double> & latencies)
+{
+	std::sort(latencies.begin(), latencies.end());
+	
+	const int n = latencies.size();
+	
+	printf("%-32s min %8.1fus  median %8.1fus  p99 %8.1fus  max %8.1fus\n",
+		name,
+		latencies[0],
+		latencies[n / 2],
+		latencies[std::min(n - 1, n * 99 / 100)],
+		latencies[n - 1]);
+}
+
+int main(int argc, char * argv[])
+{
+	const int historySize = argc >= 2 ? std::max(2, atoi(argv[1])) : 60 * 60 * 2;
+	const int hotWindowSize = argc >= 3 ? std::max(1, std::min(historySize - 1, atoi(argv[2]))) : 120;
+	const char * path = argc >= 4 ? argv[3] : ".";
+	
+	VfxImageCpuData sourceImages[kNumSourceImages];
+	
+	for (int i = 0; i < kNumSourceImages; ++i)
+	{
+		sourceImages[i].alloc(kSx, kSy, 4);
+		fillImage(sourceImages[i], i);
+	}
+	
+	ImageCpuDelayLine delayLine;
+	delayLine.init(historySize, 1024 * 1024 * 4);
+	
+	if (delayLine.initDiskStorage(path, hotWindowSize) == false)
+	{
+		printf("failed to initialize disk storage at %s\n", path);
+		return -1;
+	}
+	
+	// fill the history
+	
+	printf("filling %d images (%dx%d), hot window: %d images\n", historySize, kSx, kSy, hotWindowSize);
+	
+	const uint64_t fillTime1 = g_TimerRT.TimeUS_get();
+	
+	for (int i = 0; i < historySize; ++i)
+	{
+		delayLine.tick();
+		delayLine.add(sourceImages[i % kNumSourceImages].image, 75, i / 60.0);
+	}
+	
+	// let the remaining compression work finish and the images move to disk
+	
+	for (int i = 0; i < 100; ++i)
+	{
+		SDL_Delay(10);
+		delayLine.tick();
+	}
+	
+	const uint64_t fillTime2 = g_TimerRT.TimeUS_get();
+	
+	const ImageCpuDelayLine::MemoryUsage memoryUsage = delayLine.getMemoryUsage();
+	
+	printf("filled in %.1fs. on disk: %d images, %.1fMb. in memory: %.1fMb compressed, %.1fMb total\n",
+		(fillTime2 - fillTime1) / 1000000.0,
+		memoryUsage.numDiskImages,
+		memoryUsage.numDiskBytes / (1024.0 * 1024.0),
+		memoryUsage.numCompressedBytes / (1024.0 * 1024.0),
+		memoryUsage.numBytes / (1024.0 * 1024.0));
+	
+	if (argc >= 5 && strcmp(argv[4], "wait") == 0)
+	{
+		printf("press enter to continue\n");
+		getchar();
+	}
+	
+	// measure
+	
+	VfxImageCpuData imageData;
+	
+	std::vector<double> readLatencies;
+	std::vector<double> diskLatencies;
+	std::vector<double> hotLatencies;
+	std::vector<double> timestampLatencies;
+	
+	uint32_t checksum = 0;
+	
+	for (int i = 0; i < kNumSamples; ++i)
+	{
+		// note : each sample uses a different random offset, so the decoded image cache doesn't come into play
+		
+		{
+			const int offset = hotWindowSize + rand() % (historySize - hotWindowSize);
+			
+			const ImageCpuDelayLine::JpegData * jpegData = delayLine.history[offset]->jpegData;
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			for (int j = 0; j < jpegData->numBytes; j += 1024)
+				checksum += jpegData->bytes[j];
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			readLatencies.push_back(double(t2 - t1));
+		}
+		
+		{
+			const int offset = hotWindowSize + rand() % (historySize - hotWindowSize);
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			delayLine.get(offset, imageData);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			diskLatencies.push_back(double(t2 - t1));
+		}
+		
+		{
+			const int offset = rand() % hotWindowSize;
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			delayLine.get(offset, imageData);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			hotLatencies.push_back(double(t2 - t1));
+		}
+		
+		{
+			const double timestamp = (rand() % historySize) / 60.0;
+			
+			const uint64_t t1 = g_TimerRT.TimeUS_get();
+			
+			delayLine.getByTimestamp(timestamp, imageData);
+			
+			const uint64_t t2 = g_TimerRT.TimeUS_get();
+			
+			timestampLatencies.push_back(double(t2 - t1));
+		}
+		
+		delayLine.tick();
+	}
+	
+	printf("\nrandom access latency over %d samples:\n", kNumSamples);
+	printLatencies("disk tier, touch JPEG data", readLatencies);
+	printLatencies("disk tier, get", diskLatencies);
+	printLatencies("hot window, get", hotLatencies);
+	printLatencies("getByTimestamp", timestampLatencies);
+	printf("(checksum: %u)\n", checksum);
+	
+	delayLine.shut();
+	
+	return 0;
+}
+
+#else
+
+#include <stdio.h>
+
+int main(int argc, char * argv[])
+{
+	printf("this benchmark requires turbojpeg support (VFXGRAPH_ENABLE_TURBOJPEG)\n");
+	
+	return 0;
+}
+
+#endif
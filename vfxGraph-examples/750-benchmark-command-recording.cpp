@@ -0,0 +1,197 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "gx_command_recorder.h"
+#include "Timer.h"
+#include "vfxParallelRows.h"
+#include <algorithm>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+/*
+This benchmark measures how fast ribbon geometry can be recorded using GxCommandRecorder, on the calling thread only
+and in parallel on the helper threads of vfxParallelRows. Each ribbon is recorded into its own recorder. The recorders
+are replayed in ribbon order into a CPU replay target, so the benchmark runs without a GPU. The replayed command
+stream of each parallel run is compared against the single-threaded run, to verify the result doesn't depend on how
+the ribbons were distributed over threads.
+
+Usage: vfxgraph-750-benchmark-command-recording [numRibbons] [numSegments]
+*/
+
+static const int kThreadCounts[] = { 0, 1, 3, 7 };
+
+static void recordRibbon(GxCommandRecorder & recorder, const int index, const int numSegments, const float time)
+{
+	recorder.reset();
+	
+	// switch textures every few ribbons, to make sure state changes are replayed in order too
+	
+	if ((index % 4) == 0)
+		recorder.setTexture(1 + index / 4, GX_SAMPLE_LINEAR, true);
+	
+	recorder.pushMatrix();
+	{
+		recorder.translatef(index * 4.f, 0.f, 0.f);
+		recorder.rotatef(index * 7.f, 0.f, 0.f, 1.f);
+		
+		recorder.begin(GX_QUADS);
+		{
+			for (int i = 0; i < numSegments; ++i)
+			{
+				const float t1 = (i + 0) / float(numSegments);
+				const float t2 = (i + 1) / float(numSegments);
+				
+				const float x1 = t1 * 400.f;
+				const float x2 = t2 * 400.f;
+				const float y1 = sinf(t1 * 12.f + time + index) * 40.f;
+				const float y2 = sinf(t2 * 12.f + time + index) * 40.f;
+				const float w1 = 2.f + cosf(t1 * 5.f + time) * 1.5f;
+				const float w2 = 2.f + cosf(t2 * 5.f + time) * 1.5f;
+				
+				recorder.color4f(t1, 1.f - t1, .5f, 1.f);
+				recorder.texCoord2f(t1, 0.f); recorder.vertex2f(x1, y1 - w1);
+				recorder.texCoord2f(t2, 0.f); recorder.vertex2f(x2, y2 - w2);
+				recorder.texCoord2f(t2, 1.f); recorder.vertex2f(x2, y2 + w2);
+				recorder.texCoord2f(t1, 1.f); recorder.vertex2f(x1, y1 + w1);
+			}
+		}
+		recorder.end();
+	}
+	recorder.popMatrix();
+}
+
+static void replayRibbons(const std::vector<GxCommandRecorder> & recorders, GxCommandReplayTarget_Cpu & target)
+{
+	target.clear();
+	
+	for (auto & recorder : recorders)
+		recorder.replay(target);
+}
+
+static bool replayedResultsAreEqual(const GxCommandReplayTarget_Cpu & a, const GxCommandReplayTarget_Cpu & b)
+{
+	if (a.commands.size() != b.commands.size() || a.vertices.size() != b.vertices.size())
+		return false;
+	
+	for (size_t i = 0; i < a.commands.size(); ++i)
+	{
+		const GxCommandReplayTarget_Cpu::Command & ca = a.commands[i];
+		const GxCommandReplayTarget_Cpu::Command & cb = b.commands[i];
+		
+		if (ca.type != cb.type ||
+			ca.primitiveType != cb.primitiveType ||
+			ca.firstVertex != cb.firstVertex ||
+			ca.numVertices != cb.numVertices ||
+			ca.texture != cb.texture)
+		{
+			return false;
+		}
+	}
+	
+	return memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(GxRecordedVertex)) == 0;
+}
+
+int main(int argc, char * argv[])
+{
+	const int numRibbons = argc >= 2 ? std::max(1, atoi(argv[1])) : 256;
+	const int numSegments = argc >= 3 ? std::max(1, atoi(argv[2])) : 1024;
+	
+	std::vector<GxCommandRecorder> recorders(numRibbons);
+	
+	GxCommandReplayTarget_Cpu reference;
+	GxCommandReplayTarget_Cpu replayed;
+	
+	const int originalThreadCount = vfxGetParallelRowsThreadCount();
+	
+	printf("ribbons: %d, segments per ribbon: %d\n", numRibbons, numSegments);
+	printf("%-8s %14s %14s %14s %8s\n", "threads", "frames/sec", "Mvertices/sec", "replay (ms)", "result");
+	
+	bool success = true;
+	
+	for (auto numThreads : kThreadCounts)
+	{
+		vfxSetParallelRowsThreadCount(numThreads);
+		
+		float time = 0.f;
+		
+		auto doFrame = [&]()
+		{
+			vfxParallelRows(numRibbons, 1, [&](const int index1, const int index2)
+			{
+				for (int i = index1; i < index2; ++i)
+					recordRibbon(recorders[i], i, numSegments, time);
+			});
+		};
+		
+		const uint64_t t1 = g_TimerRT.TimeUS_get();
+		
+		int numFrames = 0;
+		uint64_t t2 = t1;
+		
+		while (t2 - t1 < 2000000)
+		{
+			doFrame();
+			
+			numFrames++;
+			t2 = g_TimerRT.TimeUS_get();
+		}
+		
+		// record a fixed frame and compare the replayed result against the single-threaded result
+		
+		time = 1.f;
+		doFrame();
+		
+		const uint64_t t3 = g_TimerRT.TimeUS_get();
+		replayRibbons(recorders, replayed);
+		const uint64_t t4 = g_TimerRT.TimeUS_get();
+		
+		bool isEqual = true;
+		
+		if (numThreads == kThreadCounts[0])
+			reference = replayed;
+		else
+			isEqual = replayedResultsAreEqual(reference, replayed);
+		
+		success &= isEqual;
+		
+		const double numSeconds = (t2 - t1) / 1000000.0;
+		
+		printf("%-8d %14.1f %14.2f %14.2f %8s\n",
+			numThreads,
+			numFrames / numSeconds,
+			numFrames * double(numRibbons) * numSegments * 4 / numSeconds / 1000000.0,
+			(t4 - t3) / 1000.0,
+			isEqual ? "ok" : "MISMATCH");
+	}
+	
+	vfxSetParallelRowsThreadCount(originalThreadCount);
+	
+	return success ? 0 : -1;
+}
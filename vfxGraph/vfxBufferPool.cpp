@@ -0,0 +1,280 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "MemAlloc.h"
+#include "vfxBufferPool.h"
+#include "vfxGraph.h"
+#include <algorithm>
+#include <new>
+
+static const int kBufferHeaderSize = (sizeof(VfxBuffer) + 15) & (~15);
+
+void VfxBuffer::release()
+{
+	if (refCount.fetch_sub(1) == 1)
+	{
+		pool->recycle(this);
+	}
+}
+
+//
+
+VfxBufferPool::VfxBufferPool()
+	: mutex()
+	, buffersInUse()
+	, usage()
+	, maxCachedBytes(128 * 1024 * 1024)
+	, isDestroyed(false)
+{
+}
+
+VfxBufferPool::~VfxBufferPool()
+{
+	Assert(buffersInUse.empty());
+	
+	trim();
+}
+
+VfxBufferPool * VfxBufferPool::create()
+{
+	return new VfxBufferPool();
+}
+
+void VfxBufferPool::destroy()
+{
+	bool canDelete;
+	
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		
+		Assert(isDestroyed == false);
+		isDestroyed = true;
+		
+		freeCachedBuffers();
+		
+		// note : once isDestroyed is set, the last buffer recycled deletes the pool. this is decided while holding
+		//        the lock, so exactly one of us deletes it. we mustn't touch the pool after releasing the lock
+		//        when buffers are still in use, as recycle may delete it from another thread at any time
+		
+		canDelete = buffersInUse.empty();
+	}
+	
+	if (canDelete)
+		delete this;
+}
+
+VfxBuffer * VfxBufferPool::alloc(const int numBytes)
+{
+	Assert(numBytes > 0 && numBytes <= (1 << 30));
+	
+	int capacity;
+	const int sizeClass = getSizeClass(numBytes, capacity);
+	
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	VfxBuffer * buffer;
+	
+	std::vector<VfxBuffer*> & freeList = freeLists[sizeClass];
+	
+	if (!freeList.empty())
+	{
+		buffer = freeList.back();
+		freeList.pop_back();
+		
+		usage.numBytesCached -= buffer->capacity;
+		usage.numBuffersCached--;
+		usage.numRecycledAllocations++;
+	}
+	else
+	{
+		uint8_t * memory = (uint8_t*)MemAlloc(kBufferHeaderSize + capacity, 16);
+		
+		buffer = new (memory) VfxBuffer();
+		buffer->pool = this;
+		buffer->sizeClass = sizeClass;
+		buffer->capacity = capacity;
+		buffer->data = memory + kBufferHeaderSize;
+		
+		usage.numHeapAllocations++;
+	}
+	
+	buffer->refCount.store(1);
+	
+	usage.numBytesInUse += buffer->capacity;
+	usage.numBuffersInUse++;
+	
+	auto i = std::lower_bound(buffersInUse.begin(), buffersInUse.end(), buffer,
+		[](const VfxBuffer * a, const VfxBuffer * b) { return a->data < b->data; });
+	buffersInUse.insert(i, buffer);
+	
+	return buffer;
+}
+
+VfxBuffer * VfxBufferPool::retain(const void * p)
+{
+	if (p == nullptr)
+		return nullptr;
+	
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	// find the last buffer starting at or before p
+	
+	auto i = std::upper_bound(buffersInUse.begin(), buffersInUse.end(), p,
+		[](const void * p, const VfxBuffer * buffer) { return p < (const void*)buffer->data; });
+	
+	if (i == buffersInUse.begin())
+		return nullptr;
+	
+	VfxBuffer * buffer = *(i - 1);
+	
+	if (buffer->contains(p) == false)
+		return nullptr;
+	
+	// the buffer may be on its way back to the pool. only retain it when someone else still holds a reference
+	
+	int refCount = buffer->refCount.load();
+	
+	while (refCount > 0)
+	{
+		if (buffer->refCount.compare_exchange_weak(refCount, refCount + 1))
+			return buffer;
+	}
+	
+	return nullptr;
+}
+
+void VfxBufferPool::trim()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	freeCachedBuffers();
+}
+
+void VfxBufferPool::freeCachedBuffers()
+{
+	for (auto & freeList : freeLists)
+	{
+		for (auto * buffer : freeList)
+			freeBuffer(buffer);
+		
+		freeList.clear();
+	}
+	
+	usage.numBytesCached = 0;
+	usage.numBuffersCached = 0;
+}
+
+void VfxBufferPool::setMaxCachedBytes(const int64_t numBytes)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	maxCachedBytes = numBytes;
+}
+
+void VfxBufferPool::getMemoryUsage(MemoryUsage & result) const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	
+	result = usage;
+}
+
+VfxBufferPool & VfxBufferPool::getCurrent()
+{
+	if (g_currentVfxGraph != nullptr && g_currentVfxGraph->bufferPool != nullptr)
+		return *g_currentVfxGraph->bufferPool;
+	
+	// note : the process wide pool is never destroyed, as buffers may be released during static destruction
+	
+	static VfxBufferPool * s_pool = VfxBufferPool::create();
+	
+	return *s_pool;
+}
+
+void VfxBufferPool::recycle(VfxBuffer * buffer)
+{
+	bool canDelete = false;
+	
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		
+		auto i = std::lower_bound(buffersInUse.begin(), buffersInUse.end(), buffer,
+			[](const VfxBuffer * a, const VfxBuffer * b) { return a->data < b->data; });
+		Assert(i != buffersInUse.end() && *i == buffer);
+		buffersInUse.erase(i);
+		
+		usage.numBytesInUse -= buffer->capacity;
+		usage.numBuffersInUse--;
+		
+		if (isDestroyed || usage.numBytesCached + buffer->capacity > maxCachedBytes)
+		{
+			freeBuffer(buffer);
+			
+			canDelete = isDestroyed && buffersInUse.empty();
+		}
+		else
+		{
+			freeLists[buffer->sizeClass].push_back(buffer);
+			
+			usage.numBytesCached += buffer->capacity;
+			usage.numBuffersCached++;
+		}
+	}
+	
+	if (canDelete)
+		delete this;
+}
+
+void VfxBufferPool::freeBuffer(VfxBuffer * buffer)
+{
+	buffer->~VfxBuffer();
+	
+	MemFree(buffer);
+}
+
+int VfxBufferPool::getSizeClass(const int numBytes, int & capacity)
+{
+	if (numBytes <= kMinCapacity)
+	{
+		capacity = kMinCapacity;
+		return 0;
+	}
+	
+	// use four size classes per power of two, so at most 25% of a buffer is wasted
+	
+	int log2 = 0;
+	while (((numBytes - 1) >> (log2 + 1)) != 0)
+		log2++;
+	
+	const int step = 1 << (log2 - 2);
+	
+	capacity = (numBytes + step - 1) & ~(step - 1);
+	
+	const int index = capacity >> (log2 - 2); // 5..8
+	
+	return 1 + (log2 - 8) * 4 + (index - 5);
+}
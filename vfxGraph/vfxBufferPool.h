@@ -0,0 +1,123 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <vector>
+
+struct VfxBufferPool;
+
+/**
+ * A reference counted block of memory allocated from a VfxBufferPool. Buffers are returned to the pool they were
+ * allocated from when their reference count drops to zero, where they are kept around for reuse by the next
+ * allocation of a similar size.
+ */
+struct VfxBuffer
+{
+	VfxBufferPool * pool;
+	std::atomic<int> refCount;
+	int sizeClass;
+	int capacity;    ///< The number of bytes available at 'data'. Always at least the number of bytes requested.
+	uint8_t * data;  ///< 16 byte aligned.
+	
+	void retain()
+	{
+		refCount.fetch_add(1);
+	}
+	
+	void release();
+	
+	bool contains(const void * p) const
+	{
+		return p >= data && p < data + capacity;
+	}
+};
+
+/**
+ * VfxBufferPool recycles the memory used by VfxChannelData and VfxImageCpuData. Each VfxGraph owns a buffer pool,
+ * which is used when allocating memory while the graph is current. Sizes are rounded up to a size class, with four
+ * classes per power of two, so buffers stay reusable when sizes fluctuate a little from frame to frame. This keeps
+ * the heap from fragmenting when e.g. the number of blobs found by a blob detector changes each frame.
+ *
+ * Buffers which are in use can be looked up by address, so passthrough nodes may retain the buffer backing their
+ * input rather than copying it. See VfxChannelData::share and VfxImageCpuData::share.
+ *
+ * The pool is thread-safe, as nodes may be ticked on worker threads.
+ */
+struct VfxBufferPool
+{
+	static const int kMinCapacity = 256;
+	static const int kNumSizeClasses = 1 + (31 - 8) * 4;
+	
+	struct MemoryUsage
+	{
+		int64_t numBytesInUse = 0;
+		int64_t numBytesCached = 0;
+		int numBuffersInUse = 0;
+		int numBuffersCached = 0;
+		int64_t numHeapAllocations = 0; ///< The number of allocations which weren't served from the cache.
+		int64_t numRecycledAllocations = 0;
+	};
+	
+	mutable std::mutex mutex;
+	
+	std::vector<VfxBuffer*> freeLists[kNumSizeClasses];
+	std::vector<VfxBuffer*> buffersInUse; ///< Sorted by address, for lookup by VfxBufferPool::retain.
+	
+	MemoryUsage usage;
+	int64_t maxCachedBytes;
+	
+	bool isDestroyed;
+	
+	static VfxBufferPool * create();
+	void destroy(); ///< Frees the cached buffers. The pool itself is freed once the last buffer in use is released.
+	
+	VfxBuffer * alloc(const int numBytes);
+	VfxBuffer * retain(const void * p); ///< Returns and retains the buffer in use containing 'p', if any.
+	
+	void trim(); ///< Frees all cached buffers.
+	void setMaxCachedBytes(const int64_t numBytes);
+	
+	void getMemoryUsage(MemoryUsage & usage) const;
+	
+	static VfxBufferPool & getCurrent(); ///< The buffer pool of the current graph, or a process wide pool when there is no current graph.
+	
+private:
+	friend struct VfxBuffer;
+	
+	VfxBufferPool();
+	~VfxBufferPool();
+	
+	void recycle(VfxBuffer * buffer);
+	void freeBuffer(VfxBuffer * buffer);
+	void freeCachedBuffers(); ///< Expects the mutex to be locked.
+	
+	static int getSizeClass(const int numBytes, int & capacity);
+};
@@ -28,10 +28,14 @@
 #include "framework.h"
 #include "graph_typeDefinitionLibrary.h"
 #include "Parse.h"
+#include "vfxBufferPool.h"
 #include "vfxGraph.h"
 #include "vfxNodeBase.h"
 #include "vfxNodes/vfxNodeDisplay.h"
 #include "vfxTypes.h"
+#include "vfxWorkerPool.h"
+#include <algorithm>
+#include <functional>
 
 #if VFX_GRAPH_ENABLE_TIMING
 	#include "Timer.h"
@@ -39,7 +43,7 @@
 
 //
 
-VfxGraph * g_currentVfxGraph = nullptr;
+thread_local VfxGraph * g_currentVfxGraph = nullptr;
 
 Surface * g_currentVfxSurface = nullptr;
 
@@ -147,7 +151,13 @@ VfxGraph::VfxGraph(VfxGraphContext * in_context)
 	, displayNodeIds()
 	, currentTickTraversalId(-1)
 	, nextDrawTraversalId(0)
+	, schedule()
+	, scheduleIsDirty(true)
+	, scheduledTickDt(0.f)
+	, numPendingPredeps()
+	, mainThreadQueue()
 	, valuesToFree()
+	, bufferPool(nullptr)
 	, dummySurface(nullptr)
 	, memory()
 	, sx(0)
@@ -161,6 +171,8 @@ VfxGraph::VfxGraph(VfxGraphContext * in_context)
 	
 	dynamicData = new VfxDynamicData();
 	
+	bufferPool = VfxBufferPool::create();
+	
 	dummySurface = new Surface(1, 1, false, false, true, 1);
 }
 
@@ -240,6 +252,9 @@ void VfxGraph::destroy()
 	
 	nodes.clear();
 	
+	bufferPool->destroy();
+	bufferPool = nullptr;
+	
 	context->refCount--;
 	if (context->refCount == 0)
 		delete context;
@@ -329,10 +344,39 @@ void VfxGraph::tick(const int in_sx, const int in_sy, const float dt)
 	Assert(g_currentVfxGraph == nullptr);
 	g_currentVfxGraph = this;
 	
-	// process nodes. start update at display node
+	// process nodes. tick in parallel when a worker pool is available
 	
 	++currentTickTraversalId;
 	
+	VfxWorkerPool * workerPool = context->tryGetSystem<VfxWorkerPool>();
+	
+	if (workerPool != nullptr && workerPool->getNumThreads() > 0)
+	{
+		if (scheduleIsDirty)
+			updateSchedule();
+		
+		if (schedule.canTickInParallel == false)
+			workerPool = nullptr;
+	}
+	
+	if (workerPool != nullptr && workerPool->getNumThreads() > 0)
+		tickParallel(*workerPool, dt);
+	else
+		tickSerial(dt);
+	
+	//
+	
+	time += dt;
+	
+	//
+	
+	g_currentVfxGraph = nullptr;
+}
+
+void VfxGraph::tickSerial(const float dt)
+{
+	// start update at display node
+	
 	if (displayNodeIds.empty() == false)
 	{
 		for (auto displayNodeId : displayNodeIds)
@@ -364,14 +408,256 @@ void VfxGraph::tick(const int in_sx, const int in_sy, const float dt)
 			node->traverseTick(currentTickTraversalId, dt);
 		}
 	}
+}
+
+static void tickScheduledNode(void * userData, const int elemIndex)
+{
+	VfxGraph * vfxGraph = (VfxGraph*)userData;
 	
-	//
+	VfxNodeBase * node = vfxGraph->schedule.elems[elemIndex].node;
 	
-	time += dt;
+	// note : the current graph is already set when ticking on the main thread
 	
-	//
+	VfxGraph * restore = g_currentVfxGraph;
+	g_currentVfxGraph = vfxGraph;
+	{
+		node->scheduledTick(vfxGraph->currentTickTraversalId, vfxGraph->scheduledTickDt);
+	}
+	g_currentVfxGraph = restore;
+}
+
+void VfxGraph::tickParallel(VfxWorkerPool & workerPool, const float dt)
+{
+	vfxCpuTimingBlock(VfxGraph_TickParallel);
 	
-	g_currentVfxGraph = nullptr;
+	// nodes become ready once all of their predeps have been ticked. thread-safe nodes are pushed onto the worker
+	// pool, other nodes are ticked on the main thread in schedule order. afterTick is called on the main thread
+	// once a node has finished ticking, before the nodes depending on it become ready
+	
+	scheduledTickDt = dt;
+	
+	const int numElems = schedule.elems.size();
+	
+	numPendingPredeps.resize(numElems);
+	mainThreadQueue.clear();
+	
+	auto makeReady = [&](const int elemIndex)
+	{
+		if (schedule.elems[elemIndex].runOnMainThread)
+		{
+			mainThreadQueue.push_back(elemIndex);
+			std::push_heap(mainThreadQueue.begin(), mainThreadQueue.end(), std::greater<int>());
+		}
+		else
+		{
+			workerPool.push(elemIndex);
+		}
+	};
+	
+	auto finish = [&](const int elemIndex)
+	{
+		auto & elem = schedule.elems[elemIndex];
+		
+		elem.node->afterTick(dt);
+		
+		for (int i = 0; i < elem.numSuccessors; ++i)
+		{
+			const int successorIndex = schedule.successors[elem.firstSuccessor + i];
+			
+			if (--numPendingPredeps[successorIndex] == 0)
+				makeReady(successorIndex);
+		}
+	};
+	
+	workerPool.begin(tickScheduledNode, this);
+	{
+		for (int i = 0; i < numElems; ++i)
+			numPendingPredeps[i] = schedule.elems[i].numPredeps;
+		
+		for (int i = 0; i < numElems; ++i)
+			if (numPendingPredeps[i] == 0)
+				makeReady(i);
+		
+		int numRemaining = numElems;
+		
+		while (numRemaining > 0)
+		{
+			int elemIndex;
+			
+			if (workerPool.popCompletedJob(elemIndex, false))
+			{
+				finish(elemIndex);
+				numRemaining--;
+			}
+			else if (mainThreadQueue.empty() == false)
+			{
+				std::pop_heap(mainThreadQueue.begin(), mainThreadQueue.end(), std::greater<int>());
+				elemIndex = mainThreadQueue.back();
+				mainThreadQueue.pop_back();
+				
+				tickScheduledNode(this, elemIndex);
+				finish(elemIndex);
+				numRemaining--;
+			}
+			else if (workerPool.popCompletedJob(elemIndex, true))
+			{
+				finish(elemIndex);
+				numRemaining--;
+			}
+			else
+			{
+				// there's nothing left to run. this would be a bug in the schedule
+				
+				AssertMsg(false, "schedule stalled with %d nodes remaining", numRemaining);
+				break;
+			}
+		}
+	}
+	workerPool.end();
+}
+
+void VfxGraph::invalidateSchedule()
+{
+	scheduleIsDirty = true;
+}
+
+static void addNodeToSchedule(
+	VfxNodeBase * node,
+	std::map<VfxNodeBase*, int> & scheduleIndices,
+	VfxGraph::Schedule & schedule)
+{
+	// note : the node is marked as being visited (-1) before visiting its predeps, to detect cycles
+	
+	scheduleIndices[node] = -1;
+	
+	for (auto * predep : node->predeps)
+	{
+		if (scheduleIndices.count(predep) == 0)
+			addNodeToSchedule(predep, scheduleIndices, schedule);
+	}
+	
+	VfxGraph::Schedule::Elem elem;
+	elem.node = node;
+	elem.firstPredep = schedule.predeps.size();
+	elem.numPredeps = 0;
+	elem.firstSuccessor = 0;
+	elem.numSuccessors = 0;
+	elem.runOnMainThread = (node->isThreadSafe == false);
+	
+	for (auto * predep : node->predeps)
+	{
+		const int predepIndex = scheduleIndices[predep];
+		
+		// skip predeps which are still being visited. these close a cycle
+		
+		if (predepIndex == -1)
+			continue;
+		
+		// skip duplicate predeps
+		
+		bool isDuplicate = false;
+		
+		for (int i = 0; i < elem.numPredeps; ++i)
+			if (schedule.predeps[elem.firstPredep + i] == predepIndex)
+				isDuplicate = true;
+		
+		if (isDuplicate)
+			continue;
+		
+		schedule.predeps.push_back(predepIndex);
+		schedule.elems[predepIndex].numSuccessors++;
+		elem.numPredeps++;
+	}
+	
+	scheduleIndices[node] = schedule.elems.size();
+	schedule.elems.push_back(elem);
+}
+
+void VfxGraph::updateSchedule()
+{
+	vfxCpuTimingBlock(VfxGraph_UpdateSchedule);
+	
+	schedule.elems.clear();
+	schedule.predeps.clear();
+	schedule.successors.clear();
+	schedule.canTickInParallel = true;
+	
+	// add nodes in the same order as tickSerial visits them, starting at the display nodes
+	
+	std::map<VfxNodeBase*, int> scheduleIndices;
+	
+	for (auto displayNodeId : displayNodeIds)
+	{
+		auto nodeItr = nodes.find(displayNodeId);
+		
+		if (nodeItr != nodes.end() && scheduleIndices.count(nodeItr->second) == 0)
+			addNodeToSchedule(nodeItr->second, scheduleIndices, schedule);
+	}
+	
+	for (auto & i : nodes)
+	{
+		VfxNodeBase * node = i.second;
+		
+		if (scheduleIndices.count(node) == 0)
+			addNodeToSchedule(node, scheduleIndices, schedule);
+	}
+	
+	// build the list of successors
+	
+	int numSuccessors = 0;
+	
+	for (auto & elem : schedule.elems)
+	{
+		elem.firstSuccessor = numSuccessors;
+		numSuccessors += elem.numSuccessors;
+		elem.numSuccessors = 0;
+	}
+	
+	schedule.successors.resize(numSuccessors);
+	
+	for (int elemIndex = 0; elemIndex < (int)schedule.elems.size(); ++elemIndex)
+	{
+		auto & elem = schedule.elems[elemIndex];
+		
+		for (int i = 0; i < elem.numPredeps; ++i)
+		{
+			auto & predep = schedule.elems[schedule.predeps[elem.firstPredep + i]];
+			
+			schedule.successors[predep.firstSuccessor + predep.numSuccessors++] = elemIndex;
+		}
+	}
+	
+	// triggers write to the inputs of the triggered node. when the triggered node doesn't depend on the node
+	// triggering it, the two may run at the same time, so both are ticked on the main thread instead
+	
+	for (int elemIndex = 0; elemIndex < (int)schedule.elems.size(); ++elemIndex)
+	{
+		auto & elem = schedule.elems[elemIndex];
+		
+		if (elem.node->flags & VfxNodeBase::kFlag_CustomTraverseTick)
+			schedule.canTickInParallel = false;
+		
+		for (auto & triggerTarget : elem.node->triggerTargets)
+		{
+			auto targetItr = scheduleIndices.find(triggerTarget.srcNode);
+			
+			if (targetItr == scheduleIndices.end())
+				continue;
+			
+			auto & targetElem = schedule.elems[targetItr->second];
+			
+			const int * predepsBegin = schedule.predeps.data() + targetElem.firstPredep;
+			const int * predepsEnd = predepsBegin + targetElem.numPredeps;
+			
+			if (std::find(predepsBegin, predepsEnd, elemIndex) == predepsEnd)
+			{
+				elem.runOnMainThread = true;
+				targetElem.runOnMainThread = true;
+			}
+		}
+	}
+	
+	scheduleIsDirty = false;
 }
 
 void VfxGraph::draw() const
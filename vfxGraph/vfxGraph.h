@@ -50,16 +50,18 @@ struct VfxDynamicData;
 struct VfxDynamicInputSocketValue;
 struct VfxDynamicLink;
 
+struct VfxBufferPool;
 struct VfxGraph;
 struct VfxNodeBase;
 struct VfxPlug;
 struct VfxResourceBase;
+struct VfxWorkerPool;
 
 struct VfxNodeDisplay;
 struct VfxNodeOutput;
 
-// vfxgraph traversal state
-extern VfxGraph * g_currentVfxGraph;
+// vfxgraph traversal state. the current graph is thread local, as nodes may be ticked on worker threads
+extern thread_local VfxGraph * g_currentVfxGraph;
 extern Surface * g_currentVfxSurface;
 
 struct VfxMemoryComponent
@@ -153,6 +155,31 @@ struct VfxGraph
 		}
 	};
 	
+	/**
+	 * The schedule lists the nodes of the graph in evaluation order, together with the (unique) nodes each node
+	 * depends on and the nodes depending on it. Dependencies are derived from predeps, which are added for each
+	 * link, and always point to nodes earlier in the schedule. The schedule is used to tick the graph in parallel,
+	 * when a worker pool is added to the graph context.
+	 */
+	struct Schedule
+	{
+		struct Elem
+		{
+			VfxNodeBase * node;
+			int firstPredep;
+			int numPredeps;
+			int firstSuccessor;
+			int numSuccessors;
+			bool runOnMainThread; // set for nodes which aren't thread-safe, or which trigger nodes (or are triggered by nodes) they aren't linked to through predeps
+		};
+		
+		std::vector<Elem> elems;
+		std::vector<int> predeps;    // for each elem, indices into elems of the nodes it depends on
+		std::vector<int> successors; // for each elem, indices into elems of the nodes depending on it
+		
+		bool canTickInParallel; // false when the graph contains nodes with a custom tick traversal. these are ticked serially
+	};
+	
 	VfxGraphContext * context;
 	
 	std::map<GraphNodeId, VfxNodeBase*> nodes;
@@ -166,8 +193,18 @@ struct VfxGraph
 	int currentTickTraversalId;
 	mutable int nextDrawTraversalId;
 	
+	Schedule schedule;
+	bool scheduleIsDirty;
+	
+	// state used while ticking in parallel
+	float scheduledTickDt;
+	std::vector<int> numPendingPredeps;
+	std::vector<int> mainThreadQueue; // min-heap of the elems ready to be ticked on the main thread
+	
 	std::vector<ValueToFree> valuesToFree;
 	
+	VfxBufferPool * bufferPool; // recycles the memory used by channel and image data of the nodes in this graph
+	
 	Surface * dummySurface;
 	
 	VfxMemoryComponent memory;
@@ -184,10 +221,15 @@ struct VfxGraph
 	void connectToInputLiteral(VfxPlug & input, const std::string & inputValue);
 	
 	void tick(const int sx, const int sy, const float dt);
+	void tickSerial(const float dt);
+	void tickParallel(VfxWorkerPool & workerPool, const float dt);
 	void draw() const;
 	int traverseDraw() const;
 	
 	VfxNodeDisplay * getMainDisplayNode() const;
+	
+	void invalidateSchedule(); // marks the schedule as dirty. this should be called whenever nodes or links are added or removed
+	void updateSchedule();
 };
 
 //
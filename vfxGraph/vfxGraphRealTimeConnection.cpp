@@ -26,6 +26,7 @@
 */
 
 #include "graphEdit.h"
+#include "vfxBufferPool.h"
 #include "vfxGraph.h"
 #include "vfxGraphRealTimeConnection.h"
 #include "vfxNodeBase.h"
@@ -127,6 +128,8 @@ void RealTimeConnection::nodeAdd(const GraphNode & node)
 	if (vfxGraph == nullptr)
 		return;
 	
+	vfxGraph->invalidateSchedule();
+	
 	auto nodeItr = vfxGraph->nodes.find(node.id);
 	
 	Assert(nodeItr == vfxGraph->nodes.end());
@@ -203,6 +206,8 @@ void RealTimeConnection::nodeRemove(const GraphNodeId nodeId)
 	if (vfxGraph == nullptr)
 		return;
 	
+	vfxGraph->invalidateSchedule();
+	
 	auto nodeItr = vfxGraph->nodes.find(nodeId);
 	
 	Assert(nodeItr != vfxGraph->nodes.end());
@@ -260,6 +265,8 @@ void RealTimeConnection::linkAdd(const GraphLinkId linkId, const GraphNodeId src
 	if (vfxGraph == nullptr)
 		return;
 	
+	vfxGraph->invalidateSchedule();
+	
 	auto srcNodeItr = vfxGraph->nodes.find(srcNodeId);
 	auto dstNodeItr = vfxGraph->nodes.find(dstNodeId);
 	
@@ -358,6 +365,8 @@ void RealTimeConnection::linkRemove(const GraphLinkId linkId, const GraphNodeId
 	if (vfxGraph == nullptr)
 		return;
 	
+	vfxGraph->invalidateSchedule();
+	
 	auto srcNodeItr = vfxGraph->nodes.find(srcNodeId);
 	auto dstNodeItr = vfxGraph->nodes.find(dstNodeId);
 	
@@ -1173,6 +1182,16 @@ bool RealTimeConnection::getNodeDescription(const GraphNodeId nodeId, std::vecto
 	d.add("gpu: %.3fms", node->gpuTimeAvg / 1000000.0);
 #endif
 	
+	if (vfxGraph->bufferPool != nullptr)
+	{
+		VfxBufferPool::MemoryUsage usage;
+		vfxGraph->bufferPool->getMemoryUsage(usage);
+		
+		d.add("graph buffers: %.2f Kb in use (%d), %.2f Kb cached (%d)",
+			usage.numBytesInUse / 1024.0, usage.numBuffersInUse,
+			usage.numBytesCached / 1024.0, usage.numBuffersCached);
+	}
+	
 #if VFXGRAPH_DEBUG_PREDEPS
 	d.add("predeps: %d", node->predeps.size());
 	for (auto & predep : node->predeps)
@@ -30,22 +30,40 @@
 #include "MemAlloc.h"
 #include "StringEx.h"
 #include "Timer.h"
+#include "vfxBufferPool.h"
 #include "vfxGraph.h"
 #include "vfxNodeBase.h"
+#include "vfxParallelRows.h"
 #include <string.h>
 
 //
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define USE_NEON 1
+#else
+	#define USE_NEON 0 // do not alter
+#endif
+
+#if USE_NEON
+	// for interleave and deinterleave methods of VfxImageCpu
+	#include <arm_neon.h>
+#endif
+
 #ifdef __SSE2__
 	// for interleave and deinterleave methods of VfxImageCpu
-	#include <xmmintrin.h>
+	#include <emmintrin.h>
 #endif
 
 #ifdef __SSSE3__
-	// for _mm_shuffle_epi8 in deinterleave4
+	// for _mm_shuffle_epi8 in (de)interleave3 and deinterleave4
 	#include <tmmintrin.h>
 #endif
 
+#ifdef __AVX2__
+	// for the 256 bit versions of interleave4 and deinterleave4
+	#include <immintrin.h>
+#endif
+
 //
 
 VfxImage_Texture::VfxImage_Texture()
@@ -197,109 +215,375 @@ int VfxImageCpu::getMemoryUsage() const
 	return result;
 }
 
-void VfxImageCpu::interleave1(const Channel & channel1, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
+// row kernels for interleave and deinterleave. each kernel processes as many pixels as it can using SIMD, and
+// returns the number of pixels it processed. the remaining pixels are processed by the (scalar) caller
+
+static int interleave3Row_SIMD(
+	const uint8_t * __restrict src1, const uint8_t * __restrict src2, const uint8_t * __restrict src3,
+	uint8_t * __restrict dst, const int sx)
 {
-	const int dstPitch = _dstPitch == 0 ? sx * 1 : _dstPitch;
+	int x = 0;
 	
-	for (int y = 0; y < sy; ++y)
+#if USE_NEON
+	for (; x + 16 <= sx; x += 16)
 	{
-		const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
-			  uint8_t * __restrict dst  = _dst + y * dstPitch;
+		uint8x16x3_t rgb;
+		rgb.val[0] = vld1q_u8(src1 + x);
+		rgb.val[1] = vld1q_u8(src2 + x);
+		rgb.val[2] = vld1q_u8(src3 + x);
 		
-		memcpy(dst, src1, sx);
+		vst3q_u8(dst + x * 3, rgb);
 	}
+#elif defined(__SSSE3__)
+	// each output vector gathers bytes from all three channels. shuffle each channel into place and combine them
+	
+	const __m128i r0 = _mm_setr_epi8( 0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1,  5);
+	const __m128i g0 = _mm_setr_epi8(-1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1, -1);
+	const __m128i b0 = _mm_setr_epi8(-1, -1,  0, -1, -1,  1, -1, -1,  2, -1, -1,  3, -1, -1,  4, -1);
+	const __m128i r1 = _mm_setr_epi8(-1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10, -1);
+	const __m128i g1 = _mm_setr_epi8( 5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1, 10);
+	const __m128i b1 = _mm_setr_epi8(-1,  5, -1, -1,  6, -1, -1,  7, -1, -1,  8, -1, -1,  9, -1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15, -1);
+	const __m128i b2 = _mm_setr_epi8(10, -1, -1, 11, -1, -1, 12, -1, -1, 13, -1, -1, 14, -1, -1, 15);
+	
+	for (; x + 16 <= sx; x += 16)
+	{
+		const __m128i r = _mm_loadu_si128((const __m128i*)(src1 + x));
+		const __m128i g = _mm_loadu_si128((const __m128i*)(src2 + x));
+		const __m128i b = _mm_loadu_si128((const __m128i*)(src3 + x));
+		
+		const __m128i rgb0 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r0), _mm_shuffle_epi8(g, g0)), _mm_shuffle_epi8(b, b0));
+		const __m128i rgb1 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r1), _mm_shuffle_epi8(g, g1)), _mm_shuffle_epi8(b, b1));
+		const __m128i rgb2 = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(r, r2), _mm_shuffle_epi8(g, g2)), _mm_shuffle_epi8(b, b2));
+		
+		__m128i * __restrict dst_16 = (__m128i*)(dst + x * 3);
+		
+		_mm_storeu_si128(dst_16 + 0, rgb0);
+		_mm_storeu_si128(dst_16 + 1, rgb1);
+		_mm_storeu_si128(dst_16 + 2, rgb2);
+	}
+#endif
+
+	return x;
 }
 
-void VfxImageCpu::interleave3(const Channel & channel1, const Channel & channel2, const Channel & channel3, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
+static int interleave4Row_SIMD(
+	const uint8_t * __restrict src1, const uint8_t * __restrict src2, const uint8_t * __restrict src3, const uint8_t * __restrict src4,
+	uint8_t * __restrict dst, const int sx)
 {
-	const int dstPitch = _dstPitch == 0 ? sx * 3 : _dstPitch;
+	int x = 0;
+	
+#if USE_NEON
+	for (; x + 16 <= sx; x += 16)
+	{
+		uint8x16x4_t rgba;
+		rgba.val[0] = vld1q_u8(src1 + x);
+		rgba.val[1] = vld1q_u8(src2 + x);
+		rgba.val[2] = vld1q_u8(src3 + x);
+		rgba.val[3] = vld1q_u8(src4 + x);
+		
+		vst4q_u8(dst + x * 4, rgba);
+	}
+#else
+	#if defined(__AVX2__)
+	for (; x + 32 <= sx; x += 32)
+	{
+		const __m256i r = _mm256_loadu_si256((const __m256i*)(src1 + x));
+		const __m256i g = _mm256_loadu_si256((const __m256i*)(src2 + x));
+		const __m256i b = _mm256_loadu_si256((const __m256i*)(src3 + x));
+		const __m256i a = _mm256_loadu_si256((const __m256i*)(src4 + x));
+		
+		// note : AVX unpacks operate on each 128 bit lane separately. the lower lanes end up holding pixels 0..15,
+		//        the upper lanes pixels 16..31. the lanes are put back in order when storing
+		
+		const __m256i rg1 = _mm256_unpacklo_epi8(r, g);
+		const __m256i rg2 = _mm256_unpackhi_epi8(r, g);
+		const __m256i ba1 = _mm256_unpacklo_epi8(b, a);
+		const __m256i ba2 = _mm256_unpackhi_epi8(b, a);
+		
+		const __m256i rgba1 = _mm256_unpacklo_epi16(rg1, ba1); // pixels 0..3, 16..19
+		const __m256i rgba2 = _mm256_unpackhi_epi16(rg1, ba1); // pixels 4..7, 20..23
+		const __m256i rgba3 = _mm256_unpacklo_epi16(rg2, ba2); // pixels 8..11, 24..27
+		const __m256i rgba4 = _mm256_unpackhi_epi16(rg2, ba2); // pixels 12..15, 28..31
+		
+		__m256i * __restrict dst_32 = (__m256i*)(dst + x * 4);
+		
+		_mm256_storeu_si256(dst_32 + 0, _mm256_permute2x128_si256(rgba1, rgba2, 0x20));
+		_mm256_storeu_si256(dst_32 + 1, _mm256_permute2x128_si256(rgba3, rgba4, 0x20));
+		_mm256_storeu_si256(dst_32 + 2, _mm256_permute2x128_si256(rgba1, rgba2, 0x31));
+		_mm256_storeu_si256(dst_32 + 3, _mm256_permute2x128_si256(rgba3, rgba4, 0x31));
+	}
+	#endif
+	
+	#if defined(__SSE2__)
+	for (; x + 16 <= sx; x += 16)
+	{
+		const __m128i r = _mm_loadu_si128((const __m128i*)(src1 + x));
+		const __m128i g = _mm_loadu_si128((const __m128i*)(src2 + x));
+		const __m128i b = _mm_loadu_si128((const __m128i*)(src3 + x));
+		const __m128i a = _mm_loadu_si128((const __m128i*)(src4 + x));
+		
+		const __m128i rg1 = _mm_unpacklo_epi8(r, g);
+		const __m128i rg2 = _mm_unpackhi_epi8(r, g);
+		const __m128i ba1 = _mm_unpacklo_epi8(b, a);
+		const __m128i ba2 = _mm_unpackhi_epi8(b, a);
+		
+		__m128i * __restrict dst_16 = (__m128i*)(dst + x * 4);
+		
+		_mm_storeu_si128(dst_16 + 0, _mm_unpacklo_epi16(rg1, ba1));
+		_mm_storeu_si128(dst_16 + 1, _mm_unpackhi_epi16(rg1, ba1));
+		_mm_storeu_si128(dst_16 + 2, _mm_unpacklo_epi16(rg2, ba2));
+		_mm_storeu_si128(dst_16 + 3, _mm_unpackhi_epi16(rg2, ba2));
+	}
+	#endif
+#endif
+
+	return x;
+}
+
+static int deinterleave3Row_SIMD(
+	const uint8_t * __restrict src,
+	uint8_t * __restrict dst1, uint8_t * __restrict dst2, uint8_t * __restrict dst3, const int sx)
+{
+	int x = 0;
+	
+#if USE_NEON
+	for (; x + 16 <= sx; x += 16)
+	{
+		const uint8x16x3_t rgb = vld3q_u8(src + x * 3);
+		
+		vst1q_u8(dst1 + x, rgb.val[0]);
+		vst1q_u8(dst2 + x, rgb.val[1]);
+		vst1q_u8(dst3 + x, rgb.val[2]);
+	}
+#elif defined(__SSSE3__)
+	// each channel gathers bytes from all three input vectors. shuffle each input vector into place and combine them
+	
+	const __m128i r0 = _mm_setr_epi8( 0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i r1 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i r2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  1,  4,  7, 10, 13);
+	const __m128i g0 = _mm_setr_epi8( 1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i g1 = _mm_setr_epi8(-1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15, -1, -1, -1, -1, -1);
+	const __m128i g2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  2,  5,  8, 11, 14);
+	const __m128i b0 = _mm_setr_epi8( 2,  5,  8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i b1 = _mm_setr_epi8(-1, -1, -1, -1, -1,  1,  4,  7, 10, 13, -1, -1, -1, -1, -1, -1);
+	const __m128i b2 = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1,  0,  3,  6,  9, 12, 15);
+	
+	for (; x + 16 <= sx; x += 16)
+	{
+		const __m128i * __restrict src_16 = (const __m128i*)(src + x * 3);
+		
+		const __m128i rgb0 = _mm_loadu_si128(src_16 + 0);
+		const __m128i rgb1 = _mm_loadu_si128(src_16 + 1);
+		const __m128i rgb2 = _mm_loadu_si128(src_16 + 2);
+		
+		const __m128i r = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(rgb0, r0), _mm_shuffle_epi8(rgb1, r1)), _mm_shuffle_epi8(rgb2, r2));
+		const __m128i g = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(rgb0, g0), _mm_shuffle_epi8(rgb1, g1)), _mm_shuffle_epi8(rgb2, g2));
+		const __m128i b = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(rgb0, b0), _mm_shuffle_epi8(rgb1, b1)), _mm_shuffle_epi8(rgb2, b2));
+		
+		_mm_storeu_si128((__m128i*)(dst1 + x), r);
+		_mm_storeu_si128((__m128i*)(dst2 + x), g);
+		_mm_storeu_si128((__m128i*)(dst3 + x), b);
+	}
+#endif
+
+	return x;
+}
+
+static int deinterleave4Row_SIMD(
+	const uint8_t * __restrict src,
+	uint8_t * __restrict dst1, uint8_t * __restrict dst2, uint8_t * __restrict dst3, uint8_t * __restrict dst4, const int sx)
+{
+	int x = 0;
 	
-	for (int y = 0; y < sy; ++y)
+#if USE_NEON
+	for (; x + 16 <= sx; x += 16)
 	{
-		const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
-		const uint8_t * __restrict src2 = channel2.data + y * channel2.pitch;
-		const uint8_t * __restrict src3 = channel3.data + y * channel3.pitch;
-			  uint8_t * __restrict dst  = _dst + y * dstPitch;
+		const uint8x16x4_t rgba = vld4q_u8(src + x * 4);
 		
-		for (int x = 0; x < sx; ++x)
+		vst1q_u8(dst1 + x, rgba.val[0]);
+		vst1q_u8(dst2 + x, rgba.val[1]);
+		vst1q_u8(dst3 + x, rgba.val[2]);
+		vst1q_u8(dst4 + x, rgba.val[3]);
+	}
+#elif defined(__SSSE3__) // SSSE3 due to _mm_shuffle_epi8
+	/*
+	without SSE:
+		[II] Benchmark: deinterleave4: 0.000278 sec
+		[II] Benchmark: deinterleave4: 0.000313 sec
+		[II] Benchmark: deinterleave4: 0.000359 sec
+	 
+	with SSE:
+		[II] Benchmark: deinterleave4: 0.000061 sec
+		[II] Benchmark: deinterleave4: 0.000069 sec
+		[II] Benchmark: deinterleave4: 0.000076 sec
+	*/
+	
+	#if defined(__AVX2__)
+	{
+		const __m256i shuffleIndices = _mm256_setr_epi8(
+			0, 4,  8, 12, 1, 5,  9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+			0, 4,  8, 12, 1, 5,  9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+		
+		const __m256i permuteIndices = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		
+		for (; x + 16 <= sx; x += 16)
 		{
-			*dst++ = *src1++;
-			*dst++ = *src2++;
-			*dst++ = *src3++;
+			const __m256i * __restrict src_32 = (const __m256i*)(src + x * 4);
+			
+			// group the channels within each four pixel block, then gather the blocks so each lane holds eight
+			// pixels worth of two channels
+			
+			const __m256i rgba1 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(src_32 + 0), shuffleIndices), permuteIndices); // r0..7 g0..7 | b0..7 a0..7
+			const __m256i rgba2 = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(_mm256_loadu_si256(src_32 + 1), shuffleIndices), permuteIndices); // r8..15 g8..15 | b8..15 a8..15
+			
+			const __m256i rb = _mm256_unpacklo_epi64(rgba1, rgba2);
+			const __m256i ga = _mm256_unpackhi_epi64(rgba1, rgba2);
+			
+			_mm_storeu_si128((__m128i*)(dst1 + x), _mm256_castsi256_si128(rb));
+			_mm_storeu_si128((__m128i*)(dst2 + x), _mm256_castsi256_si128(ga));
+			_mm_storeu_si128((__m128i*)(dst3 + x), _mm256_extracti128_si256(rb, 1));
+			_mm_storeu_si128((__m128i*)(dst4 + x), _mm256_extracti128_si256(ga, 1));
 		}
 	}
+	#endif
+	
+	const __m128i shuffleIndices = _mm_set_epi8(
+		15, 11, 7, 3,
+		14, 10, 6, 2,
+		13, 9,  5, 1,
+		12, 8,  4, 0);
+	
+	for (; x + 8 <= sx; x += 8)
+	{
+		const __m128i * __restrict src_16 = (const __m128i*)(src + x * 4);
+		
+		const __m128i rgba1 = _mm_shuffle_epi8(_mm_loadu_si128(src_16 + 0), shuffleIndices);
+		const __m128i rgba2 = _mm_shuffle_epi8(_mm_loadu_si128(src_16 + 1), shuffleIndices);
+		
+		const __m128i rg = _mm_unpacklo_epi32(rgba1, rgba2);
+		const __m128i ba = _mm_unpackhi_epi32(rgba1, rgba2);
+		
+		_mm_storel_epi64((__m128i*)(dst1 + x), rg);
+		_mm_storel_epi64((__m128i*)(dst2 + x), _mm_unpackhi_epi64(rg, rg));
+		_mm_storel_epi64((__m128i*)(dst3 + x), ba);
+		_mm_storel_epi64((__m128i*)(dst4 + x), _mm_unpackhi_epi64(ba, ba));
+	}
+#elif defined(__SSE2__)
+	// without byte shuffles, isolate each channel using shifts and masks, and pack the results back into bytes
+	
+	const __m128i mask = _mm_set1_epi32(0xff);
+	
+	for (; x + 16 <= sx; x += 16)
+	{
+		const __m128i * __restrict src_16 = (const __m128i*)(src + x * 4);
+		
+		const __m128i rgba1 = _mm_loadu_si128(src_16 + 0);
+		const __m128i rgba2 = _mm_loadu_si128(src_16 + 1);
+		const __m128i rgba3 = _mm_loadu_si128(src_16 + 2);
+		const __m128i rgba4 = _mm_loadu_si128(src_16 + 3);
+		
+	#define DEINTERLEAVE_CHANNEL(shift, dst) \
+		_mm_storeu_si128((__m128i*)(dst + x), \
+			_mm_packus_epi16( \
+				_mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(rgba1, shift), mask), _mm_and_si128(_mm_srli_epi32(rgba2, shift), mask)), \
+				_mm_packs_epi32(_mm_and_si128(_mm_srli_epi32(rgba3, shift), mask), _mm_and_si128(_mm_srli_epi32(rgba4, shift), mask))))
+		
+		DEINTERLEAVE_CHANNEL( 0, dst1);
+		DEINTERLEAVE_CHANNEL( 8, dst2);
+		DEINTERLEAVE_CHANNEL(16, dst3);
+		DEINTERLEAVE_CHANNEL(24, dst4);
+		
+	#undef DEINTERLEAVE_CHANNEL
+	}
+#endif
+
+	return x;
 }
 
-void VfxImageCpu::interleave4(const Channel & channel1, const Channel & channel2, const Channel & channel3, const Channel & channel4, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
+//
+
+void VfxImageCpu::interleave1(const Channel & channel1, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
 {
-	const int dstPitch = _dstPitch == 0 ? sx * 4 : _dstPitch;
+	const int dstPitch = _dstPitch == 0 ? sx * 1 : _dstPitch;
 	
-	for (int y = 0; y < sy; ++y)
-	{
-		const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
-		const uint8_t * __restrict src2 = channel2.data + y * channel2.pitch;
-		const uint8_t * __restrict src3 = channel3.data + y * channel3.pitch;
-		const uint8_t * __restrict src4 = channel4.data + y * channel4.pitch;
-			  uint8_t * __restrict dst  = _dst + y * dstPitch;
-		
-		int begin = 0;
-		
-	#ifdef __SSE2__
-		/*
-		// without SSE
-			[II] Benchmark: interleave4: 0.000067 sec
-			[II] Benchmark: interleave4: 0.000069 sec
-			[II] Benchmark: interleave4: 0.000069 sec
-			[II] Benchmark: interleave4: 0.000069 sec
-
-		// with SSE
-			[II] Benchmark: interleave4: 0.000040 sec
-			[II] Benchmark: interleave4: 0.000044 sec
-			[II] Benchmark: interleave4: 0.000034 sec
-			[II] Benchmark: interleave4: 0.000034 sec
-		*/
-		const int sx_16 = sx / 16;
-		
-		const __m128i * __restrict src1_16 = (const __m128i*)src1;
-		const __m128i * __restrict src2_16 = (const __m128i*)src2;
-		const __m128i * __restrict src3_16 = (const __m128i*)src3;
-		const __m128i * __restrict src4_16 = (const __m128i*)src4;
-		__m128i * __restrict dst_4 = (__m128i*)dst;
-
-		for (int x = 0; x < sx_16; ++x)
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
+	{
+		for (int y = y1; y < y2; ++y)
 		{
-			const __m128i r_16 = _mm_loadu_si128(&src1_16[x]);
-			const __m128i g_16 = _mm_loadu_si128(&src2_16[x]);
-			const __m128i b_16 = _mm_loadu_si128(&src3_16[x]);
-			const __m128i a_16 = _mm_loadu_si128(&src4_16[x]);
+			const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
+				  uint8_t * __restrict dst  = _dst + y * dstPitch;
 			
-			const __m128i rg1_8 = _mm_unpacklo_epi8(r_16, g_16);
-			const __m128i rg2_8 = _mm_unpackhi_epi8(r_16, g_16);
-			const __m128i ba1_8 = _mm_unpacklo_epi8(b_16, a_16);
-			const __m128i ba2_8 = _mm_unpackhi_epi8(b_16, a_16);
+			memcpy(dst, src1, sx);
+		}
+	});
+}
+
+void VfxImageCpu::interleave3(const Channel & channel1, const Channel & channel2, const Channel & channel3, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
+{
+	const int dstPitch = _dstPitch == 0 ? sx * 3 : _dstPitch;
+	
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
+	{
+		for (int y = y1; y < y2; ++y)
+		{
+			const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
+			const uint8_t * __restrict src2 = channel2.data + y * channel2.pitch;
+			const uint8_t * __restrict src3 = channel3.data + y * channel3.pitch;
+				  uint8_t * __restrict dst  = _dst + y * dstPitch;
 			
-			const __m128i rgba1_16 = _mm_unpacklo_epi16(rg1_8, ba1_8);
-			const __m128i rgba2_16 = _mm_unpackhi_epi16(rg1_8, ba1_8);
-			const __m128i rgba3_16 = _mm_unpacklo_epi16(rg2_8, ba2_8);
-			const __m128i rgba4_16 = _mm_unpackhi_epi16(rg2_8, ba2_8);
+			const int begin = interleave3Row_SIMD(src1, src2, src3, dst, sx);
 			
-			_mm_storeu_si128(&dst_4[x * 4 + 0], rgba1_16);
-			_mm_storeu_si128(&dst_4[x * 4 + 1], rgba2_16);
-			_mm_storeu_si128(&dst_4[x * 4 + 2], rgba3_16);
-			_mm_storeu_si128(&dst_4[x * 4 + 3], rgba4_16);
+			for (int x = begin; x < sx; ++x)
+			{
+				dst[x * 3 + 0] = src1[x];
+				dst[x * 3 + 1] = src2[x];
+				dst[x * 3 + 2] = src3[x];
+			}
 		}
-		
-		begin = sx_16 * 16;
-	#endif
+	});
+}
+
+void VfxImageCpu::interleave4(const Channel & channel1, const Channel & channel2, const Channel & channel3, const Channel & channel4, uint8_t * _dst, const int _dstPitch, const int sx, const int sy)
+{
+	const int dstPitch = _dstPitch == 0 ? sx * 4 : _dstPitch;
 	
-		for (int x = begin; x < sx; ++x)
+	/*
+	// without SSE
+		[II] Benchmark: interleave4: 0.000067 sec
+		[II] Benchmark: interleave4: 0.000069 sec
+		[II] Benchmark: interleave4: 0.000069 sec
+		[II] Benchmark: interleave4: 0.000069 sec
+
+	// with SSE
+		[II] Benchmark: interleave4: 0.000040 sec
+		[II] Benchmark: interleave4: 0.000044 sec
+		[II] Benchmark: interleave4: 0.000034 sec
+		[II] Benchmark: interleave4: 0.000034 sec
+	*/
+	
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
+	{
+		for (int y = y1; y < y2; ++y)
 		{
-			dst[x * 4 + 0] = src1[x];
-			dst[x * 4 + 1] = src2[x];
-			dst[x * 4 + 2] = src3[x];
-			dst[x * 4 + 3] = src4[x];
+			const uint8_t * __restrict src1 = channel1.data + y * channel1.pitch;
+			const uint8_t * __restrict src2 = channel2.data + y * channel2.pitch;
+			const uint8_t * __restrict src3 = channel3.data + y * channel3.pitch;
+			const uint8_t * __restrict src4 = channel4.data + y * channel4.pitch;
+				  uint8_t * __restrict dst  = _dst + y * dstPitch;
+			
+			const int begin = interleave4Row_SIMD(src1, src2, src3, src4, dst, sx);
+			
+			for (int x = begin; x < sx; ++x)
+			{
+				dst[x * 4 + 0] = src1[x];
+				dst[x * 4 + 1] = src2[x];
+				dst[x * 4 + 2] = src3[x];
+				dst[x * 4 + 3] = src4[x];
+			}
 		}
-	}
+	});
 }
 
 void VfxImageCpu::deinterleave1(
@@ -308,21 +592,24 @@ void VfxImageCpu::deinterleave1(
 {
 	const int pitch = _pitch == 0 ? sx * 4 : _pitch;
 	
-	if (pitch == channel1.pitch)
-	{
-		memcpy((uint8_t*)channel1.data, src, sy * pitch);;
-	}
-	else
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
 	{
-		for (int y = 0; y < sy; ++y)
+		if (pitch == channel1.pitch)
 		{
-			const uint8_t * __restrict srcPtr = src + y * pitch + 0;
-			
-			uint8_t * __restrict dst = (uint8_t*)channel1.data + y * channel1.pitch;
-			
-			memcpy(dst, srcPtr, sx);
+			memcpy((uint8_t*)channel1.data + y1 * pitch, src + y1 * pitch, (y2 - y1) * pitch);
 		}
-	}
+		else
+		{
+			for (int y = y1; y < y2; ++y)
+			{
+				const uint8_t * __restrict srcPtr = src + y * pitch + 0;
+				
+				uint8_t * __restrict dst = (uint8_t*)channel1.data + y * channel1.pitch;
+				
+				memcpy(dst, srcPtr, sx);
+			}
+		}
+	});
 }
 
 void VfxImageCpu::deinterleave3(
@@ -331,23 +618,26 @@ void VfxImageCpu::deinterleave3(
 {
 	const int pitch = _pitch == 0 ? sx * 4 : _pitch;
 	
-	for (int y = 0; y < sy; ++y)
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
 	{
-		const uint8_t * __restrict srcPtr = src + y * pitch;
-		
-		uint8_t * __restrict dst1 = (uint8_t*)channel1.data + y * channel1.pitch;
-		uint8_t * __restrict dst2 = (uint8_t*)channel2.data + y * channel2.pitch;
-		uint8_t * __restrict dst3 = (uint8_t*)channel3.data + y * channel3.pitch;
-		
-		for (int x = 0; x < sx; ++x)
+		for (int y = y1; y < y2; ++y)
 		{
-			dst1[x] = srcPtr[0];
-			dst2[x] = srcPtr[1];
-			dst3[x] = srcPtr[2];
+			const uint8_t * __restrict srcPtr = src + y * pitch;
+			
+			uint8_t * __restrict dst1 = (uint8_t*)channel1.data + y * channel1.pitch;
+			uint8_t * __restrict dst2 = (uint8_t*)channel2.data + y * channel2.pitch;
+			uint8_t * __restrict dst3 = (uint8_t*)channel3.data + y * channel3.pitch;
+			
+			const int begin = deinterleave3Row_SIMD(srcPtr, dst1, dst2, dst3, sx);
 			
-			srcPtr += 3;
+			for (int x = begin; x < sx; ++x)
+			{
+				dst1[x] = srcPtr[x * 3 + 0];
+				dst2[x] = srcPtr[x * 3 + 1];
+				dst3[x] = srcPtr[x * 3 + 2];
+			}
 		}
-	}
+	});
 }
 
 void VfxImageCpu::deinterleave4(
@@ -356,73 +646,28 @@ void VfxImageCpu::deinterleave4(
 {
 	const int pitch = _pitch == 0 ? sx * 4 : _pitch;
 	
-	for (int y = 0; y < sy; ++y)
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
 	{
-		const uint8_t * __restrict srcPtr = src + y * pitch;
-		
-		uint8_t * __restrict dst1 = (uint8_t*)channel1.data + y * channel1.pitch;
-		uint8_t * __restrict dst2 = (uint8_t*)channel2.data + y * channel2.pitch;
-		uint8_t * __restrict dst3 = (uint8_t*)channel3.data + y * channel3.pitch;
-		uint8_t * __restrict dst4 = (uint8_t*)channel4.data + y * channel4.pitch;
-		
-		int begin = 0;
-		
-	#if defined(__SSSE3__) // SSSE3 due to _mm_shuffle_epi8
-		/*
-		without SSE:
-			[II] Benchmark: deinterleave4: 0.000278 sec
-			[II] Benchmark: deinterleave4: 0.000313 sec
-			[II] Benchmark: deinterleave4: 0.000359 sec
-		 
-		with SSE:
-			[II] Benchmark: deinterleave4: 0.000061 sec
-			[II] Benchmark: deinterleave4: 0.000069 sec
-			[II] Benchmark: deinterleave4: 0.000076 sec
-		*/
-		
-		const __m128i * __restrict src_4 = (__m128i*)srcPtr;
-		__m64 * __restrict dst1_8 = (__m64*)dst1;
-		__m64 * __restrict dst2_8 = (__m64*)dst2;
-		__m64 * __restrict dst3_8 = (__m64*)dst3;
-		__m64 * __restrict dst4_8 = (__m64*)dst4;
-		
-		const int sx_8 = sx / 8;
-		
-		for (int x = 0; x < sx_8; ++x)
+		for (int y = y1; y < y2; ++y)
 		{
-			__m128i rgba1 = _mm_loadu_si128(&src_4[x * 2 + 0]);
-			__m128i rgba2 = _mm_loadu_si128(&src_4[x * 2 + 1]);
-			__m128i shuffleIndices = _mm_set_epi8(
-				15, 11, 7, 3,
-				14, 10, 6, 2,
-				13, 9,  5, 1,
-				12, 8,  4, 0);
+			const uint8_t * __restrict srcPtr = src + y * pitch;
 			
-			rgba1 = _mm_shuffle_epi8(rgba1, shuffleIndices);
-			rgba2 = _mm_shuffle_epi8(rgba2, shuffleIndices);
+			uint8_t * __restrict dst1 = (uint8_t*)channel1.data + y * channel1.pitch;
+			uint8_t * __restrict dst2 = (uint8_t*)channel2.data + y * channel2.pitch;
+			uint8_t * __restrict dst3 = (uint8_t*)channel3.data + y * channel3.pitch;
+			uint8_t * __restrict dst4 = (uint8_t*)channel4.data + y * channel4.pitch;
 			
-			__m128i rg = _mm_unpacklo_epi32(rgba1, rgba2);
-			__m128i ba = _mm_unpackhi_epi32(rgba1, rgba2);
+			const int begin = deinterleave4Row_SIMD(srcPtr, dst1, dst2, dst3, dst4, sx);
 			
-      		_mm_storel_pi(&dst1_8[x], _mm_castsi128_ps(rg));
-      		_mm_storeh_pi(&dst2_8[x], _mm_castsi128_ps(rg));
-      		_mm_storel_pi(&dst3_8[x], _mm_castsi128_ps(ba));
-      		_mm_storeh_pi(&dst4_8[x], _mm_castsi128_ps(ba));
-		}
-		
-		begin = sx_8 * 8;
-	#elif defined(__SSE2__)
-		#warning "__SSE2__ defined but not __SSSE3__. deinterleave4 not optimized, but possibly could be?"
-	#endif
-	
-		for (int x = begin; x < sx; ++x)
-		{
-			dst1[x] = srcPtr[x * 4 + 0];
-			dst2[x] = srcPtr[x * 4 + 1];
-			dst3[x] = srcPtr[x * 4 + 2];
-			dst4[x] = srcPtr[x * 4 + 3];
+			for (int x = begin; x < sx; ++x)
+			{
+				dst1[x] = srcPtr[x * 4 + 0];
+				dst2[x] = srcPtr[x * 4 + 1];
+				dst3[x] = srcPtr[x * 4 + 2];
+				dst4[x] = srcPtr[x * 4 + 3];
+			}
 		}
-	}
+	});
 }
 
 //
@@ -430,6 +675,8 @@ void VfxImageCpu::deinterleave4(
 VfxImageCpuData::VfxImageCpuData()
 	: data(nullptr)
 	, image()
+	, buffer(nullptr)
+	, isShared(false)
 {
 }
 
@@ -449,7 +696,8 @@ void VfxImageCpuData::alloc(const int sx, const int sy, const int numChannels)
 		const int paddedSx = (sx + 15) & (~15);
 		const int pitch = paddedSx;
 		
-		data = (uint8_t*)MemAlloc(pitch * sy * numChannels, 16);
+		buffer = VfxBufferPool::getCurrent().alloc(pitch * sy * numChannels);
+		data = buffer->data;
 		
 		image.setDataContiguous(data, sx, sy, numChannels, 16, pitch);
 	}
@@ -457,7 +705,7 @@ void VfxImageCpuData::alloc(const int sx, const int sy, const int numChannels)
 
 void VfxImageCpuData::allocOnSizeChange(const int sx, const int sy, const int numChannels)
 {
-	if (image.sx != sx || image.sy != sy || image.numChannels != numChannels)
+	if (image.sx != sx || image.sy != sy || image.numChannels != numChannels || isShared)
 	{
 		alloc(sx, sy, numChannels);
 	}
@@ -465,7 +713,7 @@ void VfxImageCpuData::allocOnSizeChange(const int sx, const int sy, const int nu
 
 void VfxImageCpuData::allocOnSizeChange(const VfxImageCpu & reference)
 {
-	if (image.sx != reference.sx || image.sy != reference.sy || image.numChannels != reference.numChannels)
+	if (image.sx != reference.sx || image.sy != reference.sy || image.numChannels != reference.numChannels || isShared)
 	{
 		alloc(reference.sx, reference.sy, reference.numChannels);
 	}
@@ -473,12 +721,75 @@ void VfxImageCpuData::allocOnSizeChange(const VfxImageCpu & reference)
 
 void VfxImageCpuData::free()
 {
-	MemFree(data);
+	if (buffer != nullptr)
+	{
+		buffer->release();
+		buffer = nullptr;
+	}
+	
 	data = nullptr;
+	isShared = false;
 
 	image.reset();
 }
 
+bool VfxImageCpuData::share(const VfxImageCpu & _image)
+{
+	VfxBuffer * newBuffer = _image.numChannels == 0 ? nullptr : VfxBufferPool::getCurrent().retain(_image.channel[0].data);
+	
+	// all of the channels must live inside the same buffer
+	
+	if (newBuffer != nullptr)
+	{
+		for (int i = 1; i < _image.numChannels; ++i)
+		{
+			if (!newBuffer->contains(_image.channel[i].data))
+			{
+				newBuffer->release();
+				newBuffer = nullptr;
+				break;
+			}
+		}
+	}
+	
+	free();
+	
+	if (newBuffer == nullptr)
+		return false;
+	
+	buffer = newBuffer;
+	data = buffer->data;
+	isShared = true;
+	
+	image = _image;
+	
+	return true;
+}
+
+bool VfxImageCpuData::share(const VfxImageCpuData & other)
+{
+	if (&other == this)
+		return buffer != nullptr;
+	
+	VfxBuffer * newBuffer = other.buffer;
+	
+	if (newBuffer != nullptr)
+		newBuffer->retain();
+	
+	free();
+	
+	if (newBuffer == nullptr)
+		return false;
+	
+	buffer = newBuffer;
+	data = other.data;
+	isShared = true;
+	
+	image = other.image;
+	
+	return true;
+}
+
 //
 
 void VfxChannelData::alloc(const int _size)
@@ -487,14 +798,15 @@ void VfxChannelData::alloc(const int _size)
 	
 	if (_size > 0)
 	{
-		data = (float*)MemAlloc(_size * sizeof(float), 16);
+		buffer = VfxBufferPool::getCurrent().alloc(_size * sizeof(float));
+		data = (float*)buffer->data;
 		size = _size;
 	}
 }
 
 void VfxChannelData::allocOnSizeChange(const int _size)
 {
-	if (_size != size)
+	if (_size != size || isShared)
 	{
 		alloc(_size);
 	}
@@ -502,12 +814,35 @@ void VfxChannelData::allocOnSizeChange(const int _size)
 
 void VfxChannelData::free()
 {
-	MemFree(data);
+	if (buffer != nullptr)
+	{
+		buffer->release();
+		buffer = nullptr;
+	}
+	
 	data = nullptr;
+	isShared = false;
 	
 	size = 0;
 }
 
+bool VfxChannelData::share(const VfxChannel & channel)
+{
+	VfxBuffer * newBuffer = channel.size == 0 ? nullptr : VfxBufferPool::getCurrent().retain(channel.data);
+	
+	free();
+	
+	if (newBuffer == nullptr)
+		return false;
+	
+	buffer = newBuffer;
+	data = (float*)channel.data;
+	size = channel.size;
+	isShared = true;
+	
+	return true;
+}
+
 #include "Parse.h" // todo : move
 
 // todo : remove framework dependency
@@ -954,6 +1289,7 @@ VfxNodeBase::VfxNodeBase()
 	, editorIsTriggeredTick(-1)
 	, editorIssue()
 	, isPassthrough(false)
+	, isThreadSafe(false)
 #if ENABLE_VFXGRAPH_CPU_TIMING
 	, tickTimeAvg(0)
 	, drawTimeAvg(0)
@@ -987,6 +1323,23 @@ void VfxNodeBase::traverseTick(const int traversalId, const float dt)
 	
 	//
 	
+	handleTriggersAndTick(dt);
+	
+	afterTick(dt);
+}
+
+void VfxNodeBase::scheduledTick(const int traversalId, const float dt)
+{
+	Assert(lastTickTraversalId != traversalId);
+	lastTickTraversalId = traversalId;
+	
+	//
+	
+	handleTriggersAndTick(dt);
+}
+
+void VfxNodeBase::handleTriggersAndTick(const float dt)
+{
 	for (int i = 0; i < inputs.size(); ++i)
 	{
 		if (inputs[i].isTriggered)
@@ -46,6 +46,8 @@ class GxMesh;
 struct GxTexture;
 class Surface;
 
+struct VfxBuffer;
+struct VfxChannel;
 struct VfxTransform;
 
 //
@@ -169,12 +171,17 @@ struct VfxImageCpu
 
 //
 
+// memory for image and channel data is allocated from the buffer pool of the current graph. see VfxBufferPool
+
 struct VfxImageCpuData
 {
 	uint8_t * data;
 	
 	VfxImageCpu image;
 	
+	VfxBuffer * buffer;
+	bool isShared; // true when the buffer was retained through share. shared data must not be written to
+	
 	VfxImageCpuData();
 	~VfxImageCpuData();
 
@@ -182,6 +189,12 @@ struct VfxImageCpuData
 	void allocOnSizeChange(const int sx, const int sy, const int numChannels);
 	void allocOnSizeChange(const VfxImageCpu & reference);
 	void free();
+	
+	// retains the pooled buffer backing the image, so it remains valid for as long as this data is kept. returns false and frees the data when the image isn't backed by a pooled buffer
+	bool share(const VfxImageCpu & image);
+	
+	// retains the buffer of another image data, which may have been allocated from any buffer pool. returns false and frees the data when the other data doesn't own a pooled buffer
+	bool share(const VfxImageCpuData & imageData);
 };
 
 //
@@ -191,9 +204,14 @@ struct VfxChannelData
 	float * data;
 	int size;
 	
+	VfxBuffer * buffer;
+	bool isShared; // true when the buffer was retained through share. shared data must not be written to
+	
 	VfxChannelData()
 		: data(nullptr)
 		, size(0)
+		, buffer(nullptr)
+		, isShared(false)
 	{
 	}
 	
@@ -206,6 +224,9 @@ struct VfxChannelData
 	void allocOnSizeChange(const int size);
 	void free();
 	
+	// retains the pooled buffer backing the channel, so it remains valid for as long as this data is kept. returns false and frees the data when the channel isn't backed by a pooled buffer
+	bool share(const VfxChannel & channel);
+	
 	static bool parse(const char * text, float *& data, int & dataSize);
 };
 
@@ -517,6 +538,7 @@ struct VfxNodeBase
 	mutable std::string editorIssue;
 	
 	bool isPassthrough;
+	bool isThreadSafe; // when set, tick may run on a worker thread when the graph is ticked in parallel. work which must be done on the main thread, like uploading textures, should be done in afterTick
 	
 #if ENABLE_VFXGRAPH_CPU_TIMING
 	int tickTimeAvg;
@@ -536,6 +558,9 @@ struct VfxNodeBase
 	void traverseTick(const int traversalId, const float dt);
 	void traverseDraw(const int traversalId);
 	
+	void scheduledTick(const int traversalId, const float dt); // ticks the node without traversing predeps. used when the graph is ticked using its schedule. afterTick must be called separately, on the main thread
+	void handleTriggersAndTick(const float dt);
+	
 	void trigger(const int outputSocketIndex);
 	
 	// -- input and output sockets
@@ -725,6 +750,7 @@ struct VfxNodeBase
 	virtual void initSelf(const GraphNode & node) { }
 	virtual void init(const GraphNode & node) { }
 	virtual void tick(const float dt) { }
+	virtual void afterTick(const float dt) { } // always called on the main thread, after tick
 	virtual void handleTrigger(const int inputSocketIndex) { }
 	virtual void draw() const { }
 	virtual void beforeDraw() const { }
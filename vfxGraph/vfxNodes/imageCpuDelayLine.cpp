@@ -29,10 +29,23 @@
 
 #include "imageCpuDelayLine.h"
 #include "jpegLoader.h"
+#include "Log.h"
 #include "ofxJpegGlitch/ofxJpegGlitch.h"
 #include "vfxNodeBase.h"
+#include <algorithm>
 #include <SDL2/SDL.h>
 
+#if defined(WIN32)
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <Windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <unistd.h>
+#endif
+
 static void copyImage(const VfxImageCpu & image, VfxImageCpuData & imageData)
 {
 	imageData.allocOnSizeChange(image.sx, image.sy, image.numChannels);
@@ -52,6 +65,201 @@ static void copyImage(const VfxImageCpu & image, VfxImageCpuData & imageData)
 	}
 }
 
+static void shareOrCopyImage(const VfxImageCpuData & srcImageData, VfxImageCpuData & imageData)
+{
+	// note : history and decoded images are never written to after they're done, so we can hand out a reference to
+	//        their buffer rather than copying the image
+	
+	if (imageData.share(srcImageData) == false)
+	{
+		copyImage(srcImageData.image, imageData);
+	}
+}
+
+static bool decodeJpeg(const uint8_t * bytes, const int numBytes, const int numChannels, JpegLoadData & loadData, VfxImageCpuData & imageData)
+{
+	if (loadImage_turbojpeg(bytes, numBytes, loadData, numChannels == 1) == false)
+	{
+		return false;
+	}
+	else
+	{
+		if (numChannels == 1)
+		{
+			imageData.allocOnSizeChange(loadData.sx, loadData.sy, 1);
+			
+			VfxImageCpu::deinterleave1(
+				loadData.buffer,
+				loadData.sx,
+				loadData.sy,
+				1,
+				loadData.sx * 1,
+				imageData.image.channel[0]);
+		}
+		else
+		{
+			// deinterleave data
+			
+			imageData.allocOnSizeChange(loadData.sx, loadData.sy, 4);
+			
+			VfxImageCpu::deinterleave4(
+				loadData.buffer,
+				loadData.sx,
+				loadData.sy,
+				1,
+				loadData.sx * 4,
+				imageData.image.channel[0],
+				imageData.image.channel[1],
+				imageData.image.channel[2],
+				imageData.image.channel[3]);
+		}
+		
+		return true;
+	}
+}
+
+//
+
+// an append-only, memory mapped file, holding the JPEG data of history items moved to disk. segments are reference
+// counted by the JPEG data pointing into them, plus the delay line while it's appending to them
+
+struct ImageCpuDelayLine::DiskSegment
+{
+	uint8_t * address = nullptr;
+	int capacity = 0;
+	int size = 0;
+	
+	int refCount = 0;
+	
+#if defined(WIN32)
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = nullptr;
+#else
+	int fd = -1;
+#endif
+
+	bool create(const char * filename, const int _capacity)
+	{
+	#if defined(WIN32)
+		file = CreateFileA(filename, GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_TEMPORARY | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+		
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+		
+		// note : creating a mapping larger than the file grows the file to the size of the mapping
+		
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READWRITE, 0, (DWORD)_capacity, nullptr);
+		
+		if (mapping == nullptr)
+		{
+			destroy();
+			return false;
+		}
+		
+		address = (uint8_t*)MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, 0);
+		
+		if (address == nullptr)
+		{
+			destroy();
+			return false;
+		}
+	#else
+		fd = open(filename, O_RDWR | O_CREAT | O_EXCL, 0600);
+		
+		if (fd < 0)
+			return false;
+		
+		// note : the file is unlinked right away. it remains accessible through the file descriptor and the mapping,
+		//        and its disk space is reclaimed once these are closed, even when the app doesn't exit cleanly
+		
+		unlink(filename);
+		
+		// note : the mapping may extend past the end of the file. the part past the end becomes accessible as the
+		//        file grows, as writes to the file are visible through shared mappings
+		
+		void * result = mmap(nullptr, (size_t)_capacity, PROT_READ, MAP_SHARED, fd, 0);
+		
+		if (result == MAP_FAILED)
+		{
+			destroy();
+			return false;
+		}
+		
+		address = (uint8_t*)result;
+	#endif
+		
+		capacity = _capacity;
+		size = 0;
+		
+		return true;
+	}
+	
+	void destroy()
+	{
+	#if defined(WIN32)
+		if (address != nullptr)
+			UnmapViewOfFile(address);
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+		
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+	#else
+		if (address != nullptr)
+			munmap(address, (size_t)capacity);
+		if (fd >= 0)
+			close(fd);
+		
+		fd = -1;
+	#endif
+		
+		address = nullptr;
+		capacity = 0;
+		size = 0;
+	}
+	
+	// appends the bytes to the segment, and returns a pointer to where they're mapped, or nullptr when the segment
+	// is full or the write failed
+	
+	uint8_t * append(const void * bytes, const int numBytes)
+	{
+		if (numBytes > capacity - size)
+			return nullptr;
+		
+	#if defined(WIN32)
+		memcpy(address + size, bytes, numBytes);
+	#else
+		if (pwrite(fd, bytes, numBytes, size) != numBytes)
+			return nullptr;
+	#endif
+		
+		uint8_t * result = address + size;
+		
+		size += numBytes;
+		
+		return result;
+	}
+	
+	void retain()
+	{
+		refCount++;
+	}
+	
+	void release()
+	{
+		Assert(refCount > 0);
+		
+		if (--refCount == 0)
+		{
+			destroy();
+			
+			delete this;
+		}
+	}
+};
+
 //
 
 ImageCpuDelayLine::JpegData::JpegData()
@@ -60,12 +268,22 @@ ImageCpuDelayLine::JpegData::JpegData()
 	, sx(0)
 	, sy(0)
 	, numChannels(0)
+	, diskSegment(nullptr)
 {
 }
 
 ImageCpuDelayLine::JpegData::~JpegData()
 {
-	delete[] bytes;
+	if (diskSegment != nullptr)
+	{
+		diskSegment->release();
+		diskSegment = nullptr;
+	}
+	else
+	{
+		delete[] bytes;
+	}
+	
 	bytes = nullptr;
 	numBytes = 0;
 	
@@ -80,11 +298,17 @@ ImageCpuDelayLine::HistoryItem::HistoryItem()
 	: imageData(nullptr)
 	, jpegData(nullptr)
 	, timestamp(0.0)
+	, index(0)
+	, compressWork(nullptr)
+	, decodeWork(nullptr)
 {
 }
 
 ImageCpuDelayLine::HistoryItem::~HistoryItem()
 {
+	Assert(compressWork == nullptr);
+	Assert(decodeWork == nullptr);
+	
 	delete imageData;
 	imageData = nullptr;
 
@@ -97,45 +321,85 @@ ImageCpuDelayLine::HistoryItem::~HistoryItem()
 //
 
 ImageCpuDelayLine::WorkItem::WorkItem()
-	: imageData(nullptr)
-	, imageDataIsConsumed(true)
+	: type(kWorkType_Compress)
+	, historyItem(nullptr)
+	, index(0)
 	, jpegQualityLevel(0)
-	, timestamp(0.0)
+	, imageData(nullptr)
 	, jpegData(nullptr)
+	, isStarted(false)
 	, isDone(false)
 {
 }
 
 ImageCpuDelayLine::WorkItem::~WorkItem()
 {
-	isDone = false;
-	
-	delete jpegData;
-	jpegData = nullptr;
-	
-	jpegQualityLevel = 0;
+	Assert(historyItem == nullptr);
+	Assert(imageData == nullptr);
+	Assert(jpegData == nullptr);
+}
+
+//
+
+ImageCpuDelayLine::Worker::Worker()
+	: delayLine(nullptr)
+	, thread(nullptr)
+	, saveBuffer(nullptr)
+	, interleaveBuffer()
+	, loadData(nullptr)
+	, numLoadDataBytes(0)
+{
+}
+
+ImageCpuDelayLine::Worker::~Worker()
+{
+	Assert(thread == nullptr);
 	
-	imageDataIsConsumed = true;
+	delete[] saveBuffer;
+	saveBuffer = nullptr;
 	
-	delete imageData;
-	imageData = nullptr;
+	delete loadData;
+	loadData = nullptr;
+}
+
+//
+
+ImageCpuDelayLine::Stats::Stats()
+	: numCacheHits(0)
+	, numCacheMisses(0)
+	, numCompressStalls(0)
+{
 }
 
 //
 
 ImageCpuDelayLine::ImageCpuDelayLine()
-	: saveBuffer(nullptr)
-	, saveBufferSize(0)
+	: saveBufferSize(0)
 	, history()
 	, maxHistorySize(0)
 	, historySize(0)
+	, nextIndex(0)
+	, decodedImages()
+	, maxDecodedImages(0)
+	, numPrefetchImages(0)
+	, tickIndex(0)
+	, workers()
 	, work()
+	, numCompressWorkInProgress(0)
+	, numDecodeWorkInProgress(0)
 	, stop(false)
 	, workEvent(nullptr)
 	, doneEvent(nullptr)
 	, mutex(nullptr)
-	, thread(nullptr)
 	, cachedLoadData(nullptr)
+	, glitchBuffer()
+	, diskStoragePath()
+	, hotWindowSize(0)
+	, diskSegmentSize(0)
+	, diskSegment(nullptr)
+	, nextDiskSegmentId(0)
+	, nextSpillIndex(0)
+	, stats()
 {
 }
 
@@ -144,14 +408,12 @@ ImageCpuDelayLine::~ImageCpuDelayLine()
 	shut();
 }
 
-void ImageCpuDelayLine::init(const int _maxHistorySize, const int _saveBufferSize)
+void ImageCpuDelayLine::init(const int _maxHistorySize, const int _saveBufferSize, const int _numThreads)
 {
 	shut();
 
 	//
 	
-	Assert(saveBuffer == nullptr);
-	saveBuffer = new uint8_t[_saveBufferSize];
 	saveBufferSize = _saveBufferSize;
 	
 	Assert(history.empty());
@@ -162,12 +424,16 @@ void ImageCpuDelayLine::init(const int _maxHistorySize, const int _saveBufferSiz
 	Assert(historySize == 0);
 	historySize = 0;
 	
-	Assert(work.imageData == nullptr);
-	Assert(work.imageDataIsConsumed);
-	Assert(work.jpegQualityLevel == 0);
-	Assert(work.jpegData == nullptr);
-	Assert(work.isDone == false);
-	work = WorkItem();
+	// note : the decoded image cache should be able to hold the images for the four outputs of the delay line node,
+	//        plus the images being prefetched for them
+	
+	Assert(decodedImages.empty());
+	numPrefetchImages = 1;
+	maxDecodedImages = 4 * (1 + numPrefetchImages);
+	
+	Assert(work.empty());
+	Assert(numCompressWorkInProgress == 0);
+	Assert(numDecodeWorkInProgress == 0);
 	
 	Assert(stop == false);
 	stop = false;
@@ -180,9 +446,6 @@ void ImageCpuDelayLine::init(const int _maxHistorySize, const int _saveBufferSiz
 
 	Assert(mutex == nullptr);
 	mutex = SDL_CreateMutex();
-
-	Assert(thread == nullptr);
-	thread = SDL_CreateThread(threadProc, "ImageCpuDelayCompress", this);
 	
 	Assert(cachedLoadData == nullptr);
 	cachedLoadData = new JpegLoadData();
@@ -190,35 +453,66 @@ void ImageCpuDelayLine::init(const int _maxHistorySize, const int _saveBufferSiz
 	Assert(workEvent != nullptr);
 	Assert(doneEvent != nullptr);
 	Assert(mutex != nullptr);
-	Assert(thread != nullptr);
+	
+	const int numThreads = _numThreads > 0 ? _numThreads : std::max(1, std::min(4, SDL_GetCPUCount() - 1));
+	
+	Assert(workers.empty());
+	
+	for (int i = 0; i < numThreads; ++i)
+	{
+		Worker * worker = new Worker();
+		worker->delayLine = this;
+		worker->saveBuffer = new uint8_t[saveBufferSize];
+		worker->loadData = new JpegLoadData();
+		
+		worker->thread = SDL_CreateThread(threadProc, "ImageCpuDelayWorker", worker);
+		Assert(worker->thread != nullptr);
+		
+		workers.push_back(worker);
+	}
 }
 
 void ImageCpuDelayLine::shut()
 {
-	if (mutex != nullptr)
+	// finish all of the work in progress
+	
+	while (!work.empty())
 	{
-		compressWait();
+		waitForWork(work.front());
+		
+		reapWork();
 	}
 	
-	delete cachedLoadData;
-	cachedLoadData = nullptr;
+	Assert(numCompressWorkInProgress == 0);
+	Assert(numDecodeWorkInProgress == 0);
 	
-	if (thread != nullptr)
+	if (!workers.empty())
 	{
 		Verify(SDL_LockMutex(mutex) == 0);
 		{
 			stop = true;
 			
-			Verify(SDL_CondSignal(workEvent) == 0);
+			Verify(SDL_CondBroadcast(workEvent) == 0);
 		}
 		Verify(SDL_UnlockMutex(mutex) == 0);
-
-		SDL_WaitThread(thread, nullptr);
-		thread = nullptr;
+		
+		for (auto *& worker : workers)
+		{
+			SDL_WaitThread(worker->thread, nullptr);
+			worker->thread = nullptr;
+			
+			delete worker;
+			worker = nullptr;
+		}
+		
+		workers.clear();
 		
 		stop = false;
 	}
 	
+	delete cachedLoadData;
+	cachedLoadData = nullptr;
+	
 	if (mutex != nullptr)
 	{
 		SDL_DestroyMutex(mutex);
@@ -237,33 +531,71 @@ void ImageCpuDelayLine::shut()
 		workEvent = nullptr;
 	}
 	
-	Assert(work.imageData == nullptr);
-	Assert(work.imageDataIsConsumed);
-	Assert(work.jpegQualityLevel == 0);
-	Assert(work.jpegData == nullptr);
-	Assert(work.isDone == false);
-	work = WorkItem();
-
-	while (!history.empty())
+	clearHistory();
+	
+	if (diskSegment != nullptr)
 	{
-		HistoryItem * item = history.back();
-		delete item;
-		item = nullptr;
-
-		history.pop_back();
+		diskSegment->release();
+		diskSegment = nullptr;
 	}
+	
+	diskStoragePath.clear();
+	hotWindowSize = 0;
+	diskSegmentSize = 0;
+	nextSpillIndex = 0;
+	
+	Assert(decodedImages.empty());
+	maxDecodedImages = 0;
+	numPrefetchImages = 0;
 
-	historySize = 0;
 	maxHistorySize = 0;
 	
-	delete[] saveBuffer;
-	saveBuffer = nullptr;
 	saveBufferSize = 0;
+	
+	glitchBuffer.clear();
+	glitchBuffer.shrink_to_fit();
+}
+
+bool ImageCpuDelayLine::initDiskStorage(const char * path, const int _hotWindowSize, const int segmentSize)
+{
+	Assert(mutex != nullptr);
+	Assert(diskStoragePath.empty());
+	
+	if (path == nullptr || path[0] == 0 || segmentSize <= 0)
+	{
+		return false;
+	}
+	
+	diskStoragePath = path;
+	hotWindowSize = std::max(0, _hotWindowSize);
+	diskSegmentSize = segmentSize;
+	
+	// create the first segment now, so we can report failure to the caller right away
+	
+	if (newDiskSegment() == false)
+	{
+		diskStoragePath.clear();
+		hotWindowSize = 0;
+		diskSegmentSize = 0;
+		
+		return false;
+	}
+	
+	return true;
 }
 
 void ImageCpuDelayLine::tick()
 {
-	compressWait();
+	tickIndex++;
+	
+	if (mutex != nullptr)
+	{
+		reapWork();
+	}
+	
+	trimDecodedImages();
+	
+	spillHistory();
 }
 
 int ImageCpuDelayLine::getLength() const
@@ -273,65 +605,82 @@ int ImageCpuDelayLine::getLength() const
 
 void ImageCpuDelayLine::setLength(const int length)
 {
-	compressWait();
-	
-	//
-	
 	maxHistorySize = length;
 	
 	while (historySize > maxHistorySize)
 	{
-		HistoryItem * item = history.back();
-		delete item;
-		item = nullptr;
-
-		history.pop_back();
-		
-		historySize--;
+		removeOldestHistoryItem();
 	}
 }
 
 void ImageCpuDelayLine::add(const VfxImageCpu & image, const int jpegQualityLevel, const double timestamp, const bool useCompression)
 {
-	// note : compressWait may add to the history. we need to wait here before we add another item
+	if (maxHistorySize <= 0)
+	{
+		return;
+	}
 	
-	compressWait();
+	reapWork();
 	
 	// note : turbojpeg doesn't like it when we try to compress a 0x0 sized image. just use the non-compressed
 	//        code path to avoid issues
 	
-	if (useCompression && (image.sx > 0 && image.sy > 0))
-	{
-		compressWork(image, jpegQualityLevel, timestamp);
-	}
-	else
+	const bool compress = useCompression && (image.sx > 0 && image.sy > 0) && !workers.empty();
+	
+	if (compress)
 	{
-		HistoryItem * historyItem = nullptr;
+		// limit the number of uncompressed images waiting to be compressed. when the workers can't keep up, this is
+		// where we wait for them
 		
-		if (historySize == maxHistorySize)
-		{
-			historyItem = history.back();
-
-			history.pop_back();
-		}
-		else
+		const int maxCompressWorkInProgress = workers.size() * 2;
+		
+		if (numCompressWorkInProgress >= maxCompressWorkInProgress)
 		{
-			historySize++;
+			stats.numCompressStalls++;
+			
+			for (auto * workItem : work)
+			{
+				if (workItem->type == kWorkType_Compress)
+				{
+					waitForWork(workItem);
+					break;
+				}
+			}
 			
-			historyItem = new HistoryItem();
+			reapWork();
 		}
+	}
+	
+	if (historySize == maxHistorySize)
+	{
+		removeOldestHistoryItem();
+	}
+	
+	HistoryItem * historyItem = new HistoryItem();
+	historyItem->imageData = new VfxImageCpuData();
+	historyItem->timestamp = timestamp;
+	historyItem->index = nextIndex++;
+	
+	copyImage(image, *historyItem->imageData);
+	
+	history.push_front(historyItem);
+	historySize++;
+	
+	if (compress)
+	{
+		WorkItem * workItem = new WorkItem();
+		workItem->type = kWorkType_Compress;
+		workItem->historyItem = historyItem;
+		workItem->index = historyItem->index;
+		workItem->jpegQualityLevel = jpegQualityLevel;
+		workItem->imageData = historyItem->imageData;
 		
-		delete historyItem->jpegData;
-		historyItem->jpegData = nullptr;
-		
-		if (historyItem->imageData == nullptr)
-			historyItem->imageData = new VfxImageCpuData();
-		
-		copyImage(image, *historyItem->imageData);
-		historyItem->timestamp = timestamp;
+		historyItem->compressWork = workItem;
 		
-		history.push_front(historyItem);
+		submitWork(workItem);
 	}
+	
+	spillHistory();
 }
 
 bool ImageCpuDelayLine::decode(const JpegData & jpegData, VfxImageCpuData & imageData, const bool glitch, const float glitchiness)
@@ -340,74 +689,28 @@ bool ImageCpuDelayLine::decode(const JpegData & jpegData, VfxImageCpuData & imag
 	{
 		return false;
 	}
-	else
+	else if (glitch && glitchiness > 0.f)
 	{
-		// decode JPEG data
+		// note : the glitch is applied to a copy of the JPEG data, as the history may be decoded by the worker threads
+		//        at the same time
 		
-		if (glitch && glitchiness > 0.f)
-		{
-			ofxJpegGlitch glitch;
-			ofBuffer buffer(jpegData.bytes, jpegData.numBytes);
-			glitch.setJpegBuffer(buffer);
-			glitch.setDataGlitchness(0);
-			glitch.setDHTGlitchness(0);
-			//glitch.setQNGlitchness(0);
-			glitch.setQNGlitchness(glitchiness * ofxJpegGlitch::kMaxGlitchiness);
-			glitch.glitch();
-		}
+		glitchBuffer.resize(jpegData.numBytes);
+		memcpy(glitchBuffer.data(), jpegData.bytes, jpegData.numBytes);
 		
-	#if 0
-		imageData.allocOnSizeChange(jpegData.sx, jpegData.sy, jpegData.numChannels, true);
-		const int numImageDataBytes = imageData.image.sy * imageData.image.channel[0].pitch;
+		ofxJpegGlitch glitch;
+		ofBuffer buffer(glitchBuffer.data(), glitchBuffer.size());
+		glitch.setJpegBuffer(buffer);
+		glitch.setDataGlitchness(0);
+		glitch.setDHTGlitchness(0);
+		//glitch.setQNGlitchness(0);
+		glitch.setQNGlitchness(glitchiness * ofxJpegGlitch::kMaxGlitchiness);
+		glitch.glitch();
 		
-		if (loadImage_turbojpeg(jpegData.bytes, jpegData.numBytes, imageData.data, numImageDataBytes, jpegData.numChannels == 1) == false)
-		{
-			return false;
-		}
-		else
-		{
-			return true;
-		}
-	#else
-		if (loadImage_turbojpeg(jpegData.bytes, jpegData.numBytes, *cachedLoadData, jpegData.numChannels == 1) == false)
-		{
-			return false;
-		}
-		else
-		{
-			if (jpegData.numChannels == 1)
-			{
-				imageData.allocOnSizeChange(cachedLoadData->sx, cachedLoadData->sy, 1);
-				
-				VfxImageCpu::deinterleave1(
-					cachedLoadData->buffer,
-					cachedLoadData->sx,
-					cachedLoadData->sy,
-					1,
-					cachedLoadData->sx * 1,
-					imageData.image.channel[0]);
-			}
-			else
-			{
-				// deinterleave data
-				
-				imageData.allocOnSizeChange(cachedLoadData->sx, cachedLoadData->sy, 4);
-				
-				VfxImageCpu::deinterleave4(
-					cachedLoadData->buffer,
-					cachedLoadData->sx,
-					cachedLoadData->sy,
-					1,
-					cachedLoadData->sx * 4,
-					imageData.image.channel[0],
-					imageData.image.channel[1],
-					imageData.image.channel[2],
-					imageData.image.channel[3]);
-			}
-			
-			return true;
-		}
-	#endif
+		return decodeJpeg(glitchBuffer.data(), glitchBuffer.size(), jpegData.numChannels, *cachedLoadData, imageData);
+	}
+	else
+	{
+		return decodeJpeg(jpegData.bytes, jpegData.numBytes, jpegData.numChannels, *cachedLoadData, imageData);
 	}
 }
 
@@ -417,21 +720,21 @@ bool ImageCpuDelayLine::get(const int offset, VfxImageCpuData & imageData, doubl
 	{
 		HistoryItem * item = history[offset];
 		
-		if (item->jpegData != nullptr)
+		if (imageTimestamp != nullptr)
 		{
-			if (imageTimestamp != nullptr)
-			{
-				*imageTimestamp = item->timestamp;
-			}
-			
-			return decode(*item->jpegData, imageData, glitch, glitchiness);
+			*imageTimestamp = item->timestamp;
 		}
-		else
+		
+		const bool result = getItem(*item, imageData, glitch, glitchiness);
+		
+		// glitched images are decoded each time, so there's no use in decoding ahead
+		
+		if (glitch == false || glitchiness <= 0.f)
 		{
-			copyImage(item->imageData->image, imageData);
-			
-			return true;
+			prefetch(offset);
 		}
+		
+		return result;
 	}
 	else
 	{
@@ -441,15 +744,12 @@ bool ImageCpuDelayLine::get(const int offset, VfxImageCpuData & imageData, doubl
 
 bool ImageCpuDelayLine::getByTimestamp(const double timestamp, VfxImageCpuData & imageData, double * imageTimestamp, const bool glitch, const float glitchiness)
 {
-	HistoryItem * item = nullptr;
+	// note : the history is ordered from newest to oldest. find the newest item which is older than the timestamp.
+	//        the item before it is the oldest item at or after the timestamp
 	
-	for (auto & h : history)
-	{
-		if (h->timestamp < timestamp)
-			break;
-		
-		item = h;
-	}
+	auto older = std::partition_point(history.begin(), history.end(), [&](const HistoryItem * h) { return h->timestamp >= timestamp; });
+	
+	HistoryItem * item = older == history.begin() ? nullptr : *(older - 1);
 	
 	if (item != nullptr)
 	{
@@ -458,16 +758,7 @@ bool ImageCpuDelayLine::getByTimestamp(const double timestamp, VfxImageCpuData &
 			*imageTimestamp = item->timestamp;
 		}
 		
-		if (item->jpegData != nullptr)
-		{
-			return decode(*item->jpegData, imageData, glitch, glitchiness);
-		}
-		else
-		{
-			copyImage(item->imageData->image, imageData);
-			
-			return true;
-		}
+		return getItem(*item, imageData, glitch, glitchiness);
 	}
 	else
 	{
@@ -479,14 +770,10 @@ void ImageCpuDelayLine::clearHistory()
 {
 	while (!history.empty())
 	{
-		HistoryItem * item = history.back();
-		delete item;
-		item = nullptr;
-
-		history.pop_back();
+		removeOldestHistoryItem();
 	}
 	
-	historySize = 0;
+	Assert(historySize == 0);
 }
 
 ImageCpuDelayLine::MemoryUsage ImageCpuDelayLine::getMemoryUsage() const
@@ -495,15 +782,34 @@ ImageCpuDelayLine::MemoryUsage ImageCpuDelayLine::getMemoryUsage() const
 	
 	{
 		result.numHistoryBytes = 0;
+		result.numCompressedBytes = 0;
+		result.numDiskBytes = 0;
+		result.numDiskImages = 0;
 		
 		for (auto & h : history)
 		{
-			if (h->jpegData != nullptr)
-				result.numHistoryBytes += h->jpegData->numBytes;
+			if (h->jpegData != nullptr && h->jpegData->diskSegment != nullptr)
+			{
+				result.numDiskBytes += h->jpegData->numBytes;
+				result.numDiskImages++;
+			}
+			else if (h->jpegData != nullptr)
+				result.numCompressedBytes += h->jpegData->numBytes;
 			if (h->imageData != nullptr)
 				result.numHistoryBytes += h->imageData->image.getMemoryUsage();
 		}
 		
+		result.numHistoryBytes += result.numCompressedBytes;
+		
+		//
+		
+		result.numDecodedBytes = 0;
+		
+		for (auto & d : decodedImages)
+			result.numDecodedBytes += d.second.imageData->image.getMemoryUsage();
+		
+		result.numDecodedImages = decodedImages.size();
+		
 		//
 		
 		result.numCachedImageBytes = 0;
@@ -517,45 +823,39 @@ ImageCpuDelayLine::MemoryUsage ImageCpuDelayLine::getMemoryUsage() const
 		
 		result.numSaveBufferBytes = 0;
 		
-		result.numSaveBufferBytes += saveBufferSize;
+		result.numSaveBufferBytes += saveBufferSize * workers.size();
+		
+		//
+		
+		result.historySize = historySize;
 	}
 	
 	if (mutex != nullptr)
 	{
 		Verify(SDL_LockMutex(mutex) == 0);
 		{
-			if (work.imageDataIsConsumed == false)
+			for (auto * worker : workers)
 			{
-				result.numSaveBufferBytes += work.imageData->image.getMemoryUsage();
+				result.numCachedImageBytes += worker->numLoadDataBytes + worker->interleaveBuffer.capacity();
 			}
-			
-			if (work.jpegData != nullptr)
-			{
-				result.numSaveBufferBytes += work.jpegData->numBytes;
-			}
-			
-			//
-			
-			result.historySize = historySize;
 		}
 		Verify(SDL_UnlockMutex(mutex) == 0);
 	}
 	
 	result.numBytes =
 		result.numHistoryBytes +
+		result.numDecodedBytes +
 		result.numCachedImageBytes +
 		result.numSaveBufferBytes;
 	
 	return result;
 }
 
-ImageCpuDelayLine::JpegData * ImageCpuDelayLine::compress(const VfxImageCpu & image, const int jpegQualityLevel)
+ImageCpuDelayLine::JpegData * ImageCpuDelayLine::compress(const VfxImageCpu & image, const int jpegQualityLevel, uint8_t * saveBuffer, const int saveBufferSize, std::vector<uint8_t> & temp)
 {
 	const void * srcBuffer = nullptr;
 	int srcBufferSize = 0;
 	
-	std::vector<uint8_t> temp;
-	
 	if (image.numChannels == 1)
 	{
 		// note : avoid temp alloc and copy if pitch allows it
@@ -577,7 +877,7 @@ ImageCpuDelayLine::JpegData * ImageCpuDelayLine::compress(const VfxImageCpu & im
 				image.sx, image.sy);
 			
 			srcBuffer = (image.sx > 0 && image.sy > 0) ? &temp[0] : nullptr;
-			srcBufferSize = temp.size();
+			srcBufferSize = image.sx * image.sy * 1;
 		}
 	}
 	else
@@ -593,7 +893,7 @@ ImageCpuDelayLine::JpegData * ImageCpuDelayLine::compress(const VfxImageCpu & im
 			image.sx, image.sy);
 		
 		srcBuffer = (image.sx > 0 && image.sy > 0) ? &temp[0] : nullptr;
-		srcBufferSize = temp.size();
+		srcBufferSize = image.sx * image.sy * 4;
 	}
 	
 	const int srcSx = image.sx;
@@ -624,170 +924,498 @@ ImageCpuDelayLine::JpegData * ImageCpuDelayLine::compress(const VfxImageCpu & im
 
 int ImageCpuDelayLine::threadProc(void * arg)
 {
-	ImageCpuDelayLine * self = (ImageCpuDelayLine*)arg;
+	Worker * worker = (Worker*)arg;
 
-	self->threadMain();
+	worker->delayLine->threadMain(*worker);
 	
 	return 0;
 }
 
-void ImageCpuDelayLine::threadMain()
+void ImageCpuDelayLine::threadMain(Worker & worker)
 {
 	Verify(SDL_LockMutex(mutex) == 0);
 
 	for (;;)
 	{
-		Verify(SDL_CondWait(workEvent, mutex) == 0);
+		// pick the oldest work item which hasn't been started yet. compression goes first, since the main thread
+		// will stall when too many images are waiting to be compressed
+		
+		WorkItem * workItem = nullptr;
 		
-		// note : we check explicitly for all of the conditions here, because they may not all be satistfied!
-		//        there is a peculiarity when using the debugger on macOS, where when the app is paused and
-		//        then resumed, the SDL_CondSignal call succeeds, without the main thread explicitly setting the event
+		for (auto * w : work)
+		{
+			if (w->isStarted == false && (workItem == nullptr || (w->type == kWorkType_Compress && workItem->type != kWorkType_Compress)))
+			{
+				workItem = w;
+				
+				if (w->type == kWorkType_Compress)
+					break;
+			}
+		}
 		
 		if (stop)
 		{
-			delete work.imageData;
-			
-			Verify(SDL_CondSignal(doneEvent) == 0);
-			
 			break;
 		}
 		
-		if (work.imageData != nullptr)
+		if (workItem == nullptr)
 		{
-			VfxImageCpuData * imageData = work.imageData;
-			const int jpegQualityLevel = work.jpegQualityLevel;
-		
-			JpegData * jpegData = nullptr;
+			// note : we check explicitly for work and the stop condition each time we wake up. there is a peculiarity
+			//        when using the debugger on macOS, where when the app is paused and then resumed, the SDL_CondSignal
+			//        call succeeds, without the main thread explicitly setting the event
 			
-			work.imageDataIsConsumed = true;
+			Verify(SDL_CondWait(workEvent, mutex) == 0);
 			
-			Verify(SDL_UnlockMutex(mutex) == 0);
+			continue;
+		}
+		
+		workItem->isStarted = true;
+		
+		Verify(SDL_UnlockMutex(mutex) == 0);
+		{
+			if (workItem->type == kWorkType_Compress)
 			{
-				if (stop == false)
-				{
-					jpegData = compress(imageData->image, jpegQualityLevel);
-				}
-
-				delete imageData;
-				//imageData = nullptr; // not set to nullptr, so we can validate the pointer later, to check work.imageData was left untouched
+				workItem->jpegData = compress(workItem->imageData->image, workItem->jpegQualityLevel, worker.saveBuffer, saveBufferSize, worker.interleaveBuffer);
 			}
-			Verify(SDL_LockMutex(mutex) == 0);
-			
-			// store the result
-			if (jpegData != nullptr)
+			else
 			{
-				Assert(work.jpegData == nullptr);
-				work.jpegData = jpegData;
+				const JpegData & jpegData = *workItem->jpegData;
+				
+				VfxImageCpuData * imageData = new VfxImageCpuData();
+				
+				if (decodeJpeg(jpegData.bytes, jpegData.numBytes, jpegData.numChannels, *worker.loadData, *imageData))
+				{
+					workItem->imageData = imageData;
+				}
+				else
+				{
+					delete imageData;
+					imageData = nullptr;
+				}
 			}
-			
-			// check if these work members were left untouched
-			Assert(work.imageData == imageData);
-			Assert(work.imageDataIsConsumed);
-			Assert(work.jpegQualityLevel == jpegQualityLevel);
-			Assert(work.isDone == false);
-			
-			// tell the main thread we're done
-			work.isDone = true;
-			
-			Verify(SDL_CondSignal(doneEvent) == 0);
 		}
+		Verify(SDL_LockMutex(mutex) == 0);
+		
+		worker.numLoadDataBytes = worker.loadData->bufferSize;
+		
+		// tell the main thread we're done
+		
+		workItem->isDone = true;
+		
+		Verify(SDL_CondBroadcast(doneEvent) == 0);
 	}
 
 	Verify(SDL_UnlockMutex(mutex) == 0);
 }
 
-void ImageCpuDelayLine::compressWork(const VfxImageCpu & image, const int jpegQualityLevel, const double timestamp)
+bool ImageCpuDelayLine::getItem(HistoryItem & item, VfxImageCpuData & imageData, const bool glitch, const float glitchiness)
 {
-	// make a copy of the image
+	if (item.jpegData == nullptr)
+	{
+		// the item is stored uncompressed, or its compression hasn't finished yet
+		
+		shareOrCopyImage(*item.imageData, imageData);
+		
+		return true;
+	}
 	
-	VfxImageCpuData * imageData = new VfxImageCpuData();
-	copyImage(image, *imageData);
+	if (glitch && glitchiness > 0.f)
+	{
+		return decode(*item.jpegData, imageData, glitch, glitchiness);
+	}
 	
-	// kick the compression thread
+	// decode the item, unless it's already decoded or being decoded
 	
-	Verify(SDL_LockMutex(mutex) == 0);
+	auto i = decodedImages.find(item.index);
+	
+	if (i == decodedImages.end() && item.decodeWork != nullptr)
+	{
+		waitForWork(item.decodeWork);
+		
+		reapWork();
+		
+		i = decodedImages.find(item.index);
+	}
+	
+	if (i == decodedImages.end())
 	{
-		Assert(work.imageData == nullptr);
-		Assert(work.imageDataIsConsumed);
-		Assert(work.jpegQualityLevel == 0);
-		Assert(work.timestamp == 0.0);
-		Assert(work.isDone == false);
+		VfxImageCpuData * decodedImageData = new VfxImageCpuData();
+		
+		if (decode(*item.jpegData, *decodedImageData, false, 0.f) == false)
+		{
+			delete decodedImageData;
+			decodedImageData = nullptr;
+			
+			return false;
+		}
 		
-		work.imageData = imageData;
-		work.imageDataIsConsumed = false;
-		work.jpegQualityLevel = jpegQualityLevel;
-		work.timestamp = timestamp;
-		work.isDone = false;
+		stats.numCacheMisses++;
+		
+		DecodedItem decodedItem;
+		decodedItem.imageData = decodedImageData;
+		decodedItem.lastUsedTick = tickIndex;
+		
+		i = decodedImages.insert(std::make_pair(item.index, decodedItem)).first;
+	}
+	else
+	{
+		stats.numCacheHits++;
+	}
+	
+	i->second.lastUsedTick = tickIndex;
+	
+	shareOrCopyImage(*i->second.imageData, imageData);
+	
+	return true;
+}
+
+void ImageCpuDelayLine::prefetch(const int offset)
+{
+	// note : each time an image is added, the item at offset - 1 moves to offset. decode the item(s) which will be
+	//        requested next, assuming the same offset will be requested again
+	
+	const int maxDecodeWorkInProgress = workers.size() * 2;
+	
+	for (int i = 1; i <= numPrefetchImages && offset - i >= 0; ++i)
+	{
+		if (numDecodeWorkInProgress >= maxDecodeWorkInProgress)
+			break;
+		
+		HistoryItem * item = history[offset - i];
+		
+		if (item->jpegData == nullptr || item->decodeWork != nullptr)
+			continue;
+		
+		auto decodedItem = decodedImages.find(item->index);
+		
+		if (decodedItem != decodedImages.end())
+		{
+			// keep the image around until it's needed
+			
+			decodedItem->second.lastUsedTick = tickIndex;
+			continue;
+		}
+		
+		WorkItem * workItem = new WorkItem();
+		workItem->type = kWorkType_Decode;
+		workItem->historyItem = item;
+		workItem->index = item->index;
+		workItem->jpegData = item->jpegData;
+		
+		item->decodeWork = workItem;
+		
+		submitWork(workItem);
+	}
+}
+
+void ImageCpuDelayLine::removeOldestHistoryItem()
+{
+	HistoryItem * item = history.back();
+	
+	// when work is still in progress, the work item takes ownership of the data it's working on
+	
+	if (item->compressWork != nullptr)
+	{
+		Assert(item->compressWork->imageData == item->imageData);
+		item->compressWork->historyItem = nullptr;
+		item->compressWork = nullptr;
+		item->imageData = nullptr;
+	}
+	
+	if (item->decodeWork != nullptr)
+	{
+		Assert(item->decodeWork->jpegData == item->jpegData);
+		item->decodeWork->historyItem = nullptr;
+		item->decodeWork = nullptr;
+		item->jpegData = nullptr;
+	}
+	
+	auto decodedItem = decodedImages.find(item->index);
+	
+	if (decodedItem != decodedImages.end())
+	{
+		delete decodedItem->second.imageData;
+		decodedItem->second.imageData = nullptr;
+		
+		decodedImages.erase(decodedItem);
+	}
+	
+	delete item;
+	item = nullptr;
+
+	history.pop_back();
+	
+	historySize--;
+}
+
+void ImageCpuDelayLine::submitWork(WorkItem * workItem)
+{
+	if (workItem->type == kWorkType_Compress)
+		numCompressWorkInProgress++;
+	else
+		numDecodeWorkInProgress++;
+	
+	Verify(SDL_LockMutex(mutex) == 0);
+	{
+		work.push_back(workItem);
 		
 		Verify(SDL_CondSignal(workEvent) == 0);
 	}
 	Verify(SDL_UnlockMutex(mutex) == 0);
 }
 
-void ImageCpuDelayLine::compressWait()
+void ImageCpuDelayLine::waitForWork(WorkItem * workItem)
 {
-	JpegData * jpegData = nullptr;
-	double timestamp = 0.0;
-	
 	Verify(SDL_LockMutex(mutex) == 0);
 	{
-		if (work.imageData != nullptr)
+		while (workItem->isDone == false)
+		{
+			Verify(SDL_CondWait(doneEvent, mutex) == 0);
+		}
+	}
+	Verify(SDL_UnlockMutex(mutex) == 0);
+}
+
+void ImageCpuDelayLine::reapWork()
+{
+	WorkItem * doneWork[16];
+	int numDoneWork = 0;
+	
+	do
+	{
+		numDoneWork = 0;
+		
+		Verify(SDL_LockMutex(mutex) == 0);
 		{
-			if (!work.isDone)
+			for (size_t i = 0; i < work.size() && numDoneWork < 16; )
 			{
-				Verify(SDL_CondWait(doneEvent, mutex) == 0);
+				if (work[i]->isDone)
+				{
+					doneWork[numDoneWork++] = work[i];
+					
+					work.erase(work.begin() + i);
+				}
+				else
+				{
+					++i;
+				}
 			}
+		}
+		Verify(SDL_UnlockMutex(mutex) == 0);
+		
+		for (int i = 0; i < numDoneWork; ++i)
+		{
+			finishWork(doneWork[i]);
+		}
+	} while (numDoneWork == 16);
+}
+
+void ImageCpuDelayLine::finishWork(WorkItem * workItem)
+{
+	HistoryItem * item = workItem->historyItem;
+	
+	if (workItem->type == kWorkType_Compress)
+	{
+		numCompressWorkInProgress--;
+		
+		if (item == nullptr)
+		{
+			// the history item was removed in the meantime
+			
+			delete workItem->imageData;
+			delete workItem->jpegData;
+		}
+		else if (workItem->jpegData != nullptr)
+		{
+			Assert(item->compressWork == workItem);
+			item->compressWork = nullptr;
+			
+			// replace the uncompressed image with the compressed one
+			
+			Assert(item->jpegData == nullptr);
+			item->jpegData = workItem->jpegData;
 			
-			// is the compression work done?
+			delete item->imageData;
+			item->imageData = nullptr;
+		}
+		else
+		{
+			// compression failed. keep the uncompressed image
 			
-			if (work.isDone)
+			item->compressWork = nullptr;
+		}
+	}
+	else
+	{
+		numDecodeWorkInProgress--;
+		
+		if (item == nullptr)
+		{
+			delete workItem->jpegData;
+			delete workItem->imageData;
+		}
+		else
+		{
+			Assert(item->decodeWork == workItem);
+			item->decodeWork = nullptr;
+			
+			if (workItem->imageData != nullptr)
 			{
-				// if so, finish up the work
-				
-				// steal the data
-				jpegData = work.jpegData;
-				timestamp = work.timestamp;
+				Assert(decodedImages.count(item->index) == 0);
 				
-				// and clear the work item
-				work.imageData = nullptr;
-				work.jpegQualityLevel = 0;
-				work.jpegData = nullptr;
-				work.isDone = false;
-				work.timestamp = 0.0;
+				DecodedItem decodedItem;
+				decodedItem.imageData = workItem->imageData;
+				decodedItem.lastUsedTick = tickIndex;
 				
-				Assert(work.imageData == nullptr);
-				Assert(work.imageDataIsConsumed);
-				Assert(work.jpegQualityLevel == 0);
-				Assert(work.jpegData == 0);
-				Assert(work.isDone == false);
-				Assert(work.timestamp == 0.0);
+				decodedImages.insert(std::make_pair(item->index, decodedItem));
 			}
 		}
 	}
-	Verify(SDL_UnlockMutex(mutex) == 0);
 	
-	if (jpegData != nullptr)
+	workItem->historyItem = nullptr;
+	workItem->imageData = nullptr;
+	workItem->jpegData = nullptr;
+	
+	delete workItem;
+	workItem = nullptr;
+}
+
+bool ImageCpuDelayLine::newDiskSegment()
+{
+	if (diskSegment != nullptr)
+	{
+		diskSegment->release();
+		diskSegment = nullptr;
+	}
+	
+	char filename[1024];
+	snprintf(filename, sizeof(filename), "%s/imageCpuDelayLine-%p-%d.seg", diskStoragePath.c_str(), this, nextDiskSegmentId++);
+	
+	DiskSegment * segment = new DiskSegment();
+	
+	if (segment->create(filename, diskSegmentSize) == false)
+	{
+		LOG_ERR("image delay line: failed to create segment file %s", filename);
+		
+		delete segment;
+		segment = nullptr;
+		
+		return false;
+	}
+	
+	segment->retain();
+	
+	diskSegment = segment;
+	
+	return true;
+}
+
+void ImageCpuDelayLine::spillHistory()
+{
+	if (diskStoragePath.empty())
+	{
+		return;
+	}
+	
+	// note : images are moved to disk in the order they were added, so segments fill up and become unused in order
+	
+	const int64_t oldestIndex = nextIndex - historySize;
+	
+	nextSpillIndex = std::max(nextSpillIndex, oldestIndex);
+	
+	for (;;)
 	{
-		// add the compressed data to the history
+		const int offset = int(nextIndex - 1 - nextSpillIndex);
+		
+		if (offset < hotWindowSize)
+			break;
+		
+		HistoryItem * item = history[offset];
+		Assert(item->index == nextSpillIndex);
+		
+		// wait for work in progress to finish, as it may be using the JPEG data
 		
-		HistoryItem * historyItem = new HistoryItem();
-		historyItem->jpegData = jpegData;
-		historyItem->timestamp = timestamp;
+		if (item->compressWork != nullptr || item->decodeWork != nullptr)
+			break;
+		
+		// note : images stored uncompressed are kept in memory
 		
-		if (historySize == maxHistorySize)
+		if (item->jpegData != nullptr && item->jpegData->diskSegment == nullptr)
 		{
-			HistoryItem * item = history.back();
-			delete item;
-			item = nullptr;
+			if (spill(*item) == false && diskStoragePath.empty())
+				break;
+		}
+		
+		nextSpillIndex++;
+	}
+}
 
-			history.pop_back();
+bool ImageCpuDelayLine::spill(HistoryItem & item)
+{
+	const JpegData & jpegData = *item.jpegData;
+	
+	if (jpegData.numBytes > diskSegmentSize)
+	{
+		return false;
+	}
+	
+	uint8_t * bytes = diskSegment == nullptr ? nullptr : diskSegment->append(jpegData.bytes, jpegData.numBytes);
+	
+	if (bytes == nullptr)
+	{
+		// the segment is full. continue with a new one
+		
+		if (newDiskSegment())
+		{
+			bytes = diskSegment->append(jpegData.bytes, jpegData.numBytes);
 		}
-		else
+		
+		if (bytes == nullptr)
 		{
-			historySize++;
+			// we can't write to disk. stop trying, and keep the remaining images in memory
+			
+			LOG_ERR("image delay line: failed to write to disk. disabling disk storage");
+			
+			diskStoragePath.clear();
+			
+			return false;
 		}
+	}
+	
+	JpegData * diskJpegData = new JpegData();
+	diskJpegData->bytes = bytes;
+	diskJpegData->numBytes = jpegData.numBytes;
+	diskJpegData->sx = jpegData.sx;
+	diskJpegData->sy = jpegData.sy;
+	diskJpegData->numChannels = jpegData.numChannels;
+	diskJpegData->diskSegment = diskSegment;
+	diskSegment->retain();
+	
+	delete item.jpegData;
+	item.jpegData = diskJpegData;
+	
+	return true;
+}
+
+void ImageCpuDelayLine::trimDecodedImages()
+{
+	// evict the least recently used images, but never the images used or prefetched during the last tick
+	
+	while ((int)decodedImages.size() > maxDecodedImages)
+	{
+		auto oldest = decodedImages.begin();
+		
+		for (auto i = decodedImages.begin(); i != decodedImages.end(); ++i)
+			if (i->second.lastUsedTick < oldest->second.lastUsedTick)
+				oldest = i;
+		
+		if (oldest->second.lastUsedTick >= tickIndex - 1)
+			break;
+		
+		delete oldest->second.imageData;
+		oldest->second.imageData = nullptr;
 		
-		history.push_front(historyItem);
+		decodedImages.erase(oldest);
 	}
 }
 
@@ -29,8 +29,11 @@
 
 #if VFXGRAPH_ENABLE_TURBOJPEG
 
+#include <map>
 #include <stdint.h>
 #include <deque>
+#include <string>
+#include <vector>
 
 struct JpegLoadData;
 
@@ -41,8 +44,25 @@ struct SDL_cond;
 struct SDL_mutex;
 struct SDL_Thread;
 
+/*
+ImageCpuDelayLine records a history of images, optionally JPEG compressed, and gives random access to them.
+
+Compression and decompression run on a pool of worker threads. Images are added to the history immediately, and are
+served from their uncompressed copy until their compression is done. Decoded images are kept in a cache, keyed by
+the (absolute) history index of the item they were decoded from. Since the history shifts by one item each time an
+image is added, the item which will be requested next time for a given offset is predictable. After each get, the
+delay line starts decoding the item(s) which will move into its place, so they are ready by the time they are needed.
+
+Optionally, compressed images which are older than a 'hot window' of recent images are moved to disk (see
+initDiskStorage). They are appended to segment files, which are memory mapped, so decoding an image from disk is no
+different from decoding an image kept in memory. This allows for hours of history, while memory usage stays bounded
+by the size of the hot window.
+*/
 struct ImageCpuDelayLine
 {
+	struct DiskSegment;
+	struct WorkItem;
+	
 	struct JpegData
 	{
 		uint8_t * bytes;
@@ -52,68 +72,144 @@ struct ImageCpuDelayLine
 		int sy;
 		int numChannels;
 		
+		DiskSegment * diskSegment; // when set, bytes points into the memory mapped segment file, rather than being owned
+		
 		JpegData();
 		~JpegData();
 	};
 
 	struct HistoryItem
 	{
-		VfxImageCpuData * imageData;
+		VfxImageCpuData * imageData; // uncompressed image. kept until compression is done
 		JpegData * jpegData;
 		double timestamp;
+		int64_t index; // absolute history index. history[offset] has index nextIndex - 1 - offset
+		
+		WorkItem * compressWork; // compression in progress for imageData
+		WorkItem * decodeWork; // decompression in progress for jpegData
 
 		HistoryItem();
 		~HistoryItem();
 	};
+	
+	enum WorkType
+	{
+		kWorkType_Compress,
+		kWorkType_Decode
+	};
 
+	// note : work items are owned by the main thread. worker threads only read imageData or jpegData, and write the
+	//        result of the work, until isDone is set. when the history item is removed while the work is in progress,
+	//        historyItem is set to nullptr and the work item takes ownership of the history item's data
+	
 	struct WorkItem
 	{
-		VfxImageCpuData * imageData;
-		bool imageDataIsConsumed;
+		WorkType type;
+		HistoryItem * historyItem;
+		int64_t index;
 		int jpegQualityLevel;
-		double timestamp;
 		
-		JpegData * jpegData;
+		VfxImageCpuData * imageData; // compress: source image. decode: decoded image
+		JpegData * jpegData; // compress: compressed image. decode: source data
+		
+		bool isStarted;
 		bool isDone;
 
 		WorkItem();
 		~WorkItem();
 	};
 	
+	struct DecodedItem
+	{
+		VfxImageCpuData * imageData;
+		int64_t lastUsedTick;
+	};
+	
+	struct Worker
+	{
+		ImageCpuDelayLine * delayLine;
+		SDL_Thread * thread;
+		
+		uint8_t * saveBuffer;
+		std::vector<uint8_t> interleaveBuffer;
+		JpegLoadData * loadData;
+		int numLoadDataBytes; // updated while holding the mutex, for getMemoryUsage
+		
+		Worker();
+		~Worker();
+	};
+	
 	struct MemoryUsage
 	{
 		int numBytes;
 		
 		int numHistoryBytes;
+		int numCompressedBytes; // JPEG data in the history, kept in memory
+		int numDecodedBytes; // decoded image cache
 		int numCachedImageBytes;
 		int numSaveBufferBytes;
 		
 		int historySize;
+		int numDecodedImages;
+		
+		int64_t numDiskBytes; // JPEG data in the history, moved to disk
+		int numDiskImages;
+	};
+	
+	struct Stats
+	{
+		int64_t numCacheHits; // decoded images which were served from the cache
+		int64_t numCacheMisses; // decoded images which were decoded on the calling thread
+		int64_t numCompressStalls; // the number of times add had to wait for compression to catch up
+		
+		Stats();
 	};
 	
-	uint8_t * saveBuffer;
 	int saveBufferSize;
 	
 	std::deque<HistoryItem*> history;
 	int maxHistorySize;
 	int historySize;
+	int64_t nextIndex;
+	
+	std::map<int64_t, DecodedItem> decodedImages;
+	int maxDecodedImages;
+	int numPrefetchImages;
+	int64_t tickIndex;
 	
-	WorkItem work;
+	std::vector<Worker*> workers;
+	std::vector<WorkItem*> work; // all work which hasn't been reaped yet. modified only while holding the mutex
+	int numCompressWorkInProgress;
+	int numDecodeWorkInProgress;
 	
 	bool stop;
 	SDL_cond * workEvent;
 	SDL_cond * doneEvent;
 	SDL_mutex * mutex;
-	SDL_Thread * thread;
 	
 	JpegLoadData * cachedLoadData;
+	std::vector<uint8_t> glitchBuffer;
+	
+	std::string diskStoragePath; // empty when disk storage is disabled
+	int hotWindowSize;
+	int diskSegmentSize;
+	DiskSegment * diskSegment; // the segment new images are appended to
+	int nextDiskSegmentId;
+	int64_t nextSpillIndex; // the index of the oldest history item which may still be moved to disk
+	
+	Stats stats;
 
 	ImageCpuDelayLine();
 	~ImageCpuDelayLine();
 
-	void init(const int maxHistorySize, const int saveBufferSize);
+	// numThreads = 0 picks a number of worker threads based on the number of cores
+	void init(const int maxHistorySize, const int saveBufferSize, const int numThreads = 0);
 	void shut();
 	
+	// moves compressed images older than hotWindowSize to segment files inside the directory at path. must be called
+	// after init. the segment files are temporary, and are removed once the images they contain leave the history
+	bool initDiskStorage(const char * path, const int hotWindowSize, const int segmentSize = 256 * 1024 * 1024);
+	
 	void tick();
 	
 	int getLength() const;
@@ -123,19 +219,34 @@ struct ImageCpuDelayLine
 	
 	bool decode(const JpegData & jpegData, VfxImageCpuData & imageData, const bool glitch, const float glitchiness);
 	bool get(const int offset, VfxImageCpuData & imageData, double * imageTimestamp = nullptr, const bool glitch = false, const float glitchiness = 0.f);
+	// returns the oldest image with a timestamp at or after the given timestamp. images must be added in timestamp order
 	bool getByTimestamp(const double timestamp, VfxImageCpuData & imageData, double * imageTimestamp = nullptr, const bool glitch = false, const float glitchiness = 0.f);
 	
 	void clearHistory();
 	
 	MemoryUsage getMemoryUsage() const;
 
-	JpegData * compress(const VfxImageCpu & image, const int jpegQualityLevel);
+	static JpegData * compress(const VfxImageCpu & image, const int jpegQualityLevel, uint8_t * saveBuffer, const int saveBufferSize, std::vector<uint8_t> & interleaveBuffer);
 
 	static int threadProc(void * arg);
-	void threadMain();
-
-	void compressWork(const VfxImageCpu & image, const int jpegQualityLevel, const double timestamp);
-	void compressWait();
+	void threadMain(Worker & worker);
+	
+private:
+	bool getItem(HistoryItem & item, VfxImageCpuData & imageData, const bool glitch, const float glitchiness);
+	void prefetch(const int offset);
+	
+	void removeOldestHistoryItem();
+	
+	void submitWork(WorkItem * workItem);
+	void waitForWork(WorkItem * workItem);
+	void reapWork();
+	void finishWork(WorkItem * workItem);
+	
+	void trimDecodedImages();
+	
+	bool newDiskSegment();
+	void spillHistory();
+	bool spill(HistoryItem & item);
 };
 
 #endif
@@ -105,6 +105,7 @@ int VfxNodeAudioGraph::VoiceMgr::calculateNumVoices() const
 VfxNodeAudioGraph::VfxNodeAudioGraph()
 	: VfxNodeBase()
 	, voiceMgr()
+	, voiceMixer()
 	, context(nullptr)
 	, audioGraphInstance(nullptr)
 	, currentFilename()
@@ -373,6 +374,7 @@ void VfxNodeAudioGraph::tick(const float dt)
 		
 	// fixme : limiting isn't really possible, as both the main and audio thread would update measured peak state ? unless we maintain and perform limiting ourselves
 		AudioVoiceManager::generateAudio(
+			voiceMixer,
 			voices, numVoices,
 			channelData.data, numSamples, numChannels,
 			limit, limitPeak,
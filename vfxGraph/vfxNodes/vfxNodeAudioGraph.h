@@ -86,6 +86,7 @@ struct VfxNodeAudioGraph : VfxNodeBase
 	};
 	
 	VoiceMgr voiceMgr;
+	AudioVoiceMixer voiceMixer; // kept around so the mixer's buffers are allocated only once
 	
 	AudioGraphContext * context;
 	
@@ -125,6 +125,7 @@ VFX_NODE_TYPE(VfxNodeAudioGraphPoly)
 VfxNodeAudioGraphPoly::VfxNodeAudioGraphPoly()
 	: VfxNodeBase()
 	, voiceMgr()
+	, voiceMixer()
 	, context(nullptr)
 	, instances()
 	, currentFilename()
@@ -537,6 +538,7 @@ void VfxNodeAudioGraphPoly::tick(const float dt)
 		const float limitPeak = 1.f;
 		
 		AudioVoiceManager::generateAudio(
+			voiceMixer,
 			voices, numVoices,
 			voicesData.data, numSamples, numChannels,
 			limit, limitPeak,
@@ -168,6 +168,7 @@ struct VfxNodeAudioGraphPoly : VfxNodeBase
 	};
 	
 	VoiceMgr_VoiceGroup voiceMgr;
+	AudioVoiceMixer voiceMixer; // kept around so the mixer's buffers are allocated only once
 	
 	AudioGraphContext * context;
 	
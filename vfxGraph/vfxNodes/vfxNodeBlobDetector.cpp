@@ -80,6 +80,8 @@ VfxNodeBlobDetector::VfxNodeBlobDetector()
 	addOutput(kOutput_X, kVfxPlugType_Channel, &xOutput);
 	addOutput(kOutput_Y, kVfxPlugType_Channel, &yOutput);
 	addOutput(kOutput_NumBlobs, kVfxPlugType_Int, &numBlobsOutput);
+	
+	isThreadSafe = true;
 }
 
 VfxNodeBlobDetector::~VfxNodeBlobDetector()
@@ -56,6 +56,8 @@ VfxNodeChannelFft::VfxNodeChannelFft()
 	addInput(kInput_Normalize, kVfxPlugType_Bool);
 	addOutput(kOutput_Real, kVfxPlugType_Channel, &realOutput);
 	addOutput(kOutput_Imag, kVfxPlugType_Channel, &imagOutput);
+	
+	isThreadSafe = true;
 }
 
 void VfxNodeChannelFft::tick(const float dt)
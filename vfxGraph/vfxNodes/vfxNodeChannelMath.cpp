@@ -196,12 +196,16 @@ void VfxNodeChannelMath::tick(const float dt)
 	
 	if (isPassthrough)
 	{
-		channelData.free();
-		
 		if (a != nullptr)
+		{
+			channelData.share(*a);
 			channelOutput = *a;
+		}
 		else
+		{
+			channelData.free();
 			channelOutput.reset();
+		}
 	}
 	else if (zipper.done())
 	{
@@ -57,12 +57,16 @@ void VfxNodeChannelRotate::tick(const float dt)
 	
 	if (isPassthrough || channel == nullptr || channel->sx == 0 || channel->sy == 0)
 	{
-		channelData.free();
-
 		if (channel == nullptr)
+		{
+			channelData.free();
 			channelOutput.reset();
+		}
 		else
+		{
+			channelData.share(*channel);
 			channelOutput = *channel;
+		}
 	}
 	else
 	{
@@ -94,6 +94,8 @@ VfxNodeDotDetector::VfxNodeDotDetector()
 	addOutput(kOutput_Y, kVfxPlugType_Channel, &yOutput);
 	addOutput(kOutput_Radius, kVfxPlugType_Channel, &rOutput);
 	addOutput(kOutput_NumDots, kVfxPlugType_Int, &numDotsOutput);
+	
+	isThreadSafe = true;
 }
 
 VfxNodeDotDetector::~VfxNodeDotDetector()
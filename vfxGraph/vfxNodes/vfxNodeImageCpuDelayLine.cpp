@@ -108,7 +108,7 @@ void VfxNodeImageCpuDelayLine::tick(const float dt)
 		return;
 	}
 	
-	if (delayLine->saveBuffer == nullptr)
+	if (delayLine->workers.empty())
 	{
 		delayLine->init(0, 1024 * 512);
 	}
@@ -199,6 +199,15 @@ void VfxNodeImageCpuDelayLine::getDescription(VfxNodeDescription & d)
 		memoryUsage.numHistoryBytes/(1024.0*1024.0),
 		memoryUsage.historySize,
 		delayLine->maxHistorySize);
+	d.add("compressed: %.2fMb, decoded: %.2fMb (%d images)",
+		memoryUsage.numCompressedBytes/(1024.0*1024.0),
+		memoryUsage.numDecodedBytes/(1024.0*1024.0),
+		memoryUsage.numDecodedImages);
+	d.add("worker threads: %d, decode cache hits: %lld, misses: %lld, compression stalls: %lld",
+		(int)delayLine->workers.size(),
+		(long long)delayLine->stats.numCacheHits,
+		(long long)delayLine->stats.numCacheMisses,
+		(long long)delayLine->stats.numCompressStalls);
 	d.newline();
 	
 	for (int i = 0; i < 4; ++i)
@@ -27,8 +27,16 @@
 
 #include "MemAlloc.h"
 #include "vfxNodeImageCpuDownsample.h"
+#include "vfxParallelRows.h"
 #include <algorithm>
 
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define USE_NEON 1
+	#include <arm_neon.h>
+#else
+	#define USE_NEON 0 // do not alter
+#endif
+
 #ifdef __SSE2__
 	#include <xmmintrin.h>
 
@@ -43,7 +51,6 @@
 	#ifndef __SSSE3__
 		#warning SSSE3 support disabled. image cpu downsample methods will use slower SSE2 code paths
 	#else
-		#include <immintrin.h> // fixme : _mm_extract_epi32 : argh! this is SSE 4.1 !
 		#include <tmmintrin.h>
 	#endif
 #endif
@@ -363,7 +370,7 @@ static int downsampleLine4x4_1channel_SSE(
 		
 		const __m128i dstValuesPacked = _mm_packus_epi16(dstValues, zero);
 		
-		((int*)dstLine)[x] = _mm_extract_epi32(dstValuesPacked, 0);
+		((int*)dstLine)[x] = _mm_cvtsi128_si32(dstValuesPacked);
 	}
 	
 	return numIterations * 4;
@@ -408,6 +415,141 @@ static int downsampleLine2x2_1channel_AVX(
 
 #endif
 
+#if USE_NEON
+
+// note : the NEON versions use the same rounding as the SSE versions : averaging rows rounds up, adding columns rounds down
+
+static int downsampleLine2x2_1channel_NEON(
+	const uint8_t * __restrict srcLine1,
+	const uint8_t * __restrict srcLine2,
+	const int numPixels,
+	uint8_t * __restrict dstLine)
+{
+	const int numIterations = numPixels / 8;
+	
+	for (int x = 0; x < numIterations; ++x)
+	{
+		const uint8x16_t srcValues = vrhaddq_u8(vld1q_u8(srcLine1 + x * 16), vld1q_u8(srcLine2 + x * 16));
+		
+		vst1_u8(dstLine + x * 8, vshrn_n_u16(vpaddlq_u8(srcValues), 1));
+	}
+	
+	return numIterations * 8;
+}
+
+static int downsampleLine4x4_1channel_NEON(
+	const uint8_t * __restrict srcLine1,
+	const uint8_t * __restrict srcLine2,
+	const uint8_t * __restrict srcLine3,
+	const uint8_t * __restrict srcLine4,
+	const int numPixels,
+	uint8_t * __restrict dstLine)
+{
+	const int numIterations = numPixels / 4;
+	
+	for (int x = 0; x < numIterations; ++x)
+	{
+		const uint8x16_t srcValuesA = vrhaddq_u8(vld1q_u8(srcLine1 + x * 16), vld1q_u8(srcLine2 + x * 16));
+		const uint8x16_t srcValuesB = vrhaddq_u8(vld1q_u8(srcLine3 + x * 16), vld1q_u8(srcLine4 + x * 16));
+		const uint8x16_t srcValues = vrhaddq_u8(srcValuesA, srcValuesB);
+		
+		const uint32x4_t sums = vpaddlq_u16(vpaddlq_u8(srcValues));
+		const uint8x8_t dstValues = vmovn_u16(vcombine_u16(vshrn_n_u32(sums, 2), vdup_n_u16(0)));
+		
+		vst1_lane_u32((uint32_t*)(dstLine + x * 4), vreinterpret_u32_u8(dstValues), 0);
+	}
+	
+	return numIterations * 4;
+}
+
+#endif
+
+static void downsampleLine2x2(
+	const uint8_t * __restrict srcItr1,
+	const uint8_t * __restrict srcItr2,
+	const int downsampledSx,
+	uint8_t * __restrict dstItr)
+{
+	int numPixelsProcessed = 0;
+	
+#if USE_NEON
+	numPixelsProcessed = downsampleLine2x2_1channel_NEON(srcItr1, srcItr2, downsampledSx, dstItr);
+#elif defined(__SSSE3__)
+	if (((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(dstItr)) & 0xf) == 0)
+	{
+	#if __AVX2__
+		numPixelsProcessed = downsampleLine2x2_1channel_AVX(srcItr1, srcItr2, downsampledSx, dstItr);
+	#else
+		numPixelsProcessed = downsampleLine2x2_1channel_SSE(srcItr1, srcItr2, downsampledSx, dstItr);
+	#endif
+	}
+#endif
+	
+	srcItr1 += numPixelsProcessed * 2;
+	srcItr2 += numPixelsProcessed * 2;
+	dstItr += numPixelsProcessed;
+	
+	for (int x = numPixelsProcessed; x < downsampledSx; ++x)
+	{
+		const int src1 = srcItr1[0] + srcItr1[1];
+		const int src2 = srcItr2[0] + srcItr2[1];
+		
+		const int src = (src1 + src2) >> 2;
+		
+		*dstItr = src;
+		
+		srcItr1 += 2;
+		srcItr2 += 2;
+		
+		dstItr += 1;
+	}
+}
+
+static void downsampleLine4x4(
+	const uint8_t * __restrict srcItr1,
+	const uint8_t * __restrict srcItr2,
+	const uint8_t * __restrict srcItr3,
+	const uint8_t * __restrict srcItr4,
+	const int downsampledSx,
+	uint8_t * __restrict dstItr)
+{
+	int numPixelsProcessed = 0;
+	
+#if USE_NEON
+	numPixelsProcessed = downsampleLine4x4_1channel_NEON(srcItr1, srcItr2, srcItr3, srcItr4, downsampledSx, dstItr);
+#elif defined(__SSSE3__)
+	if (((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(srcItr3) | uintptr_t(srcItr4) | uintptr_t(dstItr)) & 0xf) == 0)
+	{
+		numPixelsProcessed = downsampleLine4x4_1channel_SSE(srcItr1, srcItr2, srcItr3, srcItr4, downsampledSx, dstItr);
+	}
+#endif
+	
+	srcItr1 += numPixelsProcessed * 4;
+	srcItr2 += numPixelsProcessed * 4;
+	srcItr3 += numPixelsProcessed * 4;
+	srcItr4 += numPixelsProcessed * 4;
+	dstItr += numPixelsProcessed;
+	
+	for (int x = numPixelsProcessed; x < downsampledSx; ++x)
+	{
+		int src1 = srcItr1[0] + srcItr1[1] + srcItr1[2] + srcItr1[3];
+		int src2 = srcItr2[0] + srcItr2[1] + srcItr2[2] + srcItr2[3];
+		int src3 = srcItr3[0] + srcItr3[1] + srcItr3[2] + srcItr3[3];
+		int src4 = srcItr4[0] + srcItr4[1] + srcItr4[2] + srcItr4[3];
+		
+		const int src = ((src1 + src2) + (src3 + src4)) >> 4;
+		
+		*dstItr = src;
+		
+		srcItr1 += 4;
+		srcItr2 += 4;
+		srcItr3 += 4;
+		srcItr4 += 4;
+		
+		dstItr += 1;
+	}
+}
+
 void VfxNodeImageCpuDownsample::downsample(const VfxImageCpu & src, VfxImageCpu & dst, const int pixelSize)
 {
 	if (pixelSize == 2)
@@ -423,47 +565,20 @@ void VfxNodeImageCpuDownsample::downsample(const VfxImageCpu & src, VfxImageCpu
 			const VfxImageCpu::Channel & srcChannel = src.channel[i];
 				  VfxImageCpu::Channel & dstChannel = dst.channel[i];
 			
-			for (int y = 0; y < downsampledSy; ++y)
+			vfxParallelRows(downsampledSy, vfxGetRowsPerTask(src.sx * 2), [&](const int y1, const int y2)
 			{
-				const uint8_t * __restrict srcItr1 = srcChannel.data + (y * 2 + yOffset1) * srcChannel.pitch;
-				const uint8_t * __restrict srcItr2 = srcChannel.data + (y * 2 + yOffset2) * srcChannel.pitch;
-					  uint8_t * __restrict dstItr = (uint8_t*)dstChannel.data + y * dstChannel.pitch;
-				
-				Assert(((uintptr_t(srcItr1) | uintptr_t(srcItr2)) & 0xf) == 0);
-				Assert((uintptr_t(dstItr) & 0xf) == 0);
-				
-				int numPixelsProcessed = 0;
-				
-			#ifdef __SSSE3__
-				if (((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(dstItr)) & 0xf) == 0)
+				for (int y = y1; y < y2; ++y)
 				{
-				#if __AVX2__
-					numPixelsProcessed = downsampleLine2x2_1channel_AVX(srcItr1, srcItr2, downsampledSx, dstItr);
-				#else
-					numPixelsProcessed = downsampleLine2x2_1channel_SSE(srcItr1, srcItr2, downsampledSx, dstItr);
-				#endif
+					const uint8_t * __restrict srcItr1 = srcChannel.data + (y * 2 + yOffset1) * srcChannel.pitch;
+					const uint8_t * __restrict srcItr2 = srcChannel.data + (y * 2 + yOffset2) * srcChannel.pitch;
+						  uint8_t * __restrict dstItr = (uint8_t*)dstChannel.data + y * dstChannel.pitch;
 					
-					srcItr1 += numPixelsProcessed * 2;
-					srcItr2 += numPixelsProcessed * 2;
-					dstItr += numPixelsProcessed;
-				}
-			#endif
-				
-				for (int x = numPixelsProcessed; x < downsampledSx; ++x)
-				{
-					const int src1 = srcItr1[0] + srcItr1[1];
-					const int src2 = srcItr2[0] + srcItr2[1];
+					Assert(((uintptr_t(srcItr1) | uintptr_t(srcItr2)) & 0xf) == 0);
+					Assert((uintptr_t(dstItr) & 0xf) == 0);
 					
-					const int src = (src1 + src2) >> 2;
-					
-					*dstItr = src;
-					
-					srcItr1 += 2;
-					srcItr2 += 2;
-					
-					dstItr += 1;
+					downsampleLine2x2(srcItr1, srcItr2, downsampledSx, dstItr);
 				}
-			}
+			});
 		}
 	}
 	else if (pixelSize == 4)
@@ -476,51 +591,22 @@ void VfxNodeImageCpuDownsample::downsample(const VfxImageCpu & src, VfxImageCpu
 			const VfxImageCpu::Channel & srcChannel = src.channel[i];
 				  VfxImageCpu::Channel & dstChannel = dst.channel[i];
 			
-			for (int y = 0; y < downsampledSy; ++y)
+			vfxParallelRows(downsampledSy, vfxGetRowsPerTask(src.sx * 4), [&](const int y1, const int y2)
 			{
-				const uint8_t * __restrict srcItr1 = srcChannel.data + (y * 4 + 0) * srcChannel.pitch;
-				const uint8_t * __restrict srcItr2 = srcChannel.data + (y * 4 + 1) * srcChannel.pitch;
-				const uint8_t * __restrict srcItr3 = srcChannel.data + (y * 4 + 2) * srcChannel.pitch;
-				const uint8_t * __restrict srcItr4 = srcChannel.data + (y * 4 + 3) * srcChannel.pitch;
-					  uint8_t * __restrict dstItr = (uint8_t*)dstChannel.data + y * dstChannel.pitch;
-				
-				Assert(((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(srcItr3) | uintptr_t(srcItr4)) & 0xf) == 0);
-				Assert((uintptr_t(dstItr) & 0xf) == 0);
-				
-				int numPixelsProcessed = 0;
-				
-			#ifdef __SSSE3__
-				if (((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(srcItr3) | uintptr_t(srcItr4) | uintptr_t(dstItr)) & 0xf) == 0)
-				{
-					numPixelsProcessed = downsampleLine4x4_1channel_SSE(srcItr1, srcItr2, srcItr3, srcItr4, downsampledSx, dstItr);
-					
-					srcItr1 += numPixelsProcessed * 4;
-					srcItr2 += numPixelsProcessed * 4;
-					srcItr3 += numPixelsProcessed * 4;
-					srcItr4 += numPixelsProcessed * 4;
-					dstItr += numPixelsProcessed;
-				}
-			#endif
-			
-				for (int x = numPixelsProcessed; x < downsampledSx; ++x)
+				for (int y = y1; y < y2; ++y)
 				{
-					int src1 = srcItr1[0] + srcItr1[1] + srcItr1[2] + srcItr1[3];
-					int src2 = srcItr2[0] + srcItr2[1] + srcItr2[2] + srcItr2[3];
-					int src3 = srcItr3[0] + srcItr3[1] + srcItr3[2] + srcItr3[3];
-					int src4 = srcItr4[0] + srcItr4[1] + srcItr4[2] + srcItr4[3];
-					
-					const int src = ((src1 + src2) + (src3 + src4)) >> 4;
-					
-					*dstItr = src;
+					const uint8_t * __restrict srcItr1 = srcChannel.data + (y * 4 + 0) * srcChannel.pitch;
+					const uint8_t * __restrict srcItr2 = srcChannel.data + (y * 4 + 1) * srcChannel.pitch;
+					const uint8_t * __restrict srcItr3 = srcChannel.data + (y * 4 + 2) * srcChannel.pitch;
+					const uint8_t * __restrict srcItr4 = srcChannel.data + (y * 4 + 3) * srcChannel.pitch;
+						  uint8_t * __restrict dstItr = (uint8_t*)dstChannel.data + y * dstChannel.pitch;
 					
-					srcItr1 += 4;
-					srcItr2 += 4;
-					srcItr3 += 4;
-					srcItr4 += 4;
+					Assert(((uintptr_t(srcItr1) | uintptr_t(srcItr2) | uintptr_t(srcItr3) | uintptr_t(srcItr4)) & 0xf) == 0);
+					Assert((uintptr_t(dstItr) & 0xf) == 0);
 					
-					dstItr += 1;
+					downsampleLine4x4(srcItr1, srcItr2, srcItr3, srcItr4, downsampledSx, dstItr);
 				}
-			}
+			});
 		}
 	}
 	else
@@ -528,4 +614,3 @@ void VfxNodeImageCpuDownsample::downsample(const VfxImageCpu & src, VfxImageCpu
 		Assert(false);
 	}
 }
-
@@ -28,6 +28,7 @@
 #pragma once
 
 #include "vfxNodeBase.h"
+#include <string.h>
 
 struct VfxNodeImageCpuDownsample : VfxNodeBase
 {
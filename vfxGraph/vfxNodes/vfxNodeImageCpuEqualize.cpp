@@ -26,7 +26,9 @@
 */
 
 #include "vfxNodeImageCpuEqualize.h"
+#include "vfxParallelRows.h"
 #include <algorithm>
+#include <mutex>
 #include <string.h>
 
 #if defined(__AVX2__) && __AVX2__
@@ -64,17 +66,42 @@ static void computeHistogram(const VfxImageCpu::Channel * __restrict channel, co
 {
 	memset(histogram, 0, sizeof(int) * 256);
 	
-	for (int y = 0; y < sy; ++y)
+	std::mutex mutex;
+	
+	vfxParallelRows(sy, vfxGetRowsPerTask(sx), [&](const int y1, const int y2)
 	{
-		const uint8_t * __restrict srcPtr = channel->data + y * channel->pitch;
+		// note : use four sub-histograms, to avoid stalls when consecutive values fall into the same bucket
+		
+		int localHistograms[4][256];
+		memset(localHistograms, 0, sizeof(localHistograms));
 		
-		for (int x = 0; x < sx; ++x)
+		for (int y = y1; y < y2; ++y)
 		{
-			const int value = srcPtr[x];
+			const uint8_t * __restrict srcPtr = channel->data + y * channel->pitch;
+			
+			int x = 0;
+			
+			for (; x + 4 <= sx; x += 4)
+			{
+				localHistograms[0][srcPtr[x + 0]]++;
+				localHistograms[1][srcPtr[x + 1]]++;
+				localHistograms[2][srcPtr[x + 2]]++;
+				localHistograms[3][srcPtr[x + 3]]++;
+			}
 			
-			histogram[value]++;
+			for (; x < sx; ++x)
+			{
+				const int value = srcPtr[x];
+				
+				localHistograms[0][value]++;
+			}
 		}
-	}
+		
+		std::lock_guard<std::mutex> lock(mutex);
+		
+		for (int i = 0; i < 256; ++i)
+			histogram[i] += localHistograms[0][i] + localHistograms[1][i] + localHistograms[2][i] + localHistograms[3][i];
+	});
 }
 
 template <typename LookupElem>
@@ -108,6 +135,8 @@ VfxNodeImageCpuEqualize::VfxNodeImageCpuEqualize()
 	addInput(kInput_Channel, kVfxPlugType_Int);
 	addInput(kInput_ErrorDiffusion, kVfxPlugType_Bool);
 	addOutput(kOutput_Image, kVfxPlugType_ImageCpu, &imageOutput);
+	
+	isThreadSafe = true;
 }
 
 void VfxNodeImageCpuEqualize::tick(const float dt)
@@ -126,12 +155,18 @@ void VfxNodeImageCpuEqualize::tick(const float dt)
 	}
 	else if (isPassthrough)
 	{
-		imageData.free();
+		// retain the input buffer, so our output remains valid when the input changes
 		
 		if (image == nullptr)
+		{
+			imageData.free();
 			imageOutput.reset();
+		}
 		else
+		{
+			imageData.share(*image);
 			imageOutput = *image;
+		}
 	}
 	else
 	{
@@ -181,66 +216,81 @@ void VfxNodeImageCpuEqualize::tick(const float dt)
 				
 				VfxImageCpu::Channel * __restrict dstChannel = &imageData.image.channel[i];
 				
-				for (int y = 0; y < image->sy; ++y)
+			#if !USE_AVX2
+				// narrow the remapping table to bytes, so it fits in a few cache lines
+				
+				uint8_t remap8[256];
+				
+				for (int v = 0; v < 256; ++v)
+					remap8[v] = remap[v];
+			#endif
+				
+				vfxParallelRows(image->sy, vfxGetRowsPerTask(image->sx), [&](const int y1, const int y2)
 				{
-					const uint8_t * __restrict srcPtr = srcChannel->data + y * srcChannel->pitch;
-						  uint8_t * __restrict dstPtr = (uint8_t*)dstChannel->data + y * dstChannel->pitch;
-
-				#if USE_AVX2
-					// optimized version using AVX scattered reads from remap table
-					
-					const int sx32 = image->sx / 32;
-					
-					for (int x = 0; x < sx32; ++x)
+					for (int y = y1; y < y2; ++y)
 					{
-						// read 32 source values. these values will be used to index into the remap table
-						
-						const __m256i indices = _mm256_load_si256((__m256i*)&srcPtr[x * 32]);
-						
-						// unfortunately there's no gather instruction which reads 32 int8s. the smallest
-						// size available is reading 8 int32s. unpack the indices so they can be used
-						// with the  gather32 instruction
-						
-						const __m256i zero = _mm256_setzero_si256();
-						
-						// 1x32 uint8 -> 2x16 uint16
-						const __m256i i00 = _mm256_unpacklo_epi8(indices, zero);
-						const __m256i i01 = _mm256_unpackhi_epi8(indices, zero);
-						
-						// 2x16 uint16 -> 4x8 uint32
-						const __m256i i0 = _mm256_unpacklo_epi16(i00, zero);
-						const __m256i i1 = _mm256_unpackhi_epi16(i00, zero);
-						const __m256i i2 = _mm256_unpacklo_epi16(i01, zero);
-						const __m256i i3 = _mm256_unpackhi_epi16(i01, zero);
-						
-						// gather 4x8 values from the remap table
-						const __m256i d1 = _mm256_i32gather_epi32(remap, i0, sizeof(int));
-						const __m256i d2 = _mm256_i32gather_epi32(remap, i1, sizeof(int));
-						const __m256i d3 = _mm256_i32gather_epi32(remap, i2, sizeof(int));
-						const __m256i d4 = _mm256_i32gather_epi32(remap, i3, sizeof(int));
+						const uint8_t * __restrict srcPtr = srcChannel->data + y * srcChannel->pitch;
+							  uint8_t * __restrict dstPtr = (uint8_t*)dstChannel->data + y * dstChannel->pitch;
+
+					#if USE_AVX2
+						// optimized version using AVX scattered reads from remap table
 						
-						// 4x8 uint32 -> 2x16 uint16
-						const __m256i d00 = _mm256_packus_epi32(d1, d2);
-						const __m256i d01 = _mm256_packus_epi32(d3, d4);
+						const int sx32 = image->sx / 32;
 						
-						// 2x16 uint16 -> 1x32 uint8
-						const __m256i d = _mm256_packus_epi16(d00, d01);
+						for (int x = 0; x < sx32; ++x)
+						{
+							// read 32 source values. these values will be used to index into the remap table
+							
+							const __m256i indices = _mm256_load_si256((__m256i*)&srcPtr[x * 32]);
+							
+							// unfortunately there's no gather instruction which reads 32 int8s. the smallest
+							// size available is reading 8 int32s. unpack the indices so they can be used
+							// with the  gather32 instruction
+							
+							const __m256i zero = _mm256_setzero_si256();
+							
+							// 1x32 uint8 -> 2x16 uint16
+							const __m256i i00 = _mm256_unpacklo_epi8(indices, zero);
+							const __m256i i01 = _mm256_unpackhi_epi8(indices, zero);
+							
+							// 2x16 uint16 -> 4x8 uint32
+							const __m256i i0 = _mm256_unpacklo_epi16(i00, zero);
+							const __m256i i1 = _mm256_unpackhi_epi16(i00, zero);
+							const __m256i i2 = _mm256_unpacklo_epi16(i01, zero);
+							const __m256i i3 = _mm256_unpackhi_epi16(i01, zero);
+							
+							// gather 4x8 values from the remap table
+							const __m256i d1 = _mm256_i32gather_epi32(remap, i0, sizeof(int));
+							const __m256i d2 = _mm256_i32gather_epi32(remap, i1, sizeof(int));
+							const __m256i d3 = _mm256_i32gather_epi32(remap, i2, sizeof(int));
+							const __m256i d4 = _mm256_i32gather_epi32(remap, i3, sizeof(int));
+							
+							// 4x8 uint32 -> 2x16 uint16
+							const __m256i d00 = _mm256_packus_epi32(d1, d2);
+							const __m256i d01 = _mm256_packus_epi32(d3, d4);
+							
+							// 2x16 uint16 -> 1x32 uint8
+							const __m256i d = _mm256_packus_epi16(d00, d01);
+							
+							// store the 32 remapped values
+							_mm256_store_si256((__m256i*)&dstPtr[x * 32], d);
+						}
 						
-						// store the 32 remapped values
-						_mm256_store_si256((__m256i*)&dstPtr[x * 32], d);
+						for (int x = sx32 * 32; x < image->sx; ++x)
+						{
+							const int srcValue = srcPtr[x];
+							const int dstValue = remap[srcValue];
+							
+							dstPtr[x] = dstValue;
+						}
+					#else
+						for (int x = 0; x < image->sx; ++x)
+						{
+							dstPtr[x] = remap8[srcPtr[x]];
+						}
+					#endif
 					}
-					
-					for (int x = sx32 * 32; x < image->sx; ++x)
-				#else
-					for (int x = 0; x < image->sx; ++x)
-				#endif
-					{
-						const int srcValue = srcPtr[x];
-						const int dstValue = remap[srcValue];
-						
-						dstPtr[x] = dstValue;
-					}
-				}
+				});
 			}
 			else
 			{
@@ -256,24 +306,29 @@ void VfxNodeImageCpuEqualize::tick(const float dt)
 				
 				VfxImageCpu::Channel * __restrict dstChannel = &imageData.image.channel[i];
 				
-				for (int y = 0; y < image->sy; ++y)
-				{
-					const uint8_t * __restrict srcPtr = srcChannel->data + y * srcChannel->pitch;
-						  uint8_t * __restrict dstPtr = (uint8_t*)dstChannel->data + y * dstChannel->pitch;
-
-					float error = 0.f;
+				// note : the error is diffused along rows only, so rows may be processed in parallel
 				
-					for (int x = 0; x < image->sx; ++x)
+				vfxParallelRows(image->sy, vfxGetRowsPerTask(image->sx), [&](const int y1, const int y2)
+				{
+					for (int y = y1; y < y2; ++y)
 					{
-						const int srcValue = srcPtr[x];
-						const float dstValuef = remap[srcValue] + error;
-						const int dstValue = std::max(0, std::min(255, int(std::round(dstValuef))));
-						
-						dstPtr[x] = dstValue;
-						
-						error = dstValuef - dstValue;
+						const uint8_t * __restrict srcPtr = srcChannel->data + y * srcChannel->pitch;
+							  uint8_t * __restrict dstPtr = (uint8_t*)dstChannel->data + y * dstChannel->pitch;
+
+						float error = 0.f;
+					
+						for (int x = 0; x < image->sx; ++x)
+						{
+							const int srcValue = srcPtr[x];
+							const float dstValuef = remap[srcValue] + error;
+							const int dstValue = std::max(0, std::min(255, int(std::round(dstValuef))));
+							
+							dstPtr[x] = dstValue;
+							
+							error = dstValuef - dstValue;
+						}
 					}
-				}
+				});
 			}
 		}
 	}
@@ -26,6 +26,14 @@
 */
 
 #include "vfxNodeImageCpuToChannels.h"
+#include "vfxParallelRows.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+	#define USE_NEON 1
+	#include <arm_neon.h>
+#else
+	#define USE_NEON 0 // do not alter
+#endif
 
 #ifdef __SSE2__
 	#include <immintrin.h>
@@ -75,7 +83,53 @@ VfxNodeImageCpuToChannels::~VfxNodeImageCpuToChannels()
 	channelData.free();
 }
 
-#ifdef __SSE2__
+#if USE_NEON
+
+static int fillFloats_NEON(const uint8_t * __restrict src, const int sx, float * __restrict dst)
+{
+	const float32x4_t scale_4 = vdupq_n_f32(1.f / 255.f);
+	
+	const int sx_16 = sx / 16;
+	
+	for (int x = 0; x < sx_16; ++x)
+	{
+		const uint8x16_t values = vld1q_u8(src + x * 16);
+		
+		const uint16x8_t valuesL = vmovl_u8(vget_low_u8(values));
+		const uint16x8_t valuesR = vmovl_u8(vget_high_u8(values));
+		
+		vst1q_f32(dst + x * 16 +  0, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(valuesL))), scale_4));
+		vst1q_f32(dst + x * 16 +  4, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(valuesL))), scale_4));
+		vst1q_f32(dst + x * 16 +  8, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(valuesR))), scale_4));
+		vst1q_f32(dst + x * 16 + 12, vmulq_f32(vcvtq_f32_u32(vmovl_u16(vget_high_u16(valuesR))), scale_4));
+	}
+	
+	return sx_16 * 16;
+}
+
+#elif defined(__AVX2__)
+
+static int fillFloats_AVX2(const uint8_t * __restrict src, const int sx, float * __restrict dst)
+{
+	const __m256 scale_8 = _mm256_set1_ps(1.f / 255.f);
+	
+	const int sx_16 = sx / 16;
+	
+	for (int x = 0; x < sx_16; ++x)
+	{
+		const __m128i values = _mm_loadu_si128((const __m128i*)(src + x * 16));
+		
+		const __m256i values1 = _mm256_cvtepu8_epi32(values);
+		const __m256i values2 = _mm256_cvtepu8_epi32(_mm_unpackhi_epi64(values, values));
+		
+		_mm256_storeu_ps(dst + x * 16 + 0, _mm256_mul_ps(_mm256_cvtepi32_ps(values1), scale_8));
+		_mm256_storeu_ps(dst + x * 16 + 8, _mm256_mul_ps(_mm256_cvtepi32_ps(values2), scale_8));
+	}
+	
+	return sx_16 * 16;
+}
+
+#elif defined(__SSE2__)
 
 static int fillFloats_SSE(const uint8_t * __restrict src, const int sx, float * __restrict dst)
 {
@@ -97,8 +151,8 @@ static int fillFloats_SSE(const uint8_t * __restrict src, const int sx, float *
 		const __m128i valuesR = _mm_unpackhi_epi8(values, zero);
 		
 		const __m128i values1 = _mm_unpacklo_epi16(valuesL, zero);
-		const __m128i values2 = _mm_unpackhi_epi16(valuesR, zero);
-		const __m128i values3 = _mm_unpacklo_epi16(valuesL, zero);
+		const __m128i values2 = _mm_unpackhi_epi16(valuesL, zero);
+		const __m128i values3 = _mm_unpacklo_epi16(valuesR, zero);
 		const __m128i values4 = _mm_unpackhi_epi16(valuesR, zero);
 		
 		const __m128 floats1 = _mm_mul_ps(_mm_cvtepi32_ps(values1), scale_4);
@@ -123,24 +177,31 @@ static void fillFloats(float * __restrict floatValues, const VfxImageCpu * image
 	
 	const float scale = 1.f / 255.f;
 	
-	for (int y = 0; y < image->sy; ++y)
+	// note : mostly memory bandwidth bound. splitting the work over multiple threads helps more than SIMD here
+	
+	vfxParallelRows(image->sy, vfxGetRowsPerTask(image->sx), [&](const int y1, const int y2)
 	{
-		const uint8_t * __restrict src = channel.data + channel.pitch * y;
-		      float   * __restrict dst = floatValues + image->sx * y;
-		
-		int begin = 0;
-		
-	#ifdef __SSE2__
-		// 1.25ms no SSE -> 1.25ms with SSE. exactly the same! must be memory bandwidth bound..
-		// let's hope faster memory is on the way, so my time spending on this won't be in vain! ;-)
-		begin = fillFloats_SSE(src, image->sx, dst);
-	#endif
-		
-		for (int x = begin; x < image->sx; ++x)
+		for (int y = y1; y < y2; ++y)
 		{
-			dst[x] = src[x] * scale;
+			const uint8_t * __restrict src = channel.data + channel.pitch * y;
+				  float   * __restrict dst = floatValues + image->sx * y;
+			
+			int begin = 0;
+			
+		#if USE_NEON
+			begin = fillFloats_NEON(src, image->sx, dst);
+		#elif defined(__AVX2__)
+			begin = fillFloats_AVX2(src, image->sx, dst);
+		#elif defined(__SSE2__)
+			begin = fillFloats_SSE(src, image->sx, dst);
+		#endif
+			
+			for (int x = begin; x < image->sx; ++x)
+			{
+				dst[x] = src[x] * scale;
+			}
 		}
-	}
+	});
 }
 
 void VfxNodeImageCpuToChannels::tick(const float dt)
@@ -59,6 +59,8 @@ VfxNodeSpectrum2D::VfxNodeSpectrum2D()
 	, texture2()
 	, dreal(nullptr)
 	, dimag(nullptr)
+	, bufferSx(0)
+	, bufferSy(0)
 	, image1Output()
 	, image2Output()
 	, realChannelOutput()
@@ -74,11 +76,14 @@ VfxNodeSpectrum2D::VfxNodeSpectrum2D()
 	addOutput(kOutput_Image2, kVfxPlugType_Image, &image2Output);
 	addOutput(kOutput_RealChannel, kVfxPlugType_Channel, &realChannelOutput);
 	addOutput(kOutput_ImagChannel, kVfxPlugType_Channel, &imagChannelOutput);
+	
+	isThreadSafe = true;
 }
 
 VfxNodeSpectrum2D::~VfxNodeSpectrum2D()
 {
 	freeTextures();
+	freeBuffers();
 }
 
 void VfxNodeSpectrum2D::tick(const float dt)
@@ -93,19 +98,18 @@ void VfxNodeSpectrum2D::tick(const float dt)
 	const bool normalize = getInputBool(kInput_Normalize, true);
 	const float scale = getInputFloat(kInput_Scale, 1.f);
 	
-	if (isPassthrough || image == nullptr)
+	// note : tick may run on a worker thread. the textures are managed by afterTick, on the main thread
+	
+	if (isPassthrough || image == nullptr || image->sx == 0 || image->sy == 0)
 	{
-		freeTextures();
+		freeBuffers();
 	}
-	else if (texture1.isChanged(transformSx, transformSy, GX_R32_FLOAT))
+	else if (transformSx != bufferSx || transformSy != bufferSy)
 	{
-		if (image->sx == 0 || image->sy == 0)
-			freeTextures();
-		else
-			allocateTextures(transformSx, transformSy);
+		allocateBuffers(transformSx, transformSy);
 	}
 	
-	if (texture1.id != 0 && texture2.id != 0)
+	if (dreal != nullptr && dimag != nullptr)
 	{
 		const VfxImageCpu::Channel & srcChannel = image->channel[imageChannel];
 		
@@ -180,15 +184,6 @@ void VfxNodeSpectrum2D::tick(const float dt)
 			}
 		}
 		
-		// combined channel mode requires texture format change
-		
-		texture1.upload(dreal, 4, transformSx);
-		
-		if (outputMode == kOutputMode_Channel1And2)
-			texture2.upload(dimag, 4, transformSx);
-		else
-			texture2.upload(dreal, 4, transformSx);
-		
 		if (outputMode == kOutputMode_Channel1And2)
 		{
 			realChannelOutput.setData2D(dreal, false, transformSx, transformSy);
@@ -202,6 +197,30 @@ void VfxNodeSpectrum2D::tick(const float dt)
 	}
 }
 
+void VfxNodeSpectrum2D::afterTick(const float dt)
+{
+	const OutputMode outputMode = (OutputMode)getInputInt(kInput_OutputMode, kOutputMode_Channel1And2);
+	
+	if (dreal == nullptr || dimag == nullptr)
+	{
+		freeTextures();
+	}
+	else
+	{
+		if (texture1.isChanged(bufferSx, bufferSy, GX_R32_FLOAT))
+			allocateTextures(bufferSx, bufferSy);
+		
+		// combined channel mode requires texture format change
+		
+		texture1.upload(dreal, 4, bufferSx);
+		
+		if (outputMode == kOutputMode_Channel1And2)
+			texture2.upload(dimag, 4, bufferSx);
+		else
+			texture2.upload(dreal, 4, bufferSx);
+	}
+}
+
 void VfxNodeSpectrum2D::getDescription(VfxNodeDescription & d)
 {
 	d.add("channels:");
@@ -219,9 +238,6 @@ void VfxNodeSpectrum2D::allocateTextures(const int sx, const int sy)
 	texture1.setSwizzle(0, 0, 0, GX_SWIZZLE_ONE);
 	texture2.setSwizzle(0, 0, 0, GX_SWIZZLE_ONE);
 	
-	dreal = (float*)MemAlloc(sx * sy * sizeof(float), 16);
-	dimag = (float*)MemAlloc(sx * sy * sizeof(float), 16);
-	
 	image1Output.texture = texture1.id;
 	image2Output.texture = texture2.id;
 }
@@ -231,14 +247,31 @@ void VfxNodeSpectrum2D::freeTextures()
 	texture1.free();
 	texture2.free();
 	
+	image1Output.texture = 0;
+	image2Output.texture = 0;
+}
+
+void VfxNodeSpectrum2D::allocateBuffers(const int sx, const int sy)
+{
+	freeBuffers();
+	
+	dreal = (float*)MemAlloc(sx * sy * sizeof(float), 16);
+	dimag = (float*)MemAlloc(sx * sy * sizeof(float), 16);
+	
+	bufferSx = sx;
+	bufferSy = sy;
+}
+
+void VfxNodeSpectrum2D::freeBuffers()
+{
 	MemFree(dreal);
 	dreal = nullptr;
 	
 	MemFree(dimag);
 	dimag = nullptr;
 	
-	image1Output.texture = 0;
-	image2Output.texture = 0;
+	bufferSx = 0;
+	bufferSy = 0;
 	
 	realChannelOutput.reset();
 	imagChannelOutput.reset();
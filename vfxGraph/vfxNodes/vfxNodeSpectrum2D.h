@@ -72,6 +72,8 @@ struct VfxNodeSpectrum2D : VfxNodeBase
 	GxTexture texture2;
 	float * dreal;
 	float * dimag;
+	int bufferSx;
+	int bufferSy;
 	
 	VfxImage_Texture image1Output;
 	VfxImage_Texture image2Output;
@@ -82,9 +84,13 @@ struct VfxNodeSpectrum2D : VfxNodeBase
 	virtual ~VfxNodeSpectrum2D() override;
 	
 	virtual void tick(const float dt) override;
+	virtual void afterTick(const float dt) override;
 	
 	virtual void getDescription(VfxNodeDescription & d) override;
 	
 	void allocateTextures(const int sx, const int sy);
 	void freeTextures();
+	
+	void allocateBuffers(const int sx, const int sy);
+	void freeBuffers();
 };
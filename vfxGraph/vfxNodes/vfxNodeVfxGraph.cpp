@@ -33,7 +33,7 @@
 
 using namespace tinyxml2;
 
-extern VfxGraph * g_currentVfxGraph;
+extern thread_local VfxGraph * g_currentVfxGraph;
 
 VFX_NODE_TYPE(VfxNodeVfxGraph)
 {
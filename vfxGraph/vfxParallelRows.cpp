@@ -0,0 +1,225 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "vfxParallelRows.h"
+#include "vfxProfiling.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct RowThreadPool
+	{
+		std::mutex executeMutex; // held by the thread currently distributing rows over the helper threads
+		
+		std::mutex mutex;
+		std::condition_variable wakeupCond;
+		std::condition_variable doneCond;
+		
+		std::vector<std::thread> threads;
+		bool stopRequested = false;
+		
+		int epoch = 0;            // incremented each time a new set of rows is distributed
+		int numActiveThreads = 0; // the number of helper threads working on the current set of rows
+		
+		VfxRowFunction function = nullptr;
+		void * userData = nullptr;
+		int numRows = 0;
+		int rowsPerTask = 0;
+		std::atomic<int> nextRow;
+		
+		RowThreadPool()
+		{
+			const int numHardwareThreads = (int)std::thread::hardware_concurrency();
+			
+			init(std::min(7, std::max(0, numHardwareThreads - 1)));
+		}
+		
+		~RowThreadPool()
+		{
+			shut();
+		}
+		
+		void init(const int numThreads)
+		{
+			stopRequested = false;
+			
+			for (int i = 0; i < numThreads; ++i)
+				threads.emplace_back(threadMain, this);
+		}
+		
+		void shut()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				
+				stopRequested = true;
+			}
+			
+			wakeupCond.notify_all();
+			
+			for (auto & thread : threads)
+				thread.join();
+			
+			threads.clear();
+		}
+		
+		static void runTasks(VfxRowFunction function, void * userData, const int numRows, const int rowsPerTask, std::atomic<int> & nextRow)
+		{
+			for (;;)
+			{
+				const int y1 = nextRow.fetch_add(rowsPerTask);
+				
+				if (y1 >= numRows)
+					break;
+				
+				const int y2 = std::min(numRows, y1 + rowsPerTask);
+				
+				function(userData, y1, y2);
+			}
+		}
+		
+		void execute(const int in_numRows, const int in_rowsPerTask, VfxRowFunction in_function, void * in_userData)
+		{
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				
+				// wait for helper threads which woke up late for the previous set of rows to leave
+				
+				doneCond.wait(lock, [&]() { return numActiveThreads == 0; });
+				
+				function = in_function;
+				userData = in_userData;
+				numRows = in_numRows;
+				rowsPerTask = in_rowsPerTask;
+				nextRow.store(0);
+				
+				epoch++;
+			}
+			
+			wakeupCond.notify_all();
+			
+			runTasks(in_function, in_userData, in_numRows, in_rowsPerTask, nextRow);
+			
+			// wait for the helper threads to finish the tasks they picked up
+			
+			std::unique_lock<std::mutex> lock(mutex);
+			
+			doneCond.wait(lock, [&]() { return numActiveThreads == 0; });
+		}
+		
+		static void threadMain(RowThreadPool * self)
+		{
+			vfxSetThreadName("VfxGraph Row Worker");
+			
+			std::unique_lock<std::mutex> lock(self->mutex);
+			
+			int seenEpoch = self->epoch;
+			
+			for (;;)
+			{
+				self->wakeupCond.wait(lock, [&]() { return self->stopRequested || self->epoch != seenEpoch; });
+				
+				if (self->stopRequested)
+					break;
+				
+				seenEpoch = self->epoch;
+				
+				const VfxRowFunction function = self->function;
+				void * userData = self->userData;
+				const int numRows = self->numRows;
+				const int rowsPerTask = self->rowsPerTask;
+				
+				self->numActiveThreads++;
+				
+				lock.unlock();
+				{
+					runTasks(function, userData, numRows, rowsPerTask, self->nextRow);
+				}
+				lock.lock();
+				
+				self->numActiveThreads--;
+				
+				if (self->numActiveThreads == 0)
+					self->doneCond.notify_all();
+			}
+		}
+	};
+	
+	RowThreadPool & getRowThreadPool()
+	{
+		static RowThreadPool s_pool;
+		
+		return s_pool;
+	}
+}
+
+void vfxParallelRows(const int numRows, const int minRowsPerTask, VfxRowFunction function, void * userData)
+{
+	if (numRows <= 0)
+		return;
+	
+	const int rowsPerTask = std::max(1, minRowsPerTask);
+	
+	RowThreadPool & pool = getRowThreadPool();
+	
+	std::unique_lock<std::mutex> executeLock(pool.executeMutex, std::try_to_lock);
+	
+	if (executeLock.owns_lock() == false || pool.threads.empty() || numRows <= rowsPerTask)
+	{
+		// process the rows on the calling thread when the helper threads are busy or there's nothing to split
+		
+		function(userData, 0, numRows);
+	}
+	else
+	{
+		pool.execute(numRows, rowsPerTask, function, userData);
+	}
+}
+
+void vfxSetParallelRowsThreadCount(const int numThreads)
+{
+	RowThreadPool & pool = getRowThreadPool();
+	
+	std::lock_guard<std::mutex> executeLock(pool.executeMutex);
+	
+	pool.shut();
+	pool.init(std::max(0, numThreads));
+}
+
+int vfxGetParallelRowsThreadCount()
+{
+	RowThreadPool & pool = getRowThreadPool();
+	
+	std::lock_guard<std::mutex> executeLock(pool.executeMutex);
+	
+	return (int)pool.threads.size();
+}
@@ -0,0 +1,77 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+/**
+ * Splits the rows of an image into tasks of (at least) minRowsPerTask rows, and executes them in parallel on a set
+ * of helper threads, which is shared by all image processing nodes. The calling thread helps executing tasks and
+ * returns once all rows have been processed. When the helper threads are busy executing tasks on behalf of another
+ * thread, or when there are too few rows to split, the rows are processed on the calling thread instead.
+ *
+ * Usage:
+ * ```cpp
+ * vfxParallelRows(image.sy, vfxGetRowsPerTask(image.sx), [&](const int y1, const int y2)
+ * {
+ *     for (int y = y1; y < y2; ++y)
+ *         processRow(y);
+ * });
+ * ```
+ */
+
+typedef void (*VfxRowFunction)(void * userData, const int y1, const int y2);
+
+void vfxParallelRows(const int numRows, const int minRowsPerTask, VfxRowFunction function, void * userData);
+
+template <typename F>
+void vfxParallelRows(const int numRows, const int minRowsPerTask, const F & function)
+{
+	vfxParallelRows(numRows, minRowsPerTask,
+		[](void * userData, const int y1, const int y2)
+		{
+			(*(const F*)userData)(y1, y2);
+		},
+		(void*)&function);
+}
+
+/**
+ * Returns the number of rows to process per task so each task touches a reasonable number of pixels, to amortize
+ * the cost of distributing tasks over threads.
+ */
+inline int vfxGetRowsPerTask(const int sx)
+{
+	const int kMinPixelsPerTask = 32 * 1024;
+	
+	return sx <= 0 ? 1 : (kMinPixelsPerTask + sx - 1) / sx;
+}
+
+/**
+ * Sets the number of helper threads used by vfxParallelRows. By default, the number of hardware threads minus one
+ * is used, up to a maximum of seven. Setting the number of threads to zero disables parallel execution.
+ */
+void vfxSetParallelRowsThreadCount(const int numThreads);
+int vfxGetParallelRowsThreadCount();
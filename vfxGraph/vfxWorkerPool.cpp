@@ -0,0 +1,161 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "Debugging.h"
+#include "vfxProfiling.h"
+#include "vfxWorkerPool.h"
+
+VfxWorkerPool::VfxWorkerPool()
+	: threads()
+	, mutex()
+	, pendingCond()
+	, completedCond()
+	, pendingJobs()
+	, completedJobs()
+	, numJobsInFlight(0)
+	, stopRequested(false)
+	, jobFunction(nullptr)
+	, jobUserData(nullptr)
+{
+}
+
+VfxWorkerPool::~VfxWorkerPool()
+{
+	shut();
+}
+
+void VfxWorkerPool::init(const int numThreads)
+{
+	shut();
+	
+	stopRequested = false;
+	
+	for (int i = 0; i < numThreads; ++i)
+		threads.emplace_back(threadMain, this);
+}
+
+void VfxWorkerPool::shut()
+{
+	Assert(numJobsInFlight == 0);
+	
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		
+		stopRequested = true;
+	}
+	
+	pendingCond.notify_all();
+	
+	for (auto & thread : threads)
+		thread.join();
+	
+	threads.clear();
+}
+
+int VfxWorkerPool::getNumThreads() const
+{
+	return threads.size();
+}
+
+void VfxWorkerPool::begin(JobFunction function, void * userData)
+{
+	Assert(numJobsInFlight == 0);
+	
+	jobFunction = function;
+	jobUserData = userData;
+}
+
+void VfxWorkerPool::end()
+{
+	Assert(numJobsInFlight == 0);
+	
+	jobFunction = nullptr;
+	jobUserData = nullptr;
+}
+
+void VfxWorkerPool::push(const int jobIndex)
+{
+	Assert(jobFunction != nullptr);
+	
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		
+		pendingJobs.push_back(jobIndex);
+		
+		numJobsInFlight++;
+	}
+	
+	pendingCond.notify_one();
+}
+
+bool VfxWorkerPool::popCompletedJob(int & jobIndex, const bool wait)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	
+	if (wait)
+	{
+		completedCond.wait(lock, [&]() { return completedJobs.empty() == false || numJobsInFlight == 0; });
+	}
+	
+	if (completedJobs.empty())
+		return false;
+	
+	jobIndex = completedJobs.front();
+	completedJobs.pop_front();
+	
+	numJobsInFlight--;
+	
+	return true;
+}
+
+void VfxWorkerPool::threadMain(VfxWorkerPool * pool)
+{
+	vfxSetThreadName("VfxGraph Worker");
+	
+	std::unique_lock<std::mutex> lock(pool->mutex);
+	
+	for (;;)
+	{
+		pool->pendingCond.wait(lock, [&]() { return pool->stopRequested || pool->pendingJobs.empty() == false; });
+		
+		if (pool->stopRequested)
+			break;
+		
+		const int jobIndex = pool->pendingJobs.front();
+		pool->pendingJobs.pop_front();
+		
+		lock.unlock();
+		{
+			pool->jobFunction(pool->jobUserData, jobIndex);
+		}
+		lock.lock();
+		
+		pool->completedJobs.push_back(jobIndex);
+		
+		pool->completedCond.notify_one();
+	}
+}
@@ -0,0 +1,91 @@
+/*
+	Copyright (C) 2020 Marcel Smit
+	marcel303@gmail.com
+	https://www.facebook.com/marcel.smit981
+
+	Permission is hereby granted, free of charge, to any person
+	obtaining a copy of this software and associated documentation
+	files (the "Software"), to deal in the Software without
+	restriction, including without limitation the rights to use,
+	copy, modify, merge, publish, distribute, sublicense, and/or
+	sell copies of the Software, and to permit persons to whom the
+	Software is furnished to do so, subject to the following
+	conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES
+	OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+	NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+	HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+	WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING
+	FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR
+	OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * VfxWorkerPool executes jobs on a set of worker threads on behalf of the main thread. It is used by VfxGraph to
+ * tick thread-safe nodes in parallel. The main thread pushes jobs as they become ready to run, and collects them
+ * again once they have finished, so it can perform any work which must be done on the main thread in between.
+ *
+ * Parallel ticking is enabled for all graphs sharing a context by adding the worker pool to the context:
+ * ```cpp
+ * VfxWorkerPool workerPool;
+ * workerPool.init(3);
+ *
+ * VfxGraphContext context;
+ * context.addSystem<VfxWorkerPool>(&workerPool);
+ *
+ * VfxGraph * vfxGraph = constructVfxGraph(graph, typeDefinitionLibrary, &context);
+ * ```
+ */
+struct VfxWorkerPool
+{
+	typedef void (*JobFunction)(void * userData, const int jobIndex);
+	
+	std::vector<std::thread> threads;
+	
+	std::mutex mutex;
+	std::condition_variable pendingCond;   ///< Signalled when jobs are pushed, or when the worker threads should stop.
+	std::condition_variable completedCond; ///< Signalled when a job has finished.
+	
+	std::deque<int> pendingJobs;
+	std::deque<int> completedJobs;
+	int numJobsInFlight;                   ///< The number of jobs pushed which haven't been collected yet by popCompletedJob.
+	bool stopRequested;
+	
+	JobFunction jobFunction;
+	void * jobUserData;
+	
+	VfxWorkerPool();
+	~VfxWorkerPool();
+	
+	void init(const int numThreads);
+	void shut();
+	
+	int getNumThreads() const;
+	
+	void begin(JobFunction function, void * userData); ///< Sets the function used to execute jobs. Must be called before pushing jobs, while no jobs are in flight.
+	void end();
+	
+	void push(const int jobIndex);
+	
+	/**
+	 * Returns the index of a job which has finished. When 'wait' is set, blocks until a job finishes. Returns false
+	 * when no job has finished yet and 'wait' isn't set, or when there are no jobs in flight.
+	 */
+	bool popCompletedJob(int & jobIndex, const bool wait);
+	
+private:
+	static void threadMain(VfxWorkerPool * pool);
+};